@@ -139,17 +139,20 @@ export async function register(fastify, opts) {
           await axios.post(`${MARKET_SIM_URL}/export`, {
             format: "json",
             dataDir: DATA_DIR,
+            wait: true,
           }, { timeout: 300000 });
           
           await axios.post(`${MARKET_SIM_URL}/export`, {
             format: "json",
             dataDir: DATA_DIR,
             maxTicks: 100000,
+            wait: true,
           }, { timeout: 300000 });
           
           await axios.post(`${MARKET_SIM_URL}/export`, {
             format: "csv",
             dataDir: DATA_DIR,
+            wait: true,
           }, { timeout: 300000 });
           
           fastify.log.info("Data export complete");
@@ -200,6 +203,26 @@ export async function register(fastify, opts) {
     }
   });
 
+  // Incremental tick ranges straight from the simulator's buffer, streamed through
+  fastify.get("/ticks", async (request, reply) => {
+    const { start = 0, count = 1000, symbols } = request.query || {};
+    try {
+      const response = await axios.get(`${MARKET_SIM_URL}/ticks`, {
+        params: { start, count, ...(symbols ? { symbols } : {}) },
+        responseType: "stream",
+        timeout: 30000,
+        validateStatus: () => true,
+      });
+      reply.code(response.status).type("application/json");
+      return reply.send(response.data);
+    } catch (error) {
+      return reply.code(503).send({
+        error: "Market simulator not available",
+        message: error.message,
+      });
+    }
+  });
+
   fastify.get("/sample", async (request, reply) => {
     const filePath = path.join(DATA_DIR, "dev_100k.json");
 
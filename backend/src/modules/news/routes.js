@@ -4,11 +4,11 @@ const MARKET_SIM_URL = process.env.MARKET_SIM_URL || "http://localhost:8080";
 
 export async function register(fastify, opts) {
   fastify.get("/", async (request, reply) => {
-    const { limit = 100, since } = request.query;
+    const { limit = 100, since, symbol } = request.query;
 
     try {
       const response = await axios.get(`${MARKET_SIM_URL}/news/history`, {
-        params: { limit },
+        params: { limit, since, symbol },
         timeout: 5000,
       });
 
@@ -22,17 +22,13 @@ export async function register(fastify, opts) {
     const { tick } = request.params;
 
     try {
+      const tickNum = parseInt(tick, 10);
       const response = await axios.get(`${MARKET_SIM_URL}/news/history`, {
-        params: { limit: 1000 },
+        params: { since: tickNum, until: tickNum + 1, limit: 1000 },
         timeout: 5000,
       });
 
-      const tickNum = parseInt(tick, 10);
-      const filtered = response.data.filter(
-        (n) => n.tick === tickNum || n.timestamp === tickNum
-      );
-
-      return filtered;
+      return response.data;
     } catch (error) {
       return [];
     }
@@ -0,0 +1,137 @@
+#include <benchmark/benchmark.h>
+#include "engine/Simulation.hpp"
+#include "utils/Random.hpp"
+#include <spdlog/spdlog.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace market;
+
+// Whole-engine benchmarks. Arguments are (commodities, agent multiplier):
+// commodities are the five in commodities.json replicated with numbered
+// symbols, and the default 68-agent population is scaled by the multiplier.
+
+namespace {
+
+    nlohmann::json baseCommodities() {
+        static const nlohmann::json data = [] {
+            nlohmann::json j;
+            std::ifstream file("commodities.json");
+            if (file.is_open()) file >> j;
+            return j;
+        }();
+        return data;
+    }
+
+    nlohmann::json scaledCommodities(int count) {
+        nlohmann::json base = baseCommodities();
+        nlohmann::json out = base;
+        out["commodities"] = nlohmann::json::array();
+        const auto& src = base["commodities"];
+        for (int i = 0; i < count && !src.empty(); i++) {
+            nlohmann::json c = src[i % src.size()];
+            if (i >= static_cast<int>(src.size())) {
+                c["symbol"] = c["symbol"].get<std::string>() + std::to_string(i / src.size());
+                c.erase("crossEffects");
+            }
+            out["commodities"].push_back(c);
+        }
+        return out;
+    }
+
+    nlohmann::json scaledConfig(int agentMultiplier, const std::string& matchingMode) {
+        RuntimeConfig::AgentCounts defaults;
+        return {
+            {"agentCounts", {
+                {"supplyDemand", defaults.supplyDemand * agentMultiplier},
+                {"momentum", defaults.momentum * agentMultiplier},
+                {"meanReversion", defaults.meanReversion * agentMultiplier},
+                {"noise", defaults.noise * agentMultiplier},
+                {"marketMaker", defaults.marketMaker * agentMultiplier},
+                {"crossEffects", defaults.crossEffects * agentMultiplier},
+                {"inventory", defaults.inventory * agentMultiplier},
+                {"event", defaults.event * agentMultiplier}
+            }},
+            {"orderBook", {{"matchingMode", matchingMode}}}
+        };
+    }
+
+    void runTicks(benchmark::State& state, const std::string& matchingMode) {
+        spdlog::set_level(spdlog::level::warn);
+        Random::seed(42);
+
+        Simulation sim;
+        sim.loadConfig(scaledConfig(static_cast<int>(state.range(1)), matchingMode));
+        sim.setCommoditiesData(scaledCommodities(static_cast<int>(state.range(0))));
+        sim.initialize();
+
+        // Let the books fill before measuring
+        sim.step(200);
+
+        for (auto _ : state) {
+            sim.step(1);
+        }
+        state.SetItemsProcessed(state.iterations());
+        state.counters["agents"] = static_cast<double>(sim.getEngine().getAgents().size());
+    }
+
+} // namespace
+
+static void BM_Engine_Tick(benchmark::State& state) {
+    runTicks(state, "continuous");
+}
+BENCHMARK(BM_Engine_Tick)
+    ->Args({ 5, 1 })
+    ->Args({ 5, 10 })
+    ->Args({ 20, 1 })
+    ->Args({ 20, 10 })
+    ->Args({ 200, 1 })
+    ->Unit(benchmark::kMicrosecond);
+
+static void BM_Engine_TickAuction(benchmark::State& state) {
+    runTicks(state, "auction");
+}
+BENCHMARK(BM_Engine_TickAuction)
+    ->Args({ 5, 10 })
+    ->Args({ 20, 10 })
+    ->Unit(benchmark::kMicrosecond);
+
+// Replays a journal of 500 ticks recorded from the agent-driven run above:
+// the same order flow, with only the books, matching and market updates
+// running (restoring the journal's starting checkpoint included)
+static void BM_Engine_Replay(benchmark::State& state) {
+    spdlog::set_level(spdlog::level::warn);
+    Random::seed(42);
+    nlohmann::json config = scaledConfig(static_cast<int>(state.range(1)), "continuous");
+    nlohmann::json commodities = scaledCommodities(static_cast<int>(state.range(0)));
+    auto path = std::filesystem::temp_directory_path() /
+        ("market_bench_journal_" + std::to_string(state.range(0)) + "_" + std::to_string(state.range(1)) + ".bin");
+    {
+        Simulation recorder;
+        recorder.loadConfig(config);
+        recorder.setCommoditiesData(commodities);
+        recorder.initialize();
+        recorder.step(200);
+        recorder.startJournal(path.string());
+        recorder.step(500);
+        recorder.stopJournal();
+    }
+
+    uint64_t ticks = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        Simulation sim;
+        sim.loadConfig(config);
+        sim.setCommoditiesData(commodities);
+        sim.initialize();
+        state.ResumeTiming();
+        ticks += sim.replayJournal(path.string());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(ticks));
+    std::filesystem::remove(path);
+}
+BENCHMARK(BM_Engine_Replay)
+    ->Args({ 5, 10 })
+    ->Args({ 20, 10 })
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,132 @@
+#include <benchmark/benchmark.h>
+#include "core/OrderBook.hpp"
+#include "utils/Random.hpp"
+#include <vector>
+
+using namespace market;
+
+// Order book micro-benchmarks. The range argument is the number of resting
+// orders per side, spread over 100 price levels around 100.00.
+
+namespace {
+
+    Order makeOrder(OrderId id, OrderSide side, Price price, Volume qty) {
+        Order o;
+        o.id = id;
+        o.agentId = id;
+        o.symbolId = 0;
+        o.side = side;
+        o.type = OrderType::LIMIT;
+        o.price = price;
+        o.quantity = qty;
+        return o;
+    }
+
+    // Non-crossing book: bids 99.00 and below, asks 101.00 and above
+    void fillBook(OrderBook& book, int perSide, OrderId& nextId) {
+        for (int i = 0; i < perSide; i++) {
+            Price offset = (i % 100) * 0.01;
+            book.addOrder(makeOrder(nextId++, OrderSide::BUY, 99.0 - offset, 10));
+            book.addOrder(makeOrder(nextId++, OrderSide::SELL, 101.0 + offset, 10));
+        }
+    }
+
+} // namespace
+
+static void BM_OrderBook_AddOrder(benchmark::State& state) {
+    OrderBook book("BENCH");
+    OrderId nextId = 1;
+    fillBook(book, static_cast<int>(state.range(0)), nextId);
+
+    int i = 0;
+    for (auto _ : state) {
+        Price offset = (i++ % 100) * 0.01;
+        book.addOrder(makeOrder(nextId++, OrderSide::BUY, 99.0 - offset, 10));
+        if ((i & 1023) == 0) {
+            state.PauseTiming();
+            book.clear();
+            fillBook(book, static_cast<int>(state.range(0)), nextId);
+            state.ResumeTiming();
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_OrderBook_AddOrder)->Arg(100)->Arg(1000)->Arg(10000);
+
+static void BM_OrderBook_CancelOrder(benchmark::State& state) {
+    OrderBook book("BENCH");
+    OrderId nextId = 1;
+    fillBook(book, static_cast<int>(state.range(0)), nextId);
+
+    // Cancel one resting order and immediately replace it, so depth stays fixed
+    OrderId victim = 1;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(book.cancelOrder(victim));
+        book.addOrder(makeOrder(nextId, OrderSide::BUY, 99.0 - (victim % 100) * 0.01, 10));
+        victim = nextId++;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_OrderBook_CancelOrder)->Arg(100)->Arg(1000)->Arg(10000);
+
+static void BM_OrderBook_MatchOrders(benchmark::State& state) {
+    OrderBook book("BENCH");
+    OrderId nextId = 1;
+    fillBook(book, static_cast<int>(state.range(0)), nextId);
+
+    // Each iteration crosses the top of book with one aggressive order per side
+    int64_t trades = 0;
+    for (auto _ : state) {
+        book.addOrder(makeOrder(nextId++, OrderSide::BUY, 101.0, 10));
+        book.addOrder(makeOrder(nextId++, OrderSide::SELL, 99.0, 10));
+        auto executed = book.matchOrders();
+        trades += static_cast<int64_t>(executed.size());
+
+        // Put the consumed liquidity back
+        book.addOrder(makeOrder(nextId++, OrderSide::BUY, 99.0, 10));
+        book.addOrder(makeOrder(nextId++, OrderSide::SELL, 101.0, 10));
+    }
+    state.SetItemsProcessed(trades);
+}
+BENCHMARK(BM_OrderBook_MatchOrders)->Arg(100)->Arg(1000)->Arg(10000);
+
+static void BM_OrderBook_MatchAuction(benchmark::State& state) {
+    Random::seed(7);
+    OrderBook book("BENCH");
+    book.setMatchingMode(OrderBook::MatchingMode::AUCTION);
+    OrderId nextId = 1;
+    fillBook(book, static_cast<int>(state.range(0)), nextId);
+
+    // A tick's worth of crossing flow cleared in one call
+    int64_t trades = 0;
+    int64_t round = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        if ((++round & 255) == 0) {
+            book.clear();
+            fillBook(book, static_cast<int>(state.range(0)), nextId);
+        }
+        for (int i = 0; i < 50; i++) {
+            book.addOrder(makeOrder(nextId++, OrderSide::BUY, Random::uniform(99.0, 102.0), 10));
+            book.addOrder(makeOrder(nextId++, OrderSide::SELL, Random::uniform(98.0, 101.0), 10));
+        }
+        state.ResumeTiming();
+        trades += static_cast<int64_t>(book.matchOrders().size());
+    }
+    state.SetItemsProcessed(trades);
+}
+BENCHMARK(BM_OrderBook_MatchAuction)->Arg(100)->Arg(1000)->Arg(10000);
+
+static void BM_OrderBook_GetSnapshot(benchmark::State& state) {
+    OrderBook book("BENCH");
+    OrderId nextId = 1;
+    fillBook(book, static_cast<int>(state.range(0)), nextId);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(book.getSnapshot(static_cast<int>(state.range(1))));
+    }
+}
+BENCHMARK(BM_OrderBook_GetSnapshot)
+    ->Args({ 1000, 10 })
+    ->Args({ 10000, 10 })
+    ->Args({ 10000, 50 });
@@ -0,0 +1,109 @@
+#include <benchmark/benchmark.h>
+#include "core/TickBuffer.hpp"
+#include <filesystem>
+#include <string>
+
+using namespace market;
+
+// TickBuffer export benchmarks. The range argument is ticks per symbol;
+// output goes to the system temp directory and is removed afterwards.
+
+namespace {
+
+    void fillBuffer(TickBuffer& buffer, int ticks) {
+        const char* symbols[] = { "OIL", "STEEL", "WOOD", "BRICK", "GRAIN" };
+        for (const char* s : symbols) buffer.addSymbol(s);
+
+        for (int t = 0; t < ticks; t++) {
+            for (int s = 0; s < 5; s++) {
+                Price p = 50.0 + s * 10.0 + (t % 97) * 0.01;
+                buffer.recordTick(symbols[s], p, p + 0.05, p - 0.05, p + 0.01, 100.0 + t % 13);
+            }
+            buffer.advanceTick();
+        }
+    }
+
+} // namespace
+
+static void BM_TickBuffer_ExportJson(benchmark::State& state) {
+    TickBuffer buffer(static_cast<size_t>(state.range(0)));
+    fillBuffer(buffer, static_cast<int>(state.range(0)));
+    auto path = std::filesystem::temp_directory_path() / "market_bench_export.json";
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(buffer.exportToJson(path.string()));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * 5);
+    std::filesystem::remove(path);
+}
+BENCHMARK(BM_TickBuffer_ExportJson)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+// Sequential read of 100000 ticks per symbol through a tick range, plain
+// (0) or compressed (1); the bytes counter is the storage footprint
+static void BM_TickBuffer_RangeScan(benchmark::State& state) {
+    TickBuffer buffer(100000);
+    buffer.setCompression(state.range(0) != 0);
+    fillBuffer(buffer, 100000);
+
+    for (auto _ : state) {
+        double sum = 0;
+        for (const auto& series : buffer.getTickRange(0, 100000).series) {
+            series.forEach([&sum](const TickData& td) { sum += td.close; });
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * 100000 * 5);
+    state.counters["bytes"] = static_cast<double>(buffer.getStorageBytes());
+}
+BENCHMARK(BM_TickBuffer_RangeScan)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+static void BM_TickBuffer_ExportCsv(benchmark::State& state) {
+    TickBuffer buffer(static_cast<size_t>(state.range(0)));
+    fillBuffer(buffer, static_cast<int>(state.range(0)));
+    auto dir = std::filesystem::temp_directory_path() / "market_bench_csv";
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(buffer.exportToCsv(dir.string()));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * 5);
+    std::filesystem::remove_all(dir);
+}
+BENCHMARK(BM_TickBuffer_ExportCsv)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+static void BM_TickBuffer_ExportArrow(benchmark::State& state) {
+    TickBuffer buffer(static_cast<size_t>(state.range(0)));
+    fillBuffer(buffer, static_cast<int>(state.range(0)));
+    auto dir = std::filesystem::temp_directory_path() / "market_bench_arrow";
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(buffer.exportToArrow(dir.string()));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * 5);
+    std::filesystem::remove_all(dir);
+}
+BENCHMARK(BM_TickBuffer_ExportArrow)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+// Tick-thread cost of recording one tick of five symbols, with the pipeline
+// consumer appending to storage in the background
+static void BM_TickBuffer_Record(benchmark::State& state) {
+    TickBuffer buffer(1 << 20);
+    const char* symbols[] = { "OIL", "STEEL", "WOOD", "BRICK", "GRAIN" };
+    for (const char* s : symbols) buffer.addSymbol(s);
+
+    uint64_t t = 0;
+    for (auto _ : state) {
+        for (size_t s = 0; s < 5; s++) {
+            Price p = 50.0 + s * 10.0 + (t % 97) * 0.01;
+            buffer.recordTick(s, p, p + 0.05, p - 0.05, p + 0.01, 100.0);
+        }
+        buffer.advanceTick();
+        if (++t % (1 << 20) == 0) {
+            state.PauseTiming();
+            buffer.clear();
+            for (const char* s : symbols) buffer.addSymbol(s);
+            state.ResumeTiming();
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TickBuffer_Record);
@@ -0,0 +1,470 @@
+#include "engine/Simulation.hpp"
+#include "api/ApiServer.hpp"
+#include "utils/Histogram.hpp"
+#include "utils/Random.hpp"
+#include <spdlog/spdlog.h>
+#include <httplib.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+using namespace market;
+
+// End-to-end scenario driver: builds a Simulation with the given number of
+// commodities and agents, runs a fixed number of ticks and prints one JSON
+// line per scenario (ticks/sec, tick phase times, memory and allocations
+// per tick). With --http it then starts the ApiServer, attaches /stream,
+// /orderbook and /orders clients, and runs the same ticks again under that
+// load. Lists (--commodities 5,50,500) run every combination, for scaling
+// curves; see --help.
+
+// Every allocation in the process, counted for allocations per tick
+namespace {
+    std::atomic<uint64_t> g_allocations{ 0 };
+    std::atomic<uint64_t> g_allocatedBytes{ 0 };
+
+    void* countedAlloc(std::size_t size) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+        if (void* p = std::malloc(size ? size : 1)) return p;
+        throw std::bad_alloc();
+    }
+
+    void* countedAlignedAlloc(std::size_t size, std::align_val_t align) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+        auto a = static_cast<std::size_t>(align);
+        // aligned_alloc wants a size that is a multiple of the alignment
+        if (void* p = std::aligned_alloc(a, (std::max<std::size_t>(size, 1) + a - 1) / a * a)) return p;
+        throw std::bad_alloc();
+    }
+} // namespace
+
+void* operator new(std::size_t size) { return countedAlloc(size); }
+void* operator new[](std::size_t size) { return countedAlloc(size); }
+void* operator new(std::size_t size, std::align_val_t align) { return countedAlignedAlloc(size, align); }
+void* operator new[](std::size_t size, std::align_val_t align) { return countedAlignedAlloc(size, align); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+namespace {
+
+    struct Options {
+        std::vector<int> commodities{ 5 };
+        std::vector<int> agents{ 1000 };
+        std::vector<int> ticksPerDay{ 72000 };
+        int ticks = 1000;
+        int warmup = 200;
+        int matchingThreads = 1;
+        unsigned int seed = 42;
+        std::string configPath = "commodities.json";
+        std::string outPath;  // Empty: stdout
+
+        bool http = false;
+        int port = 18080;
+        int streamClients = 8;
+        int bookClients = 8;
+        int orderClients = 4;
+    };
+
+    std::vector<int> parseList(const std::string& text) {
+        std::vector<int> values;
+        std::stringstream list(text);
+        for (std::string item; std::getline(list, item, ',');) {
+            if (!item.empty()) values.push_back(std::stoi(item));
+        }
+        if (values.empty()) throw std::runtime_error("Empty list: " + text);
+        return values;
+    }
+
+    void printUsage() {
+        std::cerr
+            << "Usage: market_loadtest [options]\n"
+            << "  --commodities <n,...>   Commodity counts (default 5); beyond the configured ones,\n"
+            << "                          commodities are replicated with numbered symbols\n"
+            << "  --agents <n,...>        Total agents, split like the default population (default 1000)\n"
+            << "  --ticks-per-day <n,...> Simulated ticks per day (default 72000)\n"
+            << "  --ticks <n>             Measured ticks per scenario (default 1000)\n"
+            << "  --warmup <n>            Ticks run before measuring (default 200)\n"
+            << "  --matching-threads <n>  orderBook.matchingThreads (default 1)\n"
+            << "  --seed <n>              Simulation seed (default 42)\n"
+            << "  --config <path>         Commodity definitions (default commodities.json)\n"
+            << "  --out <path>            Append JSON lines here instead of stdout\n"
+            << "  --http                  Also measure with API clients attached\n"
+            << "  --port <n>              API port for --http (default 18080)\n"
+            << "  --stream-clients <n>    /stream clients (default 8)\n"
+            << "  --book-clients <n>      Clients polling /orderbook (default 8)\n"
+            << "  --order-clients <n>     Clients posting /orders (default 4)\n";
+    }
+
+    Options parseArgs(int argc, char* argv[]) {
+        Options o;
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::runtime_error("Missing value for " + arg);
+                return argv[++i];
+            };
+            if (arg == "--commodities") o.commodities = parseList(value());
+            else if (arg == "--agents") o.agents = parseList(value());
+            else if (arg == "--ticks-per-day") o.ticksPerDay = parseList(value());
+            else if (arg == "--ticks") o.ticks = std::stoi(value());
+            else if (arg == "--warmup") o.warmup = std::stoi(value());
+            else if (arg == "--matching-threads") o.matchingThreads = std::stoi(value());
+            else if (arg == "--seed") o.seed = static_cast<unsigned int>(std::stoul(value()));
+            else if (arg == "--config") o.configPath = value();
+            else if (arg == "--out") o.outPath = value();
+            else if (arg == "--http") o.http = true;
+            else if (arg == "--port") o.port = std::stoi(value());
+            else if (arg == "--stream-clients") o.streamClients = std::stoi(value());
+            else if (arg == "--book-clients") o.bookClients = std::stoi(value());
+            else if (arg == "--order-clients") o.orderClients = std::stoi(value());
+            else if (arg == "--help" || arg == "-h") {
+                printUsage();
+                std::exit(0);
+            }
+            else throw std::runtime_error("Unknown option: " + arg);
+        }
+        return o;
+    }
+
+    nlohmann::json scaledCommodities(const nlohmann::json& base, int count) {
+        nlohmann::json out = base;
+        out["commodities"] = nlohmann::json::array();
+        const auto& src = base["commodities"];
+        for (int i = 0; i < count && !src.empty(); i++) {
+            nlohmann::json c = src[i % src.size()];
+            if (i >= static_cast<int>(src.size())) {
+                c["symbol"] = c["symbol"].get<std::string>() + std::to_string(i / src.size());
+                c.erase("crossEffects");
+            }
+            out["commodities"].push_back(c);
+        }
+        return out;
+    }
+
+    // `total` agents in the proportions of the default population
+    nlohmann::json agentCounts(int total) {
+        RuntimeConfig::AgentCounts d;
+        std::vector<std::pair<const char*, int>> types = {
+            {"supplyDemand", d.supplyDemand}, {"momentum", d.momentum},
+            {"meanReversion", d.meanReversion}, {"noise", d.noise},
+            {"marketMaker", d.marketMaker}, {"crossEffects", d.crossEffects},
+            {"inventory", d.inventory}, {"event", d.event}
+        };
+        int defaults = 0;
+        for (const auto& [name, n] : types) defaults += n;
+        nlohmann::json counts = nlohmann::json::object();
+        int assigned = 0;
+        for (size_t i = 0; i < types.size(); i++) {
+            int n = i + 1 < types.size()
+                ? static_cast<int>(static_cast<long long>(total) * types[i].second / defaults)
+                : total - assigned;  // The remainder, so the total is exact
+            counts[types[i].first] = std::max(0, n);
+            assigned += n;
+        }
+        return counts;
+    }
+
+    uint64_t peakRssKb() {
+#if defined(__unix__) || defined(__APPLE__)
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+        return static_cast<uint64_t>(usage.ru_maxrss) / 1024;  // Bytes on macOS
+#else
+        return static_cast<uint64_t>(usage.ru_maxrss);
+#endif
+#else
+        return 0;
+#endif
+    }
+
+    uint64_t currentRssKb() {
+        std::ifstream statm("/proc/self/statm");
+        uint64_t pages = 0, resident = 0;
+        if (!(statm >> pages >> resident)) return 0;
+        return resident * 4;  // 4 KiB pages
+    }
+
+    // Steps `ticks` one at a time, so API readers can get at the engine
+    // between ticks as they would while it runs live
+    nlohmann::json measureTicks(Simulation& sim, int ticks) {
+        sim.getEngine().getProfiler().reset();
+        uint64_t allocsBefore = g_allocations.load();
+        uint64_t bytesBefore = g_allocatedBytes.load();
+        auto metricsBefore = sim.getEngine().getMetrics();
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ticks; i++) sim.step(1);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        auto metrics = sim.getEngine().getMetrics();
+        double n = std::max(1, ticks);
+        return {
+            {"ticks", ticks},
+            {"seconds", seconds},
+            {"ticksPerSec", seconds > 0 ? ticks / seconds : 0.0},
+            {"allocationsPerTick", (g_allocations.load() - allocsBefore) / n},
+            {"allocatedBytesPerTick", (g_allocatedBytes.load() - bytesBefore) / n},
+            {"tradesPerTick", (metrics.totalTrades - metricsBefore.totalTrades) / n},
+            {"ordersPerTick", (metrics.totalOrders - metricsBefore.totalOrders) / n},
+            {"phases", sim.getEngine().getProfiler().toJson()}
+        };
+    }
+
+    // Client threads against a running ApiServer, each type sharing one
+    // latency histogram and counters
+    class LoadClients {
+    public:
+        LoadClients(const Options& options, std::vector<std::string> symbols)
+            : options_(options), symbols_(std::move(symbols)) {}
+
+        ~LoadClients() { stop(); }
+
+        void start() {
+            for (int i = 0; i < options_.streamClients; i++) {
+                threads_.emplace_back([this] { streamLoop(); });
+            }
+            for (int i = 0; i < options_.bookClients; i++) {
+                threads_.emplace_back([this, i] { bookLoop(i); });
+            }
+            for (int i = 0; i < options_.orderClients; i++) {
+                threads_.emplace_back([this, i] { orderLoop(i); });
+            }
+        }
+
+        // Clients notice within one request; streams end when the server stops
+        void stop() {
+            stop_ = true;
+            for (auto& t : threads_) {
+                if (t.joinable()) t.join();
+            }
+            threads_.clear();
+        }
+
+        void resetCounts() {
+            streamBytes_ = 0;
+            streamFrames_ = 0;
+            bookLatency_.reset();
+            orderLatency_.reset();
+            errors_ = 0;
+        }
+
+        nlohmann::json toJson() const {
+            auto summary = [](const LatencyHistogram& h) {
+                return nlohmann::json{
+                    {"requests", h.count()},
+                    {"meanUs", h.mean()},
+                    {"p50Us", h.percentile(0.50)},
+                    {"p99Us", h.percentile(0.99)},
+                    {"maxUs", h.max()}
+                };
+            };
+            return {
+                {"stream", {{"clients", options_.streamClients},
+                            {"frames", streamFrames_.load()}, {"bytes", streamBytes_.load()}}},
+                {"orderbook", summary(bookLatency_)},
+                {"orders", summary(orderLatency_)},
+                {"errors", errors_.load()}
+            };
+        }
+
+    private:
+        const Options& options_;
+        std::vector<std::string> symbols_;
+        std::vector<std::thread> threads_;
+        std::atomic<bool> stop_{ false };
+
+        std::atomic<uint64_t> streamBytes_{ 0 };
+        std::atomic<uint64_t> streamFrames_{ 0 };
+        LatencyHistogram bookLatency_;
+        LatencyHistogram orderLatency_;
+        std::atomic<uint64_t> errors_{ 0 };
+
+        httplib::Client client() const {
+            httplib::Client cli("127.0.0.1", options_.port);
+            cli.set_connection_timeout(2, 0);
+            cli.set_read_timeout(5, 0);
+            return cli;
+        }
+
+        template <typename Fn>
+        void timed(LatencyHistogram& histogram, Fn&& request) {
+            auto start = std::chrono::steady_clock::now();
+            bool ok = request();
+            histogram.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count()));
+            if (!ok) {
+                errors_++;
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));  // Not a busy loop against a refusing server
+            }
+        }
+
+        void streamLoop() {
+            while (!stop_) {
+                auto cli = client();
+                auto res = cli.Get("/stream", [this](const char* data, size_t size) {
+                    streamBytes_ += size;
+                    streamFrames_ += static_cast<uint64_t>(std::count(data, data + size, '\n')) / 2;
+                    return !stop_.load();
+                });
+                if (!stop_ && (!res || res->status != 200)) {
+                    errors_++;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                }
+            }
+        }
+
+        void bookLoop(int index) {
+            auto cli = client();
+            cli.set_keep_alive(true);
+            for (size_t n = static_cast<size_t>(index); !stop_; n++) {
+                const std::string path = "/orderbook/" + symbols_[n % symbols_.size()];
+                timed(bookLatency_, [&] {
+                    auto res = cli.Get(path);
+                    return res && res->status == 200;
+                });
+            }
+        }
+
+        void orderLoop(int index) {
+            auto cli = client();
+            cli.set_keep_alive(true);
+            for (size_t n = static_cast<size_t>(index); !stop_; n++) {
+                // Small marketable orders, alternating sides, so the book stays balanced
+                nlohmann::json order = {
+                    {"symbol", symbols_[n % symbols_.size()]},
+                    {"side", n % 2 ? "SELL" : "BUY"},
+                    {"type", "MARKET"},
+                    {"quantity", 1},
+                    {"wait", false}
+                };
+                const std::string body = order.dump();
+                timed(orderLatency_, [&] {
+                    auto res = cli.Post("/orders", body, "application/json");
+                    return res && res->status == 200;
+                });
+            }
+        }
+    };
+
+    nlohmann::json runScenario(const Options& options, const nlohmann::json& baseCommodities,
+        int commodities, int agents, int ticksPerDay) {
+        nlohmann::json config = {
+            {"simulation", {{"ticksPerDay", ticksPerDay}}},
+            {"agentCounts", agentCounts(agents)},
+            {"orderBook", {{"matchingThreads", options.matchingThreads}}},
+            // Room for every client; the point is the engine under load, not 503s
+            {"http", {{"threads", 16 + options.streamClients + options.bookClients + options.orderClients},
+                      {"streamClients", options.streamClients}, {"feedClients", 0}}}
+        };
+
+        uint64_t rssBefore = currentRssKb();
+        auto buildStart = std::chrono::steady_clock::now();
+        Simulation sim;
+        sim.loadConfig(config);
+        sim.setSeed(options.seed);
+        sim.setCommoditiesData(scaledCommodities(baseCommodities, commodities));
+        sim.initialize();
+        double buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - buildStart).count();
+
+        sim.step(options.warmup);  // Let the books fill first
+
+        nlohmann::json result = {
+            {"commodities", sim.getEngine().getCommodities().size()},
+            {"agents", sim.getEngine().getAgents().size()},
+            {"ticksPerDay", ticksPerDay},
+            {"matchingThreads", options.matchingThreads},
+            {"warmupTicks", options.warmup},
+            {"profiling", MARKET_PROFILING != 0},
+            {"initSeconds", buildSeconds}
+        };
+        result["unloaded"] = measureTicks(sim, options.ticks);
+        uint64_t rssAfter = currentRssKb();
+        result["rssKb"] = rssAfter;
+        result["rssGrowthKb"] = rssAfter > rssBefore ? rssAfter - rssBefore : 0;
+        result["peakRssKb"] = peakRssKb();  // Whole process so far
+
+        if (options.http) {
+            std::vector<std::string> symbols;
+            for (const auto& c : sim.getSnapshot()->commodities) symbols.push_back(c.symbol);
+
+            ApiServer api(sim, "127.0.0.1", options.port);
+            api.start();
+            LoadClients clients(options, symbols);
+            clients.start();
+            std::this_thread::sleep_for(std::chrono::milliseconds(500));  // Connected and polling
+            clients.resetCounts();
+
+            nlohmann::json loaded = measureTicks(sim, options.ticks);
+            api.stop();  // Ends the streams, so their clients return
+            clients.stop();
+            loaded["clients"] = clients.toJson();
+            double before = result["unloaded"]["ticksPerSec"].get<double>();
+            double after = loaded["ticksPerSec"].get<double>();
+            loaded["relativeTickRate"] = before > 0 ? after / before : 0.0;
+            result["loaded"] = std::move(loaded);
+            result["peakRssKb"] = peakRssKb();
+        }
+        return result;
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        Options options = parseArgs(argc, argv);
+        spdlog::set_level(spdlog::level::err);  // Log lines would interleave with the JSON on stdout
+        Random::seed(options.seed);
+
+        nlohmann::json base;
+        std::ifstream file(options.configPath);
+        if (!file.is_open()) throw std::runtime_error("Commodity definitions not found: " + options.configPath);
+        file >> base;
+
+        std::ofstream out;
+        if (!options.outPath.empty()) {
+            out.open(options.outPath, std::ios::app);
+            if (!out.is_open()) throw std::runtime_error("Cannot write " + options.outPath);
+        }
+        std::ostream& sink = options.outPath.empty() ? std::cout : out;
+
+        for (int commodities : options.commodities) {
+            for (int agents : options.agents) {
+                for (int ticksPerDay : options.ticksPerDay) {
+                    nlohmann::json result = runScenario(options, base, commodities, agents, ticksPerDay);
+                    sink << result.dump() << std::endl;
+                    std::cerr << commodities << " commodities, " << agents << " agents: "
+                              << result["unloaded"]["ticksPerSec"].get<double>() << " ticks/s";
+                    if (result.contains("loaded")) {
+                        std::cerr << ", " << result["loaded"]["ticksPerSec"].get<double>() << " under load";
+                    }
+                    std::cerr << "\n";
+                }
+            }
+        }
+        return 0;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "market_loadtest: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -7,6 +7,7 @@
 #include "CrossEffectsTrader.hpp"
 #include "InventoryTrader.hpp"
 #include "EventTrader.hpp"
+#include "core/Checkpoint.hpp"
 #include "utils/Random.hpp"
 #include <algorithm>
 #include <cmath>
@@ -16,14 +17,12 @@ namespace market {
     Agent::Agent(AgentId id, double initialCash, const AgentParams& params,
         const RuntimeConfig* rtConfig)
         : id_(id)
-        , cash_(initialCash)
         , initialCash_(initialCash)
         , params_(params)
-        , rtConfig_(rtConfig)
+        , global_(rtConfig ? rtConfig->agentGlobal : RuntimeConfig::AgentGlobalParams{})
+        , rng_(Random::stream(id))
     {
-        if (rtConfig_) {
-            maxShortPosition_ = rtConfig_->agentGlobal.maxShortPosition;
-        }
+        state_.cash() = initialCash;
     }
 
     void Agent::onFill(const Trade& trade) {
@@ -32,19 +31,19 @@ namespace market {
         double cost = trade.price * trade.quantity;
 
         if (isBuyer) {
-            cash_ -= cost;
-            auto& pos = portfolio_[trade.symbol];
+            cashSlot() -= cost;
+            auto& pos = positionSlot(trade.symbolId);
             double totalCost = pos.avgCost * pos.quantity + cost;
             pos.quantity += trade.quantity;
             pos.avgCost = pos.quantity > 0 ? totalCost / pos.quantity : 0;
-            pos.symbol = trade.symbol;
+            pos.symbolId = trade.symbolId;
         }
         else {
-            cash_ += cost;
-            auto& pos = portfolio_[trade.symbol];
+            cashSlot() += cost;
+            auto& pos = positionSlot(trade.symbolId);
             pos.quantity -= trade.quantity;
             if (pos.quantity == 0) {
-                portfolio_.erase(trade.symbol);
+                pos = Position{};
             }
         }
     }
@@ -64,83 +63,115 @@ namespace market {
         switch (news.category) {
         case NewsCategory::GLOBAL:
         case NewsCategory::POLITICAL:
-            sentimentBias_ += signedImpact;
+            biasSlot() += signedImpact;
             break;
 
         case NewsCategory::SUPPLY:
-            if (!news.symbol.empty()) {
-                commoditySentiment_[news.symbol] += signedImpact;
+            if (news.symbolId != INVALID_SYMBOL_ID) {
+                sentimentSlot(news.symbolId) += signedImpact;
             }
-            sentimentBias_ += signedImpact * 0.2;
+            biasSlot() += signedImpact * 0.2;
             break;
 
         case NewsCategory::DEMAND:
-            if (!news.symbol.empty()) {
-                commoditySentiment_[news.symbol] += signedImpact;
+            if (news.symbolId != INVALID_SYMBOL_ID) {
+                sentimentSlot(news.symbolId) += signedImpact;
             }
-            sentimentBias_ += signedImpact * 0.2;
+            biasSlot() += signedImpact * 0.2;
             break;
         }
     }
 
     void Agent::decaySentiment(double tickScale) {
-        double dg = rtConfig_ ? rtConfig_->agentGlobal.sentimentDecayGlobal : 0.95;
-        double dc = rtConfig_ ? rtConfig_->agentGlobal.sentimentDecayCommodity : 0.90;
+        double dg = global_.sentimentDecayGlobal;
+        double dc = global_.sentimentDecayCommodity;
 
-        sentimentBias_ *= std::pow(dg, tickScale);
-        for (auto& [_, val] : commoditySentiment_) { val *= std::pow(dc, tickScale); }
+        scaleSentiment(std::pow(dg, tickScale), std::pow(dc, tickScale));
     }
 
-    double Agent::getCombinedSentiment(const std::string& symbol) const {
-        double combined = sentimentBias_ * 0.4;
+    void Agent::scaleSentiment(double biasFactor, double commodityFactor) {
+        biasSlot() *= biasFactor;
+        double* sentiment = state_.sentiment();
+        for (size_t symbol = 0; symbol < state_.symbols(); ++symbol) sentiment[symbol] *= commodityFactor;
+    }
 
-        auto it = commoditySentiment_.find(symbol);
-        if (it != commoditySentiment_.end()) {
-            combined += it->second;
+    void Agent::attachSentimentFeed(const SentimentFeed* feed) {
+        sentimentFeed_ = feed;
+        if (feed) {
+            newsCursor_ = feed->endSeq();
+            sentimentClock_ = feed->clock();
+        }
+    }
+
+    void Agent::syncSentiment() {
+        if (!sentimentFeed_) return;
+        const SentimentFeed& feed = *sentimentFeed_;
+
+        for (; newsCursor_ < feed.endSeq(); ++newsCursor_) {
+            const auto& entry = feed.at(newsCursor_);
+            if (entry.clock > sentimentClock_) {
+                decaySentiment(entry.clock - sentimentClock_);
+                sentimentClock_ = entry.clock;
+            }
+            updateBeliefs(entry.event);
+        }
+        if (feed.clock() > sentimentClock_) {
+            decaySentiment(feed.clock() - sentimentClock_);
+            sentimentClock_ = feed.clock();
+        }
+    }
+
+    double Agent::getCombinedSentiment(SymbolId symbol) const {
+        double combined = state_.sentimentBias() * 0.4;
+
+        if (symbol < state_.symbols()) {
+            combined += state_.sentiment()[symbol];
         }
 
         return combined;
     }
 
-    Volume Agent::getPosition(const std::string& symbol) const {
-        auto it = portfolio_.find(symbol);
-        return (it != portfolio_.end()) ? it->second.quantity : 0;
+    Volume Agent::getPosition(SymbolId symbol) const {
+        return symbol < state_.symbols() ? state_.positions()[symbol].quantity : 0;
     }
 
-    double Agent::getPortfolioValue(const std::map<std::string, Price>& prices) const {
+    double Agent::getPortfolioValue(ConstSpan<Price> prices) const {
         double value = 0.0;
-        for (const auto& [symbol, pos] : portfolio_) {
-            auto priceIt = prices.find(symbol);
-            if (priceIt != prices.end()) {
-                value += pos.quantity * priceIt->second;
-            }
+        const Position* portfolio = state_.positions();
+        size_t n = std::min(state_.symbols(), prices.size());
+        for (size_t symbol = 0; symbol < n; ++symbol) {
+            value += portfolio[symbol].quantity * prices[symbol];
         }
         return value;
     }
 
-    double Agent::getTotalValue(const std::map<std::string, Price>& prices) const {
-        return cash_ + getPortfolioValue(prices);
+    double Agent::getTotalValue(ConstSpan<Price> prices) const {
+        return state_.cash() + getPortfolioValue(prices);
     }
 
-    bool Agent::canBuy(const std::string& symbol, Volume quantity, Price price) const {
+    SymbolId Agent::pickSymbol(const MarketState& state) {
+        return static_cast<SymbolId>(Random::uniformInt(0, static_cast<int>(state.symbolCount()) - 1));
+    }
+
+    bool Agent::canBuy(SymbolId symbol, Volume quantity, Price price) const {
         double cost = price * quantity;
-        double reserveFrac = rtConfig_ ? rtConfig_->agentGlobal.cashReserve : 0.10;
+        double reserveFrac = global_.cashReserve;
         double reserve = initialCash_ * reserveFrac;
-        return cash_ >= (cost + reserve);
+        return state_.cash() >= (cost + reserve);
     }
 
-    bool Agent::canSell(const std::string& symbol, Volume quantity) const {
+    bool Agent::canSell(SymbolId symbol, Volume quantity) const {
         return getPosition(symbol) >= quantity;
     }
 
-    void Agent::seedInventory(const std::string& symbol, Volume quantity, Price price) {
-        auto& pos = portfolio_[symbol];
-        pos.symbol = symbol;
+    void Agent::seedInventory(SymbolId symbol, Volume quantity, Price price) {
+        auto& pos = positionSlot(symbol);
+        pos.symbolId = symbol;
         pos.quantity += quantity;
         pos.avgCost = price;
     }
 
-    Order Agent::createOrder(const std::string& symbol,
+    Order Agent::createOrder(SymbolId symbol,
         OrderSide side,
         OrderType type,
         Price price,
@@ -148,7 +179,7 @@ namespace market {
         Order order;
         order.id = 0;
         order.agentId = id_;
-        order.symbol = symbol;
+        order.symbolId = symbol;
         order.side = side;
         order.type = type;
         order.price = price;
@@ -158,15 +189,16 @@ namespace market {
     }
 
     Volume Agent::calculateOrderSize(Price price, double confidence) const {
-        if (price <= 0 || cash_ <= 0) return 0;
+        double cash = state_.cash();
+        if (price <= 0 || cash <= 0) return 0;
 
-        double capFrac = rtConfig_ ? rtConfig_->agentGlobal.capitalFraction : 0.05;
-        int    maxSize = rtConfig_ ? rtConfig_->agentGlobal.maxOrderSize : 500;
+        double capFrac = global_.capitalFraction;
+        int    maxSize = global_.maxOrderSize;
 
         double capitalFraction = capFrac / params_.riskAversion;
         double sizeFactor = capitalFraction * confidence;
 
-        double maxSpend = cash_ * std::min(sizeFactor, 0.05);
+        double maxSpend = cash * std::min(sizeFactor, 0.05);
         Volume size = static_cast<Volume>(maxSpend / price);
 
         size = std::min(size, static_cast<Volume>(maxSize));
@@ -174,6 +206,33 @@ namespace market {
         return std::max(Volume(1), size);
     }
 
+    void Agent::writeCheckpoint(CheckpointWriter& out) const {
+        out.write(state_.cash());
+        out.writeList(getPortfolio());
+        out.write(state_.sentimentBias());
+        out.writeArray(getCommoditySentiment());
+        out.write(newsCursor_);
+        out.write(sentimentClock_);
+        out.write(rng_);
+    }
+
+    void Agent::readCheckpoint(CheckpointReader& in) {
+        std::vector<Position> portfolio;
+        std::vector<double> sentiment;
+        in.read(cashSlot());
+        in.readList(portfolio);
+        in.read(biasSlot());
+        in.readArray(sentiment);
+        state_.ensureSymbols(std::max(portfolio.size(), sentiment.size()));
+        std::fill_n(state_.positions(), state_.symbols(), Position{});
+        std::fill_n(state_.sentiment(), state_.symbols(), 0.0);
+        std::copy(portfolio.begin(), portfolio.end(), state_.positions());
+        std::copy(sentiment.begin(), sentiment.end(), state_.sentiment());
+        in.read(newsCursor_);
+        in.read(sentimentClock_);
+        in.read(rng_);
+    }
+
     AgentParams AgentFactory::generateParams(const RuntimeConfig* cfg) {
         double raMean = cfg ? cfg->agentGen.riskAversionMean : 1.0;
         double raStd = cfg ? cfg->agentGen.riskAversionStd : 0.3;
@@ -228,6 +287,19 @@ namespace market {
         return std::make_unique<EventTrader>(id, cash, generateParams(cfg), cfg);
     }
 
+    std::unique_ptr<Agent> AgentFactory::create(std::string_view type, AgentId id, double cash,
+        const AgentParams& params, const RuntimeConfig* cfg) {
+        if (type == SupplyDemandTrader::TYPE) return std::make_unique<SupplyDemandTrader>(id, cash, params, cfg);
+        if (type == MomentumTrader::TYPE) return std::make_unique<MomentumTrader>(id, cash, params, cfg);
+        if (type == MeanReversionTrader::TYPE) return std::make_unique<MeanReversionTrader>(id, cash, params, cfg);
+        if (type == NoiseTrader::TYPE) return std::make_unique<NoiseTrader>(id, cash, params, cfg);
+        if (type == MarketMaker::TYPE) return std::make_unique<MarketMaker>(id, cash, params, cfg);
+        if (type == CrossEffectsTrader::TYPE) return std::make_unique<CrossEffectsTrader>(id, cash, params, cfg);
+        if (type == InventoryTrader::TYPE) return std::make_unique<InventoryTrader>(id, cash, params, cfg);
+        if (type == EventTrader::TYPE) return std::make_unique<EventTrader>(id, cash, params, cfg);
+        return nullptr;
+    }
+
     std::vector<std::unique_ptr<Agent>> AgentFactory::createPopulation(
         int numSupplyDemand,
         int numMomentum,
@@ -1,14 +1,22 @@
 #pragma once
 
+#include "AgentColumns.hpp"
 #include "core/Types.hpp"
+#include "core/OrderBatch.hpp"
 #include "core/RuntimeConfig.hpp"
+#include "core/SentimentFeed.hpp"
+#include "utils/Random.hpp"
 #include <memory>
 #include <optional>
 #include <string>
-#include <map>
+#include <string_view>
+#include <vector>
 
 namespace market {
 
+    class CheckpointWriter;
+    class CheckpointReader;
+
     class Agent {
     public:
         Agent(AgentId id, double initialCash, const AgentParams& params,
@@ -17,52 +25,154 @@ namespace market {
 
         virtual std::optional<Order> decide(const MarketState& state) = 0;
 
+        // What the engine calls each tick: appends any number of orders and
+        // cancels to `out`. The default submits decide()'s order, if any;
+        // agents that quote several books or manage resting orders override it.
+        virtual void decideBatch(const MarketState& state, OrderBatch& out) {
+            if (auto order = decide(state)) out.place(*order);
+        }
+
+        // After this agent's batch was applied, with the ids the engine gave its
+        // PLACE actions (0 when the symbol had no book)
+        virtual void onOrdersPlaced(ConstSpan<OrderAction> actions) { (void)actions; }
+
         virtual void onFill(const Trade& trade);
 
+        // All of this agent's fills from one tick, in trade order
+        virtual void onFills(ConstSpan<Trade> fills) {
+            for (const Trade& trade : fills) onFill(trade);
+        }
+
+        // Eager sentiment updates. Agents attached to a SentimentFeed get these
+        // calls from syncSentiment() instead of from the engine.
         virtual void updateBeliefs(const NewsEvent& news);
 
         virtual void decaySentiment(double tickScale = 1.0);
 
-        virtual std::string getType() const = 0;
+        // Reads news and decay from `feed` from its current position on
+        void attachSentimentFeed(const SentimentFeed* feed);
+
+        // Moves this agent's feed position to `other`'s; after attaching a
+        // clone to a copy of the feed `other` reads
+        void resumeSentimentFrom(const Agent& other) {
+            newsCursor_ = other.newsCursor_;
+            sentimentClock_ = other.sentimentClock_;
+        }
+
+        // Folds in unseen feed news, each after the decay up to its publish
+        // clock, then the decay up to now. No-op without a feed or when caught
+        // up; decide() calls it right before reading sentiment.
+        void syncSentiment();
+
+        // Static name of the concrete class; the engine interns it once at
+        // registration and tracks the agent by AgentTypeId from then on
+        virtual std::string_view getType() const = 0;
+
+        // Copy of this agent, random stream and all, with the settings of
+        // `cfg` (this agent's when null); for forked engines. Not attached
+        // to any feed.
+        virtual std::unique_ptr<Agent> clone(const RuntimeConfig* cfg) const = 0;
+
+        // Copies the settings decide() reads from `cfg` into this agent, so
+        // the hot path reads plain members. The engine calls it for every
+        // agent when a new config version takes effect, between ticks.
+        // Subclasses copy their own section and call the base.
+        virtual void applyConfig(const RuntimeConfig& cfg) { global_ = cfg.agentGlobal; }
 
         AgentId getId() const { return id_; }
-        double getCash() const { return cash_; }
-        const std::map<std::string, Position>& getPortfolio() const { return portfolio_; }
+        double getCash() const { return state_.cash(); }
+        double getInitialCash() const { return initialCash_; }
+        // Indexed by SymbolId; symbols never traded are absent or have quantity 0
+        ConstSpan<Position> getPortfolio() const { return { state_.positions(), state_.symbols() }; }
         const AgentParams& getParams() const { return params_; }
 
-        double getSentimentBias() const { return sentimentBias_; }
-        const std::map<std::string, double>& getCommoditySentiment() const { return commoditySentiment_; }
+        // Moves cash, positions and sentiment into a new row of `columns`,
+        // where they stay for this agent's lifetime; `columns` must outlive
+        // it. The engine does this at registration under the "columns"
+        // agent layout.
+        void bindColumns(AgentColumns& columns) { state_.bind(columns); }
+        bool isBoundToColumns() const { return state_.isBound(); }
+
+        // Private random stream for decide(), keyed by (seed, id) and re-based on
+        // the tick by the engine, so decisions do not depend on how agents are
+        // spread across threads or on how many draws earlier ticks made
+        Random::Engine& getRng() { return rng_; }
+
+        // Uniform (0, 1) draw for this tick's reaction gate. The engine fills
+        // these for all agents in one batch before the decision phase.
+        void setGateDraw(double u) { gateDraw_ = u; }
 
-        Volume getPosition(const std::string& symbol) const;
-        double getPortfolioValue(const std::map<std::string, Price>& prices) const;
-        double getTotalValue(const std::map<std::string, Price>& prices) const;
+        double getSentimentBias() const { return state_.sentimentBias(); }
+        // As of the last syncSentiment(); indexed by SymbolId, like getPortfolio()
+        ConstSpan<double> getCommoditySentiment() const { return { state_.sentiment(), state_.symbols() }; }
 
-        bool canBuy(const std::string& symbol, Volume quantity, Price price) const;
-        bool canSell(const std::string& symbol, Volume quantity) const;
+        Volume getPosition(SymbolId symbol) const;
+        double getPortfolioValue(ConstSpan<Price> prices) const;
+        double getTotalValue(ConstSpan<Price> prices) const;
 
-        void seedInventory(const std::string& symbol, Volume quantity, Price price);
+        bool canBuy(SymbolId symbol, Volume quantity, Price price) const;
+        bool canSell(SymbolId symbol, Volume quantity) const;
+
+        void seedInventory(SymbolId symbol, Volume quantity, Price price);
+
+        // Everything but the id, initial cash and params, which the engine
+        // writes ahead of this to construct the agent again (see
+        // AgentFactory::create). Subclasses with state of their own extend
+        // both and call the base first. readCheckpoint runs after the agent
+        // is registered with an engine, so its sentiment cursor is the saved one.
+        virtual void writeCheckpoint(CheckpointWriter& out) const;
+        virtual void readCheckpoint(CheckpointReader& in);
 
     protected:
         AgentId id_;
-        double cash_;
         double initialCash_;
-        std::map<std::string, Position> portfolio_;
         AgentParams params_;
-        const RuntimeConfig* rtConfig_ = nullptr;
+        RuntimeConfig::AgentGlobalParams global_;  // agentGlobal of the config in force
+
+        AgentRow state_;  // Cash, portfolio, sentiment bias and per-symbol sentiment
+        const SentimentFeed* sentimentFeed_ = nullptr;
+        uint64_t newsCursor_ = 0;       // Next feed entry to fold in
+        double sentimentClock_ = 0.0;   // Feed clock the values above are at
+        Random::Engine rng_;
+        double gateDraw_ = 0.0;
+
+        double getCombinedSentiment(SymbolId symbol) const;
+
+        template <typename Derived>
+        std::unique_ptr<Agent> cloneAs(const RuntimeConfig* cfg) const {
+            auto copy = std::make_unique<Derived>(static_cast<const Derived&>(*this));
+            Agent& base = *copy;
+            if (cfg) base.applyConfig(*cfg);
+            base.sentimentFeed_ = nullptr;
+            return copy;
+        }
 
-        double sentimentBias_ = 0.0;
-        std::map<std::string, double> commoditySentiment_;
-        int maxShortPosition_ = 20;
+        double& cashSlot() { return state_.cash(); }
+        double& biasSlot() { return state_.sentimentBias(); }
 
-        double getCombinedSentiment(const std::string& symbol) const;
+        // Dense per-symbol slots, grown on first touch
+        Position& positionSlot(SymbolId symbol) {
+            state_.ensureSymbols(symbol + 1);
+            return state_.positions()[symbol];
+        }
+        double& sentimentSlot(SymbolId symbol) {
+            state_.ensureSymbols(symbol + 1);
+            return state_.sentiment()[symbol];
+        }
+
+        // Multiplies the sentiment bias and every per-symbol sentiment
+        void scaleSentiment(double biasFactor, double commodityFactor);
+
+        // Uniformly random symbol id; state must have at least one symbol
+        static SymbolId pickSymbol(const MarketState& state);
 
         // Maximum volume an agent may sell for a given symbol, allowing
-        // bounded short-selling up to maxShortPosition_ units beyond zero.
-        Volume getMaxSellable(const std::string& symbol) const {
-            return getPosition(symbol) + static_cast<Volume>(maxShortPosition_);
+        // bounded short-selling up to maxShortPosition units beyond zero.
+        Volume getMaxSellable(SymbolId symbol) const {
+            return getPosition(symbol) + static_cast<Volume>(global_.maxShortPosition);
         }
 
-        Order createOrder(const std::string& symbol,
+        Order createOrder(SymbolId symbol,
             OrderSide side,
             OrderType type,
             Price price,
@@ -82,6 +192,10 @@ namespace market {
         static std::unique_ptr<Agent> createInventoryTrader(AgentId id, double cash, const RuntimeConfig* cfg = nullptr);
         static std::unique_ptr<Agent> createEventTrader(AgentId id, double cash, const RuntimeConfig* cfg = nullptr);
 
+        // By getType() name, e.g. when restoring a checkpoint; null if unknown
+        static std::unique_ptr<Agent> create(std::string_view type, AgentId id, double cash,
+            const AgentParams& params, const RuntimeConfig* cfg = nullptr);
+
         static std::vector<std::unique_ptr<Agent>> createPopulation(
             int numSupplyDemand,
             int numMomentum,
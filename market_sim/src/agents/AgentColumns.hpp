@@ -0,0 +1,142 @@
+#pragma once
+
+#include "core/Types.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace market {
+
+    // Hot state of a population of agents in contiguous columns, one row per
+    // agent: cash and sentiment bias are one column each, and positions and
+    // per-symbol sentiment are rows x symbols blocks, so one agent's slots
+    // are adjacent and a pass over the population walks memory in order.
+    // The engine owns one when the "columns" agent layout is selected (see
+    // Agent::bindColumns); an agent outside an engine keeps a one-row store
+    // of its own.
+    //
+    // Agents refer to their row by index, so adding rows moves nothing they
+    // hold. Widening rewrites every row and is not safe while agents run;
+    // the engine widens when a symbol is added, between ticks.
+    class AgentColumns {
+    public:
+        size_t rows() const { return cash_.size(); }
+        size_t symbols() const { return symbols_; }
+
+        void reserve(size_t rows) {
+            cash_.reserve(rows);
+            bias_.reserve(rows);
+            positions_.reserve(rows * symbols_);
+            sentiment_.reserve(rows * symbols_);
+        }
+
+        // Appends a zeroed row and returns its index
+        size_t addRow() {
+            cash_.push_back(0.0);
+            bias_.push_back(0.0);
+            positions_.resize(positions_.size() + symbols_);
+            sentiment_.resize(sentiment_.size() + symbols_, 0.0);
+            return cash_.size() - 1;
+        }
+
+        // Gives every row at least `symbols` slots; existing values keep their symbol
+        void ensureSymbols(size_t symbols) {
+            if (symbols <= symbols_) return;
+            std::vector<Position> positions(rows() * symbols);
+            std::vector<double> sentiment(rows() * symbols, 0.0);
+            for (size_t row = 0; row < rows(); ++row) {
+                std::copy_n(positions_.begin() + row * symbols_, symbols_, positions.begin() + row * symbols);
+                std::copy_n(sentiment_.begin() + row * symbols_, symbols_, sentiment.begin() + row * symbols);
+            }
+            positions_ = std::move(positions);
+            sentiment_ = std::move(sentiment);
+            symbols_ = symbols;
+        }
+
+        void clear() {
+            cash_.clear();
+            bias_.clear();
+            positions_.clear();
+            sentiment_.clear();
+            symbols_ = 0;
+        }
+
+        double& cash(size_t row) { return cash_[row]; }
+        double cash(size_t row) const { return cash_[row]; }
+        double& sentimentBias(size_t row) { return bias_[row]; }
+        double sentimentBias(size_t row) const { return bias_[row]; }
+
+        // `symbols()` slots each, indexed by SymbolId
+        Position* positions(size_t row) { return positions_.data() + row * symbols_; }
+        const Position* positions(size_t row) const { return positions_.data() + row * symbols_; }
+        double* sentiment(size_t row) { return sentiment_.data() + row * symbols_; }
+        const double* sentiment(size_t row) const { return sentiment_.data() + row * symbols_; }
+
+        // Whole columns, by row
+        ConstSpan<double> cashColumn() const { return cash_; }
+        ConstSpan<double> biasColumn() const { return bias_; }
+
+    private:
+        size_t symbols_ = 0;
+        std::vector<double> cash_;
+        std::vector<double> bias_;
+        std::vector<Position> positions_;  // rows x symbols_
+        std::vector<double> sentiment_;    // rows x symbols_
+    };
+
+    // One agent's row: in a one-row AgentColumns of its own until bound to
+    // a shared one. Copying copies the values into a store of the copy's own.
+    class AgentRow {
+    public:
+        AgentRow() : own_(std::make_unique<AgentColumns>()), columns_(own_.get()), row_(own_->addRow()) {}
+        AgentRow(const AgentRow& other) : AgentRow() { assign(other); }
+        AgentRow& operator=(const AgentRow& other) {
+            if (this != &other) assign(other);
+            return *this;
+        }
+
+        // Moves the values to a new row of `columns`, which holds them from then on
+        void bind(AgentColumns& columns) {
+            columns.ensureSymbols(symbols());
+            size_t row = columns.addRow();
+            columns.cash(row) = cash();
+            columns.sentimentBias(row) = sentimentBias();
+            std::copy_n(positions(), symbols(), columns.positions(row));
+            std::copy_n(sentiment(), symbols(), columns.sentiment(row));
+            columns_ = &columns;
+            row_ = row;
+            own_.reset();
+        }
+        bool isBound() const { return own_ == nullptr; }
+
+        size_t symbols() const { return columns_->symbols(); }
+        // Widens a row of its own in place; a bound row must already be wide enough
+        void ensureSymbols(size_t symbols) {
+            if (symbols > columns_->symbols()) columns_->ensureSymbols(symbols);
+        }
+
+        double& cash() { return columns_->cash(row_); }
+        double cash() const { return columns_->cash(row_); }
+        double& sentimentBias() { return columns_->sentimentBias(row_); }
+        double sentimentBias() const { return columns_->sentimentBias(row_); }
+        Position* positions() { return columns_->positions(row_); }
+        const Position* positions() const { return columns_->positions(row_); }
+        double* sentiment() { return columns_->sentiment(row_); }
+        const double* sentiment() const { return columns_->sentiment(row_); }
+
+    private:
+        std::unique_ptr<AgentColumns> own_;
+        AgentColumns* columns_;
+        size_t row_;
+
+        void assign(const AgentRow& other) {
+            ensureSymbols(other.symbols());
+            cash() = other.cash();
+            sentimentBias() = other.sentimentBias();
+            std::copy_n(other.positions(), other.symbols(), positions());
+            std::copy_n(other.sentiment(), other.symbols(), sentiment());
+        }
+    };
+
+} // namespace market
@@ -0,0 +1,67 @@
+#include "AgentKernels.hpp"
+#include "SupplyDemandTrader.hpp"
+#include "MomentumTrader.hpp"
+#include "MeanReversionTrader.hpp"
+#include "NoiseTrader.hpp"
+#include "MarketMaker.hpp"
+#include "CrossEffectsTrader.hpp"
+#include "InventoryTrader.hpp"
+#include "EventTrader.hpp"
+#include "utils/Random.hpp"
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+
+namespace market {
+
+    namespace {
+
+        // True when T declares its own decideBatch rather than inheriting
+        // Agent's, which would call decide() back through the vtable
+        template <typename T>
+        constexpr bool overridesDecideBatch =
+            !std::is_same_v<decltype(&T::decideBatch), decltype(&Agent::decideBatch)>;
+
+        template <typename T>
+        void decideRun(const AgentKernels::AgentPtr* agents, size_t count, const MarketState& state,
+                       const double* gateDraws, uint64_t tick, OrderBatch* out) {
+            for (size_t i = 0; i < count; ++i) {
+                T& agent = static_cast<T&>(*agents[i]);
+                agent.setGateDraw(gateDraws[i]);
+                agent.getRng().seek(tick);
+                Random::StreamScope stream(agent.getRng());
+                out[i].clear();
+                if constexpr (std::is_same_v<T, Agent> || overridesDecideBatch<T>) {
+                    agent.decideBatch(state, out[i]);
+                }
+                else if (auto order = agent.decide(state)) {
+                    out[i].place(*order);
+                }
+            }
+        }
+
+        template <typename T>
+        AgentKernels kernelsOf() {
+            return AgentKernels{ &decideRun<T> };
+        }
+
+    } // namespace
+
+    const AgentKernels& AgentKernels::forAgent(const Agent& agent) {
+        static const std::unordered_map<std::type_index, AgentKernels> typed = {
+            { typeid(SupplyDemandTrader), kernelsOf<SupplyDemandTrader>() },
+            { typeid(MomentumTrader), kernelsOf<MomentumTrader>() },
+            { typeid(MeanReversionTrader), kernelsOf<MeanReversionTrader>() },
+            { typeid(NoiseTrader), kernelsOf<NoiseTrader>() },
+            { typeid(MarketMaker), kernelsOf<MarketMaker>() },
+            { typeid(CrossEffectsTrader), kernelsOf<CrossEffectsTrader>() },
+            { typeid(InventoryTrader), kernelsOf<InventoryTrader>() },
+            { typeid(EventTrader), kernelsOf<EventTrader>() },
+        };
+        static const AgentKernels generic = kernelsOf<Agent>();
+
+        auto it = typed.find(typeid(agent));
+        return it != typed.end() ? it->second : generic;
+    }
+
+} // namespace market
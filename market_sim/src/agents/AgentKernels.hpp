@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Agent.hpp"
+#include <cstdint>
+#include <memory>
+
+namespace market {
+
+    // Batch loops over a contiguous run of agents that share one concrete type.
+    // Every agent class is final, so the calls inside a typed kernel bind
+    // directly instead of paying one virtual dispatch per agent.
+    struct AgentKernels {
+        using AgentPtr = std::unique_ptr<Agent>;
+
+        // Refills out[i] from agents[i]->decideBatch(state), after handing each
+        // agent its gate draw and re-basing its RNG stream on `tick`
+        void (*decide)(const AgentPtr* agents, size_t count, const MarketState& state,
+                       const double* gateDraws, uint64_t tick, OrderBatch* out);
+
+        // Kernels for the agent's dynamic type; types without a typed kernel
+        // (e.g. test doubles) get loops that dispatch virtually
+        static const AgentKernels& forAgent(const Agent& agent);
+    };
+
+    // A run [begin, end) of agents_ handled by one kernel set
+    struct AgentRun {
+        size_t begin = 0;
+        size_t end = 0;
+        const AgentKernels* kernels = nullptr;
+    };
+
+} // namespace market
@@ -1,5 +1,8 @@
 #include "CrossEffectsTrader.hpp"
+#include "core/Checkpoint.hpp"
+#include "core/CrossEffectMatrix.hpp"
 #include "utils/Random.hpp"
+#include <algorithm>
 #include <cmath>
 
 namespace market {
@@ -7,6 +10,7 @@ namespace market {
     CrossEffectsTrader::CrossEffectsTrader(AgentId id, double cash, const AgentParams& params,
         const RuntimeConfig* cfg)
         : Agent(id, cash, params, cfg)
+        , config_(cfg ? cfg->crossEffects : RuntimeConfig::CrossEffectsParams{})
     {
         int lbMin = cfg ? cfg->crossEffects.lookbackMin : 5;
         int lbRange = cfg ? cfg->crossEffects.lookbackRange : 10;
@@ -18,49 +22,48 @@ namespace market {
     }
 
     std::optional<Order> CrossEffectsTrader::decide(const MarketState& state) {
-        double rMult = rtConfig_ ? rtConfig_->crossEffects.reactionMult : 0.2;
-        double ceW = rtConfig_ ? rtConfig_->crossEffects.crossEffectWeight : 0.3;
+        double rMult = config_.reactionMult;
+        double ceW = config_.crossEffectWeight;
 
-        if (Random::uniform(0, 1) > params_.reactionSpeed * rMult * state.tickScale) {
+        if (gateDraw_ > params_.reactionSpeed * rMult * state.tickScale) {
             return std::nullopt;
         }
 
-        if (state.prices.empty() || state.crossEffects.empty()) return std::nullopt;
+        if (state.prices.empty() || !state.crossEffects || state.crossEffects->empty()) return std::nullopt;
+        const CrossEffectMatrix& effects = *state.crossEffects;
+        size_t n = std::min(effects.size(), state.symbolCount());
+        if (state.returns.size() < n || state.impliedMoves.size() < n) return std::nullopt;
 
-        for (const auto& [symbol, price] : state.prices) {
-            lastPrices_[symbol] = price;
+        // React only when some source with effects moved past this trader's
+        // threshold; targets are then judged on the combined implied move
+        bool triggered = false;
+        for (SymbolId source = 0; source < n && !triggered; ++source) {
+            triggered = effects.hasEffects(source) && std::abs(state.returns[source]) > threshold_;
         }
+        if (!triggered) return std::nullopt;
 
-        for (const auto& [sourceSymbol, effects] : state.crossEffects) {
-            double sourceChange = detectPriceChange(sourceSymbol, state.prices.at(sourceSymbol));
+        for (SymbolId target = 0; target < n; ++target) {
+            Price targetPrice = state.prices[target];
+            double expectedTargetChange = state.impliedMoves[target] * ceW;
 
-            if (std::abs(sourceChange) > threshold_) {
-                for (const auto& effect : effects) {
-                    auto targetIt = state.prices.find(effect.targetSymbol);
-                    if (targetIt == state.prices.end()) continue;
+            if (expectedTargetChange > 0.01) {
+                double confidence = std::min(1.0, expectedTargetChange / 0.05);
+                Volume size = calculateOrderSize(targetPrice, confidence);
 
-                    double expectedTargetChange = sourceChange * effect.coefficient * ceW;
-
-                    if (expectedTargetChange > 0.01) {
-                        double confidence = std::min(1.0, expectedTargetChange / 0.05);
-                        Volume size = calculateOrderSize(targetIt->second, confidence);
-
-                        if (size > 0 && canBuy(effect.targetSymbol, size, targetIt->second)) {
-                            Price limitPrice = targetIt->second * (1.0 + Random::uniform(0, 0.003));
-                            return createOrder(effect.targetSymbol, OrderSide::BUY, OrderType::LIMIT, limitPrice, size);
-                        }
-                    }
-                    else if (expectedTargetChange < -0.01) {
-                        Volume maxSellable = getMaxSellable(effect.targetSymbol);
-                        if (maxSellable > 0) {
-                            double confidence = std::min(1.0, std::abs(expectedTargetChange) / 0.05);
-                            Volume size = std::min(maxSellable, calculateOrderSize(targetIt->second, confidence));
-
-                            if (size > 0) {
-                                Price limitPrice = targetIt->second * (1.0 - Random::uniform(0, 0.003));
-                                return createOrder(effect.targetSymbol, OrderSide::SELL, OrderType::LIMIT, limitPrice, size);
-                            }
-                        }
+                if (size > 0 && canBuy(target, size, targetPrice)) {
+                    Price limitPrice = targetPrice * (1.0 + Random::uniform(0, 0.003));
+                    return createOrder(target, OrderSide::BUY, OrderType::LIMIT, limitPrice, size);
+                }
+            }
+            else if (expectedTargetChange < -0.01) {
+                Volume maxSellable = getMaxSellable(target);
+                if (maxSellable > 0) {
+                    double confidence = std::min(1.0, std::abs(expectedTargetChange) / 0.05);
+                    Volume size = std::min(maxSellable, calculateOrderSize(targetPrice, confidence));
+
+                    if (size > 0) {
+                        Price limitPrice = targetPrice * (1.0 - Random::uniform(0, 0.003));
+                        return createOrder(target, OrderSide::SELL, OrderType::LIMIT, limitPrice, size);
                     }
                 }
             }
@@ -69,13 +72,16 @@ namespace market {
         return std::nullopt;
     }
 
-    double CrossEffectsTrader::detectPriceChange(const std::string& symbol, Price currentPrice) {
-        auto it = lastPrices_.find(symbol);
-        if (it == lastPrices_.end() || it->second <= 0) {
-            return 0.0;
-        }
+    void CrossEffectsTrader::writeCheckpoint(CheckpointWriter& out) const {
+        Agent::writeCheckpoint(out);
+        out.write(lookbackPeriod_);
+        out.write(threshold_);
+    }
 
-        return (currentPrice - it->second) / it->second;
+    void CrossEffectsTrader::readCheckpoint(CheckpointReader& in) {
+        Agent::readCheckpoint(in);
+        in.read(lookbackPeriod_);
+        in.read(threshold_);
     }
 
 } // namespace market
@@ -2,24 +2,28 @@
 
 #include "Agent.hpp"
 #include <string>
-#include <map>
+#include <vector>
 
 namespace market {
 
-    class CrossEffectsTrader : public Agent {
+    class CrossEffectsTrader final : public Agent {
     public:
         CrossEffectsTrader(AgentId id, double cash, const AgentParams& params,
             const RuntimeConfig* cfg = nullptr);
 
         std::optional<Order> decide(const MarketState& state) override;
-        std::string getType() const override { return "CrossEffectsTrader"; }
+        static constexpr std::string_view TYPE = "CrossEffectsTrader";
+        std::string_view getType() const override { return TYPE; }
+        std::unique_ptr<Agent> clone(const RuntimeConfig* cfg) const override { return cloneAs<CrossEffectsTrader>(cfg); }
+        void applyConfig(const RuntimeConfig& cfg) override { Agent::applyConfig(cfg); config_ = cfg.crossEffects; }
+
+        void writeCheckpoint(CheckpointWriter& out) const override;
+        void readCheckpoint(CheckpointReader& in) override;
 
     private:
+        RuntimeConfig::CrossEffectsParams config_;  // This type's section of the config in force
         int lookbackPeriod_;
         double threshold_;
-        std::map<std::string, double> lastPrices_;
-
-        double detectPriceChange(const std::string& symbol, Price currentPrice);
     };
 
 } // namespace market
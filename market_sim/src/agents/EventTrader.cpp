@@ -1,4 +1,5 @@
 #include "EventTrader.hpp"
+#include "core/Checkpoint.hpp"
 #include "utils/Random.hpp"
 #include <cmath>
 #include <algorithm>
@@ -8,6 +9,7 @@ namespace market {
     EventTrader::EventTrader(AgentId id, double cash, const AgentParams& params,
         const RuntimeConfig* cfg)
         : Agent(id, cash, params, cfg)
+        , config_(cfg ? cfg->event : RuntimeConfig::EventParams{})
     {
         double thrBase = cfg ? cfg->event.reactionThresholdBase : 0.03;
         double thrScale = cfg ? cfg->event.reactionThresholdRiskScale : 0.02;
@@ -20,11 +22,11 @@ namespace market {
     }
 
     std::optional<Order> EventTrader::decide(const MarketState& state) {
-        double rMult = rtConfig_ ? rtConfig_->event.reactionMult : 0.5;
+        double rMult = config_.reactionMult;
 
         ticksSinceLastTrade_++;
 
-        if (Random::uniform(0, 1) > params_.reactionSpeed * rMult * state.tickScale) {
+        if (gateDraw_ > params_.reactionSpeed * rMult * state.tickScale) {
             return std::nullopt;
         }
 
@@ -36,7 +38,7 @@ namespace market {
 
         for (const auto& news : state.recentNews) {
             bool alreadyProcessed = std::any_of(processedNews_.begin(), processedNews_.end(),
-                [&news](const NewsEvent& e) { return e.timestamp == news.timestamp && e.symbol == news.symbol; });
+                [&news](const NewsEvent& e) { return e.timestamp == news.timestamp && e.symbolId == news.symbolId; });
 
             if (alreadyProcessed) continue;
 
@@ -47,17 +49,14 @@ namespace market {
 
             if (news.magnitude < reactionThreshold_) continue;
 
-            std::string targetSymbol = news.symbol;
-            if (targetSymbol.empty() && news.category == NewsCategory::GLOBAL) {
-                auto it = state.prices.begin();
-                std::advance(it, Random::uniformInt(0, state.prices.size() - 1));
-                targetSymbol = it->first;
+            SymbolId targetSymbol = news.symbolId;
+            if (targetSymbol == INVALID_SYMBOL_ID && news.category == NewsCategory::GLOBAL) {
+                targetSymbol = pickSymbol(state);
             }
 
-            auto priceIt = state.prices.find(targetSymbol);
-            if (priceIt == state.prices.end()) continue;
+            if (targetSymbol >= state.symbolCount()) continue;
 
-            Price price = priceIt->second;
+            Price price = state.prices[targetSymbol];
             double confidence = std::min(1.0, news.magnitude / 0.1);
 
             bool isPositive = (news.sentiment == NewsSentiment::POSITIVE) ||
@@ -84,4 +83,22 @@ namespace market {
         return std::nullopt;
     }
 
+    void EventTrader::writeCheckpoint(CheckpointWriter& out) const {
+        Agent::writeCheckpoint(out);
+        out.write(reactionThreshold_);
+        out.write(cooldownTicks_);
+        out.write(ticksSinceLastTrade_);
+        out.writeList(processedNews_);
+    }
+
+    void EventTrader::readCheckpoint(CheckpointReader& in) {
+        Agent::readCheckpoint(in);
+        in.read(reactionThreshold_);
+        in.read(cooldownTicks_);
+        in.read(ticksSinceLastTrade_);
+        std::vector<NewsEvent> processed;
+        in.readList(processed);
+        processedNews_.assign(processed.begin(), processed.end());
+    }
+
 } // namespace market
@@ -6,15 +6,22 @@
 
 namespace market {
 
-    class EventTrader : public Agent {
+    class EventTrader final : public Agent {
     public:
         EventTrader(AgentId id, double cash, const AgentParams& params,
             const RuntimeConfig* cfg = nullptr);
 
         std::optional<Order> decide(const MarketState& state) override;
-        std::string getType() const override { return "EventTrader"; }
+        static constexpr std::string_view TYPE = "EventTrader";
+        std::string_view getType() const override { return TYPE; }
+        std::unique_ptr<Agent> clone(const RuntimeConfig* cfg) const override { return cloneAs<EventTrader>(cfg); }
+        void applyConfig(const RuntimeConfig& cfg) override { Agent::applyConfig(cfg); config_ = cfg.event; }
+
+        void writeCheckpoint(CheckpointWriter& out) const override;
+        void readCheckpoint(CheckpointReader& in) override;
 
     private:
+        RuntimeConfig::EventParams config_;  // This type's section of the config in force
         double reactionThreshold_;
         int cooldownTicks_;
         int ticksSinceLastTrade_;
@@ -1,4 +1,5 @@
 #include "InventoryTrader.hpp"
+#include "core/Checkpoint.hpp"
 #include "utils/Random.hpp"
 #include <cmath>
 
@@ -7,6 +8,7 @@ namespace market {
     InventoryTrader::InventoryTrader(AgentId id, double cash, const AgentParams& params,
         const RuntimeConfig* cfg)
         : Agent(id, cash, params, cfg)
+        , config_(cfg ? cfg->inventory : RuntimeConfig::InventoryParams{})
     {
         double tirBase = cfg ? cfg->inventory.targetRatioBase : 0.1;
         double tirRange = cfg ? cfg->inventory.targetRatioRange : 0.05;
@@ -18,9 +20,9 @@ namespace market {
     }
 
     std::optional<Order> InventoryTrader::decide(const MarketState& state) {
-        double rMult = rtConfig_ ? rtConfig_->inventory.reactionMult : 0.15;
+        double rMult = config_.reactionMult;
 
-        if (Random::uniform(0, 1) > params_.reactionSpeed * rMult * state.tickScale) {
+        if (gateDraw_ > params_.reactionSpeed * rMult * state.tickScale) {
             return std::nullopt;
         }
 
@@ -29,11 +31,12 @@ namespace market {
         double totalValue = getTotalValue(state.prices);
         double targetInventoryValue = totalValue * targetInventoryRatio_;
 
-        std::string bestSymbol;
+        SymbolId bestSymbol = INVALID_SYMBOL_ID;
         double bestDeviation = 0.0;
         OrderSide bestSide = OrderSide::BUY;
 
-        for (const auto& [symbol, price] : state.prices) {
+        for (SymbolId symbol = 0; symbol < state.symbolCount(); ++symbol) {
+            Price price = state.prices[symbol];
             Volume position = getPosition(symbol);
             double positionValue = position * price;
             double deviation = (positionValue - targetInventoryValue / state.prices.size()) / (totalValue > 0 ? totalValue : 1.0);
@@ -49,7 +52,7 @@ namespace market {
             return std::nullopt;
         }
 
-        Price price = state.prices.at(bestSymbol);
+        Price price = state.prices[bestSymbol];
         double confidence = std::min(1.0, std::abs(bestDeviation) / 0.1);
         Volume size = calculateOrderSize(price, confidence);
 
@@ -71,4 +74,16 @@ namespace market {
         return std::nullopt;
     }
 
+    void InventoryTrader::writeCheckpoint(CheckpointWriter& out) const {
+        Agent::writeCheckpoint(out);
+        out.write(targetInventoryRatio_);
+        out.write(rebalanceThreshold_);
+    }
+
+    void InventoryTrader::readCheckpoint(CheckpointReader& in) {
+        Agent::readCheckpoint(in);
+        in.read(targetInventoryRatio_);
+        in.read(rebalanceThreshold_);
+    }
+
 } // namespace market
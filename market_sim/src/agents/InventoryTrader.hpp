@@ -5,15 +5,22 @@
 
 namespace market {
 
-    class InventoryTrader : public Agent {
+    class InventoryTrader final : public Agent {
     public:
         InventoryTrader(AgentId id, double cash, const AgentParams& params,
             const RuntimeConfig* cfg = nullptr);
 
         std::optional<Order> decide(const MarketState& state) override;
-        std::string getType() const override { return "InventoryTrader"; }
+        static constexpr std::string_view TYPE = "InventoryTrader";
+        std::string_view getType() const override { return TYPE; }
+        std::unique_ptr<Agent> clone(const RuntimeConfig* cfg) const override { return cloneAs<InventoryTrader>(cfg); }
+        void applyConfig(const RuntimeConfig& cfg) override { Agent::applyConfig(cfg); config_ = cfg.inventory; }
+
+        void writeCheckpoint(CheckpointWriter& out) const override;
+        void readCheckpoint(CheckpointReader& in) override;
 
     private:
+        RuntimeConfig::InventoryParams config_;  // This type's section of the config in force
         double targetInventoryRatio_;
         double rebalanceThreshold_;
     };
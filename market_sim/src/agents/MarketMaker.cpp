@@ -1,4 +1,6 @@
 #include "MarketMaker.hpp"
+#include "core/Checkpoint.hpp"
+#include "core/PriceIndicators.hpp"
 #include "utils/Random.hpp"
 #include <cmath>
 #include <algorithm>
@@ -8,6 +10,7 @@ namespace market {
     MarketMaker::MarketMaker(AgentId id, double cash, const AgentParams& params,
         const RuntimeConfig* cfg)
         : Agent(id, cash, params, cfg)
+        , config_(cfg ? cfg->marketMaker : RuntimeConfig::MarketMakerParams{})
     {
         double bsMin = cfg ? cfg->marketMaker.baseSpreadMin : 0.001;
         double bsMax = cfg ? cfg->marketMaker.baseSpreadMax : 0.003;
@@ -21,18 +24,18 @@ namespace market {
         maxInventory_ = miMin + Random::uniformInt(0, miMax - miMin);
     }
 
-    double MarketMaker::calculateSpread(const std::string& symbol, double volatility) const {
-        double volMult = rtConfig_ ? rtConfig_->marketMaker.volatilitySpreadMult : 10.0;
+    double MarketMaker::calculateSpread(SymbolId symbol, double volatility) const {
+        double volMult = config_.volatilitySpreadMult;
         return baseSpread_ * (1.0 + volatility * volMult);
     }
 
-    double MarketMaker::calculateSkew(const std::string& symbol) const {
+    double MarketMaker::calculateSkew(SymbolId symbol) const {
         Volume inventory = getPosition(symbol);
         return inventory * inventorySkew_;
     }
 
     std::optional<Order> MarketMaker::decide(const MarketState& state) {
-        if (state.tickScale < 1.0 && Random::uniform(0.0, 1.0) > state.tickScale) {
+        if (state.tickScale < 1.0 && gateDraw_ > state.tickScale) {
             return std::nullopt;
         }
         auto quotes = quoteMarket(state);
@@ -42,30 +45,58 @@ namespace market {
         return std::nullopt;
     }
 
+    void MarketMaker::decideBatch(const MarketState& state, OrderBatch& out) {
+        if (state.tickScale < 1.0 && gateDraw_ > state.tickScale) {
+            return;
+        }
+
+        // Older quotes may have filled or expired since; cancelling a missing
+        // order is a no-op, so there is no need to track that here
+        for (SymbolId symbol = 0; symbol < activeQuotes_.size(); ++symbol) {
+            Quote& quote = activeQuotes_[symbol];
+            if (quote.bid != 0) out.cancel(symbol, quote.bid);
+            if (quote.ask != 0) out.cancel(symbol, quote.ask);
+            quote = Quote{};
+        }
+
+        quotes_.clear();
+        appendQuotes(state, quotes_);
+        for (const Order& order : quotes_) out.place(order);
+    }
+
+    void MarketMaker::onOrdersPlaced(ConstSpan<OrderAction> actions) {
+        for (const OrderAction& action : actions) {
+            const Order& order = action.order;
+            if (action.kind != OrderAction::Kind::PLACE || order.id == 0) continue;
+            if (order.symbolId >= activeQuotes_.size()) activeQuotes_.resize(order.symbolId + 1);
+            Quote& quote = activeQuotes_[order.symbolId];
+            (order.side == OrderSide::BUY ? quote.bid : quote.ask) = order.id;
+        }
+    }
+
     std::vector<Order> MarketMaker::quoteMarket(const MarketState& state) {
         std::vector<Order> orders;
-        double sentSpreadMult = rtConfig_ ? rtConfig_->marketMaker.sentimentSpreadMult : 0.5;
-        double qCapFrac = rtConfig_ ? rtConfig_->marketMaker.quoteCapitalFrac : 0.02;
+        appendQuotes(state, orders);
+        return orders;
+    }
+
+    void MarketMaker::appendQuotes(const MarketState& state, std::vector<Order>& orders) {
+        double sentSpreadMult = config_.sentimentSpreadMult;
+        double qCapFrac = config_.quoteCapitalFrac;
+
+        syncSentiment();
 
-        for (const auto& [symbol, price] : state.prices) {
+        for (SymbolId symbol = 0; symbol < state.symbolCount(); ++symbol) {
+            Price price = state.prices[symbol];
             if (price <= 0) continue;
 
             double volatility = 0.02;
-            auto histIt = state.priceHistory.find(symbol);
-            if (histIt != state.priceHistory.end() && histIt->second.size() > 20) {
-                const auto& history = histIt->second;
-                double sumSq = 0;
-                for (size_t i = history.size() - 20; i < history.size() - 1; ++i) {
-                    if (history[i] > 0) {
-                        double ret = (history[i + 1] - history[i]) / history[i];
-                        sumSq += ret * ret;
-                    }
-                }
-                volatility = std::sqrt(sumSq / 20);
+            if (symbol < state.indicators.size() && state.indicators[symbol]->size() > 20) {
+                volatility = std::sqrt(state.indicators[symbol]->sumSquaredReturns(20) / 20);
             }
 
             double spread = calculateSpread(symbol, volatility);
-            spread *= (1.0 + std::abs(sentimentBias_) * sentSpreadMult);
+            spread *= (1.0 + std::abs(getSentimentBias()) * sentSpreadMult);
 
             double skew = calculateSkew(symbol);
 
@@ -74,9 +105,8 @@ namespace market {
             // directional orders, not through MM quote-shifting).
             double midPrice = price;
 
-            auto sdIt = state.supplyDemand.find(symbol);
-            if (sdIt != state.supplyDemand.end()) {
-                double imbalance = sdIt->second.getImbalance();
+            if (symbol < state.supplyDemand.size()) {
+                double imbalance = state.supplyDemand[symbol].getImbalance();
                 // Widen spread when supply/demand is unbalanced (more uncertainty)
                 spread *= (1.0 + std::abs(imbalance) * 2.0);
             }
@@ -95,7 +125,7 @@ namespace market {
 
             Volume inventory = getPosition(symbol);
 
-            Volume baseSize = static_cast<Volume>(cash_ * qCapFrac / price);
+            Volume baseSize = static_cast<Volume>(getCash() * qCapFrac / price);
             baseSize = std::max(Volume(1), baseSize);
 
             if (inventory < maxInventory_ && canBuy(symbol, baseSize, bidPrice)) {
@@ -107,8 +137,30 @@ namespace market {
                 orders.push_back(createOrder(symbol, OrderSide::SELL, OrderType::LIMIT, askPrice, askSize));
             }
         }
+    }
 
-        return orders;
+    void MarketMaker::writeCheckpoint(CheckpointWriter& out) const {
+        Agent::writeCheckpoint(out);
+        out.write(baseSpread_);
+        out.write(inventorySkew_);
+        out.write(maxInventory_);
+        out.write(static_cast<uint64_t>(activeQuotes_.size()));
+        for (const Quote& q : activeQuotes_) {
+            out.write(q.bid);
+            out.write(q.ask);
+        }
+    }
+
+    void MarketMaker::readCheckpoint(CheckpointReader& in) {
+        Agent::readCheckpoint(in);
+        in.read(baseSpread_);
+        in.read(inventorySkew_);
+        in.read(maxInventory_);
+        activeQuotes_.resize(in.readCount(2 * sizeof(OrderId)));
+        for (Quote& q : activeQuotes_) {
+            in.read(q.bid);
+            in.read(q.ask);
+        }
     }
 
 } // namespace market
@@ -6,25 +6,45 @@
 namespace market {
 
     // Market Maker: continuously quotes bid/ask, manages inventory risk
-    class MarketMaker : public Agent {
+    class MarketMaker final : public Agent {
     public:
         MarketMaker(AgentId id, double cash, const AgentParams& params,
             const RuntimeConfig* cfg = nullptr);
 
+        // Single-order view: one random side of one symbol's quote
         std::optional<Order> decide(const MarketState& state) override;
+        // Requotes every symbol at once, replacing the quotes still resting from
+        // the previous refresh
+        void decideBatch(const MarketState& state, OrderBatch& out) override;
+        void onOrdersPlaced(ConstSpan<OrderAction> actions) override;
+
         std::vector<Order> quoteMarket(const MarketState& state);
-        std::string getType() const override { return "MarketMaker"; }
+        static constexpr std::string_view TYPE = "MarketMaker";
+        std::string_view getType() const override { return TYPE; }
+        std::unique_ptr<Agent> clone(const RuntimeConfig* cfg) const override { return cloneAs<MarketMaker>(cfg); }
+        void applyConfig(const RuntimeConfig& cfg) override { Agent::applyConfig(cfg); config_ = cfg.marketMaker; }
+
+        void writeCheckpoint(CheckpointWriter& out) const override;
+        void readCheckpoint(CheckpointReader& in) override;
 
     private:
+        RuntimeConfig::MarketMakerParams config_;  // This type's section of the config in force
         double baseSpread_ = 0.002;  // 0.2% base spread
         double inventorySkew_ = 0.001;  // Skew per unit of inventory
         int maxInventory_ = 1000;
 
-        // Track quotes for each symbol
-        std::map<std::string, std::pair<OrderId, OrderId>> activeQuotes_;  // bid, ask order ids
+        // Ids of the last bid and ask placed per symbol (0 = none); indexed by SymbolId
+        struct Quote {
+            OrderId bid = 0;
+            OrderId ask = 0;
+        };
+        std::vector<Quote> activeQuotes_;
+        std::vector<Order> quotes_;  // decideBatch scratch
+
+        void appendQuotes(const MarketState& state, std::vector<Order>& orders);
 
-        double calculateSpread(const std::string& symbol, double volatility) const;
-        double calculateSkew(const std::string& symbol) const;
+        double calculateSpread(SymbolId symbol, double volatility) const;
+        double calculateSkew(SymbolId symbol) const;
     };
 
 } // namespace market
@@ -1,4 +1,6 @@
 #include "MeanReversionTrader.hpp"
+#include "core/Checkpoint.hpp"
+#include "core/PriceIndicators.hpp"
 #include "utils/Random.hpp"
 #include <cmath>
 
@@ -7,6 +9,7 @@ namespace market {
     MeanReversionTrader::MeanReversionTrader(AgentId id, double cash, const AgentParams& params,
         const RuntimeConfig* cfg)
         : Agent(id, cash, params, cfg)
+        , config_(cfg ? cfg->meanReversion : RuntimeConfig::MeanReversionParams{})
     {
         int lbMin = cfg ? cfg->meanReversion.lookbackMin : 20;
         int lbRange = cfg ? cfg->meanReversion.lookbackRange : 20;
@@ -17,60 +20,35 @@ namespace market {
         zThreshold_ = zMin + Random::uniform(0, zRng);
     }
 
-    double MeanReversionTrader::calculateMean(const std::vector<Price>& history, int period) const {
-        if (history.size() < static_cast<size_t>(period)) return 0.0;
-
-        double sum = 0.0;
-        auto start = history.end() - period;
-        for (auto it = start; it != history.end(); ++it) {
-            sum += *it;
-        }
-        return sum / period;
-    }
-
-    double MeanReversionTrader::calculateStd(const std::vector<Price>& history, int period, double mean) const {
-        if (history.size() < static_cast<size_t>(period)) return 0.0;
-
-        double sqSum = 0.0;
-        auto start = history.end() - period;
-        for (auto it = start; it != history.end(); ++it) {
-            sqSum += (*it - mean) * (*it - mean);
-        }
-        return std::sqrt(sqSum / period);
-    }
-
     std::optional<Order> MeanReversionTrader::decide(const MarketState& state) {
-        double rMult = rtConfig_ ? rtConfig_->meanReversion.reactionMult : 0.2;
-        double lpMax = rtConfig_ ? rtConfig_->meanReversion.limitPriceSpreadMax : 0.005;
+        double rMult = config_.reactionMult;
+        double lpMax = config_.limitPriceSpreadMax;
 
-        if (Random::uniform(0, 1) > params_.reactionSpeed * rMult * state.tickScale) {
+        if (gateDraw_ > params_.reactionSpeed * rMult * state.tickScale) {
             return std::nullopt;
         }
 
-        if (state.priceHistory.empty()) return std::nullopt;
+        if (state.indicators.empty()) return std::nullopt;
 
-        auto it = state.priceHistory.begin();
-        std::advance(it, Random::uniformInt(0, state.priceHistory.size() - 1));
-        std::string symbol = it->first;
+        SymbolId symbol = pickSymbol(state);
 
-        const auto& history = it->second;
-        if (history.size() < static_cast<size_t>(lookbackPeriod_)) {
+        const PriceIndicators& indicators = *state.indicators[symbol];
+        if (indicators.size() < static_cast<size_t>(lookbackPeriod_)) {
             return std::nullopt;
         }
 
-        auto priceIt = state.prices.find(symbol);
-        if (priceIt == state.prices.end()) return std::nullopt;
-        Price currentPrice = priceIt->second;
+        Price currentPrice = state.prices[symbol];
 
-        double mean = calculateMean(history, lookbackPeriod_);
-        double std = calculateStd(history, lookbackPeriod_, mean);
+        double mean = indicators.sma(lookbackPeriod_);
+        double std = indicators.stddev(lookbackPeriod_);
 
         if (std <= 0) return std::nullopt;
 
         double zScore = (currentPrice - mean) / std;
 
+        syncSentiment();
         double commoditySentiment = getCombinedSentiment(symbol);
-        zScore += commoditySentiment * 0.2 + sentimentBias_ * 0.1;
+        zScore += commoditySentiment * 0.2 + getSentimentBias() * 0.1;
 
         if (zScore > zThreshold_) {
             Volume maxSellable = getMaxSellable(symbol);
@@ -97,4 +75,16 @@ namespace market {
         return std::nullopt;
     }
 
+    void MeanReversionTrader::writeCheckpoint(CheckpointWriter& out) const {
+        Agent::writeCheckpoint(out);
+        out.write(lookbackPeriod_);
+        out.write(zThreshold_);
+    }
+
+    void MeanReversionTrader::readCheckpoint(CheckpointReader& in) {
+        Agent::readCheckpoint(in);
+        in.read(lookbackPeriod_);
+        in.read(zThreshold_);
+    }
+
 } // namespace market
@@ -5,20 +5,24 @@
 namespace market {
 
     // Mean Reversion Trader: trades based on z-score deviation from rolling mean
-    class MeanReversionTrader : public Agent {
+    class MeanReversionTrader final : public Agent {
     public:
         MeanReversionTrader(AgentId id, double cash, const AgentParams& params,
             const RuntimeConfig* cfg = nullptr);
 
         std::optional<Order> decide(const MarketState& state) override;
-        std::string getType() const override { return "MeanReversion"; }
+        static constexpr std::string_view TYPE = "MeanReversion";
+        std::string_view getType() const override { return TYPE; }
+        std::unique_ptr<Agent> clone(const RuntimeConfig* cfg) const override { return cloneAs<MeanReversionTrader>(cfg); }
+        void applyConfig(const RuntimeConfig& cfg) override { Agent::applyConfig(cfg); config_ = cfg.meanReversion; }
+
+        void writeCheckpoint(CheckpointWriter& out) const override;
+        void readCheckpoint(CheckpointReader& in) override;
 
     private:
+        RuntimeConfig::MeanReversionParams config_;  // This type's section of the config in force
         int lookbackPeriod_ = 30;
         double zThreshold_ = 2.0;  // Number of std deviations
-
-        double calculateMean(const std::vector<Price>& history, int period) const;
-        double calculateStd(const std::vector<Price>& history, int period, double mean) const;
     };
 
 } // namespace market
@@ -1,4 +1,6 @@
 #include "MomentumTrader.hpp"
+#include "core/Checkpoint.hpp"
+#include "core/PriceIndicators.hpp"
 #include "utils/Random.hpp"
 #include <numeric>
 
@@ -7,6 +9,7 @@ namespace market {
     MomentumTrader::MomentumTrader(AgentId id, double cash, const AgentParams& params,
         const RuntimeConfig* cfg)
         : Agent(id, cash, params, cfg)
+        , config_(cfg ? cfg->momentum : RuntimeConfig::MomentumParams{})
     {
         int spMin = cfg ? cfg->momentum.shortPeriodMin : 3;
         int spRange = cfg ? cfg->momentum.shortPeriodRange : 4;
@@ -17,53 +20,37 @@ namespace market {
         longPeriod_ = shortPeriod_ + loMin + Random::uniformInt(0, loRange);
     }
 
-    double MomentumTrader::calculateMA(const std::vector<Price>& history, int period) const {
-        if (history.size() < static_cast<size_t>(period)) {
-            return 0.0;
-        }
-
-        double sum = 0.0;
-        auto start = history.end() - period;
-        for (auto it = start; it != history.end(); ++it) {
-            sum += *it;
-        }
-        return sum / period;
-    }
-
     std::optional<Order> MomentumTrader::decide(const MarketState& state) {
-        double rMult = rtConfig_ ? rtConfig_->momentum.reactionMult : 0.25;
-        double loMin = rtConfig_ ? rtConfig_->momentum.limitOffsetMin : 0.0005;
-        double loMax = rtConfig_ ? rtConfig_->momentum.limitOffsetMax : 0.005;
-        double stRS = rtConfig_ ? rtConfig_->momentum.signalThresholdRiskScale : 0.001;
+        double rMult = config_.reactionMult;
+        double loMin = config_.limitOffsetMin;
+        double loMax = config_.limitOffsetMax;
+        double stRS = config_.signalThresholdRiskScale;
 
-        if (Random::uniform(0, 1) > params_.reactionSpeed * rMult * state.tickScale) {
+        if (gateDraw_ > params_.reactionSpeed * rMult * state.tickScale) {
             return std::nullopt;
         }
 
-        if (state.priceHistory.empty()) return std::nullopt;
+        if (state.indicators.empty()) return std::nullopt;
 
-        auto it = state.priceHistory.begin();
-        std::advance(it, Random::uniformInt(0, state.priceHistory.size() - 1));
-        std::string symbol = it->first;
+        SymbolId symbol = pickSymbol(state);
 
-        const auto& history = it->second;
-        if (history.size() < static_cast<size_t>(longPeriod_)) {
+        const PriceIndicators& indicators = *state.indicators[symbol];
+        if (indicators.size() < static_cast<size_t>(longPeriod_)) {
             return std::nullopt;
         }
 
-        auto priceIt = state.prices.find(symbol);
-        if (priceIt == state.prices.end()) return std::nullopt;
-        Price currentPrice = priceIt->second;
+        Price currentPrice = state.prices[symbol];
 
-        double shortMA = calculateMA(history, shortPeriod_);
-        double longMA = calculateMA(history, longPeriod_);
+        double shortMA = indicators.sma(shortPeriod_);
+        double longMA = indicators.sma(longPeriod_);
 
         if (shortMA <= 0 || longMA <= 0) return std::nullopt;
 
         double signal = (shortMA - longMA) / longMA;
 
+        syncSentiment();
         double commoditySentiment = getCombinedSentiment(symbol);
-        signal += commoditySentiment * 0.1 + sentimentBias_ * 0.05;
+        signal += commoditySentiment * 0.1 + getSentimentBias() * 0.05;
 
         double threshold = stRS * params_.riskAversion;
 
@@ -92,4 +79,16 @@ namespace market {
         return std::nullopt;
     }
 
+    void MomentumTrader::writeCheckpoint(CheckpointWriter& out) const {
+        Agent::writeCheckpoint(out);
+        out.write(shortPeriod_);
+        out.write(longPeriod_);
+    }
+
+    void MomentumTrader::readCheckpoint(CheckpointReader& in) {
+        Agent::readCheckpoint(in);
+        in.read(shortPeriod_);
+        in.read(longPeriod_);
+    }
+
 } // namespace market
@@ -5,19 +5,24 @@
 namespace market {
 
     // Momentum Trader: trades based on moving average crossovers
-    class MomentumTrader : public Agent {
+    class MomentumTrader final : public Agent {
     public:
         MomentumTrader(AgentId id, double cash, const AgentParams& params,
             const RuntimeConfig* cfg = nullptr);
 
         std::optional<Order> decide(const MarketState& state) override;
-        std::string getType() const override { return "Momentum"; }
+        static constexpr std::string_view TYPE = "Momentum";
+        std::string_view getType() const override { return TYPE; }
+        std::unique_ptr<Agent> clone(const RuntimeConfig* cfg) const override { return cloneAs<MomentumTrader>(cfg); }
+        void applyConfig(const RuntimeConfig& cfg) override { Agent::applyConfig(cfg); config_ = cfg.momentum; }
+
+        void writeCheckpoint(CheckpointWriter& out) const override;
+        void readCheckpoint(CheckpointReader& in) override;
 
     private:
+        RuntimeConfig::MomentumParams config_;  // This type's section of the config in force
         int shortPeriod_ = 5;
         int longPeriod_ = 20;
-
-        double calculateMA(const std::vector<Price>& history, int period) const;
     };
 
 } // namespace market
@@ -1,4 +1,5 @@
 #include "NoiseTrader.hpp"
+#include "core/Checkpoint.hpp"
 #include "utils/Random.hpp"
 #include <cmath>
 
@@ -7,6 +8,7 @@ namespace market {
     NoiseTrader::NoiseTrader(AgentId id, double cash, const AgentParams& params,
         const RuntimeConfig* cfg)
         : Agent(id, cash, params, cfg)
+        , config_(cfg ? cfg->noise : RuntimeConfig::NoiseParams{})
     {
         double tpMin = cfg ? cfg->noise.tradeProbMin : 0.05;
         double tpRng = cfg ? cfg->noise.tradeProbRange : 0.10;
@@ -18,15 +20,15 @@ namespace market {
     }
 
     void NoiseTrader::updateBeliefs(const NewsEvent& news) {
-        double orMult = rtConfig_ ? rtConfig_->noise.overreactionMult : 1.0;
+        double orMult = config_.overreactionMult;
         double impact = news.magnitude * params_.newsWeight * sentimentSensitivity_ * orMult;
 
         switch (news.sentiment) {
         case NewsSentiment::POSITIVE:
-            sentimentBias_ += impact;
+            biasSlot() += impact;
             break;
         case NewsSentiment::NEGATIVE:
-            sentimentBias_ -= impact;
+            biasSlot() -= impact;
             break;
         default:
             break;
@@ -34,36 +36,34 @@ namespace market {
     }
 
     void NoiseTrader::decaySentiment(double tickScale) {
-        double dg = rtConfig_ ? rtConfig_->noise.sentimentDecay : 0.98;
-        double dc = rtConfig_ ? rtConfig_->noise.commoditySentDecay : 0.95;
+        double dg = config_.sentimentDecay;
+        double dc = config_.commoditySentDecay;
 
-        sentimentBias_ *= std::pow(dg, tickScale);
-        for (auto& [_, val] : commoditySentiment_) val *= std::pow(dc, tickScale);
+        scaleSentiment(std::pow(dg, tickScale), std::pow(dc, tickScale));
     }
 
     std::optional<Order> NoiseTrader::decide(const MarketState& state) {
-        double mktProb = rtConfig_ ? rtConfig_->noise.marketOrderProb : 0.1;
-        double loMin = rtConfig_ ? rtConfig_->noise.limitOffsetMin : 0.001;
-        double loMax = rtConfig_ ? rtConfig_->noise.limitOffsetMax : 0.01;
-        double cMin = rtConfig_ ? rtConfig_->noise.confidenceMin : 0.2;
-        double cMax = rtConfig_ ? rtConfig_->noise.confidenceMax : 0.5;
-        double bsW = rtConfig_ ? rtConfig_->noise.buyBiasSentWeight : 0.3;
-        double bnStd = rtConfig_ ? rtConfig_->noise.buyBiasNoiseStd : 0.1;
-
-        double effectiveProb = tradeProbability_ * (1.0 + std::abs(sentimentBias_)) * state.tickScale;
-
-        if (Random::uniform(0, 1) > effectiveProb) {
+        double mktProb = config_.marketOrderProb;
+        double loMin = config_.limitOffsetMin;
+        double loMax = config_.limitOffsetMax;
+        double cMin = config_.confidenceMin;
+        double cMax = config_.confidenceMax;
+        double bsW = config_.buyBiasSentWeight;
+        double bnStd = config_.buyBiasNoiseStd;
+
+        syncSentiment();
+        double effectiveProb = tradeProbability_ * (1.0 + std::abs(getSentimentBias())) * state.tickScale;
+
+        if (gateDraw_ > effectiveProb) {
             return std::nullopt;
         }
 
         if (state.prices.empty()) return std::nullopt;
 
-        auto it = state.prices.begin();
-        std::advance(it, Random::uniformInt(0, state.prices.size() - 1));
-        std::string symbol = it->first;
-        Price currentPrice = it->second;
+        SymbolId symbol = pickSymbol(state);
+        Price currentPrice = state.prices[symbol];
 
-        double buyProb = 0.5 + sentimentBias_ * bsW + Random::normal(0, bnStd);
+        double buyProb = 0.5 + getSentimentBias() * bsW + Random::normal(0, bnStd);
         bool shouldBuy = Random::uniform(0, 1) < buyProb;
 
         if (shouldBuy) {
@@ -95,4 +95,16 @@ namespace market {
         return std::nullopt;
     }
 
+    void NoiseTrader::writeCheckpoint(CheckpointWriter& out) const {
+        Agent::writeCheckpoint(out);
+        out.write(tradeProbability_);
+        out.write(sentimentSensitivity_);
+    }
+
+    void NoiseTrader::readCheckpoint(CheckpointReader& in) {
+        Agent::readCheckpoint(in);
+        in.read(tradeProbability_);
+        in.read(sentimentSensitivity_);
+    }
+
 } // namespace market
@@ -5,7 +5,7 @@
 namespace market {
 
     // Noise Trader: trades randomly with sentiment influence
-    class NoiseTrader : public Agent {
+    class NoiseTrader final : public Agent {
     public:
         NoiseTrader(AgentId id, double cash, const AgentParams& params,
             const RuntimeConfig* cfg = nullptr);
@@ -13,9 +13,16 @@ namespace market {
         std::optional<Order> decide(const MarketState& state) override;
         void updateBeliefs(const NewsEvent& news) override;
         void decaySentiment(double tickScale = 1.0) override;
-        std::string getType() const override { return "Noise"; }
+        static constexpr std::string_view TYPE = "Noise";
+        std::string_view getType() const override { return TYPE; }
+        std::unique_ptr<Agent> clone(const RuntimeConfig* cfg) const override { return cloneAs<NoiseTrader>(cfg); }
+        void applyConfig(const RuntimeConfig& cfg) override { Agent::applyConfig(cfg); config_ = cfg.noise; }
+
+        void writeCheckpoint(CheckpointWriter& out) const override;
+        void readCheckpoint(CheckpointReader& in) override;
 
     private:
+        RuntimeConfig::NoiseParams config_;  // This type's section of the config in force
         double tradeProbability_ = 0.1;
         double sentimentSensitivity_ = 0.5;
     };
@@ -1,4 +1,5 @@
 #include "SupplyDemandTrader.hpp"
+#include "core/Checkpoint.hpp"
 #include "utils/Random.hpp"
 #include <cmath>
 
@@ -7,6 +8,7 @@ namespace market {
     SupplyDemandTrader::SupplyDemandTrader(AgentId id, double cash, const AgentParams& params,
         const RuntimeConfig* cfg)
         : Agent(id, cash, params, cfg)
+        , config_(cfg ? cfg->supplyDemand : RuntimeConfig::SupplyDemandParams{})
     {
         double tBase = cfg ? cfg->supplyDemand.thresholdBase : 0.02;
         double tScale = cfg ? cfg->supplyDemand.thresholdRiskScale : 0.03;
@@ -18,28 +20,25 @@ namespace market {
     }
 
     std::optional<Order> SupplyDemandTrader::decide(const MarketState& state) {
-        double rMult = rtConfig_ ? rtConfig_->supplyDemand.reactionMult : 0.3;
-        double sImp = rtConfig_ ? rtConfig_->supplyDemand.sentimentImpact : 0.2;
-        double lpMax = rtConfig_ ? rtConfig_->supplyDemand.limitPriceSpreadMax : 0.005;
+        double rMult = config_.reactionMult;
+        double sImp = config_.sentimentImpact;
+        double lpMax = config_.limitPriceSpreadMax;
 
-        if (Random::uniform(0, 1) > params_.reactionSpeed * rMult * state.tickScale) {
+        if (gateDraw_ > params_.reactionSpeed * rMult * state.tickScale) {
             return std::nullopt;
         }
 
         if (state.prices.empty() || state.supplyDemand.empty()) return std::nullopt;
 
-        auto it = state.prices.begin();
-        std::advance(it, Random::uniformInt(0, state.prices.size() - 1));
-        std::string symbol = it->first;
+        SymbolId symbol = pickSymbol(state);
+        Price currentPrice = state.prices[symbol];
 
-        Price currentPrice = state.prices.at(symbol);
+        if (symbol >= state.supplyDemand.size()) return std::nullopt;
 
-        auto sdIt = state.supplyDemand.find(symbol);
-        if (sdIt == state.supplyDemand.end()) return std::nullopt;
-
-        double imbalance = sdIt->second.getImbalance();
+        double imbalance = state.supplyDemand[symbol].getImbalance();
         double estimatedImbalance = imbalance + Random::normal(0, noiseStd_);
 
+        syncSentiment();
         double sentiment = getCombinedSentiment(symbol);
         estimatedImbalance += sentiment * sImp;
 
@@ -68,4 +67,16 @@ namespace market {
         return std::nullopt;
     }
 
+    void SupplyDemandTrader::writeCheckpoint(CheckpointWriter& out) const {
+        Agent::writeCheckpoint(out);
+        out.write(threshold_);
+        out.write(noiseStd_);
+    }
+
+    void SupplyDemandTrader::readCheckpoint(CheckpointReader& in) {
+        Agent::readCheckpoint(in);
+        in.read(threshold_);
+        in.read(noiseStd_);
+    }
+
 } // namespace market
@@ -5,15 +5,22 @@
 
 namespace market {
 
-    class SupplyDemandTrader : public Agent {
+    class SupplyDemandTrader final : public Agent {
     public:
         SupplyDemandTrader(AgentId id, double cash, const AgentParams& params,
             const RuntimeConfig* cfg = nullptr);
 
         std::optional<Order> decide(const MarketState& state) override;
-        std::string getType() const override { return "SupplyDemandTrader"; }
+        static constexpr std::string_view TYPE = "SupplyDemandTrader";
+        std::string_view getType() const override { return TYPE; }
+        std::unique_ptr<Agent> clone(const RuntimeConfig* cfg) const override { return cloneAs<SupplyDemandTrader>(cfg); }
+        void applyConfig(const RuntimeConfig& cfg) override { Agent::applyConfig(cfg); config_ = cfg.supplyDemand; }
+
+        void writeCheckpoint(CheckpointWriter& out) const override;
+        void readCheckpoint(CheckpointReader& in) override;
 
     private:
+        RuntimeConfig::SupplyDemandParams config_;  // This type's section of the config in force
         double threshold_;
         double noiseStd_;
     };
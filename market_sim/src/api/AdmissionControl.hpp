@@ -0,0 +1,142 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace market {
+
+    // Decides, as each request reaches its handler, whether the server has
+    // room for it, so that under load requests are refused at once with a
+    // 503 instead of piling up behind slow ones. Routes are grouped into
+    // classes:
+    //   CRITICAL  order entry, control, health: always admitted
+    //   READ      snapshots and small queries: shed while the connection
+    //             backlog is over maxQueued
+    //   BULK      large reads: as READ, and at most `bulk` at a time
+    //   STREAM    long-lived /stream and /feed: limited by their own
+    //             subscriber caps, only counted here
+    // The caller reports connections entering and leaving the worker pool
+    // (connectionQueued/Started/Finished), which is the backlog measure.
+    class AdmissionControl {
+    public:
+        enum class RouteClass : uint8_t { CRITICAL, READ, BULK, STREAM };
+        static constexpr size_t CLASSES = 4;
+
+        struct Limits {
+            size_t bulk = 8;
+            size_t maxQueued = 32;
+        };
+
+        struct ClassStats {
+            size_t active = 0;
+            uint64_t admitted = 0;
+            uint64_t rejected = 0;
+        };
+
+        struct Stats {
+            size_t queuedConnections = 0;   // Accepted, waiting for a worker
+            size_t activeConnections = 0;   // Held by a worker
+            std::array<ClassStats, CLASSES> classes{};
+        };
+
+        static const char* className(RouteClass c) {
+            switch (c) {
+            case RouteClass::CRITICAL: return "critical";
+            case RouteClass::READ: return "read";
+            case RouteClass::BULK: return "bulk";
+            case RouteClass::STREAM: return "stream";
+            }
+            return "read";
+        }
+
+        // Holds a request's place in its class until destroyed; false when
+        // the request was refused
+        class Ticket {
+        public:
+            Ticket() = default;
+            Ticket(Ticket&& other) noexcept : active_(other.active_) { other.active_ = nullptr; }
+            Ticket& operator=(Ticket&& other) noexcept {
+                if (this != &other) {
+                    release();
+                    active_ = other.active_;
+                    other.active_ = nullptr;
+                }
+                return *this;
+            }
+            Ticket(const Ticket&) = delete;
+            Ticket& operator=(const Ticket&) = delete;
+            ~Ticket() { release(); }
+
+            explicit operator bool() const { return active_ != nullptr; }
+
+        private:
+            friend class AdmissionControl;
+            explicit Ticket(std::atomic<size_t>* active) : active_(active) {}
+
+            void release() {
+                if (active_) active_->fetch_sub(1, std::memory_order_relaxed);
+                active_ = nullptr;
+            }
+
+            std::atomic<size_t>* active_ = nullptr;
+        };
+
+        AdmissionControl() = default;
+        explicit AdmissionControl(Limits limits) : limits_(limits) {}
+
+        AdmissionControl(const AdmissionControl&) = delete;
+        AdmissionControl& operator=(const AdmissionControl&) = delete;
+
+        Ticket admit(RouteClass c) {
+            auto& cls = classes_[static_cast<size_t>(c)];
+            // The place is taken first so two requests cannot both see room for one
+            size_t before = cls.active.fetch_add(1, std::memory_order_relaxed);
+            bool backlogged = queued_.load(std::memory_order_relaxed) > limits_.maxQueued;
+            bool ok = c == RouteClass::CRITICAL || c == RouteClass::STREAM ||
+                (!backlogged && (c != RouteClass::BULK || before < limits_.bulk));
+            if (!ok) {
+                cls.active.fetch_sub(1, std::memory_order_relaxed);
+                cls.rejected.fetch_add(1, std::memory_order_relaxed);
+                return Ticket();
+            }
+            cls.admitted.fetch_add(1, std::memory_order_relaxed);
+            return Ticket(&cls.active);
+        }
+
+        void connectionQueued() { queued_.fetch_add(1, std::memory_order_relaxed); }
+        void connectionStarted() {
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            workers_.fetch_add(1, std::memory_order_relaxed);
+        }
+        void connectionFinished() { workers_.fetch_sub(1, std::memory_order_relaxed); }
+
+        const Limits& limits() const { return limits_; }
+
+        Stats getStats() const {
+            Stats s;
+            s.queuedConnections = queued_.load(std::memory_order_relaxed);
+            s.activeConnections = workers_.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < CLASSES; ++i) {
+                s.classes[i].active = classes_[i].active.load(std::memory_order_relaxed);
+                s.classes[i].admitted = classes_[i].admitted.load(std::memory_order_relaxed);
+                s.classes[i].rejected = classes_[i].rejected.load(std::memory_order_relaxed);
+            }
+            return s;
+        }
+
+    private:
+        struct Counters {
+            std::atomic<size_t> active{ 0 };
+            std::atomic<uint64_t> admitted{ 0 };
+            std::atomic<uint64_t> rejected{ 0 };
+        };
+
+        Limits limits_;
+        std::atomic<size_t> queued_{ 0 };
+        std::atomic<size_t> workers_{ 0 };
+        std::array<Counters, CLASSES> classes_;
+    };
+
+} // namespace market
@@ -1,24 +1,88 @@
 #include "ApiServer.hpp"
 #include "utils/Logger.hpp"
 #include "core/RuntimeConfig.hpp"
+#include "utils/FormatBuffer.hpp"
 #include <nlohmann/json.hpp>
 #include <shared_mutex>
+#include <sstream>
 
 namespace market {
 
+    namespace {
+
+        // httplib's worker pool, reporting each connection as it waits for
+        // and then holds a worker
+        class CountedTaskQueue : public httplib::TaskQueue {
+        public:
+            CountedTaskQueue(size_t threads, AdmissionControl& admission, LatencyHistogram& wait)
+                : pool_(threads), admission_(admission), wait_(wait) {}
+
+            void enqueue(std::function<void()> fn) override {
+                admission_.connectionQueued();
+                auto queuedAt = std::chrono::steady_clock::now();
+                pool_.enqueue([this, fn = std::move(fn), queuedAt] {
+                    admission_.connectionStarted();
+                    wait_.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - queuedAt).count()));
+                    fn();
+                    admission_.connectionFinished();
+                });
+            }
+
+            void shutdown() override { pool_.shutdown(); }
+
+        private:
+            httplib::ThreadPool pool_;
+            AdmissionControl& admission_;
+            LatencyHistogram& wait_;
+        };
+
+        AdmissionControl::Limits admissionLimits(const RuntimeConfig::HttpParams& http) {
+            AdmissionControl::Limits limits;
+            limits.bulk = static_cast<size_t>(std::max(1, http.bulkConcurrency));
+            limits.maxQueued = static_cast<size_t>(std::max(0, http.maxQueuedConnections));
+            return limits;
+        }
+
+        StreamBroadcaster::Options streamOptions(const RuntimeConfig::HttpParams& http) {
+            StreamBroadcaster::Options options;
+            options.maxSubscribers = static_cast<size_t>(std::max(0, http.streamClients));
+            return options;
+        }
+
+        BookFeed::Options feedOptions(const RuntimeConfig::HttpParams& http) {
+            BookFeed::Options options;
+            options.maxSubscribers = static_cast<size_t>(std::max(0, http.feedClients));
+            return options;
+        }
+
+    } // namespace
+
     ApiServer::ApiServer(Simulation& sim, const std::string& host, int port)
         : sim_(sim)
         , host_(host)
         , port_(port)
+        , stream_(std::make_unique<StreamBroadcaster>(sim, streamOptions(sim.getRuntimeConfig()->http)))
+        , feed_(std::make_unique<BookFeed>(sim, feedOptions(sim.getRuntimeConfig()->http)))
+        , admission_(admissionLimits(sim.getRuntimeConfig()->http))
     {
-        // Increase thread pool to handle concurrent SSE streams + requests
-        server_.new_task_queue = [] { return new httplib::ThreadPool(64); };
+        auto cfg = sim.getRuntimeConfig();
+        const auto& http = cfg->http;
+        retryAfterSec_ = std::max(1, http.retryAfterSec);
+        size_t threads = static_cast<size_t>(std::max(1, http.threads));
+        if (static_cast<size_t>(http.streamClients + http.feedClients + http.bulkConcurrency) >= threads) {
+            Logger::warn("http: {} stream, {} feed and {} bulk slots leave no worker of {} for orders",
+                http.streamClients, http.feedClients, http.bulkConcurrency, threads);
+        }
+        server_.new_task_queue = [this, threads] {
+            return new CountedTaskQueue(threads, admission_, connectionWait_);
+        };
 
-        // Set timeouts to prevent stale connections from consuming threads
-        // Long timeout needed for populate operations which can take minutes
-        server_.set_read_timeout(300, 0);
-        server_.set_write_timeout(300, 0);
-        server_.set_keep_alive_timeout(10);
+        // Timeouts keep stale connections from holding workers; the long
+        // defaults are for populate requests, which can take minutes
+        server_.set_read_timeout(http.readTimeoutSec, 0);
+        server_.set_write_timeout(http.writeTimeoutSec, 0);
+        server_.set_keep_alive_timeout(http.keepAliveSec);
 
         setupRoutes();
     }
@@ -31,6 +95,8 @@ namespace market {
         if (running_.load()) return;
 
         running_ = true;
+        stream_->start();
+        feed_->start();
 
         serverThread_ = std::thread([this]() {
             Logger::info("API server starting on {}:{}", host_, port_);
@@ -45,8 +111,15 @@ namespace market {
         if (!running_.load()) return;
 
         running_ = false;
+        stream_->stop();  // Ends the stream and feed providers, freeing their threads
+        feed_->stop();
         server_.stop();
 
+        {
+            std::lock_guard<std::mutex> guard(ensembleMutex_);
+            if (ensemble_) ensemble_->cancel();
+        }
+
         if (serverThread_.joinable()) {
             serverThread_.join();
         }
@@ -62,6 +135,215 @@ namespace market {
         return nlohmann::json{ {"error", message} }.dump();
     }
 
+    ApiServer::Encoding ApiServer::acceptedEncoding(const httplib::Request& req) {
+        if (!req.has_header("Accept")) return Encoding::JSON;
+
+        // The highest-q of the types we serve; ties go to the first listed
+        std::stringstream accept(req.get_header_value("Accept"));
+        std::string range;
+        Encoding best = Encoding::JSON;
+        double bestQ = 0.0;
+        while (std::getline(accept, range, ',')) {
+            double q = 1.0;
+            size_t semicolon = range.find(';');
+            std::string type = range.substr(0, semicolon);
+            type.erase(0, type.find_first_not_of(" \t"));
+            type.erase(type.find_last_not_of(" \t") + 1);
+            if (semicolon != std::string::npos) {
+                size_t qpos = range.find("q=", semicolon);
+                if (qpos != std::string::npos) q = std::atof(range.c_str() + qpos + 2);
+            }
+
+            Encoding encoding;
+            if (type == "application/msgpack" || type == "application/x-msgpack") encoding = Encoding::MSGPACK;
+            else if (type == "application/cbor") encoding = Encoding::CBOR;
+            else if (type == "application/json" || type == "application/*" || type == "*/*") encoding = Encoding::JSON;
+            else continue;
+            if (q > bestQ) {
+                best = encoding;
+                bestQ = q;
+            }
+        }
+        return best;
+    }
+
+    bool ApiServer::wantsColumns(const httplib::Request& req) {
+        return req.has_param("layout") && req.get_param_value("layout") == "columns";
+    }
+
+    void ApiServer::sendEncoded(httplib::Response& res, const nlohmann::json& j, Encoding encoding) {
+        res.set_header("Vary", "Accept");
+        std::vector<uint8_t> bytes;
+        switch (encoding) {
+        case Encoding::MSGPACK:
+            nlohmann::json::to_msgpack(j, bytes);
+            res.set_content(std::string(bytes.begin(), bytes.end()), "application/msgpack");
+            break;
+        case Encoding::CBOR:
+            nlohmann::json::to_cbor(j, bytes);
+            res.set_content(std::string(bytes.begin(), bytes.end()), "application/cbor");
+            break;
+        default:
+            res.set_content(jsonResponse(j), "application/json");
+            break;
+        }
+    }
+
+    std::string ApiServer::routeLabel(const std::string& pattern) {
+        // "/candles/(\\w+)" -> "/candles/*", so captured values never become labels
+        std::string label;
+        int depth = 0;
+        for (char c : pattern) {
+            if (c == '(') {
+                if (depth++ == 0) label += '*';
+            }
+            else if (c == ')') {
+                depth--;
+            }
+            else if (depth == 0) {
+                label += c;
+            }
+        }
+        return label;
+    }
+
+    uint64_t ApiServer::publicationStamp() const {
+        // The snapshot version moves with every publication; the tick and
+        // flags cover what /state reports between them (populate, pause)
+        uint64_t stamp = sim_.getSnapshot()->version;
+        stamp = stamp * 0x9E3779B97F4A7C15ull + sim_.getCurrentTick();
+        stamp = stamp * 0x9E3779B97F4A7C15ull + (sim_.isRunning() ? 1 : 0) + (sim_.isPaused() ? 2 : 0)
+            + (sim_.isPopulating() ? 4 : 0);
+        return stamp;
+    }
+
+    void ApiServer::cached(const httplib::Request& req, httplib::Response& res,
+        const std::function<std::string()>& build) {
+        std::string key = req.path;
+        for (const auto& [name, value] : req.params) key += "&" + name + "=" + value;
+
+        auto entry = responseCache_.get(key, publicationStamp(), build);
+        // One entry serves both codings, so the tag is weak for a compressed body
+        res.set_header("ETag", compressesResponse(req) ? ResponseCache::weakEtag(entry->etag) : entry->etag);
+        res.set_header("Vary", "Accept-Encoding");
+        res.set_header("Cache-Control", "no-cache");
+        if (req.has_header("If-None-Match") && ResponseCache::matches(req.get_header_value("If-None-Match"), entry->etag)) {
+            responseCache_.countNotModified();
+            res.status = 304;
+            return;
+        }
+        res.set_content(entry->body, "application/json");
+    }
+
+    bool ApiServer::compressesResponse(const httplib::Request& req) {
+#ifdef CPPHTTPLIB_ZLIB_SUPPORT
+        std::string accept = req.get_header_value("Accept-Encoding");
+        return accept.find("gzip") != std::string::npos || accept.find("deflate") != std::string::npos;
+#else
+        (void)req;
+        return false;
+#endif
+    }
+
+    void ApiServer::get(const std::string& pattern, httplib::Server::Handler handler, RouteClass routeClass) {
+        server_.Get(pattern, admitted("GET", pattern, routeClass, std::move(handler)));
+    }
+
+    void ApiServer::post(const std::string& pattern, httplib::Server::Handler handler, RouteClass routeClass) {
+        server_.Post(pattern, admitted("POST", pattern, routeClass, std::move(handler)));
+    }
+
+    void ApiServer::getWithSlot(const std::string& pattern, SlotHandler handler, RouteClass routeClass) {
+        server_.Get(pattern, admitted("GET", pattern, routeClass, std::move(handler)));
+    }
+
+    ApiServer::RouteStats& ApiServer::addRoute(const std::string& method, const std::string& pattern,
+        RouteClass routeClass) {
+        // Routes are registered before the server starts, so the list is
+        // fixed by the time handlers record into it
+        routeStats_.push_back(std::make_unique<RouteStats>());
+        RouteStats& stats = *routeStats_.back();
+        stats.method = method;
+        stats.pattern = routeLabel(pattern);
+        stats.routeClass = routeClass;
+        return stats;
+    }
+
+    httplib::Server::Handler ApiServer::admitted(const std::string& method, const std::string& pattern,
+        RouteClass routeClass, httplib::Server::Handler handler) {
+        RouteStats& stats = addRoute(method, pattern, routeClass);
+        return [this, &stats, handler = std::move(handler)](const httplib::Request& req, httplib::Response& res) {
+            stats.requests.fetch_add(1, std::memory_order_relaxed);
+            auto ticket = admission_.admit(stats.routeClass);
+            if (!ticket) {
+                stats.rejected.fetch_add(1, std::memory_order_relaxed);
+                busy(res);
+                return;
+            }
+            MARKET_PROFILE_SCOPE(stats.latency);
+            handler(req, res);
+        };
+    }
+
+    httplib::Server::Handler ApiServer::admitted(const std::string& method, const std::string& pattern,
+        RouteClass routeClass, SlotHandler handler) {
+        RouteStats& stats = addRoute(method, pattern, routeClass);
+        return [this, &stats, handler = std::move(handler)](const httplib::Request& req, httplib::Response& res) {
+            stats.requests.fetch_add(1, std::memory_order_relaxed);
+            auto slot = std::make_shared<AdmissionControl::Ticket>(admission_.admit(stats.routeClass));
+            if (!*slot) {
+                stats.rejected.fetch_add(1, std::memory_order_relaxed);
+                busy(res);
+                return;
+            }
+            MARKET_PROFILE_SCOPE(stats.latency);
+            handler(req, res, std::move(slot));
+        };
+    }
+
+    void ApiServer::busy(httplib::Response& res) const {
+        // Refused at once; closing the connection frees its worker too
+        res.status = 503;
+        res.set_header("Retry-After", std::to_string(retryAfterSec_));
+        res.set_header("Connection", "close");
+        res.set_content(errorResponse("Server busy"), "application/json");
+    }
+
+    nlohmann::json ApiServer::httpStatsJson() const {
+        auto stats = admission_.getStats();
+        nlohmann::json classes = nlohmann::json::object();
+        for (size_t i = 0; i < AdmissionControl::CLASSES; ++i) {
+            const auto& c = stats.classes[i];
+            classes[AdmissionControl::className(static_cast<RouteClass>(i))] = {
+                {"active", c.active}, {"admitted", c.admitted}, {"rejected", c.rejected}
+            };
+        }
+        nlohmann::json routes = nlohmann::json::array();
+        for (const auto& route : routeStats_) {
+            nlohmann::json r = {
+                {"method", route->method},
+                {"route", route->pattern},
+                {"class", AdmissionControl::className(route->routeClass)},
+                {"requests", route->requests.load(std::memory_order_relaxed)},
+                {"rejected", route->rejected.load(std::memory_order_relaxed)}
+            };
+#if MARKET_PROFILING
+            r["meanUs"] = route->latency.mean();
+            r["maxUs"] = route->latency.max();
+#endif
+            routes.push_back(std::move(r));
+        }
+        return {
+            {"threads", std::max(1, sim_.getRuntimeConfig()->http.threads)},
+            {"queuedConnections", stats.queuedConnections},
+            {"activeConnections", stats.activeConnections},
+            {"connectionWaitMeanUs", connectionWait_.mean()},
+            {"connectionWaitMaxUs", connectionWait_.max()},
+            {"classes", std::move(classes)},
+            {"routes", std::move(routes)}
+        };
+    }
+
     void ApiServer::setupRoutes() {
         // CORS headers
         server_.set_default_headers({
@@ -76,60 +358,135 @@ namespace market {
             });
 
         // GET /state - Current simulation state
-        server_.Get("/state", [this](const httplib::Request&, httplib::Response& res) {
-            res.set_content(jsonResponse(sim_.getStateJson()), "application/json");
+        // Read endpoints below are served from responseCache_ with an ETag
+        // and rebuilt at most once per publication
+        get("/state", [this](const httplib::Request& req, httplib::Response& res) {
+            cached(req, res, [this] { return jsonResponse(sim_.getStateJson()); });
             });
 
         // GET /commodities - All commodity data
-        server_.Get("/commodities", [this](const httplib::Request&, httplib::Response& res) {
-            res.set_content(jsonResponse(sim_.getCommoditiesJson()), "application/json");
+        get("/commodities", [this](const httplib::Request& req, httplib::Response& res) {
+            cached(req, res, [this] { return jsonResponse(sim_.getCommoditiesJson()); });
             });
 
         // GET /agents - Agent summary
-        server_.Get("/agents", [this](const httplib::Request&, httplib::Response& res) {
-            res.set_content(jsonResponse(sim_.getAgentSummaryJson()), "application/json");
+        get("/agents", [this](const httplib::Request& req, httplib::Response& res) {
+            cached(req, res, [this] { return jsonResponse(sim_.getAgentSummaryJson()); });
             });
 
         // GET /metrics - Simulation metrics
-        server_.Get("/metrics", [this](const httplib::Request&, httplib::Response& res) {
-            res.set_content(jsonResponse(sim_.getMetricsJson()), "application/json");
+        // Not cached: the server counters below move without a publication
+        get("/metrics", [this](const httplib::Request&, httplib::Response& res) {
+            nlohmann::json m = sim_.getMetricsJson();
+            auto stream = stream_->getStats();
+            m["stream"] = {
+                {"subscribers", stream.subscribers},
+                {"framesBuilt", stream.framesBuilt},
+                {"framesQueued", stream.framesQueued},
+                {"dropped", stream.dropped},
+                {"rejected", stream.rejected}
+            };
+            auto feed = feed_->getStats();
+            m["feed"] = {
+                {"subscribers", feed.subscribers},
+                {"messages", feed.messages},
+                {"bytes", feed.bytes},
+                {"dropped", feed.dropped},
+                {"rejected", feed.rejected},
+                {"tradeGaps", feed.tradeGaps}
+            };
+            auto cache = responseCache_.getStats();
+            m["responseCache"] = {
+                {"hits", cache.hits},
+                {"misses", cache.misses},
+                {"notModified", cache.notModified}
+            };
+            m["http"] = httpStatsJson();
+            res.set_content(jsonResponse(m), "application/json");
+            });
+
+        // GET /metrics/prometheus - Tick phase, scheduler and handler timings,
+        // counters and book depth in the Prometheus text format
+        get("/metrics/prometheus", [this](const httplib::Request&, httplib::Response& res) {
+            PrometheusWriter out;
+            sim_.writePrometheus(out);
+            auto stream = stream_->getStats();
+            out.gauge("market_stream_subscribers", "Connected /stream clients", static_cast<double>(stream.subscribers));
+            out.counter("market_stream_frames_built_total", "Stream frames serialized", static_cast<double>(stream.framesBuilt));
+            out.counter("market_stream_frames_queued_total", "Stream frames queued to clients", static_cast<double>(stream.framesQueued));
+            out.counter("market_stream_dropped_total", "Stream clients dropped for falling behind", static_cast<double>(stream.dropped));
+            out.counter("market_stream_rejected_total", "Stream clients refused over the limit", static_cast<double>(stream.rejected));
+            auto feed = feed_->getStats();
+            out.gauge("market_feed_subscribers", "Connected /feed clients", static_cast<double>(feed.subscribers));
+            out.counter("market_feed_messages_total", "Book feed messages encoded", static_cast<double>(feed.messages));
+            out.counter("market_feed_bytes_total", "Book feed bytes encoded", static_cast<double>(feed.bytes));
+            out.counter("market_feed_dropped_total", "Feed clients dropped for falling behind", static_cast<double>(feed.dropped));
+            out.counter("market_feed_rejected_total", "Feed clients refused over the limit", static_cast<double>(feed.rejected));
+            out.counter("market_feed_trade_gaps_total", "Feed polls that missed trades", static_cast<double>(feed.tradeGaps));
+            auto http = admission_.getStats();
+            out.gauge("market_http_connections_queued", "Connections waiting for a worker", static_cast<double>(http.queuedConnections));
+            out.gauge("market_http_connections_active", "Connections held by a worker", static_cast<double>(http.activeConnections));
+            out.histogram("market_http_connection_wait_seconds", "Time connections wait for a worker", connectionWait_);
+            for (size_t i = 0; i < AdmissionControl::CLASSES; ++i) {
+                std::string label = PrometheusWriter::label("class", AdmissionControl::className(static_cast<RouteClass>(i)));
+                out.gauge("market_http_class_active", "Requests in handlers by admission class",
+                    static_cast<double>(http.classes[i].active), label);
+                out.counter("market_http_class_rejected_total", "Requests refused with 503 by admission class",
+                    static_cast<double>(http.classes[i].rejected), label);
+            }
+            for (const auto& route : routeStats_) {
+                std::string labels = PrometheusWriter::label("method", route->method) + "," + PrometheusWriter::label("route", route->pattern);
+                out.counter("market_http_requests_total", "API requests by route",
+                    static_cast<double>(route->requests.load(std::memory_order_relaxed)), labels);
+                out.counter("market_http_rejected_total", "API requests refused with 503 by route",
+                    static_cast<double>(route->rejected.load(std::memory_order_relaxed)), labels);
+#if MARKET_PROFILING
+                out.histogram("market_http_request_seconds", "API handler time by route", route->latency, labels);
+#endif
+            }
+            res.set_content(out.str(), PrometheusWriter::CONTENT_TYPE);
             });
 
         // GET /orderbook/:symbol - Order book for symbol
-        server_.Get(R"(/orderbook/(\w+))", [this](const httplib::Request& req, httplib::Response& res) {
-            std::shared_lock<std::shared_mutex> lock(sim_.getEngineMutex());
+        // (top levels as of the last published snapshot)
+        get(R"(/orderbook/(\w+))", [this](const httplib::Request& req, httplib::Response& res) {
             std::string symbol = req.matches[1];
 
-            auto* book = sim_.getEngine().getOrderBook(symbol);
-            if (!book) {
+            auto published = sim_.getSnapshot();
+            auto it = published->books.find(symbol);
+            if (it == published->books.end()) {
                 res.status = 404;
                 res.set_content(errorResponse("Symbol not found"), "application/json");
                 return;
             }
 
-            auto snapshot = book->getSnapshot(10);
-            nlohmann::json j;
-            j["symbol"] = snapshot.symbol;
-            j["bestBid"] = snapshot.bestBid;
-            j["bestAsk"] = snapshot.bestAsk;
-            j["spread"] = snapshot.spread;
-            j["midPrice"] = snapshot.midPrice;
-
-            j["bids"] = nlohmann::json::array();
-            for (const auto& level : snapshot.bids) {
-                j["bids"].push_back({ {"price", level.price}, {"quantity", level.totalQuantity} });
-            }
-
-            j["asks"] = nlohmann::json::array();
-            for (const auto& level : snapshot.asks) {
-                j["asks"].push_back({ {"price", level.price}, {"quantity", level.totalQuantity} });
-            }
+            cached(req, res, [&] {
+                // Built from the publication the cache stamp was taken under, or a later one
+                auto current = sim_.getSnapshot();
+                auto found = current->books.find(symbol);
+                const OrderBookSnapshot& snapshot = found != current->books.end() ? found->second : it->second;
+                nlohmann::json j;
+                j["symbol"] = snapshot.symbol;
+                j["bestBid"] = snapshot.bestBid;
+                j["bestAsk"] = snapshot.bestAsk;
+                j["spread"] = snapshot.spread;
+                j["midPrice"] = snapshot.midPrice;
+
+                j["bids"] = nlohmann::json::array();
+                for (const auto& level : snapshot.bids) {
+                    j["bids"].push_back({ {"price", level.price}, {"quantity", level.totalQuantity} });
+                }
 
-            res.set_content(jsonResponse(j), "application/json");
+                j["asks"] = nlohmann::json::array();
+                for (const auto& level : snapshot.asks) {
+                    j["asks"].push_back({ {"price", level.price}, {"quantity", level.totalQuantity} });
+                }
+                return jsonResponse(j);
+                });
             });
 
         // POST /control - Start/pause/stop/reset simulation
-        server_.Post("/control", [this](const httplib::Request& req, httplib::Response& res) {
+        post("/control", [this](const httplib::Request& req, httplib::Response& res) {
             try {
                 auto body = nlohmann::json::parse(req.body);
                 std::string action = body.value("action", "");
@@ -167,10 +524,10 @@ namespace market {
                 res.status = 400;
                 res.set_content(errorResponse(e.what()), "application/json");
             }
-            });
+            }, RouteClass::CRITICAL);
 
         // POST /news - Inject news event
-        server_.Post("/news", [this](const httplib::Request& req, httplib::Response& res) {
+        post("/news", [this](const httplib::Request& req, httplib::Response& res) {
             try {
                 std::unique_lock<std::shared_mutex> lock(sim_.getEngineMutex());
                 auto body = nlohmann::json::parse(req.body);
@@ -231,72 +588,44 @@ namespace market {
             });
 
         // GET /config - Return full RuntimeConfig as JSON
-        server_.Get("/config", [this](const httplib::Request&, httplib::Response& res) {
-            std::shared_lock<std::shared_mutex> lock(sim_.getEngineMutex());
-            res.set_content(jsonResponse(sim_.getRuntimeConfig().toJson()), "application/json");
+        get("/config", [this](const httplib::Request&, httplib::Response& res) {
+            auto cfg = sim_.getRuntimeConfig();
+            auto j = cfg->toJson();
+            j["version"] = cfg->version;
+            res.set_content(jsonResponse(j), "application/json");
             });
 
         // GET /config/defaults - Return a fresh default RuntimeConfig
-        server_.Get("/config/defaults", [this](const httplib::Request&, httplib::Response& res) {
+        get("/config/defaults", [this](const httplib::Request&, httplib::Response& res) {
             RuntimeConfig defaults;
             res.set_content(jsonResponse(defaults.toJson()), "application/json");
             });
 
-        // POST /config - Merge-patch update to RuntimeConfig (hot params only)
-        server_.Post("/config", [this](const httplib::Request& req, httplib::Response& res) {
+        // POST /config - Merge-patch update to RuntimeConfig (hot params only).
+        // Publishes a new config snapshot without the engine lock; the tick
+        // loop picks it up at its next tick.
+        post("/config", [this](const httplib::Request& req, httplib::Response& res) {
             try {
-                Logger::info("[API] POST /config - updating runtime config");
-                std::unique_lock<std::shared_mutex> lock(sim_.getEngineMutex());
                 auto body = nlohmann::json::parse(req.body);
-                Logger::info("[API] POST /config - lock acquired, applying {} keys", body.size());
-
-                // Merge-patch into the live config
-                sim_.getRuntimeConfig().fromJson(body);
-
-                // Push hot-reloadable values to subsystems
-                auto& cfg = sim_.getRuntimeConfig();
-
-                // Tick rate
-                if (body.contains("simulation") && body["simulation"].contains("tickRateMs")) {
-                    sim_.setTickRate(cfg.simulation.tickRateMs);
-                }
-
-                // News lambda
-                if (body.contains("news") && body["news"].contains("lambda")) {
-                    sim_.getEngine().getNewsGenerator().setLambda(cfg.news.lambda);
-                }
-
-                // Commodity params (push to all commodities)
-                if (body.contains("commodity")) {
-                    for (auto& [sym, commodity] : sim_.getEngine().getMutableCommodities()) {
-                        commodity->setMaxDailyMove(cfg.commodity.circuitBreakerLimit);
-                        commodity->setImpactDampening(cfg.commodity.impactDampening);
-                        commodity->setPriceFloor(cfg.commodity.priceFloor);
-                    }
-                }
-
-                // OrderBook expiry
-                if (body.contains("orderBook") && body["orderBook"].contains("orderExpiryMs")) {
-                    for (auto& [sym, book] : sim_.getEngine().getOrderBooks()) {
-                        book->setMaxOrderAgeMs(cfg.orderBook.orderExpiryMs);
-                    }
-                }
+                auto cfg = sim_.updateConfig(body);
+                Logger::info("[API] POST /config - published version {} ({} keys)", cfg->version, body.size());
 
                 res.set_content(jsonResponse({
                     {"status", "ok"},
-                    {"message", "Config updated (hot reload). Use POST /reinitialize for cold params."}
+                    {"version", cfg->version},
+                    {"message", "Config updated (hot reload, from the next tick). Use POST /reinitialize for cold params."}
                     }), "application/json");
             }
             catch (const std::exception& e) {
                 res.status = 400;
                 res.set_content(errorResponse(e.what()), "application/json");
             }
-            });
+            }, RouteClass::CRITICAL);
 
         // POST /config/reset - Reset to defaults + reinitialize
-        server_.Post("/config/reset", [this](const httplib::Request&, httplib::Response& res) {
+        post("/config/reset", [this](const httplib::Request&, httplib::Response& res) {
             try {
-                sim_.getRuntimeConfig() = RuntimeConfig();
+                sim_.resetConfig();
                 sim_.reinitialize();  // reinitialize() acquires its own lock
                 res.set_content(jsonResponse({
                     {"status", "ok"},
@@ -307,10 +636,10 @@ namespace market {
                 res.status = 500;
                 res.set_content(errorResponse(e.what()), "application/json");
             }
-            });
+            }, RouteClass::CRITICAL);
 
         // POST /reinitialize - Rebuild agents/commodities with current config (cold params)
-        server_.Post("/reinitialize", [this](const httplib::Request&, httplib::Response& res) {
+        post("/reinitialize", [this](const httplib::Request&, httplib::Response& res) {
             try {
                 Logger::info("[API] POST /reinitialize - starting");
                 sim_.reinitialize();  // reinitialize() acquires its own lock
@@ -324,12 +653,15 @@ namespace market {
                 res.status = 500;
                 res.set_content(errorResponse(e.what()), "application/json");
             }
-            });
+            }, RouteClass::CRITICAL);
 
         // POST /orders - Submit user order for execution
-        server_.Post("/orders", [this](const httplib::Request& req, httplib::Response& res) {
+        // Orders go through the engine's ingress queue and are matched inside the next
+        // tick, so this handler never takes the engine lock while the simulation runs.
+        // The response carries the new order id at once; with "wait": true it instead
+        // waits for that tick and carries the fill result.
+        post("/orders", [this](const httplib::Request& req, httplib::Response& res) {
             try {
-                std::unique_lock<std::shared_mutex> lock(sim_.getEngineMutex());
                 auto body = nlohmann::json::parse(req.body);
 
                 std::string symbol = body.value("symbol", "");
@@ -338,6 +670,8 @@ namespace market {
                 double price = body.value("price", 0.0);
                 int64_t quantity = body.value("quantity", 0);
                 std::string userId = body.value("userId", "");
+                bool wait = body.value("wait", false);
+                int timeoutMs = body.value("timeoutMs", 5000);
 
                 if (symbol.empty() || quantity <= 0) {
                     res.status = 400;
@@ -345,99 +679,214 @@ namespace market {
                     return;
                 }
 
-                // Get current commodity price
-                auto* commodity = sim_.getEngine().getCommodity(symbol);
-                if (!commodity) {
+                if (!sim_.getEngine().isKnownSymbol(symbol)) {
                     res.status = 404;
                     res.set_content(errorResponse("Symbol not found: " + symbol), "application/json");
                     return;
                 }
 
-                // Get order book
-                auto* book = sim_.getEngine().getOrderBook(symbol);
-                if (!book) {
-                    res.status = 500;
-                    res.set_content(errorResponse("Order book unavailable"), "application/json");
-                    return;
+                OrderSide side = (sideStr == "SELL") ? OrderSide::SELL : OrderSide::BUY;
+                OrderType orderType = (typeStr == "LIMIT") ? OrderType::LIMIT : OrderType::MARKET;
+
+                // Create and enqueue order; market orders are priced by the engine at drain time
+                IngressOrder ingress;
+                ingress.symbol = symbol;
+                ingress.order.id = sim_.getEngine().allocateOrderId();
+                ingress.order.agentId = userOwnerId(userId);  // Only this userId can cancel it
+                ingress.order.side = side;
+                ingress.order.type = orderType;
+                ingress.order.price = (orderType == OrderType::LIMIT) ? price : 0.0;
+                ingress.order.quantity = quantity;
+                ingress.order.timestamp = now();
+
+                std::future<OrderAck> ackFuture;
+                if (wait) {
+                    ingress.ack = std::make_shared<std::promise<OrderAck>>();
+                    ackFuture = ingress.ack->get_future();
                 }
 
-                // Determine execution price
-                double execPrice = commodity->getPrice();
-                OrderSide side = (sideStr == "SELL") ? OrderSide::SELL : OrderSide::BUY;
+                OrderId orderId = ingress.order.id;
+                sim_.getEngine().submitExternalOrder(std::move(ingress));
+                sim_.flushExternalOrders();
 
-                // For market orders, use best available price
-                auto snapshot = book->getSnapshot(1);
-                if (side == OrderSide::BUY && snapshot.bestAsk > 0) {
-                    execPrice = snapshot.bestAsk;
+                nlohmann::json response;
+                response["status"] = "accepted";
+                response["orderId"] = orderId;
+                response["symbol"] = symbol;
+                response["side"] = sideStr;
+                response["quantity"] = quantity;
+                response["userId"] = userId;
+
+                if (wait) {
+                    if (ackFuture.wait_for(std::chrono::milliseconds(timeoutMs)) == std::future_status::ready) {
+                        OrderAck ack = ackFuture.get();
+                        if (ack.status == "rejected") {
+                            res.status = 409;
+                            res.set_content(errorResponse(ack.reason), "application/json");
+                            return;
+                        }
+                        response["status"] = ack.status;
+                        response["filledQuantity"] = ack.filledQuantity;
+                        response["avgFillPrice"] = ack.filledQuantity > 0 ? ack.avgFillPrice : price;
+                    }
+                    else {
+                        response["status"] = "queued";  // Still waiting for a tick
+                    }
                 }
-                else if (side == OrderSide::SELL && snapshot.bestBid > 0) {
-                    execPrice = snapshot.bestBid;
+
+                Logger::info("User order {}: {} {} {} @ {} -> {}",
+                    orderId, sideStr, quantity, symbol, price,
+                    response["status"].get<std::string>());
+
+                res.set_content(jsonResponse(response), "application/json");
+            }
+            catch (const std::exception& e) {
+                res.status = 400;
+                res.set_content(errorResponse(e.what()), "application/json");
+            }
+            }, RouteClass::CRITICAL);
+
+        // POST /orders/batch - Submit many orders (and cancels) in one request
+        // Body: {"orders": [...], "wait": false, "timeoutMs": 5000, "userId": ...}.
+        // Each entry is an order as for POST /orders, or {"symbol", "cancel": orderId}
+        // to cancel a resting order placed with the same userId. Entries are validated here, outside any
+        // lock; the valid ones enter the ingress queue together and reach the books
+        // in the same tick, in request order. Invalid entries are reported per index.
+        post("/orders/batch", [this](const httplib::Request& req, httplib::Response& res) {
+            constexpr size_t MAX_BATCH_ORDERS = 1000;
+            try {
+                auto body = nlohmann::json::parse(req.body);
+                if (!body.is_object() || !body.contains("orders") || !body["orders"].is_array()) {
+                    res.status = 400;
+                    res.set_content(errorResponse("Expected {\"orders\": [...]}"), "application/json");
+                    return;
                 }
+                const auto& entries = body["orders"];
+                if (entries.size() > MAX_BATCH_ORDERS) {
+                    res.status = 413;
+                    res.set_content(errorResponse("At most " + std::to_string(MAX_BATCH_ORDERS) +
+                        " orders per batch"), "application/json");
+                    return;
+                }
+                bool wait = body.value("wait", false);
+                int timeoutMs = body.value("timeoutMs", 5000);
+                std::string userId = body.value("userId", "");
 
-                // For limit orders, check price validity
-                OrderType orderType = (typeStr == "LIMIT") ? OrderType::LIMIT : OrderType::MARKET;
-                if (orderType == OrderType::LIMIT && price > 0) {
-                    execPrice = price;
-                }
-
-                // Create and submit order
-                Order order;
-                order.id = static_cast<OrderId>(std::chrono::steady_clock::now().time_since_epoch().count());
-                order.agentId = 0;  // User orders have agentId = 0
-                order.symbol = symbol;
-                order.side = side;
-                order.type = orderType;
-                order.price = execPrice;
-                order.quantity = quantity;
-                order.timestamp = now();
-
-                // Add to order book and try to match
-                book->addOrder(order);
-                auto trades = book->matchOrders();
-
-                // Check if our order was filled
-                double filledQty = 0;
-                double avgFillPrice = 0;
-                for (const auto& trade : trades) {
-                    if (trade.buyerId == 0 || trade.sellerId == 0) {
-                        filledQty += trade.quantity;
-                        avgFillPrice += trade.price * trade.quantity;
+                auto& engine = sim_.getEngine();
+                nlohmann::json results = nlohmann::json::array();
+                std::vector<IngressOrder> batch;
+                std::vector<size_t> batchIndex;  // results index of each batch entry
+                batch.reserve(entries.size());
+                batchIndex.reserve(entries.size());
+
+                for (size_t i = 0; i < entries.size(); ++i) {
+                    const auto& entry = entries[i];
+                    nlohmann::json result = { {"index", i} };
+                    try {
+                        if (!entry.is_object()) throw std::runtime_error("Order must be an object");
+                        std::string symbol = entry.value("symbol", "");
+                        if (symbol.empty()) throw std::runtime_error("Missing symbol");
+                        if (!engine.isKnownSymbol(symbol)) throw std::runtime_error("Symbol not found: " + symbol);
+                        result["symbol"] = symbol;
+
+                        IngressOrder ingress;
+                        ingress.symbol = symbol;
+                        ingress.order.agentId = userOwnerId(userId);
+                        if (entry.contains("cancel")) {
+                            OrderId target = entry["cancel"].get<OrderId>();
+                            if (target == 0) throw std::runtime_error("Invalid order id to cancel");
+                            ingress.cancelId = target;
+                            result["cancel"] = target;
+                        }
+                        else {
+                            std::string sideStr = entry.value("side", "BUY");
+                            std::string typeStr = entry.value("type", "MARKET");
+                            double price = entry.value("price", 0.0);
+                            int64_t quantity = entry.value("quantity", 0);
+                            if (quantity <= 0) throw std::runtime_error("Invalid quantity");
+
+                            OrderType orderType = (typeStr == "LIMIT") ? OrderType::LIMIT : OrderType::MARKET;
+                            ingress.order.id = engine.allocateOrderId();
+                            ingress.order.side = (sideStr == "SELL") ? OrderSide::SELL : OrderSide::BUY;
+                            ingress.order.type = orderType;
+                            ingress.order.price = (orderType == OrderType::LIMIT) ? price : 0.0;
+                            ingress.order.quantity = quantity;
+                            ingress.order.timestamp = now();
+                            result["orderId"] = ingress.order.id;
+                            result["side"] = sideStr;
+                            result["quantity"] = quantity;
+                        }
+                        if (wait) ingress.ack = std::make_shared<std::promise<OrderAck>>();
+                        result["status"] = "accepted";
+                        batch.push_back(std::move(ingress));
+                        batchIndex.push_back(i);
+                    }
+                    catch (const std::exception& e) {
+                        result["status"] = "invalid";
+                        result["error"] = e.what();
                     }
+                    results.push_back(std::move(result));
                 }
-                if (filledQty > 0) {
-                    avgFillPrice /= filledQty;
+
+                std::vector<std::future<OrderAck>> acks;
+                if (wait) {
+                    acks.reserve(batch.size());
+                    for (auto& ingress : batch) acks.push_back(ingress.ack->get_future());
                 }
 
-                // Update commodity price
-                if (!trades.empty()) {
-                    commodity->setPrice(trades.back().price);
+                size_t accepted = batch.size();
+                engine.submitExternalOrders(std::move(batch));
+                sim_.flushExternalOrders();
+
+                if (wait) {
+                    // One deadline for the whole batch; they all resolve in the same tick
+                    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+                    for (size_t k = 0; k < acks.size(); ++k) {
+                        auto& result = results[batchIndex[k]];
+                        if (acks[k].wait_until(deadline) != std::future_status::ready) {
+                            result["status"] = "queued";  // Still waiting for a tick
+                            continue;
+                        }
+                        OrderAck ack = acks[k].get();
+                        result["status"] = ack.status;
+                        if (ack.status == "rejected") {
+                            result["error"] = ack.reason;
+                        }
+                        else if (!result.contains("cancel")) {
+                            result["filledQuantity"] = ack.filledQuantity;
+                            result["avgFillPrice"] = ack.avgFillPrice;
+                        }
+                    }
                 }
 
+                Logger::info("User batch: {} orders, {} accepted", entries.size(), accepted);
+
                 nlohmann::json response;
-                response["status"] = (filledQty >= quantity) ? "filled" : (filledQty > 0 ? "partial" : "pending");
-                response["orderId"] = order.id;
-                response["symbol"] = symbol;
-                response["side"] = sideStr;
-                response["quantity"] = quantity;
-                response["filledQuantity"] = filledQty;
-                response["avgFillPrice"] = avgFillPrice > 0 ? avgFillPrice : execPrice;
                 response["userId"] = userId;
-
-                Logger::info("User order: {} {} {} @ {} -> {} filled @ {}",
-                    sideStr, quantity, symbol, execPrice,
-                    response["status"].get<std::string>(),
-                    response["avgFillPrice"].get<double>());
-
+                response["accepted"] = accepted;
+                response["invalid"] = entries.size() - accepted;
+                response["results"] = std::move(results);
                 res.set_content(jsonResponse(response), "application/json");
             }
             catch (const std::exception& e) {
                 res.status = 400;
                 res.set_content(errorResponse(e.what()), "application/json");
             }
-            });
+            }, RouteClass::CRITICAL);
+
+        // GET /stream - Server-Sent Events for real-time data. Frames are
+        // serialized once by the broadcaster and shared by every client;
+        // ?deltas=1 sends only changed prices after the first full update.
+        get("/stream", [this](const httplib::Request& req, httplib::Response& res) {
+            bool deltas = req.has_param("deltas") && req.get_param_value("deltas") != "0";
+            auto subscription = stream_->subscribe(deltas);
+            if (!subscription) {
+                res.status = 503;
+                res.set_header("Retry-After", std::to_string(retryAfterSec_));
+                res.set_content(errorResponse("Too many stream clients"), "application/json");
+                return;
+            }
 
-        // GET /stream - Server-Sent Events for real-time data
-        server_.Get("/stream", [this](const httplib::Request&, httplib::Response& res) {
             res.set_header("Content-Type", "text/event-stream");
             res.set_header("Cache-Control", "no-cache");
             res.set_header("Connection", "keep-alive");
@@ -445,219 +894,273 @@ namespace market {
 
             res.set_chunked_content_provider(
                 "text/event-stream",
-                [this](size_t /*offset*/, httplib::DataSink& sink) {
-                    int tickCounter = 0;
-                    while (running_.load()) {
-                        // Send state update every tick
-                        nlohmann::json data;
-                        {
-                            std::shared_lock<std::shared_mutex> lock(sim_.getEngineMutex());
-                            data["type"] = "update";
-                            data["tick"] = sim_.getCurrentTick();
-                            data["running"] = sim_.isRunning();
-                            data["paused"] = sim_.isPaused();
-                            data["simDate"] = sim_.getEngine().getSimClock().currentDateString();
-                            data["simDateTime"] = sim_.getEngine().getSimClock().currentDateTimeString();
-                            data["simTimestamp"] = sim_.getEngine().getSimClock().currentTimestamp();
-
-                            // Include prices
-                            data["commodities"] = nlohmann::json::array();
-                            for (const auto& [symbol, commodity] : sim_.getEngine().getCommodities()) {
-                                data["commodities"].push_back({
-                                    {"symbol", symbol},
-                                    {"name", commodity->getName()},
-                                    {"price", commodity->getPrice()},
-                                    {"change", commodity->getReturn(1)}
-                                    });
-                            }
-                        } // release shared lock before writing to sink
-
-                        std::string event = "data: " + data.dump() + "\n\n";
-                        if (!sink.write(event.c_str(), event.size())) {
+                [this, subscription](size_t /*offset*/, httplib::DataSink& sink) {
+                    static const std::string keepalive = ": keepalive\n\n";
+                    StreamBroadcaster::Frame frame;
+                    while (running_.load() && subscription->next(frame, std::chrono::seconds(15))) {
+                        const std::string& bytes = frame ? *frame : keepalive;
+                        if (!sink.is_writable() || !sink.write(bytes.data(), bytes.size())) {
                             return false;  // Connection closed
                         }
-
-                        // Send news events less frequently
-                        if (tickCounter % 5 == 0) {
-                            std::shared_lock<std::shared_mutex> lock(sim_.getEngineMutex());
-                            auto news = sim_.getEngine().getNewsGenerator().getRecentNews(3);
-                            if (!news.empty()) {
-                                nlohmann::json newsData;
-                                newsData["type"] = "news";
-                                newsData["events"] = nlohmann::json::array();
-                                for (const auto& n : news) {
-                                    newsData["events"].push_back({
-                                            {"headline", n.headline},
-                                            {"category", n.category == NewsCategory::GLOBAL ? "global" :
-                                                         n.category == NewsCategory::POLITICAL ? "political" :
-                                                         n.category == NewsCategory::SUPPLY ? "supply" : "demand"},
-                                            {"sentiment", n.sentiment == NewsSentiment::POSITIVE ? "positive" :
-                                                          n.sentiment == NewsSentiment::NEGATIVE ? "negative" : "neutral"},
-                                            {"magnitude", n.magnitude},
-                                            {"symbol", n.symbol},
-                                            {"subcategory", n.subcategory}
-                                        });
-                                }
-                                std::string newsEvent = "data: " + newsData.dump() + "\n\n";
-                                sink.write(newsEvent.c_str(), newsEvent.size());
-                            }
-                        }
-
-                        tickCounter++;
-                        std::this_thread::sleep_for(std::chrono::milliseconds(100));
                     }
-                    return false;
+                    return false;  // Stopped, or dropped for falling behind
+                },
+                [this, subscription](bool /*success*/) { stream_->unsubscribe(subscription); }
+            );
+            }, RouteClass::STREAM);
+
+        // GET /feed?symbols=OIL,STEEL - Binary L2 book, trade and candle
+        // feed (see BookFeed for the encoding); all symbols without `symbols`.
+        // Starts with the directory and a snapshot per symbol; reconnect to resync.
+        get("/feed", [this](const httplib::Request& req, httplib::Response& res) {
+            std::vector<std::string> symbols;
+            if (req.has_param("symbols")) {
+                std::stringstream list(req.get_param_value("symbols"));
+                std::string symbol;
+                auto published = sim_.getSnapshot();
+                while (std::getline(list, symbol, ',')) {
+                    if (symbol.empty()) continue;
+                    if (published->books.count(symbol) == 0) {
+                        res.status = 404;
+                        res.set_content(errorResponse("Symbol not found: " + symbol), "application/json");
+                        return;
+                    }
+                    symbols.push_back(symbol);
                 }
+            }
+            auto subscription = feed_->subscribe(symbols);
+            if (!subscription) {
+                res.status = 503;
+                res.set_header("Retry-After", std::to_string(retryAfterSec_));
+                res.set_content(errorResponse("Too many feed clients"), "application/json");
+                return;
+            }
+
+            res.set_header("Cache-Control", "no-cache");
+            res.set_header("Access-Control-Allow-Origin", "*");
+            res.set_chunked_content_provider(
+                "application/octet-stream",
+                [this, subscription](size_t /*offset*/, httplib::DataSink& sink) {
+                    FrameQueue::Frame frame;
+                    while (running_.load() && subscription->next(frame, std::chrono::seconds(1))) {
+                        if (!sink.is_writable()) return false;  // Connection closed
+                        if (frame && !sink.write(frame->data(), frame->size())) return false;
+                    }
+                    return false;  // Stopped, or dropped for falling behind
+                },
+                [this, subscription](bool /*success*/) { feed_->unsubscribe(subscription); }
             );
-            });
+            }, RouteClass::STREAM);
 
         // GET /trades - Recent trade log with agent type info
-        server_.Get("/trades", [this](const httplib::Request& req, httplib::Response& res) {
+        get("/trades", [this](const httplib::Request& req, httplib::Response& res) {
             std::shared_lock<std::shared_mutex> lock(sim_.getEngineMutex());
             std::string filterSymbol = req.has_param("symbol") ? req.get_param_value("symbol") : "";
             int limit = req.has_param("limit") ? std::stoi(req.get_param_value("limit")) : 100;
 
-            const auto& trades = sim_.getEngine().getRecentTrades();
+            const auto& engine = sim_.getEngine();
+            const auto& trades = engine.getRecentTrades();
+            SymbolId filterId = filterSymbol.empty() ? INVALID_SYMBOL_ID : engine.getSymbolId(filterSymbol);
 
-            nlohmann::json j = nlohmann::json::array();
+            bool columns = wantsColumns(req);
+            nlohmann::json j = columns ? nlohmann::json::object() : nlohmann::json::array();
+            if (columns) {
+                for (const char* field : { "seq", "symbol", "price", "quantity", "buyerId", "sellerId",
+                    "buyerType", "sellerType", "timestamp" }) {
+                    j[field] = nlohmann::json::array();
+                }
+            }
             int count = 0;
-            // Iterate in reverse for newest-first
-            for (auto it = trades.rbegin(); it != trades.rend() && count < limit; ++it) {
-                if (!filterSymbol.empty() && it->symbol != filterSymbol) continue;
-
-                j.push_back({
-                    {"symbol", it->symbol},
-                    {"price", it->price},
-                    {"quantity", it->quantity},
-                    {"buyerId", it->buyerId},
-                    {"sellerId", it->sellerId},
-                    {"buyerType", it->buyerType},
-                    {"sellerType", it->sellerType},
-                    {"timestamp", it->timestamp}
-                    });
+            auto emit = [&](uint64_t seq, const Trade& t) {
+                if (count >= limit) return false;
+                if (!filterSymbol.empty() && t.symbolId != filterId) return true;
+
+                if (columns) {
+                    j["seq"].push_back(seq);
+                    j["symbol"].push_back(engine.getSymbolName(t.symbolId));
+                    j["price"].push_back(t.price);
+                    j["quantity"].push_back(t.quantity);
+                    j["buyerId"].push_back(t.buyerId);
+                    j["sellerId"].push_back(t.sellerId);
+                    j["buyerType"].push_back(engine.getAgentTypeName(t.buyerType));
+                    j["sellerType"].push_back(engine.getAgentTypeName(t.sellerType));
+                    j["timestamp"].push_back(t.timestamp);
+                }
+                else {
+                    j.push_back({
+                        {"seq", seq},
+                        {"symbol", engine.getSymbolName(t.symbolId)},
+                        {"price", t.price},
+                        {"quantity", t.quantity},
+                        {"buyerId", t.buyerId},
+                        {"sellerId", t.sellerId},
+                        {"buyerType", engine.getAgentTypeName(t.buyerType)},
+                        {"sellerType", engine.getAgentTypeName(t.sellerType)},
+                        {"timestamp", t.timestamp}
+                        });
+                }
                 count++;
+                return true;
+            };
+
+            // ?after=<seq>: oldest-first continuation for pollers; otherwise newest-first
+            if (req.has_param("after")) {
+                trades.forEachAfter(std::stoull(req.get_param_value("after")), emit);
+            }
+            else {
+                trades.forEachNewest(emit);
             }
 
-            res.set_content(jsonResponse(j), "application/json");
-            });
+            // Lets a poller detect a gap (its cursor fell out of the window)
+            res.set_header("X-Trades-First-Seq", std::to_string(trades.firstSeq()));
+            res.set_header("X-Trades-Last-Seq", std::to_string(trades.lastSeq()));
+            sendEncoded(res, j, acceptedEncoding(req));
+            }, RouteClass::BULK);
 
         // GET /diagnostics - One-stop debugging endpoint
-        server_.Get("/diagnostics", [this](const httplib::Request&, httplib::Response& res) {
-            std::shared_lock<std::shared_mutex> lock(sim_.getEngineMutex());
-
-            nlohmann::json diag;
-
-            // 1. Agent population summary
-            diag["agents"] = sim_.getAgentSummaryJson();
-
-            // 2. Per-type order/trade stats
-            nlohmann::json statsJson;
-            for (const auto& [type, stats] : sim_.getEngine().getAgentTypeStats()) {
-                statsJson[type] = {
-                    {"ordersPlaced", stats.ordersPlaced},
-                    {"buyOrders", stats.buyOrders},
-                    {"sellOrders", stats.sellOrders},
-                    {"fills", stats.fills},
-                    {"volumeTraded", stats.volumeTraded},
-                    {"cashSpent", stats.cashSpent},
-                    {"cashReceived", stats.cashReceived},
-                    {"buyToSellRatio", stats.sellOrders > 0 ? static_cast<double>(stats.buyOrders) / stats.sellOrders : 0.0}
-                };
-            }
-            diag["agentTypeStats"] = statsJson;
-
-            // 3. Commodity health
-            nlohmann::json commoditiesJson;
-            for (const auto& [sym, commodity] : sim_.getEngine().getCommodities()) {
-                auto* book = sim_.getEngine().getOrderBook(sym);
-                auto snap = book ? book->getSnapshot(1) : OrderBookSnapshot{};
-
-                commoditiesJson[sym] = {
-                    {"price", commodity->getPrice()},
-                    {"dailyVolume", commodity->getDailyVolume()},
-                    {"bestBid", snap.bestBid},
-                    {"bestAsk", snap.bestAsk},
-                    {"spread", snap.spread},
-                    {"spreadPct", snap.midPrice > 0 ? snap.spread / snap.midPrice * 100.0 : 0.0}
+        get("/diagnostics", [this](const httplib::Request& req, httplib::Response& res) {
+            cached(req, res, [this] {
+                std::shared_lock<std::shared_mutex> lock(sim_.getEngineMutex());
+
+                nlohmann::json diag;
+
+                // 1. Agent population summary
+                diag["agents"] = sim_.getAgentSummaryJson();
+
+                // 2. Per-type order/trade stats
+                nlohmann::json statsJson;
+                for (const auto& [type, stats] : sim_.getEngine().getAgentTypeStats()) {
+                    statsJson[type] = {
+                        {"ordersPlaced", stats.ordersPlaced},
+                        {"buyOrders", stats.buyOrders},
+                        {"sellOrders", stats.sellOrders},
+                        {"cancels", stats.cancels},
+                        {"fills", stats.fills},
+                        {"volumeTraded", stats.volumeTraded},
+                        {"cashSpent", stats.cashSpent},
+                        {"cashReceived", stats.cashReceived},
+                        {"buyToSellRatio", stats.sellOrders > 0 ? static_cast<double>(stats.buyOrders) / stats.sellOrders : 0.0}
+                    };
+                }
+                diag["agentTypeStats"] = statsJson;
+
+                // 3. Commodity health
+                nlohmann::json commoditiesJson;
+                for (const auto& [sym, commodity] : sim_.getEngine().getCommodities()) {
+                    auto* book = sim_.getEngine().getOrderBook(sym);
+                    auto snap = book ? book->getSnapshot(1) : OrderBookSnapshot{};
+
+                    commoditiesJson[sym] = {
+                        {"price", commodity->getPrice()},
+                        {"dailyVolume", commodity->getDailyVolume()},
+                        {"bestBid", snap.bestBid},
+                        {"bestAsk", snap.bestAsk},
+                        {"spread", snap.spread},
+                        {"spreadPct", snap.midPrice > 0 ? snap.spread / snap.midPrice * 100.0 : 0.0}
+                    };
+                }
+                diag["commodities"] = commoditiesJson;
+
+                // 4. Simulation clock
+                const auto& clock = sim_.getEngine().getSimClock();
+                diag["clock"] = {
+                    {"currentDate", clock.currentDateString()},
+                    {"currentDateTime", clock.currentDateTimeString()},
+                    {"timestamp", clock.currentTimestamp()},
+                    {"ticksPerDay", clock.getTicksPerDay()}
                 };
-            }
-            diag["commodities"] = commoditiesJson;
-
-            // 4. Simulation clock
-            const auto& clock = sim_.getEngine().getSimClock();
-            diag["clock"] = {
-                {"currentDate", clock.currentDateString()},
-                {"currentDateTime", clock.currentDateTimeString()},
-                {"timestamp", clock.currentTimestamp()},
-                {"ticksPerDay", clock.getTicksPerDay()}
-            };
 
-            // 5. Top-level metrics
-            auto metrics = sim_.getEngine().getMetrics();
-            diag["metrics"] = {
-                {"totalTicks", metrics.totalTicks},
-                {"totalTrades", metrics.totalTrades},
-                {"totalOrders", metrics.totalOrders},
-                {"avgSpread", metrics.avgSpread},
-                {"tradeLogSize", sim_.getEngine().getRecentTrades().size()}
-            };
+                // 5. Top-level metrics
+                auto metrics = sim_.getEngine().getMetrics();
+                diag["metrics"] = {
+                    {"totalTicks", metrics.totalTicks},
+                    {"totalTrades", metrics.totalTrades},
+                    {"totalOrders", metrics.totalOrders},
+                    {"avgSpread", metrics.avgSpread},
+                    {"tradeLogSize", sim_.getEngine().getRecentTrades().size()}
+                };
 
-            // 6. Recent trades sample (last 10)
-            nlohmann::json recentTrades = nlohmann::json::array();
-            const auto& trades = sim_.getEngine().getRecentTrades();
-            int count = 0;
-            for (auto it = trades.rbegin(); it != trades.rend() && count < 10; ++it, ++count) {
-                recentTrades.push_back({
-                    {"symbol", it->symbol},
-                    {"price", it->price},
-                    {"quantity", it->quantity},
-                    {"buyerType", it->buyerType},
-                    {"sellerType", it->sellerType}
-                    });
-            }
-            diag["recentTrades"] = recentTrades;
+                // 6. Recent trades sample (last 10)
+                nlohmann::json recentTrades = nlohmann::json::array();
+                int count = 0;
+                sim_.getEngine().getRecentTrades().forEachNewest([&](uint64_t, const Trade& t) {
+                    recentTrades.push_back({
+                        {"symbol", sim_.getEngine().getSymbolName(t.symbolId)},
+                        {"price", t.price},
+                        {"quantity", t.quantity},
+                        {"buyerType", sim_.getEngine().getAgentTypeName(t.buyerType)},
+                        {"sellerType", sim_.getEngine().getAgentTypeName(t.sellerType)}
+                        });
+                    return ++count < 10;
+                });
+                diag["recentTrades"] = recentTrades;
 
-            res.set_content(jsonResponse(diag), "application/json");
+                return jsonResponse(diag);
+                });
             });
 
         // Health check
-        server_.Get("/health", [](const httplib::Request&, httplib::Response& res) {
+        get("/health", [](const httplib::Request&, httplib::Response& res) {
             res.set_content(jsonResponse({ {"status", "healthy"} }), "application/json");
-            });
+            }, RouteClass::CRITICAL);
 
         // GET /candles/bulk - Get candles for all symbols at once
         // NOTE: Must be registered BEFORE /candles/(\w+) or the regex swallows "bulk" as a symbol
-        server_.Get("/candles/bulk", [this](const httplib::Request& req, httplib::Response& res) {
-            std::shared_lock<std::shared_mutex> lock(sim_.getEngineMutex());
+        get("/candles/bulk", [this](const httplib::Request& req, httplib::Response& res) {
             std::string intervalStr = req.has_param("interval") ? req.get_param_value("interval") : "1m";
             int64_t since = req.has_param("since") ? std::stoll(req.get_param_value("since")) : 0;
-            int limit = req.has_param("limit") ? std::stoi(req.get_param_value("limit")) : 500;
-
             auto interval = CandleAggregator::parseInterval(intervalStr);
 
-            auto allCandles = sim_.getEngine().getCandleAggregator().getAllCandles(interval, since);
-
-            nlohmann::json j;
-            for (const auto& [symbol, candles] : allCandles) {
-                j[symbol] = nlohmann::json::array();
-                for (const auto& c : candles) {
-                    j[symbol].push_back({
-                        {"time", c.time},
-                        {"open", c.open},
-                        {"high", c.high},
-                        {"low", c.low},
-                        {"close", c.close},
-                        {"volume", c.volume}
-                        });
+            // Rows as JSON: candles are kept serialized; the lock covers copying the text only
+            Encoding encoding = acceptedEncoding(req);
+            bool columns = wantsColumns(req);
+            if (encoding == Encoding::JSON && !columns) {
+                std::string body;
+                {
+                    std::shared_lock<std::shared_mutex> lock(sim_.getEngineMutex());
+                    body = sim_.getEngine().getCandleAggregator().getAllCandlesJson(interval, since);
                 }
+                res.set_header("Vary", "Accept");
+                res.set_content(std::move(body), "application/json");
+                return;
             }
 
-            res.set_content(jsonResponse(j), "application/json");
-            });
+            std::map<std::string, std::vector<Candle>> candles;
+            {
+                std::shared_lock<std::shared_mutex> lock(sim_.getEngineMutex());
+                candles = sim_.getEngine().getCandleAggregator().getAllCandles(interval, since);
+            }
+            nlohmann::json j = nlohmann::json::object();
+            for (const auto& [symbol, series] : candles) {
+                if (columns) {
+                    nlohmann::json c = {
+                        {"time", nlohmann::json::array()}, {"open", nlohmann::json::array()},
+                        {"high", nlohmann::json::array()}, {"low", nlohmann::json::array()},
+                        {"close", nlohmann::json::array()}, {"volume", nlohmann::json::array()} };
+                    for (const auto& candle : series) {
+                        c["time"].push_back(candle.time);
+                        c["open"].push_back(candle.open);
+                        c["high"].push_back(candle.high);
+                        c["low"].push_back(candle.low);
+                        c["close"].push_back(candle.close);
+                        c["volume"].push_back(candle.volume);
+                    }
+                    j[symbol] = std::move(c);
+                }
+                else {
+                    nlohmann::json rows = nlohmann::json::array();
+                    for (const auto& candle : series) {
+                        rows.push_back({ {"time", candle.time}, {"open", candle.open}, {"high", candle.high},
+                            {"low", candle.low}, {"close", candle.close}, {"volume", candle.volume} });
+                    }
+                    j[symbol] = std::move(rows);
+                }
+            }
+            sendEncoded(res, j, encoding);
+            }, RouteClass::BULK);
 
         // GET /candles/:symbol - Get OHLCV candles for a symbol
-        server_.Get(R"(/candles/(\w+))", [this](const httplib::Request& req, httplib::Response& res) {
-            std::shared_lock<std::shared_mutex> lock(sim_.getEngineMutex());
+        get(R"(/candles/(\w+))", [this](const httplib::Request& req, httplib::Response& res) {
             std::string symbol = req.matches[1];
 
             // Parse query params
@@ -667,26 +1170,16 @@ namespace market {
 
             auto interval = CandleAggregator::parseInterval(intervalStr);
 
-            auto candles = sim_.getEngine().getCandleAggregator().getCandles(
-                symbol, interval, since, limit);
-
-            nlohmann::json j = nlohmann::json::array();
-            for (const auto& c : candles) {
-                j.push_back({
-                    {"time", c.time},
-                    {"open", c.open},
-                    {"high", c.high},
-                    {"low", c.low},
-                    {"close", c.close},
-                    {"volume", c.volume}
-                    });
+            std::string body;
+            {
+                std::shared_lock<std::shared_mutex> lock(sim_.getEngineMutex());
+                body = sim_.getEngine().getCandleAggregator().getCandlesJson(symbol, interval, since, limit);
             }
-
-            res.set_content(jsonResponse(j), "application/json");
-            });
+            res.set_content(std::move(body), "application/json");
+            }, RouteClass::BULK);
 
         // POST /populate - Populate historical data (async)
-        server_.Post("/populate", [this](const httplib::Request& req, httplib::Response& res) {
+        post("/populate", [this](const httplib::Request& req, httplib::Response& res) {
             try {
                 auto body = nlohmann::json::parse(req.body);
                 int days = body.value("days", 180);
@@ -729,63 +1222,171 @@ namespace market {
             }
             });
 
-        // POST /restore - Restore simulation state from saved data
-        server_.Post("/restore", [this](const httplib::Request& req, httplib::Response& res) {
+        // POST /checkpoint - Write a binary checkpoint of the full state
+        post("/checkpoint", [this](const httplib::Request& req, httplib::Response& res) {
             try {
-                std::unique_lock<std::shared_mutex> lock(sim_.getEngineMutex());
-                auto body = nlohmann::json::parse(req.body);
-                sim_.restore(body);
-                res.set_content(jsonResponse({ {"status", "ok"} }), "application/json");
+                auto body = nlohmann::json::parse(req.body.empty() ? "{}" : req.body);
+                std::string path = body.value("path", "/data/checkpoint.bin");
+
+                if (sim_.isPopulating()) {
+                    res.status = 400;
+                    res.set_content(errorResponse("Cannot checkpoint while populating"), "application/json");
+                    return;
+                }
+
+                size_t bytes = sim_.saveCheckpoint(path);
+                res.set_content(jsonResponse({
+                    {"status", "ok"},
+                    {"path", path},
+                    {"bytes", bytes},
+                    {"tick", sim_.getCurrentTick()}
+                    }), "application/json");
+            }
+            catch (const std::exception& e) {
+                res.status = 500;
+                res.set_content(errorResponse(e.what()), "application/json");
+            }
+            }, RouteClass::CRITICAL);
+
+        // POST /restore - Replace the running state with a binary checkpoint
+        post("/restore", [this](const httplib::Request& req, httplib::Response& res) {
+            try {
+                auto body = nlohmann::json::parse(req.body.empty() ? "{}" : req.body);
+                std::string path = body.value("path", "/data/checkpoint.bin");
+
+                if (sim_.isPopulating()) {
+                    res.status = 400;
+                    res.set_content(errorResponse("Cannot restore while populating"), "application/json");
+                    return;
+                }
+
+                sim_.loadCheckpoint(path);
+                res.set_content(jsonResponse({
+                    {"status", "ok"},
+                    {"path", path},
+                    {"tick", sim_.getCurrentTick()}
+                    }), "application/json");
             }
             catch (const std::exception& e) {
                 res.status = 400;
                 res.set_content(errorResponse(e.what()), "application/json");
             }
-            });
+            }, RouteClass::CRITICAL);
 
-        // GET /news/history - Get recent news history
-        server_.Get("/news/history", [this](const httplib::Request& req, httplib::Response& res) {
-            std::shared_lock<std::shared_mutex> lock(sim_.getEngineMutex());
-            int limit = req.has_param("limit") ? std::stoi(req.get_param_value("limit")) : 50;
-
-            auto& newsGen = sim_.getEngine().getNewsGenerator();
-            auto history = newsGen.getNewsHistory();
-
-            // Return last N events  
-            nlohmann::json j = nlohmann::json::array();
-            size_t start = history.size() > static_cast<size_t>(limit) ? history.size() - limit : 0;
-            for (size_t i = start; i < history.size(); ++i) {
-                const auto& n = history[i];
-                std::string catStr;
-                switch (n.category) {
-                case NewsCategory::GLOBAL: catStr = "global"; break;
-                case NewsCategory::POLITICAL: catStr = "political"; break;
-                case NewsCategory::SUPPLY: catStr = "supply"; break;
-                case NewsCategory::DEMAND: catStr = "demand"; break;
-                }
-                j.push_back({
-                    {"headline", n.headline},
-                    {"category", catStr},
-                    {"sentiment", n.sentiment == NewsSentiment::POSITIVE ? "positive" :
-                                  n.sentiment == NewsSentiment::NEGATIVE ? "negative" : "neutral"},
-                    {"magnitude", n.magnitude},
-                    {"symbol", n.symbol},
-                    {"subcategory", n.subcategory},
-                    {"timestamp", n.timestamp}
-                    });
+        // POST /journal - Start or stop the order-flow journal
+        post("/journal", [this](const httplib::Request& req, httplib::Response& res) {
+            try {
+                auto body = nlohmann::json::parse(req.body.empty() ? "{}" : req.body);
+                std::string action = body.value("action", "start");
+
+                if (action == "start") {
+                    sim_.startJournal(body.value("path", "/data/journal.bin"));
+                }
+                else if (action == "stop") {
+                    sim_.stopJournal();
+                }
+                else {
+                    res.status = 400;
+                    res.set_content(errorResponse("Invalid action. Must be: start, stop"), "application/json");
+                    return;
+                }
+                res.set_content(jsonResponse(sim_.getJournalJson()), "application/json");
+            }
+            catch (const std::exception& e) {
+                res.status = 400;
+                res.set_content(errorResponse(e.what()), "application/json");
             }
+            });
 
-            res.set_content(jsonResponse(j), "application/json");
+        // GET /journal - Journal status
+        get("/journal", [this](const httplib::Request&, httplib::Response& res) {
+            res.set_content(jsonResponse(sim_.getJournalJson()), "application/json");
             });
 
-        // POST /export - Export tick data to files
-        server_.Post("/export", [this](const httplib::Request& req, httplib::Response& res) {
+        // POST /journal/replay - Replace the state with a journal's start and replay it
+        post("/journal/replay", [this](const httplib::Request& req, httplib::Response& res) {
+            try {
+                auto body = nlohmann::json::parse(req.body.empty() ? "{}" : req.body);
+                std::string path = body.value("path", "/data/journal.bin");
+
+                auto start = std::chrono::steady_clock::now();
+                uint64_t ticks = sim_.replayJournal(path);
+                double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                res.set_content(jsonResponse({
+                    {"status", "ok"},
+                    {"path", path},
+                    {"ticks", ticks},
+                    {"elapsedSec", sec},
+                    {"tick", sim_.getCurrentTick()}
+                    }), "application/json");
+            }
+            catch (const std::exception& e) {
+                res.status = 400;
+                res.set_content(errorResponse(e.what()), "application/json");
+            }
+            });
+
+        // GET /news/history?limit=&since=&until=&symbol= - The newest `limit`
+        // news events (default 50) with ticks in [since, until), optionally
+        // of one symbol, oldest first. Read from the news log by its tick
+        // and symbol indexes; no engine lock.
+        get("/news/history", [this](const httplib::Request& req, httplib::Response& res) {
+            try {
+                size_t limit = req.has_param("limit") ? std::stoul(req.get_param_value("limit")) : 50;
+                uint64_t since = req.has_param("since") ? std::stoull(req.get_param_value("since")) : 0;
+                uint64_t until = req.has_param("until") ? std::stoull(req.get_param_value("until")) : UINT64_MAX;
+                std::string symbol = req.has_param("symbol") ? req.get_param_value("symbol") : "";
+
+                bool columns = wantsColumns(req);
+                nlohmann::json j = columns ? nlohmann::json::object() : nlohmann::json::array();
+                if (columns) {
+                    for (const char* field : { "tick", "headline", "category", "sentiment", "magnitude",
+                        "symbol", "subcategory", "timestamp" }) {
+                        j[field] = nlohmann::json::array();
+                    }
+                }
+                sim_.getTickBuffer().forEachNews(since, until, symbol, limit, [&](const NewsLog::Record& n) {
+                    if (columns) {
+                        j["tick"].push_back(n.tick);
+                        j["headline"].push_back(n.headline);
+                        j["category"].push_back(n.category);
+                        j["sentiment"].push_back(n.sentiment);
+                        j["magnitude"].push_back(n.magnitude);
+                        j["symbol"].push_back(n.symbol);
+                        j["subcategory"].push_back(n.subcategory);
+                        j["timestamp"].push_back(n.timestamp);
+                        return;
+                    }
+                    j.push_back({
+                        {"tick", n.tick},
+                        {"headline", n.headline},
+                        {"category", n.category},
+                        {"sentiment", n.sentiment},
+                        {"magnitude", n.magnitude},
+                        {"symbol", n.symbol},
+                        {"subcategory", n.subcategory},
+                        {"timestamp", n.timestamp}
+                    });
+                });
+                sendEncoded(res, j, acceptedEncoding(req));
+            }
+            catch (const std::exception& e) {
+                res.status = 400;
+                res.set_content(errorResponse(e.what()), "application/json");
+            }
+            }, RouteClass::BULK);
+
+        // POST /export - Export tick data to files in the background. The
+        // export covers the ticks recorded when it starts; poll
+        // GET /export/status, or pass "wait": true to answer once it ends.
+        post("/export", [this](const httplib::Request& req, httplib::Response& res) {
             try {
                 auto body = nlohmann::json::parse(req.body.empty() ? "{}" : req.body);
 
                 std::string format = body.value("format", "json");
                 std::string dataDir = body.value("dataDir", "/data");
                 size_t maxTicks = body.value("maxTicks", 0);
+                bool wait = body.value("wait", false);
 
                 if (sim_.isPopulating()) {
                     res.status = 400;
@@ -793,35 +1394,56 @@ namespace market {
                     return;
                 }
 
-                bool success = false;
+                using Format = TickBuffer::ExportFormat;
+                std::vector<TickBuffer::ExportTarget> targets;
                 std::string fullPath;
-
                 if (format == "csv") {
                     fullPath = dataDir + "/csv";
-                    success = sim_.getTickBuffer().exportToCsv(fullPath, maxTicks);
+                    targets.push_back({ Format::CSV, fullPath, maxTicks });
+                }
+                else if (format == "arrow") {
+                    fullPath = dataDir + "/arrow";
+                    targets.push_back({ Format::ARROW, fullPath, maxTicks });
                 }
                 else {
                     fullPath = dataDir + "/full_1m.json";
-                    success = sim_.getTickBuffer().exportToJson(fullPath, maxTicks);
+                    targets.push_back({ Format::JSON, fullPath, maxTicks });
+                    if (maxTicks == 0) targets.push_back({ Format::JSON, dataDir + "/dev_100k.json", 100000 });
+                }
 
-                    if (success && maxTicks == 0) {
-                        std::string devPath = dataDir + "/dev_100k.json";
-                        success = sim_.getTickBuffer().exportToJson(devPath, 100000);
-                    }
+                auto& buffer = sim_.getTickBuffer();
+                try {
+                    buffer.startExport(std::move(targets));
+                }
+                catch (const std::runtime_error& e) {
+                    res.status = 409;
+                    res.set_content(errorResponse(e.what()), "application/json");
+                    return;
                 }
 
-                if (success) {
-                    res.set_content(jsonResponse({
-                        {"status", "ok"},
-                        {"path", fullPath},
-                        {"format", format},
-                        {"ticksExported", sim_.getTickBuffer().getTickCount()}
-                        }), "application/json");
+                auto status = buffer.getExportStatus();
+                if (wait) {
+                    while (status.state == TickBuffer::ExportStatus::State::RUNNING) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                        status = buffer.getExportStatus();
+                    }
+                    if (status.state != TickBuffer::ExportStatus::State::DONE) {
+                        res.status = 500;
+                        res.set_content(errorResponse(status.state == TickBuffer::ExportStatus::State::CANCELLED
+                            ? "Export cancelled" : "Export failed"), "application/json");
+                        return;
+                    }
                 }
                 else {
-                    res.status = 500;
-                    res.set_content(errorResponse("Export failed"), "application/json");
+                    res.status = 202;
                 }
+
+                res.set_content(jsonResponse({
+                    {"status", wait ? "ok" : "started"},
+                    {"path", fullPath},
+                    {"format", format},
+                    {"ticksExported", status.ticks}
+                    }), "application/json");
             }
             catch (const std::exception& e) {
                 res.status = 400;
@@ -829,20 +1451,167 @@ namespace market {
             }
             });
 
-        // GET /export/status - Check export status
-        server_.Get("/export/status", [this](const httplib::Request&, httplib::Response& res) {
+        // GET /export/status - Progress of the current or last export job
+        get("/export/status", [this](const httplib::Request&, httplib::Response& res) {
             auto& buffer = sim_.getTickBuffer();
+            auto status = buffer.getExportStatus();
 
             res.set_content(jsonResponse({
-                {"isExporting", buffer.isExporting()},
-                {"progress", buffer.getExportProgress()},
+                {"isExporting", status.state == TickBuffer::ExportStatus::State::RUNNING},
+                {"state", TickBuffer::ExportStatus::stateName(status.state)},
+                {"progress", status.progress},
+                {"exportTicks", status.ticks},
+                {"paths", status.paths},
+                {"error", status.error},
                 {"totalTicks", buffer.getTickCount()},
                 {"currentTick", buffer.getCurrentTick()}
                 }), "application/json");
             });
 
+        // POST /export/cancel - Stop the running export job and delete its partial output
+        post("/export/cancel", [this](const httplib::Request&, httplib::Response& res) {
+            auto& buffer = sim_.getTickBuffer();
+            bool running = buffer.getExportStatus().state == TickBuffer::ExportStatus::State::RUNNING;
+            buffer.cancelExport();
+            res.set_content(jsonResponse({ {"status", running ? "cancelling" : "idle"} }), "application/json");
+            }, RouteClass::CRITICAL);
+
+        // POST /ensemble - Run independent replicas of the loaded config (async)
+        post("/ensemble", [this](const httplib::Request& req, httplib::Response& res) {
+            try {
+                auto body = nlohmann::json::parse(req.body.empty() ? "{}" : req.body);
+                EnsembleOptions options = EnsembleOptions::fromJson(body);
+                if (!body.contains("outputDir")) options.outputDir = "/data/ensemble";
+                if (options.replicas <= 0) {
+                    res.status = 400;
+                    res.set_content(errorResponse("replicas must be positive"), "application/json");
+                    return;
+                }
+
+                std::lock_guard<std::mutex> guard(ensembleMutex_);
+                if (ensemble_ && !ensemble_->isDone()) {
+                    res.status = 400;
+                    res.set_content(errorResponse("Ensemble already in progress"), "application/json");
+                    return;
+                }
+
+                // Replicas start from the loaded config with live overrides applied
+                nlohmann::json config;
+                nlohmann::json commodities;
+                {
+                    std::shared_lock<std::shared_mutex> lock(sim_.getEngineMutex());
+                    config = sim_.getConfigJson().is_object() ? sim_.getConfigJson() : nlohmann::json::object();
+                    config.merge_patch(sim_.getRuntimeConfig()->toJson());
+                    commodities = sim_.getCommoditiesData();
+                }
+
+                Logger::info("[API] POST /ensemble replicas={} baseSeed={}", options.replicas, options.baseSeed);
+                ensemble_.reset();
+                ensemble_ = std::make_unique<EnsembleRunner>(std::move(config), std::move(commodities), options);
+                ensemble_->start();
+
+                res.set_content(jsonResponse({
+                    {"status", "started"},
+                    {"message", "Ensemble started. Poll GET /ensemble for progress."},
+                    {"replicas", options.replicas},
+                    {"outputDir", options.outputDir}
+                    }), "application/json");
+            }
+            catch (const std::exception& e) {
+                res.status = 400;
+                res.set_content(errorResponse(e.what()), "application/json");
+            }
+            });
+
+        // GET /ensemble - Progress of the current or last ensemble
+        get("/ensemble", [this](const httplib::Request&, httplib::Response& res) {
+            std::lock_guard<std::mutex> guard(ensembleMutex_);
+            if (!ensemble_) {
+                res.status = 404;
+                res.set_content(errorResponse("No ensemble has been started"), "application/json");
+                return;
+            }
+            res.set_content(jsonResponse(ensemble_->getProgressJson()), "application/json");
+            });
+
+        // POST /ensemble/cancel - Skip replicas that have not started yet
+        post("/ensemble/cancel", [this](const httplib::Request&, httplib::Response& res) {
+            std::lock_guard<std::mutex> guard(ensembleMutex_);
+            if (ensemble_) ensemble_->cancel();
+            res.set_content(jsonResponse({ {"status", ensemble_ ? "cancelling" : "idle"} }), "application/json");
+            }, RouteClass::CRITICAL);
+
+        // GET /ticks?start=&count=&symbols=A,B - Recorded ticks [start, start + count)
+        // per symbol, streamed in chunks straight from a range of the tick buffer
+        // The body is encoded after this handler returns, so the provider holds
+        // the bulk slot until it is done
+        getWithSlot("/ticks", [this](const httplib::Request& req, httplib::Response& res, Slot slot) {
+            constexpr size_t MAX_TICKS = 1000000;  // Per symbol and request
+            std::shared_ptr<TickBuffer::TickRange> range;
+            try {
+                size_t start = req.has_param("start") ? std::stoull(req.get_param_value("start")) : 0;
+                size_t count = req.has_param("count") ? std::stoull(req.get_param_value("count")) : 1000;
+                std::vector<std::string> symbols;
+                if (req.has_param("symbols")) {
+                    std::stringstream list(req.get_param_value("symbols"));
+                    for (std::string symbol; std::getline(list, symbol, ',');) {
+                        if (!symbol.empty()) symbols.push_back(symbol);
+                    }
+                }
+                range = std::make_shared<TickBuffer::TickRange>(
+                    sim_.getTickBuffer().getTickRange(start, std::min(count, MAX_TICKS), symbols));
+            }
+            catch (const std::runtime_error& e) {
+                res.status = 404;
+                res.set_content(errorResponse(e.what()), "application/json");
+                return;
+            }
+            catch (const std::exception& e) {
+                res.status = 400;
+                res.set_content(errorResponse(std::string("Invalid range: ") + e.what()), "application/json");
+                return;
+            }
+
+            res.set_header("X-Current-Tick", std::to_string(range->currentTick));
+            res.set_chunked_content_provider(
+                "application/json",
+                [range, slot](size_t /*offset*/, httplib::DataSink& sink) {
+                    FormatBuffer out([&sink](const char* data, size_t size) { return sink.write(data, size); },
+                        64 * 1024);
+                    size_t start = range->series.empty() ? 0 : range->series.front().begin;
+                    size_t count = range->series.empty() ? 0 : range->series.front().size();
+                    out.put("{\"start\":").putUInt(start)
+                       .put(",\"count\":").putUInt(count)
+                       .put(",\"currentTick\":").putUInt(range->currentTick)
+                       .put(",\"symbols\":{");
+                    for (size_t i = 0; i < range->series.size() && out.good(); ++i) {
+                        const auto& series = range->series[i];
+                        if (i > 0) out.put(',');
+                        out.put('"').put(series.symbol).put("\":[");
+                        bool first = true;
+                        series.forEach([&](const TickData& td) {
+                            if (!out.good()) return;
+                            if (!first) out.put(',');
+                            first = false;
+                            out.put("{\"tick\":").putUInt(td.tick)
+                               .put(",\"open\":").putShortest(static_cast<float>(td.open))
+                               .put(",\"high\":").putShortest(static_cast<float>(td.high))
+                               .put(",\"low\":").putShortest(static_cast<float>(td.low))
+                               .put(",\"close\":").putShortest(static_cast<float>(td.close))
+                               .put(",\"volume\":").putShortest(static_cast<float>(td.volume)).put('}');
+                        });
+                        out.put(']');
+                    }
+                    out.put("}}\n");
+                    if (!out.flush()) return false;  // Connection closed
+                    sink.done();
+                    return true;
+                }
+            );
+            }, RouteClass::BULK);
+
         // GET /ticks/count - Get tick count in buffer
-        server_.Get("/ticks/count", [this](const httplib::Request&, httplib::Response& res) {
+        get("/ticks/count", [this](const httplib::Request&, httplib::Response& res) {
             res.set_content(jsonResponse({
                 {"count", sim_.getTickBuffer().getTickCount()},
                 {"currentTick", sim_.getTickBuffer().getCurrentTick()}
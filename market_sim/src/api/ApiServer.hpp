@@ -1,9 +1,17 @@
 #pragma once
 
 #include "engine/Simulation.hpp"
+#include "engine/EnsembleRunner.hpp"
+#include "api/StreamBroadcaster.hpp"
+#include "api/BookFeed.hpp"
+#include "api/ResponseCache.hpp"
+#include "api/AdmissionControl.hpp"
 #include <httplib.h>
 #include <thread>
 #include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace market {
 
@@ -25,12 +33,81 @@ private:
     
     std::thread serverThread_;
     std::atomic<bool> running_{false};
+
+    // /stream fan-out: one serialization per update for all clients
+    std::unique_ptr<StreamBroadcaster> stream_;
+    std::unique_ptr<BookFeed> feed_;  // Binary /feed of book changes
+
+    // Bodies of the read endpoints, per publication
+    ResponseCache responseCache_;
+
+    // At most one ensemble at a time; a finished one is kept for its report
+    std::mutex ensembleMutex_;
+    std::unique_ptr<EnsembleRunner> ensemble_;
+
+    // Which requests get a worker's time when the server is saturated;
+    // sized from the "http" config section
+    AdmissionControl admission_;
+    LatencyHistogram connectionWait_;  // From accept to a worker picking the connection up
+    int retryAfterSec_ = 1;
+
+    using RouteClass = AdmissionControl::RouteClass;
+
+    // Per registered route: requests, 503s, and handler time (the latter
+    // only with ENABLE_PROFILING)
+    struct RouteStats {
+        std::string method;
+        std::string pattern;  // Capture groups shown as "*"
+        RouteClass routeClass;
+        std::atomic<uint64_t> requests{0};
+        std::atomic<uint64_t> rejected{0};
+        LatencyHistogram latency;
+    };
+    std::vector<std::unique_ptr<RouteStats>> routeStats_;
     
     void setupRoutes();
+
+    // Register a route in an admission class, counting and timing its
+    // handler into routeStats_
+    void get(const std::string& pattern, httplib::Server::Handler handler,
+             RouteClass routeClass = RouteClass::READ);
+    void post(const std::string& pattern, httplib::Server::Handler handler,
+              RouteClass routeClass = RouteClass::READ);
+    httplib::Server::Handler admitted(const std::string& method, const std::string& pattern,
+                                      RouteClass routeClass, httplib::Server::Handler handler);
+
+    // As get(), for a handler whose response is produced after it returns
+    // (a content provider): it is passed its admission ticket to hold
+    // until then
+    using Slot = std::shared_ptr<AdmissionControl::Ticket>;
+    using SlotHandler = std::function<void(const httplib::Request&, httplib::Response&, Slot)>;
+    void getWithSlot(const std::string& pattern, SlotHandler handler, RouteClass routeClass);
+    httplib::Server::Handler admitted(const std::string& method, const std::string& pattern,
+                                      RouteClass routeClass, SlotHandler handler);
+    RouteStats& addRoute(const std::string& method, const std::string& pattern, RouteClass routeClass);
+    static std::string routeLabel(const std::string& pattern);
+    void busy(httplib::Response& res) const;  // 503 with Retry-After, closing the connection
+    nlohmann::json httpStatsJson() const;
+
+    // Replies with the body cached for this request under the current
+    // publication, building it on a miss, or 304 if If-None-Match names it
+    void cached(const httplib::Request& req, httplib::Response& res,
+                const std::function<std::string()>& build);
+    // True if cpp-httplib will gzip or deflate a text response to `req`
+    static bool compressesResponse(const httplib::Request& req);
+    uint64_t publicationStamp() const;
     
     // Helper for JSON responses
     static std::string jsonResponse(const nlohmann::json& j);
     static std::string errorResponse(const std::string& message);
+
+    // Bulk endpoint bodies: JSON, or MessagePack / CBOR when the Accept
+    // header prefers them. ?layout=columns asks for an object of arrays
+    // (one per field) instead of an array of objects.
+    enum class Encoding { JSON, MSGPACK, CBOR };
+    static Encoding acceptedEncoding(const httplib::Request& req);
+    static bool wantsColumns(const httplib::Request& req);
+    static void sendEncoded(httplib::Response& res, const nlohmann::json& j, Encoding encoding);
 };
 
 } // namespace market
@@ -0,0 +1,405 @@
+#include "BookFeed.hpp"
+#include "engine/Simulation.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace market {
+
+    namespace {
+
+        template <typename T>
+        void put(std::string& out, T value) {
+            char bytes[sizeof(T)];
+            std::memcpy(bytes, &value, sizeof(T));
+            out.append(bytes, sizeof(T));
+        }
+
+        // Writes a header with a zero length; endMessage() fills it in
+        size_t beginMessage(std::string& out, BookFeed::MessageType type, BookFeed::Side side,
+            uint32_t symbol, uint64_t seq) {
+            size_t start = out.size();
+            put<uint16_t>(out, 0);
+            put(out, static_cast<uint8_t>(type));
+            put(out, static_cast<uint8_t>(side));
+            put(out, symbol);
+            put(out, seq);
+            return start;
+        }
+
+        void endMessage(std::string& out, size_t start) {
+            uint16_t length = static_cast<uint16_t>(out.size() - start);
+            std::memcpy(&out[start], &length, sizeof(length));
+        }
+
+        void putLevel(std::string& out, const BookLevel& level) {
+            put(out, level.price);
+            put(out, static_cast<int64_t>(level.totalQuantity));
+            put(out, static_cast<uint32_t>(level.orderCount));
+        }
+
+        // Bounds-checked reads over one message
+        class Reader {
+        public:
+            Reader(const char* data, size_t size) : data_(data), end_(data + size) {}
+
+            template <typename T>
+            T get() {
+                if (static_cast<size_t>(end_ - data_) < sizeof(T)) {
+                    throw std::runtime_error("Book feed message truncated");
+                }
+                T value;
+                std::memcpy(&value, data_, sizeof(T));
+                data_ += sizeof(T);
+                return value;
+            }
+
+            BookLevel level() {
+                BookLevel l;
+                l.price = get<double>();
+                l.totalQuantity = get<int64_t>();
+                l.orderCount = static_cast<int>(get<uint32_t>());
+                return l;
+            }
+
+            std::string rest() {
+                std::string s(data_, end_);
+                data_ = end_;
+                return s;
+            }
+
+        private:
+            const char* data_;
+            const char* end_;
+        };
+
+        bool sameLevel(const BookLevel& a, const BookLevel& b) {
+            return a.totalQuantity == b.totalQuantity && a.orderCount == b.orderCount;
+        }
+
+    } // namespace
+
+    BookFeed::BookFeed(const Simulation& sim)
+        : BookFeed(sim, Options{})
+    {
+    }
+
+    BookFeed::BookFeed(const Simulation& sim, Options options)
+        : sim_(sim)
+        , options_(options)
+    {
+        options_.queueFrames = std::max<size_t>(options_.queueFrames, 2);
+    }
+
+    BookFeed::~BookFeed() {
+        stop();
+    }
+
+    void BookFeed::start() {
+        if (running_.exchange(true)) return;
+        thread_ = std::thread([this] { run(); });
+    }
+
+    void BookFeed::stop() {
+        if (running_.exchange(false)) {
+            {
+                std::lock_guard<std::mutex> lock(wakeMutex_);
+            }
+            wake_.notify_all();
+            if (thread_.joinable()) thread_.join();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& s : subscribers_) s.queue->close();
+        subscribers_.clear();
+        stats_.subscribers = 0;
+    }
+
+    std::shared_ptr<FrameQueue> BookFeed::subscribe(const std::vector<std::string>& symbols) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (subscribers_.size() >= options_.maxSubscribers) {
+            stats_.rejected++;
+            return nullptr;
+        }
+        auto queue = std::make_shared<FrameQueue>(options_.queueFrames);
+        subscribers_.push_back({ queue, symbols, {}, false });
+        stats_.subscribers = subscribers_.size();
+        wake_.notify_all();  // The thread idles without subscribers
+        return queue;
+    }
+
+    void BookFeed::unsubscribe(const std::shared_ptr<FrameQueue>& subscription) {
+        if (!subscription) return;
+        subscription->close();
+        std::lock_guard<std::mutex> lock(mutex_);
+        subscribers_.erase(std::remove_if(subscribers_.begin(), subscribers_.end(),
+            [&](const Subscriber& s) { return s.queue == subscription; }), subscribers_.end());
+        stats_.subscribers = subscribers_.size();
+    }
+
+    BookFeed::Stats BookFeed::getStats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+    void BookFeed::reset(const MarketSnapshot& snapshot) {
+        symbols_.clear();
+        std::string directory;
+        for (const auto& commodity : snapshot.commodities) {
+            SymbolState state;
+            state.name = commodity.symbol;
+            auto it = snapshot.books.find(commodity.symbol);
+            if (it != snapshot.books.end()) state.book = it->second;
+            state.candleTime = commodity.lastCandle.time;
+
+            size_t start = beginMessage(directory, MessageType::SYMBOL, Side::BID,
+                static_cast<uint32_t>(symbols_.size()), 0);
+            directory += commodity.symbol;
+            endMessage(directory, start);
+            symbols_.push_back(std::move(state));
+        }
+        directory_ = std::make_shared<const std::string>(std::move(directory));
+        for (uint32_t i = 0; i < symbols_.size(); ++i) symbols_[i].snapshot = encodeSnapshot(i, snapshot);
+    }
+
+    BookFeed::Frame BookFeed::encodeSnapshot(uint32_t symbol, const MarketSnapshot& snapshot) const {
+        const SymbolState& state = symbols_[symbol];
+        std::string out;
+        size_t start = beginMessage(out, MessageType::BOOK_SNAPSHOT, Side::BID, symbol, state.seq);
+        put<uint64_t>(out, snapshot.tick);
+        put(out, static_cast<uint16_t>(state.book.bids.size()));
+        put(out, static_cast<uint16_t>(state.book.asks.size()));
+        for (const auto& level : state.book.bids) putLevel(out, level);
+        for (const auto& level : state.book.asks) putLevel(out, level);
+        endMessage(out, start);
+        return std::make_shared<const std::string>(std::move(out));
+    }
+
+    void BookFeed::diffLevels(std::string& out, uint32_t symbol, Side side,
+        const std::vector<BookLevel>& before, const std::vector<BookLevel>& after) {
+        auto find = [](const std::vector<BookLevel>& levels, Price price) {
+            return std::find_if(levels.begin(), levels.end(), [price](const BookLevel& l) { return l.price == price; });
+        };
+        uint64_t& seq = symbols_[symbol].seq;
+
+        // Deletes first, so a client's book never holds more than the depth
+        for (const auto& level : before) {
+            if (find(after, level.price) != after.end()) continue;
+            size_t start = beginMessage(out, MessageType::LEVEL_DELETE, side, symbol, ++seq);
+            put(out, level.price);
+            endMessage(out, start);
+        }
+        for (const auto& level : after) {
+            auto old = find(before, level.price);
+            if (old != before.end() && sameLevel(*old, level)) continue;
+            MessageType type = old == before.end() ? MessageType::LEVEL_ADD : MessageType::LEVEL_CHANGE;
+            size_t start = beginMessage(out, type, side, symbol, ++seq);
+            putLevel(out, level);
+            endMessage(out, start);
+        }
+    }
+
+    void BookFeed::publish() {
+        auto snapshot = sim_.getSnapshot();
+        uint64_t lastTrade = snapshot->recentTrades.empty() ? lastTradeSeq_ : snapshot->recentTrades.back().seq;
+        std::vector<Frame> deltas;  // By symbol; null when nothing changed
+        bool resync = false;
+
+        if (!published_ || snapshot->version != lastVersion_) {
+            bool sameSymbols = published_ && symbols_.size() == snapshot->commodities.size();
+            for (size_t i = 0; sameSymbols && i < symbols_.size(); ++i) {
+                sameSymbols = symbols_[i].name == snapshot->commodities[i].symbol;
+            }
+
+            if (!sameSymbols) {
+                reset(*snapshot);
+                resync = published_;
+            }
+            else {
+                // Trades beyond RECENT_TRADES per poll are not in the snapshot, and
+                // which symbols they were for is not known: every symbol's seq skips
+                // one ahead of this poll's messages, so each client sees the gap
+                bool lostTrades = !snapshot->recentTrades.empty() &&
+                    snapshot->recentTrades.front().seq > lastTradeSeq_ + 1;
+                if (lostTrades) {
+                    for (auto& state : symbols_) state.seq++;
+                }
+
+                std::vector<std::string> out(symbols_.size());
+                static const OrderBookSnapshot emptyBook{};
+                for (uint32_t i = 0; i < symbols_.size(); ++i) {
+                    SymbolState& state = symbols_[i];
+                    auto it = snapshot->books.find(state.name);
+                    const OrderBookSnapshot& book = it != snapshot->books.end() ? it->second : emptyBook;
+                    diffLevels(out[i], i, Side::BID, state.book.bids, book.bids);
+                    diffLevels(out[i], i, Side::ASK, state.book.asks, book.asks);
+                    state.book = book;
+                }
+
+                for (const auto& trade : snapshot->recentTrades) {
+                    if (trade.seq <= lastTradeSeq_ || trade.commodity >= symbols_.size()) continue;
+                    size_t start = beginMessage(out[trade.commodity], MessageType::TRADE, Side::BID,
+                        trade.commodity, ++symbols_[trade.commodity].seq);
+                    std::string& buf = out[trade.commodity];
+                    put(buf, trade.price);
+                    put(buf, static_cast<int64_t>(trade.quantity));
+                    put<uint64_t>(buf, trade.timestamp);
+                    endMessage(out[trade.commodity], start);
+                }
+
+                for (uint32_t i = 0; i < symbols_.size(); ++i) {
+                    const Candle& candle = snapshot->commodities[i].lastCandle;
+                    if (candle.time == 0 || candle.time == symbols_[i].candleTime) continue;
+                    symbols_[i].candleTime = candle.time;
+                    size_t start = beginMessage(out[i], MessageType::CANDLE, Side::BID, i, ++symbols_[i].seq);
+                    put<uint64_t>(out[i], candle.time);
+                    put(out[i], candle.open);
+                    put(out[i], candle.high);
+                    put(out[i], candle.low);
+                    put(out[i], candle.close);
+                    put(out[i], candle.volume);
+                    endMessage(out[i], start);
+                }
+
+                deltas.resize(symbols_.size());
+                uint64_t messages = 0;
+                uint64_t bytes = 0;
+                for (uint32_t i = 0; i < symbols_.size(); ++i) {
+                    if (out[i].empty()) {
+                        if (lostTrades) symbols_[i].snapshot = encodeSnapshot(i, *snapshot);
+                        continue;
+                    }
+                    for (size_t pos = 0; pos < out[i].size(); messages++) {
+                        uint16_t length;
+                        std::memcpy(&length, out[i].data() + pos, sizeof(length));
+                        pos += length;
+                    }
+                    bytes += out[i].size();
+                    deltas[i] = std::make_shared<const std::string>(std::move(out[i]));
+                    symbols_[i].snapshot = encodeSnapshot(i, *snapshot);
+                }
+                std::lock_guard<std::mutex> lock(mutex_);
+                stats_.messages += messages;
+                stats_.bytes += bytes;
+                if (lostTrades) stats_.tradeGaps++;
+            }
+            published_ = true;
+            lastVersion_ = snapshot->version;
+        }
+        lastTradeSeq_ = lastTrade;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto keep = subscribers_.begin();
+        for (auto& s : subscribers_) {
+            bool ok = true;
+            if (resync && s.primed) {
+                s.queue->close();  // Its symbol indexes no longer hold
+                ok = false;
+            }
+            else if (!s.primed) {
+                s.wanted.assign(symbols_.size(), s.symbols.empty());
+                for (const auto& name : s.symbols) {
+                    for (size_t i = 0; i < symbols_.size(); ++i) {
+                        if (symbols_[i].name == name) s.wanted[i] = true;
+                    }
+                }
+                ok = s.queue->push(directory_);
+                for (size_t i = 0; ok && i < symbols_.size(); ++i) {
+                    if (s.wanted[i]) ok = s.queue->push(symbols_[i].snapshot);
+                }
+                s.primed = true;
+            }
+            else {
+                for (size_t i = 0; ok && i < deltas.size(); ++i) {
+                    if (deltas[i] && s.wanted[i]) ok = s.queue->push(deltas[i]);
+                }
+            }
+            if (ok) {
+                if (&*keep != &s) *keep = std::move(s);
+                ++keep;
+            }
+            else if (s.queue->isDropped()) {
+                stats_.dropped++;
+            }
+        }
+        subscribers_.erase(keep, subscribers_.end());
+        stats_.subscribers = subscribers_.size();
+    }
+
+    size_t BookFeed::decode(const char* data, size_t size, std::vector<Message>& out) {
+        size_t pos = 0;
+        while (size - pos >= sizeof(uint16_t)) {
+            uint16_t length;
+            std::memcpy(&length, data + pos, sizeof(length));
+            if (length < HEADER_BYTES) throw std::runtime_error("Book feed message shorter than its header");
+            if (length > size - pos) break;
+
+            Reader in(data + pos + sizeof(length), length - sizeof(length));
+            Message m;
+            m.type = static_cast<MessageType>(in.get<uint8_t>());
+            m.side = in.get<uint8_t>() == 0 ? Side::BID : Side::ASK;
+            m.symbol = in.get<uint32_t>();
+            m.seq = in.get<uint64_t>();
+            switch (m.type) {
+            case MessageType::SYMBOL:
+                m.name = in.rest();
+                break;
+            case MessageType::BOOK_SNAPSHOT: {
+                m.tick = in.get<uint64_t>();
+                uint16_t bids = in.get<uint16_t>();
+                uint16_t asks = in.get<uint16_t>();
+                for (uint16_t i = 0; i < bids; ++i) m.bids.push_back(in.level());
+                for (uint16_t i = 0; i < asks; ++i) m.asks.push_back(in.level());
+                break;
+            }
+            case MessageType::LEVEL_ADD:
+            case MessageType::LEVEL_CHANGE:
+                m.level = in.level();
+                break;
+            case MessageType::LEVEL_DELETE:
+                m.level.price = in.get<double>();
+                break;
+            case MessageType::TRADE:
+                m.price = in.get<double>();
+                m.quantity = in.get<int64_t>();
+                m.timestamp = in.get<uint64_t>();
+                break;
+            case MessageType::CANDLE:
+                m.candle.time = in.get<uint64_t>();
+                m.candle.open = in.get<double>();
+                m.candle.high = in.get<double>();
+                m.candle.low = in.get<double>();
+                m.candle.close = in.get<double>();
+                m.candle.volume = in.get<double>();
+                break;
+            default:
+                throw std::runtime_error("Unknown book feed message type " + std::to_string(static_cast<int>(m.type)));
+            }
+            out.push_back(std::move(m));
+            pos += length;
+        }
+        return pos;
+    }
+
+    void BookFeed::run() {
+        std::unique_lock<std::mutex> lock(wakeMutex_);
+        while (running_.load()) {
+            bool idle;
+            {
+                std::lock_guard<std::mutex> guard(mutex_);
+                idle = subscribers_.empty();
+            }
+            if (idle) {
+                // Nothing is diffed for nobody; the next subscriber wakes us
+                wake_.wait_for(lock, options_.interval * 20);
+                published_ = false;  // The last state is stale; start over
+                continue;
+            }
+            lock.unlock();
+            publish();
+            lock.lock();
+            wake_.wait_for(lock, options_.interval, [this] { return !running_.load(); });
+        }
+    }
+
+} // namespace market
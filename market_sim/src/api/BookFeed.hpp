@@ -0,0 +1,168 @@
+#pragma once
+
+#include "FrameQueue.hpp"
+#include "engine/MarketSnapshot.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace market {
+
+    class Simulation;
+
+    // Binary market-data feed: per symbol, changes to the published top
+    // levels of the book (level add, change, delete), trades and 1-minute
+    // candle closes. One thread diffs each new published snapshot against
+    // the last, encodes every symbol's messages once, and queues the same
+    // bytes to each client subscribed to that symbol (see FrameQueue for
+    // slow clients). A client starts with the symbol directory and a book
+    // snapshot per symbol, then applies messages in sequence; after a gap
+    // or a drop it resyncs by subscribing again.
+    //
+    // Messages are little-endian and self-delimiting. Each starts with a
+    // 16-byte header:
+    //     u16 length (whole message)  u8 type  u8 side  u32 symbol  u64 seq
+    // where `symbol` indexes the directory and `seq` counts the symbol's
+    // level, trade and candle messages from 1. When more trades happen
+    // between two polls than a snapshot holds, the rest are not sent and
+    // every symbol's `seq` skips one, so that clients see a gap. Bodies by
+    // type:
+    //     SYMBOL         name bytes
+    //     BOOK_SNAPSHOT  u64 tick, u16 bids, u16 asks, then each level as
+    //                    f64 price, i64 quantity, u32 orders (best first);
+    //                    `seq` is that of the last message it includes
+    //     LEVEL_ADD/CHANGE  f64 price, i64 quantity, u32 orders
+    //     LEVEL_DELETE   f64 price
+    //     TRADE          f64 price, i64 quantity, u64 timestamp
+    //     CANDLE         u64 time, f64 open, high, low, close, volume
+    class BookFeed {
+    public:
+        using Frame = FrameQueue::Frame;
+
+        enum class MessageType : uint8_t {
+            SYMBOL = 1,
+            BOOK_SNAPSHOT = 2,
+            LEVEL_ADD = 3,
+            LEVEL_CHANGE = 4,
+            LEVEL_DELETE = 5,
+            TRADE = 6,
+            CANDLE = 7
+        };
+
+        enum class Side : uint8_t { BID = 0, ASK = 1 };
+
+        static constexpr size_t HEADER_BYTES = 16;
+
+        struct Options {
+            std::chrono::milliseconds interval{ 50 };  // Between snapshot polls
+            size_t queueFrames = 256;                  // Per subscriber, one frame per symbol and poll
+            size_t maxSubscribers = 32;
+        };
+
+        struct Stats {
+            size_t subscribers = 0;
+            uint64_t messages = 0;     // Encoded once each, however many subscribers
+            uint64_t bytes = 0;
+            uint64_t dropped = 0;      // Subscribers dropped for a full queue
+            uint64_t rejected = 0;     // subscribe() calls over maxSubscribers
+            uint64_t tradeGaps = 0;    // Polls that missed trades beyond RECENT_TRADES
+        };
+
+        // One decoded message; only the fields of its type are set
+        struct Message {
+            MessageType type = MessageType::SYMBOL;
+            Side side = Side::BID;
+            uint32_t symbol = 0;
+            uint64_t seq = 0;
+            std::string name;                   // SYMBOL
+            uint64_t tick = 0;                  // BOOK_SNAPSHOT
+            std::vector<BookLevel> bids, asks;  // BOOK_SNAPSHOT
+            BookLevel level{};                  // LEVEL_* (DELETE: price only)
+            Price price = 0.0;                  // TRADE
+            Volume quantity = 0;
+            Timestamp timestamp = 0;
+            Candle candle{};                    // CANDLE
+        };
+
+        explicit BookFeed(const Simulation& sim);
+        BookFeed(const Simulation& sim, Options options);
+        ~BookFeed();
+
+        BookFeed(const BookFeed&) = delete;
+        BookFeed& operator=(const BookFeed&) = delete;
+
+        // The polling thread; it only diffs snapshots while there are subscribers
+        void start();
+        void stop();  // Also closes every subscription
+
+        // A subscription to `symbols` (all when empty; unknown names are
+        // ignored), or null at maxSubscribers. Its directory and snapshots
+        // are queued at the next publish().
+        std::shared_ptr<FrameQueue> subscribe(const std::vector<std::string>& symbols);
+        void unsubscribe(const std::shared_ptr<FrameQueue>& subscription);
+
+        // Encodes the changes since the last call, if the snapshot changed,
+        // queues them and primes new subscribers; the polling thread calls
+        // this every interval. Not to be called from two threads at once.
+        void publish();
+
+        Stats getStats() const;
+
+        // Appends the complete messages in [data, data + size) to `out` and
+        // returns the bytes they took; a partial message at the end is left.
+        // Throws std::runtime_error on a malformed message.
+        static size_t decode(const char* data, size_t size, std::vector<Message>& out);
+
+    private:
+        struct Subscriber {
+            std::shared_ptr<FrameQueue> queue;
+            std::vector<std::string> symbols;
+            std::vector<bool> wanted;  // By symbol index, once primed
+            bool primed = false;
+        };
+
+        // Per symbol: what the last publish() showed, and its latest snapshot
+        struct SymbolState {
+            std::string name;
+            OrderBookSnapshot book;
+            Timestamp candleTime = 0;
+            uint64_t seq = 0;
+            Frame snapshot;
+        };
+
+        const Simulation& sim_;
+        Options options_;
+
+        mutable std::mutex mutex_;  // subscribers_, directory_, snapshots in symbols_, stats_
+        std::vector<Subscriber> subscribers_;
+        Stats stats_;
+
+        // publish() only, apart from the snapshot frames
+        std::vector<SymbolState> symbols_;
+        Frame directory_;
+        bool published_ = false;
+        uint64_t lastVersion_ = 0;
+        uint64_t lastTradeSeq_ = 0;
+
+        std::thread thread_;
+        std::atomic<bool> running_{ false };
+        std::mutex wakeMutex_;
+        std::condition_variable wake_;
+
+        void run();
+
+        // New symbol list: state restarts and every subscriber must resync
+        void reset(const MarketSnapshot& snapshot);
+
+        Frame encodeSnapshot(uint32_t symbol, const MarketSnapshot& snapshot) const;
+        void diffLevels(std::string& out, uint32_t symbol, Side side,
+            const std::vector<BookLevel>& before, const std::vector<BookLevel>& after);
+    };
+
+} // namespace market
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace market {
+
+    // Bounded queue of shared, already-serialized frames from a publisher
+    // thread to one streaming client. A push to a full queue closes it as
+    // dropped instead of blocking the publisher: a client that falls that
+    // far behind is cut off rather than slowing everyone else.
+    class FrameQueue {
+    public:
+        using Frame = std::shared_ptr<const std::string>;
+
+        explicit FrameQueue(size_t capacity) : capacity_(capacity) {}
+
+        // Waits up to `timeout` for the next frame. True with `frame` set,
+        // or null on timeout; false once the queue is closed.
+        bool next(Frame& frame, std::chrono::milliseconds timeout) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_.wait_for(lock, timeout, [this] { return closed_ || !queue_.empty(); });
+            if (closed_) return false;
+            frame = nullptr;
+            if (!queue_.empty()) {
+                frame = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            return true;
+        }
+
+        // False if closed, or if full, which closes it as dropped
+        bool push(const Frame& frame) {
+            bool queued = false;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (closed_) return false;
+                if (queue_.size() >= capacity_) {
+                    closed_ = true;
+                    dropped_ = true;
+                    queue_.clear();
+                }
+                else {
+                    queue_.push_back(frame);
+                    queued = true;
+                }
+            }
+            ready_.notify_one();
+            return queued;
+        }
+
+        void close() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                closed_ = true;
+            }
+            ready_.notify_all();
+        }
+
+        bool isDropped() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return dropped_;
+        }
+
+        size_t queued() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return queue_.size();
+        }
+
+    private:
+        mutable std::mutex mutex_;
+        std::condition_variable ready_;
+        std::deque<Frame> queue_;
+        size_t capacity_;
+        bool closed_ = false;
+        bool dropped_ = false;
+    };
+
+} // namespace market
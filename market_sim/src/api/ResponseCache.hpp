@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace market {
+
+    // Serialized bodies of read endpoints, kept per request key (route and
+    // query) together with the publication stamp they were built under. A
+    // request under the same stamp is served the stored body; the first one
+    // after the stamp moves rebuilds it, and concurrent requests for that
+    // key wait for that one build instead of repeating it. Each body has a
+    // strong ETag derived from its content.
+    class ResponseCache {
+    public:
+        static constexpr size_t MAX_KEYS = 256;  // Beyond this the cache starts over
+
+        struct Entry {
+            uint64_t stamp = 0;
+            std::string body;
+            std::string etag;  // Quoted, as sent
+        };
+
+        struct Stats {
+            uint64_t hits = 0;
+            uint64_t misses = 0;         // Builds
+            uint64_t notModified = 0;    // 304s, counted by the caller via countNotModified()
+        };
+
+        // The entry for `key` built under `stamp`, from the cache or from
+        // build(), which returns the body
+        std::shared_ptr<const Entry> get(const std::string& key, uint64_t stamp,
+            const std::function<std::string()>& build) {
+            std::shared_ptr<Slot> slot;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = slots_.find(key);
+                if (it == slots_.end()) {
+                    if (slots_.size() >= MAX_KEYS) slots_.clear();
+                    it = slots_.emplace(key, std::make_shared<Slot>()).first;
+                }
+                slot = it->second;
+            }
+
+            std::lock_guard<std::mutex> lock(slot->mutex);
+            if (slot->entry && slot->entry->stamp == stamp) {
+                hits_++;
+                return slot->entry;
+            }
+            auto entry = std::make_shared<Entry>();
+            entry->stamp = stamp;
+            entry->body = build();
+            entry->etag = makeEtag(entry->body);
+            slot->entry = entry;
+            misses_++;
+            return entry;
+        }
+
+        // True if an If-None-Match header value names `etag` (or is "*");
+        // weak tags compare by their opaque part
+        static bool matches(std::string_view ifNoneMatch, std::string_view etag) {
+            if (etag.rfind("W/", 0) == 0) etag.remove_prefix(2);
+            size_t pos = 0;
+            while (pos < ifNoneMatch.size()) {
+                size_t comma = ifNoneMatch.find(',', pos);
+                std::string_view tag = ifNoneMatch.substr(pos, comma == std::string_view::npos ? std::string_view::npos : comma - pos);
+                pos = comma == std::string_view::npos ? ifNoneMatch.size() : comma + 1;
+                while (!tag.empty() && (tag.front() == ' ' || tag.front() == '\t')) tag.remove_prefix(1);
+                while (!tag.empty() && (tag.back() == ' ' || tag.back() == '\t')) tag.remove_suffix(1);
+                if (tag == "*") return true;
+                if (tag.rfind("W/", 0) == 0) tag.remove_prefix(2);
+                if (tag == etag) return true;
+            }
+            return false;
+        }
+
+        // `etag` as sent with a content-coded (e.g. gzip) body: weak, since
+        // that body is not byte-identical to the identity one the tag names
+        static std::string weakEtag(const std::string& etag) {
+            return etag.rfind("W/", 0) == 0 ? etag : "W/" + etag;
+        }
+
+        static std::string makeEtag(const std::string& body) {
+            char tag[40];
+            std::snprintf(tag, sizeof(tag), "\"%zx-%016llx\"", body.size(),
+                static_cast<unsigned long long>(std::hash<std::string>{}(body)));
+            return tag;
+        }
+
+        void countNotModified() { notModified_++; }
+
+        Stats getStats() const { return Stats{ hits_.load(), misses_.load(), notModified_.load() }; }
+
+    private:
+        struct Slot {
+            std::mutex mutex;  // Held while building, so a key builds once per stamp
+            std::shared_ptr<const Entry> entry;
+        };
+
+        std::mutex mutex_;  // slots_ (not their contents)
+        std::unordered_map<std::string, std::shared_ptr<Slot>> slots_;
+        std::atomic<uint64_t> hits_{ 0 };
+        std::atomic<uint64_t> misses_{ 0 };
+        std::atomic<uint64_t> notModified_{ 0 };
+    };
+
+} // namespace market
@@ -0,0 +1,234 @@
+#include "StreamBroadcaster.hpp"
+#include "engine/Simulation.hpp"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+
+namespace market {
+
+    namespace {
+
+        // At most this many of the newest headlines go into one news frame
+        constexpr size_t NEWS_PER_FRAME = 3;
+
+        StreamBroadcaster::Frame makeFrame(const nlohmann::json& data) {
+            return std::make_shared<const std::string>("data: " + data.dump() + "\n\n");
+        }
+
+        bool sameNews(const NewsEvent& a, const NewsEvent& b) {
+            return a.timestamp == b.timestamp && a.symbol == b.symbol && a.headline == b.headline;
+        }
+
+    } // namespace
+
+    StreamBroadcaster::StreamBroadcaster(const Simulation& sim)
+        : StreamBroadcaster(sim, Options{})
+    {
+    }
+
+    StreamBroadcaster::StreamBroadcaster(const Simulation& sim, Options options)
+        : sim_(sim)
+        , options_(options)
+    {
+        options_.queueFrames = std::max<size_t>(options_.queueFrames, 2);
+    }
+
+    StreamBroadcaster::~StreamBroadcaster() {
+        stop();
+    }
+
+    void StreamBroadcaster::start() {
+        if (running_.exchange(true)) return;
+        thread_ = std::thread([this] { run(); });
+    }
+
+    void StreamBroadcaster::stop() {
+        if (running_.exchange(false)) {
+            {
+                std::lock_guard<std::mutex> lock(wakeMutex_);
+            }
+            wake_.notify_all();
+            if (thread_.joinable()) thread_.join();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& s : subscribers_) s.queue->close();
+        subscribers_.clear();
+    }
+
+    std::shared_ptr<StreamBroadcaster::Subscription> StreamBroadcaster::subscribe(bool deltas) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (subscribers_.size() >= options_.maxSubscribers) {
+            stats_.rejected++;
+            return nullptr;
+        }
+        auto s = std::make_shared<Subscription>(options_.queueFrames);
+        for (const auto& frame : latest_) {
+            if (frame) s->push(frame);
+        }
+        subscribers_.push_back({ s, deltas });
+        stats_.subscribers = subscribers_.size();
+        wake_.notify_all();  // The thread idles without subscribers
+        return s;
+    }
+
+    void StreamBroadcaster::unsubscribe(const std::shared_ptr<Subscription>& subscription) {
+        if (!subscription) return;
+        subscription->close();
+        std::lock_guard<std::mutex> lock(mutex_);
+        subscribers_.erase(std::remove_if(subscribers_.begin(), subscribers_.end(),
+            [&](const Subscriber& s) { return s.queue == subscription; }), subscribers_.end());
+        stats_.subscribers = subscribers_.size();
+    }
+
+    std::vector<const NewsEvent*> StreamBroadcaster::newNews(const MarketSnapshot& snapshot) const {
+        const auto& recent = snapshot.recentNews;
+        size_t first = 0;
+        if (hasNews_) {
+            // Everything after the last one sent; all of it if that has aged out
+            for (size_t i = recent.size(); i > 0; --i) {
+                if (sameNews(recent[i - 1], lastNews_)) {
+                    first = i;
+                    break;
+                }
+            }
+        }
+        first = std::max(first, recent.size() - std::min(recent.size(), NEWS_PER_FRAME));
+
+        std::vector<const NewsEvent*> out;
+        for (size_t i = first; i < recent.size(); ++i) out.push_back(&recent[i]);
+        return out;
+    }
+
+    void StreamBroadcaster::publish() {
+        auto snapshot = sim_.getSnapshot();
+        bool running = sim_.isRunning();
+        bool paused = sim_.isPaused();
+        if (published_ && snapshot->version == lastVersion_ && running == lastRunning_ && paused == lastPaused_) {
+            return;
+        }
+
+        nlohmann::json header;
+        header["tick"] = sim_.getCurrentTick();
+        header["running"] = running;
+        header["paused"] = paused;
+        header["simDate"] = snapshot->simDate;
+        header["simDateTime"] = snapshot->simDateTime;
+        header["simTimestamp"] = snapshot->simTimestamp;
+
+        nlohmann::json full = header;
+        full["type"] = "update";
+        full["commodities"] = nlohmann::json::array();
+        for (const auto& commodity : snapshot->commodities) {
+            full["commodities"].push_back({
+                {"symbol", commodity.symbol},
+                {"name", commodity.name},
+                {"price", commodity.price},
+                {"change", commodity.change}
+                });
+        }
+        Frame fullFrame = makeFrame(full);
+
+        // A delta needs the same commodities as the frame before it; when
+        // they change, delta subscribers get the full update instead
+        bool sameSymbols = published_ && lastSymbols_.size() == snapshot->commodities.size();
+        for (size_t i = 0; sameSymbols && i < lastSymbols_.size(); ++i) {
+            sameSymbols = lastSymbols_[i] == snapshot->commodities[i].symbol;
+        }
+        Frame deltaFrame = fullFrame;
+        if (sameSymbols) {
+            nlohmann::json delta = header;
+            delta["type"] = "delta";
+            delta["prices"] = nlohmann::json::object();
+            for (size_t i = 0; i < lastPrices_.size(); ++i) {
+                const auto& commodity = snapshot->commodities[i];
+                if (lastPrices_[i].first != commodity.price || lastPrices_[i].second != commodity.change) {
+                    delta["prices"][commodity.symbol] = { {"price", commodity.price}, {"change", commodity.change} };
+                }
+            }
+            deltaFrame = makeFrame(delta);
+        }
+
+        Frame newsFrame;
+        auto news = newNews(*snapshot);
+        if (!news.empty()) {
+            nlohmann::json newsData;
+            newsData["type"] = "news";
+            newsData["events"] = nlohmann::json::array();
+            for (const NewsEvent* n : news) {
+                newsData["events"].push_back({
+                        {"headline", n->headline},
+                        {"category", newsCategoryName(n->category)},
+                        {"sentiment", newsSentimentName(n->sentiment)},
+                        {"magnitude", n->magnitude},
+                        {"symbol", n->symbol},
+                        {"subcategory", n->subcategory}
+                    });
+            }
+            newsFrame = makeFrame(newsData);
+            lastNews_ = *news.back();
+            hasNews_ = true;
+        }
+
+        published_ = true;
+        lastVersion_ = snapshot->version;
+        lastRunning_ = running;
+        lastPaused_ = paused;
+        lastSymbols_.clear();
+        lastPrices_.clear();
+        for (const auto& commodity : snapshot->commodities) {
+            lastSymbols_.push_back(commodity.symbol);
+            lastPrices_.emplace_back(commodity.price, commodity.change);
+        }
+
+        queue(fullFrame, deltaFrame, newsFrame);
+    }
+
+    void StreamBroadcaster::queue(const Frame& full, const Frame& delta, const Frame& news) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.framesBuilt += 1 + (delta != full) + (news != nullptr);
+        Frame latestNews = news ? news : (latest_.size() > 1 ? latest_[1] : nullptr);
+        latest_ = { full, latestNews };
+
+        auto keep = subscribers_.begin();
+        for (auto& s : subscribers_) {
+            bool ok = s.queue->push(s.deltas ? delta : full);
+            if (ok && news) ok = s.queue->push(news);
+            stats_.framesQueued += ok ? 1 + (news != nullptr) : 0;
+            if (ok) {
+                if (&*keep != &s) *keep = std::move(s);
+                ++keep;
+            }
+            else if (s.queue->isDropped()) {
+                stats_.dropped++;
+            }
+        }
+        subscribers_.erase(keep, subscribers_.end());
+        stats_.subscribers = subscribers_.size();
+    }
+
+    StreamBroadcaster::Stats StreamBroadcaster::getStats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+    void StreamBroadcaster::run() {
+        std::unique_lock<std::mutex> lock(wakeMutex_);
+        while (running_.load()) {
+            bool idle;
+            {
+                std::lock_guard<std::mutex> guard(mutex_);
+                idle = subscribers_.empty();
+            }
+            if (idle) {
+                // Nothing is built for nobody; the next subscriber wakes us
+                wake_.wait_for(lock, options_.interval * 10);
+                continue;
+            }
+            lock.unlock();
+            publish();
+            lock.lock();
+            wake_.wait_for(lock, options_.interval, [this] { return !running_.load(); });
+        }
+    }
+
+} // namespace market
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "FrameQueue.hpp"
+#include "engine/MarketSnapshot.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace market {
+
+    class Simulation;
+
+    // The /stream fan-out. One thread reads each new published snapshot,
+    // serializes its update once and pushes the same bytes to every
+    // subscriber's bounded queue; a subscriber whose queue is full is
+    // dropped rather than allowed to hold up the others. Subscribers may
+    // ask for delta frames, which carry only the prices that changed since
+    // the previous frame (after one full update to start from).
+    class StreamBroadcaster {
+    public:
+        using Frame = FrameQueue::Frame;  // One SSE event, "data: ...\n\n"
+
+        struct Options {
+            std::chrono::milliseconds interval{ 100 };  // Between snapshot polls
+            size_t queueFrames = 64;                    // Per subscriber; overflowing it drops the subscriber
+            size_t maxSubscribers = 32;
+        };
+
+        struct Stats {
+            size_t subscribers = 0;
+            uint64_t framesBuilt = 0;      // Serialized once each, however many subscribers
+            uint64_t framesQueued = 0;     // Summed over subscribers
+            uint64_t dropped = 0;          // Subscribers dropped for a full queue
+            uint64_t rejected = 0;         // subscribe() calls over maxSubscribers
+        };
+
+        using Subscription = FrameQueue;
+
+        explicit StreamBroadcaster(const Simulation& sim);
+        StreamBroadcaster(const Simulation& sim, Options options);
+        ~StreamBroadcaster();
+
+        StreamBroadcaster(const StreamBroadcaster&) = delete;
+        StreamBroadcaster& operator=(const StreamBroadcaster&) = delete;
+
+        // The polling thread; it only builds frames while there are subscribers
+        void start();
+        void stop();  // Also closes every subscription
+
+        // A new subscription, its queue already holding the latest full
+        // update (and news) if there is one; null at maxSubscribers
+        std::shared_ptr<Subscription> subscribe(bool deltas = false);
+        void unsubscribe(const std::shared_ptr<Subscription>& subscription);
+
+        // Builds the frames for the current snapshot, if it changed, and
+        // queues them; the polling thread calls this every interval. Not to
+        // be called from two threads at once.
+        void publish();
+
+        Stats getStats() const;
+
+    private:
+        const Simulation& sim_;
+        Options options_;
+
+        mutable std::mutex mutex_;  // subscribers_, latest_, stats_
+        struct Subscriber {
+            std::shared_ptr<Subscription> queue;
+            bool deltas;
+        };
+        std::vector<Subscriber> subscribers_;
+        std::vector<Frame> latest_;  // Last full update and news frame, for new subscribers
+        Stats stats_;
+
+        // What the last frames showed; publish() only
+        bool published_ = false;
+        uint64_t lastVersion_ = 0;
+        bool lastRunning_ = false;
+        bool lastPaused_ = false;
+        std::vector<std::string> lastSymbols_;
+        std::vector<std::pair<Price, double>> lastPrices_;  // Price and change, by commodity
+        NewsEvent lastNews_{};
+        bool hasNews_ = false;
+
+        std::thread thread_;
+        std::atomic<bool> running_{ false };
+        std::mutex wakeMutex_;
+        std::condition_variable wake_;
+
+        void run();
+
+        // The news in `snapshot` not yet sent, oldest first
+        std::vector<const NewsEvent*> newNews(const MarketSnapshot& snapshot) const;
+
+        void queue(const Frame& full, const Frame& delta, const Frame& news);
+    };
+
+} // namespace market
@@ -0,0 +1,366 @@
+#include "ArrowIpc.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace market {
+
+    namespace {
+        constexpr char MAGIC[6] = { 'A', 'R', 'R', 'O', 'W', '1' };
+        constexpr uint32_t CONTINUATION = 0xFFFFFFFF;
+
+        // Arrow flatbuffer schema constants (format/Schema.fbs, Message.fbs)
+        constexpr int16_t METADATA_V5 = 4;
+        constexpr uint8_t HEADER_SCHEMA = 1;
+        constexpr uint8_t HEADER_RECORD_BATCH = 3;
+        constexpr uint8_t TYPE_INT = 2;
+        constexpr uint8_t TYPE_FLOATING_POINT = 3;
+        constexpr uint8_t TYPE_UTF8 = 5;
+        constexpr int16_t PRECISION_SINGLE = 1;
+        constexpr int16_t PRECISION_DOUBLE = 2;
+
+        size_t padded8(size_t n) { return (n + 7) & ~size_t(7); }
+
+        // Just enough of a FlatBuffers builder for Arrow's metadata: objects
+        // are described as a tree, then laid out front to back, every child
+        // after the field that points to it (uoffsets are forward), every
+        // vtable just before its table
+        class FlatBuilder {
+        public:
+            int table() { return add(Node::Kind::TABLE); }
+
+            void scalar(int table, uint16_t id, uint64_t value, size_t size) {
+                nodes_[table].slots.push_back({ id, size, value, -1 });
+            }
+
+            void offset(int table, uint16_t id, int child) {
+                nodes_[table].slots.push_back({ id, 4, 0, child });
+            }
+
+            int string(const std::string& s) {
+                int n = add(Node::Kind::STRING);
+                nodes_[n].bytes = s;
+                nodes_[n].count = static_cast<uint32_t>(s.size());
+                return n;
+            }
+
+            int tableVector(std::vector<int> tables) {
+                int n = add(Node::Kind::TABLE_VECTOR);
+                nodes_[n].children = std::move(tables);
+                return n;
+            }
+
+            // `count` structs of `bytes.size() / count` bytes each, aligned to 8
+            int structVector(std::string bytes, uint32_t count) {
+                int n = add(Node::Kind::STRUCT_VECTOR);
+                nodes_[n].bytes = std::move(bytes);
+                nodes_[n].count = count;
+                return n;
+            }
+
+            // The finished buffer, padded to a multiple of 8 bytes
+            std::string finish(int root) {
+                std::string out(4, '\0');
+                put32(out, 0, static_cast<uint32_t>(write(out, root)));
+                align(out, 8);
+                return out;
+            }
+
+        private:
+            struct Slot {
+                uint16_t id;
+                size_t size;
+                uint64_t value;
+                int child;  // >= 0: uoffset to that node
+            };
+
+            struct Node {
+                enum class Kind { TABLE, STRING, TABLE_VECTOR, STRUCT_VECTOR };
+                Kind kind;
+                std::vector<Slot> slots;
+                std::vector<int> children;
+                std::string bytes;
+                uint32_t count = 0;
+            };
+
+            std::vector<Node> nodes_;
+
+            int add(Node::Kind kind) {
+                nodes_.push_back(Node{ kind, {}, {}, {}, 0 });
+                return static_cast<int>(nodes_.size() - 1);
+            }
+
+            static void align(std::string& out, size_t alignment) {
+                while (out.size() % alignment) out.push_back('\0');
+            }
+
+            static void put(std::string& out, size_t at, uint64_t value, size_t size) {
+                for (size_t i = 0; i < size; ++i) out[at + i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+            }
+
+            static void put32(std::string& out, size_t at, uint32_t value) { put(out, at, value, 4); }
+
+            static void append(std::string& out, uint64_t value, size_t size) {
+                out.append(size, '\0');
+                put(out, out.size() - size, value, size);
+            }
+
+            // Lays out `index` and everything below it; returns its position
+            size_t write(std::string& out, int index) {
+                const Node& node = nodes_[index];
+                switch (node.kind) {
+                    case Node::Kind::STRING: {
+                        align(out, 4);
+                        size_t at = out.size();
+                        append(out, node.count, 4);
+                        out += node.bytes;
+                        out.push_back('\0');
+                        return at;
+                    }
+                    case Node::Kind::STRUCT_VECTOR: {
+                        // Elements 8-aligned, so the length sits 4 bytes before that
+                        while (out.size() % 8 != 4) out.push_back('\0');
+                        size_t at = out.size();
+                        append(out, node.count, 4);
+                        out += node.bytes;
+                        return at;
+                    }
+                    case Node::Kind::TABLE_VECTOR: {
+                        align(out, 4);
+                        size_t at = out.size();
+                        append(out, node.children.size(), 4);
+                        size_t slots = out.size();
+                        out.append(4 * node.children.size(), '\0');
+                        for (size_t i = 0; i < node.children.size(); ++i) {
+                            size_t slot = slots + 4 * i;
+                            size_t child = write(out, node.children[i]);
+                            put32(out, slot, static_cast<uint32_t>(child - slot));
+                        }
+                        return at;
+                    }
+                    case Node::Kind::TABLE:
+                    default:
+                        return writeTable(out, node);
+                }
+            }
+
+            size_t writeTable(std::string& out, const Node& node) {
+                uint16_t fields = 0;
+                for (const auto& slot : node.slots) fields = std::max<uint16_t>(fields, slot.id + 1);
+
+                align(out, 2);
+                size_t vtable = out.size();
+                out.append(4 + 2 * fields, '\0');
+
+                align(out, 8);
+                size_t table = out.size();
+                append(out, table - vtable, 4);  // soffset: the vtable precedes the table
+
+                // Widest first keeps the padding small
+                std::vector<Slot> slots = node.slots;
+                std::stable_sort(slots.begin(), slots.end(), [](const Slot& a, const Slot& b) { return a.size > b.size; });
+                std::vector<std::pair<size_t, int>> pending;  // Offset slot position, child
+                for (const auto& slot : slots) {
+                    align(out, slot.size);
+                    put(out, vtable + 4 + 2 * slot.id, out.size() - table, 2);
+                    if (slot.child >= 0) pending.emplace_back(out.size(), slot.child);
+                    append(out, slot.value, slot.size);
+                }
+                put(out, vtable, 4 + 2 * fields, 2);
+                put(out, vtable + 2, out.size() - table, 2);
+
+                for (const auto& [slot, child] : pending) {
+                    size_t at = write(out, child);
+                    put32(out, slot, static_cast<uint32_t>(at - slot));
+                }
+                return table;
+            }
+        };
+
+        std::string packStructs(const std::vector<uint64_t>& words) {
+            std::string bytes(words.size() * 8, '\0');
+            std::memcpy(bytes.data(), words.data(), bytes.size());
+            return bytes;
+        }
+
+        // Schema table for `columns`, built into `fb`
+        int buildSchema(FlatBuilder& fb, const std::vector<ArrowIpcWriter::Column>& columns) {
+            std::vector<int> fields;
+            for (const auto& column : columns) {
+                int type = fb.table();
+                uint8_t typeId = TYPE_UTF8;
+                switch (column.type) {
+                    case ArrowIpcWriter::Type::UINT64:
+                        typeId = TYPE_INT;
+                        fb.scalar(type, 0, 64, 4);  // bitWidth
+                        fb.scalar(type, 1, 0, 1);   // is_signed
+                        break;
+                    case ArrowIpcWriter::Type::FLOAT32:
+                        typeId = TYPE_FLOATING_POINT;
+                        fb.scalar(type, 0, PRECISION_SINGLE, 2);
+                        break;
+                    case ArrowIpcWriter::Type::FLOAT64:
+                        typeId = TYPE_FLOATING_POINT;
+                        fb.scalar(type, 0, PRECISION_DOUBLE, 2);
+                        break;
+                    case ArrowIpcWriter::Type::UTF8:
+                        break;
+                }
+
+                int field = fb.table();
+                fb.offset(field, 0, fb.string(column.name));  // name
+                fb.scalar(field, 1, 0, 1);                     // nullable
+                fb.scalar(field, 2, typeId, 1);                // type_type
+                fb.offset(field, 3, type);                     // type
+                fb.offset(field, 5, fb.tableVector({}));       // children
+                fields.push_back(field);
+            }
+            int schema = fb.table();
+            fb.offset(schema, 1, fb.tableVector(std::move(fields)));
+            return schema;
+        }
+
+        std::string messageMetadata(FlatBuilder& fb, uint8_t headerType, int header, uint64_t bodyLength) {
+            int message = fb.table();
+            fb.scalar(message, 0, static_cast<uint64_t>(METADATA_V5), 2);  // version
+            fb.scalar(message, 1, headerType, 1);                           // header_type
+            fb.offset(message, 2, header);                                  // header
+            fb.scalar(message, 3, bodyLength, 8);                           // bodyLength
+            return fb.finish(message);
+        }
+    }
+
+    ArrowIpcWriter::ArrowIpcWriter(const std::string& path, std::vector<Column> columns)
+        : columns_(std::move(columns)), data_(columns_.size())
+    {
+        file_.open(path, std::ios::binary | std::ios::trunc);
+        if (!file_.is_open()) return;
+
+        writeBytes(MAGIC, sizeof(MAGIC));
+        pad();
+
+        FlatBuilder fb;
+        writeMessage(messageMetadata(fb, HEADER_SCHEMA, buildSchema(fb, columns_), 0), {});
+    }
+
+    ArrowIpcWriter::~ArrowIpcWriter() {
+        close();
+    }
+
+    void ArrowIpcWriter::appendString(size_t column, std::string_view value) {
+        ColumnData& d = data_[column];
+        d.values.insert(d.values.end(), value.begin(), value.end());
+        d.offsets.push_back(static_cast<int32_t>(d.values.size()));
+    }
+
+    void ArrowIpcWriter::appendRaw(size_t column, const void* value, size_t size) {
+        const char* bytes = static_cast<const char*>(value);
+        data_[column].values.insert(data_[column].values.end(), bytes, bytes + size);
+    }
+
+    size_t ArrowIpcWriter::rows(size_t column) const {
+        if (column >= columns_.size()) return 0;
+        switch (columns_[column].type) {
+            case Type::UINT64:
+            case Type::FLOAT64: return data_[column].values.size() / 8;
+            case Type::FLOAT32: return data_[column].values.size() / 4;
+            case Type::UTF8:
+            default: return data_[column].offsets.size() - 1;
+        }
+    }
+
+    bool ArrowIpcWriter::writeBatch() {
+        if (!isOpen() || closed_) return false;
+        size_t length = pendingRows();
+        if (length == 0) return true;
+
+        // Per column: a FieldNode, an empty validity buffer (no nulls), then
+        // values, or value offsets and UTF-8 data
+        std::vector<uint64_t> nodes;
+        std::vector<uint64_t> buffers;
+        std::vector<char> body;
+        auto addBuffer = [&](const void* data, size_t size) {
+            buffers.push_back(body.size());
+            buffers.push_back(size);
+            const char* bytes = static_cast<const char*>(data);
+            body.insert(body.end(), bytes, bytes + size);
+            body.resize(padded8(body.size()), '\0');
+        };
+        for (size_t c = 0; c < columns_.size(); ++c) {
+            if (rows(c) != length) return false;
+            nodes.push_back(length);
+            nodes.push_back(0);
+            addBuffer(nullptr, 0);
+            if (columns_[c].type == Type::UTF8) {
+                addBuffer(data_[c].offsets.data(), data_[c].offsets.size() * sizeof(int32_t));
+            }
+            addBuffer(data_[c].values.data(), data_[c].values.size());
+        }
+
+        FlatBuilder fb;
+        int batch = fb.table();
+        fb.scalar(batch, 0, length, 8);                                                                  // length
+        fb.offset(batch, 1, fb.structVector(packStructs(nodes), static_cast<uint32_t>(nodes.size() / 2)));     // nodes
+        fb.offset(batch, 2, fb.structVector(packStructs(buffers), static_cast<uint32_t>(buffers.size() / 2))); // buffers
+        blocks_.push_back(writeMessage(messageMetadata(fb, HEADER_RECORD_BATCH, batch, body.size()), body));
+
+        for (auto& d : data_) {
+            d.values.clear();
+            d.offsets.assign(1, 0);
+        }
+        return isOpen();
+    }
+
+    bool ArrowIpcWriter::close() {
+        if (closed_ || !file_.is_open()) return false;
+        bool ok = writeBatch();
+        closed_ = true;
+
+        // End-of-stream marker, then the footer and its length
+        uint32_t eos[2] = { CONTINUATION, 0 };
+        writeBytes(eos, sizeof(eos));
+
+        FlatBuilder fb;
+        int schema = buildSchema(fb, columns_);
+        std::vector<uint64_t> blocks;
+        for (const auto& block : blocks_) {
+            blocks.push_back(block.offset);
+            blocks.push_back(block.metadataLength);  // int32, then 4 bytes of struct padding
+            blocks.push_back(block.bodyLength);
+        }
+        int footer = fb.table();
+        fb.scalar(footer, 0, static_cast<uint64_t>(METADATA_V5), 2);                                      // version
+        fb.offset(footer, 1, schema);                                                                     // schema
+        fb.offset(footer, 2, fb.structVector({}, 0));                                                     // dictionaries
+        fb.offset(footer, 3, fb.structVector(packStructs(blocks), static_cast<uint32_t>(blocks_.size())));  // recordBatches
+        std::string metadata = fb.finish(footer);
+
+        writeBytes(metadata.data(), metadata.size());
+        int32_t footerLength = static_cast<int32_t>(metadata.size());
+        writeBytes(&footerLength, sizeof(footerLength));
+        writeBytes(MAGIC, sizeof(MAGIC));
+
+        file_.close();
+        return ok && !file_.fail();
+    }
+
+    void ArrowIpcWriter::writeBytes(const void* data, size_t size) {
+        file_.write(static_cast<const char*>(data), size);
+        position_ += size;
+    }
+
+    void ArrowIpcWriter::pad() {
+        static const char zeros[8] = {};
+        writeBytes(zeros, padded8(position_) - position_);
+    }
+
+    ArrowIpcWriter::Block ArrowIpcWriter::writeMessage(const std::string& metadata, const std::vector<char>& body) {
+        // Continuation marker and metadata length, the metadata padded to 8, then the body
+        Block block{ position_, static_cast<uint32_t>(8 + metadata.size()), body.size() };
+        uint32_t prefix[2] = { CONTINUATION, static_cast<uint32_t>(metadata.size()) };
+        writeBytes(prefix, sizeof(prefix));
+        writeBytes(metadata.data(), metadata.size());
+        writeBytes(body.data(), body.size());
+        return block;
+    }
+
+} // namespace market
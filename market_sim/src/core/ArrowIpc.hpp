@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace market {
+
+    // Writes an Apache Arrow IPC file (the Feather v2 / `.arrow` format that
+    // pyarrow.ipc.open_file, pandas.read_feather and polars.read_ipc read):
+    // one schema of non-nullable columns, then record batches streamed out
+    // as they are filled, then the footer indexing them. Bodies are stored
+    // uncompressed with 8-byte aligned buffers, so readers can map them.
+    // Only the column types the exports need are supported.
+    class ArrowIpcWriter {
+    public:
+        enum class Type { UINT64, FLOAT32, FLOAT64, UTF8 };
+
+        struct Column {
+            std::string name;
+            Type type;
+        };
+
+        // Opens (truncates) `path` and writes the schema; check isOpen()
+        ArrowIpcWriter(const std::string& path, std::vector<Column> columns);
+        ~ArrowIpcWriter();
+
+        ArrowIpcWriter(const ArrowIpcWriter&) = delete;
+        ArrowIpcWriter& operator=(const ArrowIpcWriter&) = delete;
+
+        bool isOpen() const { return file_.is_open() && file_.good(); }
+
+        // Values of the next row, one per column in schema order
+        void appendUInt64(size_t column, uint64_t value) { appendRaw(column, &value, sizeof(value)); }
+        void appendFloat32(size_t column, float value) { appendRaw(column, &value, sizeof(value)); }
+        void appendFloat64(size_t column, double value) { appendRaw(column, &value, sizeof(value)); }
+        void appendString(size_t column, std::string_view value);
+
+        // Rows appended since the last batch
+        size_t pendingRows() const { return rows(0); }
+
+        // Writes the pending rows as one record batch. False on a write error
+        // or if the columns hold different row counts.
+        bool writeBatch();
+
+        // Writes any pending rows and the footer. The file is only readable
+        // after this; the destructor calls it too.
+        bool close();
+
+    private:
+        struct ColumnData {
+            std::vector<char> values;
+            std::vector<int32_t> offsets{ 0 };  // UTF8 only: n + 1 value offsets
+        };
+
+        struct Block {
+            uint64_t offset;
+            uint32_t metadataLength;
+            uint64_t bodyLength;
+        };
+
+        std::ofstream file_;
+        std::vector<Column> columns_;
+        std::vector<ColumnData> data_;
+        std::vector<Block> blocks_;
+        uint64_t position_ = 0;
+        bool closed_ = false;
+
+        size_t rows(size_t column) const;
+        void appendRaw(size_t column, const void* value, size_t size);
+        void writeBytes(const void* data, size_t size);
+        void pad();
+        Block writeMessage(const std::string& metadata, const std::vector<char>& body);
+    };
+
+} // namespace market
@@ -1,128 +1,345 @@
 #include "CandleAggregator.hpp"
+#include "Checkpoint.hpp"
 #include <algorithm>
+#include <charconv>
+#include <limits>
 #include <stdexcept>
 
 namespace market {
 
-    CandleAggregator::CandleAggregator() {}
+    namespace {
+        void startCandle(Candle& c, Timestamp time, Price price, double volume) {
+            c.time = time;
+            c.open = price;
+            c.high = price;
+            c.low = price;
+            c.close = price;
+            c.volume = volume;
+        }
+
+        template <typename T>
+        void appendNumber(std::string& out, T value) {
+            char buffer[64];
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            out.append(buffer, result.ptr);
+        }
+
+        // {"time":...,"open":...,"high":...,"low":...,"close":...,"volume":...}
+        void appendCandleJson(std::string& out, const Candle& c) {
+            out += "{\"time\":";
+            appendNumber(out, c.time);
+            out += ",\"open\":";
+            appendNumber(out, c.open);
+            out += ",\"high\":";
+            appendNumber(out, c.high);
+            out += ",\"low\":";
+            appendNumber(out, c.low);
+            out += ",\"close\":";
+            appendNumber(out, c.close);
+            out += ",\"volume\":";
+            appendNumber(out, c.volume);
+            out += '}';
+        }
+
+        // Extends `into` with `later`, which follows it in time
+        void mergeCandle(Candle& into, const Candle& later) {
+            into.high = std::max(into.high, later.high);
+            into.low = std::min(into.low, later.low);
+            into.close = later.close;
+            into.volume += later.volume;
+        }
+    }
+
+    void CandleAggregator::CandleHistory::push(const Candle& candle) {
+        uint64_t offset = base_ + text_.size();
+        appendCandleJson(text_, candle);
+        text_ += ',';
+        if (candles_.size() < capacity_) {
+            candles_.push_back(candle);
+            offsets_.push_back(offset);
+            return;
+        }
+        candles_[head_] = candle;
+        offsets_[head_] = offset;
+        head_ = (head_ + 1) % candles_.size();
+
+        // Drop the text of evicted candles once it is most of the buffer
+        size_t dead = textPos(0);
+        if (dead > text_.size() / 2) {
+            text_.erase(0, dead);
+            base_ += dead;
+        }
+    }
+
+    void CandleAggregator::CandleHistory::setCapacity(size_t capacity) {
+        if (capacity == capacity_) return;
+        size_t keep = std::min(capacity, candles_.size());
+        std::vector<Candle> kept;
+        kept.reserve(keep);
+        for (size_t i = size() - keep; i < size(); ++i) kept.push_back((*this)[i]);
+
+        *this = CandleHistory(capacity);
+        for (const Candle& candle : kept) push(candle);
+    }
+
+    size_t CandleAggregator::CandleHistory::lowerBound(Timestamp time) const {
+        size_t low = 0;
+        size_t high = size();
+        while (low < high) {
+            size_t mid = low + (high - low) / 2;
+            if ((*this)[mid].time < time) low = mid + 1;
+            else high = mid;
+        }
+        return low;
+    }
+
+    std::string_view CandleAggregator::CandleHistory::json(size_t begin, size_t end) const {
+        if (begin >= end) return {};
+        size_t from = textPos(begin);
+        size_t to = end < size() ? textPos(end) : text_.size();
+        return std::string_view(text_).substr(from, to - from - 1);  // Without the last ','
+    }
+
+    CandleAggregator::CandleAggregator() {
+        retention_.fill(DEFAULT_RETENTION);
+    }
 
     void CandleAggregator::initialize(const SimClock* clock) {
         clock_ = clock;
     }
 
-    void CandleAggregator::addSymbol(const std::string& symbol) {
-        // Initialize candle states for all intervals
-        for (auto interval : { Interval::M1, Interval::M5, Interval::M15, Interval::M30, Interval::H1, Interval::D1 }) {
-            data_[symbol][interval] = CandleState{};
+    size_t CandleAggregator::addSymbol(const std::string& symbol) {
+        auto [it, added] = index_.emplace(symbol, symbols_.size());
+        if (added) symbols_.emplace_back();
+
+        SymbolCandles& s = symbols_[it->second];
+        s.symbol = symbol;
+        for (size_t level = 0; level < INTERVAL_COUNT; ++level) {
+            s.intervals[level] = CandleState{};
+            s.intervals[level].completed = std::make_shared<CandleHistory>(retention_[level]);
         }
+        return it->second;
+    }
+
+    const CandleAggregator::SymbolCandles* CandleAggregator::find(const std::string& symbol) const {
+        auto it = index_.find(symbol);
+        return it == index_.end() ? nullptr : &symbols_[it->second];
     }
 
     void CandleAggregator::onTick(const std::string& symbol, Price price, double volume, Timestamp simTime) {
-        auto symbolIt = data_.find(symbol);
-        if (symbolIt == data_.end()) return;
+        auto it = index_.find(symbol);
+        if (it != index_.end()) onTick(it->second, price, volume, simTime);
+    }
 
-        for (auto& [interval, state] : symbolIt->second) {
-            Timestamp boundary = getCandleBoundary(simTime, interval);
+    void CandleAggregator::onTick(size_t symbolIndex, Price price, double volume, Timestamp simTime) {
+        if (symbolIndex >= symbols_.size()) return;
+        SymbolCandles& s = symbols_[symbolIndex];
+        CandleState& state = s.intervals[index(Interval::M1)];
 
+        if (!state.hasData) {
+            // First tick ever for this symbol
+            startCandle(state.current, getCandleBoundary(simTime, Interval::M1), price, volume);
+            state.hasData = true;
+        }
+        else if (simTime >= state.current.time + MS_PER_MINUTE) {
+            // New minute: close it and roll it up into the coarser intervals
+            Candle closed = state.current;
+            closeCandle(state, 0);
+            startCandle(state.current, getCandleBoundary(simTime, Interval::M1), price, volume);
+            rollUp(s, 1, closed, simTime);
+        }
+        else {
+            // Same minute — update OHLCV
+            state.current.high = std::max(state.current.high, price);
+            state.current.low = std::min(state.current.low, price);
+            state.current.close = price;
+            state.current.volume += volume;
+        }
+    }
+
+    void CandleAggregator::rollUp(SymbolCandles& s, size_t level, const Candle& closed, Timestamp newTime) {
+        Candle finer = closed;
+        for (; level < INTERVAL_COUNT; ++level) {
+            auto interval = static_cast<Interval>(level);
+            CandleState& state = s.intervals[level];
             if (!state.hasData) {
-                // First tick ever for this candle
-                state.current.time = boundary;
-                state.current.open = price;
-                state.current.high = price;
-                state.current.low = price;
-                state.current.close = price;
-                state.current.volume = volume;
+                state.current = finer;
+                state.current.time = getCandleBoundary(finer.time, interval);
                 state.hasData = true;
             }
-            else if (boundary > state.current.time) {
-                // New candle period — close current and start new
-                closeCandle(state, boundary);
-                state.current.time = boundary;
-                state.current.open = price;
-                state.current.high = price;
-                state.current.low = price;
-                state.current.close = price;
-                state.current.volume = volume;
-            }
             else {
-                // Same candle period — update OHLCV
-                state.current.high = std::max(state.current.high, price);
-                state.current.low = std::min(state.current.low, price);
-                state.current.close = price;
-                state.current.volume += volume;
+                mergeCandle(state.current, finer);
             }
+
+            // Coarser intervals can only close where this one does
+            if (getCandleBoundary(newTime, interval) <= state.current.time) return;
+            finer = state.current;
+            closeCandle(state, level);
+            state.hasData = false;
         }
     }
 
-    std::vector<Candle> CandleAggregator::getCandles(const std::string& symbol, Interval interval,
-        Timestamp since, int limit) const {
-        auto symbolIt = data_.find(symbol);
-        if (symbolIt == data_.end()) return {};
-
-        auto intervalIt = symbolIt->second.find(interval);
-        if (intervalIt == symbolIt->second.end()) return {};
-
-        const auto& completed = intervalIt->second.completed;
+    Candle CandleAggregator::currentCandle(const SymbolCandles& s, size_t level) const {
+        // Coarse to fine is oldest to newest within the open period
+        Candle result{};
+        bool any = false;
+        for (size_t l = level + 1; l-- > 0;) {
+            const CandleState& state = s.intervals[l];
+            if (!state.hasData) continue;
+            if (!any) {
+                result = state.current;
+                result.time = getCandleBoundary(state.current.time, static_cast<Interval>(level));
+                any = true;
+            }
+            else {
+                mergeCandle(result, state.current);
+            }
+        }
+        return result;
+    }
 
-        std::vector<Candle> result;
-        result.reserve(std::min(static_cast<size_t>(limit), completed.size()));
+    void CandleAggregator::setRetention(Interval interval, size_t candles) {
+        size_t level = index(interval);
+        retention_[level] = std::max<size_t>(1, candles);
+        for (auto& s : symbols_) {
+            CandleState& state = s.intervals[level];
+            if (state.shared) {
+                state.completed = std::make_shared<CandleHistory>(*state.completed);
+                state.shared = false;
+            }
+            state.completed->setCapacity(retention_[level]);
+        }
+    }
 
-        for (auto it = completed.rbegin(); it != completed.rend() && static_cast<int>(result.size()) < limit; ++it) {
-            if (since > 0 && it->time < since) break;
-            result.push_back(*it);
+    void CandleAggregator::writeCheckpoint(CheckpointWriter& out) const {
+        out.write(static_cast<uint64_t>(symbols_.size()));
+        for (const auto& s : symbols_) {
+            out.write(s.symbol);
+            out.write(static_cast<uint64_t>(INTERVAL_COUNT));
+            for (size_t level = 0; level < INTERVAL_COUNT; ++level) {
+                const CandleState& state = s.intervals[level];
+                out.write(static_cast<Interval>(level));
+                out.write(state.hasData);
+                out.write(state.current);
+                const CandleHistory& completed = *state.completed;
+                out.write(static_cast<uint64_t>(completed.size()));
+                for (size_t i = 0; i < completed.size(); ++i) out.write(completed[i]);
+            }
         }
+    }
 
-        // Reverse to chronological order
-        std::reverse(result.begin(), result.end());
+    void CandleAggregator::readCheckpoint(CheckpointReader& in) {
+        size_t symbols = in.readCount(1);
+        for (size_t i = 0; i < symbols; ++i) {
+            std::string symbol;
+            in.read(symbol);
+            auto symbolIt = index_.find(symbol);
 
-        // Apply since filter
-        if (since > 0) {
-            result.erase(
-                std::remove_if(result.begin(), result.end(),
-                    [since](const Candle& c) { return c.time < since; }),
-                result.end()
-            );
+            size_t intervals = in.readCount(1);
+            for (size_t j = 0; j < intervals; ++j) {
+                CandleState state;
+                auto interval = in.read<Interval>();
+                size_t level = index(interval);
+                if (level >= INTERVAL_COUNT) throw std::runtime_error("Invalid checkpoint: unknown candle interval");
+                in.read(state.hasData);
+                in.read(state.current);
+                state.completed = std::make_shared<CandleHistory>(retention_[level]);
+                size_t completed = in.readCount(sizeof(Candle::time));
+                for (size_t k = 0; k < completed; ++k) {
+                    Candle candle;
+                    in.read(candle);
+                    state.completed->push(candle);
+                }
+                if (symbolIt != index_.end()) symbols_[symbolIt->second].intervals[level] = std::move(state);
+            }
         }
+    }
 
-        // Apply limit
-        if (static_cast<int>(result.size()) > limit) {
-            result.erase(result.begin(), result.end() - limit);
+    CandleAggregator CandleAggregator::fork() {
+        for (auto& s : symbols_) {
+            for (auto& state : s.intervals) state.shared = true;
         }
+        return *this;
+    }
+
+    std::pair<size_t, size_t> CandleAggregator::select(const CandleHistory& completed, Timestamp since, int limit) {
+        size_t end = completed.size();
+        if (limit <= 0) return { end, end };
+        size_t begin = since > 0 ? completed.lowerBound(since) : 0;
+        return { std::max(begin, end - std::min<size_t>(end, static_cast<size_t>(limit))), end };
+    }
 
+    std::vector<Candle> CandleAggregator::getCandles(const std::string& symbol, Interval interval,
+        Timestamp since, int limit) const {
+        const SymbolCandles* s = find(symbol);
+        if (!s) return {};
+
+        const CandleHistory& completed = *s->intervals[index(interval)].completed;
+        auto [begin, end] = select(completed, since, limit);
+        std::vector<Candle> result;
+        result.reserve(end - begin);
+        for (size_t i = begin; i < end; ++i) result.push_back(completed[i]);
         return result;
     }
 
     std::map<std::string, std::vector<Candle>> CandleAggregator::getAllCandles(Interval interval,
         Timestamp since) const {
         std::map<std::string, std::vector<Candle>> result;
-        for (const auto& [symbol, intervals] : data_) {
-            result[symbol] = getCandles(symbol, interval, since, MAX_CANDLES);
+        int limit = static_cast<int>(std::min<size_t>(retention_[index(interval)], std::numeric_limits<int>::max()));
+        for (const auto& s : symbols_) {
+            result[s.symbol] = getCandles(s.symbol, interval, since, limit);
         }
         return result;
     }
 
-    Candle CandleAggregator::getCurrentCandle(const std::string& symbol, Interval interval) const {
-        auto symbolIt = data_.find(symbol);
-        if (symbolIt == data_.end()) return {};
-
-        auto intervalIt = symbolIt->second.find(interval);
-        if (intervalIt == symbolIt->second.end()) return {};
+    void CandleAggregator::appendJson(std::string& out, const CandleHistory& completed, Timestamp since, int limit) {
+        auto [begin, end] = select(completed, since, limit);
+        out += '[';
+        out += completed.json(begin, end);
+        out += ']';
+    }
 
-        return intervalIt->second.current;
+    std::string CandleAggregator::getCandlesJson(const std::string& symbol, Interval interval,
+        Timestamp since, int limit) const {
+        const SymbolCandles* s = find(symbol);
+        if (!s) return "[]";
+        std::string out;
+        appendJson(out, *s->intervals[index(interval)].completed, since, limit);
+        return out;
     }
 
-    size_t CandleAggregator::getCandleCount(const std::string& symbol, Interval interval) const {
-        auto symbolIt = data_.find(symbol);
-        if (symbolIt == data_.end()) return 0;
+    std::string CandleAggregator::getAllCandlesJson(Interval interval, Timestamp since) const {
+        std::map<std::string, const CandleHistory*> bySymbol;
+        for (const auto& s : symbols_) bySymbol[s.symbol] = s.intervals[index(interval)].completed.get();
 
-        auto intervalIt = symbolIt->second.find(interval);
-        if (intervalIt == symbolIt->second.end()) return 0;
+        int limit = static_cast<int>(std::min<size_t>(retention_[index(interval)], std::numeric_limits<int>::max()));
+        std::string out = "{";
+        for (const auto& [symbol, completed] : bySymbol) {
+            if (out.size() > 1) out += ',';
+            out += '"';
+            out += symbol;
+            out += "\":";
+            appendJson(out, *completed, since, limit);
+        }
+        out += '}';
+        return out;
+    }
 
-        return intervalIt->second.completed.size();
+    Candle CandleAggregator::getCurrentCandle(const std::string& symbol, Interval interval) const {
+        const SymbolCandles* s = find(symbol);
+        if (!s) return {};
+        return currentCandle(*s, index(interval));
+    }
+
+    size_t CandleAggregator::getCandleCount(const std::string& symbol, Interval interval) const {
+        const SymbolCandles* s = find(symbol);
+        if (!s) return 0;
+        return s->intervals[index(interval)].completed->size();
     }
 
     void CandleAggregator::reset() {
-        data_.clear();
+        symbols_.clear();
+        index_.clear();
     }
 
     std::string CandleAggregator::intervalToString(Interval interval) {
@@ -159,19 +376,21 @@ namespace market {
         return MS_PER_DAY;
     }
 
-    Timestamp CandleAggregator::getCandleBoundary(Timestamp time, Interval interval) const {
+    Timestamp CandleAggregator::getCandleBoundary(Timestamp time, Interval interval) {
         Timestamp intervalMs = getIntervalMs(interval);
         return (time / intervalMs) * intervalMs;
     }
 
-    void CandleAggregator::closeCandle(CandleState& state, Timestamp newBoundary) {
-        if (state.hasData && state.current.open > 0) {
-            state.completed.push_back(state.current);
-
-            // Bound the deque size
-            while (state.completed.size() > MAX_CANDLES) {
-                state.completed.pop_front();
+    void CandleAggregator::closeCandle(CandleState& state, size_t level) {
+        if (state.current.open > 0) {
+            if (!state.completed) {
+                state.completed = std::make_shared<CandleHistory>(retention_[level]);
+            }
+            else if (state.shared) {
+                state.completed = std::make_shared<CandleHistory>(*state.completed);
             }
+            state.shared = false;
+            state.completed->push(state.current);
         }
     }
 
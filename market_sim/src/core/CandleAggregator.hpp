@@ -2,14 +2,27 @@
 
 #include "Types.hpp"
 #include "SimClock.hpp"
+#include <algorithm>
+#include <array>
 #include <vector>
-#include <deque>
 #include <map>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 
 namespace market {
 
-    // Aggregates tick-level price data into OHLCV candles at multiple intervals
+    class CheckpointWriter;
+    class CheckpointReader;
+
+    // Aggregates tick-level price data into OHLCV candles at multiple intervals.
+    // Only the 1-minute candle is updated per tick; each coarser interval is
+    // rolled up from the next finer one when that closes, and closes itself
+    // when the tick that closed the finer one falls past its own boundary
+    // (every interval divides the next). Symbols are indexed in addSymbol()
+    // order, and completed candles are kept in per-interval rings.
     class CandleAggregator {
     public:
         // Supported intervals in simulated milliseconds
@@ -22,18 +35,31 @@ namespace market {
             D1      // 1 day
         };
 
+        static constexpr size_t INTERVAL_COUNT = 6;
+        static constexpr size_t DEFAULT_RETENTION = 10000;
+
         CandleAggregator();
+        CandleAggregator(CandleAggregator&&) = default;
+        CandleAggregator& operator=(CandleAggregator&&) = default;
 
         // Initialize with the clock reference for time boundaries
         void initialize(const SimClock* clock);
 
-        // Register a symbol to track
-        void addSymbol(const std::string& symbol);
+        // Register a symbol to track (again: its candles restart). Returns
+        // its index for onTick(size_t, ...).
+        size_t addSymbol(const std::string& symbol);
 
         // Feed a new price tick
         void onTick(const std::string& symbol, Price price, double volume, Timestamp simTime);
+        void onTick(size_t symbolIndex, Price price, double volume, Timestamp simTime);
 
-        // Get completed candles for a symbol at a given interval
+        // Completed candles kept per symbol at `interval` (at least 1);
+        // older ones are dropped, now if already over
+        void setRetention(Interval interval, size_t candles);
+        size_t getRetention(Interval interval) const { return retention_[index(interval)]; }
+
+        // Get completed candles for a symbol at a given interval: the newest
+        // `limit` starting at or after `since`, found by binary search
         std::vector<Candle> getCandles(const std::string& symbol, Interval interval,
             Timestamp since = 0, int limit = 500) const;
 
@@ -41,6 +67,14 @@ namespace market {
         std::map<std::string, std::vector<Candle>> getAllCandles(Interval interval,
             Timestamp since = 0) const;
 
+        // The same selections as a JSON array of {time, open, high, low,
+        // close, volume} objects, and an object of such arrays by symbol.
+        // Candles are serialized once, when they close, so these only copy
+        // text: O(log n) plus the size of the answer.
+        std::string getCandlesJson(const std::string& symbol, Interval interval,
+            Timestamp since = 0, int limit = 500) const;
+        std::string getAllCandlesJson(Interval interval, Timestamp since = 0) const;
+
         // Get the current (incomplete) candle for a symbol
         Candle getCurrentCandle(const std::string& symbol, Interval interval) const;
 
@@ -50,6 +84,16 @@ namespace market {
         // Clear all data
         void reset();
 
+        // Open and completed candles of every symbol. Loading only fills
+        // symbols registered with addSymbol(); others in the checkpoint are skipped.
+        void writeCheckpoint(CheckpointWriter& out) const;
+        void readCheckpoint(CheckpointReader& in);
+
+        // Copy for a forked engine. Completed candles are shared, not copied:
+        // from here on both this aggregator and the copy copy a series before
+        // they next close a candle in it, so neither sees the other's candles.
+        CandleAggregator fork();
+
         // Convert interval enum to string
         static std::string intervalToString(Interval interval);
 
@@ -60,28 +104,87 @@ namespace market {
         static Timestamp getIntervalMs(Interval interval);
 
     private:
-        static constexpr size_t MAX_CANDLES = 10000;
-
         static constexpr Timestamp MS_PER_MINUTE = 60000;
         static constexpr Timestamp MS_PER_HOUR = 3600000;
         static constexpr Timestamp MS_PER_DAY = 86400000;
 
+        // Completed candles, oldest first, in one ring of at most `capacity`.
+        // Alongside, each candle's JSON object is kept in one text buffer in
+        // the same order, so a run of candles serializes as a single slice.
+        class CandleHistory {
+        public:
+            explicit CandleHistory(size_t capacity) : capacity_(capacity) {}
+
+            size_t size() const { return candles_.size(); }
+            const Candle& operator[](size_t i) const { return candles_[slot(i)]; }
+
+            void push(const Candle& candle);
+
+            // Keeps the newest `capacity` candles
+            void setCapacity(size_t capacity);
+
+            // First index whose candle starts at or after `time`; times only increase
+            size_t lowerBound(Timestamp time) const;
+
+            // Candles [begin, end) as comma-separated JSON objects
+            std::string_view json(size_t begin, size_t end) const;
+
+        private:
+            std::vector<Candle> candles_;   // Grows to capacity_, then wraps at head_
+            std::vector<uint64_t> offsets_; // Per slot: where its object starts, counting from base_
+            std::string text_;              // Objects oldest first, each followed by ','
+            uint64_t base_ = 0;             // Absolute offset of text_[0]
+            size_t head_ = 0;               // Oldest once full
+            size_t capacity_;
+
+            size_t slot(size_t i) const { return (head_ + i) % candles_.size(); }
+            size_t textPos(size_t i) const { return static_cast<size_t>(offsets_[slot(i)] - base_); }
+        };
+
         struct CandleState {
-            Candle current;          // Currently building candle
-            std::deque<Candle> completed;  // Completed candles
+            // M1: built from ticks. Coarser: the finer candles closed into it
+            // so far; the finer open candles complete it (see currentCandle).
+            Candle current{};
             bool hasData = false;
+            std::shared_ptr<CandleHistory> completed;
+            bool shared = false;     // `completed` is also a fork's; copy before writing
+        };
+
+        struct SymbolCandles {
+            std::string symbol;
+            std::array<CandleState, INTERVAL_COUNT> intervals;
         };
 
-        // symbol -> interval -> candle state
-        std::map<std::string, std::map<Interval, CandleState>> data_;
+        std::vector<SymbolCandles> symbols_;              // By addSymbol() index
+        std::unordered_map<std::string, size_t> index_;   // Symbol -> index into symbols_
+        std::array<size_t, INTERVAL_COUNT> retention_;
 
         const SimClock* clock_ = nullptr;
 
+        // Plain copies would alias the completed series; fork() makes them
+        CandleAggregator(const CandleAggregator&) = default;
+        CandleAggregator& operator=(const CandleAggregator&) = default;
+
+        static size_t index(Interval interval) { return static_cast<size_t>(interval); }
+
+        const SymbolCandles* find(const std::string& symbol) const;
+
+        // Index range of getCandles() within the interval's history
+        static std::pair<size_t, size_t> select(const CandleHistory& completed, Timestamp since, int limit);
+        static void appendJson(std::string& out, const CandleHistory& completed, Timestamp since, int limit);
+
         // Get the candle boundary start time for a given timestamp and interval
-        Timestamp getCandleBoundary(Timestamp time, Interval interval) const;
+        static Timestamp getCandleBoundary(Timestamp time, Interval interval);
+
+        // Folds `closed`, a finished candle of level - 1, into `level` upward,
+        // closing each interval that `newTime` has moved past
+        void rollUp(SymbolCandles& s, size_t level, const Candle& closed, Timestamp newTime);
+
+        // The open candle at `level`: its rolled-up part plus the finer open ones
+        Candle currentCandle(const SymbolCandles& s, size_t level) const;
 
-        // Close current candle and start a new one
-        void closeCandle(CandleState& state, Timestamp newBoundary);
+        // Append a finished candle to the interval's history
+        void closeCandle(CandleState& state, size_t level);
     };
 
 } // namespace market
@@ -0,0 +1,413 @@
+#pragma once
+
+#include "Types.hpp"
+#include "utils/Random.hpp"
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace market {
+
+    // Binary checkpoint of a running simulation: a header (magic, format
+    // version) and then tagged, length-prefixed sections, each written by the
+    // component that owns the state. Scalars are stored in host byte order and
+    // doubles bit for bit, so a restored run continues exactly where the saved
+    // one stopped; a checkpoint moves between builds and hosts of the same
+    // architecture, not across endianness.
+    namespace checkpoint {
+        inline constexpr char MAGIC[8] = { 'M', 'S', 'I', 'M', 'C', 'K', 'P', 'T' };
+        // Bump on any layout change; readers refuse other versions
+        inline constexpr uint32_t VERSION = 5;
+
+        constexpr uint32_t tag(const char (&name)[5]) {
+            return static_cast<uint32_t>(static_cast<uint8_t>(name[0]))
+                | static_cast<uint32_t>(static_cast<uint8_t>(name[1])) << 8
+                | static_cast<uint32_t>(static_cast<uint8_t>(name[2])) << 16
+                | static_cast<uint32_t>(static_cast<uint8_t>(name[3])) << 24;
+        }
+    }
+
+    // The same container under another magic and version, for other binary
+    // files built from sections (the order journal)
+    class CheckpointWriter {
+    public:
+        CheckpointWriter(const char (&magic)[8] = checkpoint::MAGIC, uint32_t version = checkpoint::VERSION) {
+            writeRaw(magic, sizeof(magic));
+            write(version);
+        }
+
+        template <typename T, std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T>, int> = 0>
+        void write(T value) { writeRaw(&value, sizeof(value)); }
+
+        void write(const std::string& s) {
+            write(static_cast<uint64_t>(s.size()));
+            writeRaw(s.data(), s.size());
+        }
+
+        // Count, then the elements as one block
+        template <typename T>
+        void writeArray(ConstSpan<T> values) {
+            static_assert(std::is_arithmetic_v<T>, "writeArray takes scalars; use writeList for structs");
+            write(static_cast<uint64_t>(values.size()));
+            writeRaw(values.data(), values.size() * sizeof(T));
+        }
+        template <typename T>
+        void writeArray(const std::vector<T>& values) { writeArray(ConstSpan<T>(values)); }
+
+        // Count, then write(element) for each
+        template <typename Range>
+        void writeList(const Range& items) {
+            write(static_cast<uint64_t>(items.size()));
+            for (const auto& item : items) write(item);
+        }
+
+        void write(const Order& o) {
+            write(o.id);
+            write(o.agentId);
+            write(o.symbolId);
+            write(o.side);
+            write(o.type);
+            write(o.price);
+            write(o.quantity);
+            write(o.timestamp);
+        }
+
+        void write(const OrderAction& a) {
+            write(a.kind);
+            write(a.order);
+        }
+
+        void write(const Trade& t) {
+            write(t.buyOrderId);
+            write(t.sellOrderId);
+            write(t.buyerId);
+            write(t.sellerId);
+            write(t.buyerType);
+            write(t.sellerType);
+            write(t.symbolId);
+            write(t.priceTicks);
+            write(t.price);
+            write(t.quantity);
+            write(t.timestamp);
+        }
+
+        void write(const NewsEvent& n) {
+            write(n.category);
+            write(n.sentiment);
+            write(n.symbol);
+            write(n.commodityName);
+            write(n.subcategory);
+            write(n.magnitude);
+            write(n.timestamp);
+            write(n.headline);
+            write(n.symbolId);
+        }
+
+        void write(const Candle& c) {
+            write(c.time);
+            write(c.open);
+            write(c.high);
+            write(c.low);
+            write(c.close);
+            write(c.volume);
+        }
+
+        void write(const SupplyDemand& sd) {
+            write(sd.production);
+            write(sd.imports);
+            write(sd.exports);
+            write(sd.consumption);
+            write(sd.inventory);
+        }
+
+        void write(const Position& p) {
+            write(p.symbolId);
+            write(p.quantity);
+            write(p.avgCost);
+        }
+
+        void write(const AgentParams& p) {
+            write(p.riskAversion);
+            write(p.reactionSpeed);
+            write(p.newsWeight);
+            write(p.confidenceLevel);
+            write(p.timeHorizon);
+        }
+
+        void write(const AgentTypeStats& s) {
+            write(s.ordersPlaced);
+            write(s.buyOrders);
+            write(s.sellOrders);
+            write(s.cancels);
+            write(s.fills);
+            write(s.volumeTraded);
+            write(s.cashSpent);
+            write(s.cashReceived);
+        }
+
+        void write(const Random::Engine& engine) {
+            Random::Engine::State s = engine.getState();
+            for (uint32_t v : s.key) write(v);
+            for (uint32_t v : s.counter) write(v);
+            for (uint32_t v : s.buffer) write(v);
+            write(s.index);
+            write(s.hasSpareNormal);
+            write(s.spareNormal);
+        }
+
+        // Sections nest; the length is patched in by endSection()
+        void beginSection(uint32_t tag) {
+            write(tag);
+            open_.push_back(buffer_.size());
+            write(uint64_t{ 0 });
+        }
+
+        void endSection() {
+            size_t at = open_.back();
+            open_.pop_back();
+            uint64_t length = buffer_.size() - at - sizeof(uint64_t);
+            std::memcpy(buffer_.data() + at, &length, sizeof(length));
+        }
+
+        size_t size() const { return buffer_.size(); }
+        const std::vector<char>& data() const { return buffer_; }
+        // Hands over what was written so far; later sections start a new
+        // buffer, so a stream can be drained between sections
+        std::vector<char> release() {
+            std::vector<char> out;
+            out.swap(buffer_);
+            return out;
+        }
+
+    private:
+        std::vector<char> buffer_;
+        std::vector<size_t> open_;  // Offsets of the open sections' length fields
+
+        void writeRaw(const void* data, size_t bytes) {
+            const char* p = static_cast<const char*>(data);
+            buffer_.insert(buffer_.end(), p, p + bytes);
+        }
+    };
+
+    // Reads what CheckpointWriter wrote, in the same order. Every read is
+    // bounds-checked, and a truncated or malformed file throws
+    // std::runtime_error rather than reading past the end.
+    class CheckpointReader {
+    public:
+        // `kind` names the file in error messages
+        explicit CheckpointReader(std::vector<char> data, const char (&magic)[8] = checkpoint::MAGIC,
+            uint32_t version = checkpoint::VERSION, const char* kind = "checkpoint")
+            : buffer_(std::move(data)), kind_(kind) {
+            char found[sizeof(magic)];
+            if (buffer_.size() < sizeof(found)) fail("file too short");
+            readRaw(found, sizeof(found));
+            if (std::memcmp(found, magic, sizeof(found)) != 0) fail(std::string("not a ") + kind_ + " file");
+            version_ = read<uint32_t>();
+            if (version_ != version) {
+                fail("unsupported version " + std::to_string(version_) +
+                    " (expected " + std::to_string(version) + ")");
+            }
+        }
+
+        uint32_t version() const { return version_; }
+
+        template <typename T, std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T>, int> = 0>
+        T read() {
+            T value;
+            readRaw(&value, sizeof(value));
+            return value;
+        }
+
+        template <typename T, std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T>, int> = 0>
+        void read(T& value) { value = read<T>(); }
+
+        void read(std::string& s) {
+            size_t n = readCount(1);
+            s.assign(cursor(), n);
+            pos_ += n;
+        }
+
+        // Element count whose elements take at least minBytes each, checked
+        // against what is left so a corrupt count cannot force a huge allocation
+        size_t readCount(size_t minBytes) {
+            uint64_t n = read<uint64_t>();
+            if (minBytes > 0 && n > remaining() / minBytes) fail("element count out of range");
+            return static_cast<size_t>(n);
+        }
+
+        template <typename T>
+        void readArray(std::vector<T>& values) {
+            static_assert(std::is_arithmetic_v<T>, "readArray takes scalars; use readList for structs");
+            size_t n = readCount(sizeof(T));
+            values.resize(n);
+            readRaw(values.data(), n * sizeof(T));
+        }
+
+        template <typename T>
+        void readList(std::vector<T>& items) {
+            size_t n = readCount(1);
+            items.clear();
+            items.resize(n);
+            for (T& item : items) read(item);
+        }
+
+        void read(Order& o) {
+            read(o.id);
+            read(o.agentId);
+            read(o.symbolId);
+            read(o.side);
+            read(o.type);
+            read(o.price);
+            read(o.quantity);
+            read(o.timestamp);
+        }
+
+        void read(OrderAction& a) {
+            read(a.kind);
+            read(a.order);
+        }
+
+        void read(Trade& t) {
+            read(t.buyOrderId);
+            read(t.sellOrderId);
+            read(t.buyerId);
+            read(t.sellerId);
+            read(t.buyerType);
+            read(t.sellerType);
+            read(t.symbolId);
+            read(t.priceTicks);
+            read(t.price);
+            read(t.quantity);
+            read(t.timestamp);
+        }
+
+        void read(NewsEvent& n) {
+            read(n.category);
+            read(n.sentiment);
+            read(n.symbol);
+            read(n.commodityName);
+            read(n.subcategory);
+            read(n.magnitude);
+            read(n.timestamp);
+            read(n.headline);
+            read(n.symbolId);
+        }
+
+        void read(Candle& c) {
+            read(c.time);
+            read(c.open);
+            read(c.high);
+            read(c.low);
+            read(c.close);
+            read(c.volume);
+        }
+
+        void read(SupplyDemand& sd) {
+            read(sd.production);
+            read(sd.imports);
+            read(sd.exports);
+            read(sd.consumption);
+            read(sd.inventory);
+        }
+
+        void read(Position& p) {
+            read(p.symbolId);
+            read(p.quantity);
+            read(p.avgCost);
+        }
+
+        void read(AgentParams& p) {
+            read(p.riskAversion);
+            read(p.reactionSpeed);
+            read(p.newsWeight);
+            read(p.confidenceLevel);
+            read(p.timeHorizon);
+        }
+
+        void read(AgentTypeStats& s) {
+            read(s.ordersPlaced);
+            read(s.buyOrders);
+            read(s.sellOrders);
+            read(s.cancels);
+            read(s.fills);
+            read(s.volumeTraded);
+            read(s.cashSpent);
+            read(s.cashReceived);
+        }
+
+        void read(Random::Engine& engine) {
+            Random::Engine::State s{};
+            for (uint32_t& v : s.key) read(v);
+            for (uint32_t& v : s.counter) read(v);
+            for (uint32_t& v : s.buffer) read(v);
+            read(s.index);
+            read(s.hasSpareNormal);
+            read(s.spareNormal);
+            engine.setState(s);
+        }
+
+        // Expects the next section to be `tag`. Reads are then confined to it,
+        // and leaveSection() skips whatever the reader did not consume.
+        void enterSection(uint32_t tag) {
+            uint32_t found = enterSection();
+            if (found != tag) fail("expected section " + tagName(tag) + ", found " + tagName(found));
+        }
+
+        // Whether a whole section follows (a file cut short mid-write ends in
+        // a partial one), and entering it whatever its tag
+        bool hasSection() const {
+            size_t header = sizeof(uint32_t) + sizeof(uint64_t);
+            if (remaining() < header) return false;
+            uint64_t length;
+            std::memcpy(&length, cursor() + sizeof(uint32_t), sizeof(length));
+            return length <= remaining() - header;
+        }
+
+        uint32_t enterSection() {
+            uint32_t tag = read<uint32_t>();
+            uint64_t length = read<uint64_t>();
+            if (length > remaining()) fail("section " + tagName(tag) + " is truncated");
+            ends_.push_back(pos_ + static_cast<size_t>(length));
+            return tag;
+        }
+
+        void leaveSection() {
+            if (pos_ > ends_.back()) fail("section overrun");
+            pos_ = ends_.back();
+            ends_.pop_back();
+        }
+
+        bool atEnd() const { return pos_ == buffer_.size(); }
+
+    private:
+        std::vector<char> buffer_;
+        size_t pos_ = 0;
+        std::vector<size_t> ends_;  // End offsets of the entered sections
+        uint32_t version_ = 0;
+        const char* kind_;
+
+        size_t limit() const { return ends_.empty() ? buffer_.size() : ends_.back(); }
+        size_t remaining() const { return pos_ < limit() ? limit() - pos_ : 0; }
+        const char* cursor() const { return buffer_.data() + pos_; }
+
+        void readRaw(void* out, size_t bytes) {
+            if (bytes > remaining()) fail("unexpected end of data");
+            if (bytes > 0) std::memcpy(out, cursor(), bytes);
+            pos_ += bytes;
+        }
+
+        static std::string tagName(uint32_t tag) {
+            std::string name(4, ' ');
+            for (size_t i = 0; i < 4; ++i) name[i] = static_cast<char>((tag >> (8 * i)) & 0xFF);
+            return "'" + name + "'";
+        }
+
+        [[noreturn]] void fail(const std::string& what) const {
+            throw std::runtime_error(std::string("Invalid ") + kind_ + ": " + what);
+        }
+    };
+
+} // namespace market
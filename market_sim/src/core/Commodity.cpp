@@ -24,6 +24,7 @@ namespace market {
         , baseConsumption_(baseConsumption)
     {
         priceHistory_.push_back(initialPrice);
+        indicators_.append(initialPrice);
 
         supplyDemand_.production = baseProduction;
         supplyDemand_.consumption = baseConsumption;
@@ -46,11 +47,42 @@ namespace market {
         }
 
         price_ = price;
+        bool evicts = priceHistory_.full();
         priceHistory_.push_back(price);
+        indicators_.append(price);
+        if (evicts) indicators_.popFront();
+    }
 
-        if (priceHistory_.size() > MAX_HISTORY) {
-            priceHistory_.erase(priceHistory_.begin());
-        }
+    void Commodity::setHistoryCapacity(size_t capacity) {
+        priceHistory_.setCapacity(capacity);
+        while (indicators_.size() > priceHistory_.size()) indicators_.popFront();
+    }
+
+    void Commodity::writeCheckpoint(CheckpointWriter& out) const {
+        out.write(price_);
+        out.write(volatility_);
+        out.write(dailyVolume_);
+        out.writeArray(priceHistory_.view());
+        indicators_.writeCheckpoint(out);
+        out.write(supplyDemand_);
+        out.write(dayOpenPrice_);
+        out.write(circuitBroken_);
+    }
+
+    void Commodity::readCheckpoint(CheckpointReader& in) {
+        in.read(price_);
+        in.read(volatility_);
+        in.read(dailyVolume_);
+        std::vector<Price> history;
+        in.readArray(history);
+        priceHistory_.clear();
+        for (Price p : history) priceHistory_.push_back(p);
+        indicators_.readCheckpoint(in);
+        // The configured depth may have shrunk since the checkpoint was taken
+        while (indicators_.size() > priceHistory_.size()) indicators_.popFront();
+        in.read(supplyDemand_);
+        in.read(dayOpenPrice_);
+        in.read(circuitBroken_);
     }
 
     void Commodity::applyTradePrice(Price tradePrice, Volume tradeQty) {
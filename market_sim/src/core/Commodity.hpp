@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Types.hpp"
+#include "PriceIndicators.hpp"
+#include "RingBuffer.hpp"
 #include <string>
 #include <vector>
 #include <map>
@@ -24,7 +26,13 @@ namespace market {
         Price getPrice() const { return price_; }
         double getVolatility() const { return volatility_; }
         Volume getDailyVolume() const { return dailyVolume_; }
-        const std::vector<Price>& getPriceHistory() const { return priceHistory_; }
+        // Newest getHistoryCapacity() prices, oldest first; valid until the next update
+        ConstSpan<Price> getPriceHistory() const { return priceHistory_.view(); }
+        size_t getHistoryCapacity() const { return priceHistory_.capacity(); }
+        // Keeps the newest prices when shrinking
+        void setHistoryCapacity(size_t capacity);
+        // Rolling SMA / stddev / return / EMA indicators over getPriceHistory()
+        const PriceIndicators& getIndicators() const { return indicators_; }
 
         const SupplyDemand& getSupplyDemand() const { return supplyDemand_; }
         SupplyDemand& getMutableSupplyDemand() { return supplyDemand_; }
@@ -59,6 +67,14 @@ namespace market {
         void setSupplyDecayRate(double d) { supplyDecayRate_ = d; }
         void setDemandDecayRate(double d) { demandDecayRate_ = d; }
 
+        Price getTickSize() const { return tickSize_; }
+        void setTickSize(Price t) { if (t > 0) tickSize_ = t; }
+
+        // Market state only (price, history, supply/demand, daily counters);
+        // the configured parameters above are left as they are
+        void writeCheckpoint(CheckpointWriter& out) const;
+        void readCheckpoint(CheckpointReader& in);
+
     private:
         std::string symbol_;
         std::string name_;
@@ -66,8 +82,9 @@ namespace market {
         Price price_;
         double volatility_;
         Volume dailyVolume_;
-        std::vector<Price> priceHistory_;
-        static constexpr size_t MAX_HISTORY = 1000;
+        static constexpr size_t DEFAULT_HISTORY = 1000;
+        RingBuffer<Price> priceHistory_{ DEFAULT_HISTORY };
+        PriceIndicators indicators_;  // Updated alongside priceHistory_
 
         SupplyDemand supplyDemand_;
 
@@ -84,6 +101,8 @@ namespace market {
         double supplyDecayRate_ = 0.1;
         double demandDecayRate_ = 0.1;
         double baseInventory_ = 50.0;
+
+        Price tickSize_ = 0.01;
     };
 
 } // namespace market
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "RuntimeConfig.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace market {
+
+    // The RuntimeConfig in force, as immutable versioned snapshots. A writer
+    // copies the current snapshot, changes the copy and publishes it under
+    // the next version; readers take the current one with an atomic load and
+    // may keep it as long as they like, so no one ever reads a config while
+    // it is being changed. The engine adopts a new version at its next tick
+    // boundary (MarketEngine::adoptConfig), so configs never change mid-tick.
+    class ConfigStore {
+    public:
+        ConfigStore() { publish(RuntimeConfig()); }
+
+        ConfigStore(const ConfigStore&) = delete;
+        ConfigStore& operator=(const ConfigStore&) = delete;
+
+        std::shared_ptr<const RuntimeConfig> current() const { return std::atomic_load(&current_); }
+        uint64_t version() const { return version_.load(std::memory_order_acquire); }
+
+        // Publishes a copy of the current config after edit(copy). Writers
+        // are serialized; if edit throws, nothing is published.
+        template <typename Edit>
+        std::shared_ptr<const RuntimeConfig> update(Edit&& edit) {
+            std::lock_guard<std::mutex> lock(writeMutex_);
+            RuntimeConfig next = *current_;
+            edit(next);
+            return publishLocked(std::move(next));
+        }
+
+        std::shared_ptr<const RuntimeConfig> publish(RuntimeConfig config) {
+            std::lock_guard<std::mutex> lock(writeMutex_);
+            return publishLocked(std::move(config));
+        }
+
+    private:
+        std::mutex writeMutex_;
+        std::shared_ptr<const RuntimeConfig> current_;
+        std::atomic<uint64_t> version_{ 0 };
+
+        std::shared_ptr<const RuntimeConfig> publishLocked(RuntimeConfig config) {
+            config.version = version_.load(std::memory_order_relaxed) + 1;
+            auto snapshot = std::make_shared<const RuntimeConfig>(std::move(config));
+            std::atomic_store(&current_, snapshot);
+            version_.store(snapshot->version, std::memory_order_release);
+            return snapshot;
+        }
+    };
+
+} // namespace market
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace market {
+
+    // Dense cross-effect coefficients between every pair of symbols:
+    // at(source, target) is how much the target moves per unit return of the
+    // source (0 where none is configured). Rows are stored by source, so
+    // impliedMoves() adds one contiguous row per moving source into the
+    // output: an axpy loop the compiler vectorizes without reassociating
+    // floating-point sums, and which skips sources with no effects.
+    class CrossEffectMatrix {
+    public:
+        // n x n, all zero
+        void reset(size_t n) {
+            n_ = n;
+            coefficients_.assign(n * n, 0.0);
+            hasSource_.assign(n, 0);
+        }
+
+        size_t size() const { return n_; }
+        bool empty() const { return n_ == 0; }
+
+        void set(size_t source, size_t target, double coefficient) {
+            coefficients_[source * n_ + target] = coefficient;
+            if (coefficient != 0.0) hasSource_[source] = 1;
+        }
+
+        double at(size_t source, size_t target) const { return coefficients_[source * n_ + target]; }
+
+        // Whether any target has a coefficient for `source`
+        bool hasEffects(size_t source) const { return hasSource_[source] != 0; }
+
+        // out[target] = sum over sources of at(source, target) * returns[source].
+        // `returns` and `out` hold size() values and must not overlap.
+        void impliedMoves(const double* returns, double* out) const {
+            for (size_t target = 0; target < n_; ++target) out[target] = 0.0;
+            for (size_t source = 0; source < n_; ++source) {
+                double r = returns[source];
+                if (r == 0.0 || !hasSource_[source]) continue;
+                const double* row = coefficients_.data() + source * n_;
+                for (size_t target = 0; target < n_; ++target) out[target] += row[target] * r;
+            }
+        }
+
+    private:
+        size_t n_ = 0;
+        std::vector<double> coefficients_;  // n_ x n_, row per source
+        std::vector<char> hasSource_;
+    };
+
+} // namespace market
@@ -0,0 +1,237 @@
+#pragma once
+
+#include "Types.hpp"
+#include "Checkpoint.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace market {
+
+    // Append-only news history in tick order. Entries are fixed-size records
+    // in blocks of BLOCK_ENTRIES; symbol, category, sentiment and
+    // subcategory are interned to ids, and headlines are copied once into a
+    // text arena. Entries are found by tick with a binary search over the
+    // (sorted) tick column, and by symbol through a per-symbol list of
+    // entry indexes.
+    //
+    // Not synchronized. fork() shares every block, text block and name with
+    // the copy; whichever side appends first afterwards copies the open entry
+    // block and starts a text block of its own, so a fork can be read while
+    // the original goes on appending, and no side rewrites text the other
+    // can see.
+    class NewsLog {
+    public:
+        static constexpr size_t BLOCK_ENTRIES = 1024;
+        static constexpr size_t TEXT_BLOCK_BYTES = 64 * 1024;
+
+        // One entry. The views point into text blocks and interned names,
+        // which appending never moves or rewrites: they stay valid until
+        // this log is cleared or destroyed, or as long as a fork made after
+        // the entry was appended is still alive.
+        struct Record {
+            uint64_t tick = 0;
+            Timestamp timestamp = 0;
+            std::string_view symbol;
+            std::string_view category;
+            std::string_view sentiment;
+            std::string_view subcategory;
+            std::string_view headline;
+            double magnitude = 0.0;
+        };
+
+        size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+
+        Record operator[](size_t i) const {
+            const Entry& e = entry(i);
+            const auto& text = *text_[e.textBlock];
+            return Record{ e.tick, e.timestamp, *names_[e.symbol], *names_[e.category], *names_[e.sentiment],
+                *names_[e.subcategory], std::string_view(text.data() + e.textOffset, e.textLength), e.magnitude };
+        }
+
+        uint64_t tickAt(size_t i) const { return entry(i).tick; }
+
+        // Ticks must not decrease; throws std::runtime_error if `tick` is
+        // before the last entry's
+        void append(uint64_t tick, std::string_view symbol, std::string_view category,
+            std::string_view sentiment, double magnitude, std::string_view headline,
+            std::string_view subcategory = {}, Timestamp timestamp = 0) {
+            if (size_ > 0 && tick < tickAt(size_ - 1)) {
+                throw std::runtime_error("News must be appended in tick order");
+            }
+            if (tailShared_) unshareTail();
+
+            if (size_ % BLOCK_ENTRIES == 0) blocks_.push_back(std::make_shared<Block>());
+            Entry& e = (*blocks_.back())[size_ % BLOCK_ENTRIES];
+            e.tick = tick;
+            e.timestamp = timestamp;
+            e.magnitude = magnitude;
+            e.symbol = intern(symbol);
+            e.category = intern(category);
+            e.sentiment = intern(sentiment);
+            e.subcategory = intern(subcategory);
+            storeText(e, headline);
+
+            if (!symbol.empty()) {
+                if (bySymbol_.size() <= e.symbol) bySymbol_.resize(e.symbol + 1);
+                bySymbol_[e.symbol].push_back(static_cast<uint32_t>(size_));
+            }
+            size_++;
+        }
+
+        void append(uint64_t tick, const NewsEvent& news) {
+            append(tick, news.symbol, newsCategoryName(news.category), newsSentimentName(news.sentiment),
+                news.magnitude, news.headline, news.subcategory, news.timestamp);
+        }
+
+        // Index of the first entry at or after `tick`
+        size_t lowerBound(uint64_t tick) const {
+            size_t lo = 0;
+            size_t hi = size_;
+            while (lo < hi) {
+                size_t mid = lo + (hi - lo) / 2;
+                if (tickAt(mid) < tick) lo = mid + 1;
+                else hi = mid;
+            }
+            return lo;
+        }
+
+        // Indexes of the newest `limit` entries with ticks in [since, until),
+        // only `symbol`'s unless it is empty; oldest first
+        std::vector<size_t> select(uint64_t since, uint64_t until, std::string_view symbol, size_t limit) const {
+            std::vector<size_t> out;
+            if (since >= until) return out;
+            if (symbol.empty()) {
+                size_t end = lowerBound(until);
+                size_t begin = std::max(lowerBound(since), end - std::min(end, limit));
+                for (size_t i = begin; i < end; ++i) out.push_back(i);
+                return out;
+            }
+            auto it = nameIds_.find(symbol);
+            if (it == nameIds_.end() || it->second >= bySymbol_.size()) return out;
+            const auto& entries = bySymbol_[it->second];
+            auto byTick = [this](uint32_t i, uint64_t tick) { return tickAt(i) < tick; };
+            auto first = std::lower_bound(entries.begin(), entries.end(), since, byTick);
+            auto last = std::lower_bound(first, entries.end(), until, byTick);
+            size_t count = std::min(static_cast<size_t>(last - first), limit);
+            for (auto i = last - static_cast<ptrdiff_t>(count); i != last; ++i) out.push_back(*i);
+            return out;
+        }
+
+        // Copy sharing every block with this log; see the class comment
+        NewsLog fork() const {
+            tailShared_ = true;
+            return *this;
+        }
+
+        void clear() { *this = NewsLog(); }
+
+        // Bytes held by blocks, arena, names and index (shared blocks included)
+        size_t memoryBytes() const {
+            size_t bytes = blocks_.size() * sizeof(Block);
+            for (const auto& text : text_) bytes += text->capacity();
+            for (const auto& name : names_) bytes += sizeof(*name) + name->capacity();
+            for (const auto& entries : bySymbol_) bytes += entries.capacity() * sizeof(uint32_t);
+            return bytes;
+        }
+
+        void writeCheckpoint(CheckpointWriter& out) const {
+            out.write(static_cast<uint64_t>(size_));
+            for (size_t i = 0; i < size_; ++i) {
+                Record r = (*this)[i];
+                out.write(r.tick);
+                out.write(r.timestamp);
+                out.write(std::string(r.symbol));
+                out.write(std::string(r.category));
+                out.write(std::string(r.sentiment));
+                out.write(std::string(r.subcategory));
+                out.write(r.magnitude);
+                out.write(std::string(r.headline));
+            }
+        }
+
+        // Replaces the log with the checkpoint's
+        void readCheckpoint(CheckpointReader& in) {
+            clear();
+            size_t count = in.readCount(sizeof(uint64_t) * 2);
+            std::string symbol, category, sentiment, subcategory, headline;
+            for (size_t i = 0; i < count; ++i) {
+                uint64_t tick = in.read<uint64_t>();
+                Timestamp timestamp = in.read<Timestamp>();
+                in.read(symbol);
+                in.read(category);
+                in.read(sentiment);
+                in.read(subcategory);
+                double magnitude = in.read<double>();
+                in.read(headline);
+                append(tick, symbol, category, sentiment, magnitude, headline, subcategory, timestamp);
+            }
+        }
+
+    private:
+        struct Entry {
+            uint64_t tick;
+            Timestamp timestamp;
+            double magnitude;
+            uint32_t symbol;        // symbol to subcategory: into names_
+            uint32_t category;
+            uint32_t sentiment;
+            uint32_t subcategory;
+            uint32_t textBlock;     // Headline: text_[textBlock], from textOffset
+            uint32_t textOffset;
+            uint32_t textLength;
+        };
+        using Block = std::array<Entry, BLOCK_ENTRIES>;
+
+        std::vector<std::shared_ptr<Block>> blocks_;
+        std::vector<std::shared_ptr<std::vector<char>>> text_;  // Sized once, filled from the front
+        size_t textUsed_ = 0;                                    // Bytes filled in text_.back()
+        size_t size_ = 0;
+        // Interned strings, by id; shared with forks and never moved, so
+        // Record views and the keys of nameIds_ can point into them
+        std::vector<std::shared_ptr<const std::string>> names_;
+        std::unordered_map<std::string_view, uint32_t> nameIds_;
+        std::vector<std::vector<uint32_t>> bySymbol_;            // By symbol id: its entries
+        mutable bool tailShared_ = false;                        // The open blocks are also a fork's
+
+        const Entry& entry(size_t i) const { return (*blocks_[i / BLOCK_ENTRIES])[i % BLOCK_ENTRIES]; }
+
+        uint32_t intern(std::string_view name) {
+            auto it = nameIds_.find(name);
+            if (it != nameIds_.end()) return it->second;
+            uint32_t id = static_cast<uint32_t>(names_.size());
+            names_.push_back(std::make_shared<const std::string>(name));
+            nameIds_.emplace(*names_.back(), id);
+            return id;
+        }
+
+        void storeText(Entry& e, std::string_view text) {
+            if (text_.empty() || text.size() > text_.back()->size() - textUsed_) {
+                text_.push_back(std::make_shared<std::vector<char>>(std::max(TEXT_BLOCK_BYTES, text.size())));
+                textUsed_ = 0;
+            }
+            text.copy(text_.back()->data() + textUsed_, text.size());
+            e.textBlock = static_cast<uint32_t>(text_.size() - 1);
+            e.textOffset = static_cast<uint32_t>(textUsed_);
+            e.textLength = static_cast<uint32_t>(text.size());
+            textUsed_ += text.size();
+        }
+
+        // Gives this side its own copy of the entry block still being filled.
+        // Headlines go to a new text block instead: copying would move the
+        // text that this side's earlier Records point at.
+        void unshareTail() {
+            if (size_ % BLOCK_ENTRIES != 0) blocks_.back() = std::make_shared<Block>(*blocks_.back());
+            textUsed_ = text_.empty() ? 0 : text_.back()->size();
+            tailShared_ = false;
+        }
+    };
+
+} // namespace market
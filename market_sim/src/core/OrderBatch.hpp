@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Types.hpp"
+#include <vector>
+
+namespace market {
+
+    // Engine-owned buffer an agent appends its decisions to. Nothing touches a
+    // book while agents decide; the engine applies every batch in agent order
+    // once the phase is over, assigning ids to placed orders and stamping each
+    // action with the deciding agent's id, so cancels only reach its own orders.
+    class OrderBatch {
+    public:
+        void place(const Order& order) {
+            actions_.push_back({ OrderAction::Kind::PLACE, order });
+        }
+
+        void cancel(SymbolId symbol, OrderId orderId) {
+            OrderAction action;
+            action.kind = OrderAction::Kind::CANCEL;
+            action.order.id = orderId;
+            action.order.symbolId = symbol;
+            actions_.push_back(action);
+        }
+
+        // Pulls `orderId` and rests `order` in its place (on order.symbolId)
+        void replace(OrderId orderId, const Order& order) {
+            cancel(order.symbolId, orderId);
+            place(order);
+        }
+
+        void clear() { actions_.clear(); }
+        bool empty() const { return actions_.empty(); }
+        size_t size() const { return actions_.size(); }
+
+        ConstSpan<OrderAction> actions() const { return actions_; }
+        // For the engine while applying the batch
+        std::vector<OrderAction>& mutableActions() { return actions_; }
+
+    private:
+        std::vector<OrderAction> actions_;
+    };
+
+} // namespace market
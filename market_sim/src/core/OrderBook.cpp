@@ -1,75 +1,299 @@
 #include "OrderBook.hpp"
 #include <algorithm>
 #include <limits>
+#include <cmath>
+#include <stdexcept>
 
 namespace market {
 
-    OrderId OrderBook::nextOrderId_ = 1;
-
-    OrderBook::OrderBook(const std::string& symbol)
+    OrderBook::OrderBook(const std::string& symbol, Price tickSize, SymbolId symbolId)
         : symbol_(symbol)
+        , symbolId_(symbolId)
+        , tickSize_(tickSize > 0 ? tickSize : 0.01)
+        , wheel_(WHEEL_SLOTS)
+        , wheelBucketMs_(bucketWidthFor(maxOrderAgeMs_))
     {
+        double perUnit = 1.0 / tickSize_;
+        if (std::abs(perUnit - std::round(perUnit)) < 1e-9) {
+            ticksPerUnit_ = std::round(perUnit);
+        }
+    }
+
+    PriceTicks OrderBook::toTicks(Price price, OrderSide side) const {
+        double ticks = ticksPerUnit_ > 0 ? price * ticksPerUnit_ : price / tickSize_;
+        double nearest = std::round(ticks);
+        if (std::abs(ticks - nearest) < 1e-6) {
+            return static_cast<PriceTicks>(nearest);
+        }
+        return static_cast<PriceTicks>(side == OrderSide::BUY ? std::floor(ticks) : std::ceil(ticks));
+    }
+
+    Price OrderBook::toPrice(PriceTicks ticks) const {
+        return ticksPerUnit_ > 0 ? static_cast<Price>(ticks) / ticksPerUnit_
+                                 : static_cast<Price>(ticks) * tickSize_;
+    }
+
+    // ----- Node / level maintenance -----
+
+    OrderBook::OrderNode* OrderBook::allocateNode(const Order& order) {
+        OrderNode* node;
+        if (!freeNodes_.empty()) {
+            node = freeNodes_.back();
+            freeNodes_.pop_back();
+        }
+        else {
+            nodePool_.emplace_back();
+            node = &nodePool_.back();
+        }
+        node->order = order;
+        node->prev = nullptr;
+        node->next = nullptr;
+        node->wheelPrev = nullptr;
+        node->wheelNext = nullptr;
+        node->wheelSlot = UNSCHEDULED;
+        return node;
+    }
+
+    void OrderBook::releaseNode(OrderNode* node) {
+        auto it = orderIndex_.find(node->order.id);
+        if (it != orderIndex_.end() && it->second == node) {
+            orderIndex_.erase(it);
+        }
+        freeNodes_.push_back(node);
+    }
+
+    void OrderBook::appendNode(LevelMap& levels, OrderNode* node) {
+        auto levelIt = levels.try_emplace(node->priceTicks).first;
+        PriceLevel& level = levelIt->second;
+
+        node->level = levelIt;
+        node->prev = level.tail;
+        node->next = nullptr;
+        if (level.tail) level.tail->next = node;
+        else level.head = node;
+        level.tail = node;
+
+        level.totalQuantity += node->order.quantity;
+        if (node->order.type == OrderType::MARKET) level.marketQuantity += node->order.quantity;
+        level.orderCount++;
+    }
+
+    void OrderBook::removeNode(LevelMap& levels, OrderNode* node) {
+        PriceLevel& level = node->level->second;
+        level.totalQuantity -= node->order.quantity;
+        if (node->order.type == OrderType::MARKET) level.marketQuantity -= node->order.quantity;
+        level.orderCount--;
+
+        if (node->prev) node->prev->next = node->next;
+        else level.head = node->next;
+        if (node->next) node->next->prev = node->prev;
+        else level.tail = node->prev;
+
+        if (!level.head) {
+            levels.erase(node->level);
+        }
+
+        if (node->order.side == OrderSide::BUY) --bidOrderCount_;
+        else --askOrderCount_;
+
+        unscheduleExpiry(node);
+        releaseNode(node);
+    }
+
+    void OrderBook::fillNode(OrderNode* node, Volume qty) {
+        node->order.quantity -= qty;
+        node->level->second.totalQuantity -= qty;
+        if (node->order.type == OrderType::MARKET) node->level->second.marketQuantity -= qty;
+    }
+
+    OrderBook::OrderNode* OrderBook::bestBidNode() const {
+        return bidLevels_.empty() ? nullptr : bidLevels_.rbegin()->second.head;
+    }
+
+    OrderBook::OrderNode* OrderBook::bestAskNode() const {
+        return askLevels_.empty() ? nullptr : askLevels_.begin()->second.head;
+    }
+
+    // ----- Expiry wheel -----
+
+    void OrderBook::scheduleExpiry(OrderNode* node, Timestamp currentTime) {
+        if (!wheelStarted_) {
+            wheelCursor_ = currentTime / wheelBucketMs_;
+            wheelStarted_ = true;
+        }
+
+        node->expiresAt = expiryFor(node->order.timestamp);
+        Timestamp bucket = node->expiresAt / wheelBucketMs_;
+
+        // A slot holds one rotation only; if adds have outrun matching, sweep first
+        if (bucket >= wheelCursor_ + WHEEL_SLOTS - 1) {
+            expireOrdersUnlocked(currentTime);
+        }
+        // Already due (or clock rewound past the cursor) -> the next sweep's first slot
+        bucket = std::clamp(bucket, wheelCursor_, wheelCursor_ + static_cast<Timestamp>(WHEEL_SLOTS - 2));
+
+        node->wheelSlot = static_cast<size_t>(bucket % WHEEL_SLOTS);
+        WheelSlot& slot = wheel_[node->wheelSlot];
+        node->wheelPrev = slot.tail;
+        node->wheelNext = nullptr;
+        if (slot.tail) slot.tail->wheelNext = node;
+        else slot.head = node;
+        slot.tail = node;
+    }
+
+    void OrderBook::unscheduleExpiry(OrderNode* node) {
+        if (node->wheelSlot == UNSCHEDULED) return;
+
+        WheelSlot& slot = wheel_[node->wheelSlot];
+        if (node->wheelPrev) node->wheelPrev->wheelNext = node->wheelNext;
+        else slot.head = node->wheelNext;
+        if (node->wheelNext) node->wheelNext->wheelPrev = node->wheelPrev;
+        else slot.tail = node->wheelPrev;
+
+        node->wheelPrev = nullptr;
+        node->wheelNext = nullptr;
+        node->wheelSlot = UNSCHEDULED;
     }
 
+    size_t OrderBook::expireOrdersUnlocked(Timestamp currentTime) {
+        if (!wheelStarted_) return 0;
+
+        size_t expired = 0;
+        Timestamp target = currentTime / wheelBucketMs_;
+        if (target < wheelCursor_) {
+            // Sim clock was rewound (e.g. a fresh populate); re-bucket from the new time
+            expired += rebuildExpiryWheel(currentTime);
+        }
+
+        // Each slot is visited at most once, however far the clock jumped
+        Timestamp first = wheelCursor_;
+        if (target - first >= WHEEL_SLOTS) first = target - WHEEL_SLOTS + 1;
+
+        for (Timestamp bucket = first; bucket <= target; ++bucket) {
+            WheelSlot& slot = wheel_[bucket % WHEEL_SLOTS];
+            // Slots are in expiry order: stop at the first order still alive
+            while (slot.head && isExpired(slot.head, currentTime)) {
+                OrderNode* node = slot.head;
+                removeNode(node->order.side == OrderSide::BUY ? bidLevels_ : askLevels_, node);
+                expired++;
+            }
+        }
+
+        wheelCursor_ = target;
+        return expired;
+    }
+
+    size_t OrderBook::rebuildExpiryWheel(Timestamp currentTime) {
+        std::fill(wheel_.begin(), wheel_.end(), WheelSlot{});
+        wheelBucketMs_ = bucketWidthFor(maxOrderAgeMs_);
+        wheelCursor_ = currentTime / wheelBucketMs_;
+        wheelStarted_ = true;
+
+        std::vector<OrderNode*> nodes;
+        nodes.reserve(orderIndex_.size());
+        for (auto& [id, node] : orderIndex_) {
+            node->wheelPrev = nullptr;
+            node->wheelNext = nullptr;
+            node->wheelSlot = UNSCHEDULED;
+            nodes.push_back(node);
+        }
+
+        // Re-insert in arrival order so every slot stays sorted by expiry
+        std::sort(nodes.begin(), nodes.end(), [](const OrderNode* a, const OrderNode* b) {
+            if (a->order.timestamp != b->order.timestamp) return a->order.timestamp < b->order.timestamp;
+            return a->order.id < b->order.id;
+        });
+
+        size_t expired = 0;
+        for (OrderNode* node : nodes) {
+            if (node->order.timestamp > currentTime) {
+                removeNode(node->order.side == OrderSide::BUY ? bidLevels_ : askLevels_, node);
+                expired++;
+                continue;
+            }
+            scheduleExpiry(node, currentTime);
+        }
+        return expired;
+    }
+
+    void OrderBook::setMaxOrderAgeMs(Timestamp ms) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        maxOrderAgeMs_ = ms;
+        rebuildExpiryWheel(currentTs());
+    }
+
+    size_t OrderBook::expireOrders() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return expireOrdersUnlocked(currentTs());
+    }
+
+    // ----- Order management -----
+
     void OrderBook::addOrder(const Order& order) {
         std::lock_guard<std::mutex> lock(mutex_);
+        addOrderUnlocked(order);
+    }
 
-        Order orderCopy = order;
-        if (orderCopy.id == 0) {
-            orderCopy.id = nextOrderId_++;
+    void OrderBook::addOrderUnlocked(const Order& order) {
+        OrderNode* node = allocateNode(order);
+        if (node->order.id == 0) {
+            node->order.id = allocateOrderId();
         }
-        orderCopy.timestamp = currentTs();
+        node->order.timestamp = currentTs();
+        node->priceTicks = toTicks(node->order.price, node->order.side);
+        node->order.price = toPrice(node->priceTicks);
 
-        activeOrders_[orderCopy.id] = true;
+        scheduleExpiry(node, node->order.timestamp);
+        orderIndex_[node->order.id] = node;
 
-        if (orderCopy.side == OrderSide::BUY) {
-            bids_.push(orderCopy);
-            orderIdToBidPrice_[orderCopy.id] = orderCopy.price;
-            auto it = bestBidByPrice_.find(orderCopy.price);
-            if (it == bestBidByPrice_.end()) {
-                bestBidByPrice_[orderCopy.price] = orderCopy.id;
-            }
+        if (node->order.side == OrderSide::BUY) {
+            appendNode(bidLevels_, node);
+            ++bidOrderCount_;
         }
         else {
-            asks_.push(orderCopy);
-            orderIdToAskPrice_[orderCopy.id] = orderCopy.price;
-            auto it = bestAskByPrice_.find(orderCopy.price);
-            if (it == bestAskByPrice_.end()) {
-                bestAskByPrice_[orderCopy.price] = orderCopy.id;
-            }
+            appendNode(askLevels_, node);
+            ++askOrderCount_;
         }
     }
 
     bool OrderBook::cancelOrder(OrderId orderId) {
         std::lock_guard<std::mutex> lock(mutex_);
 
-        auto it = activeOrders_.find(orderId);
-        if (it != activeOrders_.end() && it->second) {
-            it->second = false;
-
-            auto bidPriceIt = orderIdToBidPrice_.find(orderId);
-            if (bidPriceIt != orderIdToBidPrice_.end()) {
-                Price price = bidPriceIt->second;
-                orderIdToBidPrice_.erase(bidPriceIt);
-                auto bestIt = bestBidByPrice_.find(price);
-                if (bestIt != bestBidByPrice_.end() && bestIt->second == orderId) {
-                    bestBidByPrice_.erase(bestIt);
-                }
-            }
+        auto it = orderIndex_.find(orderId);
+        if (it == orderIndex_.end()) return false;
 
-            auto askPriceIt = orderIdToAskPrice_.find(orderId);
-            if (askPriceIt != orderIdToAskPrice_.end()) {
-                Price price = askPriceIt->second;
-                orderIdToAskPrice_.erase(askPriceIt);
-                auto bestIt = bestAskByPrice_.find(price);
-                if (bestIt != bestAskByPrice_.end() && bestIt->second == orderId) {
-                    bestAskByPrice_.erase(bestIt);
-                }
-            }
+        OrderNode* node = it->second;
+        removeNode(node->order.side == OrderSide::BUY ? bidLevels_ : askLevels_, node);
+        return true;
+    }
+
+    bool OrderBook::cancelOrder(OrderId orderId, AgentId owner) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return cancelOwnedUnlocked(orderId, owner);
+    }
 
-            return true;
+    bool OrderBook::cancelOwnedUnlocked(OrderId orderId, AgentId owner) {
+        auto it = orderIndex_.find(orderId);
+        if (it == orderIndex_.end() || it->second->order.agentId != owner) return false;
+
+        OrderNode* node = it->second;
+        removeNode(node->order.side == OrderSide::BUY ? bidLevels_ : askLevels_, node);
+        return true;
+    }
+
+    size_t OrderBook::applyActions(ConstSpan<OrderAction> actions) {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        size_t cancelled = 0;
+        for (const OrderAction& action : actions) {
+            if (action.kind == OrderAction::Kind::CANCEL) {
+                if (cancelOwnedUnlocked(action.order.id, action.order.agentId)) cancelled++;
+            }
+            else {
+                addOrderUnlocked(action.order);
+            }
         }
-        return false;
+        return cancelled;
     }
 
     std::vector<Trade> OrderBook::matchOrders() {
@@ -78,67 +302,56 @@ namespace market {
 
         Timestamp currentTime = currentTs();
 
-        auto isExpired = [&](const Order& o) {
-            return (currentTime - o.timestamp) > maxOrderAgeMs_;
-        };
+        // Evict expired orders at every depth, not just the top of each side
+        expireOrdersUnlocked(currentTime);
 
-        // Remove cancelled and expired orders from top
-        while (!bids_.empty()) {
-            const Order& top = bids_.top();
-            if (!activeOrders_[top.id] || isExpired(top)) {
-                if (activeOrders_[top.id]) activeOrders_[top.id] = false;
-                bids_.pop();
-            } else {
-                break;
-            }
+        if (matchingMode_ == MatchingMode::AUCTION) {
+            matchAuctionUnlocked(trades, currentTime);
         }
-        while (!asks_.empty()) {
-            const Order& top = asks_.top();
-            if (!activeOrders_[top.id] || isExpired(top)) {
-                if (activeOrders_[top.id]) activeOrders_[top.id] = false;
-                asks_.pop();
-            } else {
-                break;
-            }
+        else {
+            matchContinuousUnlocked(trades, currentTime);
         }
+        return trades;
+    }
 
+    void OrderBook::matchContinuousUnlocked(std::vector<Trade>& trades, Timestamp currentTime) {
         // Match while bid >= ask
-        while (!bids_.empty() && !asks_.empty()) {
-            Order bid = bids_.top();
-            Order ask = asks_.top();
-
-            // Skip cancelled or expired orders
-            if (!activeOrders_[bid.id] || isExpired(bid)) {
-                activeOrders_[bid.id] = false;
-                bids_.pop();
+        while (!bidLevels_.empty() && !askLevels_.empty()) {
+            OrderNode* bidNode = bestBidNode();
+            OrderNode* askNode = bestAskNode();
+            Order& bid = bidNode->order;
+            Order& ask = askNode->order;
+
+            // Skip expired orders (the wheel may place a clamped order one bucket late)
+            if (isExpired(bidNode, currentTime)) {
+                removeNode(bidLevels_, bidNode);
                 continue;
             }
-            if (!activeOrders_[ask.id] || isExpired(ask)) {
-                activeOrders_[ask.id] = false;
-                asks_.pop();
+            if (isExpired(askNode, currentTime)) {
+                removeNode(askLevels_, askNode);
                 continue;
             }
 
             // Check if orders can be matched
-            if (bid.price < ask.price && bid.type == OrderType::LIMIT && ask.type == OrderType::LIMIT) {
+            if (bidNode->priceTicks < askNode->priceTicks && bid.type == OrderType::LIMIT && ask.type == OrderType::LIMIT) {
                 break; // No match possible
             }
 
             // Determine execution price (resting order price)
-            Price execPrice;
+            PriceTicks execTicks;
             if (bid.timestamp < ask.timestamp) {
-                execPrice = bid.price; // Bid was resting
+                execTicks = bidNode->priceTicks; // Bid was resting
             }
             else {
-                execPrice = ask.price; // Ask was resting
+                execTicks = askNode->priceTicks; // Ask was resting
             }
 
             // Handle market orders
             if (bid.type == OrderType::MARKET) {
-                execPrice = ask.price;
+                execTicks = askNode->priceTicks;
             }
             else if (ask.type == OrderType::MARKET) {
-                execPrice = bid.price;
+                execTicks = bidNode->priceTicks;
             }
 
             // Determine execution quantity
@@ -150,100 +363,219 @@ namespace market {
             trade.sellOrderId = ask.id;
             trade.buyerId = bid.agentId;
             trade.sellerId = ask.agentId;
-            trade.symbol = symbol_;
-            trade.price = execPrice;
+            trade.symbolId = symbolId_;
+            trade.priceTicks = execTicks;
+            trade.price = toPrice(execTicks);
             trade.quantity = execQty;
             trade.timestamp = currentTime;
             trades.push_back(trade);
 
-            // Update order quantities
-            bids_.pop();
-            asks_.pop();
-
-            // Clean up price indices for filled orders
-            bestBidByPrice_.erase(bid.price);
-            bestAskByPrice_.erase(ask.price);
-            orderIdToBidPrice_.erase(bid.id);
-            orderIdToAskPrice_.erase(ask.id);
-
-            if (bid.quantity > execQty) {
-                Order remainingBid = bid;
-                remainingBid.quantity -= execQty;
-                bids_.push(remainingBid);
-                orderIdToBidPrice_[remainingBid.id] = remainingBid.price;
-                bestBidByPrice_[remainingBid.price] = remainingBid.id;
-            }
-            else {
-                activeOrders_[bid.id] = false;
+            // Partially filled orders keep their place at the front of the level
+            fillNode(bidNode, execQty);
+            fillNode(askNode, execQty);
+            if (bid.quantity == 0) removeNode(bidLevels_, bidNode);
+            if (ask.quantity == 0) removeNode(askLevels_, askNode);
+        }
+    }
+
+    void OrderBook::matchAuctionUnlocked(std::vector<Trade>& trades, Timestamp currentTime) {
+        if (bidLevels_.empty() || askLevels_.empty()) return;
+
+        // MARKET orders accept any price, so they count towards demand/supply at
+        // every candidate price; LIMIT orders count where their price allows.
+        Volume bidLimitTotal = 0, bidMarketTotal = 0, askMarketTotal = 0;
+        for (const auto& [ticks, level] : bidLevels_) {
+            bidLimitTotal += level.totalQuantity - level.marketQuantity;
+            bidMarketTotal += level.marketQuantity;
+        }
+        for (const auto& [ticks, level] : askLevels_) {
+            askMarketTotal += level.marketQuantity;
+        }
+
+        // One ascending pass over every level price. The clearing price maximises
+        // executed volume, then minimises the leftover imbalance; remaining ties
+        // go to the side with pressure (highest price if all have excess demand,
+        // lowest if all have excess supply), else to the middle candidate.
+        Volume bestVolume = 0;
+        Volume bestImbalance = 0;
+        std::vector<std::pair<PriceTicks, Volume>> candidates;  // (price, demand - supply)
+
+        Volume bidLimitBelow = 0;   // Limit bids priced below p (excluded at p)
+        Volume askLimitUpTo = 0;    // Limit asks priced at or below p
+        auto bi = bidLevels_.begin();
+        auto ai = askLevels_.begin();
+        while (bi != bidLevels_.end() || ai != askLevels_.end()) {
+            PriceTicks p = (bi == bidLevels_.end()) ? ai->first
+                : (ai == askLevels_.end()) ? bi->first
+                : std::min(bi->first, ai->first);
+
+            for (; ai != askLevels_.end() && ai->first <= p; ++ai) {
+                askLimitUpTo += ai->second.totalQuantity - ai->second.marketQuantity;
             }
 
-            if (ask.quantity > execQty) {
-                Order remainingAsk = ask;
-                remainingAsk.quantity -= execQty;
-                asks_.push(remainingAsk);
-                orderIdToAskPrice_[remainingAsk.id] = remainingAsk.price;
-                bestAskByPrice_[remainingAsk.price] = remainingAsk.id;
+            Volume demand = bidLimitTotal - bidLimitBelow + bidMarketTotal;
+            Volume supply = askLimitUpTo + askMarketTotal;
+            Volume volume = std::min(demand, supply);
+            Volume imbalance = std::abs(demand - supply);
+            if (volume > 0) {
+                if (volume > bestVolume || (volume == bestVolume && imbalance < bestImbalance)) {
+                    bestVolume = volume;
+                    bestImbalance = imbalance;
+                    candidates.clear();
+                }
+                if (volume == bestVolume && imbalance == bestImbalance) {
+                    candidates.emplace_back(p, demand - supply);
+                }
             }
-            else {
-                activeOrders_[ask.id] = false;
+
+            for (; bi != bidLevels_.end() && bi->first <= p; ++bi) {
+                bidLimitBelow += bi->second.totalQuantity - bi->second.marketQuantity;
             }
         }
 
-        return trades;
-    }
+        if (bestVolume == 0) return;
+
+        bool allDemand = std::all_of(candidates.begin(), candidates.end(),
+            [](const auto& c) { return c.second > 0; });
+        bool allSupply = std::all_of(candidates.begin(), candidates.end(),
+            [](const auto& c) { return c.second < 0; });
+        PriceTicks clearing = allDemand ? candidates.back().first
+            : allSupply ? candidates.front().first
+            : candidates[(candidates.size() - 1) / 2].first;
+
+        // Allocate bestVolume on each side: MARKET orders first, then LIMIT orders
+        // in price-time priority. Only the marginal level is rationed.
+        struct Fill {
+            OrderNode* node;
+            Volume quantity;
+        };
+        auto allocate = [&](auto begin, auto end, auto priceOk, std::vector<Fill>& fills) {
+            Volume remaining = bestVolume;
+
+            for (auto it = begin; it != end && remaining > 0; ++it) {
+                if (it->second.marketQuantity == 0) continue;
+                for (OrderNode* n = it->second.head; n && remaining > 0; n = n->next) {
+                    if (n->order.type != OrderType::MARKET) continue;
+                    Volume qty = std::min(n->order.quantity, remaining);
+                    fills.push_back({ n, qty });
+                    remaining -= qty;
+                }
+            }
 
-    // ----- O(1) best price helpers using cached indices -----
+            for (auto it = begin; it != end && remaining > 0 && priceOk(it->first); ++it) {
+                const PriceLevel& level = it->second;
+                Volume limitQty = level.totalQuantity - level.marketQuantity;
+                if (limitQty == 0) continue;
+
+                if (limitQty <= remaining || allocation_ == Allocation::TIME_PRIORITY) {
+                    for (OrderNode* n = level.head; n && remaining > 0; n = n->next) {
+                        if (n->order.type == OrderType::MARKET) continue;
+                        Volume qty = std::min(n->order.quantity, remaining);
+                        fills.push_back({ n, qty });
+                        remaining -= qty;
+                    }
+                    continue;
+                }
 
-    Price OrderBook::getBestBidUnlocked() const {
-        // Try cached best bid first
-        while (!bestBidByPrice_.empty()) {
-            auto it = bestBidByPrice_.begin(); // highest price (std::greater)
-            OrderId id = it->second;
-            if (activeOrders_.count(id) && activeOrders_.at(id)) {
-                return it->first;
+                // Pro-rata on the marginal level; rounding leftovers go in time order
+                size_t first = fills.size();
+                Volume allotted = 0;
+                for (OrderNode* n = level.head; n; n = n->next) {
+                    if (n->order.type == OrderType::MARKET) continue;
+                    Volume qty = n->order.quantity * remaining / limitQty;
+                    fills.push_back({ n, qty });
+                    allotted += qty;
+                }
+                Volume leftover = remaining - allotted;
+                for (size_t i = first; i < fills.size() && leftover > 0; ++i) {
+                    if (fills[i].quantity < fills[i].node->order.quantity) {
+                        fills[i].quantity++;
+                        leftover--;
+                    }
+                }
+                remaining = 0;
             }
-            // Stale entry - remove and continue
-            const_cast<OrderBook*>(this)->bestBidByPrice_.erase(it);
-        }
-
-        // Fallback: scan queue for valid order
-        auto bidsCopy = bids_;
-        while (!bidsCopy.empty()) {
-            const Order& o = bidsCopy.top();
-            if (activeOrders_.count(o.id) && activeOrders_.at(o.id)) {
-                // Rebuild index
-                const_cast<OrderBook*>(this)->bestBidByPrice_[o.price] = o.id;
-                return o.price;
+        };
+
+        std::vector<Fill> buys;
+        std::vector<Fill> sells;
+        allocate(bidLevels_.rbegin(), bidLevels_.rend(),
+            [clearing](PriceTicks t) { return t >= clearing; }, buys);
+        allocate(askLevels_.begin(), askLevels_.end(),
+            [clearing](PriceTicks t) { return t <= clearing; }, sells);
+
+        // Pair the two fill lists into trades at the clearing price
+        Price clearingPrice = toPrice(clearing);
+        size_t b = 0, a = 0;
+        Volume buyPaired = 0, sellPaired = 0;  // Already traded from buys[b] / sells[a]
+        while (b < buys.size() && a < sells.size()) {
+            Volume execQty = std::min(buys[b].quantity - buyPaired, sells[a].quantity - sellPaired);
+            if (execQty > 0) {
+                const Order& bid = buys[b].node->order;
+                const Order& ask = sells[a].node->order;
+
+                Trade trade;
+                trade.buyOrderId = bid.id;
+                trade.sellOrderId = ask.id;
+                trade.buyerId = bid.agentId;
+                trade.sellerId = ask.agentId;
+                trade.symbolId = symbolId_;
+                trade.priceTicks = clearing;
+                trade.price = clearingPrice;
+                trade.quantity = execQty;
+                trade.timestamp = currentTime;
+                trades.push_back(trade);
+
+                buyPaired += execQty;
+                sellPaired += execQty;
             }
-            bidsCopy.pop();
+            if (buyPaired == buys[b].quantity) { ++b; buyPaired = 0; }
+            if (sellPaired == sells[a].quantity) { ++a; sellPaired = 0; }
         }
-        return 0.0;
+
+        // Apply fills last so level iterators stay valid while allocating
+        auto applyFills = [&](const std::vector<Fill>& fills, LevelMap& levels) {
+            for (const Fill& f : fills) {
+                if (f.quantity == 0) continue;
+                fillNode(f.node, f.quantity);
+                if (f.node->order.quantity == 0) removeNode(levels, f.node);
+            }
+        };
+        applyFills(buys, bidLevels_);
+        applyFills(sells, askLevels_);
+    }
+
+    void OrderBook::setMatchingMode(MatchingMode mode, Allocation allocation) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        matchingMode_ = mode;
+        allocation_ = allocation;
+    }
+
+    OrderBook::MatchingMode OrderBook::getMatchingMode() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return matchingMode_;
+    }
+
+    OrderBook::MatchingMode OrderBook::parseMatchingMode(const std::string& str) {
+        if (str == "auction" || str == "batch") return MatchingMode::AUCTION;
+        return MatchingMode::CONTINUOUS;
+    }
+
+    OrderBook::Allocation OrderBook::parseAllocation(const std::string& str) {
+        if (str == "proRata" || str == "pro_rata" || str == "prorata") return Allocation::PRO_RATA;
+        return Allocation::TIME_PRIORITY;
+    }
+
+    // ----- O(1) best price helpers -----
+
+    Price OrderBook::getBestBidUnlocked() const {
+        if (bidLevels_.empty()) return 0.0;
+        return toPrice(bidLevels_.rbegin()->first);
     }
 
     Price OrderBook::getBestAskUnlocked() const {
-        // Try cached best ask first
-        while (!bestAskByPrice_.empty()) {
-            auto it = bestAskByPrice_.begin(); // lowest price
-            OrderId id = it->second;
-            if (activeOrders_.count(id) && activeOrders_.at(id)) {
-                return it->first;
-            }
-            // Stale entry - remove and continue
-            const_cast<OrderBook*>(this)->bestAskByPrice_.erase(it);
-        }
-
-        // Fallback: scan queue for valid order
-        auto asksCopy = asks_;
-        while (!asksCopy.empty()) {
-            const Order& o = asksCopy.top();
-            if (activeOrders_.count(o.id) && activeOrders_.at(o.id)) {
-                // Rebuild index
-                const_cast<OrderBook*>(this)->bestAskByPrice_[o.price] = o.id;
-                return o.price;
-            }
-            asksCopy.pop();
-        }
-        return std::numeric_limits<double>::max();
+        if (askLevels_.empty()) return std::numeric_limits<double>::max();
+        return toPrice(askLevels_.begin()->first);
     }
 
     Price OrderBook::getSpreadUnlocked() const {
@@ -292,44 +624,33 @@ namespace market {
         return getMidPriceUnlocked();
     }
 
+    size_t OrderBook::getBidCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return bidOrderCount_;
+    }
+
+    size_t OrderBook::getAskCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return askOrderCount_;
+    }
+
     OrderBookSnapshot OrderBook::getSnapshot(int depth) const {
         std::lock_guard<std::mutex> lock(mutex_);
 
         OrderBookSnapshot snapshot;
         snapshot.symbol = symbol_;
 
-        // Aggregate bids
-        std::map<Price, Volume, std::greater<Price>> bidLevels;
-        auto bidsCopy = bids_;
-        while (!bidsCopy.empty()) {
-            const Order& o = bidsCopy.top();
-            if (activeOrders_.count(o.id) && activeOrders_.at(o.id)) {
-                bidLevels[o.price] += o.quantity;
-            }
-            bidsCopy.pop();
-        }
-
-        int count = 0;
-        for (const auto& [price, qty] : bidLevels) {
-            if (count++ >= depth) break;
-            snapshot.bids.push_back({ price, qty, 1 });
-        }
+        // Level aggregates are maintained incrementally — only the top `depth` levels are read
+        size_t maxLevels = depth > 0 ? static_cast<size_t>(depth) : 0;
+        snapshot.bids.reserve(std::min(maxLevels, bidLevels_.size()));
+        snapshot.asks.reserve(std::min(maxLevels, askLevels_.size()));
 
-        // Aggregate asks
-        std::map<Price, Volume> askLevels;
-        auto asksCopy = asks_;
-        while (!asksCopy.empty()) {
-            const Order& o = asksCopy.top();
-            if (activeOrders_.count(o.id) && activeOrders_.at(o.id)) {
-                askLevels[o.price] += o.quantity;
-            }
-            asksCopy.pop();
+        for (auto it = bidLevels_.rbegin(); it != bidLevels_.rend() && snapshot.bids.size() < maxLevels; ++it) {
+            snapshot.bids.push_back({ toPrice(it->first), it->second.totalQuantity, it->second.orderCount });
         }
 
-        count = 0;
-        for (const auto& [price, qty] : askLevels) {
-            if (count++ >= depth) break;
-            snapshot.asks.push_back({ price, qty, 1 });
+        for (auto it = askLevels_.begin(); it != askLevels_.end() && snapshot.asks.size() < maxLevels; ++it) {
+            snapshot.asks.push_back({ toPrice(it->first), it->second.totalQuantity, it->second.orderCount });
         }
 
         snapshot.bestBid = getBestBidUnlocked();
@@ -340,16 +661,83 @@ namespace market {
         return snapshot;
     }
 
+    void OrderBook::writeCheckpoint(CheckpointWriter& out) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        out.write(static_cast<uint64_t>(orderIndex_.size()));
+        for (const LevelMap* levels : { &bidLevels_, &askLevels_ }) {
+            for (const auto& [ticks, level] : *levels) {
+                for (const OrderNode* node = level.head; node; node = node->next) {
+                    out.write(node->order);
+                    out.write(node->priceTicks);
+                }
+            }
+        }
+    }
+
+    void OrderBook::readCheckpoint(CheckpointReader& in) {
+        clear();
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        size_t count = in.readCount(sizeof(PriceTicks));
+        for (size_t i = 0; i < count; ++i) {
+            Order order;
+            in.read(order);
+            PriceTicks ticks = in.read<PriceTicks>();
+            // Appended in saved order, which is each level's FIFO order
+            if (!appendRestored(order, ticks)) {
+                throw std::runtime_error("Invalid checkpoint: duplicate order id in " + symbol_);
+            }
+        }
+
+        // Buckets every order by its original timestamp
+        rebuildExpiryWheel(currentTs());
+    }
+
+    void OrderBook::copyOrdersFrom(const OrderBook& source) {
+        if (&source == this) return;
+        clear();
+        std::scoped_lock lock(mutex_, source.mutex_);
+
+        for (const LevelMap* levels : { &source.bidLevels_, &source.askLevels_ }) {
+            for (const auto& [ticks, level] : *levels) {
+                for (const OrderNode* node = level.head; node; node = node->next) {
+                    appendRestored(node->order, node->priceTicks);
+                }
+            }
+        }
+        rebuildExpiryWheel(currentTs());
+    }
+
+    bool OrderBook::appendRestored(const Order& order, PriceTicks ticks) {
+        if (orderIndex_.count(order.id)) return false;
+
+        OrderNode* node = allocateNode(order);
+        node->priceTicks = ticks;
+        orderIndex_[order.id] = node;
+        if (order.side == OrderSide::BUY) {
+            appendNode(bidLevels_, node);
+            ++bidOrderCount_;
+        }
+        else {
+            appendNode(askLevels_, node);
+            ++askOrderCount_;
+        }
+        return true;
+    }
+
     void OrderBook::clear() {
         std::lock_guard<std::mutex> lock(mutex_);
 
-        while (!bids_.empty()) bids_.pop();
-        while (!asks_.empty()) asks_.pop();
-        activeOrders_.clear();
-        bestBidByPrice_.clear();
-        bestAskByPrice_.clear();
-        orderIdToBidPrice_.clear();
-        orderIdToAskPrice_.clear();
+        bidLevels_.clear();
+        askLevels_.clear();
+        orderIndex_.clear();
+        bidOrderCount_ = 0;
+        askOrderCount_ = 0;
+        nodePool_.clear();
+        freeNodes_.clear();
+        std::fill(wheel_.begin(), wheel_.end(), WheelSlot{});
+        wheelStarted_ = false;
     }
 
 } // namespace market
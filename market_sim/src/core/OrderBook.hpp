@@ -2,27 +2,61 @@
 
 #include "Types.hpp"
 #include "SimClock.hpp"
+#include "Checkpoint.hpp"
 #include <map>
 #include <vector>
-#include <queue>
+#include <deque>
+#include <unordered_map>
 #include <mutex>
-#include <functional>
+#include <atomic>
+#include <limits>
 
 namespace market {
 
+    // Source of order ids for a set of books; MarketEngine shares one across
+    // its books so ids are unique per engine. Safe to call from any thread.
+    class OrderIdSequence {
+    public:
+        OrderId next() { return next_.fetch_add(1, std::memory_order_relaxed); }
+
+        // Id the next call to next() returns; restart() is for checkpoint restore
+        OrderId peek() const { return next_.load(std::memory_order_relaxed); }
+        void restart(OrderId next) { next_.store(next, std::memory_order_relaxed); }
+
+    private:
+        std::atomic<OrderId> next_{ 1 };
+    };
+
     class OrderBook {
     public:
-        explicit OrderBook(const std::string& symbol);
+        // CONTINUOUS crosses the best bid and ask one pair at a time. AUCTION treats
+        // each matchOrders() call as a call market: the whole crossed book clears
+        // at one uniform price.
+        enum class MatchingMode { CONTINUOUS, AUCTION };
+
+        // How an auction rations the marginal price level on the long side
+        enum class Allocation { TIME_PRIORITY, PRO_RATA };
+
+        explicit OrderBook(const std::string& symbol, Price tickSize = 0.01,
+            SymbolId symbolId = INVALID_SYMBOL_ID);
 
         // Order management
         void addOrder(const Order& order);
         bool cancelOrder(OrderId orderId);
+        // Only cancels a resting order that belongs to `owner`
+        bool cancelOrder(OrderId orderId, AgentId owner);
+
+        // Applies actions in order under one lock. A CANCEL only removes an order
+        // owned by the action's order.agentId; returns the number of orders removed.
+        size_t applyActions(ConstSpan<OrderAction> actions);
 
         // Match orders and return executed trades
         std::vector<Trade> matchOrders();
 
         // Getters
         const std::string& getSymbol() const { return symbol_; }
+        SymbolId getSymbolId() const { return symbolId_; }
+        Price getTickSize() const { return tickSize_; }
         Price getBestBid() const;
         Price getBestAsk() const;
         Price getSpread() const;
@@ -34,53 +68,131 @@ namespace market {
         // Clear all orders
         void clear();
 
-        // Statistics
-        size_t getBidCount() const { return bids_.size(); }
-        size_t getAskCount() const { return asks_.size(); }
+        // Resting orders, each level in time priority. Loading replaces the
+        // book's orders and keeps their ids and timestamps, so the SimClock the
+        // book is attached to must already be at the checkpoint's time.
+        void writeCheckpoint(CheckpointWriter& out) const;
+        void readCheckpoint(CheckpointReader& in);
+
+        // Replaces this book's orders with copies of `source`'s, the same way
+        // readCheckpoint() does, for a forked engine
+        void copyOrdersFrom(const OrderBook& source);
+
+        // Statistics (resting orders only — cancelled/filled orders are removed eagerly)
+        size_t getBidCount() const;
+        size_t getAskCount() const;
 
         // SimClock integration — set this so timestamps use sim time
         void setSimClock(const SimClock* clock) { simClock_ = clock; }
 
-        // Configurable order expiry (milliseconds of sim time)
-        void setMaxOrderAgeMs(Timestamp ms) { maxOrderAgeMs_ = ms; }
+        // Matching mode (continuous by default)
+        void setMatchingMode(MatchingMode mode, Allocation allocation = Allocation::TIME_PRIORITY);
+        MatchingMode getMatchingMode() const;
+
+        static MatchingMode parseMatchingMode(const std::string& str);
+        static Allocation parseAllocation(const std::string& str);
+
+        // Configurable order expiry (milliseconds of sim time). Re-buckets every
+        // resting order, so it is O(n) — meant for config changes, not per tick.
+        void setMaxOrderAgeMs(Timestamp ms);
+
+        // Evict every resting order older than the max age, at any depth. Called at
+        // the start of matchOrders(); cost is proportional to the orders evicted.
+        size_t expireOrders();
+
+        // Ids for orders added with id 0 come from `ids` (the book's own
+        // sequence when null); `ids` must outlive the book
+        void setOrderIdSequence(OrderIdSequence* ids) { ids_ = ids ? ids : &ownIds_; }
+
+        // Allocate an order id without touching the book (safe from any thread)
+        OrderId allocateOrderId() { return ids_->next(); }
+
+        // Tick conversion. Bids round down and asks round up so a limit is never
+        // loosened; prices within 1e-6 ticks of a boundary snap to it.
+        PriceTicks toTicks(Price price, OrderSide side) const;
+        Price toPrice(PriceTicks ticks) const;
 
     private:
         std::string symbol_;
-
-        // Bid queue: sorted by price (descending), then by time (ascending)
-        struct BidComparator {
-            bool operator()(const Order& a, const Order& b) const {
-                if (a.price != b.price) return a.price < b.price; // Higher price has priority
-                return a.timestamp > b.timestamp; // Earlier time has priority
-            }
+        SymbolId symbolId_;
+        Price tickSize_;
+        // For decimal tick sizes (0.01, 0.25, ...) conversions divide by the integer
+        // ticks-per-unit so that e.g. 10500 ticks maps back to exactly 105.0
+        double ticksPerUnit_ = 0.0;
+
+        // Each price level holds an intrusive FIFO of resting orders (time priority).
+        // Levels live in ordered maps keyed by integer ticks, so the best bid is the
+        // last key and the best ask is the first; the maps are touched per level, not
+        // per order, and nearly-equal double prices can no longer split a level.
+        struct OrderNode;
+
+        static constexpr size_t WHEEL_SLOTS = 256;          // Expiry wheel size (see wheel_)
+        static constexpr size_t UNSCHEDULED = WHEEL_SLOTS;  // wheelSlot of a node not in the wheel
+
+        // totalQuantity/orderCount are maintained on every add, fill and cancel so a
+        // depth-N snapshot is an O(N) read
+        struct PriceLevel {
+            OrderNode* head = nullptr;
+            OrderNode* tail = nullptr;
+            Volume totalQuantity = 0;
+            Volume marketQuantity = 0;  // Part of totalQuantity on MARKET orders
+            int orderCount = 0;
         };
 
-        // Ask queue: sorted by price (ascending), then by time (ascending)
-        struct AskComparator {
-            bool operator()(const Order& a, const Order& b) const {
-                if (a.price != b.price) return a.price > b.price; // Lower price has priority
-                return a.timestamp > b.timestamp; // Earlier time has priority
-            }
+        using LevelMap = std::map<PriceTicks, PriceLevel>;
+
+        struct OrderNode {
+            Order order;
+            PriceTicks priceTicks = 0;
+            OrderNode* prev = nullptr;
+            OrderNode* next = nullptr;
+            LevelMap::iterator level;
+
+            // Expiry wheel membership
+            Timestamp expiresAt = 0;
+            OrderNode* wheelPrev = nullptr;
+            OrderNode* wheelNext = nullptr;
+            size_t wheelSlot = UNSCHEDULED;
         };
 
-        std::priority_queue<Order, std::vector<Order>, BidComparator> bids_;
-        std::priority_queue<Order, std::vector<Order>, AskComparator> asks_;
+        LevelMap bidLevels_;  // best bid = rbegin()
+        LevelMap askLevels_;  // best ask = begin()
+
+        // OrderId -> node, gives O(1) cancel without touching the level maps
+        std::unordered_map<OrderId, OrderNode*> orderIndex_;
+
+        size_t bidOrderCount_ = 0;
+        size_t askOrderCount_ = 0;
+
+        // Node pool: std::deque keeps node addresses stable, freed nodes are recycled
+        std::deque<OrderNode> nodePool_;
+        std::vector<OrderNode*> freeNodes_;
+
+        // Expiry timing wheel. Each slot is an intrusive list of the orders whose
+        // expiry falls in one sim-time bucket; slots are reused every rotation.
+        // Bucket width is chosen so one rotation spans more than the max order
+        // age, so a single level is enough: a slot never holds orders from two
+        // rotations, and a swept bucket is evicted wholesale. Orders within a slot
+        // are in arrival order, which (sim time being monotonic) is expiry order.
+        struct WheelSlot {
+            OrderNode* head = nullptr;
+            OrderNode* tail = nullptr;
+        };
 
-        // Map for O(1) order lookup for cancellation
-        std::map<OrderId, bool> activeOrders_;
+        std::vector<WheelSlot> wheel_;
+        Timestamp wheelBucketMs_ = 1;
+        Timestamp wheelCursor_ = 0;   // Lowest bucket that may still hold orders
+        bool wheelStarted_ = false;   // Cursor is set on the first add
 
-        // O(1) best price tracking: price -> best order at that price
-        // Uses lazy deletion: entry is valid if orderId exists in activeOrders_ and is true
-        std::map<Price, OrderId, std::greater<Price>> bestBidByPrice_;  // descending by price
-        std::map<Price, OrderId> bestAskByPrice_;                        // ascending by price
-        std::map<OrderId, Price> orderIdToBidPrice_;  // orderId -> price for removal
-        std::map<OrderId, Price> orderIdToAskPrice_;
+        MatchingMode matchingMode_ = MatchingMode::CONTINUOUS;
+        Allocation allocation_ = Allocation::TIME_PRIORITY;
 
         // Thread safety
         mutable std::mutex mutex_;
 
         // Order ID generator
-        static OrderId nextOrderId_;
+        OrderIdSequence ownIds_;
+        OrderIdSequence* ids_ = &ownIds_;
 
         // Max order age before expiry (sim-time milliseconds)
         Timestamp maxOrderAgeMs_ = 172800000;  // 2 simulated days in ms
@@ -91,8 +203,41 @@ namespace market {
         // Get current timestamp (sim time if available, else wall-clock)
         Timestamp currentTs() const { return simClock_ ? simClock_->currentTimestamp() : now(); }
 
-        // Helper to process market orders
-        std::vector<Trade> processMarketOrder(Order& order);
+        // Node / level maintenance (must be called with mutex_ already held)
+        void addOrderUnlocked(const Order& order);
+        bool cancelOwnedUnlocked(OrderId orderId, AgentId owner);
+        OrderNode* allocateNode(const Order& order);
+        void releaseNode(OrderNode* node);
+        void appendNode(LevelMap& levels, OrderNode* node);
+        // Appends a restored order at its level's tail; false on a duplicate id
+        bool appendRestored(const Order& order, PriceTicks ticks);
+        void removeNode(LevelMap& levels, OrderNode* node);
+        void fillNode(OrderNode* node, Volume qty);
+        OrderNode* bestBidNode() const;
+        OrderNode* bestAskNode() const;
+
+        // Matching passes (must be called with mutex_ already held)
+        void matchContinuousUnlocked(std::vector<Trade>& trades, Timestamp currentTime);
+        void matchAuctionUnlocked(std::vector<Trade>& trades, Timestamp currentTime);
+
+        // Expiry wheel maintenance (must be called with mutex_ already held)
+        void scheduleExpiry(OrderNode* node, Timestamp currentTime);
+        void unscheduleExpiry(OrderNode* node);
+        size_t expireOrdersUnlocked(Timestamp currentTime);
+        size_t rebuildExpiryWheel(Timestamp currentTime);
+
+        // Same rule as the old age check: (now - timestamp) > maxAge in unsigned
+        // arithmetic, so an order stamped after `now` (clock rewound) is expired too
+        bool isExpired(const OrderNode* node, Timestamp currentTime) const {
+            return node->order.timestamp > currentTime || node->expiresAt < currentTime;
+        }
+        Timestamp expiryFor(Timestamp ts) const {
+            Timestamp maxTs = std::numeric_limits<Timestamp>::max();
+            return ts > maxTs - maxOrderAgeMs_ ? maxTs : ts + maxOrderAgeMs_;
+        }
+        static Timestamp bucketWidthFor(Timestamp maxAgeMs) {
+            return maxAgeMs / (WHEEL_SLOTS - 2) + 1;
+        }
 
         // Lock-free helpers (must be called with mutex_ already held)
         Price getBestBidUnlocked() const;
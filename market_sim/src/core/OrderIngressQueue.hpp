@@ -0,0 +1,133 @@
+#pragma once
+
+#include "Types.hpp"
+#include <atomic>
+#include <future>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace market {
+
+    // Result of an externally submitted order after the tick that matched it
+    struct OrderAck {
+        std::string status;         // "filled", "partial", "pending", "cancelled" or "rejected"
+        Volume filledQuantity = 0;
+        Price avgFillPrice = 0.0;
+        std::string reason;         // Set when rejected
+    };
+
+    // Owner id of the orders a client submits as `userId`: an FNV-1a hash in
+    // the top half of the AgentId space, which agents never use. The book's
+    // owner check then keeps one user from cancelling another's orders. The
+    // id is not authenticated, since anyone may send any userId, and every
+    // order sent without one shares the same owner.
+    inline AgentId userOwnerId(std::string_view userId) {
+        uint64_t hash = 14695981039346656037ull;
+        for (char c : userId) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ull;
+        }
+        return hash | (uint64_t(1) << 63);
+    }
+
+    // An order submitted from outside the engine thread (e.g. POST /orders).
+    // The symbol is resolved by the engine when the queue is drained. With
+    // cancelId set it cancels that resting user order instead of adding one,
+    // if order.agentId (the caller's userOwnerId) placed it.
+    struct IngressOrder {
+        Order order{};
+        std::string symbol;
+        OrderId cancelId = 0;
+        std::shared_ptr<std::promise<OrderAck>> ack;  // null if the caller does not wait
+    };
+
+    // Multi-producer / single-consumer intrusive queue (Vyukov). Producers never
+    // block each other or the consumer: push is one atomic exchange plus one
+    // store. Only MarketEngine drains it, from inside the tick.
+    class OrderIngressQueue {
+    public:
+        OrderIngressQueue() {
+            Node* stub = new Node();
+            head_.store(stub, std::memory_order_relaxed);
+            tail_ = stub;
+        }
+
+        ~OrderIngressQueue() {
+            IngressOrder discard;
+            while (pop(discard)) {}
+            delete tail_;
+        }
+
+        OrderIngressQueue(const OrderIngressQueue&) = delete;
+        OrderIngressQueue& operator=(const OrderIngressQueue&) = delete;
+
+        // Safe from any thread
+        void push(IngressOrder item) {
+            Node* node = new Node();
+            node->item = std::move(item);
+            Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+            prev->next.store(node, std::memory_order_release);
+            size_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Safe from any thread. The items are linked privately and published
+        // with a single exchange, so one drain sees all of them, in order,
+        // with no other producer's items in between.
+        void pushBatch(std::vector<IngressOrder> items) {
+            if (items.empty()) return;
+            Node* first = new Node();
+            first->item = std::move(items[0]);
+            Node* last = first;
+            for (size_t i = 1; i < items.size(); ++i) {
+                Node* node = new Node();
+                node->item = std::move(items[i]);
+                last->next.store(node, std::memory_order_relaxed);
+                last = node;
+            }
+            Node* prev = head_.exchange(last, std::memory_order_acq_rel);
+            prev->next.store(first, std::memory_order_release);
+            size_.fetch_add(items.size(), std::memory_order_relaxed);
+        }
+
+        // Consumer only. Returns false when empty (or when a producer is midway
+        // through a push — that item is picked up on the next drain).
+        bool pop(IngressOrder& out) {
+            Node* tail = tail_;
+            Node* next = tail->next.load(std::memory_order_acquire);
+            if (!next) return false;
+
+            out = std::move(next->item);
+            tail_ = next;
+            delete tail;
+            size_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        // Consumer only. Calls fn(IngressOrder&) for each queued item.
+        template <typename Fn>
+        size_t drain(Fn&& fn) {
+            size_t count = 0;
+            IngressOrder item;
+            while (pop(item)) {
+                fn(item);
+                count++;
+            }
+            return count;
+        }
+
+        size_t approxSize() const { return size_.load(std::memory_order_relaxed); }
+
+    private:
+        struct Node {
+            std::atomic<Node*> next{ nullptr };
+            IngressOrder item;
+        };
+
+        std::atomic<Node*> head_;   // Producers append here
+        Node* tail_;                // Consumer-owned dummy node
+        std::atomic<size_t> size_{ 0 };
+    };
+
+} // namespace market
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "Types.hpp"
+#include "Checkpoint.hpp"
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace market {
+
+    // Rolling indicators over a commodity's price window, kept in step with
+    // Commodity::priceHistory_ so every query is O(1) whatever the period.
+    // Prefix sums are taken relative to a reference price and rebuilt once the
+    // dead prefix reaches the window size, which keeps them small (and the
+    // variance free of cancellation) at O(1) amortised cost per append.
+    class PriceIndicators {
+    public:
+        static constexpr std::array<int, 4> EMA_SPANS = { 5, 10, 20, 50 };
+
+        void clear() {
+            prices_.clear();
+            sum_.assign(1, 0.0);
+            sumSq_.assign(1, 0.0);
+            retSq_.clear();
+            head_ = 0;
+            emaCount_ = 0;
+        }
+
+        void append(Price price) {
+            if (sum_.empty()) clear();
+            if (prices_.size() == head_) reference_ = price;
+
+            double d = price - reference_;
+            double r = 0.0;
+            if (prices_.size() > head_ && prices_.back() > 0) {
+                r = (price - prices_.back()) / prices_.back();
+            }
+            prices_.push_back(price);
+            sum_.push_back(sum_.back() + d);
+            sumSq_.push_back(sumSq_.back() + d * d);
+            retSq_.push_back((retSq_.empty() ? 0.0 : retSq_.back()) + r * r);
+
+            for (size_t i = 0; i < EMA_SPANS.size(); ++i) {
+                double alpha = 2.0 / (EMA_SPANS[i] + 1.0);
+                ema_[i] = emaCount_ == 0 ? price : alpha * price + (1.0 - alpha) * ema_[i];
+            }
+            emaCount_++;
+        }
+
+        // Drops the oldest price from the window
+        void popFront() {
+            if (head_ >= prices_.size()) return;
+            head_++;
+            if (head_ >= size() && head_ >= MIN_REBASE) rebase();
+        }
+
+        size_t size() const { return prices_.size() - head_; }
+
+        // Mean of the last `period` prices; 0 when the window is shorter
+        double sma(size_t period) const {
+            if (period == 0 || period > size()) return 0.0;
+            return reference_ + rangeSum(sum_, period) / period;
+        }
+
+        // Population standard deviation of the last `period` prices
+        double stddev(size_t period) const {
+            if (period == 0 || period > size()) return 0.0;
+            double mean = rangeSum(sum_, period) / period;
+            double var = rangeSum(sumSq_, period) / period - mean * mean;
+            return var > 0.0 ? std::sqrt(var) : 0.0;
+        }
+
+        // Sum of squared one-step returns between the last `period` prices
+        double sumSquaredReturns(size_t period) const {
+            if (period < 2 || period > size()) return 0.0;
+            size_t end = prices_.size() - 1;
+            return retSq_[end] - retSq_[end - (period - 1)];
+        }
+
+        // EMA over EMA_SPANS[spanIndex], seeded with the first price
+        double ema(size_t spanIndex) const { return spanIndex < ema_.size() ? ema_[spanIndex] : 0.0; }
+
+        // The prefix arrays go out as they are, so a restored window answers
+        // every query with the same bits as the one that was saved
+        void writeCheckpoint(CheckpointWriter& out) const {
+            out.writeArray(prices_);
+            out.writeArray(sum_);
+            out.writeArray(sumSq_);
+            out.writeArray(retSq_);
+            out.write(static_cast<uint64_t>(head_));
+            out.write(reference_);
+            for (double v : ema_) out.write(v);
+            out.write(static_cast<uint64_t>(emaCount_));
+        }
+
+        void readCheckpoint(CheckpointReader& in) {
+            in.readArray(prices_);
+            in.readArray(sum_);
+            in.readArray(sumSq_);
+            in.readArray(retSq_);
+            head_ = static_cast<size_t>(in.read<uint64_t>());
+            in.read(reference_);
+            for (double& v : ema_) in.read(v);
+            emaCount_ = static_cast<size_t>(in.read<uint64_t>());
+
+            size_t n = prices_.size();
+            if (head_ > n || sum_.size() != n + 1 || sumSq_.size() != n + 1 || retSq_.size() != n) {
+                throw std::runtime_error("Invalid checkpoint: inconsistent price indicators");
+            }
+        }
+
+    private:
+        static constexpr size_t MIN_REBASE = 64;
+
+        std::vector<Price> prices_;     // [head_, end) is the live window
+        std::vector<double> sum_;       // sum_[i] = sum of (p - reference_) over prices_[0, i)
+        std::vector<double> sumSq_;     // Same for (p - reference_)^2
+        std::vector<double> retSq_;     // retSq_[i] = sum of squared returns ending at or before i
+        size_t head_ = 0;
+        Price reference_ = 0.0;
+
+        std::array<double, EMA_SPANS.size()> ema_{};
+        size_t emaCount_ = 0;
+
+        // Sum over the last `period` entries of a prefix array
+        double rangeSum(const std::vector<double>& prefix, size_t period) const {
+            return prefix[prices_.size()] - prefix[prices_.size() - period];
+        }
+
+        void rebase() {
+            std::vector<Price> window(prices_.begin() + head_, prices_.end());
+            auto ema = ema_;
+            size_t emaCount = emaCount_;
+            clear();
+            for (Price p : window) append(p);
+            ema_ = ema;
+            emaCount_ = emaCount;
+        }
+    };
+
+} // namespace market
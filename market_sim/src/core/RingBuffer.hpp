@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Types.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace market {
+
+    // Fixed-capacity FIFO that keeps only the newest `capacity` elements and
+    // still hands out one contiguous span, oldest first. Once full, every
+    // element is written twice, at slot i and its mirror i + capacity, so the
+    // live elements always occupy [start, start + size) of the doubled array
+    // and push_back is O(1) with nothing ever shifted. Storage grows with use
+    // and is only doubled when the buffer first wraps.
+    template <typename T>
+    class RingBuffer {
+    public:
+        explicit RingBuffer(size_t capacity = 1) { setCapacity(capacity); }
+
+        // Keeps the newest min(size, capacity) elements
+        void setCapacity(size_t capacity) {
+            capacity = std::max<size_t>(capacity, 1);
+            if (capacity == capacity_) return;
+
+            ConstSpan<T> live = view();
+            size_t keep = std::min(live.size(), capacity);
+            std::vector<T> kept(live.end() - keep, live.end());
+
+            capacity_ = capacity;
+            clear();
+            for (const T& value : kept) push_back(value);
+        }
+
+        void push_back(const T& value) {
+            if (slots_.size() < capacity_) {
+                // Still filling for the first time: [0, size) is the whole buffer
+                slots_.push_back(value);
+                size_++;
+                next_ = size_ == capacity_ ? 0 : size_;
+                return;
+            }
+            if (slots_.size() == capacity_) {
+                slots_.resize(2 * capacity_);
+                std::copy(slots_.begin(), slots_.begin() + capacity_, slots_.begin() + capacity_);
+            }
+            slots_[next_] = value;
+            slots_[next_ + capacity_] = value;
+            next_ = next_ + 1 == capacity_ ? 0 : next_ + 1;
+            if (size_ < capacity_) size_++;
+        }
+
+        void clear() {
+            slots_.clear();
+            next_ = 0;
+            size_ = 0;
+        }
+
+        size_t size() const { return size_; }
+        size_t capacity() const { return capacity_; }
+        bool empty() const { return size_ == 0; }
+        bool full() const { return size_ == capacity_; }
+
+        // Valid until the next push_back, setCapacity or clear
+        ConstSpan<T> view() const {
+            if (slots_.empty()) return {};
+            return ConstSpan<T>(slots_.data() + start(), size_);
+        }
+
+        const T* begin() const { return slots_.data() + start(); }
+        const T* end() const { return begin() + size_; }
+        const T& operator[](size_t i) const { return slots_[start() + i]; }
+        const T& front() const { return (*this)[0]; }
+        const T& back() const { return (*this)[size_ - 1]; }
+
+    private:
+        std::vector<T> slots_;
+        size_t capacity_ = 0;
+        size_t next_ = 0;  // Slot the next push writes
+        size_t size_ = 0;
+
+        size_t start() const { return next_ >= size_ ? next_ - size_ : next_ + capacity_ - size_; }
+    };
+
+} // namespace market
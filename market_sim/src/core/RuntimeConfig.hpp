@@ -8,6 +8,9 @@ namespace market {
 
     struct RuntimeConfig {
 
+        // Set by ConfigStore when this config is published; not in the JSON
+        uint64_t version = 0;
+
         struct SimulationParams {
             int    tickRateMs = 50;
             int    maxTicks = 0;
@@ -16,6 +19,10 @@ namespace market {
             int    populateFineTicksPerDay = 1440;
             int    populateFineDays = 7;
             std::string startDate = "2025-01-01";
+            int    tradeLogCapacity = 100000;   // Recent trades kept for GET /trades
+            std::string tickPolicy = "catchUp";  // Real-time loop behind schedule: "catchUp", "skip" or "stretch"
+            int    maxCatchUpTicks = 10;        // Longest catch-up burst before missed ticks are dropped; 0 = no cap
+            std::string agentLayout = "objects"; // "columns": agents' cash, positions and sentiment in engine-owned columns
         } simulation;
 
         struct CommodityParams {
@@ -24,10 +31,14 @@ namespace market {
             double priceFloor = 0.01;
             double supplyDecayRate = 0.1;
             double demandDecayRate = 0.1;
+            int    historyDepth = 1000;    // Prices kept per commodity; commodities.json may override per symbol
         } commodity;
 
         struct OrderBookParams {
             uint64_t orderExpiryMs = 172800000;
+            int      matchingThreads = 1;   // 1 = serial, 0 = one per hardware thread
+            std::string matchingMode = "continuous";   // "continuous" or "auction" (uniform-price call per tick)
+            std::string auctionAllocation = "time";    // Marginal level in an auction: "time" or "proRata"
         } orderBook;
 
         struct AgentCounts {
@@ -53,6 +64,7 @@ namespace market {
             double sentimentDecayGlobal = 0.95;
             double sentimentDecayCommodity = 0.90;
             int    maxShortPosition = 20;
+            int    decisionThreads = 1;   // Agent decide() phase: 1 = serial, 0 = one per hardware thread
         } agentGlobal;
 
         struct AgentGeneration {
@@ -161,6 +173,32 @@ namespace market {
             double demandImpactStd = 0.04;
         } news;
 
+        struct CandleParams {
+            // Completed candles kept per symbol, by interval
+            int    retention1m = 10000;
+            int    retention5m = 10000;
+            int    retention15m = 10000;
+            int    retention30m = 10000;
+            int    retention1h = 10000;
+            int    retention1d = 10000;
+        } candles;
+
+        struct HttpParams {
+            // Read when the API server starts. Every connection holds a worker
+            // thread, streams for as long as they last, so the stream, feed and
+            // bulk limits together should stay well under `threads`; what is
+            // left over is always there for orders and control.
+            int    threads = 64;
+            int    streamClients = 16;          // Concurrent /stream connections
+            int    feedClients = 16;            // Concurrent /feed connections
+            int    bulkConcurrency = 8;         // Bulk reads (trades, candles, ticks, news history) in flight
+            int    maxQueuedConnections = 32;   // Backlog beyond which reads are shed with 503
+            int    retryAfterSec = 1;
+            int    readTimeoutSec = 300;
+            int    writeTimeoutSec = 300;
+            int    keepAliveSec = 10;
+        } http;
+
         nlohmann::json toJson() const {
             nlohmann::json j;
 
@@ -171,7 +209,11 @@ namespace market {
                 {"populateTicksPerDay", simulation.populateTicksPerDay},
                 {"populateFineTicksPerDay", simulation.populateFineTicksPerDay},
                 {"populateFineDays", simulation.populateFineDays},
-                {"startDate", simulation.startDate}
+                {"startDate", simulation.startDate},
+                {"tradeLogCapacity", simulation.tradeLogCapacity},
+                {"tickPolicy", simulation.tickPolicy},
+                {"maxCatchUpTicks", simulation.maxCatchUpTicks},
+                {"agentLayout", simulation.agentLayout}
             };
 
             j["commodity"] = {
@@ -179,7 +221,15 @@ namespace market {
                 {"impactDampening", commodity.impactDampening},
                 {"priceFloor", commodity.priceFloor},
                 {"supplyDecayRate", commodity.supplyDecayRate},
-                {"demandDecayRate", commodity.demandDecayRate}
+                {"demandDecayRate", commodity.demandDecayRate},
+                {"historyDepth", commodity.historyDepth}
+            };
+
+            j["orderBook"] = {
+                {"orderExpiryMs", orderBook.orderExpiryMs},
+                {"matchingThreads", orderBook.matchingThreads},
+                {"matchingMode", orderBook.matchingMode},
+                {"auctionAllocation", orderBook.auctionAllocation}
             };
 
             j["agentCounts"] = {
@@ -241,6 +291,27 @@ namespace market {
                 {"demandImpactStd", news.demandImpactStd}
             };
 
+            j["candles"] = {
+                {"retention1m", candles.retention1m},
+                {"retention5m", candles.retention5m},
+                {"retention15m", candles.retention15m},
+                {"retention30m", candles.retention30m},
+                {"retention1h", candles.retention1h},
+                {"retention1d", candles.retention1d}
+            };
+
+            j["http"] = {
+                {"threads", http.threads},
+                {"streamClients", http.streamClients},
+                {"feedClients", http.feedClients},
+                {"bulkConcurrency", http.bulkConcurrency},
+                {"maxQueuedConnections", http.maxQueuedConnections},
+                {"retryAfterSec", http.retryAfterSec},
+                {"readTimeoutSec", http.readTimeoutSec},
+                {"writeTimeoutSec", http.writeTimeoutSec},
+                {"keepAliveSec", http.keepAliveSec}
+            };
+
             return j;
         }
 
@@ -258,6 +329,10 @@ namespace market {
                 get(s, "populateFineTicksPerDay", simulation.populateFineTicksPerDay);
                 get(s, "populateFineDays", simulation.populateFineDays);
                 get(s, "startDate", simulation.startDate);
+                get(s, "tradeLogCapacity", simulation.tradeLogCapacity);
+                get(s, "tickPolicy", simulation.tickPolicy);
+                get(s, "maxCatchUpTicks", simulation.maxCatchUpTicks);
+                get(s, "agentLayout", simulation.agentLayout);
             }
 
             if (j.contains("commodity")) {
@@ -267,11 +342,15 @@ namespace market {
                 get(c, "priceFloor", commodity.priceFloor);
                 get(c, "supplyDecayRate", commodity.supplyDecayRate);
                 get(c, "demandDecayRate", commodity.demandDecayRate);
+                get(c, "historyDepth", commodity.historyDepth);
             }
 
             if (j.contains("orderBook")) {
                 auto& o = j["orderBook"];
                 get(o, "orderExpiryMs", orderBook.orderExpiryMs);
+                get(o, "matchingThreads", orderBook.matchingThreads);
+                get(o, "matchingMode", orderBook.matchingMode);
+                get(o, "auctionAllocation", orderBook.auctionAllocation);
             }
 
             // Accept both "agents" and "agentCounts" keys
@@ -302,6 +381,7 @@ namespace market {
                 get(g, "sentimentDecayGlobal", agentGlobal.sentimentDecayGlobal);
                 get(g, "sentimentDecayCommodity", agentGlobal.sentimentDecayCommodity);
                 get(g, "maxShortPosition", agentGlobal.maxShortPosition);
+                get(g, "decisionThreads", agentGlobal.decisionThreads);
             }
 
             if (j.contains("marketMaker")) {
@@ -401,6 +481,29 @@ namespace market {
                 get(n, "supplyImpactStd", news.supplyImpactStd);
                 get(n, "demandImpactStd", news.demandImpactStd);
             }
+
+            if (j.contains("candles")) {
+                auto& c = j["candles"];
+                get(c, "retention1m", candles.retention1m);
+                get(c, "retention5m", candles.retention5m);
+                get(c, "retention15m", candles.retention15m);
+                get(c, "retention30m", candles.retention30m);
+                get(c, "retention1h", candles.retention1h);
+                get(c, "retention1d", candles.retention1d);
+            }
+
+            if (j.contains("http")) {
+                auto& h = j["http"];
+                get(h, "threads", http.threads);
+                get(h, "streamClients", http.streamClients);
+                get(h, "feedClients", http.feedClients);
+                get(h, "bulkConcurrency", http.bulkConcurrency);
+                get(h, "maxQueuedConnections", http.maxQueuedConnections);
+                get(h, "retryAfterSec", http.retryAfterSec);
+                get(h, "readTimeoutSec", http.readTimeoutSec);
+                get(h, "writeTimeoutSec", http.writeTimeoutSec);
+                get(h, "keepAliveSec", http.keepAliveSec);
+            }
         }
 
         void fromLegacyJson(const nlohmann::json& cfg) {
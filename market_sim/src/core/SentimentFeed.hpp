@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Types.hpp"
+#include "Checkpoint.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace market {
+
+    // Shared news log plus a decay clock that agents fold into their sentiment
+    // lazily, instead of the engine touching every agent on every tick and
+    // every news event. The clock is the sum of tickScale over all ticks, so
+    // sentiment read at clock c after a value was set at clock c0 has decayed
+    // by rate^(c - c0). Sequence numbers keep increasing across compact().
+    class SentimentFeed {
+    public:
+        struct Entry {
+            NewsEvent event;
+            double clock;  // Clock when the event was published
+        };
+
+        double clock() const { return clock_; }
+        void advance(double tickScale) { clock_ += tickScale; }
+
+        void publish(const NewsEvent& event) { entries_.push_back(Entry{ event, clock_ }); }
+
+        // Held entries are [beginSeq(), endSeq())
+        uint64_t beginSeq() const { return baseSeq_; }
+        uint64_t endSeq() const { return baseSeq_ + entries_.size(); }
+        const Entry& at(uint64_t seq) const { return entries_[seq - baseSeq_]; }
+        size_t pending() const { return entries_.size(); }
+
+        // Drops the held entries; every reader must already be at endSeq()
+        void compact() {
+            baseSeq_ = endSeq();
+            entries_.clear();
+        }
+
+        void clear() {
+            compact();
+            clock_ = 0.0;
+        }
+
+        // Sequence numbers are kept, so restored agent cursors stay valid
+        void writeCheckpoint(CheckpointWriter& out) const {
+            out.write(baseSeq_);
+            out.write(clock_);
+            out.write(static_cast<uint64_t>(entries_.size()));
+            for (const Entry& e : entries_) {
+                out.write(e.event);
+                out.write(e.clock);
+            }
+        }
+
+        void readCheckpoint(CheckpointReader& in) {
+            in.read(baseSeq_);
+            in.read(clock_);
+            entries_.resize(in.readCount(sizeof(double)));
+            for (Entry& e : entries_) {
+                in.read(e.event);
+                in.read(e.clock);
+            }
+        }
+
+    private:
+        std::vector<Entry> entries_;
+        uint64_t baseSeq_ = 0;
+        double clock_ = 0.0;
+    };
+
+} // namespace market
@@ -1,4 +1,5 @@
 #include "SimClock.hpp"
+#include "Checkpoint.hpp"
 #include <sstream>
 #include <iomanip>
 #include <ctime>
@@ -31,6 +32,24 @@ namespace market {
         return simTimeMs_;
     }
 
+    void SimClock::writeCheckpoint(CheckpointWriter& out) const {
+        out.write(startTimeMs_);
+        out.write(simTimeMs_);
+        out.write(ticksPerDay_);
+        out.write(referenceTicksPerDay_);
+        out.write(tickInDay_);
+        out.write(totalTicks_);
+    }
+
+    void SimClock::readCheckpoint(CheckpointReader& in) {
+        in.read(startTimeMs_);
+        in.read(simTimeMs_);
+        in.read(ticksPerDay_);
+        in.read(referenceTicksPerDay_);
+        in.read(tickInDay_);
+        in.read(totalTicks_);
+    }
+
     Timestamp SimClock::parseDate(const std::string& dateStr) {
         std::tm tm = {};
         std::istringstream ss(dateStr);
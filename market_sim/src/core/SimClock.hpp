@@ -7,6 +7,9 @@
 
 namespace market {
 
+    class CheckpointWriter;
+    class CheckpointReader;
+
     // Maps simulation ticks to simulated calendar time
     // 1 real hour = 1 simulated day (at 50ms/tick -> 72000 ticks/day)
     class SimClock {
@@ -79,6 +82,9 @@ namespace market {
         // Convenience: current datetime as ISO string
         std::string currentDateTimeString() const { return formatDateTime(simTimeMs_); }
 
+        void writeCheckpoint(CheckpointWriter& out) const;
+        void readCheckpoint(CheckpointReader& in);
+
     private:
         Timestamp startTimeMs_ = 0;
         Timestamp simTimeMs_ = 0;
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Types.hpp"
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace market {
+
+    // Interns names into dense integer ids (0, 1, 2, ...) in registration order.
+    // Ids are stable for the lifetime of the registry, so they can index plain
+    // vectors on the hot path; names are only resolved when serializing.
+    template <typename Id>
+    class NameRegistry {
+    public:
+        static constexpr Id INVALID = static_cast<Id>(-1);
+
+        Id intern(const std::string& name) {
+            auto it = ids_.find(name);
+            if (it != ids_.end()) return it->second;
+            Id id = static_cast<Id>(names_.size());
+            names_.push_back(name);
+            ids_.emplace(name, id);
+            return id;
+        }
+
+        // Returns INVALID for unknown names
+        Id find(const std::string& name) const {
+            auto it = ids_.find(name);
+            return it != ids_.end() ? it->second : INVALID;
+        }
+
+        const std::string& name(Id id) const {
+            static const std::string empty;
+            return id < names_.size() ? names_[id] : empty;
+        }
+
+        bool contains(Id id) const { return id < names_.size(); }
+        size_t size() const { return names_.size(); }
+        const std::vector<std::string>& names() const { return names_; }
+
+        void clear() {
+            names_.clear();
+            ids_.clear();
+        }
+
+    private:
+        std::vector<std::string> names_;
+        std::unordered_map<std::string, Id> ids_;
+    };
+
+    using SymbolRegistry = NameRegistry<SymbolId>;
+    using AgentTypeRegistry = NameRegistry<AgentTypeId>;
+
+} // namespace market
@@ -1,28 +1,35 @@
 #pragma once
 
 #include "Types.hpp"
+#include "ArrowIpc.hpp"
+#include "Checkpoint.hpp"
+#include "NewsLog.hpp"
+#include "TickSeries.hpp"
+#include "TickStore.hpp"
+#include "utils/FormatBuffer.hpp"
+#include "utils/SpscRing.hpp"
+#include "utils/WorkerPool.hpp"
+#include <algorithm>
 #include <string>
 #include <vector>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <thread>
 #include <fstream>
 #include <sstream>
 #include <iomanip>
 #include <ctime>
 #include <cstdint>
 #include <filesystem>
+#include <functional>
+#include <stdexcept>
 
 namespace market {
 
-    struct TickData {
-        uint64_t tick;
-        Price open;
-        Price high;
-        Price low;
-        Price close;
-        double volume;
-    };
-
     struct NewsData {
         std::string symbol;
         std::string category;
@@ -31,257 +38,1006 @@ namespace market {
         std::string headline;
     };
 
+    // Price history of every symbol, recorded by the tick thread and read by
+    // exports, queries and checkpoints. Recording never touches the storage
+    // lock: recordTick() stages one symbol's tick, and advanceTick() publishes
+    // the whole tick as one record into an SPSC ring that a background
+    // thread appends to storage. Readers wait only for that thread to apply
+    // what was published before they asked, not for the tick thread. If a
+    // long reader holds storage until the ring is full, advanceTick() waits
+    // for room (counted in producerStalls).
+    //
+    // Exports hold the storage lock only to fork every series (sharing its
+    // chunks) and then write that point-in-time copy unlocked, directly or
+    // as a cancellable background job (startExport).
+    //
+    // With a TickStore attached, the background thread also moves every
+    // CHUNKS_PER_SEGMENT full chunks of a series into a new segment and reads
+    // them from the mapping from then on, so memory holds only the recent
+    // ticks and the history outlives the process.
+    //
+    // addSymbol, recordTick, advanceTick, setCurrentTick, clear, attachStore
+    // and readCheckpoint belong to the recording thread; the rest are safe
+    // from any thread.
     class TickBuffer {
     public:
-        TickBuffer(size_t maxTicks = 1000000) 
-            : maxTicks_(maxTicks), currentTick_(0), exporting_(false), exportProgress_(0.0) {}
+        static constexpr size_t PIPELINE_TICKS = 65536;  // Ring capacity, in ticks
 
-        void addSymbol(const std::string& symbol) {
+        TickBuffer(size_t maxTicks = 1000000)
+            : maxTicks_(maxTicks), pipeline_(PIPELINE_TICKS)
+        {
+            consumer_ = std::thread([this]() { consumeLoop(); });
+        }
+
+        ~TickBuffer() {
+            cancelExport();
+            if (exportThread_.joinable()) exportThread_.join();
+            {
+                std::lock_guard<std::mutex> lock(wakeMutex_);
+                stopping_ = true;
+            }
+            wake_.notify_all();
+            consumer_.join();
+
+            // Keep the unsealed tail for the next attachStore()
+            if (store_) {
+                for (const auto& [symbol, tickData] : ticks_) store_->writeTail(symbol, tickData, spilledChunks_[symbol]);
+            }
+        }
+
+        TickBuffer(const TickBuffer&) = delete;
+        TickBuffer& operator=(const TickBuffer&) = delete;
+
+        // Ticks reserved per symbol by later addSymbol() calls
+        void setMaxTicks(size_t maxTicks) {
             std::lock_guard<std::mutex> lock(mutex_);
-            ticks_[symbol] = std::vector<TickData>();
-            ticks_[symbol].reserve(maxTicks_);
+            maxTicks_ = maxTicks;
         }
 
-        void recordTick(const std::string& symbol, Price open, Price high, Price low, Price close, double volume) {
+        // Threads each export writes symbols on; 0 (the default) uses one
+        // per hardware thread. Every format gives the same output for any count.
+        void setExportThreads(size_t threads) { exportThreads_ = threads; }
+
+        // Compressed history (see TickChunk::compress): from now on each
+        // chunk is compressed as it fills, and full chunks already recorded
+        // are compressed now. Reads see the same (float) ticks; flat prices
+        // and consecutive ticks cost about a bit per value. Turning it off
+        // leaves compressed chunks as they are. No effect while a store is
+        // attached, which keeps full chunks on disk instead.
+        void setCompression(bool enabled) {
+            flush();
             std::lock_guard<std::mutex> lock(mutex_);
-            
-            auto it = ticks_.find(symbol);
-            if (it == ticks_.end()) return;
+            compression_ = enabled;
+            if (enabled) compressFull(true);
+        }
 
-            TickData td;
-            td.tick = currentTick_;
-            td.open = open;
-            td.high = high;
-            td.low = low;
-            td.close = close;
-            td.volume = volume;
+        bool isCompressionEnabled() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return compression_;
+        }
+
+        // Starts the symbol's series empty. Its index for recordTick(size_t, ...)
+        // is the number of distinct symbols added before it.
+        void addSymbol(const std::string& symbol) {
+            flush();
+            std::lock_guard<std::mutex> lock(mutex_);
+            TickSeries& series = ticks_[symbol];
+            series = TickSeries();
+            series.reserve(maxTicks_);
+            spilledChunks_[symbol] = 0;
+            if (symbolIndex_.emplace(symbol, symbolOrder_.size()).second) symbolOrder_.push_back(&series);
+            staged_.resize(symbolOrder_.size());
+            stagedSet_.resize(symbolOrder_.size(), 0);
+        }
+
+        // Stages a symbol's tick for the next advanceTick(); no locking
+        void recordTick(size_t symbolIndex, Price open, Price high, Price low, Price close, double volume) {
+            if (symbolIndex >= staged_.size()) return;
+            staged_[symbolIndex] = TickData{ currentTick_.load(std::memory_order_relaxed), open, high, low, close, volume };
+            stagedSet_[symbolIndex] = 1;
+        }
 
-            it->second.push_back(td);
+        void recordTick(const std::string& symbol, Price open, Price high, Price low, Price close, double volume) {
+            auto it = symbolIndex_.find(symbol);
+            if (it != symbolIndex_.end()) recordTick(it->second, open, high, low, close, volume);
         }
 
+        // News goes to a NewsLog under its own lock, never the storage
+        // lock; ticks must not decrease (std::runtime_error otherwise)
         void recordNews(uint64_t tick, const NewsData& news) {
-            std::lock_guard<std::mutex> lock(mutex_);
-            news_[tick].push_back(news);
+            std::lock_guard<std::mutex> lock(newsMutex_);
+            news_.append(tick, news.symbol, news.category, news.sentiment, news.magnitude, news.headline);
+        }
+
+        void recordNews(uint64_t tick, const NewsEvent& news) {
+            std::lock_guard<std::mutex> lock(newsMutex_);
+            news_.append(tick, news);
         }
 
+        // Calls fn(const NewsLog::Record&) for NewsLog::select(since, until,
+        // symbol, limit), oldest first, holding the news lock
+        template <typename Fn>
+        void forEachNews(uint64_t since, uint64_t until, const std::string& symbol, size_t limit, Fn&& fn) const {
+            std::lock_guard<std::mutex> lock(newsMutex_);
+            for (size_t i : news_.select(since, until, symbol, limit)) fn(news_[i]);
+        }
+
+        size_t getNewsCount() const {
+            std::lock_guard<std::mutex> lock(newsMutex_);
+            return news_.size();
+        }
+
+        size_t getNewsBytes() const {
+            std::lock_guard<std::mutex> lock(newsMutex_);
+            return news_.memoryBytes();
+        }
+
+        // Publishes the staged ticks as one record and moves to the next tick
         void advanceTick() {
-            std::lock_guard<std::mutex> lock(mutex_);
-            currentTick_++;
+            TickRecord* record = pipeline_.tryBeginPush();
+            if (!record) {
+                producerStalls_.fetch_add(1, std::memory_order_relaxed);
+                wakeConsumer();
+                while (!(record = pipeline_.tryBeginPush())) std::this_thread::yield();
+            }
+            record->ticks.assign(staged_.begin(), staged_.end());
+            record->present.assign(stagedSet_.begin(), stagedSet_.end());
+            pipeline_.commitPush();
+            std::fill(stagedSet_.begin(), stagedSet_.end(), 0);
+            currentTick_.fetch_add(1, std::memory_order_relaxed);
+            if (consumerIdle_.load(std::memory_order_acquire)) wakeConsumer();
         }
 
         void setCurrentTick(uint64_t tick) {
-            std::lock_guard<std::mutex> lock(mutex_);
+            flush();
             currentTick_ = tick;
         }
 
+        // Blocks until every tick published so far is in storage
+        void flush() const {
+            uint64_t target = pipeline_.pushed();
+            if (applied_.load(std::memory_order_acquire) >= target) return;
+            std::unique_lock<std::mutex> lock(wakeMutex_);
+            wake_.notify_all();
+            applied_cv_.wait(lock, [this, target]() { return applied_.load(std::memory_order_acquire) >= target; });
+        }
+
         size_t getTickCount() const {
+            flush();
             std::lock_guard<std::mutex> lock(mutex_);
             if (ticks_.empty()) return 0;
             return ticks_.begin()->second.size();
         }
 
         uint64_t getCurrentTick() const {
+            return currentTick_.load();
+        }
+
+        // Pipeline counters: ticks published by advanceTick(), ticks appended
+        // to storage, the difference, and times advanceTick() found the ring full
+        uint64_t getPublishedTicks() const { return pipeline_.pushed(); }
+        uint64_t getAppliedTicks() const { return applied_.load(); }
+        size_t getQueuedTicks() const {
+            uint64_t applied = applied_.load();
+            uint64_t published = pipeline_.pushed();
+            return static_cast<size_t>(published - std::min(applied, published));
+        }
+        size_t getPipelineCapacity() const { return pipeline_.capacity(); }
+        uint64_t getProducerStalls() const { return producerStalls_.load(); }
+
+        // Bytes held by the stored series (see TickSeries); chunks shared with a fork count in both
+        size_t getStorageBytes() const {
             std::lock_guard<std::mutex> lock(mutex_);
-            return currentTick_;
+            size_t bytes = 0;
+            for (const auto& [symbol, tickData] : ticks_) bytes += tickData.memoryBytes();
+            return bytes;
         }
 
-        bool exportToJson(const std::string& filepath, size_t maxTicks = 0) {
+        // Persists the history in a TickStore under `directory` from now on.
+        // Added symbols with history in the store take it over, mapped, and
+        // recording continues after the last stored tick; the others keep
+        // what they recorded. Throws std::runtime_error, with the buffer
+        // unchanged and no store attached, if the directory cannot be
+        // created or a stored segment cannot be read.
+        void attachStore(const std::string& directory) {
+            flush();
             std::lock_guard<std::mutex> lock(mutex_);
-            
-            if (ticks_.empty()) return false;
+            auto store = std::make_unique<TickStore>(directory);
+            std::map<std::string, std::pair<TickSeries, size_t>> loaded;
+            for (const auto& [symbol, tickData] : ticks_) {
+                TickSeries stored;
+                size_t mapped = store->load(symbol, stored);
+                loaded.emplace(symbol, std::make_pair(std::move(stored), mapped));
+            }
 
-            exporting_ = true;
-            exportProgress_ = 0.0;
+            store_ = std::move(store);
+            uint64_t next = currentTick_.load();
+            for (auto& [symbol, tickData] : ticks_) {
+                auto& [stored, mapped] = loaded[symbol];
+                if (stored.empty()) {
+                    spilledChunks_[symbol] = 0;
+                    continue;
+                }
+                tickData = std::move(stored);
+                spilledChunks_[symbol] = mapped;
+                next = std::max(next, tickData[tickData.size() - 1].tick + 1);
+            }
+            currentTick_ = next;
+            spillFull();
+        }
 
-            size_t limit = (maxTicks > 0) ? std::min(maxTicks, currentTick_) : currentTick_;
+        bool hasStore() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return store_ != nullptr;
+        }
 
-            std::ofstream file(filepath);
-            if (!file.is_open()) {
-                exporting_ = false;
-                return false;
-            }
+        // Store index and footprint; empty without a store
+        std::vector<TickStore::Segment> getStoreSegments() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return store_ ? store_->getSegments() : std::vector<TickStore::Segment>();
+        }
+        size_t getStoreSegmentCount() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return store_ ? store_->getSegmentCount() : 0;
+        }
+        size_t getStoreMappedBytes() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return store_ ? store_->getMappedBytes() : 0;
+        }
+        uint64_t getStoreErrors() const { return storeErrors_.load(); }
 
-            file << "{\n";
-            
-            size_t symbolCount = 0;
-            for (const auto& [symbol, tickData] : ticks_) {
-                if (symbolCount > 0) file << ",\n";
-                
-                file << "  \"" << symbol << "\": {\n";
-                file << "    \"ticks\": [\n";
-
-                size_t count = 0;
-                size_t exportCount = std::min(limit, tickData.size());
-                for (size_t i = 0; i < exportCount; ++i) {
-                    const auto& td = tickData[i];
-                    file << "      {\"tick\":" << td.tick 
-                         << ",\"open\":" << td.open 
-                         << ",\"high\":" << td.high 
-                         << ",\"low\":" << td.low 
-                         << ",\"close\":" << td.close 
-                         << ",\"volume\":" << td.volume << "}";
-                    
-                    if (i < exportCount - 1) file << ",";
-                    file << "\n";
-                    
-                    if (i % 10000 == 0) {
-                        exportProgress_ = static_cast<double>(i) / exportCount * 0.5;
-                    }
-                }
+        enum class ExportFormat { JSON, CSV, ARROW };
 
-                file << "    ],\n";
-                file << "    \"orderbooks\": {}\n";
-                file << "  }";
-                
-                symbolCount++;
-                exportProgress_ = static_cast<double>(symbolCount) / ticks_.size() * 0.5;
-            }
-
-            file << ",\n  \"_news\": {\n";
-            
-            size_t newsCount = 0;
-            size_t newsTotal = news_.size();
-            for (const auto& [tick, events] : news_) {
-                if (tick >= limit) break;
-                
-                if (newsCount > 0) file << ",\n";
-                file << "    \"" << tick << "\": [\n";
-                
-                for (size_t i = 0; i < events.size(); ++i) {
-                    const auto& ne = events[i];
-                    file << "      {\"symbol\":\"" << ne.symbol 
-                         << "\",\"category\":\"" << ne.category 
-                         << "\",\"sentiment\":\"" << ne.sentiment 
-                         << "\",\"magnitude\":" << ne.magnitude 
-                         << ",\"headline\":\"" << escapeJson(ne.headline) << "\"}";
-                    
-                    if (i < events.size() - 1) file << ",";
-                    file << "\n";
+        // One output of an export: a JSON file, or a CSV or Arrow directory
+        // with a file per symbol (Arrow also writes news.arrow)
+        struct ExportTarget {
+            ExportFormat format = ExportFormat::JSON;
+            std::string path;
+            size_t maxTicks = 0;  // 0: every tick
+        };
+
+        // The current or last background export (startExport)
+        struct ExportStatus {
+            enum class State { IDLE, RUNNING, DONE, FAILED, CANCELLED };
+
+            State state = State::IDLE;
+            double progress = 0.0;
+            uint64_t ticks = 0;              // Recorded when the job started; later ticks are not exported
+            std::vector<std::string> paths;
+            std::string error;
+
+            static const char* stateName(State state) {
+                switch (state) {
+                    case State::RUNNING: return "running";
+                    case State::DONE: return "done";
+                    case State::FAILED: return "failed";
+                    case State::CANCELLED: return "cancelled";
+                    default: return "idle";
                 }
-                
-                file << "    ]";
-                newsCount++;
             }
-            
-            file << "\n  }\n";
-            file << "}\n";
+        };
 
-            file.close();
-            exporting_ = false;
-            exportProgress_ = 1.0;
-
-            return true;
+        // Writes the history as of now to `filepath`. Storage is locked only
+        // to take a snapshot (see exportSnapshot), not while writing.
+        bool exportToJson(const std::string& filepath, size_t maxTicks = 0) {
+            ExportSnapshot snapshot = exportSnapshot();
+            return runExport(snapshot, { ExportFormat::JSON, filepath, maxTicks }, 0.0, 1.0, nullptr);
         }
 
         bool exportToCsv(const std::string& dir, size_t maxTicks = 0) {
-            std::lock_guard<std::mutex> lock(mutex_);
-            
-            if (ticks_.empty()) return false;
+            ExportSnapshot snapshot = exportSnapshot();
+            return runExport(snapshot, { ExportFormat::CSV, dir, maxTicks }, 0.0, 1.0, nullptr);
+        }
 
-            exporting_ = true;
-            exportProgress_ = 0.0;
+        // Arrow IPC files under `dir`: <symbol>.arrow with columns tick
+        // (uint64) and open, high, low, close, volume (float32, as stored),
+        // and news.arrow with tick, symbol, category, sentiment, magnitude
+        // and headline. Written a record batch of EXPORT_BATCH_TICKS at a time.
+        bool exportToArrow(const std::string& dir, size_t maxTicks = 0) {
+            ExportSnapshot snapshot = exportSnapshot();
+            return runExport(snapshot, { ExportFormat::ARROW, dir, maxTicks }, 0.0, 1.0, nullptr);
+        }
 
-            std::filesystem::create_directories(dir);
+        // Exports the history as of this call to every target in turn, on a
+        // background thread; poll getExportStatus(). Throws std::runtime_error
+        // if an export job is already running or nothing is recorded.
+        void startExport(std::vector<ExportTarget> targets) {
+            std::lock_guard<std::mutex> jobLock(exportMutex_);
+            if (exportStatus_.state == ExportStatus::State::RUNNING) {
+                throw std::runtime_error("Export already in progress");
+            }
+            auto snapshot = std::make_shared<ExportSnapshot>(exportSnapshot());
+            if (snapshot->ticks.empty()) throw std::runtime_error("No ticks recorded");
+            if (exportThread_.joinable()) exportThread_.join();
 
-            size_t limit = (maxTicks > 0) ? std::min(maxTicks, currentTick_) : currentTick_;
+            exportCancel_ = false;
+            exportStatus_ = ExportStatus();
+            exportStatus_.state = ExportStatus::State::RUNNING;
+            exportStatus_.ticks = snapshot->currentTick;
+            for (const auto& target : targets) exportStatus_.paths.push_back(target.path);
 
-            size_t symbolCount = 0;
-            for (const auto& [symbol, tickData] : ticks_) {
-                std::string filepath = dir + "/" + symbol + ".csv";
-                std::ofstream file(filepath);
-                
-                if (!file.is_open()) {
-                    exporting_ = false;
-                    return false;
+            exportThread_ = std::thread([this, snapshot, targets = std::move(targets)]() {
+                bool ok = true;
+                for (size_t i = 0; i < targets.size() && ok; ++i) {
+                    double span = 1.0 / targets.size();
+                    ok = runExport(*snapshot, targets[i], i * span, span, &exportCancel_);
                 }
-
-                file << "tick,open,high,low,close,volume\n";
-
-                size_t exportCount = std::min(limit, tickData.size());
-                for (size_t i = 0; i < exportCount; ++i) {
-                    const auto& td = tickData[i];
-                    file << td.tick << "," 
-                         << std::fixed << std::setprecision(4) << td.open << ","
-                         << std::fixed << std::setprecision(4) << td.high << ","
-                         << std::fixed << std::setprecision(4) << td.low << ","
-                         << std::fixed << std::setprecision(4) << td.close << ","
-                         << std::fixed << std::setprecision(2) << td.volume << "\n";
+                std::lock_guard<std::mutex> lock(exportMutex_);
+                if (ok) {
+                    exportStatus_.state = ExportStatus::State::DONE;
+                    exportStatus_.progress = 1.0;
                 }
+                else if (exportCancel_) {
+                    exportStatus_.state = ExportStatus::State::CANCELLED;
+                }
+                else {
+                    exportStatus_.state = ExportStatus::State::FAILED;
+                    exportStatus_.error = "Cannot write export output";
+                }
+            });
+        }
 
-                file.close();
-                symbolCount++;
-                exportProgress_ = static_cast<double>(symbolCount) / ticks_.size();
-            }
+        // Stops the running export job at its next block of ticks; its
+        // partial output is deleted and it ends CANCELLED
+        void cancelExport() { exportCancel_ = true; }
 
-            std::ofstream metaFile(dir + "/metadata.json");
-            metaFile << "{\"totalTicks\":" << currentTick_ 
-                     << ",\"exportedTicks\":" << limit 
-                     << ",\"commodities\":" << ticks_.size() 
-                     << ",\"exportedAt\":\"" << getCurrentTimestamp() << "\"}\n";
-            metaFile.close();
+        ExportStatus getExportStatus() const {
+            std::lock_guard<std::mutex> lock(exportMutex_);
+            ExportStatus status = exportStatus_;
+            if (status.state == ExportStatus::State::RUNNING) status.progress = exportProgress_.load();
+            return status;
+        }
 
-            exporting_ = false;
-            exportProgress_ = 1.0;
+        // Ticks [start, start + count) of some symbols as of one moment. The
+        // series share their chunks with storage (TickSeries::fork), so a
+        // range copies no ticks and is read without any lock while
+        // recording goes on.
+        struct TickRange {
+            struct Series {
+                std::string symbol;
+                TickSeries ticks;
+                size_t begin = 0;
+                size_t end = 0;  // Clamped to the ticks recorded
 
-            return true;
+                size_t size() const { return end - begin; }
+                TickData operator[](size_t i) const { return ticks[begin + i]; }
+
+                // fn(const TickData&) for each tick of the range, in order
+                template <typename Fn>
+                void forEach(Fn&& fn) const { ticks.forEach(begin, end, std::forward<Fn>(fn)); }
+            };
+
+            std::vector<Series> series;  // In symbol order
+            uint64_t currentTick = 0;
+
+            size_t size() const {
+                size_t total = 0;
+                for (const auto& s : series) total += s.size();
+                return total;
+            }
+        };
+
+        // Every symbol, or just `symbols`. Throws std::runtime_error for a
+        // symbol that is not recorded.
+        TickRange getTickRange(size_t start, size_t count, const std::vector<std::string>& symbols = {}) const {
+            flush();
+            std::lock_guard<std::mutex> lock(mutex_);
+            TickRange range;
+            range.currentTick = currentTick_.load();
+            auto add = [&](const std::string& symbol, const TickSeries& tickData) {
+                TickRange::Series s;
+                s.symbol = symbol;
+                s.ticks = tickData.fork();
+                s.begin = std::min(start, tickData.size());
+                s.end = s.begin + std::min(count, tickData.size() - s.begin);
+                range.series.push_back(std::move(s));
+            };
+            if (symbols.empty()) {
+                for (const auto& [symbol, tickData] : ticks_) add(symbol, tickData);
+            }
+            else {
+                std::vector<std::string> sorted(symbols);
+                std::sort(sorted.begin(), sorted.end());
+                sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+                for (const auto& symbol : sorted) {
+                    auto it = ticks_.find(symbol);
+                    if (it == ticks_.end()) throw std::runtime_error("Unknown symbol: " + symbol);
+                    add(symbol, it->second);
+                }
+            }
+            return range;
         }
 
+        // Copies of the range's ticks, by symbol
         std::map<std::string, std::vector<TickData>> getTicks(size_t startTick, size_t count) const {
-            std::lock_guard<std::mutex> lock(mutex_);
-            
+            TickRange range = getTickRange(startTick, count);
             std::map<std::string, std::vector<TickData>> result;
-            
-            for (const auto& [symbol, tickData] : ticks_) {
-                result[symbol] = std::vector<TickData>();
-                
-                size_t endTick = std::min(startTick + count, tickData.size());
-                for (size_t i = startTick; i < endTick; ++i) {
-                    result[symbol].push_back(tickData[i]);
-                }
+            for (const auto& s : range.series) {
+                auto& out = result[s.symbol];
+                out.reserve(s.size());
+                s.forEach([&out](const TickData& td) { out.push_back(td); });
             }
-            
             return result;
         }
 
-        bool isExporting() const {
-            std::lock_guard<std::mutex> lock(mutex_);
-            return exporting_;
+        bool isExporting() const { return exporting_.load(); }
+        double getExportProgress() const { return exportProgress_.load(); }
+
+        void clear() {
+            flush();
+            std::scoped_lock lock(mutex_, newsMutex_);
+            ticks_.clear();
+            news_.clear();
+            symbolIndex_.clear();
+            symbolOrder_.clear();
+            staged_.clear();
+            stagedSet_.clear();
+            spilledChunks_.clear();
+            if (store_) store_->clear();
+            currentTick_ = 0;
         }
 
-        double getExportProgress() const {
-            std::lock_guard<std::mutex> lock(mutex_);
-            return exportProgress_;
+        void writeCheckpoint(CheckpointWriter& out) const {
+            flush();
+            std::scoped_lock lock(mutex_, newsMutex_);
+            out.write(currentTick_.load());
+            out.write(static_cast<uint64_t>(ticks_.size()));
+            for (const auto& [symbol, tickData] : ticks_) {
+                out.write(symbol);
+                out.write(static_cast<uint64_t>(tickData.size()));
+                tickData.forEach(0, tickData.size(), [&out](const TickData& td) {
+                    out.write(td.tick);
+                    out.write(td.open);
+                    out.write(td.high);
+                    out.write(td.low);
+                    out.write(td.close);
+                    out.write(td.volume);
+                });
+            }
+            news_.writeCheckpoint(out);
         }
 
-        void clear() {
-            std::lock_guard<std::mutex> lock(mutex_);
+        // Replaces every series with the checkpoint's, and the store's
+        // contents with them too
+        void readCheckpoint(CheckpointReader& in) {
+            flush();
+            std::scoped_lock lock(mutex_, newsMutex_);
             ticks_.clear();
             news_.clear();
-            currentTick_ = 0;
+            symbolIndex_.clear();
+            symbolOrder_.clear();
+            spilledChunks_.clear();
+            if (store_) store_->clear();
+
+            currentTick_ = in.read<uint64_t>();
+            size_t symbols = in.readCount(1);
+            for (size_t i = 0; i < symbols; ++i) {
+                std::string symbol;
+                in.read(symbol);
+                size_t count = in.readCount(sizeof(TickData));
+                auto& tickData = ticks_[symbol];
+                symbolIndex_[symbol] = symbolOrder_.size();
+                symbolOrder_.push_back(&tickData);
+                tickData.reserve(std::max(maxTicks_, count));
+                for (size_t j = 0; j < count; ++j) {
+                    TickData td;
+                    in.read(td.tick);
+                    in.read(td.open);
+                    in.read(td.high);
+                    in.read(td.low);
+                    in.read(td.close);
+                    in.read(td.volume);
+                    tickData.push_back(td);
+                }
+            }
+            staged_.assign(symbolOrder_.size(), TickData{});
+            stagedSet_.assign(symbolOrder_.size(), 0);
+
+            news_.readCheckpoint(in);
+            spillFull();
+            compressFull(true);
+        }
+
+        // Replaces this buffer with a copy of `source` for a forked simulation.
+        // Tick series are shared chunk by chunk (see TickSeries), mapped ones
+        // included, and so is the news log (NewsLog::fork). The copy writes
+        // to no store.
+        void forkFrom(TickBuffer& source) {
+            if (&source == this) return;
+            flush();
+            source.flush();
+            std::scoped_lock lock(mutex_, source.mutex_, newsMutex_, source.newsMutex_);
+            maxTicks_ = source.maxTicks_;
+            compression_ = source.compression_;
+            currentTick_ = source.currentTick_.load();
+            ticks_.clear();
+            symbolOrder_.clear();
+            symbolIndex_.clear();
+            spilledChunks_.clear();
+            store_.reset();
+            // Same indices as the source; its map order is not always its add order
+            symbolOrder_.resize(source.symbolOrder_.size());
+            for (auto& [symbol, tickData] : source.ticks_) {
+                TickSeries& series = ticks_.emplace(symbol, tickData.fork()).first->second;
+                size_t index = source.symbolIndex_.at(symbol);
+                symbolIndex_[symbol] = index;
+                symbolOrder_[index] = &series;
+            }
+            staged_.assign(symbolOrder_.size(), TickData{});
+            stagedSet_.assign(symbolOrder_.size(), 0);
+            news_ = source.news_.fork();
         }
 
     private:
+        // One tick of every symbol, as published by advanceTick()
+        struct TickRecord {
+            std::vector<TickData> ticks;    // By symbol index
+            std::vector<uint8_t> present;   // Whether the symbol was recorded this tick
+        };
+
         size_t maxTicks_;
-        uint64_t currentTick_;
-        std::map<std::string, std::vector<TickData>> ticks_;
-        std::map<uint64_t, std::vector<NewsData>> news_;
-        mutable std::mutex mutex_;
-        bool exporting_;
-        double exportProgress_;
-
-        std::string escapeJson(const std::string& s) const {
-            std::string result;
-            for (char c : s) {
-                switch (c) {
-                    case '"': result += "\\\""; break;
-                    case '\\': result += "\\\\"; break;
-                    case '\n': result += "\\n"; break;
-                    case '\r': result += "\\r"; break;
-                    case '\t': result += "\\t"; break;
-                    default: result += c;
+        std::map<std::string, TickSeries> ticks_;
+        NewsLog news_;                                 // Guarded by newsMutex_
+        mutable std::mutex newsMutex_;                 // After mutex_ when both are held
+        std::vector<TickSeries*> symbolOrder_;         // Into ticks_, by symbol index
+        std::unique_ptr<TickStore> store_;
+        std::map<std::string, size_t> spilledChunks_;  // Leading chunks of each series in store_
+        bool compression_ = false;                     // Compress chunks as they fill
+        mutable std::mutex mutex_;                     // Storage: ticks_ to compression_
+        std::atomic<bool> exporting_{ false };
+        std::atomic<double> exportProgress_{ 0.0 };
+        std::atomic<bool> exportCancel_{ false };
+        std::atomic<size_t> exportThreads_{ 0 };
+
+        // Background export job
+        mutable std::mutex exportMutex_;
+        ExportStatus exportStatus_;  // Guarded by exportMutex_
+        std::thread exportThread_;
+
+        // Recording thread only
+        std::map<std::string, size_t> symbolIndex_;
+        std::vector<TickData> staged_;
+        std::vector<uint8_t> stagedSet_;
+        std::atomic<uint64_t> currentTick_{ 0 };       // Read from any thread
+
+        SpscRing<TickRecord> pipeline_;
+        std::atomic<uint64_t> applied_{ 0 };           // Records in storage
+        std::atomic<uint64_t> producerStalls_{ 0 };
+        std::atomic<uint64_t> storeErrors_{ 0 };       // Segment writes that failed
+
+        std::thread consumer_;
+        mutable std::mutex wakeMutex_;
+        mutable std::condition_variable wake_;         // Consumer waits here when idle
+        mutable std::condition_variable applied_cv_;   // flush() waits here
+        mutable std::atomic<bool> consumerIdle_{ false };
+        bool stopping_ = false;                        // Guarded by wakeMutex_
+
+        void wakeConsumer() const {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            wake_.notify_all();
+        }
+
+        // Appends everything published to storage, a batch per storage lock
+        void consumeLoop() {
+            for (;;) {
+                if (!pipeline_.front()) {
+                    std::unique_lock<std::mutex> lock(wakeMutex_);
+                    consumerIdle_.store(true, std::memory_order_release);
+                    if (!pipeline_.front()) {
+                        if (stopping_) return;
+                        wake_.wait_for(lock, std::chrono::milliseconds(50));
+                    }
+                    consumerIdle_.store(false, std::memory_order_release);
+                    continue;
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    size_t batch = 0;
+                    while (TickRecord* record = pipeline_.front()) {
+                        size_t n = std::min(record->ticks.size(), symbolOrder_.size());
+                        for (size_t i = 0; i < n; ++i) {
+                            if (record->present[i]) symbolOrder_[i]->push_back(record->ticks[i]);
+                        }
+                        pipeline_.pop();
+                        applied_.fetch_add(1, std::memory_order_release);
+                        if (++batch == 1024) break;
+                    }
+                    spillFull();
+                    compressFull(false);
+                }
+                {
+                    std::lock_guard<std::mutex> lock(wakeMutex_);
+                    applied_cv_.notify_all();
+                }
+            }
+        }
+
+        // Point-in-time copy of the history for an export: series share
+        // their chunks with storage (TickSeries::fork), so taking one costs
+        // a pointer per chunk and recording goes on meanwhile
+        struct ExportSnapshot {
+            std::map<std::string, TickSeries> ticks;
+            NewsLog news;
+            uint64_t currentTick = 0;
+        };
+
+        static constexpr size_t EXPORT_BLOCK_TICKS = TickSeries::CHUNK_TICKS;  // Progress and cancel checks
+        static constexpr size_t EXPORT_BATCH_TICKS = 65536;     // Arrow record batch rows
+
+        ExportSnapshot exportSnapshot() {
+            flush();
+            std::lock_guard<std::mutex> lock(mutex_);
+            ExportSnapshot snapshot;
+            for (const auto& [symbol, tickData] : ticks_) snapshot.ticks.emplace(symbol, tickData.fork());
+            {
+                std::lock_guard<std::mutex> newsLock(newsMutex_);
+                snapshot.news = news_.fork();
+            }
+            snapshot.currentTick = currentTick_.load();
+            return snapshot;
+        }
+
+        // Ticks written so far by all the workers of one export, as progress
+        class ExportProgress {
+        public:
+            ExportProgress(std::atomic<double>& progress, double base, double span, size_t total)
+                : progress_(progress), base_(base), span_(span), total_(std::max<size_t>(total, 1)) {}
+
+            void add(size_t ticks) {
+                size_t done = done_.fetch_add(ticks, std::memory_order_relaxed) + ticks;
+                progress_ = base_ + span_ * static_cast<double>(std::min(done, total_)) / total_;
+            }
+
+        private:
+            std::atomic<double>& progress_;
+            double base_;
+            double span_;
+            size_t total_;
+            std::atomic<size_t> done_{ 0 };
+        };
+
+        struct ExportSymbol {
+            const std::string* symbol;
+            const TickSeries* ticks;
+            size_t count;  // Ticks to write
+        };
+
+        // Calls fn(const TickData&) -> bool for the symbol's ticks in order,
+        // EXPORT_BLOCK_TICKS at a time, reporting progress and checking for
+        // cancellation between blocks. False once fn is, or if cancelled.
+        template <typename Fn>
+        static bool forEachExportTick(const ExportSymbol& s, ExportProgress& progress,
+            const std::atomic<bool>* cancel, Fn&& fn) {
+            bool ok = true;
+            for (size_t begin = 0; begin < s.count && ok; begin += EXPORT_BLOCK_TICKS) {
+                size_t end = std::min(s.count, begin + EXPORT_BLOCK_TICKS);
+                s.ticks->forEach(begin, end, [&](const TickData& td) { ok = ok && fn(td); });
+                if (cancel && *cancel) return false;
+                progress.add(end - begin);
+            }
+            return ok && !(cancel && *cancel);
+        }
+
+        std::vector<ExportSymbol> exportSymbols(const ExportSnapshot& snapshot, size_t limit) const {
+            std::vector<ExportSymbol> symbols;
+            for (const auto& [symbol, tickData] : snapshot.ticks) {
+                symbols.push_back({ &symbol, &tickData, std::min(limit, tickData.size()) });
+            }
+            return symbols;
+        }
+
+        static size_t exportTickTotal(const std::vector<ExportSymbol>& symbols) {
+            size_t total = 0;
+            for (const auto& s : symbols) total += s.count;
+            return total;
+        }
+
+        size_t exportWorkerCount(size_t symbols) const {
+            size_t threads = exportThreads_.load();
+            if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+            return std::max<size_t>(1, std::min(threads, symbols));
+        }
+
+        // Runs fn(i) for every i in [0, count) on exportWorkerCount(count)
+        // threads, the caller included. False if any call returned false;
+        // calls not yet started are then skipped.
+        bool forEachExportSymbol(size_t count, const std::function<bool(size_t)>& fn) const {
+            std::atomic<bool> failed{ false };
+            auto run = [&](size_t i) {
+                if (!failed.load(std::memory_order_relaxed) && !fn(i)) failed = true;
+            };
+            size_t workers = exportWorkerCount(count);
+            if (workers == 1) {
+                for (size_t i = 0; i < count; ++i) run(i);
+            }
+            else {
+                WorkerPool pool(workers - 1);
+                pool.parallelFor(count, run);
+            }
+            return !failed;
+        }
+
+        static std::string exportPartPath(const std::string& filepath, size_t index) {
+            return filepath + ".part" + std::to_string(index);
+        }
+
+        // Writes one target, reporting progress from `progressBase` over
+        // `progressSpan` and stopping once `*cancel` is set (if given);
+        // removes the partial output on failure or cancel
+        bool runExport(const ExportSnapshot& snapshot, const ExportTarget& target,
+            double progressBase, double progressSpan, const std::atomic<bool>* cancel) {
+            if (snapshot.ticks.empty()) return false;
+            exporting_ = true;
+            exportProgress_ = progressBase;
+            bool ok = false;
+            switch (target.format) {
+                case ExportFormat::CSV:
+                    ok = writeCsv(snapshot, target.path, target.maxTicks, progressBase, progressSpan, cancel);
+                    break;
+                case ExportFormat::ARROW:
+                    ok = writeArrow(snapshot, target.path, target.maxTicks, progressBase, progressSpan, cancel);
+                    break;
+                default:
+                    ok = writeJson(snapshot, target.path, target.maxTicks, progressBase, progressSpan, cancel);
+            }
+            exporting_ = false;
+            std::error_code ec;
+            if (ok) {
+                exportProgress_ = progressBase + progressSpan;
+            }
+            else if (target.format == ExportFormat::CSV) {
+                for (const auto& [symbol, tickData] : snapshot.ticks) {
+                    std::filesystem::remove(target.path + "/" + symbol + ".csv", ec);
+                }
+                std::filesystem::remove(target.path + "/metadata.json", ec);
+            }
+            else if (target.format == ExportFormat::ARROW) {
+                for (const auto& [symbol, tickData] : snapshot.ticks) {
+                    std::filesystem::remove(target.path + "/" + symbol + ".arrow", ec);
+                }
+                std::filesystem::remove(target.path + "/news.arrow", ec);
+            }
+            else {
+                std::filesystem::remove(target.path, ec);
+            }
+            if (target.format == ExportFormat::JSON) {
+                for (size_t i = 0; i < snapshot.ticks.size(); ++i) {
+                    std::filesystem::remove(exportPartPath(target.path, i), ec);
+                }
+            }
+            return ok;
+        }
+
+        // With several workers, each symbol's section is rendered to its own
+        // part file next to `filepath`; the parts are then stitched together
+        // in symbol order, so the output is the same for any worker count
+        bool writeJson(const ExportSnapshot& snapshot, const std::string& filepath, size_t maxTicks,
+            double progressBase, double progressSpan, const std::atomic<bool>* cancel) {
+            size_t limit = (maxTicks > 0) ? std::min<uint64_t>(maxTicks, snapshot.currentTick) : snapshot.currentTick;
+            auto symbols = exportSymbols(snapshot, limit);
+            ExportProgress progress(exportProgress_, progressBase, progressSpan, exportTickTotal(symbols));
+
+            std::ofstream file(filepath, std::ios::binary);
+            if (!file.is_open()) return false;
+            file << "{\n";
+
+            if (exportWorkerCount(symbols.size()) == 1) {
+                FormatBuffer out(file);
+                for (size_t i = 0; i < symbols.size(); ++i) {
+                    if (i > 0) out.put(",\n");
+                    if (!writeJsonSymbol(out, symbols[i], progress, cancel)) return false;
+                }
+                if (!out.flush()) return false;
+            }
+            else {
+                bool ok = forEachExportSymbol(symbols.size(), [&](size_t i) {
+                    std::ofstream part(exportPartPath(filepath, i), std::ios::binary);
+                    if (!part.is_open()) return false;
+                    FormatBuffer out(part);
+                    return writeJsonSymbol(out, symbols[i], progress, cancel) && out.flush();
+                });
+                if (!ok) return false;
+
+                std::error_code ec;
+                for (size_t i = 0; i < symbols.size(); ++i) {
+                    if (i > 0) file << ",\n";
+                    std::string partPath = exportPartPath(filepath, i);
+                    {
+                        std::ifstream part(partPath, std::ios::binary);
+                        if (!part.is_open() || !(file << part.rdbuf())) return false;
+                    }
+                    std::filesystem::remove(partPath, ec);
+                }
+            }
+
+            FormatBuffer out(file);
+            out.put(",\n  \"_news\": {\n");
+
+            // One array per tick with news; the log keeps ticks in order
+            const NewsLog& news = snapshot.news;
+            size_t newsEnd = news.lowerBound(limit);
+            for (size_t i = 0; i < newsEnd; ++i) {
+                auto ne = news[i];
+                bool first = i == 0 || news.tickAt(i - 1) != ne.tick;
+                bool last = i + 1 == newsEnd || news.tickAt(i + 1) != ne.tick;
+                if (first) {
+                    if (i > 0) out.put(",\n");
+                    out.put("    \"").putUInt(ne.tick).put("\": [\n");
+                }
+
+                out.put("      {\"symbol\":\"").put(ne.symbol)
+                   .put("\",\"category\":\"").put(ne.category)
+                   .put("\",\"sentiment\":\"").put(ne.sentiment)
+                   .put("\",\"magnitude\":").putGeneral(ne.magnitude)
+                   .put(",\"headline\":\"").putEscaped(ne.headline).put("\"}");
+                out.put(last ? "\n    ]" : ",\n");
+            }
+
+            out.put("\n  }\n");
+            out.put("}\n");
+            if (!out.flush()) return false;
+
+            file.close();
+            return !file.fail();
+        }
+
+        // One symbol's `"SYM": {...}` section. Prices and volume are written
+        // as the shortest text that reads back as the stored float.
+        bool writeJsonSymbol(FormatBuffer& out, const ExportSymbol& s, ExportProgress& progress,
+            const std::atomic<bool>* cancel) const {
+            out.put("  \"").put(*s.symbol).put("\": {\n");
+            out.put("    \"ticks\": [\n");
+
+            size_t written = 0;
+            bool ok = forEachExportTick(s, progress, cancel, [&](const TickData& td) {
+                out.put("      {\"tick\":").putUInt(td.tick)
+                   .put(",\"open\":").putShortest(static_cast<float>(td.open))
+                   .put(",\"high\":").putShortest(static_cast<float>(td.high))
+                   .put(",\"low\":").putShortest(static_cast<float>(td.low))
+                   .put(",\"close\":").putShortest(static_cast<float>(td.close))
+                   .put(",\"volume\":").putShortest(static_cast<float>(td.volume)).put('}');
+
+                if (++written < s.count) out.put(',');
+                out.put('\n');
+                return true;
+            });
+            if (!ok) return false;
+
+            out.put("    ],\n");
+            out.put("    \"orderbooks\": {}\n");
+            out.put("  }");
+            return true;
+        }
+
+        bool writeCsv(const ExportSnapshot& snapshot, const std::string& dir, size_t maxTicks,
+            double progressBase, double progressSpan, const std::atomic<bool>* cancel) {
+            std::error_code ec;
+            std::filesystem::create_directories(dir, ec);
+
+            size_t limit = (maxTicks > 0) ? std::min<uint64_t>(maxTicks, snapshot.currentTick) : snapshot.currentTick;
+            auto symbols = exportSymbols(snapshot, limit);
+            ExportProgress progress(exportProgress_, progressBase, progressSpan, exportTickTotal(symbols));
+
+            // Files are independent: one per worker at a time
+            bool ok = forEachExportSymbol(symbols.size(), [&](size_t index) {
+                const ExportSymbol& s = symbols[index];
+                std::ofstream file(dir + "/" + *s.symbol + ".csv", std::ios::binary);
+                if (!file.is_open()) return false;
+
+                FormatBuffer out(file);
+                out.put("tick,open,high,low,close,volume\n");
+
+                bool ok = forEachExportTick(s, progress, cancel, [&out](const TickData& td) {
+                    out.putUInt(td.tick).put(',')
+                       .putFixed(td.open, 4).put(',')
+                       .putFixed(td.high, 4).put(',')
+                       .putFixed(td.low, 4).put(',')
+                       .putFixed(td.close, 4).put(',')
+                       .putFixed(td.volume, 2).put('\n');
+                    return true;
+                });
+                if (!ok || !out.flush()) return false;
+                file.close();
+                return !file.fail();
+            });
+            if (!ok) return false;
+
+            std::ofstream metaFile(dir + "/metadata.json");
+            metaFile << "{\"totalTicks\":" << snapshot.currentTick
+                     << ",\"exportedTicks\":" << limit
+                     << ",\"commodities\":" << snapshot.ticks.size()
+                     << ",\"exportedAt\":\"" << getCurrentTimestamp() << "\"}\n";
+            metaFile.close();
+
+            return true;
+        }
+
+        bool writeArrow(const ExportSnapshot& snapshot, const std::string& dir, size_t maxTicks,
+            double progressBase, double progressSpan, const std::atomic<bool>* cancel) {
+            using Type = ArrowIpcWriter::Type;
+            std::error_code ec;
+            std::filesystem::create_directories(dir, ec);
+            size_t limit = (maxTicks > 0) ? std::min<uint64_t>(maxTicks, snapshot.currentTick) : snapshot.currentTick;
+            auto symbols = exportSymbols(snapshot, limit);
+            ExportProgress progress(exportProgress_, progressBase, progressSpan, exportTickTotal(symbols));
+
+            bool ok = forEachExportSymbol(symbols.size(), [&](size_t index) {
+                const ExportSymbol& s = symbols[index];
+                ArrowIpcWriter out(dir + "/" + *s.symbol + ".arrow", {
+                    { "tick", Type::UINT64 }, { "open", Type::FLOAT32 }, { "high", Type::FLOAT32 },
+                    { "low", Type::FLOAT32 }, { "close", Type::FLOAT32 }, { "volume", Type::FLOAT32 } });
+                if (!out.isOpen()) return false;
+
+                bool ok = forEachExportTick(s, progress, cancel, [&out](const TickData& td) {
+                    out.appendUInt64(0, td.tick);
+                    out.appendFloat32(1, static_cast<float>(td.open));
+                    out.appendFloat32(2, static_cast<float>(td.high));
+                    out.appendFloat32(3, static_cast<float>(td.low));
+                    out.appendFloat32(4, static_cast<float>(td.close));
+                    out.appendFloat32(5, static_cast<float>(td.volume));
+                    return out.pendingRows() < EXPORT_BATCH_TICKS || out.writeBatch();
+                });
+                return ok && out.close();
+            });
+            if (!ok) return false;
+
+            ArrowIpcWriter news(dir + "/news.arrow", {
+                { "tick", Type::UINT64 }, { "symbol", Type::UTF8 }, { "category", Type::UTF8 },
+                { "sentiment", Type::UTF8 }, { "magnitude", Type::FLOAT64 }, { "headline", Type::UTF8 } });
+            if (!news.isOpen()) return false;
+            for (size_t i = 0, end = snapshot.news.lowerBound(limit); i < end; ++i) {
+                auto ne = snapshot.news[i];
+                news.appendUInt64(0, ne.tick);
+                news.appendString(1, ne.symbol);
+                news.appendString(2, ne.category);
+                news.appendString(3, ne.sentiment);
+                news.appendFloat64(4, ne.magnitude);
+                news.appendString(5, ne.headline);
+                if (news.pendingRows() == EXPORT_BATCH_TICKS && !news.writeBatch()) return false;
+            }
+            return news.close();
+        }
+
+        // Moves full chunks into the store a segment at a time; storage lock held
+        void spillFull() {
+            if (!store_) return;
+            for (auto& [symbol, tickData] : ticks_) {
+                size_t& spilled = spilledChunks_[symbol];
+                const auto& chunks = tickData.chunks();
+                size_t full = tickData.size() / TickSeries::CHUNK_TICKS;
+                while (full - spilled >= tickstore::CHUNKS_PER_SEGMENT) {
+                    std::vector<std::shared_ptr<TickChunk>> segment(chunks.begin() + spilled,
+                        chunks.begin() + spilled + tickstore::CHUNKS_PER_SEGMENT);
+                    auto mapped = store_->append(symbol, segment);
+                    if (mapped.empty()) {
+                        // Retried at the next batch; the chunks stay in memory meanwhile
+                        storeErrors_.fetch_add(1, std::memory_order_relaxed);
+                        break;
+                    }
+                    for (size_t i = 0; i < mapped.size(); ++i) tickData.replaceChunk(spilled + i, mapped[i]);
+                    spilled += mapped.size();
+                }
+            }
+        }
+
+        // Compresses full in-memory chunks; storage lock held. Chunks
+        // compress in order, so after a batch only the newly filled ones are
+        // left: walking back from the last full chunk stops at a compressed
+        // one, unless `all` asks for every chunk.
+        void compressFull(bool all) {
+            if (!compression_ || store_) return;
+            for (auto& [symbol, tickData] : ticks_) {
+                const auto& chunks = tickData.chunks();
+                for (size_t i = tickData.size() / TickSeries::CHUNK_TICKS; i-- > 0;) {
+                    const TickChunk& chunk = *chunks[i];
+                    if (chunk.isCompressed() || chunk.isMapped()) {
+                        if (all) continue;
+                        break;
+                    }
+                    tickData.replaceChunk(i, TickChunk::compress(chunk));
                 }
             }
-            return result;
         }
 
         std::string getCurrentTimestamp() const {
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace market {
+
+    // Bit-level codecs for compressed TickChunks, after Facebook's Gorilla:
+    // floats are stored as the XOR with a reference value (the previous one
+    // of the column, or a related column of the same tick), so unchanged
+    // values cost a single bit and small moves only their differing middle
+    // bits; tick indexes are stored as the change in their delta.
+    namespace tickcodec {
+
+        inline uint64_t lowMask(unsigned bits) { return bits >= 64 ? ~uint64_t(0) : (uint64_t(1) << bits) - 1; }
+
+        inline uint32_t floatBits(float f) {
+            uint32_t bits;
+            std::memcpy(&bits, &f, sizeof(bits));
+            return bits;
+        }
+
+        inline float bitsFloat(uint32_t bits) {
+            float f;
+            std::memcpy(&f, &bits, sizeof(f));
+            return f;
+        }
+
+        // Appends bit fields, most significant bit first, to 64-bit words
+        class BitWriter {
+        public:
+            void write(uint64_t value, unsigned bits) {
+                if (bits == 0) return;
+                value &= lowMask(bits);
+                unsigned used = static_cast<unsigned>(size_ % 64);
+                if (used == 0) words_.push_back(0);
+                unsigned free = 64 - used;
+                if (bits <= free) {
+                    words_.back() |= value << (free - bits);
+                }
+                else {
+                    words_.back() |= value >> (bits - free);
+                    words_.push_back(value << (64 - (bits - free)));
+                }
+                size_ += bits;
+            }
+
+            const std::vector<uint64_t>& words() const { return words_; }
+
+        private:
+            std::vector<uint64_t> words_;
+            size_t size_ = 0;  // In bits
+        };
+
+        // Reads back what a BitWriter wrote, starting at `words`, through a
+        // 64-bit buffer refilled a word at a time
+        class BitReader {
+        public:
+            explicit BitReader(const uint64_t* words = nullptr) : next_(words) {}
+
+            uint64_t read(unsigned bits) {
+                if (bits == 0) return 0;
+                if (bits <= available_) return take(bits);
+                unsigned rest = bits - available_;
+                uint64_t high = available_ > 0 ? take(available_) : 0;
+                buffer_ = *next_++;
+                available_ = 64;
+                uint64_t low = take(rest);
+                return rest == 64 ? low : (high << rest) | low;
+            }
+
+            bool readBit() { return read(1) != 0; }
+
+        private:
+            const uint64_t* next_;
+            uint64_t buffer_ = 0;     // Unread bits, left-aligned
+            unsigned available_ = 0;
+
+            uint64_t take(unsigned bits) {
+                uint64_t value = buffer_ >> (64 - bits);
+                buffer_ = bits == 64 ? 0 : buffer_ << bits;
+                available_ -= bits;
+                return value;
+            }
+        };
+
+        // 32-bit values as their XOR with a reference: '0' if equal, '10' and
+        // the bits inside the previous leading/trailing-zero window if they
+        // fit it, else '11', 5 bits of leading zeros, 5 bits of length - 1
+        // and the meaningful bits, which become the new window
+        class XorEncoder {
+        public:
+            void encode(BitWriter& out, uint32_t value, uint32_t reference) {
+                uint32_t x = value ^ reference;
+                if (x == 0) {
+                    out.write(0, 1);
+                    return;
+                }
+                unsigned leading = static_cast<unsigned>(__builtin_clz(x));
+                unsigned trailing = static_cast<unsigned>(__builtin_ctz(x));
+                if (hasWindow_ && leading >= leading_ && trailing >= trailing_) {
+                    out.write(0b10, 2);
+                    out.write(x >> trailing_, 32 - leading_ - trailing_);
+                    return;
+                }
+                unsigned length = 32 - leading - trailing;
+                out.write(0b11, 2);
+                out.write(leading, 5);
+                out.write(length - 1, 5);
+                out.write(x >> trailing, length);
+                leading_ = leading;
+                trailing_ = trailing;
+                hasWindow_ = true;
+            }
+
+        private:
+            unsigned leading_ = 0;
+            unsigned trailing_ = 0;
+            bool hasWindow_ = false;
+        };
+
+        class XorDecoder {
+        public:
+            uint32_t decode(BitReader& in, uint32_t reference) {
+                if (!in.readBit()) return reference;
+                if (in.readBit()) {
+                    leading_ = static_cast<unsigned>(in.read(5));
+                    unsigned length = static_cast<unsigned>(in.read(5)) + 1;
+                    trailing_ = 32 - leading_ - length;
+                }
+                uint32_t x = static_cast<uint32_t>(in.read(32 - leading_ - trailing_)) << trailing_;
+                return reference ^ x;
+            }
+
+        private:
+            unsigned leading_ = 0;
+            unsigned trailing_ = 0;
+        };
+
+        // Increasing tick indexes, by delta-of-delta from the first (which
+        // the chunk header holds) with a starting delta of 1: '0' for the same
+        // delta, then '10', '110', '1110' with a 7, 9 or 12-bit biased
+        // difference, and '1111' with the full 64 bits
+        class DeltaEncoder {
+        public:
+            explicit DeltaEncoder(uint64_t first) : prev_(first) {}
+
+            void encode(BitWriter& out, uint64_t tick) {
+                uint64_t delta = tick - prev_;
+                int64_t dod = static_cast<int64_t>(delta - delta_);
+                prev_ = tick;
+                delta_ = delta;
+                if (dod == 0) out.write(0, 1);
+                else if (dod >= -63 && dod <= 64) { out.write(0b10, 2); out.write(static_cast<uint64_t>(dod + 63), 7); }
+                else if (dod >= -255 && dod <= 256) { out.write(0b110, 3); out.write(static_cast<uint64_t>(dod + 255), 9); }
+                else if (dod >= -2047 && dod <= 2048) { out.write(0b1110, 4); out.write(static_cast<uint64_t>(dod + 2047), 12); }
+                else { out.write(0b1111, 4); out.write(static_cast<uint64_t>(dod), 64); }
+            }
+
+        private:
+            uint64_t prev_;
+            uint64_t delta_ = 1;
+        };
+
+        class DeltaDecoder {
+        public:
+            explicit DeltaDecoder(uint64_t first = 0) : prev_(first) {}
+
+            uint64_t decode(BitReader& in) {
+                int64_t dod;
+                if (!in.readBit()) dod = 0;
+                else if (!in.readBit()) dod = static_cast<int64_t>(in.read(7)) - 63;
+                else if (!in.readBit()) dod = static_cast<int64_t>(in.read(9)) - 255;
+                else if (!in.readBit()) dod = static_cast<int64_t>(in.read(12)) - 2047;
+                else dod = static_cast<int64_t>(in.read(64));
+                delta_ += static_cast<uint64_t>(dod);
+                prev_ += delta_;
+                return prev_;
+            }
+
+        private:
+            uint64_t prev_;
+            uint64_t delta_ = 1;
+        };
+
+    } // namespace tickcodec
+
+} // namespace market
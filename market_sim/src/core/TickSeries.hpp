@@ -0,0 +1,415 @@
+#pragma once
+
+#include "Types.hpp"
+#include "TickCodec.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+namespace market {
+
+    struct TickData {
+        uint64_t tick;
+        Price open;
+        Price high;
+        Price low;
+        Price close;
+        double volume;
+    };
+
+    // Up to CHUNK_TICKS ticks of one symbol, by column. Prices and volume are
+    // kept as float. Columns that carry no information are left out until a
+    // tick needs them: the tick column while ticks are consecutive,
+    // open/high/low while they equal close, and volume while it is zero, so
+    // flat, volume-less ticks cost 4 bytes each.
+    //
+    // A chunk either owns its columns and is appended to, is a read-only
+    // view of a full chunk inside a TickStore segment mapping, which it
+    // keeps alive, or is a read-only compressed copy (compress()): each
+    // present column as a bit stream (see TickCodec.hpp), close XORed with
+    // the previous close, open/high/low with their tick's close, volume with
+    // the previous volume, ticks by delta-of-delta. Those decode in order
+    // only, so at() on one decodes up to the tick; walk it with forEach().
+    // serialize() writes the layout a view reads, whatever the chunk is.
+    class TickChunk {
+    public:
+        static constexpr size_t CHUNK_TICKS = 4096;
+
+        TickChunk() = default;
+        TickChunk(const TickChunk& other) {
+            // A copy owns its columns, whatever the original was
+            other.forEach(0, other.size_, [this](const TickData& td) { push_back(td); });
+        }
+        TickChunk& operator=(const TickChunk&) = delete;
+
+        size_t size() const { return size_; }
+        bool full() const { return size_ == CHUNK_TICKS; }
+        bool isMapped() const { return mapping_ != nullptr; }
+        bool isCompressed() const { return compressed_; }
+
+        TickData at(size_t i) const {
+            if (compressed_) {
+                Decoder decoder(*this);
+                for (size_t j = 0; j < i; ++j) decoder.next();
+                return decoder.next();
+            }
+            Price close = closeData()[i];
+            const float* open = openData();
+            return TickData{
+                ticksData() ? ticksData()[i] : firstTick_ + i,
+                open ? open[i] : close,
+                open ? highData()[i] : close,
+                open ? lowData()[i] : close,
+                close,
+                volumeData() ? volumeData()[i] : 0.0
+            };
+        }
+
+        // Calls fn(const TickData&) for ticks [begin, end)
+        template <typename Fn>
+        void forEach(size_t begin, size_t end, Fn&& fn) const {
+            end = std::min(end, size_);
+            if (compressed_) {
+                Decoder decoder(*this);
+                for (size_t i = 0; i < end; ++i) {
+                    TickData td = decoder.next();
+                    if (i >= begin) fn(td);
+                }
+                return;
+            }
+            for (size_t i = begin; i < end; ++i) fn(at(i));
+        }
+
+        // Compressed copy of `source`, which reads the same ticks (as
+        // float prices and volume, like any chunk)
+        static std::shared_ptr<TickChunk> compress(const TickChunk& source) {
+            using namespace tickcodec;
+            auto chunk = std::make_shared<TickChunk>();
+            chunk->firstTick_ = source.firstTick_;
+            chunk->size_ = source.size_;
+            chunk->compressed_ = true;
+            uint32_t columns = source.presentColumns();
+            chunk->hasTicks_ = (columns & TICKS) != 0;
+            chunk->hasOhlc_ = (columns & OHLC) != 0;
+            chunk->hasVolume_ = (columns & VOLUME) != 0;
+
+            std::array<BitWriter, STREAMS> out;
+            std::array<XorEncoder, STREAMS> xors;
+            DeltaEncoder ticks(source.firstTick_);
+            uint32_t close = 0;
+            uint32_t volume = 0;
+            size_t i = 0;
+            source.forEach(0, source.size_, [&](const TickData& td) {
+                if (chunk->hasTicks_ && i++ > 0) ticks.encode(out[TICK_STREAM], td.tick);
+                uint32_t prevClose = close;
+                close = floatBits(static_cast<float>(td.close));
+                xors[CLOSE_STREAM].encode(out[CLOSE_STREAM], close, prevClose);
+                if (chunk->hasOhlc_) {
+                    xors[OPEN_STREAM].encode(out[OPEN_STREAM], floatBits(static_cast<float>(td.open)), close);
+                    xors[HIGH_STREAM].encode(out[HIGH_STREAM], floatBits(static_cast<float>(td.high)), close);
+                    xors[LOW_STREAM].encode(out[LOW_STREAM], floatBits(static_cast<float>(td.low)), close);
+                }
+                if (chunk->hasVolume_) {
+                    uint32_t prevVolume = volume;
+                    volume = floatBits(static_cast<float>(td.volume));
+                    xors[VOLUME_STREAM].encode(out[VOLUME_STREAM], volume, prevVolume);
+                }
+            });
+
+            // One allocation; each stream starts on a word
+            size_t words = 0;
+            for (const auto& stream : out) words += stream.words().size();
+            chunk->packed_.reserve(words);
+            for (size_t s = 0; s < STREAMS; ++s) {
+                chunk->streamStart_[s] = static_cast<uint32_t>(chunk->packed_.size());
+                chunk->packed_.insert(chunk->packed_.end(), out[s].words().begin(), out[s].words().end());
+            }
+            return chunk;
+        }
+
+        void push_back(const TickData& td) {
+            size_t n = close_.size();
+            if (n == 0) {
+                firstTick_ = td.tick;
+                close_.reserve(CHUNK_TICKS);
+            }
+
+            if (!hasTicks_ && td.tick != firstTick_ + n) {
+                hasTicks_ = true;
+                ticks_.reserve(CHUNK_TICKS);
+                for (size_t i = 0; i < n; ++i) ticks_.push_back(firstTick_ + i);
+            }
+            if (hasTicks_) ticks_.push_back(td.tick);
+
+            float close = static_cast<float>(td.close);
+            float open = static_cast<float>(td.open);
+            float high = static_cast<float>(td.high);
+            float low = static_cast<float>(td.low);
+            if (!hasOhlc_ && (open != close || high != close || low != close)) {
+                hasOhlc_ = true;
+                for (auto* column : { &open_, &high_, &low_ }) {
+                    column->reserve(CHUNK_TICKS);
+                    column->assign(close_.begin(), close_.end());
+                }
+            }
+            if (hasOhlc_) {
+                open_.push_back(open);
+                high_.push_back(high);
+                low_.push_back(low);
+            }
+
+            float volume = static_cast<float>(td.volume);
+            if (!hasVolume_ && volume != 0.0f) {
+                hasVolume_ = true;
+                volume_.reserve(CHUNK_TICKS);
+                volume_.assign(n, 0.0f);
+            }
+            if (hasVolume_) volume_.push_back(volume);
+
+            close_.push_back(close);
+            size_ = close_.size();
+        }
+
+        // Bytes held in memory by an owning or compressed chunk; a mapped
+        // one counts as its header
+        size_t memoryBytes() const {
+            return sizeof(TickChunk) + (ticks_.capacity() + packed_.capacity()) * sizeof(uint64_t)
+                + (close_.capacity() + open_.capacity() + high_.capacity() + low_.capacity()
+                    + volume_.capacity()) * sizeof(float);
+        }
+
+        // On-disk layout: a 16-byte header, then the present columns, each
+        // padded to 8 bytes: ticks (uint64), close, open, high, low, volume (float)
+        size_t serializedSize() const {
+            return compressed_ ? TickChunk(*this).serializedSize() : serializedSize(presentColumns());
+        }
+
+        void serialize(std::ostream& out) const {
+            if (compressed_) {
+                TickChunk(*this).serialize(out);
+                return;
+            }
+            uint32_t columns = presentColumns();
+            uint32_t count = static_cast<uint32_t>(size_);
+            out.write(reinterpret_cast<const char*>(&firstTick_), sizeof(firstTick_));
+            out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+            out.write(reinterpret_cast<const char*>(&columns), sizeof(columns));
+            if (columns & TICKS) out.write(reinterpret_cast<const char*>(ticksData()), size_ * 8);
+            writeFloats(out, closeData());
+            if (columns & OHLC) {
+                writeFloats(out, openData());
+                writeFloats(out, highData());
+                writeFloats(out, lowData());
+            }
+            if (columns & VOLUME) writeFloats(out, volumeData());
+        }
+
+        // View of a chunk serialized at `data`, which holds `available` bytes
+        // and stays valid while `mapping` lives. nullptr if it does not fit.
+        static std::shared_ptr<TickChunk> view(const char* data, size_t available,
+            std::shared_ptr<const void> mapping) {
+            if (available < HEADER_BYTES) return nullptr;
+            auto chunk = std::make_shared<TickChunk>();
+            uint32_t count = 0;
+            uint32_t columns = 0;
+            std::memcpy(&chunk->firstTick_, data, 8);
+            std::memcpy(&count, data + 8, 4);
+            std::memcpy(&columns, data + 12, 4);
+            if (count == 0 || count > CHUNK_TICKS) return nullptr;
+
+            chunk->size_ = count;
+            chunk->mapping_ = std::move(mapping);
+            if (chunk->serializedSize(columns) > available) return nullptr;
+
+            const char* at = data + HEADER_BYTES;
+            if (columns & TICKS) { chunk->mTicks_ = reinterpret_cast<const uint64_t*>(at); at += count * 8; }
+            chunk->mClose_ = reinterpret_cast<const float*>(at); at += padded(count * 4);
+            if (columns & OHLC) {
+                chunk->mOpen_ = reinterpret_cast<const float*>(at); at += padded(count * 4);
+                chunk->mHigh_ = reinterpret_cast<const float*>(at); at += padded(count * 4);
+                chunk->mLow_ = reinterpret_cast<const float*>(at); at += padded(count * 4);
+            }
+            if (columns & VOLUME) chunk->mVolume_ = reinterpret_cast<const float*>(at);
+            return chunk;
+        }
+
+    private:
+        static constexpr size_t HEADER_BYTES = 16;
+        static constexpr uint32_t TICKS = 1, OHLC = 2, VOLUME = 4;  // Column flags
+        enum Stream : size_t { TICK_STREAM, CLOSE_STREAM, OPEN_STREAM, HIGH_STREAM, LOW_STREAM, VOLUME_STREAM, STREAMS };
+
+        uint64_t firstTick_ = 0;
+        size_t size_ = 0;
+        std::vector<uint64_t> ticks_;  // Unused while ticks run firstTick_, firstTick_ + 1, ...
+        std::vector<float> close_;
+        std::vector<float> open_;      // open_, high_, low_: unused while equal to close_
+        std::vector<float> high_;
+        std::vector<float> low_;
+        std::vector<float> volume_;    // Unused while zero
+        bool hasTicks_ = false;        // Whether the optional columns are in use
+        bool hasOhlc_ = false;
+        bool hasVolume_ = false;
+
+        // Set on a mapped view instead of the vectors
+        std::shared_ptr<const void> mapping_;
+        const uint64_t* mTicks_ = nullptr;
+        const float* mClose_ = nullptr;
+        const float* mOpen_ = nullptr;
+        const float* mHigh_ = nullptr;
+        const float* mLow_ = nullptr;
+        const float* mVolume_ = nullptr;
+
+        // Set on a compressed chunk instead of the vectors, with the has* flags
+        bool compressed_ = false;
+        std::vector<uint64_t> packed_;              // Every stream, back to back
+        std::array<uint32_t, STREAMS> streamStart_{};  // Word where each starts
+
+        // Reads a compressed chunk's ticks in order
+        class Decoder {
+        public:
+            explicit Decoder(const TickChunk& chunk) : chunk_(chunk), ticks_(chunk.firstTick_), tick_(chunk.firstTick_) {
+                for (size_t s = 0; s < STREAMS; ++s) {
+                    in_[s] = tickcodec::BitReader(chunk.packed_.data() + chunk.streamStart_[s]);
+                }
+            }
+
+            TickData next() {
+                using tickcodec::bitsFloat;
+                TickData td;
+                td.tick = index_ == 0 ? chunk_.firstTick_
+                    : chunk_.hasTicks_ ? ticks_.decode(in_[TICK_STREAM]) : tick_ + 1;
+                tick_ = td.tick;
+                index_++;
+                close_ = xors_[CLOSE_STREAM].decode(in_[CLOSE_STREAM], close_);
+                td.close = bitsFloat(close_);
+                if (chunk_.hasOhlc_) {
+                    td.open = bitsFloat(xors_[OPEN_STREAM].decode(in_[OPEN_STREAM], close_));
+                    td.high = bitsFloat(xors_[HIGH_STREAM].decode(in_[HIGH_STREAM], close_));
+                    td.low = bitsFloat(xors_[LOW_STREAM].decode(in_[LOW_STREAM], close_));
+                }
+                else {
+                    td.open = td.high = td.low = td.close;
+                }
+                if (chunk_.hasVolume_) volume_ = xors_[VOLUME_STREAM].decode(in_[VOLUME_STREAM], volume_);
+                td.volume = chunk_.hasVolume_ ? bitsFloat(volume_) : 0.0;
+                return td;
+            }
+
+        private:
+            const TickChunk& chunk_;
+            std::array<tickcodec::BitReader, STREAMS> in_;
+            std::array<tickcodec::XorDecoder, STREAMS> xors_;
+            tickcodec::DeltaDecoder ticks_;
+            uint64_t tick_;
+            size_t index_ = 0;
+            uint32_t close_ = 0;
+            uint32_t volume_ = 0;
+        };
+
+        const uint64_t* ticksData() const { return mapping_ ? mTicks_ : (hasTicks_ ? ticks_.data() : nullptr); }
+        const float* closeData() const { return mapping_ ? mClose_ : close_.data(); }
+        const float* openData() const { return mapping_ ? mOpen_ : (hasOhlc_ ? open_.data() : nullptr); }
+        const float* highData() const { return mapping_ ? mHigh_ : high_.data(); }
+        const float* lowData() const { return mapping_ ? mLow_ : low_.data(); }
+        const float* volumeData() const { return mapping_ ? mVolume_ : (hasVolume_ ? volume_.data() : nullptr); }
+
+        // Compressed chunks have no column data; their flags say what was stored
+        uint32_t presentColumns() const {
+            if (compressed_) {
+                return (hasTicks_ ? TICKS : 0u) | (hasOhlc_ ? OHLC : 0u) | (hasVolume_ ? VOLUME : 0u);
+            }
+            return (ticksData() ? TICKS : 0u) | (openData() ? OHLC : 0u) | (volumeData() ? VOLUME : 0u);
+        }
+
+        size_t serializedSize(uint32_t columns) const {
+            return HEADER_BYTES + ((columns & TICKS) ? size_ * 8 : 0) + padded(size_ * 4)
+                + ((columns & OHLC) ? 3 * padded(size_ * 4) : 0) + ((columns & VOLUME) ? padded(size_ * 4) : 0);
+        }
+
+        static size_t padded(size_t bytes) { return (bytes + 7) & ~size_t(7); }
+
+        void writeFloats(std::ostream& out, const float* column) const {
+            static const char zeros[8] = {};
+            out.write(reinterpret_cast<const char*>(column), size_ * 4);
+            out.write(zeros, padded(size_ * 4) - size_ * 4);
+        }
+    };
+
+    // Append-only tick series: a list of TickChunks. Full chunks never change
+    // again, so forks share them; only the open tail chunk is copied, by
+    // whichever side appends to it first after the fork. Full chunks may be
+    // swapped for mapped views of the same data (TickStore), which read the
+    // same, or compressed ones (TickBuffer::setCompression). Random access
+    // goes straight to a tick's chunk, but a compressed chunk decodes from
+    // its start; forEach() decodes each chunk once.
+    class TickSeries {
+    public:
+        static constexpr size_t CHUNK_TICKS = TickChunk::CHUNK_TICKS;
+
+        size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+        TickData operator[](size_t i) const { return chunks_[i / CHUNK_TICKS]->at(i % CHUNK_TICKS); }
+
+        // Room for the chunk pointers only; columns grow a chunk at a time
+        void reserve(size_t ticks) { chunks_.reserve((ticks + CHUNK_TICKS - 1) / CHUNK_TICKS); }
+
+        void push_back(const TickData& td) {
+            if (chunks_.empty() || chunks_.back()->full()) {
+                chunks_.push_back(std::make_shared<TickChunk>());
+            }
+            else if (tailShared_) {
+                chunks_.back() = std::make_shared<TickChunk>(*chunks_.back());
+            }
+            tailShared_ = false;
+            chunks_.back()->push_back(td);
+            size_++;
+        }
+
+        // Calls fn(const TickData&) for ticks [begin, end), a chunk at a time
+        template <typename Fn>
+        void forEach(size_t begin, size_t end, Fn&& fn) const {
+            end = std::min(end, size_);
+            while (begin < end) {
+                const TickChunk& chunk = *chunks_[begin / CHUNK_TICKS];
+                size_t offset = begin % CHUNK_TICKS;
+                size_t stop = std::min(chunk.size(), offset + (end - begin));
+                chunk.forEach(offset, stop, fn);
+                begin += stop - offset;
+            }
+        }
+
+        // Copy sharing every chunk with this series; see the class comment
+        TickSeries fork() const {
+            tailShared_ = true;
+            return *this;
+        }
+
+        const std::vector<std::shared_ptr<TickChunk>>& chunks() const { return chunks_; }
+
+        // Appends a full chunk, such as a mapped one read back from a TickStore
+        void appendChunk(std::shared_ptr<TickChunk> chunk) {
+            size_ += chunk->size();
+            chunks_.push_back(std::move(chunk));
+        }
+
+        // Replaces chunk `i` with one holding the same ticks
+        void replaceChunk(size_t i, std::shared_ptr<TickChunk> chunk) { chunks_[i] = std::move(chunk); }
+
+        // Bytes held in memory by the chunks (shared ones included, mappings not)
+        size_t memoryBytes() const {
+            size_t bytes = chunks_.capacity() * sizeof(chunks_[0]);
+            for (const auto& chunk : chunks_) bytes += chunk->memoryBytes();
+            return bytes;
+        }
+
+    private:
+        std::vector<std::shared_ptr<TickChunk>> chunks_;
+        size_t size_ = 0;
+        mutable bool tailShared_ = false;  // The last chunk is also a fork's
+    };
+
+} // namespace market
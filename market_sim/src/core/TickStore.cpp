@@ -0,0 +1,256 @@
+#include "TickStore.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace market {
+
+    namespace {
+        constexpr size_t HEADER_BYTES = sizeof(tickstore::MAGIC) + 2 * sizeof(uint32_t);
+        constexpr const char* TAIL_FILE = "tail.seg";
+
+        // A read-only view of a whole file, valid while `owner` lives
+        struct MappedFile {
+            std::shared_ptr<const void> owner;
+            const char* data = nullptr;
+            size_t size = 0;
+        };
+
+#ifndef _WIN32
+        struct Mapping {
+            void* address = nullptr;
+            size_t size = 0;
+            ~Mapping() { if (address) munmap(address, size); }
+        };
+
+        bool mapFile(const std::string& path, MappedFile& out) {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) return false;
+            struct stat st {};
+            if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+                ::close(fd);
+                return false;
+            }
+            size_t size = static_cast<size_t>(st.st_size);
+            void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (address == MAP_FAILED) return false;
+
+            auto mapping = std::make_shared<Mapping>();
+            mapping->address = address;
+            mapping->size = size;
+            out.data = static_cast<const char*>(address);
+            out.size = size;
+            out.owner = mapping;
+            return true;
+        }
+#else
+        // No mmap: read the file into memory instead
+        bool mapFile(const std::string& path, MappedFile& out) {
+            std::ifstream file(path, std::ios::binary | std::ios::ate);
+            if (!file.is_open()) return false;
+            auto contents = std::make_shared<std::vector<char>>(static_cast<size_t>(file.tellg()));
+            file.seekg(0);
+            if (contents->empty() || !file.read(contents->data(), contents->size())) return false;
+            out.data = contents->data();
+            out.size = contents->size();
+            out.owner = contents;
+            return true;
+        }
+#endif
+
+        // The chunks of a segment file, pointing into its mapping
+        bool readSegment(const std::string& path, std::vector<std::shared_ptr<TickChunk>>& chunks, size_t& bytes) {
+            MappedFile file;
+            if (!mapFile(path, file) || file.size < HEADER_BYTES) return false;
+            if (std::memcmp(file.data, tickstore::MAGIC, sizeof(tickstore::MAGIC)) != 0) return false;
+            uint32_t version = 0;
+            uint32_t count = 0;
+            std::memcpy(&version, file.data + sizeof(tickstore::MAGIC), sizeof(version));
+            std::memcpy(&count, file.data + sizeof(tickstore::MAGIC) + sizeof(version), sizeof(count));
+            if (version != tickstore::VERSION) return false;
+
+            chunks.clear();
+            size_t offset = HEADER_BYTES;
+            for (uint32_t i = 0; i < count; ++i) {
+                auto chunk = TickChunk::view(file.data + offset, file.size - offset, file.owner);
+                if (!chunk) return false;
+                offset += chunk->serializedSize();
+                chunks.push_back(std::move(chunk));
+            }
+            bytes = file.size;
+            return true;
+        }
+    }
+
+    TickStore::TickStore(const std::string& directory)
+        : directory_(directory)
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(directory_, ec);
+        if (!std::filesystem::is_directory(directory_)) {
+            throw std::runtime_error("Cannot create tick store directory: " + directory_);
+        }
+    }
+
+    std::string TickStore::symbolDirectory(const std::string& symbol) const {
+        return (std::filesystem::path(directory_) / symbol).string();
+    }
+
+    size_t TickStore::load(const std::string& symbol, TickSeries& into) {
+        into = TickSeries();
+        std::filesystem::path dir(symbolDirectory(symbol));
+        std::error_code ec;
+        if (!std::filesystem::is_directory(dir, ec)) return 0;
+
+        std::vector<std::filesystem::path> files;
+        for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+            if (entry.path().extension() == ".seg" && entry.path().filename() != TAIL_FILE) {
+                files.push_back(entry.path());
+            }
+        }
+        // Zero-padded sequence numbers sort in write order
+        std::sort(files.begin(), files.end());
+
+        uint64_t next = 0;
+        std::vector<std::shared_ptr<TickChunk>> chunks;
+        for (const auto& path : files) {
+            next = std::max<uint64_t>(next, std::strtoull(path.stem().string().c_str(), nullptr, 10) + 1);
+            size_t bytes = 0;
+            // TickSeries indexes by position, so a missing or partial segment
+            // would shift every later tick: refuse the history instead
+            if (!readSegment(path.string(), chunks, bytes) ||
+                !std::all_of(chunks.begin(), chunks.end(), [](const auto& chunk) { return chunk->full(); })) {
+                throw std::runtime_error("Unreadable tick store segment: " + path.string());
+            }
+            for (const auto& chunk : chunks) into.appendChunk(chunk);
+            addSegment(symbol, path.string(), chunks, bytes);
+        }
+        nextSegment_[symbol] = next;
+        size_t mapped = into.chunks().size();
+
+        // The tail is copied into memory, where recording continues
+        std::string tailPath = (dir / TAIL_FILE).string();
+        size_t bytes = 0;
+        if (readSegment(tailPath, chunks, bytes)) {
+            for (const auto& chunk : chunks) {
+                for (size_t i = 0; i < chunk->size(); ++i) into.push_back(chunk->at(i));
+            }
+        }
+        std::filesystem::remove(tailPath, ec);
+        return mapped;
+    }
+
+    std::vector<std::shared_ptr<TickChunk>> TickStore::append(const std::string& symbol,
+        const std::vector<std::shared_ptr<TickChunk>>& chunks) {
+        std::filesystem::path dir(symbolDirectory(symbol));
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+
+        uint64_t& next = nextSegment_[symbol];
+        std::ostringstream name;
+        name << std::setw(8) << std::setfill('0') << next << ".seg";
+        std::string path = (dir / name.str()).string();
+        if (!writeSegment(path, chunks)) return {};
+        next++;
+
+        std::vector<std::shared_ptr<TickChunk>> mapped;
+        size_t bytes = 0;
+        if (!readSegment(path, mapped, bytes) || mapped.size() != chunks.size()) return {};
+        addSegment(symbol, path, mapped, bytes);
+        return mapped;
+    }
+
+    bool TickStore::writeTail(const std::string& symbol, const TickSeries& series, size_t fromChunk) {
+        std::filesystem::path dir(symbolDirectory(symbol));
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+        const auto& all = series.chunks();
+        std::vector<std::shared_ptr<TickChunk>> tail(all.begin() + std::min(fromChunk, all.size()), all.end());
+        std::string path = (dir / TAIL_FILE).string();
+        if (tail.empty()) {
+            std::filesystem::remove(path, ec);
+            return true;
+        }
+        return writeSegment(path, tail);
+    }
+
+    void TickStore::clear() {
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(directory_, ec)) {
+            if (entry.is_directory()) std::filesystem::remove_all(entry.path(), ec);
+        }
+        nextSegment_.clear();
+        std::lock_guard<std::mutex> lock(indexMutex_);
+        segments_.clear();
+        mappedBytes_ = 0;
+    }
+
+    std::vector<TickStore::Segment> TickStore::getSegments() const {
+        std::lock_guard<std::mutex> lock(indexMutex_);
+        return segments_;
+    }
+
+    size_t TickStore::getSegmentCount() const {
+        std::lock_guard<std::mutex> lock(indexMutex_);
+        return segments_.size();
+    }
+
+    size_t TickStore::getMappedBytes() const {
+        std::lock_guard<std::mutex> lock(indexMutex_);
+        return mappedBytes_;
+    }
+
+    bool TickStore::writeSegment(const std::string& path, const std::vector<std::shared_ptr<TickChunk>>& chunks) const {
+        // Written aside and renamed, so a crash never leaves a partial segment
+        std::string temp = path + ".tmp";
+        {
+            std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) return false;
+            uint32_t version = tickstore::VERSION;
+            uint32_t count = static_cast<uint32_t>(chunks.size());
+            file.write(tickstore::MAGIC, sizeof(tickstore::MAGIC));
+            file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+            file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+            for (const auto& chunk : chunks) chunk->serialize(file);
+            if (!file.flush()) return false;
+        }
+        std::error_code ec;
+        std::filesystem::rename(temp, path, ec);
+        if (ec) {
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+        return true;
+    }
+
+    void TickStore::addSegment(const std::string& symbol, const std::string& path,
+        const std::vector<std::shared_ptr<TickChunk>>& chunks, size_t bytes) {
+        Segment segment;
+        segment.symbol = symbol;
+        segment.path = path;
+        segment.bytes = bytes;
+        if (!chunks.empty()) {
+            segment.firstTick = chunks.front()->at(0).tick;
+            segment.lastTick = chunks.back()->at(chunks.back()->size() - 1).tick;
+        }
+        for (const auto& chunk : chunks) segment.ticks += chunk->size();
+
+        std::lock_guard<std::mutex> lock(indexMutex_);
+        segments_.push_back(std::move(segment));
+        mappedBytes_ += bytes;
+    }
+
+} // namespace market
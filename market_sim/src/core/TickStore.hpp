@@ -0,0 +1,85 @@
+#pragma once
+
+#include "TickSeries.hpp"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace market {
+
+    namespace tickstore {
+        inline constexpr char MAGIC[8] = { 'M', 'S', 'I', 'M', 'T', 'S', 'E', 'G' };
+        inline constexpr uint32_t VERSION = 1;
+        inline constexpr size_t CHUNKS_PER_SEGMENT = 16;  // 65536 ticks
+    }
+
+    // Append-only on-disk tick history: per symbol, a directory of numbered
+    // segment files, each a header (magic, version, chunk count) followed by
+    // full TickChunks in their serialized column layout. Segments are written
+    // once, to a temporary name and then renamed, and read back by mapping
+    // the file: the returned chunks point into the mapping, so reads copy
+    // nothing and a reopened store costs one mmap per segment. The open tail
+    // of each series is kept in `tail.seg`, written on close and consumed on
+    // load. segments() is the index of tick ranges per segment.
+    //
+    // Not synchronized except for the index; TickBuffer calls it under its
+    // storage lock.
+    class TickStore {
+    public:
+        struct Segment {
+            std::string symbol;
+            std::string path;
+            uint64_t firstTick = 0;
+            uint64_t lastTick = 0;
+            size_t ticks = 0;
+            size_t bytes = 0;
+        };
+
+        // Creates `directory` if needed. Throws std::runtime_error if it cannot.
+        explicit TickStore(const std::string& directory);
+
+        TickStore(const TickStore&) = delete;
+        TickStore& operator=(const TickStore&) = delete;
+
+        const std::string& getDirectory() const { return directory_; }
+
+        // Replaces `into` with the symbol's stored history: its segments,
+        // mapped, then the saved tail, in memory (the tail file is removed).
+        // Returns the number of leading mapped chunks. Throws
+        // std::runtime_error, leaving `into` incomplete, if a segment cannot
+        // be read.
+        size_t load(const std::string& symbol, TickSeries& into);
+
+        // Writes `chunks` (full, in tick order) as the symbol's next segment
+        // and returns mapped views of them, or nothing if the write failed
+        std::vector<std::shared_ptr<TickChunk>> append(const std::string& symbol,
+            const std::vector<std::shared_ptr<TickChunk>>& chunks);
+
+        // Saves chunks [fromChunk, end) of `series` as the symbol's tail
+        bool writeTail(const std::string& symbol, const TickSeries& series, size_t fromChunk);
+
+        // Deletes every segment and tail; chunks already mapped stay readable
+        void clear();
+
+        std::vector<Segment> getSegments() const;
+        size_t getSegmentCount() const;
+        size_t getMappedBytes() const;
+
+    private:
+        std::string directory_;
+        std::map<std::string, uint64_t> nextSegment_;  // By symbol
+
+        mutable std::mutex indexMutex_;
+        std::vector<Segment> segments_;  // Guarded by indexMutex_
+        size_t mappedBytes_ = 0;         // Guarded by indexMutex_
+
+        std::string symbolDirectory(const std::string& symbol) const;
+        bool writeSegment(const std::string& path, const std::vector<std::shared_ptr<TickChunk>>& chunks) const;
+        void addSegment(const std::string& symbol, const std::string& path,
+            const std::vector<std::shared_ptr<TickChunk>>& chunks, size_t bytes);
+    };
+
+} // namespace market
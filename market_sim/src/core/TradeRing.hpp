@@ -0,0 +1,103 @@
+#pragma once
+
+#include "Types.hpp"
+#include "Checkpoint.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace market {
+
+    // Fixed-capacity ring of the most recent trades. Every trade gets a sequence
+    // number (1, 2, ...) that keeps increasing across clear() and capacity
+    // changes, so a poller can ask for "everything after seq N". Storage is
+    // allocated once; push overwrites the oldest slot when full.
+    class TradeRing {
+    public:
+        explicit TradeRing(size_t capacity = 100000) { setCapacity(capacity); }
+
+        // Keeps the newest min(size, capacity) trades
+        void setCapacity(size_t capacity) {
+            capacity = std::max<size_t>(capacity, 1);
+            if (capacity == slots_.size()) return;
+
+            size_t keep = std::min(count_, capacity);
+            std::vector<Trade> kept;
+            kept.reserve(keep);
+            for (uint64_t seq = lastSeq_ - keep + 1; seq <= lastSeq_; ++seq) {
+                kept.push_back(at(seq));
+            }
+
+            slots_.assign(capacity, Trade{});
+            uint64_t seq = lastSeq_ - keep + 1;
+            for (const Trade& t : kept) {
+                slots_[seq++ % capacity] = t;
+            }
+            count_ = keep;
+        }
+
+        // Returns the trade's sequence number
+        uint64_t push(const Trade& trade) {
+            uint64_t seq = ++lastSeq_;
+            slots_[seq % slots_.size()] = trade;
+            if (count_ < slots_.size()) count_++;
+            return seq;
+        }
+
+        void clear() { count_ = 0; }
+
+        // Held trades and the sequence counter; loading keeps this capacity
+        void writeCheckpoint(CheckpointWriter& out) const {
+            out.write(lastSeq_);
+            out.write(static_cast<uint64_t>(count_));
+            for (uint64_t seq = firstSeq(); seq <= lastSeq_ && count_ > 0; ++seq) out.write(at(seq));
+        }
+
+        void readCheckpoint(CheckpointReader& in) {
+            uint64_t lastSeq = in.read<uint64_t>();
+            size_t count = in.readCount(sizeof(Trade::price));
+            if (count > lastSeq) throw std::runtime_error("Invalid checkpoint: trade log ahead of its sequence");
+
+            count_ = 0;
+            lastSeq_ = lastSeq - count;
+            for (size_t i = 0; i < count; ++i) {
+                Trade trade;
+                in.read(trade);
+                push(trade);
+            }
+        }
+
+        size_t size() const { return count_; }
+        size_t capacity() const { return slots_.size(); }
+        bool empty() const { return count_ == 0; }
+
+        // Sequence range currently held; firstSeq() > lastSeq() when empty
+        uint64_t firstSeq() const { return lastSeq_ - count_ + 1; }
+        uint64_t lastSeq() const { return lastSeq_; }
+
+        // seq must be in [firstSeq(), lastSeq()]
+        const Trade& at(uint64_t seq) const { return slots_[seq % slots_.size()]; }
+
+        // Oldest-first over trades with seq > after; fn(seq, trade) returns false to stop
+        template <typename Fn>
+        void forEachAfter(uint64_t after, Fn&& fn) const {
+            if (after >= lastSeq_) return;
+            for (uint64_t seq = std::max(after + 1, firstSeq()); seq <= lastSeq_; ++seq) {
+                if (!fn(seq, at(seq))) return;
+            }
+        }
+
+        // Newest-first over all held trades; fn(seq, trade) returns false to stop
+        template <typename Fn>
+        void forEachNewest(Fn&& fn) const {
+            for (uint64_t seq = lastSeq_; seq >= firstSeq(); --seq) {
+                if (!fn(seq, at(seq))) return;
+            }
+        }
+
+    private:
+        std::vector<Trade> slots_;
+        size_t count_ = 0;
+        uint64_t lastSeq_ = 0;
+    };
+
+} // namespace market
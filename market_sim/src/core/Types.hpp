@@ -10,10 +10,15 @@
 namespace market {
 
     using Price = double;
+    using PriceTicks = int64_t;  // Integer price in units of the commodity's tick size
     using Volume = int64_t;
     using Timestamp = uint64_t;
     using AgentId = uint64_t;
     using OrderId = uint64_t;
+    using SymbolId = uint32_t;     // Dense id assigned by MarketEngine's SymbolRegistry
+    using AgentTypeId = uint16_t;  // Dense id assigned by MarketEngine's AgentTypeRegistry
+
+    inline constexpr SymbolId INVALID_SYMBOL_ID = static_cast<SymbolId>(-1);
 
     enum class OrderSide {
         BUY,
@@ -38,10 +43,30 @@ namespace market {
         NEUTRAL
     };
 
+    // Lowercase names, as in the API and exports
+    inline const char* newsCategoryName(NewsCategory category) {
+        switch (category) {
+        case NewsCategory::GLOBAL: return "global";
+        case NewsCategory::POLITICAL: return "political";
+        case NewsCategory::SUPPLY: return "supply";
+        case NewsCategory::DEMAND: return "demand";
+        }
+        return "global";
+    }
+
+    inline const char* newsSentimentName(NewsSentiment sentiment) {
+        switch (sentiment) {
+        case NewsSentiment::POSITIVE: return "positive";
+        case NewsSentiment::NEGATIVE: return "negative";
+        case NewsSentiment::NEUTRAL: return "neutral";
+        }
+        return "neutral";
+    }
+
     struct Order {
         OrderId id;
         AgentId agentId;
-        std::string symbol;
+        SymbolId symbolId = INVALID_SYMBOL_ID;
         OrderSide side;
         OrderType type;
         Price price;
@@ -53,15 +78,25 @@ namespace market {
         }
     };
 
+    // One step of an agent's decision: rest a new order, or pull one of the
+    // agent's own resting orders (named by order.id and order.symbolId). A
+    // replace is a CANCEL followed by a PLACE.
+    struct OrderAction {
+        enum class Kind : uint8_t { PLACE, CANCEL };
+        Kind kind = Kind::PLACE;
+        Order order{};
+    };
+
     struct Trade {
         OrderId buyOrderId;
         OrderId sellOrderId;
         AgentId buyerId;
         AgentId sellerId;
-        std::string buyerType;
-        std::string sellerType;
-        std::string symbol;
-        Price price;
+        AgentTypeId buyerType = 0;   // 0 = "User" (non-agent counterparty)
+        AgentTypeId sellerType = 0;
+        SymbolId symbolId = INVALID_SYMBOL_ID;
+        PriceTicks priceTicks = 0;  // Exact execution price in ticks
+        Price price;                // priceTicks * tickSize, for agents and the API
         Volume quantity;
         Timestamp timestamp;
     };
@@ -70,6 +105,7 @@ namespace market {
         uint64_t ordersPlaced = 0;
         uint64_t buyOrders = 0;
         uint64_t sellOrders = 0;
+        uint64_t cancels = 0;
         uint64_t fills = 0;
         double volumeTraded = 0;
         double cashSpent = 0;
@@ -85,6 +121,7 @@ namespace market {
         double magnitude;           // Impact size [0, 1]
         Timestamp timestamp;
         std::string headline;
+        SymbolId symbolId = INVALID_SYMBOL_ID;  // Resolved by MarketEngine when processed
     };
 
     struct Candle {
@@ -133,19 +170,57 @@ namespace market {
     struct CrossEffect {
         std::string targetSymbol;
         double coefficient;  // How much target price moves per 1% source price change
+        SymbolId targetId = INVALID_SYMBOL_ID;  // Resolved by MarketEngine
+    };
+
+    // Read-only, non-owning view of a contiguous array (std::span is C++20)
+    template <typename T>
+    class ConstSpan {
+    public:
+        ConstSpan() = default;
+        ConstSpan(const T* data, size_t size) : data_(data), size_(size) {}
+        ConstSpan(const std::vector<T>& v) : data_(v.data()), size_(v.size()) {}
+
+        const T* begin() const { return data_; }
+        const T* end() const { return data_ + size_; }
+        const T* data() const { return data_; }
+        size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+        const T& operator[](size_t i) const { return data_[i]; }
+        const T& front() const { return data_[0]; }
+        const T& back() const { return data_[size_ - 1]; }
+
+    private:
+        const T* data_ = nullptr;
+        size_t size_ = 0;
     };
 
+    // What agents see during the decision phase. A view, not a snapshot, and
+    // consistent only during that phase: prices, supplyDemand, volumes,
+    // returns and impliedMoves are engine copies taken when it starts, but
+    // priceHistory, indicators and recentNews point at commodity- and
+    // engine-owned storage that matching and the next tick's news and
+    // supply/demand update change (and may reallocate). Per-symbol spans
+    // are dense, indexed by SymbolId.
+    class PriceIndicators;
+
+    class CrossEffectMatrix;  // core/CrossEffectMatrix.hpp
+
     struct MarketState {
-        std::map<std::string, Price> prices;
-        std::map<std::string, SupplyDemand> supplyDemand;
-        std::map<std::string, std::vector<Price>> priceHistory;
-        std::map<std::string, Volume> volumes;
-        std::map<std::string, std::string> symbolToCategory;
-        std::map<std::string, std::vector<CrossEffect>> crossEffects;
-        std::vector<NewsEvent> recentNews;
-        double globalSentiment;
+        ConstSpan<Price> prices;
+        ConstSpan<SupplyDemand> supplyDemand;
+        ConstSpan<ConstSpan<Price>> priceHistory;   // Each commodity's history, oldest first
+        ConstSpan<const PriceIndicators*> indicators;  // Rolling indicators over priceHistory
+        ConstSpan<Volume> volumes;
+        const CrossEffectMatrix* crossEffects = nullptr;  // By symbol id; null before publication
+        ConstSpan<double> returns;         // Each commodity's last price step
+        ConstSpan<double> impliedMoves;    // crossEffects applied to returns, by target
+        ConstSpan<NewsEvent> recentNews;
+        double globalSentiment = 0.0;
         double tickScale = 1.0;
-        Timestamp currentTime;
+        Timestamp currentTime = 0;
+
+        size_t symbolCount() const { return prices.size(); }
     };
 
     struct AgentParams {
@@ -157,9 +232,9 @@ namespace market {
     };
 
     struct Position {
-        std::string symbol;
-        Volume quantity;
-        Price avgCost;
+        SymbolId symbolId = INVALID_SYMBOL_ID;
+        Volume quantity = 0;
+        Price avgCost = 0.0;
     };
 
     struct BookLevel {
@@ -0,0 +1,258 @@
+#include "EnsembleRunner.hpp"
+#include "utils/Logger.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+namespace market {
+
+    EnsembleOptions EnsembleOptions::fromJson(const nlohmann::json& j) {
+        EnsembleOptions o;
+        o.replicas = j.value("replicas", o.replicas);
+        o.maxParallel = j.value("maxParallel", o.maxParallel);
+        o.baseSeed = j.value("baseSeed", o.baseSeed);
+        o.days = j.value("days", o.days);
+        o.ticks = j.value("ticks", o.ticks);
+        o.startDate = j.value("startDate", o.startDate);
+        o.outputDir = j.value("outputDir", o.outputDir);
+        o.format = j.value("format", o.format);
+        o.maxTicks = j.value("maxTicks", o.maxTicks);
+        return o;
+    }
+
+    EnsembleRunner::EnsembleRunner(nlohmann::json config, nlohmann::json commodities, EnsembleOptions options)
+        : config_(std::move(config))
+        , commodities_(std::move(commodities))
+        , options_(std::move(options))
+    {
+        options_.replicas = std::max(options_.replicas, 0);
+
+        // Parallelism comes from running replicas side by side
+        if (!config_.is_object()) config_ = nlohmann::json::object();
+        config_["agentGlobal"]["decisionThreads"] = 1;
+        config_["orderBook"]["matchingThreads"] = 1;
+
+        replicas_.resize(options_.replicas);
+        for (size_t i = 0; i < replicas_.size(); ++i) {
+            replicas_[i].seed = options_.baseSeed + static_cast<unsigned int>(i);
+        }
+
+        size_t threads = options_.maxParallel > 0
+            ? static_cast<size_t>(options_.maxParallel)
+            : std::max(1u, std::thread::hardware_concurrency());
+        workerCount_ = std::min(threads, replicas_.size());
+    }
+
+    EnsembleRunner::~EnsembleRunner() {
+        cancel();
+        wait();
+    }
+
+    void EnsembleRunner::start() {
+        startedAt_ = std::chrono::steady_clock::now();
+        started_ = true;
+        Logger::info("Ensemble: {} replicas, {} at a time, seeds {}..{}",
+            replicas_.size(), workerCount_, options_.baseSeed,
+            options_.baseSeed + std::max(options_.replicas - 1, 0));
+
+        workers_.reserve(workerCount_);
+        for (size_t i = 0; i < workerCount_; ++i) {
+            workers_.emplace_back([this]() { workerLoop(); });
+        }
+    }
+
+    void EnsembleRunner::wait() {
+        for (auto& t : workers_) {
+            if (t.joinable()) t.join();
+        }
+    }
+
+    void EnsembleRunner::cancel() {
+        cancelled_ = true;
+    }
+
+    void EnsembleRunner::workerLoop() {
+        for (size_t i = nextReplica_.fetch_add(1); i < replicas_.size(); i = nextReplica_.fetch_add(1)) {
+            if (cancelled_.load()) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                replicas_[i].state = ReplicaState::CANCELLED;
+                continue;
+            }
+            runReplica(i);
+        }
+        // The last worker out records what the ensemble produced
+        if (finishedWorkers_.fetch_add(1) + 1 == workerCount_) writeManifest();
+    }
+
+    void EnsembleRunner::writeManifest() const {
+        if (options_.format == "none") return;
+        nlohmann::json manifest = getProgressJson();
+        manifest["options"] = {
+            {"replicas", options_.replicas},
+            {"baseSeed", options_.baseSeed},
+            {"days", options_.days},
+            {"ticks", options_.ticks},
+            {"startDate", options_.startDate},
+            {"format", options_.format},
+            {"maxTicks", options_.maxTicks}
+        };
+
+        std::error_code ec;
+        std::filesystem::create_directories(options_.outputDir, ec);
+        std::ofstream file(options_.outputDir + "/ensemble.json");
+        if (!file.is_open()) {
+            Logger::error("Ensemble: cannot write manifest to {}", options_.outputDir);
+            return;
+        }
+        file << manifest.dump(2);
+    }
+
+    void EnsembleRunner::runReplica(size_t index) {
+        unsigned int seed;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            seed = replicas_[index].seed;
+        }
+
+        std::string dir = options_.outputDir + "/replica_" + std::to_string(index);
+        // Outlives the try block so progress readers never see a dangling pointer
+        std::unique_ptr<Simulation> sim;
+        try {
+            sim = std::make_unique<Simulation>();
+            sim->loadConfig(config_);
+            sim->setSeed(seed);
+            if (!commodities_.is_null()) sim->setCommoditiesData(commodities_);
+
+            uint64_t target = options_.ticks > 0 ? options_.ticks : sim->getPopulateTickCount(options_.days);
+            sim->getTickBuffer().setMaxTicks(static_cast<size_t>(target));
+            // Replicas already export side by side; share the cores between them
+            sim->getTickBuffer().setExportThreads(
+                std::max<size_t>(1, std::thread::hardware_concurrency() / workerCount_));
+            sim->initialize();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                Replica& r = replicas_[index];
+                r.state = ReplicaState::RUNNING;
+                r.targetTicks = target;
+                r.sim = sim.get();
+            }
+
+            if (options_.ticks > 0) {
+                sim->populateTicks(options_.ticks, options_.startDate);
+            }
+            else {
+                sim->populate(options_.days, options_.startDate);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                replicas_[index].state = ReplicaState::EXPORTING;
+            }
+
+            std::string path;
+            bool exported = true;
+            if (options_.format == "csv") {
+                path = dir + "/csv";
+                exported = sim->getTickBuffer().exportToCsv(path, options_.maxTicks);
+            }
+            else if (options_.format == "arrow") {
+                path = dir + "/arrow";
+                exported = sim->getTickBuffer().exportToArrow(path, options_.maxTicks);
+            }
+            else if (options_.format != "none") {
+                std::filesystem::create_directories(dir);
+                path = dir + "/ticks.json";
+                exported = sim->getTickBuffer().exportToJson(path, options_.maxTicks);
+            }
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            Replica& r = replicas_[index];
+            r.ticks = sim->getCurrentTick();
+            r.sim = nullptr;
+            r.outputPath = path;
+            r.state = exported ? ReplicaState::DONE : ReplicaState::FAILED;
+            if (!exported) r.error = "Export to " + path + " failed";
+        }
+        catch (const std::exception& e) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            Replica& r = replicas_[index];
+            r.sim = nullptr;
+            r.state = ReplicaState::FAILED;
+            r.error = e.what();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        const Replica& r = replicas_[index];
+        if (r.state == ReplicaState::DONE) {
+            Logger::info("Ensemble: replica {} (seed {}) done, {} ticks", index, r.seed, r.ticks);
+        }
+        else {
+            Logger::error("Ensemble: replica {} (seed {}) failed: {}", index, r.seed, r.error);
+        }
+    }
+
+    const char* EnsembleRunner::stateName(ReplicaState state) {
+        switch (state) {
+        case ReplicaState::QUEUED: return "queued";
+        case ReplicaState::RUNNING: return "running";
+        case ReplicaState::EXPORTING: return "exporting";
+        case ReplicaState::DONE: return "done";
+        case ReplicaState::FAILED: return "failed";
+        case ReplicaState::CANCELLED: return "cancelled";
+        }
+        return "unknown";
+    }
+
+    nlohmann::json EnsembleRunner::getProgressJson() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        size_t counts[6] = {};
+        uint64_t ticks = 0;
+        uint64_t targetTicks = 0;
+        nlohmann::json list = nlohmann::json::array();
+        for (size_t i = 0; i < replicas_.size(); ++i) {
+            const Replica& r = replicas_[i];
+            counts[static_cast<size_t>(r.state)]++;
+            // getCurrentTick() is atomic, so a running replica can be read mid-populate
+            uint64_t current = r.sim ? r.sim->getCurrentTick() : r.ticks;
+            ticks += current;
+            targetTicks += r.targetTicks;
+
+            nlohmann::json entry = {
+                {"index", i},
+                {"seed", r.seed},
+                {"state", stateName(r.state)},
+                {"ticks", current},
+                {"targetTicks", r.targetTicks}
+            };
+            if (!r.outputPath.empty()) entry["path"] = r.outputPath;
+            if (!r.error.empty()) entry["error"] = r.error;
+            list.push_back(entry);
+        }
+
+        double elapsed = !started_.load() ? 0.0
+            : std::chrono::duration<double>(std::chrono::steady_clock::now() - startedAt_).count();
+
+        return {
+            {"done", isDone()},
+            {"cancelled", cancelled_.load()},
+            {"replicas", replicas_.size()},
+            {"parallel", workerCount_},
+            {"queued", counts[static_cast<size_t>(ReplicaState::QUEUED)]},
+            {"running", counts[static_cast<size_t>(ReplicaState::RUNNING)] +
+                        counts[static_cast<size_t>(ReplicaState::EXPORTING)]},
+            {"completed", counts[static_cast<size_t>(ReplicaState::DONE)]},
+            {"failed", counts[static_cast<size_t>(ReplicaState::FAILED)]},
+            {"skipped", counts[static_cast<size_t>(ReplicaState::CANCELLED)]},
+            {"ticks", ticks},
+            {"targetTicks", targetTicks},
+            {"progress", targetTicks > 0 ? static_cast<double>(ticks) / targetTicks : 0.0},
+            {"elapsedSec", elapsed},
+            {"ticksPerSec", elapsed > 0 ? ticks / elapsed : 0.0},
+            {"outputDir", options_.outputDir},
+            {"replicaStatus", list}
+        };
+    }
+
+} // namespace market
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Simulation.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace market {
+
+    struct EnsembleOptions {
+        int replicas = 4;
+        int maxParallel = 0;            // Replicas running at once; 0 = one per hardware thread
+        unsigned int baseSeed = 1;      // Replica i runs with seed baseSeed + i
+        int days = 180;                 // populate(days), unless ticks > 0
+        uint64_t ticks = 0;             // populateTicks(ticks) when > 0
+        std::string startDate = "2025-01-01";
+        std::string outputDir = "/data/ensemble";  // Replica i exports under outputDir/replica_<i>
+        std::string format = "json";    // "json", "csv", "arrow" or "none"
+        size_t maxTicks = 0;            // Export limit, 0 = everything
+
+        static EnsembleOptions fromJson(const nlohmann::json& j);
+    };
+
+    // Runs independent Simulation replicas, each with its own seed, RNG context,
+    // order ids and TickBuffer, on a bounded set of threads. Replicas are forced
+    // to single-threaded ticks so the ensemble, not each replica, uses the cores.
+    class EnsembleRunner {
+    public:
+        // `config` and `commodities` are what Simulation::loadConfig and
+        // setCommoditiesData would take; every replica gets its own copy
+        EnsembleRunner(nlohmann::json config, nlohmann::json commodities, EnsembleOptions options);
+        ~EnsembleRunner();
+
+        EnsembleRunner(const EnsembleRunner&) = delete;
+        EnsembleRunner& operator=(const EnsembleRunner&) = delete;
+
+        // Starts the workers and returns; call once. Each replica writes its
+        // ticks under outputDir/replica_<i>, and outputDir/ensemble.json gets
+        // the final progress report once every replica is over.
+        void start();
+        // Blocks until every replica has finished or been skipped
+        void wait();
+        // Replicas not yet started are skipped; running ones finish their run
+        void cancel();
+
+        bool isDone() const { return finishedWorkers_.load() == workerCount_; }
+        const EnsembleOptions& getOptions() const { return options_; }
+
+        // Aggregate and per-replica progress; safe from any thread
+        nlohmann::json getProgressJson() const;
+
+    private:
+        enum class ReplicaState { QUEUED, RUNNING, EXPORTING, DONE, FAILED, CANCELLED };
+
+        struct Replica {
+            unsigned int seed = 0;
+            ReplicaState state = ReplicaState::QUEUED;
+            uint64_t targetTicks = 0;
+            uint64_t ticks = 0;          // Final count once the run is over
+            std::string outputPath;
+            std::string error;
+            const Simulation* sim = nullptr;  // While running, for live tick counts
+        };
+
+        nlohmann::json config_;
+        nlohmann::json commodities_;
+        EnsembleOptions options_;
+
+        mutable std::mutex mutex_;  // Guards replicas_
+        std::vector<Replica> replicas_;
+
+        std::vector<std::thread> workers_;
+        size_t workerCount_ = 0;
+        std::atomic<size_t> nextReplica_{ 0 };
+        std::atomic<size_t> finishedWorkers_{ 0 };
+        std::atomic<bool> cancelled_{ false };
+        std::atomic<bool> started_{ false };
+        std::chrono::steady_clock::time_point startedAt_;
+
+        void workerLoop();
+        void runReplica(size_t index);
+        void writeManifest() const;  // outputDir/ensemble.json, unless format is "none"
+
+        static const char* stateName(ReplicaState state);
+    };
+
+} // namespace market
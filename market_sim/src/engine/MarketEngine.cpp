@@ -3,21 +3,104 @@
 #include "utils/Random.hpp"
 #include <algorithm>
 #include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
 
 namespace market {
 
-    MarketEngine::MarketEngine() {}
+    MarketEngine::MarketEngine() {
+        agentTypes_.intern("User");
+        agentTypeStats_.resize(1);
+        publishSymbols();
+    }
+
+    void MarketEngine::setRuntimeConfig(std::shared_ptr<const RuntimeConfig> cfg) {
+        auto previous = std::move(rtConfig_);
+        rtConfig_ = std::move(cfg);
+        if (!rtConfig_) return;
+        const RuntimeConfig& c = *rtConfig_;
+
+        recentTrades_.setCapacity(static_cast<size_t>(std::max(1, c.simulation.tradeLogCapacity)));
+        const auto& r = c.candles;
+        if (!previous || std::tie(r.retention1m, r.retention5m, r.retention15m, r.retention30m, r.retention1h, r.retention1d) !=
+            std::tie(previous->candles.retention1m, previous->candles.retention5m, previous->candles.retention15m,
+                previous->candles.retention30m, previous->candles.retention1h, previous->candles.retention1d)) {
+            applyCandleRetention();
+        }
+        if (!previous || previous == rtConfig_) return;
+
+        const auto& cm = c.commodity;
+        const auto& pcm = previous->commodity;
+        if (std::tie(cm.circuitBreakerLimit, cm.impactDampening, cm.priceFloor, cm.supplyDecayRate, cm.demandDecayRate) !=
+            std::tie(pcm.circuitBreakerLimit, pcm.impactDampening, pcm.priceFloor, pcm.supplyDecayRate, pcm.demandDecayRate)) {
+            for (Commodity* commodity : commodityById_) {
+                commodity->setMaxDailyMove(cm.circuitBreakerLimit);
+                commodity->setImpactDampening(cm.impactDampening);
+                commodity->setPriceFloor(cm.priceFloor);
+                commodity->setSupplyDecayRate(cm.supplyDecayRate);
+                commodity->setDemandDecayRate(cm.demandDecayRate);
+            }
+        }
+
+        const auto& ob = c.orderBook;
+        if (ob.orderExpiryMs != previous->orderBook.orderExpiryMs) {
+            for (OrderBook* book : bookById_) book->setMaxOrderAgeMs(ob.orderExpiryMs);
+        }
+        if (ob.matchingMode != previous->orderBook.matchingMode ||
+            ob.auctionAllocation != previous->orderBook.auctionAllocation) {
+            for (OrderBook* book : bookById_) {
+                book->setMatchingMode(OrderBook::parseMatchingMode(ob.matchingMode),
+                    OrderBook::parseAllocation(ob.auctionAllocation));
+            }
+        }
+
+        if (c.news.lambda != previous->news.lambda) newsGenerator_.setLambda(c.news.lambda);
+
+        for (auto& agent : agents_) agent->applyConfig(c);
+    }
+
+    void MarketEngine::setConfigSource(const ConfigStore* source) {
+        configSource_ = source;
+        if (configSource_) setRuntimeConfig(configSource_->current());
+    }
+
+    void MarketEngine::adoptConfig() {
+        if (configSource_ && (!rtConfig_ || configSource_->version() != rtConfig_->version)) {
+            setRuntimeConfig(configSource_->current());
+        }
+    }
+
+    void MarketEngine::applyCandleRetention() {
+        if (!rtConfig_) return;
+        const auto& c = rtConfig_->candles;
+        auto candles = [](int n) { return static_cast<size_t>(std::max(1, n)); };
+        candleAggregator_.setRetention(CandleAggregator::Interval::M1, candles(c.retention1m));
+        candleAggregator_.setRetention(CandleAggregator::Interval::M5, candles(c.retention5m));
+        candleAggregator_.setRetention(CandleAggregator::Interval::M15, candles(c.retention15m));
+        candleAggregator_.setRetention(CandleAggregator::Interval::M30, candles(c.retention30m));
+        candleAggregator_.setRetention(CandleAggregator::Interval::H1, candles(c.retention1h));
+        candleAggregator_.setRetention(CandleAggregator::Interval::D1, candles(c.retention1d));
+    }
 
     void MarketEngine::addCommodity(std::unique_ptr<Commodity> commodity) {
         const std::string& symbol = commodity->getSymbol();
+        SymbolId id = symbols_.intern(symbol);
 
-        orderBooks_[symbol] = std::make_unique<OrderBook>(symbol);
+        orderBooks_[symbol] = std::make_unique<OrderBook>(symbol, commodity->getTickSize(), id);
         orderBooks_[symbol]->setSimClock(&simClock_);
+        orderBooks_[symbol]->setOrderIdSequence(&orderIds_);
         if (rtConfig_) {
             orderBooks_[symbol]->setMaxOrderAgeMs(rtConfig_->orderBook.orderExpiryMs);
+            orderBooks_[symbol]->setMatchingMode(
+                OrderBook::parseMatchingMode(rtConfig_->orderBook.matchingMode),
+                OrderBook::parseAllocation(rtConfig_->orderBook.auctionAllocation));
         }
 
         candleAggregator_.addSymbol(symbol);
+        // Bound agent rows never widen themselves while agents run in parallel
+        if (agentColumns_.rows() > 0) agentColumns_.ensureSymbols(symbols_.size());
 
         newsGenerator_.setCommodities([&]() {
             std::vector<std::string> syms;
@@ -42,7 +125,16 @@ namespace market {
         categories[symbol] = commodity->getCategory();
         newsGenerator_.setCommodityCategories(categories);
 
+        if (commodityById_.size() <= id) {
+            commodityById_.resize(id + 1, nullptr);
+            bookById_.resize(id + 1, nullptr);
+        }
+        commodityById_[id] = commodity.get();
+        bookById_[id] = orderBooks_[symbol].get();
+
         commodities_[symbol] = std::move(commodity);
+        resolveCrossEffects();
+        publishSymbols();
 
         Logger::info("Added commodity {} ({})", symbol, categories[symbol]);
     }
@@ -52,14 +144,40 @@ namespace market {
         return it != commodities_.end() ? it->second.get() : nullptr;
     }
 
+    void MarketEngine::registerAgentType(Agent& agent) {
+        AgentTypeId typeId = agentTypes_.intern(std::string(agent.getType()));
+        if (agentTypeStats_.size() <= typeId) {
+            agentTypeStats_.resize(typeId + 1);
+        }
+        agent.attachSentimentFeed(&sentimentFeed_);
+        if (columnLayout() && !agent.isBoundToColumns()) {
+            agentColumns_.ensureSymbols(symbols_.size());
+            agent.bindColumns(agentColumns_);
+        }
+
+        size_t index = agents_.size();
+        agentIndexById_.emplace(agent.getId(), index);  // first registration wins
+        agentTypeIds_.push_back(typeId);
+
+        const AgentKernels* kernels = &AgentKernels::forAgent(agent);
+        if (!agentRuns_.empty() && agentRuns_.back().kernels == kernels && agentRuns_.back().end == index) {
+            agentRuns_.back().end++;
+        }
+        else {
+            agentRuns_.push_back(AgentRun{ index, index + 1, kernels });
+        }
+    }
+
     void MarketEngine::addAgent(std::unique_ptr<Agent> agent) {
-        agentIdToType_[agent->getId()] = agent->getType();
+        registerAgentType(*agent);
         agents_.push_back(std::move(agent));
     }
 
     void MarketEngine::addAgents(std::vector<std::unique_ptr<Agent>> newAgents) {
+        if (columnLayout()) agentColumns_.reserve(agentColumns_.rows() + newAgents.size());
+        agents_.reserve(agents_.size() + newAgents.size());
         for (auto& agent : newAgents) {
-            agentIdToType_[agent->getId()] = agent->getType();
+            registerAgentType(*agent);
             agents_.push_back(std::move(agent));
         }
         Logger::info("Added {} agents, total: {}", newAgents.size(), agents_.size());
@@ -72,10 +190,75 @@ namespace market {
 
     void MarketEngine::setCrossEffects(const std::string& symbol, const std::vector<CrossEffect>& effects) {
         crossEffects_[symbol] = effects;
+        resolveCrossEffects();
+    }
+
+    void MarketEngine::resolveCrossEffects() {
+        crossMatrix_.reset(symbols_.size());
+        for (const auto& [symbol, effects] : crossEffects_) {
+            SymbolId sourceId = symbols_.find(symbol);
+            if (sourceId == INVALID_SYMBOL_ID) continue;
+
+            for (const auto& effect : effects) {
+                SymbolId targetId = symbols_.find(effect.targetSymbol);
+                if (targetId == INVALID_SYMBOL_ID) continue;
+                crossMatrix_.set(sourceId, targetId, effect.coefficient);
+            }
+        }
+    }
+
+    std::map<std::string, AgentTypeStats> MarketEngine::getAgentTypeStats() const {
+        std::map<std::string, AgentTypeStats> stats;
+        for (AgentTypeId id = 0; id < agentTypeStats_.size(); ++id) {
+            const auto& s = agentTypeStats_[id];
+            if (s.ordersPlaced == 0 && s.fills == 0) continue;
+            stats[agentTypes_.name(id)] = s;
+        }
+        return stats;
     }
 
     void MarketEngine::tick() {
+        runTick(nullptr);
+    }
+
+    void MarketEngine::replay(const JournalEntry& entry) {
+        if (entry.kind == JournalEntry::Kind::FLUSH) {
+            if (entry.tick != totalTicks_) {
+                throw std::runtime_error("Journal entry for tick " + std::to_string(entry.tick) +
+                    " does not follow engine tick " + std::to_string(totalTicks_));
+            }
+            addJournaledUserOrders(entry.userOrders);
+            matchAllOrders(false);
+        }
+        else {
+            if (entry.tick != totalTicks_ + 1) {
+                throw std::runtime_error("Journal entry for tick " + std::to_string(entry.tick) +
+                    " does not follow engine tick " + std::to_string(totalTicks_));
+            }
+            runTick(&entry);
+        }
+        checkReplay(entry);
+    }
+
+    void MarketEngine::checkReplay(const JournalEntry& entry) const {
+        if (totalTrades_ != entry.totalTrades) {
+            throw std::runtime_error("Journal replay diverged at tick " + std::to_string(entry.tick) + ": " +
+                std::to_string(totalTrades_) + " trades, journal has " + std::to_string(entry.totalTrades));
+        }
+    }
+
+    void MarketEngine::runTick(const JournalEntry* replay) {
+        MARKET_PROFILE_SCOPE(profiler_[TickProfiler::Phase::TICK]);
+        adoptConfig();
         totalTicks_++;
+        uint64_t tradesBefore = totalTrades_;
+        uint64_t ordersBefore = totalOrders_;
+        bool journaling = journal_ && !replay;
+        if (journaling) {
+            journalEntry_.clear();
+            journalEntry_.kind = JournalEntry::Kind::TICK;
+            journalEntry_.tick = totalTicks_;
+        }
 
         simClock_.tick();
         Timestamp simTime = simClock_.currentTimestamp();
@@ -89,24 +272,76 @@ namespace market {
         }
 
         double tickScale = simClock_.getTickScale();
-        auto news = newsGenerator_.generate(simTime, tickScale);
-        processNews(news);
+        {
+            MARKET_PROFILE_SCOPE(profiler_[TickProfiler::Phase::NEWS]);
+            auto news = replay ? replay->news : newsGenerator_.generate(simTime, tickScale);
+            if (replay) newsGenerator_.setSchedule(replay->newsSchedule);
+            if (journaling) {
+                journalEntry_.news = news;
+                journalEntry_.newsSchedule = newsGenerator_.getSchedule();
+            }
+            processNews(news);
+        }
+
+        {
+            MARKET_PROFILE_SCOPE(profiler_[TickProfiler::Phase::SENTIMENT]);
+            // Agents apply decay (and this tick's news) when they next read sentiment
+            sentimentFeed_.advance(tickScale);
+
+            decaySentiment(tickScale);
+        }
 
-        for (auto& agent : agents_) {
-            agent->decaySentiment(tickScale);
+        {
+            MARKET_PROFILE_SCOPE(profiler_[TickProfiler::Phase::SUPPLY_DEMAND]);
+            // Supply/demand noise is the only draw from the simulation's stream
+            // after news, so this state is all a replay needs to reproduce it
+            if (replay) Random::engine() = replay->rng;
+            if (journaling) journalEntry_.rng = Random::engine();
+            updateSupplyDemand(tickScale);
         }
 
-        decaySentiment(tickScale);
+        {
+            MARKET_PROFILE_SCOPE(profiler_[TickProfiler::Phase::AGENT_ORDERS]);
+            if (replay)
+                applyJournaledActions(replay->agentActions);
+            else
+                processAgentOrders();
+        }
 
-        updateSupplyDemand(tickScale);
+        {
+            MARKET_PROFILE_SCOPE(profiler_[TickProfiler::Phase::EXTERNAL_ORDERS]);
+            if (replay)
+                addJournaledUserOrders(replay->userOrders);
+            else
+                drainExternalOrders();
+        }
 
-        processAgentOrders();
+        {
+            MARKET_PROFILE_SCOPE(profiler_[TickProfiler::Phase::MATCHING]);
+            matchAllOrders(!replay);
+        }
 
-        matchAllOrders();
+        {
+            MARKET_PROFILE_SCOPE(profiler_[TickProfiler::Phase::ACKS]);
+            resolveExternalAcks();
+        }
 
-        for (const auto& [symbol, commodity] : commodities_) {
-            double vol = commodity->getDailyVolume();
-            candleAggregator_.onTick(symbol, commodity->getPrice(), vol, simTime);
+        {
+            MARKET_PROFILE_SCOPE(profiler_[TickProfiler::Phase::CANDLES]);
+            // Candle indices follow SymbolId: both are assigned in addCommodity() order
+            for (SymbolId id = 0; id < commodityById_.size(); ++id) {
+                const Commodity* commodity = commodityById_[id];
+                if (!commodity) continue;
+                candleAggregator_.onTick(id, commodity->getPrice(), commodity->getDailyVolume(), simTime);
+            }
+        }
+
+        lastTickTrades_ = totalTrades_ - tradesBefore;
+        lastTickOrders_ = totalOrders_ - ordersBefore;
+
+        if (journaling) {
+            journalEntry_.totalTrades = totalTrades_;
+            journal_->append(journalEntry_);
         }
 
         if (totalTicks_ % 1000 == 0) {
@@ -115,14 +350,15 @@ namespace market {
         }
     }
 
-    void MarketEngine::processNews(const std::vector<NewsEvent>& news) {
-        for (const auto& event : news) {
-            recentNews_.push_back(event);
-            if (recentNews_.size() > MAX_RECENT_NEWS) {
-                recentNews_.erase(recentNews_.begin());
+    void MarketEngine::processNews(std::vector<NewsEvent>& news) {
+        for (auto& event : news) {
+            if (!event.symbol.empty()) {
+                event.symbolId = symbols_.find(event.symbol);
             }
 
-            Logger::debug("[NEWS] {}: {} (mag: {:.3f})",
+            recentNews_.push_back(event);
+
+            MARKET_LOG_DEBUG("[NEWS] {}: {} (mag: {:.3f})",
                 event.category == NewsCategory::SUPPLY ? "SUPPLY" :
                 event.category == NewsCategory::DEMAND ? "DEMAND" :
                 event.category == NewsCategory::GLOBAL ? "GLOBAL" : "POLITICAL",
@@ -135,21 +371,19 @@ namespace market {
                 globalSentiment_ += sign * event.magnitude * 0.3;
             }
             else if (event.category == NewsCategory::SUPPLY) {
-                auto* commodity = getCommodity(event.symbol);
+                auto* commodity = getCommodity(event.symbolId);
                 if (commodity) {
                     commodity->applySupplyShock(-sign * event.magnitude);
                 }
             }
             else if (event.category == NewsCategory::DEMAND) {
-                auto* commodity = getCommodity(event.symbol);
+                auto* commodity = getCommodity(event.symbolId);
                 if (commodity) {
                     commodity->applyDemandShock(sign * event.magnitude);
                 }
             }
 
-            for (auto& agent : agents_) {
-                agent->updateBeliefs(event);
-            }
+            sentimentFeed_.publish(event);
 
             if (newsCallback_) {
                 newsCallback_(event);
@@ -157,6 +391,12 @@ namespace market {
 
             newsGenerator_.addToRecent(event);
         }
+
+        // Bound the feed: catch every agent up, after which no one needs the log
+        if (sentimentFeed_.pending() > MAX_PENDING_SENTIMENT_NEWS) {
+            for (auto& agent : agents_) agent->syncSentiment();
+            sentimentFeed_.compact();
+        }
     }
 
     void MarketEngine::updateSupplyDemand(double tickScale) {
@@ -169,69 +409,374 @@ namespace market {
         globalSentiment_ *= std::pow(0.95, tickScale);
     }
 
-    MarketState MarketEngine::getMarketState() const {
-        MarketState state;
-        state.currentTime = simClock_.currentTimestamp();
-        state.globalSentiment = globalSentiment_;
-        state.tickScale = simClock_.getTickScale();
-        state.recentNews = recentNews_;
+    void MarketEngine::publishMarketState() {
+        size_t n = commodityById_.size();
+        statePrices_.resize(n);
+        stateSupplyDemand_.resize(n);
+        stateHistory_.resize(n);
+        stateVolumes_.resize(n);
+        stateIndicators_.resize(n);
+        stateReturns_.resize(n);
+        stateImpliedMoves_.resize(n);
+
+        for (SymbolId id = 0; id < n; ++id) {
+            const Commodity* commodity = commodityById_[id];
+            statePrices_[id] = commodity->getPrice();
+            stateSupplyDemand_[id] = commodity->getSupplyDemand();
+            stateHistory_[id] = commodity->getPriceHistory();
+            stateVolumes_[id] = commodity->getDailyVolume();
+            stateIndicators_[id] = &commodity->getIndicators();
+            stateReturns_[id] = commodity->getReturn(1);
+        }
+        crossMatrix_.impliedMoves(stateReturns_.data(), stateImpliedMoves_.data());
+
+        marketState_.prices = statePrices_;
+        marketState_.supplyDemand = stateSupplyDemand_;
+        marketState_.priceHistory = stateHistory_;
+        marketState_.volumes = stateVolumes_;
+        marketState_.indicators = stateIndicators_;
+        marketState_.crossEffects = &crossMatrix_;
+        marketState_.returns = stateReturns_;
+        marketState_.impliedMoves = stateImpliedMoves_;
+        marketState_.recentNews = recentNews_.view();
+        marketState_.globalSentiment = globalSentiment_;
+        marketState_.tickScale = simClock_.getTickScale();
+        marketState_.currentTime = simClock_.currentTimestamp();
+    }
+
+    void MarketEngine::processAgentOrders() {
+        publishMarketState();
+        const MarketState& state = marketState_;
+
+        // Each agent's stream is re-based on the tick, and every reaction gate is
+        // drawn up front in one batch from a counter-based stream
+        uint64_t tick = simClock_.getTotalTicks();
+        gateDraws_.resize(agents_.size());
+        Random::fillUniform(gateDraws_.data(), gateDraws_.size(), Random::GATE_STREAM, tick);
+
+        // Agents only touch their own state and RNG stream while deciding, so the
+        // phase can run in parallel, one typed kernel per run of same-class
+        // agents; batches are then submitted in agent order
+        decisions_.resize(agents_.size());
+        runParallel(rtConfig_ ? rtConfig_->agentGlobal.decisionThreads : 1, agents_.size(),
+            [this, &state, tick](size_t begin, size_t end) {
+                forEachAgentRun(begin, end, [&](const AgentRun& run, size_t b, size_t e) {
+                    run.kernels->decide(&agents_[b], e - b, state, &gateDraws_[b], tick, &decisions_[b]);
+                });
+            });
+
+        // In agent order: stamp the owner, assign ids (independent of the thread
+        // count), count stats and bucket each action under its book
+        bookActions_.resize(bookById_.size());
+        for (auto& actions : bookActions_) actions.clear();
+
+        for (size_t i = 0; i < agents_.size(); ++i) {
+            OrderBatch& batch = decisions_[i];
+            if (batch.empty()) continue;
+
+            auto& stats = agentTypeStats_[agentTypeIds_[i]];
+            AgentId owner = agents_[i]->getId();
+            bool places = false;
+            for (OrderAction& action : batch.mutableActions()) {
+                Order& order = action.order;
+                order.agentId = owner;
+                bool isPlace = action.kind == OrderAction::Kind::PLACE;
+                places |= isPlace;
+
+                if (!getOrderBook(order.symbolId)) {
+                    if (isPlace) order.id = 0;
+                    continue;
+                }
+                if (isPlace) {
+                    order.id = orderIds_.next();
+                    countPlacedOrder(stats, order);
+                }
+                else {
+                    stats.cancels++;
+                }
+                bookActions_[order.symbolId].push_back(action);
+            }
+            if (places) agents_[i]->onOrdersPlaced(batch.actions());
+        }
+
+        if (journal_) {
+            for (const auto& actions : bookActions_) {
+                journalEntry_.agentActions.insert(journalEntry_.agentActions.end(), actions.begin(), actions.end());
+            }
+        }
+
+        // Each book's share goes in under one lock; books are independent, and
+        // within a book the actions keep agent order, so this matches a serial run
+        runParallel(rtConfig_ ? rtConfig_->orderBook.matchingThreads : 1, bookActions_.size(),
+            [this](size_t begin, size_t end) {
+                for (size_t id = begin; id < end; ++id) {
+                    if (!bookActions_[id].empty()) bookById_[id]->applyActions(bookActions_[id]);
+                }
+            });
+    }
+
+    void MarketEngine::countPlacedOrder(AgentTypeStats& stats, const Order& order) {
+        totalOrders_++;
+        stats.ordersPlaced++;
+        if (order.side == OrderSide::BUY)
+            stats.buyOrders++;
+        else
+            stats.sellOrders++;
+    }
 
+    void MarketEngine::applyJournaledActions(const std::vector<OrderAction>& actions) {
+        bookActions_.resize(bookById_.size());
+        for (auto& bucket : bookActions_) bucket.clear();
+
+        for (const OrderAction& action : actions) {
+            if (!getOrderBook(action.order.symbolId)) {
+                throw std::runtime_error("Journal names a book this engine does not have");
+            }
+            size_t agent = agentIndexOf(action.order.agentId);
+            auto& stats = agentTypeStats_[agent != NO_AGENT ? agentTypeIds_[agent] : 0];
+            if (action.kind == OrderAction::Kind::PLACE)
+                countPlacedOrder(stats, action.order);
+            else
+                stats.cancels++;
+            bookActions_[action.order.symbolId].push_back(action);
+        }
+
+        runParallel(rtConfig_ ? rtConfig_->orderBook.matchingThreads : 1, bookActions_.size(),
+            [this](size_t begin, size_t end) {
+                for (size_t id = begin; id < end; ++id) {
+                    if (!bookActions_[id].empty()) bookById_[id]->applyActions(bookActions_[id]);
+                }
+            });
+        for (const OrderAction& action : actions) {
+            if (action.order.id >= orderIds_.peek()) orderIds_.restart(action.order.id + 1);
+        }
+    }
+
+    void MarketEngine::addJournaledUserOrders(const std::vector<OrderAction>& actions) {
+        for (const OrderAction& action : actions) {
+            const Order& order = action.order;
+            OrderBook* book = getOrderBook(order.symbolId);
+            if (!book) throw std::runtime_error("Journal names a book this engine does not have");
+            if (action.kind == OrderAction::Kind::CANCEL) {
+                book->cancelOrder(order.id, order.agentId);
+                agentTypeStats_[0].cancels++;
+                continue;
+            }
+            book->addOrder(order);
+            countPlacedOrder(agentTypeStats_[0], order);  // "User"
+            if (order.id >= orderIds_.peek()) orderIds_.restart(order.id + 1);
+        }
+    }
+
+    void MarketEngine::publishSymbols() {
+        auto syms = std::make_shared<std::unordered_set<std::string>>(
+            symbols_.names().begin(), symbols_.names().end());
+        std::atomic_store(&publishedSymbols_, std::shared_ptr<const std::unordered_set<std::string>>(syms));
+    }
+
+    void MarketEngine::publishSnapshot() {
+        MARKET_PROFILE_SCOPE(profiler_[TickProfiler::Phase::SNAPSHOT]);
+        auto snapshot = std::make_shared<MarketSnapshot>();
+        snapshot->version = ++snapshotVersion_;
+        snapshot->tick = totalTicks_;
+        snapshot->simTimestamp = simClock_.currentTimestamp();
+        snapshot->simDate = simClock_.currentDateString();
+        snapshot->simDateTime = simClock_.currentDateTimeString();
+
+        snapshot->commodities.reserve(commodities_.size());
+        std::vector<uint32_t> commodityIndex(symbols_.size(), 0);  // By SymbolId
         for (const auto& [symbol, commodity] : commodities_) {
-            state.prices[symbol] = commodity->getPrice();
-            state.supplyDemand[symbol] = commodity->getSupplyDemand();
-            state.priceHistory[symbol] = commodity->getPriceHistory();
-            state.volumes[symbol] = commodity->getDailyVolume();
-            state.symbolToCategory[symbol] = commodity->getCategory();
+            SymbolId id = symbols_.find(symbol);
+            if (id != INVALID_SYMBOL_ID && id < commodityIndex.size()) {
+                commodityIndex[id] = static_cast<uint32_t>(snapshot->commodities.size());
+            }
+            MarketSnapshot::CommodityView view;
+            view.symbol = symbol;
+            view.name = commodity->getName();
+            view.category = commodity->getCategory();
+            view.price = commodity->getPrice();
+            view.tickSize = commodity->getTickSize();
+            view.dailyVolume = commodity->getDailyVolume();
+            view.change = commodity->getReturn(1);
+            view.supplyDemand = commodity->getSupplyDemand();
+            if (const OrderBook* book = getOrderBook(symbol)) {
+                view.bidOrders = book->getBidCount();
+                view.askOrders = book->getAskCount();
+            }
+            auto candles = candleAggregator_.getCandles(symbol, CandleAggregator::Interval::M1, 0, 1);
+            if (!candles.empty()) view.lastCandle = candles.back();
+            snapshot->commodities.push_back(std::move(view));
         }
 
-        for (const auto& [symbol, effects] : crossEffects_) {
-            state.crossEffects[symbol] = effects;
+        snapshot->books = getOrderBookSnapshots(MarketSnapshot::BOOK_DEPTH);
+        double sumSpread = 0;
+        int spreads = 0;
+        for (const auto& [symbol, book] : snapshot->books) {
+            if (book.spread > 0) {
+                sumSpread += book.spread;
+                spreads++;
+            }
         }
+        snapshot->avgSpread = spreads > 0 ? sumSpread / spreads : 0;
+        snapshot->totalTrades = totalTrades_;
+        snapshot->totalOrders = totalOrders_;
+        snapshot->tickTrades = lastTickTrades_;
+        snapshot->tickOrders = lastTickOrders_;
+        snapshot->recentNews = newsGenerator_.getRecentNews(MarketSnapshot::RECENT_NEWS);
+
+        uint64_t lastSeq = recentTrades_.lastSeq();
+        uint64_t after = lastSeq - std::min<uint64_t>(lastSeq, MarketSnapshot::RECENT_TRADES);
+        snapshot->recentTrades.reserve(std::min<uint64_t>(recentTrades_.size(), MarketSnapshot::RECENT_TRADES));
+        recentTrades_.forEachAfter(after, [&](uint64_t seq, const Trade& t) {
+            if (t.symbolId < commodityIndex.size()) {
+                snapshot->recentTrades.push_back({ seq, commodityIndex[t.symbolId], t.price, t.quantity, t.timestamp });
+            }
+            return true;
+        });
 
-        return state;
+        std::atomic_store(&snapshot_, std::shared_ptr<const MarketSnapshot>(std::move(snapshot)));
     }
 
-    void MarketEngine::processAgentOrders() {
-        MarketState state = getMarketState();
+    bool MarketEngine::isKnownSymbol(const std::string& symbol) const {
+        auto syms = std::atomic_load(&publishedSymbols_);
+        return syms && syms->count(symbol) > 0;
+    }
 
-        for (auto& agent : agents_) {
-            auto orderOpt = agent->decide(state);
+    void MarketEngine::drainExternalOrders() {
+        ingress_.drain([this](IngressOrder& in) {
+            SymbolId id = symbols_.find(in.symbol);
+            OrderBook* book = getOrderBook(id);
+            if (!book) {
+                if (in.ack) {
+                    in.ack->set_value(OrderAck{ "rejected", 0, 0.0, "Symbol not found: " + in.symbol });
+                }
+                return;
+            }
 
-            if (orderOpt.has_value()) {
-                Order& order = orderOpt.value();
+            if (in.cancelId != 0) {
+                // Only the submitting user's own orders; anyone else's read as not found
+                bool cancelled = book->cancelOrder(in.cancelId, in.order.agentId);
+                if (cancelled) {
+                    agentTypeStats_[0].cancels++;
+                    auto pit = pendingAcks_.find(in.cancelId);
+                    if (pit != pendingAcks_.end()) pit->second.cancelled = true;
+                    if (journal_) {
+                        OrderAction action;
+                        action.kind = OrderAction::Kind::CANCEL;
+                        action.order.id = in.cancelId;
+                        action.order.agentId = in.order.agentId;
+                        action.order.symbolId = id;
+                        journalEntry_.userOrders.push_back(action);
+                    }
+                }
+                if (in.ack) {
+                    in.ack->set_value(cancelled ? OrderAck{ "cancelled", 0, 0.0, "" } :
+                        OrderAck{ "rejected", 0, 0.0, "Order not found: " + std::to_string(in.cancelId) });
+                }
+                return;
+            }
 
-                auto* book = getOrderBook(order.symbol);
-                if (book) {
-                    book->addOrder(order);
-                    totalOrders_++;
+            Order& order = in.order;
+            order.symbolId = id;
+            if (order.id == 0) {
+                order.id = orderIds_.next();
+            }
 
-                    auto& stats = agentTypeStats_[agent->getType()];
-                    stats.ordersPlaced++;
-                    if (order.side == OrderSide::BUY)
-                        stats.buyOrders++;
-                    else
-                        stats.sellOrders++;
+            // Market orders (and limits without a price) rest at the best opposite
+            // price at drain time, falling back to the last trade price
+            if (order.type != OrderType::LIMIT || order.price <= 0) {
+                Price fallback = getCommodity(id)->getPrice();
+                if (order.side == OrderSide::BUY) {
+                    Price ask = book->getBestAsk();
+                    order.price = book->getAskCount() > 0 ? ask : fallback;
+                }
+                else {
+                    Price bid = book->getBestBid();
+                    order.price = bid > 0 ? bid : fallback;
                 }
             }
+
+            book->addOrder(order);
+            countPlacedOrder(agentTypeStats_[0], order);  // "User"
+            if (journal_) journalEntry_.userOrders.push_back(OrderAction{ OrderAction::Kind::PLACE, order });
+
+            if (in.ack) {
+                PendingAck pending;
+                pending.promise = std::move(in.ack);
+                pending.requested = order.quantity;
+                pendingAcks_[order.id] = std::move(pending);
+            }
+        });
+    }
+
+    void MarketEngine::resolveExternalAcks() {
+        for (auto& [id, pending] : pendingAcks_) {
+            OrderAck ack;
+            ack.filledQuantity = pending.filled;
+            ack.avgFillPrice = pending.filled > 0 ? pending.notional / pending.filled : 0.0;
+            ack.status = pending.cancelled ? "cancelled" :
+                         (pending.filled >= pending.requested) ? "filled" :
+                         (pending.filled > 0 ? "partial" : "pending");
+            pending.promise->set_value(ack);
+        }
+        pendingAcks_.clear();
+    }
+
+    void MarketEngine::processExternalOrders() {
+        if (ingress_.approxSize() == 0) return;
+        if (journal_) {
+            journalEntry_.clear();
+            journalEntry_.kind = JournalEntry::Kind::FLUSH;
+            journalEntry_.tick = totalTicks_;
+        }
+        drainExternalOrders();
+        matchAllOrders();
+        resolveExternalAcks();
+        if (journal_) {
+            journalEntry_.totalTrades = totalTrades_;
+            journal_->append(journalEntry_);
         }
     }
 
-    void MarketEngine::matchAllOrders() {
+    void MarketEngine::runParallel(int threads, size_t count, const std::function<void(size_t, size_t)>& fn) {
+        if (threads <= 0) {
+            threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        }
+        size_t chunks = std::min(static_cast<size_t>(threads), count);
+        if (chunks <= 1) {
+            if (count > 0) fn(0, count);
+            return;
+        }
+
+        // The caller runs one chunk itself; the pool only grows, so phases with
+        // different thread counts share it without re-spawning threads
+        if (!workerPool_ || workerPool_->size() < chunks - 1) {
+            workerPool_ = std::make_unique<WorkerPool>(chunks - 1);
+        }
+        workerPool_->parallelFor(chunks, [&](size_t chunk) {
+            fn(chunk * count / chunks, (chunk + 1) * count / chunks);
+        });
+    }
+
+    void MarketEngine::matchAllOrders(bool notifyAgents) {
         std::vector<Trade> allTrades;
 
-        for (auto& [symbol, book] : orderBooks_) {
-            auto trades = book->matchOrders();
+        // Books are independent (each has its own mutex), so match them concurrently
+        bookTrades_.resize(bookById_.size());
+        runParallel(rtConfig_ ? rtConfig_->orderBook.matchingThreads : 1, bookById_.size(),
+            [this](size_t begin, size_t end) {
+                for (size_t id = begin; id < end; ++id) bookTrades_[id] = bookById_[id]->matchOrders();
+            });
 
+        // Deterministic merge: SymbolId order, then the book's own trade order
+        for (auto& trades : bookTrades_) {
             for (auto& trade : trades) {
-                auto bit = agentIdToType_.find(trade.buyerId);
-                trade.buyerType = (bit != agentIdToType_.end()) ? bit->second : "User";
-                auto sit = agentIdToType_.find(trade.sellerId);
-                trade.sellerType = (sit != agentIdToType_.end()) ? sit->second : "User";
-
-                recentTrades_.push_back(trade);
-                if (recentTrades_.size() > MAX_RECENT_TRADES) {
-                    recentTrades_.pop_front();
-                }
+                size_t buyer = agentIndexOf(trade.buyerId);
+                size_t seller = agentIndexOf(trade.sellerId);
+                trade.buyerType = buyer != NO_AGENT ? agentTypeIds_[buyer] : 0;
+                trade.sellerType = seller != NO_AGENT ? agentTypeIds_[seller] : 0;
+
+                recentTrades_.push(trade);
 
                 agentTypeStats_[trade.buyerType].fills++;
                 agentTypeStats_[trade.buyerType].volumeTraded += trade.quantity;
@@ -240,6 +785,16 @@ namespace market {
                 agentTypeStats_[trade.sellerType].volumeTraded += trade.quantity;
                 agentTypeStats_[trade.sellerType].cashReceived += trade.price * trade.quantity;
 
+                if (!pendingAcks_.empty()) {
+                    for (OrderId oid : { trade.buyOrderId, trade.sellOrderId }) {
+                        auto pit = pendingAcks_.find(oid);
+                        if (pit != pendingAcks_.end()) {
+                            pit->second.filled += trade.quantity;
+                            pit->second.notional += trade.price * trade.quantity;
+                        }
+                    }
+                }
+
                 allTrades.push_back(trade);
                 totalTrades_++;
 
@@ -250,12 +805,12 @@ namespace market {
         }
 
         updatePrices(allTrades);
-        notifyAgentsOfTrades(allTrades);
+        if (notifyAgents) notifyAgentsOfTrades(allTrades);
     }
 
     void MarketEngine::updatePrices(const std::vector<Trade>& trades) {
         for (const auto& trade : trades) {
-            auto* commodity = getCommodity(trade.symbol);
+            auto* commodity = getCommodity(trade.symbolId);
             if (commodity) {
                 commodity->applyTradePrice(trade.price, trade.quantity);
                 commodity->addVolume(trade.quantity);
@@ -264,12 +819,28 @@ namespace market {
     }
 
     void MarketEngine::notifyAgentsOfTrades(const std::vector<Trade>& trades) {
-        for (const auto& trade : trades) {
-            for (auto& agent : agents_) {
-                if (agent->getId() == trade.buyerId || agent->getId() == trade.sellerId) {
-                    agent->onFill(trade);
-                }
-            }
+        // Route each fill to its counterparties by id, then hand every agent its
+        // fills in one call. Agents only update their own state in onFill, so
+        // grouping by agent gives the same result as trade-by-trade delivery.
+        fillRoutes_.clear();
+        for (size_t t = 0; t < trades.size(); ++t) {
+            size_t buyer = agentIndexOf(trades[t].buyerId);
+            size_t seller = agentIndexOf(trades[t].sellerId);
+            if (buyer != NO_AGENT) fillRoutes_.emplace_back(buyer, t);
+            if (seller != NO_AGENT && seller != buyer) fillRoutes_.emplace_back(seller, t);
+        }
+        if (fillRoutes_.empty()) return;
+
+        std::sort(fillRoutes_.begin(), fillRoutes_.end());
+        routedFills_.clear();
+        for (const auto& route : fillRoutes_) routedFills_.push_back(trades[route.second]);
+
+        for (size_t begin = 0; begin < fillRoutes_.size();) {
+            size_t agent = fillRoutes_[begin].first;
+            size_t end = begin + 1;
+            while (end < fillRoutes_.size() && fillRoutes_[end].first == agent) end++;
+            agents_[agent]->onFills(ConstSpan<Trade>(routedFills_.data() + begin, end - begin));
+            begin = end;
         }
     }
 
@@ -302,7 +873,7 @@ namespace market {
             metrics.returns[symbol] = commodity->getReturn(1);
         }
 
-        metrics.agentTypeStats = agentTypeStats_;
+        metrics.agentTypeStats = getAgentTypeStats();
 
         return metrics;
     }
@@ -311,20 +882,251 @@ namespace market {
         totalTicks_ = 0;
         totalTrades_ = 0;
         totalOrders_ = 0;
+        lastTickTrades_ = 0;
+        lastTickOrders_ = 0;
         recentNews_.clear();
         globalSentiment_ = 0.0;
 
         recentTrades_.clear();
-        agentTypeStats_.clear();
-        agentIdToType_.clear();
+        for (auto& [id, pending] : pendingAcks_) {
+            pending.promise->set_value(OrderAck{ "rejected", 0, 0.0, "Market reset" });
+        }
+        pendingAcks_.clear();
+        agentTypeStats_.assign(1, AgentTypeStats{});
+        agentIndexById_.clear();
+        agentTypeIds_.clear();
+        agentRuns_.clear();
+        sentimentFeed_.clear();
 
         agents_.clear();
+        agentColumns_.clear();
+        commodityById_.clear();
+        bookById_.clear();
         commodities_.clear();
         orderBooks_.clear();
         crossEffects_.clear();
+        crossMatrix_.reset(0);
+        marketState_ = MarketState{};
+        symbols_.clear();
+        agentTypes_.clear();
+        agentTypes_.intern("User");
+        publishSymbols();
         candleAggregator_ = CandleAggregator();
+        applyCandleRetention();
+        publishSnapshot();
 
         Logger::info("Market engine reset");
     }
 
+    void MarketEngine::rejectPendingExternalOrders(const std::string& reason) {
+        ingress_.drain([&reason](IngressOrder& in) {
+            if (in.ack) in.ack->set_value(OrderAck{ "rejected", 0, 0.0, reason });
+        });
+        for (auto& [id, pending] : pendingAcks_) {
+            pending.promise->set_value(OrderAck{ "rejected", 0, 0.0, reason });
+        }
+        pendingAcks_.clear();
+    }
+
+    void MarketEngine::writeCheckpoint(CheckpointWriter& out) const {
+        out.beginSection(checkpoint::tag("ENGN"));
+        out.write(totalTicks_);
+        out.write(totalTrades_);
+        out.write(totalOrders_);
+        out.write(globalSentiment_);
+        out.write(orderIds_.peek());
+        out.write(static_cast<uint64_t>(agentTypes_.size()));
+        for (AgentTypeId id = 0; id < agentTypes_.size(); ++id) out.write(agentTypes_.name(id));
+        out.writeList(agentTypeStats_);
+        out.endSection();
+
+        // Dense by SymbolId from here on
+        out.beginSection(checkpoint::tag("CMDT"));
+        out.write(static_cast<uint64_t>(commodityById_.size()));
+        for (const Commodity* commodity : commodityById_) {
+            out.write(commodity->getSymbol());
+            commodity->writeCheckpoint(out);
+        }
+        out.endSection();
+
+        out.beginSection(checkpoint::tag("CLCK"));
+        simClock_.writeCheckpoint(out);
+        out.endSection();
+
+        out.beginSection(checkpoint::tag("BOOK"));
+        for (const OrderBook* book : bookById_) book->writeCheckpoint(out);
+        out.endSection();
+
+        out.beginSection(checkpoint::tag("NEWS"));
+        newsGenerator_.writeCheckpoint(out);
+        out.writeList(recentNews_);
+        sentimentFeed_.writeCheckpoint(out);
+        out.endSection();
+
+        out.beginSection(checkpoint::tag("AGNT"));
+        out.write(static_cast<uint64_t>(agents_.size()));
+        for (size_t i = 0; i < agents_.size(); ++i) {
+            const Agent& agent = *agents_[i];
+            out.write(agentTypeIds_[i]);
+            out.write(agent.getId());
+            out.write(agent.getInitialCash());
+            out.write(agent.getParams());
+            agent.writeCheckpoint(out);
+        }
+        out.endSection();
+
+        out.beginSection(checkpoint::tag("CNDL"));
+        candleAggregator_.writeCheckpoint(out);
+        out.endSection();
+
+        out.beginSection(checkpoint::tag("TRAD"));
+        recentTrades_.writeCheckpoint(out);
+        out.endSection();
+    }
+
+    void MarketEngine::readCheckpoint(CheckpointReader& in) {
+        rejectPendingExternalOrders("Market restored from checkpoint");
+
+        in.enterSection(checkpoint::tag("ENGN"));
+        in.read(totalTicks_);
+        in.read(totalTrades_);
+        in.read(totalOrders_);
+        in.read(globalSentiment_);
+        orderIds_.restart(in.read<OrderId>());
+
+        // Same type ids as when saved, so the ones in the trade log stay valid
+        std::vector<std::string> typeNames;
+        in.readList(typeNames);
+        if (typeNames.empty() || typeNames.size() > std::numeric_limits<AgentTypeId>::max()) {
+            throw std::runtime_error("Invalid checkpoint: bad agent type table");
+        }
+        agentTypes_.clear();
+        for (const auto& name : typeNames) agentTypes_.intern(name);
+        in.readList(agentTypeStats_);
+        agentTypeStats_.resize(agentTypes_.size());
+        in.leaveSection();
+
+        in.enterSection(checkpoint::tag("CMDT"));
+        size_t commodities = in.readCount(1);
+        if (commodities != commodityById_.size()) {
+            throw std::runtime_error("Checkpoint has " + std::to_string(commodities) +
+                " commodities, the engine " + std::to_string(commodityById_.size()));
+        }
+        for (Commodity* commodity : commodityById_) {
+            std::string symbol;
+            in.read(symbol);
+            if (symbol != commodity->getSymbol()) {
+                throw std::runtime_error("Checkpoint commodity " + symbol +
+                    " does not match configured " + commodity->getSymbol());
+            }
+            commodity->readCheckpoint(in);
+        }
+        in.leaveSection();
+
+        // Before the books, which bucket order expiry against the clock
+        in.enterSection(checkpoint::tag("CLCK"));
+        simClock_.readCheckpoint(in);
+        in.leaveSection();
+
+        in.enterSection(checkpoint::tag("BOOK"));
+        for (OrderBook* book : bookById_) book->readCheckpoint(in);
+        in.leaveSection();
+
+        // Before the agents, whose cursors index into the sentiment feed
+        in.enterSection(checkpoint::tag("NEWS"));
+        newsGenerator_.readCheckpoint(in);
+        std::vector<NewsEvent> recent;
+        in.readList(recent);
+        recentNews_.clear();
+        for (const auto& event : recent) recentNews_.push_back(event);
+        sentimentFeed_.readCheckpoint(in);
+        in.leaveSection();
+
+        in.enterSection(checkpoint::tag("AGNT"));
+        agents_.clear();
+        agentColumns_.clear();
+        agentIndexById_.clear();
+        agentTypeIds_.clear();
+        agentRuns_.clear();
+        decisions_.clear();
+
+        size_t agents = in.readCount(1);
+        agents_.reserve(agents);
+        for (size_t i = 0; i < agents; ++i) {
+            auto typeId = in.read<AgentTypeId>();
+            auto id = in.read<AgentId>();
+            auto initialCash = in.read<double>();
+            AgentParams params;
+            in.read(params);
+
+            auto agent = AgentFactory::create(agentTypes_.name(typeId), id, initialCash, params, rtConfig_.get());
+            if (!agent) {
+                throw std::runtime_error("Invalid checkpoint: unknown agent type '" + agentTypes_.name(typeId) + "'");
+            }
+            addAgent(std::move(agent));
+            agents_.back()->readCheckpoint(in);
+        }
+        in.leaveSection();
+
+        in.enterSection(checkpoint::tag("CNDL"));
+        candleAggregator_.readCheckpoint(in);
+        in.leaveSection();
+
+        in.enterSection(checkpoint::tag("TRAD"));
+        recentTrades_.readCheckpoint(in);
+        in.leaveSection();
+
+        // The published views pointed into the buffers just replaced
+        publishMarketState();
+        publishSnapshot();
+
+        Logger::info("Market engine restored: {} agents, {} commodities, tick {}",
+            agents_.size(), commodityById_.size(), totalTicks_);
+    }
+
+    void MarketEngine::forkFrom(MarketEngine& source) {
+        if (&source == this || !commodities_.empty() || !agents_.empty()) {
+            throw std::runtime_error("Can only fork into an empty engine");
+        }
+
+        totalTicks_ = source.totalTicks_;
+        totalTrades_ = source.totalTrades_;
+        totalOrders_ = source.totalOrders_;
+        lastTickTrades_ = source.lastTickTrades_;
+        lastTickOrders_ = source.lastTickOrders_;
+        globalSentiment_ = source.globalSentiment_;
+        orderIds_.restart(source.orderIds_.peek());
+        agentTypes_ = source.agentTypes_;
+        agentTypeStats_ = source.agentTypeStats_;
+
+        // Before the books, which bucket order expiry against the clock.
+        // Symbols are interned in SymbolId order, so every id carries over.
+        simClock_ = source.simClock_;
+        for (const Commodity* commodity : source.commodityById_) {
+            addCommodity(std::make_unique<Commodity>(*commodity));
+        }
+        for (size_t id = 0; id < bookById_.size(); ++id) {
+            bookById_[id]->copyOrdersFrom(*source.bookById_[id]);
+        }
+        crossEffects_ = source.crossEffects_;
+        resolveCrossEffects();
+
+        // After the commodities, whose registration reset the generator's symbols
+        newsGenerator_ = source.newsGenerator_;
+        recentNews_ = source.recentNews_;
+        sentimentFeed_ = source.sentimentFeed_;
+
+        agents_.reserve(source.agents_.size());
+        for (const auto& agent : source.agents_) {
+            addAgent(agent->clone(rtConfig_.get()));
+            agents_.back()->resumeSentimentFrom(*agent);
+        }
+
+        candleAggregator_ = source.candleAggregator_.fork();
+        recentTrades_ = source.recentTrades_;
+
+        publishMarketState();
+        publishSnapshot();
+    }
+
 } // namespace market
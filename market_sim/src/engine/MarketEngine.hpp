@@ -6,13 +6,28 @@
 #include "core/SimClock.hpp"
 #include "core/CandleAggregator.hpp"
 #include "core/RuntimeConfig.hpp"
+#include "core/ConfigStore.hpp"
+#include "core/SymbolRegistry.hpp"
+#include "core/OrderIngressQueue.hpp"
+#include "core/TradeRing.hpp"
+#include "core/OrderBatch.hpp"
+#include "core/Checkpoint.hpp"
+#include "core/CrossEffectMatrix.hpp"
+#include "MarketSnapshot.hpp"
+#include "OrderJournal.hpp"
 #include "agents/Agent.hpp"
+#include "agents/AgentColumns.hpp"
+#include "agents/AgentKernels.hpp"
 #include "environment/NewsGenerator.hpp"
+#include "utils/Profiler.hpp"
+#include "utils/WorkerPool.hpp"
+#include <algorithm>
 #include <memory>
 #include <vector>
 #include <map>
-#include <deque>
 #include <functional>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace market {
 
@@ -20,11 +35,23 @@ namespace market {
     public:
         MarketEngine();
 
-        void setRuntimeConfig(const RuntimeConfig* cfg) { rtConfig_ = cfg; }
-        const RuntimeConfig* getRuntimeConfig() const { return rtConfig_; }
+        // Puts `cfg` in force. The first config is read by commodities, books
+        // and agents as they are added; a later one is diffed against the
+        // previous and its hot settings pushed to the commodities, books,
+        // news generator and every agent (Agent::applyConfig).
+        void setRuntimeConfig(std::shared_ptr<const RuntimeConfig> cfg);
+        // Where new config versions are published; the engine adopts the
+        // current one now and any newer one at the start of a tick
+        void setConfigSource(const ConfigStore* source);
+        // Adopts the source's config if its version moved; every tick starts with this
+        void adoptConfig();
+        // Pushes the runtime config's candle retention to the aggregator
+        void applyCandleRetention();
+        const RuntimeConfig* getRuntimeConfig() const { return rtConfig_.get(); }
 
         void addCommodity(std::unique_ptr<Commodity> commodity);
         Commodity* getCommodity(const std::string& symbol);
+        Commodity* getCommodity(SymbolId id) { return id < commodityById_.size() ? commodityById_[id] : nullptr; }
         const std::map<std::string, std::unique_ptr<Commodity>>& getCommodities() const { return commodities_; }
         std::map<std::string, std::unique_ptr<Commodity>>& getMutableCommodities() { return commodities_; }
 
@@ -32,9 +59,23 @@ namespace market {
         void addAgents(std::vector<std::unique_ptr<Agent>> agents);
         const std::vector<std::unique_ptr<Agent>>& getAgents() const { return agents_; }
         std::vector<std::unique_ptr<Agent>>& getMutableAgents() { return agents_; }
+        // Rows of the agents bound under the "columns" layout, in registration order
+        const AgentColumns& getAgentColumns() const { return agentColumns_; }
         std::map<std::string, std::unique_ptr<OrderBook>>& getOrderBooks() { return orderBooks_; }
 
         OrderBook* getOrderBook(const std::string& symbol);
+        // Ids are unique per engine, not per process; safe from any thread
+        OrderId allocateOrderId() { return orderIds_.next(); }
+        OrderBook* getOrderBook(SymbolId id) { return id < bookById_.size() ? bookById_[id] : nullptr; }
+
+        // Interned ids — names are only resolved when serializing
+        SymbolId getSymbolId(const std::string& symbol) const { return symbols_.find(symbol); }
+        const std::string& getSymbolName(SymbolId id) const { return symbols_.name(id); }
+        const SymbolRegistry& getSymbolRegistry() const { return symbols_; }
+        const std::string& getAgentTypeName(AgentTypeId id) const { return agentTypes_.name(id); }
+        const AgentTypeRegistry& getAgentTypeRegistry() const { return agentTypes_; }
+        // Parallel to getAgents()
+        const std::vector<AgentTypeId>& getAgentTypeIds() const { return agentTypeIds_; }
 
         NewsGenerator& getNewsGenerator() { return newsGenerator_; }
         const NewsGenerator& getNewsGenerator() const { return newsGenerator_; }
@@ -45,18 +86,77 @@ namespace market {
 
         void tick();
 
-        MarketState getMarketState() const;
+        // While set, every tick and external order flush is appended to the
+        // journal (see OrderJournal). The caller owns it and holds the engine
+        // lock exclusively to change it.
+        void setJournal(OrderJournal* journal) { journal_ = journal; }
+        OrderJournal* getJournal() const { return journal_; }
+
+        // Re-runs one journaled entry: the clock, news effects, supply/demand
+        // (from the journaled RNG state), sentiment, matching and candles run as
+        // in tick(), but the books get the journaled agent and user orders and
+        // no agent decides or hears of its fills. The engine must be in the
+        // state the journaled run was in; throws std::runtime_error if the
+        // entry is for another tick or the trade count comes out different.
+        void replay(const JournalEntry& entry);
+
+        // External (user) orders. submitExternalOrder never blocks on the engine;
+        // queued orders are added to the books inside tick() just before matching.
+        // processExternalOrders() drains and matches immediately, for use while the
+        // simulation is not ticking (caller must hold the engine lock).
+        void submitExternalOrder(IngressOrder order) { ingress_.push(std::move(order)); }
+        // All of `orders` (and cancels) reach the books in the same drain, in order
+        void submitExternalOrders(std::vector<IngressOrder> orders) { ingress_.pushBatch(std::move(orders)); }
+        size_t getPendingExternalOrders() const { return ingress_.approxSize(); }
+        void processExternalOrders();
+
+        // Lock-free symbol check for request validation outside the engine lock
+        bool isKnownSymbol(const std::string& symbol) const;
+
+        // View published at the start of the agent phase and consistent only
+        // during it (see MarketState); read it under the engine lock, between
+        // ticks, for that phase's inputs, not for current prices
+        const MarketState& getMarketState() const { return marketState_; }
+
+        // Latest published snapshot; never null, safe from any thread without
+        // the engine lock. publishSnapshot() builds the next one from the
+        // current state (caller holds the engine lock exclusively); the
+        // Simulation calls it after real-time ticks and other changes, not
+        // on every populate tick.
+        std::shared_ptr<const MarketSnapshot> getSnapshot() const { return std::atomic_load(&snapshot_); }
+        void publishSnapshot();
 
         std::map<std::string, OrderBookSnapshot> getOrderBookSnapshots(int depth = 5) const;
 
         SimulationMetrics getMetrics() const;
 
-        const std::deque<Trade>& getRecentTrades() const { return recentTrades_; }
+        // Per-phase tick timings (empty when built without ENABLE_PROFILING).
+        // The Simulation records its own bookkeeping phases here too.
+        TickProfiler& getProfiler() { return profiler_; }
+        const TickProfiler& getProfiler() const { return profiler_; }
 
-        const std::map<std::string, AgentTypeStats>& getAgentTypeStats() const { return agentTypeStats_; }
+        const TradeRing& getRecentTrades() const { return recentTrades_; }
+
+        // Keyed by type name; built from the id-indexed counters
+        std::map<std::string, AgentTypeStats> getAgentTypeStats() const;
 
         void reset();
 
+        // Complete market state as checkpoint sections (see core/Checkpoint.hpp).
+        // Loading needs the commodities this engine was built with, in the same
+        // order, and replaces agents, resting orders, news, clock, candles and
+        // counters. Queued external orders and unresolved acks are rejected.
+        void writeCheckpoint(CheckpointWriter& out) const;
+        void readCheckpoint(CheckpointReader& in);
+
+        // Makes this engine, which must have no commodities or agents yet, a
+        // branch of `source` at its current tick: the same state to the bit,
+        // without going through a checkpoint. Completed candles are shared
+        // copy-on-write; commodities, books, agents and news are deep copies.
+        // Agents read this engine's runtime config. `source` must not tick
+        // meanwhile; queued external orders and callbacks stay with it.
+        void forkFrom(MarketEngine& source);
+
         using TradeCallback = std::function<void(const Trade&)>;
         using NewsCallback = std::function<void(const NewsEvent&)>;
 
@@ -66,44 +166,157 @@ namespace market {
         void setCrossEffects(const std::string& symbol, const std::vector<CrossEffect>& effects);
 
     private:
-        const RuntimeConfig* rtConfig_ = nullptr;
+        std::shared_ptr<const RuntimeConfig> rtConfig_;  // Changes only between ticks
+        const ConfigStore* configSource_ = nullptr;
 
         std::map<std::string, std::unique_ptr<Commodity>> commodities_;
+        OrderIdSequence orderIds_;  // Shared by every book of this engine
         std::map<std::string, std::unique_ptr<OrderBook>> orderBooks_;
+        // Agents' hot state under the "columns" agent layout, one row per
+        // bound agent and as wide as symbols_; empty otherwise
+        AgentColumns agentColumns_;
         std::vector<std::unique_ptr<Agent>> agents_;
 
+        SymbolRegistry symbols_;
+        AgentTypeRegistry agentTypes_;  // id 0 is always "User"
+        std::vector<Commodity*> commodityById_;
+        std::vector<OrderBook*> bookById_;
+        std::vector<AgentTypeId> agentTypeIds_;  // parallel to agents_
+        // Maximal runs of same-class agents in agents_; the factory emits a
+        // population type by type, so each run is normally one whole type
+        std::vector<AgentRun> agentRuns_;
+
         NewsGenerator newsGenerator_;
         SimClock simClock_;
         CandleAggregator candleAggregator_;
 
-        std::vector<NewsEvent> recentNews_;
         static constexpr size_t MAX_RECENT_NEWS = 20;
+        RingBuffer<NewsEvent> recentNews_{ MAX_RECENT_NEWS };
+        // Feed entries held before every agent is caught up and the feed compacted
+        static constexpr size_t MAX_PENDING_SENTIMENT_NEWS = 256;
 
+        // Cross-effects as configured (by name) and compiled into a dense matrix by
+        // SymbolId. Targets may be registered after their source, so the matrix is
+        // rebuilt whenever a commodity or effect list is added.
         std::map<std::string, std::vector<CrossEffect>> crossEffects_;
+        CrossEffectMatrix crossMatrix_;
+
+        // Dense per-symbol buffers behind marketState_, overwritten in place each
+        // tick; price histories are viewed where the commodities keep them
+        MarketState marketState_;
+        std::vector<Price> statePrices_;
+        std::vector<SupplyDemand> stateSupplyDemand_;
+        std::vector<ConstSpan<Price>> stateHistory_;
+        std::vector<Volume> stateVolumes_;
+        std::vector<const PriceIndicators*> stateIndicators_;
+        std::vector<double> stateReturns_;
+        std::vector<double> stateImpliedMoves_;
 
         double globalSentiment_ = 0.0;
+        SentimentFeed sentimentFeed_;  // Agents read news and decay from here lazily
 
         uint64_t totalTicks_ = 0;
         uint64_t totalTrades_ = 0;
         uint64_t totalOrders_ = 0;
+        uint64_t lastTickTrades_ = 0;
+        uint64_t lastTickOrders_ = 0;
+
+        TickProfiler profiler_;
+
+        TradeRing recentTrades_;  // Capacity from simulation.tradeLogCapacity
+
+        std::vector<AgentTypeStats> agentTypeStats_;  // indexed by AgentTypeId
+
+        // AgentId -> index into agents_; ids not in here (e.g. 0 for user orders)
+        // are external counterparties
+        std::unordered_map<AgentId, size_t> agentIndexById_;
+        static constexpr size_t NO_AGENT = static_cast<size_t>(-1);
+        size_t agentIndexOf(AgentId id) const {
+            auto it = agentIndexById_.find(id);
+            return it != agentIndexById_.end() ? it->second : NO_AGENT;
+        }
+
+        // Fill routing scratch, reused across ticks: (agent index, trade index)
+        // pairs sorted by agent, and the trades gathered in that order
+        std::vector<std::pair<size_t, size_t>> fillRoutes_;
+        std::vector<Trade> routedFills_;
+
+        OrderIngressQueue ingress_;
+
+        // Shared by the parallel phases. Matching writes per-book trade lists that are
+        // merged in SymbolId order; agents decide into per-agent batches that are
+        // submitted in agent order. Either way the result matches a serial run.
+        std::unique_ptr<WorkerPool> workerPool_;
+        std::vector<std::vector<Trade>> bookTrades_;  // per-SymbolId scratch, reused
+        std::vector<OrderBatch> decisions_;           // parallel to agents_, reused
+        std::vector<std::vector<OrderAction>> bookActions_;  // per-SymbolId, agent order
+        std::vector<double> gateDraws_;               // per-agent reaction gate draws for this tick
+
+        struct PendingAck {
+            std::shared_ptr<std::promise<OrderAck>> promise;
+            Volume requested = 0;
+            Volume filled = 0;
+            double notional = 0.0;
+            bool cancelled = false;  // By a cancel later in the same drain
+        };
+        std::unordered_map<OrderId, PendingAck> pendingAcks_;
+
+        // Published copy of the symbol set, swapped atomically on add/reset
+        std::shared_ptr<const std::unordered_set<std::string>> publishedSymbols_;
+
+        std::shared_ptr<const MarketSnapshot> snapshot_ = std::make_shared<const MarketSnapshot>();
+        uint64_t snapshotVersion_ = 0;
+
+        TradeCallback tradeCallback_;
+        NewsCallback newsCallback_;
 
-        std::deque<Trade> recentTrades_;
-        static constexpr size_t MAX_RECENT_TRADES = 1000;
+        OrderJournal* journal_ = nullptr;
+        JournalEntry journalEntry_;  // This tick's, reused
 
-        std::map<std::string, AgentTypeStats> agentTypeStats_;
+        void registerAgentType(Agent& agent);
+        bool columnLayout() const { return rtConfig_ && rtConfig_->simulation.agentLayout == "columns"; }
 
-        std::map<AgentId, std::string> agentIdToType_;
+        void rejectPendingExternalOrders(const std::string& reason);
 
-        TradeCallback tradeCallback_;
-        NewsCallback newsCallback_;
+        void resolveCrossEffects();
 
-        void processNews(const std::vector<NewsEvent>& news);
+        void processNews(std::vector<NewsEvent>& news);
 
         void updateSupplyDemand(double tickScale);
 
+        void publishMarketState();
+
         void processAgentOrders();
 
-        void matchAllOrders();
+        // tick(), or replay() of a TICK entry when `replay` is set
+        void runTick(const JournalEntry* replay);
+        void applyJournaledActions(const std::vector<OrderAction>& actions);
+        void addJournaledUserOrders(const std::vector<OrderAction>& actions);
+        void checkReplay(const JournalEntry& entry) const;
+        void countPlacedOrder(AgentTypeStats& stats, const Order& order);
+
+        void drainExternalOrders();
+
+        void resolveExternalAcks();
+
+        void publishSymbols();
+
+        // Agents are not told of fills during replay
+        void matchAllOrders(bool notifyAgents = true);
+
+        // Runs fn(begin, end) over [0, count) split into contiguous chunks on up
+        // to `threads` threads (0 = hardware concurrency, 1 = inline)
+        void runParallel(int threads, size_t count, const std::function<void(size_t, size_t)>& fn);
+
+        // Calls fn(run, begin, end) for each agent run overlapping [begin, end)
+        template <typename Fn>
+        void forEachAgentRun(size_t begin, size_t end, Fn&& fn) const {
+            for (const AgentRun& run : agentRuns_) {
+                size_t b = std::max(begin, run.begin);
+                size_t e = std::min(end, run.end);
+                if (b < e) fn(run, b, e);
+            }
+        }
 
         void updatePrices(const std::vector<Trade>& trades);
 
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "core/Types.hpp"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace market {
+
+    // Read-only copy of the market as of one publication, for readers that
+    // must not take the engine lock (API endpoints, the SSE stream). The
+    // engine builds a new one and swaps it in atomically; a published
+    // snapshot never changes, so a reader may keep and serialize it at
+    // leisure while ticks go on.
+    struct MarketSnapshot {
+        static constexpr int BOOK_DEPTH = 10;
+        static constexpr size_t RECENT_NEWS = 5;
+        static constexpr size_t RECENT_TRADES = 256;
+
+        struct CommodityView {
+            std::string symbol;
+            std::string name;
+            std::string category;
+            Price price = 0.0;
+            Price tickSize = 0.0;
+            Volume dailyVolume = 0;
+            double change = 0.0;  // One-tick return
+            SupplyDemand supplyDemand;
+            size_t bidOrders = 0;  // Resting orders on each side of the book
+            size_t askOrders = 0;
+            Candle lastCandle{};  // Newest completed 1-minute candle; time 0 before the first
+        };
+
+        struct TradeView {
+            uint64_t seq = 0;         // In the engine's trade log
+            uint32_t commodity = 0;   // Index into commodities
+            Price price = 0.0;
+            Volume quantity = 0;
+            Timestamp timestamp = 0;
+        };
+
+        uint64_t version = 0;  // Increases with every publication of an engine
+        uint64_t tick = 0;     // Engine ticks run when published
+        Timestamp simTimestamp = 0;
+        std::string simDate;
+        std::string simDateTime;
+
+        std::vector<CommodityView> commodities;        // By symbol
+        std::map<std::string, OrderBookSnapshot> books; // Top BOOK_DEPTH levels
+        std::vector<NewsEvent> recentNews;             // Newest last, at most RECENT_NEWS
+        std::vector<TradeView> recentTrades;           // Newest last, at most RECENT_TRADES
+
+        uint64_t totalTrades = 0;
+        uint64_t totalOrders = 0;
+        uint64_t tickTrades = 0;  // Trades and orders of the last engine tick
+        uint64_t tickOrders = 0;
+        double avgSpread = 0.0;
+    };
+
+} // namespace market
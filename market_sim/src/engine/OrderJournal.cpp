@@ -0,0 +1,150 @@
+#include "OrderJournal.hpp"
+#include "utils/Logger.hpp"
+#include <chrono>
+#include <filesystem>
+#include <stdexcept>
+
+namespace market {
+
+    namespace {
+        constexpr uint32_t START_TAG = checkpoint::tag("STRT");
+        constexpr uint32_t TICK_TAG = checkpoint::tag("TICK");
+        constexpr uint32_t FLUSH_TAG = checkpoint::tag("FLSH");
+
+        // The writer wakes this often, or sooner once this much is pending
+        constexpr auto FLUSH_INTERVAL = std::chrono::milliseconds(100);
+        constexpr size_t FLUSH_BYTES = 64 * 1024;
+    }
+
+    OrderJournal::OrderJournal(const std::string& path, const std::vector<char>& startState)
+        : path_(path)
+    {
+        std::filesystem::path target(path);
+        if (target.has_parent_path()) {
+            std::error_code ec;
+            std::filesystem::create_directories(target.parent_path(), ec);
+        }
+        file_.open(path, std::ios::binary | std::ios::trunc);
+        if (!file_.is_open()) throw std::runtime_error("Cannot write journal: " + path);
+
+        pending_.beginSection(START_TAG);
+        pending_.writeArray(startState);
+        pending_.endSection();
+        pendingBytes_ = pending_.size();
+
+        writer_ = std::thread([this]() { writerLoop(); });
+    }
+
+    OrderJournal::~OrderJournal() {
+        close();
+    }
+
+    void OrderJournal::append(const JournalEntry& entry) {
+        size_t pending;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closing_) return;
+            pending_.beginSection(entry.kind == JournalEntry::Kind::TICK ? TICK_TAG : FLUSH_TAG);
+            pending_.write(entry.tick);
+            pending_.writeList(entry.news);
+            NewsGenerator::writeSchedule(pending_, entry.newsSchedule);
+            pending_.write(entry.rng);
+            pending_.writeList(entry.agentActions);
+            pending_.writeList(entry.userOrders);
+            pending_.write(entry.totalTrades);
+            pending_.endSection();
+            pending = pending_.size();
+        }
+        entries_++;
+        pendingBytes_ = pending;
+        if (pending >= FLUSH_BYTES) wake_.notify_one();
+    }
+
+    void OrderJournal::close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closing_) return;
+            closing_ = true;
+        }
+        wake_.notify_one();
+        if (writer_.joinable()) writer_.join();
+        file_.close();
+        Logger::info("Journal {} closed: {} entries, {} bytes", path_, entries_.load(), bytesWritten_.load());
+    }
+
+    void OrderJournal::writerLoop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            wake_.wait_for(lock, FLUSH_INTERVAL, [this]() { return closing_ || pending_.size() >= FLUSH_BYTES; });
+            bool last = closing_;
+            std::vector<char> chunk = pending_.release();
+            pendingBytes_ = 0;
+            lock.unlock();
+
+            if (!chunk.empty() && !failed_.load()) {
+                file_.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+                file_.flush();
+                if (!file_) {
+                    failed_ = true;
+                    Logger::error("Journal {}: write failed, later entries are lost", path_);
+                }
+                else {
+                    bytesWritten_ += chunk.size();
+                }
+            }
+            if (last) return;
+            lock.lock();
+        }
+    }
+
+    nlohmann::json OrderJournal::toJson() const {
+        return {
+            {"path", path_},
+            {"entries", entries_.load()},
+            {"bytesWritten", bytesWritten_.load()},
+            {"pendingBytes", pendingBytes_.load()},
+            {"failed", failed_.load()}
+        };
+    }
+
+    JournalReader::JournalReader(const std::string& path)
+        : in_(readFile(path), journal::MAGIC, journal::VERSION, "journal")
+    {
+        in_.enterSection(START_TAG);
+        in_.readArray(startState_);
+        in_.leaveSection();
+    }
+
+    std::vector<char> JournalReader::readFile(const std::string& path) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) throw std::runtime_error("Journal not found: " + path);
+
+        std::streamsize size = file.tellg();
+        std::vector<char> data(static_cast<size_t>(std::max<std::streamsize>(size, 0)));
+        file.seekg(0);
+        if (!file.read(data.data(), size)) throw std::runtime_error("Failed reading journal: " + path);
+        return data;
+    }
+
+    bool JournalReader::next(JournalEntry& entry) {
+        if (in_.atEnd()) return false;
+        if (!in_.hasSection()) {
+            truncated_ = true;
+            return false;
+        }
+
+        uint32_t tag = in_.enterSection();
+        if (tag != TICK_TAG && tag != FLUSH_TAG) throw std::runtime_error("Invalid journal: unknown entry");
+        entry.kind = tag == TICK_TAG ? JournalEntry::Kind::TICK : JournalEntry::Kind::FLUSH;
+        in_.read(entry.tick);
+        in_.readList(entry.news);
+        NewsGenerator::readSchedule(in_, entry.newsSchedule);
+        in_.read(entry.rng);
+        in_.readList(entry.agentActions);
+        in_.readList(entry.userOrders);
+        in_.read(entry.totalTrades);
+        in_.leaveSection();
+        return true;
+    }
+
+} // namespace market
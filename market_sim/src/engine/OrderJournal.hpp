@@ -0,0 +1,112 @@
+#pragma once
+
+#include "core/Checkpoint.hpp"
+#include "core/Types.hpp"
+#include "environment/NewsGenerator.hpp"
+#include "utils/Random.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace market {
+
+    namespace journal {
+        inline constexpr char MAGIC[8] = { 'M', 'S', 'I', 'M', 'J', 'R', 'N', 'L' };
+        inline constexpr uint32_t VERSION = 3;
+    }
+
+    // Everything that reached the books in one engine tick, or in an external
+    // order flush between ticks, as MarketEngine::replay() consumes it
+    struct JournalEntry {
+        enum class Kind : uint8_t { TICK, FLUSH };
+
+        Kind kind = Kind::TICK;
+        uint64_t tick = 0;                     // Engine ticks run, this one included
+        std::vector<NewsEvent> news;           // Generated and injected, as processed
+        NewsGenerator::Schedule newsSchedule;  // After this tick's news
+        Random::Engine rng;                    // Simulation RNG before the supply/demand update
+        std::vector<OrderAction> agentActions; // Stamped with ids and owners, by book
+        std::vector<OrderAction> userOrders;   // Placed (prices resolved) and cancelled, as applied
+        uint64_t totalTrades = 0;              // Engine trade count afterwards, to catch divergence
+
+        void clear() {
+            news.clear();
+            agentActions.clear();
+            userOrders.clear();
+        }
+    };
+
+    // Append-only binary journal of a run's order flow: a header, the
+    // checkpoint the run started from, then one section per JournalEntry
+    // (core/Checkpoint.hpp container, journal magic). append() only encodes
+    // into memory; a background thread writes to the file, so the tick
+    // thread never waits on disk. A crash loses at most the unflushed tail,
+    // and a reader stops cleanly at a partial last entry.
+    class OrderJournal {
+    public:
+        // Creates (truncates) `path` and writes the header and `startState`,
+        // a Simulation checkpoint. Throws std::runtime_error if it cannot be opened.
+        OrderJournal(const std::string& path, const std::vector<char>& startState);
+        ~OrderJournal();
+
+        OrderJournal(const OrderJournal&) = delete;
+        OrderJournal& operator=(const OrderJournal&) = delete;
+
+        void append(const JournalEntry& entry);
+
+        // Writes what is pending and stops the writer; append() is then a no-op
+        void close();
+
+        const std::string& getPath() const { return path_; }
+        uint64_t getEntries() const { return entries_.load(); }
+
+        // Entries, bytes on disk and bytes waiting for the writer; any thread
+        nlohmann::json toJson() const;
+
+    private:
+        std::string path_;
+        std::ofstream file_;
+
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        CheckpointWriter pending_{ journal::MAGIC, journal::VERSION };  // Guarded by mutex_
+        bool closing_ = false;
+        std::thread writer_;
+
+        std::atomic<uint64_t> entries_{ 0 };
+        std::atomic<uint64_t> bytesWritten_{ 0 };
+        std::atomic<uint64_t> pendingBytes_{ 0 };
+        std::atomic<bool> failed_{ false };
+
+        void writerLoop();
+    };
+
+    // Reads a journal written by OrderJournal, whole, into memory
+    class JournalReader {
+    public:
+        // Throws std::runtime_error on a missing file or bad header
+        explicit JournalReader(const std::string& path);
+
+        // The checkpoint the journaled run started from
+        std::vector<char> takeStartState() { return std::move(startState_); }
+
+        // Next entry, false at the end. A partial last entry (the writer was cut
+        // off mid-flush) also ends the journal and sets truncated().
+        bool next(JournalEntry& entry);
+        bool truncated() const { return truncated_; }
+
+    private:
+        CheckpointReader in_;
+        std::vector<char> startState_;
+        bool truncated_ = false;
+
+        static std::vector<char> readFile(const std::string& path);
+    };
+
+} // namespace market
@@ -2,15 +2,24 @@
 #include "agents/Agent.hpp"
 #include "utils/Logger.hpp"
 #include "utils/Random.hpp"
+#include "core/Checkpoint.hpp"
+#include <algorithm>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 
 namespace market {
 
-    Simulation::Simulation() : tickBuffer_(1000000) {}
+    Simulation::Simulation() : tickBuffer_(1000000) {
+        // Processed news goes to the log at the tick whose prices it moved
+        engine_.setNewsCallback([this](const NewsEvent& news) {
+            tickBuffer_.recordNews(tickBuffer_.getCurrentTick(), news);
+        });
+    }
 
     Simulation::~Simulation() {
         stop();
+        stopJournal();
     }
 
     void Simulation::loadConfig(const std::string& configPath) {
@@ -27,7 +36,7 @@ namespace market {
 
     void Simulation::loadConfig(const nlohmann::json& config) {
         config_ = config;
-        rtConfig_.fromJson(config);
+        auto cfg = configStore_.update([&](RuntimeConfig& c) { c.fromJson(config); });
 
         if (config.contains("simulation")) {
             auto& s = config["simulation"];
@@ -37,11 +46,27 @@ namespace market {
             if (s.contains("populate_ticks_per_day")) populateTicksPerDay_ = s["populate_ticks_per_day"].get<int>();
             if (s.contains("populate_fine_ticks_per_day")) populateFineTicksPerDay_ = s["populate_fine_ticks_per_day"].get<int>();
             if (s.contains("populate_fine_days")) populateFineDays_ = s["populate_fine_days"].get<int>();
+            if (s.contains("seed")) setSeed(s["seed"].get<unsigned int>());
         }
+        setTickRate(tickRateMs_);
+        setTickPolicy(TickScheduler::parsePolicy(cfg->simulation.tickPolicy), cfg->simulation.maxCatchUpTicks);
 
         Logger::info("Config loaded: tickRate={}ms, ticksPerDay={}", tickRateMs_, ticksPerDay_);
     }
 
+    std::shared_ptr<const RuntimeConfig> Simulation::updateConfig(const nlohmann::json& patch) {
+        auto cfg = configStore_.update([&](RuntimeConfig& c) { c.fromJson(patch); });
+
+        if (patch.contains("simulation")) {
+            const auto& s = patch["simulation"];
+            if (s.contains("tickRateMs")) setTickRate(cfg->simulation.tickRateMs);
+            if (s.contains("tickPolicy") || s.contains("maxCatchUpTicks")) {
+                setTickPolicy(TickScheduler::parsePolicy(cfg->simulation.tickPolicy), cfg->simulation.maxCatchUpTicks);
+            }
+        }
+        return cfg;
+    }
+
     void Simulation::loadCommodities(const std::string& commoditiesPath) {
         std::ifstream file(commoditiesPath);
         if (!file.is_open()) {
@@ -53,13 +78,26 @@ namespace market {
         Logger::info("Loaded {} commodities from {}", commoditiesData_["commodities"].size(), commoditiesPath);
     }
 
+    void Simulation::setCommoditiesData(const nlohmann::json& commoditiesData) {
+        commoditiesData_ = commoditiesData;
+        Logger::info("Loaded {} commodities", commoditiesData_.value("commodities", nlohmann::json::array()).size());
+    }
+
     void Simulation::initialize() {
         std::unique_lock lock(engineMutex_);
         initializeUnlocked();
     }
 
+    void Simulation::setSeed(unsigned int seed) {
+        random_.reseed(seed);
+        seeded_ = true;
+    }
+
     void Simulation::initializeUnlocked() {
-        engine_.setRuntimeConfig(&rtConfig_);
+        if (!seeded_) setSeed(Random::currentSeed());
+        Random::ContextScope rng(random_);
+
+        engine_.setConfigSource(&configStore_);
 
         if (!commoditiesData_.is_null() && commoditiesData_.contains("commodities")) {
             createCommoditiesFromConfig();
@@ -71,13 +109,15 @@ namespace market {
         createDefaultAgents();
         seedMarketMakerInventory();
 
-        engine_.getSimClock().initialize(rtConfig_.simulation.startDate, ticksPerDay_);
+        engine_.getSimClock().initialize(engine_.getRuntimeConfig()->simulation.startDate, ticksPerDay_);
 
         tickBuffer_.clear();
         for (const auto& [symbol, commodity] : engine_.getCommodities()) {
             tickBuffer_.addSymbol(symbol);
         }
 
+        engine_.publishSnapshot();
+
         Logger::info("Simulation initialized with {} commodities and {} agents",
             engine_.getCommodities().size(), engine_.getAgents().size());
     }
@@ -86,12 +126,14 @@ namespace market {
         Logger::info("[SIM] reinitialize() - acquiring lock...");
         std::unique_lock lock(engineMutex_);
         Logger::info("[SIM] reinitialize() - lock acquired, resetting engine");
+        closeJournalUnlocked("reinitialize");
         engine_.reset();
         initializeUnlocked();
         Logger::info("[SIM] reinitialize() - done");
     }
 
     void Simulation::createCommoditiesFromConfig() {
+        const RuntimeConfig& cfg = *engine_.getRuntimeConfig();
         for (const auto& c : commoditiesData_["commodities"]) {
             std::string symbol = c.value("symbol", "");
             std::string name = c.value("name", symbol);
@@ -101,18 +143,23 @@ namespace market {
             double baseConsumption = c.value("baseConsumption", 100.0);
             double volatility = c.value("volatility", 0.02);
             double initialInventory = c.value("initialInventory", 50.0);
+            double tickSize = c.value("tickSize", 0.01);
+            int historyDepth = c.value("historyDepth", cfg.commodity.historyDepth);
 
             auto commodity = std::make_unique<Commodity>(
                 symbol, name, category, initialPrice,
                 baseProduction, baseConsumption, volatility, initialInventory
             );
 
+            commodity->setTickSize(tickSize);
+            commodity->setHistoryCapacity(static_cast<size_t>(std::max(historyDepth, 1)));
+
             // Apply runtime config to commodity
-            commodity->setImpactDampening(rtConfig_.commodity.impactDampening);
-            commodity->setPriceFloor(rtConfig_.commodity.priceFloor);
-            commodity->setMaxDailyMove(rtConfig_.commodity.circuitBreakerLimit);
-            commodity->setSupplyDecayRate(rtConfig_.commodity.supplyDecayRate);
-            commodity->setDemandDecayRate(rtConfig_.commodity.demandDecayRate);
+            commodity->setImpactDampening(cfg.commodity.impactDampening);
+            commodity->setPriceFloor(cfg.commodity.priceFloor);
+            commodity->setMaxDailyMove(cfg.commodity.circuitBreakerLimit);
+            commodity->setSupplyDecayRate(cfg.commodity.supplyDecayRate);
+            commodity->setDemandDecayRate(cfg.commodity.demandDecayRate);
 
             if (c.contains("crossEffects")) {
                 std::vector<CrossEffect> effects;
@@ -130,6 +177,7 @@ namespace market {
     }
 
     void Simulation::createDefaultCommodities() {
+        const RuntimeConfig& cfg = *engine_.getRuntimeConfig();
         std::vector<std::tuple<std::string, std::string, std::string, double>> defaults = {
             {"OIL", "Crude Oil", "Energy", 75.0},
             {"STEEL", "Steel", "Construction", 120.0},
@@ -140,12 +188,13 @@ namespace market {
 
         for (const auto& [sym, name, cat, price] : defaults) {
             auto commodity = std::make_unique<Commodity>(sym, name, cat, price);
+            commodity->setHistoryCapacity(static_cast<size_t>(std::max(cfg.commodity.historyDepth, 1)));
             // Apply runtime config to commodity
-            commodity->setImpactDampening(rtConfig_.commodity.impactDampening);
-            commodity->setPriceFloor(rtConfig_.commodity.priceFloor);
-            commodity->setMaxDailyMove(rtConfig_.commodity.circuitBreakerLimit);
-            commodity->setSupplyDecayRate(rtConfig_.commodity.supplyDecayRate);
-            commodity->setDemandDecayRate(rtConfig_.commodity.demandDecayRate);
+            commodity->setImpactDampening(cfg.commodity.impactDampening);
+            commodity->setPriceFloor(cfg.commodity.priceFloor);
+            commodity->setMaxDailyMove(cfg.commodity.circuitBreakerLimit);
+            commodity->setSupplyDecayRate(cfg.commodity.supplyDecayRate);
+            commodity->setDemandDecayRate(cfg.commodity.demandDecayRate);
             engine_.addCommodity(std::move(commodity));
         }
 
@@ -156,30 +205,35 @@ namespace market {
     }
 
     void Simulation::createDefaultAgents() {
+        const RuntimeConfig& cfg = *engine_.getRuntimeConfig();
         auto agents = AgentFactory::createPopulation(
-            rtConfig_.agentCounts.supplyDemand,
-            rtConfig_.agentCounts.momentum,
-            rtConfig_.agentCounts.meanReversion,
-            rtConfig_.agentCounts.noise,
-            rtConfig_.agentCounts.marketMaker,
-            rtConfig_.agentCounts.crossEffects,
-            rtConfig_.agentCounts.inventory,
-            rtConfig_.agentCounts.event,
-            rtConfig_.agentCash.meanCash,
-            rtConfig_.agentCash.stdCash,
-            &rtConfig_
+            cfg.agentCounts.supplyDemand,
+            cfg.agentCounts.momentum,
+            cfg.agentCounts.meanReversion,
+            cfg.agentCounts.noise,
+            cfg.agentCounts.marketMaker,
+            cfg.agentCounts.crossEffects,
+            cfg.agentCounts.inventory,
+            cfg.agentCounts.event,
+            cfg.agentCash.meanCash,
+            cfg.agentCash.stdCash,
+            &cfg
         );
 
         engine_.addAgents(std::move(agents));
     }
 
     void Simulation::seedMarketMakerInventory() {
-        int invPerCommodity = rtConfig_.marketMaker.initialInventoryPerCommodity;
-
-        for (auto& agent : engine_.getMutableAgents()) {
-            if (agent->getType() == "MarketMaker") {
+        const RuntimeConfig& cfg = *engine_.getRuntimeConfig();
+        int invPerCommodity = cfg.marketMaker.initialInventoryPerCommodity;
+
+        AgentTypeId marketMaker = engine_.getAgentTypeRegistry().find("MarketMaker");
+        auto& agents = engine_.getMutableAgents();
+        const auto& typeIds = engine_.getAgentTypeIds();
+        for (size_t i = 0; i < agents.size(); ++i) {
+            if (typeIds[i] == marketMaker) {
                 for (const auto& [symbol, commodity] : engine_.getCommodities()) {
-                    agent->seedInventory(symbol, invPerCommodity, commodity->getPrice());
+                    agents[i]->seedInventory(engine_.getSymbolId(symbol), invPerCommodity, commodity->getPrice());
                 }
             }
         }
@@ -192,6 +246,7 @@ namespace market {
         populateStartDate_ = startDate;
 
         std::unique_lock lock(engineMutex_);
+        Random::ContextScope rng(random_);
 
         int normalDays = std::max(0, days - populateFineDays_);
         int fineDays = std::min(populateFineDays_, days);
@@ -208,6 +263,7 @@ namespace market {
 
                 if (i % populateTicksPerDay_ == 0) {
                     populateCurrentDay_ = i / populateTicksPerDay_;
+                    engine_.publishSnapshot();
                 }
 
                 if (i % (populateTicksPerDay_ * 10) == 0) {
@@ -231,6 +287,7 @@ namespace market {
 
                 if (i % populateFineTicksPerDay_ == 0) {
                     populateCurrentDay_ = normalDays + (i / populateFineTicksPerDay_);
+                    engine_.publishSnapshot();
                 }
 
                 if (i % (populateFineTicksPerDay_ * 2) == 0) {
@@ -243,6 +300,7 @@ namespace market {
         }
 
         engine_.getSimClock().setTicksPerDay(ticksPerDay_);
+        engine_.publishSnapshot();
         populateCurrentDay_ = days;
         populating_ = false;
         populateTargetDays_ = 0;
@@ -251,6 +309,13 @@ namespace market {
             engine_.getSimClock().currentDateString());
     }
 
+    uint64_t Simulation::getPopulateTickCount(int days) const {
+        int normalDays = std::max(0, days - populateFineDays_);
+        int fineDays = std::min(populateFineDays_, days);
+        return static_cast<uint64_t>(normalDays) * populateTicksPerDay_ +
+               static_cast<uint64_t>(std::max(0, fineDays)) * populateFineTicksPerDay_;
+    }
+
     void Simulation::populateTicks(uint64_t targetTicks, const std::string& startDate) {
         populating_ = true;
         populateTargetDays_ = 0;
@@ -258,6 +323,7 @@ namespace market {
         populateStartDate_ = startDate;
 
         std::unique_lock lock(engineMutex_);
+        Random::ContextScope rng(random_);
 
         tickBuffer_.clear();
         for (const auto& [symbol, commodity] : engine_.getCommodities()) {
@@ -278,11 +344,13 @@ namespace market {
             recordTickToBuffer();
 
             if (i % reportInterval == 0) {
+                engine_.publishSnapshot();
                 Logger::info("Populate progress: {}/{} ticks ({:.1f}%)",
                     i + 1, targetTicks, 100.0 * (i + 1) / targetTicks);
             }
         }
 
+        engine_.publishSnapshot();
         populating_ = false;
         Logger::info("Populate complete. Total ticks: {}", currentTick_.load());
     }
@@ -309,6 +377,7 @@ namespace market {
 
     void Simulation::stop() {
         running_ = false;
+        scheduler_.interrupt();
         if (simThread_.joinable()) {
             simThread_.join();
         }
@@ -319,12 +388,14 @@ namespace market {
         stop();
         currentTick_ = 0;
         std::unique_lock lock(engineMutex_);
+        closeJournalUnlocked("reset");
         engine_.reset();
         Logger::info("Simulation reset");
     }
 
     void Simulation::step(int count) {
         std::unique_lock lock(engineMutex_);
+        Random::ContextScope rng(random_);
         for (int i = 0; i < count; ++i) {
             engine_.tick();
             currentTick_++;
@@ -334,20 +405,37 @@ namespace market {
                 break;
             }
         }
+        engine_.publishSnapshot();
+    }
+
+    void Simulation::flushExternalOrders() {
+        bool ticking = (running_.load() && !paused_.load()) || populating_.load();
+        if (ticking) return;
+
+        std::unique_lock lock(engineMutex_);
+        engine_.processExternalOrders();
+        engine_.publishSnapshot();
     }
 
     void Simulation::runLoop() {
+        scheduler_.start();
         while (running_.load()) {
-            if (!paused_.load()) {
-                step(1);
-
-                if (maxTicks_ > 0 && currentTick_ >= maxTicks_) {
-                    running_ = false;
-                    break;
-                }
+            if (paused_.load()) {
+                // Resuming starts a fresh schedule instead of catching up the pause
+                std::this_thread::sleep_for(std::chrono::milliseconds(std::clamp(tickRateMs_.load(), 1, 50)));
+                scheduler_.rebase();
+                continue;
             }
+            if (!scheduler_.waitUntilDue()) break;
+
+            scheduler_.tickStarted();
+            step(1);
+            scheduler_.tickFinished();
 
-            std::this_thread::sleep_for(std::chrono::milliseconds(tickRateMs_));
+            if (maxTicks_ > 0 && currentTick_ >= maxTicks_) {
+                running_ = false;
+                break;
+            }
         }
     }
 
@@ -356,7 +444,7 @@ namespace market {
     }
 
     nlohmann::json Simulation::getStateJson() const {
-        // No mutex needed — all fields are std::atomic, so /state works during populate
+        // No mutex needed — atomics and the published snapshot, so /state works during populate
         nlohmann::json state;
         state["running"] = running_.load();
         state["paused"] = paused_.load();
@@ -366,15 +454,8 @@ namespace market {
             {"target", populateTargetDays_.load()},
             {"current", populateCurrentDay_.load()}
         };
-        // simDate needs the engine — only safe when not populating
         if (!populating_.load()) {
-            try {
-                std::shared_lock lock(engineMutex_);
-                state["simDate"] = engine_.getSimClock().currentDateString();
-            }
-            catch (...) {
-                state["simDate"] = "unknown";
-            }
+            state["simDate"] = getSnapshot()->simDate;
         }
         else {
             state["simDate"] = "populating...";
@@ -383,23 +464,25 @@ namespace market {
     }
 
     nlohmann::json Simulation::getCommoditiesJson() const {
-        std::shared_lock lock(engineMutex_);
+        auto snapshot = getSnapshot();
 
         nlohmann::json arr = nlohmann::json::array();
-        for (const auto& [symbol, commodity] : engine_.getCommodities()) {
+        for (const auto& commodity : snapshot->commodities) {
+            const SupplyDemand& sd = commodity.supplyDemand;
             nlohmann::json c;
-            c["symbol"] = symbol;
-            c["name"] = commodity->getName();
-            c["category"] = commodity->getCategory();
-            c["price"] = commodity->getPrice();
-            c["dailyVolume"] = commodity->getDailyVolume();
+            c["symbol"] = commodity.symbol;
+            c["name"] = commodity.name;
+            c["category"] = commodity.category;
+            c["price"] = commodity.price;
+            c["tickSize"] = commodity.tickSize;
+            c["dailyVolume"] = commodity.dailyVolume;
             c["supplyDemand"] = {
-                {"production", commodity->getSupplyDemand().production},
-                {"consumption", commodity->getSupplyDemand().consumption},
-                {"imports", commodity->getSupplyDemand().imports},
-                {"exports", commodity->getSupplyDemand().exports},
-                {"inventory", commodity->getSupplyDemand().inventory},
-                {"imbalance", commodity->getSupplyDemand().getImbalance()}
+                {"production", sd.production},
+                {"consumption", sd.consumption},
+                {"imports", sd.imports},
+                {"exports", sd.exports},
+                {"inventory", sd.inventory},
+                {"imbalance", sd.getImbalance()}
             };
             arr.push_back(c);
         }
@@ -409,9 +492,14 @@ namespace market {
     nlohmann::json Simulation::getAgentSummaryJson() const {
         std::shared_lock lock(engineMutex_);
 
+        std::vector<int> countById(engine_.getAgentTypeRegistry().size(), 0);
+        for (AgentTypeId id : engine_.getAgentTypeIds()) {
+            countById[id]++;
+        }
+
         std::map<std::string, int> counts;
-        for (const auto& agent : engine_.getAgents()) {
-            counts[agent->getType()]++;
+        for (AgentTypeId id = 0; id < countById.size(); ++id) {
+            if (countById[id] > 0) counts[engine_.getAgentTypeName(id)] = countById[id];
         }
 
         nlohmann::json arr = nlohmann::json::array();
@@ -422,26 +510,307 @@ namespace market {
     }
 
     nlohmann::json Simulation::getMetricsJson() const {
-        std::shared_lock lock(engineMutex_);
+        auto snapshot = getSnapshot();
 
-        auto metrics = engine_.getMetrics();
         nlohmann::json m;
-        m["totalTicks"] = metrics.totalTicks;
-        m["totalTrades"] = metrics.totalTrades;
-        m["totalOrders"] = metrics.totalOrders;
-        m["avgSpread"] = metrics.avgSpread;
+        m["totalTicks"] = snapshot->tick;
+        m["totalTrades"] = snapshot->totalTrades;
+        m["totalOrders"] = snapshot->totalOrders;
+        m["avgSpread"] = snapshot->avgSpread;
+        m["snapshotVersion"] = snapshot->version;
+        m["scheduler"] = scheduler_.toJson();
+        m["tickPhases"] = engine_.getProfiler().toJson();
+        m["tickBuffer"] = {
+            {"published", tickBuffer_.getPublishedTicks()},
+            {"applied", tickBuffer_.getAppliedTicks()},
+            {"queued", tickBuffer_.getQueuedTicks()},
+            {"capacity", tickBuffer_.getPipelineCapacity()},
+            {"producerStalls", tickBuffer_.getProducerStalls()},
+            {"storageBytes", tickBuffer_.getStorageBytes()},
+            {"compression", tickBuffer_.isCompressionEnabled()},
+            {"news", tickBuffer_.getNewsCount()},
+            {"newsBytes", tickBuffer_.getNewsBytes()},
+            {"store", tickBuffer_.hasStore()},
+            {"storeSegments", tickBuffer_.getStoreSegmentCount()},
+            {"storeMappedBytes", tickBuffer_.getStoreMappedBytes()},
+            {"storeErrors", tickBuffer_.getStoreErrors()}
+        };
+        m["logging"] = {
+            {"async", Logger::isAsync()},
+            {"dropped", Logger::droppedMessages()}
+        };
         return m;
     }
 
-    void Simulation::restore(const nlohmann::json& stateData) {
-        Logger::warn("State restoration not yet implemented");
-        throw std::runtime_error("State restoration not implemented");
+    void Simulation::writePrometheus(PrometheusWriter& out) const {
+        auto snapshot = getSnapshot();
+
+        out.counter("market_ticks_total", "Engine ticks run", static_cast<double>(snapshot->tick));
+        out.counter("market_trades_total", "Trades executed", static_cast<double>(snapshot->totalTrades));
+        out.counter("market_orders_total", "Orders submitted", static_cast<double>(snapshot->totalOrders));
+        out.gauge("market_tick_trades", "Trades in the last tick", static_cast<double>(snapshot->tickTrades));
+        out.gauge("market_tick_orders", "Orders in the last tick", static_cast<double>(snapshot->tickOrders));
+        out.gauge("market_avg_spread", "Mean bid-ask spread over books with both sides", snapshot->avgSpread);
+        out.gauge("market_snapshot_version", "Read snapshots published", static_cast<double>(snapshot->version));
+
+        for (const auto& view : snapshot->commodities) {
+            std::string symbol = PrometheusWriter::label("symbol", view.symbol);
+            out.gauge("market_book_orders", "Resting orders in the book",
+                static_cast<double>(view.bidOrders), symbol + "," + PrometheusWriter::label("side", "bid"));
+            out.gauge("market_book_orders", "Resting orders in the book",
+                static_cast<double>(view.askOrders), symbol + "," + PrometheusWriter::label("side", "ask"));
+        }
+
+        const TickProfiler& profiler = engine_.getProfiler();
+        for (size_t i = 0; i < static_cast<size_t>(TickProfiler::Phase::COUNT); ++i) {
+            auto phase = static_cast<TickProfiler::Phase>(i);
+            out.histogram("market_tick_phase_seconds", "Time spent per tick phase", profiler[phase],
+                PrometheusWriter::label("phase", TickProfiler::phaseName(phase)));
+        }
+
+        out.counter("market_scheduler_ticks_total", "Ticks run by the real-time loop",
+            static_cast<double>(scheduler_.getTicks()));
+        out.counter("market_scheduler_dropped_ticks_total", "Ticks skipped to get back on schedule",
+            static_cast<double>(scheduler_.getDroppedTicks()));
+        out.counter("market_scheduler_overruns_total", "Ticks that finished past the next deadline",
+            static_cast<double>(scheduler_.getOverruns()));
+        out.histogram("market_scheduler_lateness_seconds", "Tick start delay past its deadline",
+            scheduler_.getLateness());
+        out.histogram("market_scheduler_tick_seconds", "Real-time tick duration including bookkeeping",
+            scheduler_.getTickDuration());
+
+        out.gauge("market_tick_buffer_queued", "Recorded ticks not yet in tick storage",
+            static_cast<double>(tickBuffer_.getQueuedTicks()));
+        out.counter("market_tick_buffer_stalls_total", "Ticks that waited for room in the recording pipeline",
+            static_cast<double>(tickBuffer_.getProducerStalls()));
+        out.gauge("market_tick_buffer_bytes", "Memory held by recorded tick series",
+            static_cast<double>(tickBuffer_.getStorageBytes()));
+        out.gauge("market_tick_store_segments", "Tick store segment files",
+            static_cast<double>(tickBuffer_.getStoreSegmentCount()));
+        out.gauge("market_tick_store_mapped_bytes", "Tick store segment bytes mapped for reads",
+            static_cast<double>(tickBuffer_.getStoreMappedBytes()));
+        out.counter("market_tick_store_errors_total", "Tick store segment writes that failed",
+            static_cast<double>(tickBuffer_.getStoreErrors()));
+        out.counter("market_log_dropped_total", "Log messages the async queue overwrote when full",
+            static_cast<double>(Logger::droppedMessages()));
+    }
+
+    std::vector<char> Simulation::captureCheckpoint() const {
+        std::shared_lock lock(engineMutex_);
+        return captureCheckpointUnlocked();
+    }
+
+    std::vector<char> Simulation::captureCheckpointUnlocked() const {
+        CheckpointWriter out;
+        out.beginSection(checkpoint::tag("SIMU"));
+        out.write(random_.seed());
+        out.write(random_.engine());
+        out.write(currentTick_.load());
+        out.endSection();
+
+        engine_.writeCheckpoint(out);
+
+        out.beginSection(checkpoint::tag("TICK"));
+        tickBuffer_.writeCheckpoint(out);
+        out.endSection();
+        return out.release();
+    }
+
+    size_t Simulation::saveCheckpoint(const std::string& path) const {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<char> data = captureCheckpoint();
+        auto captured = std::chrono::steady_clock::now();
+
+        std::filesystem::path target(path);
+        if (target.has_parent_path()) {
+            std::error_code ec;
+            std::filesystem::create_directories(target.parent_path(), ec);
+        }
+
+        // A crash mid-write leaves the previous checkpoint in place
+        std::string tmp = path + ".tmp";
+        {
+            std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) throw std::runtime_error("Cannot write checkpoint: " + tmp);
+            file.write(data.data(), static_cast<std::streamsize>(data.size()));
+            if (!file) throw std::runtime_error("Failed writing checkpoint: " + tmp);
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmp, target, ec);
+        if (ec) throw std::runtime_error("Cannot move checkpoint into place: " + path + " (" + ec.message() + ")");
+
+        auto ms = [](auto d) { return std::chrono::duration_cast<std::chrono::milliseconds>(d).count(); };
+        Logger::info("Checkpoint saved to {}: {} bytes, tick {} (captured in {}ms, written in {}ms)",
+            path, data.size(), currentTick_.load(), ms(captured - start),
+            ms(std::chrono::steady_clock::now() - captured));
+        return data.size();
+    }
+
+    void Simulation::loadCheckpoint(const std::string& path) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) throw std::runtime_error("Checkpoint not found: " + path);
+
+        std::streamsize size = file.tellg();
+        std::vector<char> data(static_cast<size_t>(std::max<std::streamsize>(size, 0)));
+        file.seekg(0);
+        if (!file.read(data.data(), size)) throw std::runtime_error("Failed reading checkpoint: " + path);
+
+        auto start = std::chrono::steady_clock::now();
+        restoreCheckpoint(std::move(data));
+        Logger::info("Checkpoint {} restored in {}ms", path,
+            std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    void Simulation::restoreCheckpoint(std::vector<char> data) {
+        std::unique_lock lock(engineMutex_);
+        closeJournalUnlocked("checkpoint restore");
+        if (engine_.getCommodities().empty()) initializeUnlocked();
+
+        // Header and run identity are checked before anything is replaced
+        CheckpointReader in(std::move(data));
+        in.enterSection(checkpoint::tag("SIMU"));
+        auto seed = in.read<unsigned int>();
+        Random::Engine rng;
+        in.read(rng);
+        auto tick = in.read<uint64_t>();
+        in.leaveSection();
+
+        setSeed(seed);
+        try {
+            // Agents rebuilt from the file draw their streams from this seed
+            Random::ContextScope scope(random_);
+            engine_.readCheckpoint(in);
+
+            in.enterSection(checkpoint::tag("TICK"));
+            tickBuffer_.readCheckpoint(in);
+            in.leaveSection();
+        }
+        catch (...) {
+            Logger::error("Checkpoint restore failed, reinitializing from configuration");
+            engine_.reset();
+            initializeUnlocked();
+            currentTick_ = 0;
+            throw;
+        }
+
+        random_.engine() = rng;
+        currentTick_ = tick;
+        Logger::info("Restored simulation at tick {} ({}), seed {}",
+            tick, engine_.getSimClock().currentDateString(), seed);
+    }
+
+    std::unique_ptr<Simulation> Simulation::fork() {
+        auto start = std::chrono::steady_clock::now();
+        auto branch = std::make_unique<Simulation>();
+
+        std::unique_lock lock(engineMutex_);
+        branch->config_ = config_;
+        branch->commoditiesData_ = commoditiesData_;
+        branch->configStore_.publish(*configStore_.current());
+        branch->random_ = random_;
+        branch->seeded_ = true;
+        branch->currentTick_ = currentTick_.load();
+        branch->populateStartDate_ = populateStartDate_;
+        branch->setTickRate(tickRateMs_);
+        branch->setTickPolicy(scheduler_.getPolicy(), configStore_.current()->simulation.maxCatchUpTicks);
+        branch->maxTicks_ = maxTicks_;
+        branch->ticksPerDay_ = ticksPerDay_;
+        branch->populateTicksPerDay_ = populateTicksPerDay_;
+        branch->populateFineTicksPerDay_ = populateFineTicksPerDay_;
+        branch->populateFineDays_ = populateFineDays_;
+
+        branch->engine_.setConfigSource(&branch->configStore_);
+        branch->engine_.forkFrom(engine_);
+        branch->tickBuffer_.forkFrom(tickBuffer_);
+        lock.unlock();
+
+        Logger::info("Forked simulation at tick {} in {}us", branch->getCurrentTick(),
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+        return branch;
+    }
+
+    void Simulation::startJournal(const std::string& path) {
+        std::unique_lock lock(engineMutex_);
+        if (journal_) throw std::runtime_error("Already journaling to " + journal_->getPath());
+        if (populating_.load()) throw std::runtime_error("Cannot start a journal while populating");
+
+        // The engine holds the lock between ticks, so the journal starts exactly here
+        journal_ = std::make_unique<OrderJournal>(path, captureCheckpointUnlocked());
+        engine_.setJournal(journal_.get());
+        Logger::info("Journaling order flow to {} from tick {}", path, currentTick_.load());
+    }
+
+    void Simulation::openTickStore(const std::string& directory) {
+        std::unique_lock lock(engineMutex_);
+        tickBuffer_.attachStore(directory);
+        Logger::info("Tick store at {}: {} segments, {} ticks recorded", directory, tickBuffer_.getStoreSegmentCount(),
+            tickBuffer_.getTickCount());
+    }
+
+    void Simulation::stopJournal() {
+        std::unique_lock lock(engineMutex_);
+        closeJournalUnlocked(nullptr);
+    }
+
+    void Simulation::closeJournalUnlocked(const char* reason) {
+        if (!journal_) return;
+        if (reason) Logger::warn("Closing journal {} on {}", journal_->getPath(), reason);
+        engine_.setJournal(nullptr);
+        journal_->close();
+        journal_.reset();
+    }
+
+    bool Simulation::isJournaling() const {
+        std::shared_lock lock(engineMutex_);
+        return journal_ != nullptr;
+    }
+
+    nlohmann::json Simulation::getJournalJson() const {
+        std::shared_lock lock(engineMutex_);
+        if (!journal_) return { {"active", false} };
+        nlohmann::json j = journal_->toJson();
+        j["active"] = true;
+        return j;
+    }
+
+    uint64_t Simulation::replayJournal(const std::string& path) {
+        if (running_.load() || populating_.load()) {
+            throw std::runtime_error("Stop the simulation before replaying a journal");
+        }
+        if (isJournaling()) throw std::runtime_error("Cannot replay while journaling");
+
+        JournalReader in(path);
+        restoreCheckpoint(in.takeStartState());
+
+        auto start = std::chrono::steady_clock::now();
+        std::unique_lock lock(engineMutex_);
+        Random::ContextScope rng(random_);
+        uint64_t ticks = 0;
+        JournalEntry entry;
+        while (in.next(entry)) {
+            engine_.replay(entry);
+            if (entry.kind == JournalEntry::Kind::TICK) {
+                currentTick_++;
+                recordTickToBuffer();
+                ticks++;
+            }
+        }
+        engine_.publishSnapshot();
+
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        Logger::info("Replayed {} ticks from {} in {:.3f}s ({:.0f} ticks/s), now at tick {}",
+            ticks, path, sec, sec > 0 ? ticks / sec : 0.0, currentTick_.load());
+        if (in.truncated()) Logger::warn("Journal {} ends in a partial entry; replayed up to it", path);
+        return ticks;
     }
 
     void Simulation::recordTickToBuffer() {
+        MARKET_PROFILE_SCOPE(engine_.getProfiler()[TickProfiler::Phase::TICK_BUFFER]);
+        // Symbols were added to the buffer in this same (map) order
+        size_t index = 0;
         for (const auto& [symbol, commodity] : engine_.getCommodities()) {
             Price price = commodity->getPrice();
-            tickBuffer_.recordTick(symbol, price, price, price, price, 0);
+            tickBuffer_.recordTick(index++, price, price, price, price, 0);
         }
         tickBuffer_.advanceTick();
     }
@@ -1,12 +1,16 @@
 #pragma once
 
 #include "MarketEngine.hpp"
-#include "core/RuntimeConfig.hpp"
+#include "core/ConfigStore.hpp"
 #include "core/TickBuffer.hpp"
+#include "TickScheduler.hpp"
+#include "utils/Prometheus.hpp"
+#include "utils/Random.hpp"
 #include <atomic>
 #include <thread>
 #include <shared_mutex>
 #include <chrono>
+#include <memory>
 #include <nlohmann/json.hpp>
 
 namespace market {
@@ -20,14 +24,74 @@ namespace market {
         void loadConfig(const nlohmann::json& config);
 
         void loadCommodities(const std::string& commoditiesPath);
+        void setCommoditiesData(const nlohmann::json& commoditiesData);  // Same as loadCommodities, already parsed
 
         void initialize();
         void reinitialize();
 
         void populate(int days, const std::string& startDate = "2025-01-01");
         void populateTicks(uint64_t targetTicks, const std::string& startDate = "2025-01-01");
-
-        void restore(const nlohmann::json& stateData);
+        // Ticks populate(days) will run with the current configuration
+        uint64_t getPopulateTickCount(int days) const;
+
+        // Every random draw this simulation makes comes from its own seeded
+        // context, bound while it builds or ticks. Without a seed (setSeed() or
+        // simulation.seed) the first initialize() adopts the calling thread's
+        // current seed, so Random::seed() before a run still reproduces it.
+        void setSeed(unsigned int seed);
+        unsigned int getSeed() const { return random_.seed(); }
+
+        // Binary checkpoint of everything a run needs to continue: market and
+        // agent state, resting orders, history, the TickBuffer and RNG state
+        // (see core/Checkpoint.hpp). The state is encoded in memory under a
+        // shared engine lock, so a running tick loop only waits for that copy;
+        // the file is written after the lock is released, on the calling
+        // thread, and renamed into place once complete. Returns the bytes written.
+        size_t saveCheckpoint(const std::string& path) const;
+        std::vector<char> captureCheckpoint() const;
+
+        // Replaces the current state with a checkpoint, initializing first if
+        // needed. The configured commodities must be the ones it was taken
+        // with; agents come from the file. Throws std::runtime_error on a bad
+        // file; if the engine state was already partly replaced it is
+        // reinitialized from the configuration first.
+        void loadCheckpoint(const std::string& path);
+        void restoreCheckpoint(std::vector<char> data);
+
+        // Independent branch of this simulation at its current tick, for
+        // what-if runs: the same market, agents, history and RNG state, so
+        // stepping both reproduces the same ticks until one of them is given
+        // different input (news, orders, config). Nothing goes through a
+        // checkpoint: tick history and completed candles are shared
+        // copy-on-write, and books, agents and current market state are deep
+        // copies. Takes the engine lock only for the copy. The branch is
+        // stopped, has the hot-reloaded config as of now and its own engine
+        // lock, so it can be stepped or started on another thread.
+        std::unique_ptr<Simulation> fork();
+
+        // Order-flow journal (see OrderJournal): from now on every tick's news,
+        // agent and user orders and RNG state go to `path`, after a checkpoint
+        // of the current state. Throws std::runtime_error if one is already
+        // open or the file cannot be created. Reset, reinitialize and
+        // checkpoint restore close it, since the journaled run ends there.
+        void startJournal(const std::string& path);
+        // Flushes and closes the journal, if any
+        void stopJournal();
+        bool isJournaling() const;
+
+        // Keeps the recorded tick history in a memory-mapped TickStore under
+        // `directory`, and resumes the history already stored there (see
+        // TickBuffer::attachStore). Engine state is not stored; restore a
+        // checkpoint for that. Throws std::runtime_error on a bad directory.
+        void openTickStore(const std::string& directory);
+        nlohmann::json getJournalJson() const;
+
+        // Restores the journal's starting checkpoint and re-runs its entries
+        // through MarketEngine::replay(), as fast as the engine goes, without
+        // agent logic; returns the ticks replayed. The configured commodities
+        // must be the journaled run's. Throws std::runtime_error while running
+        // or journaling, on a bad file, or where the replay diverges.
+        uint64_t replayJournal(const std::string& path);
 
         void start();
         void pause();
@@ -37,6 +101,10 @@ namespace market {
 
         void step(int count = 1);
 
+        // Drain queued external orders now if no tick loop will pick them up
+        // (stopped or paused). Takes the engine lock only in that case.
+        void flushExternalOrders();
+
         bool isRunning() const { return running_.load(); }
         bool isPaused() const { return paused_.load(); }
         bool isPopulating() const { return populating_.load(); }
@@ -46,31 +114,68 @@ namespace market {
         int getPopulateCurrentDay() const { return populateCurrentDay_.load(); }
         std::string getPopulateStartDate() const;
 
-        void setTickRate(int ms) { tickRateMs_ = ms; }
-        int getTickRate() const { return tickRateMs_; }
-
-        RuntimeConfig& getRuntimeConfig() { return rtConfig_; }
-        const RuntimeConfig& getRuntimeConfig() const { return rtConfig_; }
+        // Real-time pacing; <= 0 ticks as fast as possible. The policy for
+        // falling behind comes from simulation.tickPolicy and
+        // simulation.maxCatchUpTicks (see TickScheduler).
+        void setTickRate(int ms) {
+            tickRateMs_ = ms;
+            scheduler_.setTickRateMs(ms);
+        }
+        int getTickRate() const { return tickRateMs_.load(); }
+        void setTickPolicy(TickScheduler::Policy policy, int maxCatchUpTicks) {
+            scheduler_.setPolicy(policy);
+            scheduler_.setMaxCatchUpTicks(maxCatchUpTicks);
+        }
+        const TickScheduler& getTickScheduler() const { return scheduler_; }
+
+        // Latest published config, an immutable snapshot; the engine puts
+        // it in force at its next tick
+        std::shared_ptr<const RuntimeConfig> getRuntimeConfig() const { return configStore_.current(); }
+
+        // Merge-patches `patch` into a copy of the config and publishes it,
+        // without the engine lock. Tick rate and policy change at once, the
+        // rest at the next tick boundary (MarketEngine::setRuntimeConfig);
+        // Agent counts, cash, generation ranges and other settings read only
+        // at construction still take a reinitialize().
+        // Throws, publishing nothing, on a value of the wrong type.
+        std::shared_ptr<const RuntimeConfig> updateConfig(const nlohmann::json& patch);
+        void resetConfig() { configStore_.publish(RuntimeConfig()); }
 
         MarketEngine& getEngine() { return engine_; }
         const MarketEngine& getEngine() const { return engine_; }
 
         std::shared_mutex& getEngineMutex() { return engineMutex_; }
 
+        // Raw config and commodity definitions as loaded (not the hot-reloaded values)
+        const nlohmann::json& getConfigJson() const { return config_; }
+        const nlohmann::json& getCommoditiesData() const { return commoditiesData_; }
+
         TickBuffer& getTickBuffer() { return tickBuffer_; }
         const TickBuffer& getTickBuffer() const { return tickBuffer_; }
 
+        // Latest published market snapshot (see MarketEngine::getSnapshot);
+        // no lock needed, so readers never hold up a tick
+        std::shared_ptr<const MarketSnapshot> getSnapshot() const { return engine_.getSnapshot(); }
+
+        // State, commodities and metrics are built from the snapshot
         nlohmann::json getStateJson() const;
         nlohmann::json getCommoditiesJson() const;
         nlohmann::json getAgentSummaryJson() const;
         nlohmann::json getMetricsJson() const;
 
+        // Tick phase and scheduler histograms, activity counters and book
+        // depth, for GET /metrics/prometheus. Lock-free like getMetricsJson.
+        void writePrometheus(PrometheusWriter& out) const;
+
     private:
         MarketEngine engine_;
-        RuntimeConfig rtConfig_;
+        ConfigStore configStore_;
         TickBuffer tickBuffer_;
         mutable std::shared_mutex engineMutex_;
 
+        Random::Context random_{ 0 };
+        bool seeded_ = false;
+
         std::atomic<bool> running_{ false };
         std::atomic<bool> paused_{ false };
         std::atomic<bool> populating_{ false };
@@ -80,7 +185,8 @@ namespace market {
         std::atomic<int> populateCurrentDay_{ 0 };
         std::string populateStartDate_;
 
-        int tickRateMs_ = 50;
+        std::atomic<int> tickRateMs_{ 50 };
+        TickScheduler scheduler_;
         int maxTicks_ = 0;
         int ticksPerDay_ = 72000;
         int populateTicksPerDay_ = 576;
@@ -92,6 +198,8 @@ namespace market {
         nlohmann::json commoditiesData_;
         nlohmann::json config_;
 
+        std::unique_ptr<OrderJournal> journal_;  // Guarded by engineMutex_
+
         void runLoop();
         void initializeUnlocked();  // initialize without locking engineMutex_
         void createCommoditiesFromConfig();
@@ -99,6 +207,8 @@ namespace market {
         void createDefaultAgents();
         void seedMarketMakerInventory();
         void recordTickToBuffer();
+        std::vector<char> captureCheckpointUnlocked() const;
+        void closeJournalUnlocked(const char* reason);
     };
 
 } // namespace market
@@ -0,0 +1,129 @@
+#include "TickScheduler.hpp"
+
+namespace market {
+
+    namespace {
+        int64_t toUs(TickScheduler::Clock::duration d) {
+            return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+        }
+    }
+
+    TickScheduler::Policy TickScheduler::parsePolicy(const std::string& str) {
+        if (str == "skip") return Policy::SKIP;
+        if (str == "stretch") return Policy::STRETCH;
+        return Policy::CATCH_UP;
+    }
+
+    const char* TickScheduler::policyName(Policy policy) {
+        switch (policy) {
+        case Policy::CATCH_UP: return "catchUp";
+        case Policy::SKIP: return "skip";
+        case Policy::STRETCH: return "stretch";
+        }
+        return "catchUp";
+    }
+
+    void TickScheduler::start(Clock::time_point now) {
+        {
+            std::lock_guard<std::mutex> lock(waitMutex_);
+            interrupted_ = false;
+        }
+        next_ = now;
+        burst_ = 0;
+        ticks_ = 0;
+        dropped_ = 0;
+        overruns_ = 0;
+        startedAtUs_ = toUs(now.time_since_epoch());
+        lateness_.reset();
+        duration_.reset();
+    }
+
+    void TickScheduler::rebase(Clock::time_point now) {
+        next_ = now + std::chrono::microseconds(periodUs_.load());
+        burst_ = 0;
+    }
+
+    bool TickScheduler::waitUntilDue() {
+        std::unique_lock<std::mutex> lock(waitMutex_);
+        wake_.wait_until(lock, next_, [this]() { return interrupted_; });
+        return !interrupted_;
+    }
+
+    void TickScheduler::interrupt() {
+        {
+            std::lock_guard<std::mutex> lock(waitMutex_);
+            interrupted_ = true;
+        }
+        wake_.notify_all();
+    }
+
+    void TickScheduler::tickStarted(Clock::time_point now) {
+        tickStart_ = now;
+        lateness_.record(static_cast<uint64_t>(std::max<int64_t>(0, toUs(now - next_))));
+    }
+
+    void TickScheduler::tickFinished(Clock::time_point now) {
+        ticks_++;
+        duration_.record(static_cast<uint64_t>(std::max<int64_t>(0, toUs(now - tickStart_))));
+
+        auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::microseconds(periodUs_.load()));
+        if (period <= Clock::duration::zero()) {
+            next_ = now;
+            return;
+        }
+
+        next_ += period;
+        if (now <= next_) {
+            burst_ = 0;
+            return;
+        }
+
+        overruns_++;
+        switch (policy_.load()) {
+        case Policy::CATCH_UP: {
+            int cap = maxCatchUpTicks_.load();
+            if (cap <= 0 || burst_ < cap) {
+                burst_++;  // next_ is in the past, so the next tick starts at once
+            }
+            else {
+                skipTo(now, period);
+                burst_ = 0;
+            }
+            break;
+        }
+        case Policy::SKIP:
+            skipTo(now, period);
+            break;
+        case Policy::STRETCH:
+            next_ = now;
+            break;
+        }
+    }
+
+    void TickScheduler::skipTo(Clock::time_point now, Clock::duration period) {
+        auto missed = (now - next_) / period + 1;
+        next_ += missed * period;
+        dropped_ += static_cast<uint64_t>(missed);
+    }
+
+    nlohmann::json TickScheduler::toJson() const {
+        int64_t periodUs = periodUs_.load();
+        uint64_t ticks = ticks_.load();
+        double elapsedSec = (toUs(Clock::now().time_since_epoch()) - startedAtUs_.load()) / 1e6;
+
+        return {
+            {"policy", policyName(policy_.load())},
+            {"tickRateMs", periodUs / 1000.0},
+            {"maxCatchUpTicks", maxCatchUpTicks_.load()},
+            {"asFastAsPossible", periodUs <= 0},
+            {"ticks", ticks},
+            {"droppedTicks", dropped_.load()},
+            {"overruns", overruns_.load()},
+            {"targetTicksPerSec", periodUs > 0 ? 1e6 / periodUs : 0.0},
+            {"ticksPerSec", ticks > 0 && elapsedSec > 0 ? ticks / elapsedSec : 0.0},
+            {"lateness", lateness_.toJson()},
+            {"tickDuration", duration_.toJson()}
+        };
+    }
+
+} // namespace market
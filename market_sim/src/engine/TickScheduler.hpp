@@ -0,0 +1,95 @@
+#pragma once
+
+#include "utils/Histogram.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <nlohmann/json.hpp>
+
+namespace market {
+
+    // Paces the real-time tick loop against absolute deadlines: tick n is due
+    // at anchor + n * period, however long the ticks before it took, so the
+    // tick rate holds as long as a tick fits in its period. The policy decides
+    // what happens to deadlines the loop has already missed. A period of 0
+    // runs ticks back to back, as fast as the engine goes.
+    //
+    // The loop thread drives it (tickStarted/tickFinished, waitUntilDue);
+    // setters, interrupt() and toJson() are safe from any thread.
+    class TickScheduler {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        enum class Policy {
+            CATCH_UP,  // Run missed ticks back to back, up to maxCatchUpTicks in a row, then drop the rest
+            SKIP,      // Drop missed deadlines; the next tick waits for the next slot on the grid
+            STRETCH    // Re-anchor the grid on the late tick; simulated time slows, never bursts
+        };
+
+        static Policy parsePolicy(const std::string& str);
+        static const char* policyName(Policy policy);
+
+        // <= 0 runs as fast as possible
+        void setTickRateMs(int ms) { periodUs_ = ms > 0 ? static_cast<int64_t>(ms) * 1000 : 0; }
+        void setPolicy(Policy policy) { policy_ = policy; }
+        // Catch-up burst cap; <= 0 catches up however far behind
+        void setMaxCatchUpTicks(int ticks) { maxCatchUpTicks_ = ticks; }
+
+        Policy getPolicy() const { return policy_.load(); }
+
+        // Anchors the first tick's deadline at `now` and clears the statistics
+        void start(Clock::time_point now = Clock::now());
+        // The next tick is due one period after `now`, with no debt carried;
+        // for resuming after a pause
+        void rebase(Clock::time_point now = Clock::now());
+
+        Clock::time_point nextDeadline() const { return next_; }
+
+        // Sleeps until the next deadline; false if interrupt() cut it short
+        bool waitUntilDue();
+        // Wakes waitUntilDue() and makes it return false until start()
+        void interrupt();
+
+        // Records the tick's lateness against its deadline
+        void tickStarted(Clock::time_point now = Clock::now());
+        // Records its duration and sets the next deadline, applying the policy
+        // if the loop is now behind
+        void tickFinished(Clock::time_point now = Clock::now());
+
+        uint64_t getTicks() const { return ticks_.load(); }
+        uint64_t getDroppedTicks() const { return dropped_.load(); }
+        uint64_t getOverruns() const { return overruns_.load(); }
+        const LatencyHistogram& getLateness() const { return lateness_; }
+        const LatencyHistogram& getTickDuration() const { return duration_; }
+
+        nlohmann::json toJson() const;
+
+    private:
+        std::atomic<int64_t> periodUs_{ 50000 };
+        std::atomic<Policy> policy_{ Policy::CATCH_UP };
+        std::atomic<int> maxCatchUpTicks_{ 10 };
+
+        // Loop thread only
+        Clock::time_point next_{};
+        Clock::time_point tickStart_{};
+        int burst_ = 0;  // Late ticks run back to back so far
+
+        std::atomic<uint64_t> ticks_{ 0 };
+        std::atomic<uint64_t> dropped_{ 0 };   // Deadlines given up by SKIP or a capped catch-up
+        std::atomic<uint64_t> overruns_{ 0 };  // Ticks that ended past the next tick's deadline
+        std::atomic<int64_t> startedAtUs_{ 0 };  // Clock time of start(), for the achieved rate
+        LatencyHistogram lateness_;
+        LatencyHistogram duration_;
+
+        std::mutex waitMutex_;
+        std::condition_variable wake_;
+        bool interrupted_ = false;
+
+        // Moves next_ to the first grid slot after `now`, counting the skipped ones
+        void skipTo(Clock::time_point now, Clock::duration period);
+    };
+
+} // namespace market
@@ -1,14 +1,31 @@
 #pragma once
 
 #include "core/Types.hpp"
+#include "core/RingBuffer.hpp"
+#include <array>
 #include <vector>
 #include <string>
 #include <map>
 
 namespace market {
 
+    class CheckpointWriter;
+    class CheckpointReader;
+
     class NewsGenerator {
     public:
+        static constexpr size_t CATEGORIES = 4;  // NewsCategory values
+
+        // When the next generated news arrives: per category (NewsCategory
+        // order) the expected events left until its next arrival, an Exp(1)
+        // draw used up at lambda * the category's share * tickScale per
+        // tick. Drawn on the first generate() so it comes from the
+        // simulation's RNG.
+        struct Schedule {
+            std::array<double, CATEGORIES> untilArrival{};
+            bool scheduled = false;
+        };
+
         NewsGenerator(double lambda = 0.1,
             double globalImpactStd = 0.02,
             double supplyImpactStd = 0.05,
@@ -18,6 +35,9 @@ namespace market {
         void setCommodityNames(const std::map<std::string, std::string>& symbolToName);
         void setCommodityCategories(const std::map<std::string, std::string>& symbolToCategory);
 
+        // Injected news plus the generated events arriving this tick. Each
+        // category's next arrival is scheduled ahead in event time (see
+        // Schedule), so a tick without news draws no random numbers.
         std::vector<NewsEvent> generate(Timestamp currentTime, double tickScale = 1.0);
 
         void injectNews(const NewsEvent& news);
@@ -29,15 +49,25 @@ namespace market {
         std::vector<NewsEvent> getRecentNews(size_t count = 5) const;
         void addToRecent(const NewsEvent& news);
 
-        const std::vector<NewsEvent>& getNewsHistory() const { return newsHistory_; }
-        void clearNewsHistory() { newsHistory_.clear(); }
-
         void setLambda(double lambda) { lambda_ = lambda; }
         void setGlobalImpactStd(double std) { globalImpactStd_ = std; }
         void setSupplyImpactStd(double std) { supplyImpactStd_ = std; }
         void setDemandImpactStd(double std) { demandImpactStd_ = std; }
         void setPoliticalImpactStd(double std) { politicalImpactStd_ = std; }
 
+        // Pending injected news, recent news and the arrival schedule; rates
+        // stay as configured.
+        // The history is the simulation's NewsLog (TickBuffer).
+        void writeCheckpoint(CheckpointWriter& out) const;
+        void readCheckpoint(CheckpointReader& in);
+
+        // The schedule after the last generate(); a journal replay, which
+        // does not generate, restores it tick by tick
+        const Schedule& getSchedule() const { return schedule_; }
+        void setSchedule(const Schedule& schedule) { schedule_ = schedule; }
+        static void writeSchedule(CheckpointWriter& out, const Schedule& schedule);
+        static void readSchedule(CheckpointReader& in, Schedule& schedule);
+
     private:
         double lambda_;
         double globalImpactStd_;
@@ -49,11 +79,26 @@ namespace market {
         std::map<std::string, std::string> symbolToName_;
         std::map<std::string, std::string> symbolToCategory_;
 
+        Schedule schedule_;
+
+        // Headlines for symbols_[i], resolved when the symbols or names
+        // change: the template lists for the symbol (null when it has
+        // none) and the fallback lines already composed with its name
+        struct SymbolHeadlines {
+            std::string name;  // Display name, the symbol when unnamed
+            const std::vector<std::string>* supplyNegative = nullptr;
+            const std::vector<std::string>* supplyPositive = nullptr;
+            const std::vector<std::string>* demandPositive = nullptr;
+            const std::vector<std::string>* demandNegative = nullptr;
+            std::string supplyDisrupted, supplyImproved, demandSurges, demandWeakens;
+        };
+        std::vector<SymbolHeadlines> headlines_;  // Parallel to symbols_
+        void rebuildHeadlines();
+        static SymbolHeadlines makeHeadlines(const std::string& symbol, const std::string& name);
+
         std::vector<NewsEvent> injectedNews_;
-        std::vector<NewsEvent> recentNews_;
-        std::vector<NewsEvent> newsHistory_;
         static constexpr size_t MAX_RECENT = 20;
-        static constexpr size_t MAX_HISTORY = 50000;
+        RingBuffer<NewsEvent> recentNews_{ MAX_RECENT };
 
         NewsEvent generateGlobalNews(Timestamp time);
         NewsEvent generatePoliticalNews(Timestamp time);
@@ -62,6 +107,7 @@ namespace market {
 
         std::string generateHeadline(NewsCategory category, NewsSentiment sentiment,
             const std::string& symbol, const std::string& name);
+        std::string symbolHeadline(NewsCategory category, NewsSentiment sentiment, const SymbolHeadlines& h);
     };
 
 } // namespace market
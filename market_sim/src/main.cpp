@@ -1,6 +1,9 @@
 #include "engine/Simulation.hpp"
+#include "engine/EnsembleRunner.hpp"
 #include "api/ApiServer.hpp"
 #include "utils/Logger.hpp"
+#include <chrono>
+#include <fstream>
 #include <iostream>
 #include <csignal>
 
@@ -8,6 +11,7 @@ using namespace market;
 
 static Simulation* g_sim = nullptr;
 static ApiServer* g_api = nullptr;
+static EnsembleRunner* g_ensemble = nullptr;
 
 void signalHandler(int signal) {
     std::cout << "\nReceived signal " << signal << ", shutting down..." << std::endl;
@@ -18,6 +22,43 @@ void signalHandler(int signal) {
     if (g_api) {
         g_api->stop();
     }
+    if (g_ensemble) {
+        g_ensemble->cancel();
+    }
+}
+
+// Runs the ensemble to completion without starting the API server
+static int runEnsemble(const std::string& configPath, const EnsembleOptions& options) {
+    nlohmann::json config = nlohmann::json::object();
+    std::ifstream file(configPath);
+    if (file.is_open()) {
+        file >> config;
+    }
+    else {
+        Logger::warn("Config file not found: {}, using defaults", configPath);
+    }
+    // The config file also holds the commodity definitions
+    nlohmann::json commodities = config.contains("commodities") ? config : nlohmann::json();
+
+    EnsembleRunner runner(config, commodities, options);
+    g_ensemble = &runner;
+    runner.start();
+
+    while (!runner.isDone()) {
+        std::this_thread::sleep_for(std::chrono::seconds(5));
+        auto progress = runner.getProgressJson();
+        Logger::info("Ensemble progress: {}/{} done, {} running, {:.1f}% of ticks",
+            progress["completed"].get<size_t>(), progress["replicas"].get<size_t>(),
+            progress["running"].get<size_t>(), 100.0 * progress["progress"].get<double>());
+    }
+    runner.wait();
+    g_ensemble = nullptr;
+
+    auto progress = runner.getProgressJson();
+    Logger::info("Ensemble complete: {} done, {} failed, {} skipped in {:.1f}s; results in {}",
+        progress["completed"].get<size_t>(), progress["failed"].get<size_t>(),
+        progress["skipped"].get<size_t>(), progress["elapsedSec"].get<double>(), options.outputDir);
+    return progress["failed"].get<size_t>() > 0 ? 1 : 0;
 }
 
 int main(int argc, char* argv[]) {
@@ -34,6 +75,18 @@ int main(int argc, char* argv[]) {
     bool exportOnStart = false;
     int populateDays = 180;
     uint64_t populateTicksCount = 1000000;
+    int ensembleReplicas = 0;
+    int ensembleParallel = 0;
+    bool hasSeed = false;
+    unsigned int seed = 1;
+    std::string restorePath;
+    std::string checkpointPath;
+    std::string journalPath;
+    std::string replayPath;
+    bool tickStore = false;
+    bool compressTicks = false;
+    std::string logLevel = "info";
+    Logger::AsyncOptions logAsync;
 
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
@@ -67,6 +120,51 @@ int main(int argc, char* argv[]) {
         else if (arg == "--export-on-start") {
             exportOnStart = true;
         }
+        else if (arg == "--seed" && i + 1 < argc) {
+            seed = static_cast<unsigned int>(std::stoul(argv[++i]));
+            hasSeed = true;
+        }
+        else if (arg == "--restore" && i + 1 < argc) {
+            restorePath = argv[++i];
+        }
+        else if (arg == "--checkpoint" && i + 1 < argc) {
+            checkpointPath = argv[++i];
+        }
+        else if (arg == "--journal" && i + 1 < argc) {
+            journalPath = argv[++i];
+        }
+        else if (arg == "--replay" && i + 1 < argc) {
+            replayPath = argv[++i];
+        }
+        else if (arg == "--tick-store") {
+            tickStore = true;
+        }
+        else if (arg == "--compress-ticks") {
+            compressTicks = true;
+        }
+        else if (arg == "--log-level" && i + 1 < argc) {
+            logLevel = argv[++i];
+        }
+        else if (arg == "--log-async") {
+            logAsync.enabled = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                std::string policy = argv[++i];
+                if (policy != "block" && policy != "drop") {
+                    std::cerr << "--log-async: expected block or drop, got " << policy << "\n";
+                    return 1;
+                }
+                logAsync.dropOldest = policy == "drop";
+            }
+        }
+        else if (arg == "--log-queue" && i + 1 < argc) {
+            logAsync.queueSize = std::stoul(argv[++i]);
+        }
+        else if (arg == "--ensemble" && i + 1 < argc) {
+            ensembleReplicas = std::stoi(argv[++i]);
+        }
+        else if (arg == "--ensemble-parallel" && i + 1 < argc) {
+            ensembleParallel = std::stoi(argv[++i]);
+        }
         else if (arg == "--help") {
             std::cout << "Commodity Market Simulation Engine\n"
                 << "Usage: market_sim [options]\n"
@@ -79,32 +177,98 @@ int main(int argc, char* argv[]) {
                 << "  --populate [days]       Populate historical data by days (default: 180 days)\n"
                 << "  --populate-ticks [n]    Populate exactly N ticks (default: 1000000)\n"
                 << "  --export-on-start       Export data after population\n"
+                << "  --seed <n>              Random seed (ensemble: seed of replica 0)\n"
+                << "  --restore <file>        Resume from a binary checkpoint instead of populating;\n"
+                << "                          falls back to --populate if the file cannot be loaded\n"
+                << "  --checkpoint <file>     Write a binary checkpoint after populating\n"
+                << "  --journal <file>        Journal the order flow from startup (after populating)\n"
+                << "  --replay <file>         Replay a journal at full speed without agents, then exit\n"
+                << "  --tick-store            Keep tick history in memory-mapped segments under\n"
+                << "                          <data-dir>/ticks and resume it on the next start\n"
+                << "  --compress-ticks        Keep full in-memory tick chunks compressed\n"
+                << "  --log-level <level>     trace, debug, info, warn or error (default: info);\n"
+                << "                          levels below the build's MARKET_LOG_LEVEL are compiled out\n"
+                << "  --log-async [policy]    Write logs on a background thread; when its queue is full,\n"
+                << "                          block the caller (default) or drop the oldest message\n"
+                << "  --log-queue <n>         Async log queue size in messages (default: 8192)\n"
+                << "  --ensemble <n>          Populate N independent replicas in parallel, export\n"
+                << "                          each to <data-dir>/ensemble/replica_<i>, then exit\n"
+                << "                          (uses --populate [days] or --populate-ticks [n])\n"
+                << "  --ensemble-parallel <k> Replicas run at once (default: one per core)\n"
                 << "  --help                  Show this help\n";
             return 0;
         }
     }
 
     try {
-        Logger::init("commodity_sim.log", "info", true);
+        Logger::init("commodity_sim.log", logLevel, true, logAsync);
 
         Logger::info("=== Commodity Market Simulation Engine ===");
         Logger::info("Config: {}", configPath);
         Logger::info("API: {}:{}", host, port);
         Logger::info("Data directory: {}", dataDir);
 
+        if (ensembleReplicas > 0) {
+            EnsembleOptions options;
+            options.replicas = ensembleReplicas;
+            options.maxParallel = ensembleParallel;
+            options.baseSeed = hasSeed ? seed : 1;
+            options.days = populateDays;
+            options.ticks = populateByTicks ? populateTicksCount : 0;
+            options.outputDir = dataDir + "/ensemble";
+            int code = runEnsemble(configPath, options);
+            Logger::shutdown();
+            return code;
+        }
+
         Simulation sim;
         g_sim = &sim;
+        if (hasSeed) sim.setSeed(seed);
 
         sim.loadConfig(configPath);
         sim.loadCommodities(configPath);
         sim.initialize();
 
+        if (!replayPath.empty()) {
+            auto start = std::chrono::steady_clock::now();
+            uint64_t ticks = sim.replayJournal(replayPath);
+            double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            auto metrics = sim.getEngine().getMetrics();
+            Logger::info("Replay complete: {} ticks in {:.2f}s, {} trades", ticks, sec, metrics.totalTrades);
+            Logger::shutdown();
+            return 0;
+        }
+
+        if (compressTicks) sim.getTickBuffer().setCompression(true);
+
+        // Populating or restoring below replaces the stored history
+        if (tickStore) {
+            sim.openTickStore(dataDir + "/ticks");
+        }
+
         ApiServer api(sim, host, port);
         g_api = &api;
 
         api.start();
 
-        if (populateByTicks) {
+        bool restored = false;
+        if (!restorePath.empty()) {
+            try {
+                Logger::info("Restoring checkpoint {}...", restorePath);
+                sim.loadCheckpoint(restorePath);
+                restored = true;
+            }
+            catch (const std::exception& e) {
+                if (!populate && !populateByTicks) throw;
+                Logger::warn("Cannot restore {}: {}; populating instead", restorePath, e.what());
+            }
+        }
+
+        // A restored checkpoint already holds the populated history
+        if (restored) {
+            Logger::info("Resumed at tick {}", sim.getCurrentTick());
+        }
+        else if (populateByTicks) {
             Logger::info("Populating {} ticks...", populateTicksCount);
             sim.populateTicks(populateTicksCount);
             Logger::info("Population complete. {} ticks generated.", sim.getCurrentTick());
@@ -115,6 +279,10 @@ int main(int argc, char* argv[]) {
             Logger::info("Population complete");
         }
 
+        if (!restored && !checkpointPath.empty() && (populate || populateByTicks)) {
+            sim.saveCheckpoint(checkpointPath);
+        }
+
         if (exportOnStart && (populate || populateByTicks)) {
             Logger::info("Exporting tick data to {}...", dataDir);
             
@@ -129,6 +297,10 @@ int main(int argc, char* argv[]) {
             }
         }
 
+        if (!journalPath.empty()) {
+            sim.startJournal(journalPath);
+        }
+
         if (autoStart) {
             sim.start();
         }
@@ -143,9 +315,11 @@ int main(int argc, char* argv[]) {
     }
     catch (const std::exception& e) {
         Logger::error("Fatal error: {}", e.what());
+        Logger::shutdown();
         return 1;
     }
 
     Logger::info("Shutdown complete");
+    Logger::shutdown();
     return 0;
 }
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace market {
+
+    // Text output for bulk exports. Numbers are formatted with std::to_chars
+    // (locale-independent, no stream state) straight into one large buffer,
+    // which goes to the stream in a single write whenever it fills, so the
+    // stream sees a few large writes instead of one call per field. The
+    // output can also be any sink taking blocks, such as an HTTP response.
+    class FormatBuffer {
+    public:
+        static constexpr size_t DEFAULT_CAPACITY = 1 << 20;
+
+        // Returns false once the output is gone; later writes are dropped
+        using Sink = std::function<bool(const char* data, size_t size)>;
+
+        explicit FormatBuffer(std::ostream& out, size_t capacity = DEFAULT_CAPACITY)
+            : FormatBuffer([&out](const char* data, size_t size) {
+                    out.write(data, static_cast<std::streamsize>(size));
+                    return !out.fail();
+                }, capacity) {}
+
+        explicit FormatBuffer(Sink sink, size_t capacity = DEFAULT_CAPACITY)
+            : sink_(std::move(sink)), buffer_(capacity < MAX_NUMBER * 2 ? MAX_NUMBER * 2 : capacity) {}
+
+        ~FormatBuffer() { flush(); }
+
+        FormatBuffer(const FormatBuffer&) = delete;
+        FormatBuffer& operator=(const FormatBuffer&) = delete;
+
+        FormatBuffer& put(char c) {
+            reserve(1);
+            buffer_[size_++] = c;
+            return *this;
+        }
+
+        FormatBuffer& put(std::string_view s) {
+            if (s.size() > buffer_.size() - size_) {
+                flush();
+                if (s.size() > buffer_.size()) {
+                    write(s.data(), s.size());
+                    return *this;
+                }
+            }
+            s.copy(buffer_.data() + size_, s.size());
+            size_ += s.size();
+            return *this;
+        }
+
+        // `s` with JSON string escapes for quotes, backslashes and \n \r \t
+        FormatBuffer& putEscaped(std::string_view s) {
+            for (char c : s) {
+                switch (c) {
+                    case '"': put("\\\""); break;
+                    case '\\': put("\\\\"); break;
+                    case '\n': put("\\n"); break;
+                    case '\r': put("\\r"); break;
+                    case '\t': put("\\t"); break;
+                    default: put(c);
+                }
+            }
+            return *this;
+        }
+
+        FormatBuffer& putUInt(uint64_t v) { return number(v); }
+
+        // Shortest text that reads back as the same float
+        FormatBuffer& putShortest(float v) { return number(v); }
+
+        // Like operator<< with setprecision(precision): %g style
+        FormatBuffer& putGeneral(double v, int precision = 6) {
+            return number(v, std::chars_format::general, precision);
+        }
+
+        // Like std::fixed << setprecision(precision)
+        FormatBuffer& putFixed(double v, int precision) {
+            return number(v, std::chars_format::fixed, precision);
+        }
+
+        // Writes out the buffered text; false once the output has failed
+        bool flush() {
+            if (size_ > 0) write(buffer_.data(), size_);
+            size_ = 0;
+            return ok_;
+        }
+
+        bool good() const { return ok_; }
+
+    private:
+        // Room for any double in fixed notation with a few decimals
+        static constexpr size_t MAX_NUMBER = 384;
+
+        Sink sink_;
+        std::vector<char> buffer_;
+        size_t size_ = 0;
+        bool ok_ = true;
+
+        void write(const char* data, size_t size) {
+            if (ok_) ok_ = sink_(data, size);
+        }
+
+        void reserve(size_t n) {
+            if (buffer_.size() - size_ < n) flush();
+        }
+
+        template <typename... Format>
+        FormatBuffer& number(Format... args) {
+            reserve(MAX_NUMBER);
+            char* begin = buffer_.data() + size_;
+            auto result = std::to_chars(begin, buffer_.data() + buffer_.size(), args...);
+            if (result.ec == std::errc()) size_ += static_cast<size_t>(result.ptr - begin);
+            return *this;
+        }
+    };
+
+} // namespace market
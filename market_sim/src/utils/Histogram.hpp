@@ -0,0 +1,97 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+
+namespace market {
+
+    // Histogram of durations in microseconds, in power-of-two buckets: bucket
+    // 0 is [0, 1], bucket i is (2^(i-1), 2^i], and the last one also takes
+    // everything longer. Recording is a handful of relaxed atomic adds, so a
+    // hot loop can record while other threads read; a reader may see a
+    // sample in `count` a moment before it shows in its bucket.
+    class LatencyHistogram {
+    public:
+        static constexpr size_t BUCKETS = 28;  // Last finite bound 2^26us, about 67s
+
+        void record(uint64_t us) {
+            size_t b = 0;
+            while (b < BUCKETS - 1 && (uint64_t{ 1 } << b) < us) ++b;
+            buckets_[b].fetch_add(1, std::memory_order_relaxed);
+            count_.fetch_add(1, std::memory_order_relaxed);
+            sum_.fetch_add(us, std::memory_order_relaxed);
+            uint64_t seen = max_.load(std::memory_order_relaxed);
+            while (us > seen && !max_.compare_exchange_weak(seen, us, std::memory_order_relaxed)) {}
+        }
+
+        void reset() {
+            for (auto& b : buckets_) b.store(0, std::memory_order_relaxed);
+            count_.store(0, std::memory_order_relaxed);
+            sum_.store(0, std::memory_order_relaxed);
+            max_.store(0, std::memory_order_relaxed);
+        }
+
+        uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+        uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+        uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+        uint64_t bucketCount(size_t bucket) const { return buckets_[bucket].load(std::memory_order_relaxed); }
+        double mean() const {
+            uint64_t n = count();
+            return n > 0 ? static_cast<double>(sum()) / n : 0.0;
+        }
+
+        // Upper bound of the bucket holding the q-th quantile, capped at the
+        // largest sample; 0 when empty
+        uint64_t percentile(double q) const {
+            uint64_t total = 0;
+            uint64_t counts[BUCKETS];
+            for (size_t i = 0; i < BUCKETS; ++i) {
+                counts[i] = buckets_[i].load(std::memory_order_relaxed);
+                total += counts[i];
+            }
+            if (total == 0) return 0;
+
+            auto rank = static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * total));
+            rank = std::max<uint64_t>(rank, 1);
+            uint64_t seen = 0;
+            for (size_t i = 0; i < BUCKETS; ++i) {
+                seen += counts[i];
+                if (seen >= rank) return std::min(upperBound(i), max());
+            }
+            return max();
+        }
+
+        static uint64_t upperBound(size_t bucket) { return uint64_t{ 1 } << bucket; }
+
+        // Summary plus the non-empty buckets; the last bucket's bound is "+Inf"
+        nlohmann::json toJson() const {
+            nlohmann::json buckets = nlohmann::json::array();
+            for (size_t i = 0; i < BUCKETS; ++i) {
+                uint64_t n = buckets_[i].load(std::memory_order_relaxed);
+                if (n == 0) continue;
+                nlohmann::json bound = i + 1 < BUCKETS ? nlohmann::json(upperBound(i)) : nlohmann::json("+Inf");
+                buckets.push_back({ {"leUs", bound}, {"count", n} });
+            }
+            return {
+                {"count", count()},
+                {"meanUs", mean()},
+                {"p50Us", percentile(0.50)},
+                {"p90Us", percentile(0.90)},
+                {"p99Us", percentile(0.99)},
+                {"maxUs", max()},
+                {"buckets", buckets}
+            };
+        }
+
+    private:
+        std::atomic<uint64_t> buckets_[BUCKETS] = {};
+        std::atomic<uint64_t> count_{ 0 };
+        std::atomic<uint64_t> sum_{ 0 };
+        std::atomic<uint64_t> max_{ 0 };
+    };
+
+} // namespace market
@@ -1,32 +1,79 @@
 #pragma once
 
 #include <spdlog/spdlog.h>
+#include <spdlog/async.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/sinks/basic_file_sink.h>
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <string>
 
+// Lowest level compiled in, as an spdlog level number (0 trace, 1 debug,
+// 2 info, 3 warn, 4 error). Set by the CMake cache variable MARKET_LOG_LEVEL;
+// Release builds default to info. Calls below it compile to nothing, and
+// MARKET_LOG_TRACE / MARKET_LOG_DEBUG do not evaluate their arguments then.
+#ifndef MARKET_LOG_LEVEL
+#define MARKET_LOG_LEVEL 0
+#endif
+
+// Logs only when `level` is compiled in and enabled at run time; the
+// arguments are evaluated only in that case
+#define MARKET_LOG_AT_(level, method, ...) \
+    do { \
+        if constexpr (::market::Logger::compiledIn(level)) { \
+            if (::market::Logger::shouldLog(level)) ::market::Logger::method(__VA_ARGS__); \
+        } \
+    } while (0)
+
+#define MARKET_LOG_TRACE(...) MARKET_LOG_AT_(::spdlog::level::trace, trace, __VA_ARGS__)
+#define MARKET_LOG_DEBUG(...) MARKET_LOG_AT_(::spdlog::level::debug, debug, __VA_ARGS__)
+
 namespace market {
 
 class Logger {
 public:
+    // Asynchronous mode: callers format the message and queue it; one
+    // background thread writes the sinks. A full queue either blocks the
+    // caller or overwrites the oldest queued message
+    struct AsyncOptions {
+        bool enabled = false;
+        size_t queueSize = 8192;   // Messages
+        bool dropOldest = false;   // On overflow, instead of blocking
+    };
+
     static void init(const std::string& filename = "market_sim.log",
                      const std::string& level = "info",
                      bool console = true) {
+        init(filename, level, console, AsyncOptions());
+    }
+
+    static void init(const std::string& filename, const std::string& level, bool console,
+                     const AsyncOptions& async) {
         std::vector<spdlog::sink_ptr> sinks;
-        
+
         if (console) {
             auto consoleSink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
             consoleSink->set_level(spdlog::level::trace);
             sinks.push_back(consoleSink);
         }
-        
+
         auto fileSink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(filename, true);
         fileSink->set_level(spdlog::level::trace);
         sinks.push_back(fileSink);
-        
-        auto logger = std::make_shared<spdlog::logger>("market", sinks.begin(), sinks.end());
-        
+
+        std::shared_ptr<spdlog::logger> logger;
+        if (async.enabled) {
+            spdlog::init_thread_pool(std::max<size_t>(async.queueSize, 1), 1);
+            logger = std::make_shared<spdlog::async_logger>("market", sinks.begin(), sinks.end(),
+                spdlog::thread_pool(), async.dropOldest
+                    ? spdlog::async_overflow_policy::overrun_oldest : spdlog::async_overflow_policy::block);
+        }
+        else {
+            logger = std::make_shared<spdlog::logger>("market", sinks.begin(), sinks.end());
+        }
+        async_ = async.enabled;
+
         // Set level
         if (level == "trace") logger->set_level(spdlog::level::trace);
         else if (level == "debug") logger->set_level(spdlog::level::debug);
@@ -34,42 +81,78 @@ public:
         else if (level == "warn") logger->set_level(spdlog::level::warn);
         else if (level == "error") logger->set_level(spdlog::level::err);
         else logger->set_level(spdlog::level::info);
-        
-        logger->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%^%l%$] [%n] %v");
-        
+
+        logger->set_pattern(PATTERN);
+
         spdlog::set_default_logger(logger);
         spdlog::flush_every(std::chrono::seconds(1));
     }
-    
+
+    // Writes out everything queued and stops the async writer; later messages
+    // go to the same sinks synchronously. Call before exiting.
+    static void shutdown() {
+        if (!async_) return;
+        auto queued = spdlog::default_logger();
+        auto logger = std::make_shared<spdlog::logger>(queued->name(), queued->sinks().begin(), queued->sinks().end());
+        logger->set_level(queued->level());
+        logger->set_pattern(PATTERN);
+        spdlog::set_default_logger(logger);
+        queued.reset();
+        // The pool drains its queue before its thread exits
+        spdlog::details::registry::instance().set_tp(nullptr);
+        async_ = false;
+    }
+
     static std::shared_ptr<spdlog::logger> get() {
         return spdlog::default_logger();
     }
-    
+
+    static constexpr bool compiledIn(spdlog::level::level_enum level) {
+        return static_cast<int>(level) >= MARKET_LOG_LEVEL;
+    }
+
+    static bool shouldLog(spdlog::level::level_enum level) {
+        return spdlog::default_logger_raw()->should_log(level);
+    }
+
+    static bool isAsync() { return async_; }
+
+    // Messages the async queue overwrote because it was full
+    static size_t droppedMessages() {
+        if (!async_) return 0;
+        auto pool = spdlog::thread_pool();
+        return pool ? pool->overrun_counter() : 0;
+    }
+
     // Convenience methods
     template<typename... Args>
     static void trace(fmt::format_string<Args...> fmt, Args&&... args) {
-        spdlog::trace(fmt, std::forward<Args>(args)...);
+        if constexpr (compiledIn(spdlog::level::trace)) spdlog::trace(fmt, std::forward<Args>(args)...);
     }
-    
+
     template<typename... Args>
     static void debug(fmt::format_string<Args...> fmt, Args&&... args) {
-        spdlog::debug(fmt, std::forward<Args>(args)...);
+        if constexpr (compiledIn(spdlog::level::debug)) spdlog::debug(fmt, std::forward<Args>(args)...);
     }
-    
+
     template<typename... Args>
     static void info(fmt::format_string<Args...> fmt, Args&&... args) {
-        spdlog::info(fmt, std::forward<Args>(args)...);
+        if constexpr (compiledIn(spdlog::level::info)) spdlog::info(fmt, std::forward<Args>(args)...);
     }
-    
+
     template<typename... Args>
     static void warn(fmt::format_string<Args...> fmt, Args&&... args) {
-        spdlog::warn(fmt, std::forward<Args>(args)...);
+        if constexpr (compiledIn(spdlog::level::warn)) spdlog::warn(fmt, std::forward<Args>(args)...);
     }
-    
+
     template<typename... Args>
     static void error(fmt::format_string<Args...> fmt, Args&&... args) {
-        spdlog::error(fmt, std::forward<Args>(args)...);
+        if constexpr (compiledIn(spdlog::level::err)) spdlog::error(fmt, std::forward<Args>(args)...);
     }
+
+private:
+    static constexpr const char* PATTERN = "[%Y-%m-%d %H:%M:%S.%e] [%^%l%$] [%n] %v";
+    static inline std::atomic<bool> async_{ false };
 };
 
 } // namespace market
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "Histogram.hpp"
+#include <chrono>
+#include <cstddef>
+#include <nlohmann/json.hpp>
+
+// Scoped timers are compiled in when MARKET_PROFILING is non-zero (CMake
+// option ENABLE_PROFILING, on by default). Without it MARKET_PROFILE_SCOPE
+// expands to nothing and its argument is not evaluated.
+#ifndef MARKET_PROFILING
+#define MARKET_PROFILING 0
+#endif
+
+#define MARKET_PROFILE_CONCAT_(a, b) a##b
+#define MARKET_PROFILE_CONCAT(a, b) MARKET_PROFILE_CONCAT_(a, b)
+
+#if MARKET_PROFILING
+// Records the time to the end of the enclosing scope into `histogram`
+#define MARKET_PROFILE_SCOPE(histogram) \
+    ::market::ScopedTimer MARKET_PROFILE_CONCAT(profileScope_, __LINE__)(histogram)
+#else
+#define MARKET_PROFILE_SCOPE(histogram) static_cast<void>(0)
+#endif
+
+namespace market {
+
+    // Adds the microseconds between construction and destruction to a histogram
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(LatencyHistogram& histogram)
+            : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+        ~ScopedTimer() {
+            auto elapsed = std::chrono::steady_clock::now() - start_;
+            histogram_.record(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+        }
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        LatencyHistogram& histogram_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    // One histogram per tick phase, filled by MARKET_PROFILE_SCOPE in
+    // MarketEngine::tick(), publishSnapshot() and the Simulation's tick recording
+    class TickProfiler {
+    public:
+        enum class Phase : size_t {
+            TICK,             // All of MarketEngine::tick()
+            NEWS,             // Generating and applying news
+            SENTIMENT,        // Feed advance and global sentiment decay
+            SUPPLY_DEMAND,
+            AGENT_ORDERS,     // Decisions and order submission
+            EXTERNAL_ORDERS,  // Draining queued user orders
+            MATCHING,
+            ACKS,             // Resolving user order acks
+            CANDLES,
+            TICK_BUFFER,      // Simulation: recording the tick for export
+            SNAPSHOT,         // Publishing the read snapshot
+            COUNT
+        };
+
+        static const char* phaseName(Phase phase) {
+            switch (phase) {
+            case Phase::TICK: return "tick";
+            case Phase::NEWS: return "news";
+            case Phase::SENTIMENT: return "sentiment";
+            case Phase::SUPPLY_DEMAND: return "supply_demand";
+            case Phase::AGENT_ORDERS: return "agent_orders";
+            case Phase::EXTERNAL_ORDERS: return "external_orders";
+            case Phase::MATCHING: return "matching";
+            case Phase::ACKS: return "acks";
+            case Phase::CANDLES: return "candles";
+            case Phase::TICK_BUFFER: return "tick_buffer";
+            case Phase::SNAPSHOT: return "snapshot";
+            case Phase::COUNT: break;
+            }
+            return "unknown";
+        }
+
+        LatencyHistogram& operator[](Phase phase) { return phases_[static_cast<size_t>(phase)]; }
+        const LatencyHistogram& operator[](Phase phase) const { return phases_[static_cast<size_t>(phase)]; }
+
+        void reset() {
+            for (auto& h : phases_) h.reset();
+        }
+
+        // p50/p99/max and counts per phase, in microseconds
+        nlohmann::json toJson() const {
+            nlohmann::json j = nlohmann::json::object();
+            for (size_t i = 0; i < static_cast<size_t>(Phase::COUNT); ++i) {
+                const LatencyHistogram& h = phases_[i];
+                j[phaseName(static_cast<Phase>(i))] = {
+                    {"count", h.count()},
+                    {"meanUs", h.mean()},
+                    {"p50Us", h.percentile(0.50)},
+                    {"p99Us", h.percentile(0.99)},
+                    {"maxUs", h.max()}
+                };
+            }
+            return j;
+        }
+
+    private:
+        LatencyHistogram phases_[static_cast<size_t>(Phase::COUNT)];
+    };
+
+} // namespace market
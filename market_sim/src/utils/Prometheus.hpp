@@ -0,0 +1,103 @@
+#pragma once
+
+#include "Histogram.hpp"
+#include <cstdint>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace market {
+
+    // Builds a Prometheus text exposition (format 0.0.4). Samples are grouped
+    // under their family's HELP/TYPE header in the order families were first
+    // used, so callers may write labelled series of several families
+    // interleaved. `labels` is a preformatted list such as
+    // label("phase", "matching"), or empty.
+    class PrometheusWriter {
+    public:
+        static constexpr const char* CONTENT_TYPE = "text/plain; version=0.0.4; charset=utf-8";
+
+        void counter(const std::string& name, const std::string& help, double value, const std::string& labels = "") {
+            sample(family(name, help, "counter"), name, labels, value);
+        }
+
+        void gauge(const std::string& name, const std::string& help, double value, const std::string& labels = "") {
+            sample(family(name, help, "gauge"), name, labels, value);
+        }
+
+        // Microsecond LatencyHistogram exported in seconds as `name`, with
+        // cumulative buckets, plus `name`_quantile (p50, p99) and `name`_max gauges
+        void histogram(const std::string& name, const std::string& help, const LatencyHistogram& h,
+            const std::string& labels = "") {
+            std::string sep = labels.empty() ? "" : ",";
+            Family& f = family(name, help, "histogram");
+            uint64_t cumulative = 0;
+            for (size_t i = 0; i < LatencyHistogram::BUCKETS; ++i) {
+                cumulative += h.bucketCount(i);
+                std::string le = i + 1 < LatencyHistogram::BUCKETS
+                    ? number(LatencyHistogram::upperBound(i) / 1e6) : "+Inf";
+                sample(f, name + "_bucket", labels + sep + label("le", le), static_cast<double>(cumulative));
+            }
+            sample(f, name + "_sum", labels, h.sum() / 1e6);
+            sample(f, name + "_count", labels, static_cast<double>(cumulative));
+
+            for (double q : { 0.5, 0.99 }) {
+                gauge(name + "_quantile", help + " (bucket upper bound at quantile)", h.percentile(q) / 1e6,
+                    labels + sep + label("quantile", number(q)));
+            }
+            gauge(name + "_max", help + " (largest sample)", h.max() / 1e6, labels);
+        }
+
+        static std::string label(const std::string& key, const std::string& value) {
+            std::string escaped;
+            for (char c : value) {
+                if (c == '\n') { escaped += "\\n"; continue; }
+                if (c == '\\' || c == '"') escaped += '\\';
+                escaped += c;
+            }
+            return key + "=\"" + escaped + "\"";
+        }
+
+        std::string str() const {
+            std::string out;
+            for (const auto& f : families_) {
+                out += "# HELP " + f.name + ' ' + f.help + '\n';
+                out += "# TYPE " + f.name + ' ' + f.type + '\n';
+                out += f.samples;
+            }
+            return out;
+        }
+
+    private:
+        struct Family {
+            std::string name;
+            std::string help;
+            std::string type;
+            std::string samples;
+        };
+
+        std::vector<Family> families_;
+        std::map<std::string, size_t> index_;
+
+        Family& family(const std::string& name, const std::string& help, const char* type) {
+            auto [it, inserted] = index_.emplace(name, families_.size());
+            if (inserted) families_.push_back({ name, help, type, "" });
+            return families_[it->second];
+        }
+
+        static void sample(Family& f, const std::string& name, const std::string& labels, double value) {
+            f.samples += name;
+            if (!labels.empty()) f.samples += '{' + labels + '}';
+            f.samples += ' ' + number(value) + '\n';
+        }
+
+        static std::string number(double v) {
+            std::ostringstream s;
+            s.precision(9);
+            s << v;
+            return s.str();
+        }
+    };
+
+} // namespace market
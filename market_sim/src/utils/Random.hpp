@@ -2,62 +2,299 @@
 
 #include <random>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 
 namespace market {
 
+// Philox4x32-10 counter-based generator (Salmon et al., "Parallel random
+// numbers: as easy as 1, 2, 3"). Output block n is a pure function of
+// (key, counter n), so a stream is identified by its key and can jump to any
+// position in O(1). Here the key is (seed, stream id) and the counter's high
+// word is a caller-chosen epoch (the tick), giving (seed, agent, tick) streams.
+class Philox4x32 {
+public:
+    using result_type = uint32_t;
+
+    Philox4x32(uint64_t seed = 0, uint64_t stream = 0) {
+        key_[0] = static_cast<uint32_t>(seed) ^ static_cast<uint32_t>(stream >> 32);
+        key_[1] = static_cast<uint32_t>(seed >> 32) ^ static_cast<uint32_t>(stream);
+        key_[0] ^= static_cast<uint32_t>(stream) * 0x9E3779B9u;
+        seek(0);
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<uint32_t>::max(); }
+
+    // Restart at block 0 of `epoch`; drops any buffered output
+    void seek(uint64_t epoch) {
+        counter_[0] = 0;
+        counter_[1] = 0;
+        counter_[2] = static_cast<uint32_t>(epoch);
+        counter_[3] = static_cast<uint32_t>(epoch >> 32);
+        index_ = 4;
+        hasSpareNormal_ = false;
+    }
+
+    // Complete position, buffered output included, for checkpoints
+    struct State {
+        uint32_t key[2];
+        uint32_t counter[4];
+        uint32_t buffer[4];
+        int32_t index;
+        bool hasSpareNormal;
+        double spareNormal;
+    };
+
+    State getState() const {
+        State s{};
+        for (int i = 0; i < 2; ++i) s.key[i] = key_[i];
+        for (int i = 0; i < 4; ++i) s.counter[i] = counter_[i];
+        for (int i = 0; i < 4; ++i) s.buffer[i] = buffer_[i];
+        s.index = index_;
+        s.hasSpareNormal = hasSpareNormal_;
+        s.spareNormal = spareNormal_;
+        return s;
+    }
+
+    void setState(const State& s) {
+        for (int i = 0; i < 2; ++i) key_[i] = s.key[i];
+        for (int i = 0; i < 4; ++i) counter_[i] = s.counter[i];
+        for (int i = 0; i < 4; ++i) buffer_[i] = s.buffer[i];
+        index_ = s.index >= 0 && s.index <= 4 ? s.index : 4;
+        hasSpareNormal_ = s.hasSpareNormal;
+        spareNormal_ = s.spareNormal;
+    }
+
+    result_type operator()() {
+        if (index_ == 4) {
+            uint32_t c[4] = { counter_[0], counter_[1], counter_[2], counter_[3] };
+            generate(c, key_, buffer_);
+            if (++counter_[0] == 0) ++counter_[1];
+            index_ = 0;
+        }
+        return buffer_[index_++];
+    }
+
+    uint64_t next64() {
+        uint64_t hi = (*this)();
+        return (hi << 32) | (*this)();
+    }
+
+    // Fills out[0..4*blocks) with blocks [first, first+blocks) of `epoch`,
+    // without touching this engine's position. Lanes are independent, so the
+    // rounds below compile to vector multiplies.
+    void generateBlocks(uint64_t epoch, uint64_t first, size_t blocks, uint32_t* out) const {
+        constexpr size_t LANES = 16;
+        uint32_t c0[LANES], c1[LANES], c2[LANES], c3[LANES];
+        for (size_t base = 0; base < blocks; base += LANES) {
+            size_t lanes = blocks - base < LANES ? blocks - base : LANES;
+            for (size_t l = 0; l < LANES; ++l) {
+                uint64_t n = first + base + l;
+                c0[l] = static_cast<uint32_t>(n);
+                c1[l] = static_cast<uint32_t>(n >> 32);
+                c2[l] = static_cast<uint32_t>(epoch);
+                c3[l] = static_cast<uint32_t>(epoch >> 32);
+            }
+            uint32_t k0 = key_[0], k1 = key_[1];
+            for (int r = 0; r < ROUNDS; ++r) {
+                for (size_t l = 0; l < LANES; ++l) {
+                    uint64_t p0 = static_cast<uint64_t>(M0) * c0[l];
+                    uint64_t p1 = static_cast<uint64_t>(M1) * c2[l];
+                    uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1[l] ^ k0;
+                    uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3[l] ^ k1;
+                    c1[l] = static_cast<uint32_t>(p1);
+                    c3[l] = static_cast<uint32_t>(p0);
+                    c0[l] = n0;
+                    c2[l] = n2;
+                }
+                k0 += W0;
+                k1 += W1;
+            }
+            for (size_t l = 0; l < lanes; ++l) {
+                uint32_t* o = out + 4 * (base + l);
+                o[0] = c0[l];
+                o[1] = c1[l];
+                o[2] = c2[l];
+                o[3] = c3[l];
+            }
+        }
+    }
+
+private:
+    friend class Random;
+
+    static constexpr int ROUNDS = 10;
+    static constexpr uint32_t M0 = 0xD2511F53u;
+    static constexpr uint32_t M1 = 0xCD9E8D57u;
+    static constexpr uint32_t W0 = 0x9E3779B9u;
+    static constexpr uint32_t W1 = 0xBB67AE85u;
+
+    uint32_t key_[2];
+    uint32_t counter_[4];
+    uint32_t buffer_[4];
+    int index_ = 4;
+
+    bool hasSpareNormal_ = false;  // Box-Muller produces pairs
+    double spareNormal_ = 0.0;
+
+    static void generate(uint32_t c[4], const uint32_t key[2], uint32_t out[4]) {
+        uint32_t k0 = key[0], k1 = key[1];
+        for (int r = 0; r < ROUNDS; ++r) {
+            uint64_t p0 = static_cast<uint64_t>(M0) * c[0];
+            uint64_t p1 = static_cast<uint64_t>(M1) * c[2];
+            uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c[1] ^ k0;
+            uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c[3] ^ k1;
+            c[1] = static_cast<uint32_t>(p1);
+            c[3] = static_cast<uint32_t>(p0);
+            c[0] = n0;
+            c[2] = n2;
+            k0 += W0;
+            k1 += W1;
+        }
+        out[0] = c[0];
+        out[1] = c[1];
+        out[2] = c[2];
+        out[3] = c[3];
+    }
+};
+
 class Random {
 public:
-    // Get singleton random engine
-    static std::mt19937& engine() {
-        static std::mt19937 gen(std::random_device{}());
-        return gen;
-    }
-    
-    // Set seed for reproducibility
-    static void seed(unsigned int s) {
-        engine().seed(s);
-    }
-    
-    // Uniform distribution [min, max]
+    using Engine = Philox4x32;
+
+    // Stream ids below this are free for per-agent streams (the agent id)
+    static constexpr uint64_t GLOBAL_STREAM = ~0ULL;
+    static constexpr uint64_t GATE_STREAM = ~0ULL - 1;
+
+    // A seed and the engine behind the calls below when no stream is active.
+    // There is no process-wide engine: each Simulation owns a Context and binds
+    // it while it runs, so replicas in one process share no random state. A
+    // thread with nothing bound uses its own default Context.
+    class Context {
+    public:
+        explicit Context(unsigned int seed) { reseed(seed); }
+
+        void reseed(unsigned int s) {
+            seed_ = s;
+            engine_ = Engine(s, GLOBAL_STREAM);
+        }
+        unsigned int seed() const { return seed_; }
+        Engine& engine() { return engine_; }
+        const Engine& engine() const { return engine_; }
+
+    private:
+        unsigned int seed_ = 0;
+        Engine engine_;
+    };
+
+    // Routes this thread's Random calls to `context` until the scope closes
+    class ContextScope {
+    public:
+        explicit ContextScope(Context& context) : previous_(activeContext()) { activeContext() = &context; }
+        ~ContextScope() { activeContext() = previous_; }
+        ContextScope(const ContextScope&) = delete;
+        ContextScope& operator=(const ContextScope&) = delete;
+    private:
+        Context* previous_;
+    };
+
+    // Engine used by the calls below: the thread's active stream if a
+    // StreamScope is open, otherwise its current Context's engine
+    static Engine& engine() {
+        Engine* stream = activeStream();
+        return stream ? *stream : context().engine();
+    }
+
+    // Reseeds the thread's current Context (also the key for stream())
+    static void seed(unsigned int s) { context().reseed(s); }
+    static unsigned int currentSeed() { return context().seed(); }
+
+    // Independent stream keyed by (seed, id), e.g. one per agent. Derived from
+    // the current seed without drawing from the context's engine.
+    static Engine stream(uint64_t id) { return Engine(currentSeed(), id); }
+
+    // Routes this thread's Random calls to `stream` until the scope closes
+    class StreamScope {
+    public:
+        explicit StreamScope(Engine& stream) : previous_(activeStream()) { activeStream() = &stream; }
+        ~StreamScope() { activeStream() = previous_; }
+        StreamScope(const StreamScope&) = delete;
+        StreamScope& operator=(const StreamScope&) = delete;
+    private:
+        Engine* previous_;
+    };
+
+    // Uniform distribution [min, max)
     static double uniform(double min, double max) {
-        std::uniform_real_distribution<double> dist(min, max);
-        return dist(engine());
+        return min + (max - min) * unit53(engine().next64());
     }
-    
-    // Uniform integer [min, max]
+
+    // Uniform integer [min, max] (Lemire's multiply-shift with rejection)
     static int uniformInt(int min, int max) {
-        std::uniform_int_distribution<int> dist(min, max);
-        return dist(engine());
+        if (max <= min) return min;
+        uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(max) - min) + 1;
+        Engine& e = engine();
+        uint64_t m = static_cast<uint64_t>(e()) * range;
+        uint32_t low = static_cast<uint32_t>(m);
+        if (low < range) {
+            uint32_t threshold = static_cast<uint32_t>((0x100000000ULL - range) % range);
+            while (low < threshold) {
+                m = static_cast<uint64_t>(e()) * range;
+                low = static_cast<uint32_t>(m);
+            }
+        }
+        return static_cast<int>(static_cast<int64_t>(min) + static_cast<int64_t>(m >> 32));
     }
-    
-    // Normal distribution
+
+    // Normal distribution (Box-Muller; the second value of each pair is kept)
     static double normal(double mean, double stddev) {
-        std::normal_distribution<double> dist(mean, stddev);
-        return dist(engine());
+        Engine& e = engine();
+        if (e.hasSpareNormal_) {
+            e.hasSpareNormal_ = false;
+            return mean + stddev * e.spareNormal_;
+        }
+        double u1 = unit32Open(e());
+        double u2 = unit32Open(e());
+        double r = std::sqrt(-2.0 * std::log(u1));
+        double theta = TWO_PI * u2;
+        e.spareNormal_ = r * std::sin(theta);
+        e.hasSpareNormal_ = true;
+        return mean + stddev * r * std::cos(theta);
     }
-    
+
     // Log-normal distribution
     static double logNormal(double mean, double stddev) {
-        std::lognormal_distribution<double> dist(mean, stddev);
-        return dist(engine());
+        return std::exp(normal(mean, stddev));
     }
-    
+
     // Exponential distribution
     static double exponential(double lambda) {
-        std::exponential_distribution<double> dist(lambda);
-        return dist(engine());
+        return -std::log(unit32Open(engine()())) / lambda;
     }
-    
-    // Poisson distribution
+
+    // Poisson distribution (Knuth's product method for the small rates used
+    // per tick; falls back to the library sampler for large lambda)
     static int poisson(double lambda) {
-        std::poisson_distribution<int> dist(lambda);
-        return dist(engine());
+        if (!(lambda > 0.0)) return 0;
+        if (lambda >= 30.0) {
+            std::poisson_distribution<int> dist(lambda);
+            return dist(engine());
+        }
+        double limit = std::exp(-lambda);
+        double product = unit32Open(engine()());
+        int k = 0;
+        while (product > limit) {
+            product *= unit32Open(engine()());
+            k++;
+        }
+        return k;
     }
-    
+
     // Bernoulli (coin flip with probability p)
     static bool bernoulli(double p) {
-        std::bernoulli_distribution dist(p);
-        return dist(engine());
+        return unit53(engine().next64()) < p;
     }
 
     // Pareto distribution (heavy-tailed) with shape alpha and scale xmin
@@ -66,6 +303,71 @@ public:
         double u = uniform(0.0001, 1.0); // avoid division by zero
         return xmin / std::pow(u, 1.0 / alpha);
     }
+
+    // Batch draws: out[i] for i in [0, n) from block i/4 of (stream, epoch).
+    // Values depend only on (seed, stream, epoch, i), not on call order, and
+    // the loops carry no dependencies so the compiler can vectorize them.
+    // Uniforms are in (0, 1) with 32-bit resolution.
+    static void fillUniform(double* out, size_t n, uint64_t stream, uint64_t epoch) {
+        forEachUniformChunk(n, stream, epoch, [out](const double* u, size_t offset, size_t count) {
+            for (size_t i = 0; i < count; ++i) out[offset + i] = u[i];
+        });
+    }
+
+    static void fillNormal(double* out, size_t n, uint64_t stream, uint64_t epoch,
+                           double mean = 0.0, double stddev = 1.0) {
+        forEachUniformChunk(n, stream, epoch, [=](const double* u, size_t offset, size_t count) {
+            for (size_t i = 0; i < count; i += 2) {
+                double r = std::sqrt(-2.0 * std::log(u[i]));
+                double theta = TWO_PI * u[i + 1];
+                out[offset + i] = mean + stddev * r * std::cos(theta);
+                if (i + 1 < count) out[offset + i + 1] = mean + stddev * r * std::sin(theta);
+            }
+        });
+    }
+
+private:
+    static constexpr double TWO_PI = 6.283185307179586476925286766559;
+
+    // [0, 1) from the top 53 bits
+    static double unit53(uint64_t bits) { return static_cast<double>(bits >> 11) * 0x1.0p-53; }
+    // (0, 1): safe for log()
+    static double unit32Open(uint32_t bits) { return (static_cast<double>(bits) + 0.5) * 0x1.0p-32; }
+
+    // Calls fn(u, offset, count) for [0, n) in chunks of whole blocks; u holds
+    // count values rounded up to a whole block, so u[count] is readable when
+    // count is odd
+    template <typename Fn>
+    static void forEachUniformChunk(size_t n, uint64_t stream, uint64_t epoch, Fn&& fn) {
+        constexpr size_t CHUNK_BLOCKS = 16;
+        uint32_t bits[CHUNK_BLOCKS * 4];
+        double u[CHUNK_BLOCKS * 4];
+        Engine e(currentSeed(), stream);
+        for (size_t offset = 0; offset < n; offset += CHUNK_BLOCKS * 4) {
+            size_t count = n - offset < CHUNK_BLOCKS * 4 ? n - offset : CHUNK_BLOCKS * 4;
+            size_t blocks = (count + 3) / 4;
+            e.generateBlocks(epoch, offset / 4, blocks, bits);
+            for (size_t i = 0; i < blocks * 4; ++i) u[i] = unit32Open(bits[i]);
+            fn(u, offset, count);
+        }
+    }
+
+    static Context& context() {
+        Context* bound = activeContext();
+        if (bound) return *bound;
+        thread_local Context fallback(std::random_device{}());
+        return fallback;
+    }
+
+    static Context*& activeContext() {
+        thread_local Context* context = nullptr;
+        return context;
+    }
+
+    static Engine*& activeStream() {
+        thread_local Engine* stream = nullptr;
+        return stream;
+    }
 };
 
 } // namespace market
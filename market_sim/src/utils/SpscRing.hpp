@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace market {
+
+    // Bounded single-producer / single-consumer ring of reusable slots. The
+    // producer fills a slot in place and publishes it; the consumer reads it
+    // in place and releases it. Slots are never destroyed in between, so
+    // slot types holding vectors keep their capacity and a steady stream
+    // allocates nothing. Each side touches one atomic per operation.
+    template <typename T>
+    class SpscRing {
+    public:
+        // Capacity is rounded up to a power of two
+        explicit SpscRing(size_t capacity) {
+            size_t n = 1;
+            while (n < capacity) n <<= 1;
+            slots_.resize(n);
+            mask_ = n - 1;
+        }
+
+        SpscRing(const SpscRing&) = delete;
+        SpscRing& operator=(const SpscRing&) = delete;
+
+        size_t capacity() const { return slots_.size(); }
+
+        // Producer: the next free slot, or nullptr while the ring is full
+        T* tryBeginPush() {
+            uint64_t head = head_.load(std::memory_order_relaxed);
+            if (head - tail_.load(std::memory_order_acquire) >= slots_.size()) return nullptr;
+            return &slots_[head & mask_];
+        }
+
+        // Producer: publishes the slot tryBeginPush() returned
+        void commitPush() {
+            head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        // Consumer: the oldest published slot, or nullptr when empty
+        T* front() {
+            uint64_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail == head_.load(std::memory_order_acquire)) return nullptr;
+            return &slots_[tail & mask_];
+        }
+
+        // Consumer: hands the front slot back to the producer
+        void pop() {
+            tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        // Totals since construction; any thread
+        uint64_t pushed() const { return head_.load(std::memory_order_acquire); }
+        uint64_t popped() const { return tail_.load(std::memory_order_acquire); }
+        size_t approxSize() const { return static_cast<size_t>(pushed() - popped()); }
+
+    private:
+        std::vector<T> slots_;
+        size_t mask_ = 0;
+        alignas(64) std::atomic<uint64_t> head_{ 0 };  // Slots published
+        alignas(64) std::atomic<uint64_t> tail_{ 0 };  // Slots released
+    };
+
+} // namespace market
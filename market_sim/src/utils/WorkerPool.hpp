@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace market {
+
+    // Fixed set of persistent worker threads for fork-join loops inside a tick.
+    // parallelFor blocks until every index has run; the calling thread works too,
+    // so a pool of N workers runs N+1 tasks at a time.
+    class WorkerPool {
+    public:
+        explicit WorkerPool(size_t workers) {
+            threads_.reserve(workers);
+            for (size_t i = 0; i < workers; ++i) {
+                threads_.emplace_back([this]() { workerLoop(); });
+            }
+        }
+
+        ~WorkerPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            wake_.notify_all();
+            for (auto& t : threads_) t.join();
+        }
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        size_t size() const { return threads_.size(); }
+
+        // Runs fn(i) for i in [0, count). Not re-entrant: one loop at a time.
+        void parallelFor(size_t count, const std::function<void(size_t)>& fn) {
+            if (count == 0) return;
+            if (threads_.empty() || count == 1) {
+                for (size_t i = 0; i < count; ++i) fn(i);
+                return;
+            }
+
+            std::lock_guard<std::mutex> submit(submitMutex_);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                job_ = &fn;
+                jobCount_ = count;
+                nextIndex_.store(0, std::memory_order_relaxed);
+                remaining_.store(count, std::memory_order_relaxed);
+                generation_++;
+            }
+            wake_.notify_all();
+
+            runIndices(fn, count);
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            // Also wait for workers to leave the job so none can pick up a stale one
+            done_.wait(lock, [this]() {
+                return remaining_.load(std::memory_order_acquire) == 0 && active_ == 0;
+            });
+            job_ = nullptr;
+        }
+
+    private:
+        std::vector<std::thread> threads_;
+
+        std::mutex submitMutex_;
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::condition_variable done_;
+        bool stopping_ = false;
+        uint64_t generation_ = 0;
+        size_t active_ = 0;  // Workers currently inside runIndices
+
+        const std::function<void(size_t)>* job_ = nullptr;
+        size_t jobCount_ = 0;
+        std::atomic<size_t> nextIndex_{ 0 };
+        std::atomic<size_t> remaining_{ 0 };
+
+        void runIndices(const std::function<void(size_t)>& fn, size_t count) {
+            size_t finished = 0;
+            for (size_t i = nextIndex_.fetch_add(1, std::memory_order_relaxed); i < count;
+                 i = nextIndex_.fetch_add(1, std::memory_order_relaxed)) {
+                fn(i);
+                finished++;
+            }
+            if (finished > 0 &&
+                remaining_.fetch_sub(finished, std::memory_order_acq_rel) == finished) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                done_.notify_one();
+            }
+        }
+
+        void workerLoop() {
+            uint64_t seen = 0;
+            while (true) {
+                const std::function<void(size_t)>* job;
+                size_t count;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    wake_.wait(lock, [&]() { return stopping_ || generation_ != seen; });
+                    if (stopping_) return;
+                    seen = generation_;
+                    job = job_;
+                    count = jobCount_;
+                    if (!job) continue;
+                    active_++;
+                }
+                runIndices(*job, count);
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    active_--;
+                }
+                done_.notify_one();
+            }
+        }
+    };
+
+} // namespace market
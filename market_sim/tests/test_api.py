@@ -241,6 +241,27 @@ class TestTicksCountEndpoint:
         assert "currentTick" in data
 
 
+class TestTicksEndpoint:
+    """Tests for /ticks range endpoint"""
+
+    def test_ticks_range_by_symbol(self, market_sim_process):
+        """A range holds at most count ticks per requested symbol"""
+        response = requests.get(f"{BASE_URL}/ticks", params={"start": 0, "count": 5, "symbols": "OIL"})
+        assert response.status_code == 200
+        data = response.json()
+        assert list(data["symbols"].keys()) == ["OIL"]
+        ticks = data["symbols"]["OIL"]
+        assert len(ticks) <= 5
+        for i, tick in enumerate(ticks):
+            assert tick["tick"] == i
+            assert tick["low"] <= tick["high"]
+
+    def test_ticks_unknown_symbol(self, market_sim_process):
+        """Unknown symbols are 404"""
+        response = requests.get(f"{BASE_URL}/ticks", params={"symbols": "NOPE"})
+        assert response.status_code == 404
+
+
 class TestMetricsEndpoint:
     """Tests for /metrics endpoint"""
 
@@ -254,6 +275,34 @@ class TestMetricsEndpoint:
         assert "totalTrades" in data
         assert "totalOrders" in data
 
+    def test_metrics_prometheus_text(self, market_sim_process):
+        """Prometheus exposition should carry tick phase histograms and counters"""
+        response = requests.get(f"{BASE_URL}/metrics/prometheus")
+        assert response.status_code == 200
+        assert response.headers["Content-Type"].startswith("text/plain")
+
+        body = response.text
+        assert "# TYPE market_ticks_total counter" in body
+        assert "# TYPE market_tick_phase_seconds histogram" in body
+        assert 'market_tick_phase_seconds_count{phase="matching"}' in body
+
+    def test_metrics_http_admission(self, market_sim_process):
+        """Admission classes and per-route request counts are reported"""
+        http = requests.get(f"{BASE_URL}/metrics").json()["http"]
+        assert set(http["classes"]) == {"critical", "read", "bulk", "stream"}
+        assert http["threads"] > 0
+        routes = {(r["method"], r["route"]): r for r in http["routes"]}
+        assert routes[("POST", "/orders")]["class"] == "critical"
+        for route in ("/config", "/config/reset", "/reinitialize", "/restore", "/export/cancel"):
+            assert routes[("POST", route)]["class"] == "critical"
+        assert routes[("GET", "/trades")]["class"] == "bulk"
+        assert routes[("GET", "/ticks")]["class"] == "bulk"
+        assert routes[("GET", "/stream")]["class"] == "stream"
+
+        body = requests.get(f"{BASE_URL}/metrics/prometheus").text
+        assert "# TYPE market_http_requests_total counter" in body
+        assert "# TYPE market_http_connections_queued gauge" in body
+
 
 class TestCandlesEndpoint:
     """Tests for /candles endpoint"""
@@ -285,6 +334,33 @@ class TestCandlesEndpoint:
         # Should have at least OIL
         assert "OIL" in data or len(data) > 0
 
+    def test_candles_bulk_columns(self, market_sim_process):
+        """layout=columns returns one array per field for each symbol"""
+        response = requests.get(f"{BASE_URL}/candles/bulk", params={"layout": "columns"})
+        assert response.status_code == 200
+        data = response.json()
+        assert isinstance(data, dict)
+        for columns in data.values():
+            assert set(columns) == {"time", "open", "high", "low", "close", "volume"}
+            assert len({len(values) for values in columns.values()}) == 1
+
+    @pytest.mark.parametrize("path", ["/candles/bulk", "/trades", "/news/history"])
+    def test_binary_encodings(self, market_sim_process, path):
+        """Accept picks MessagePack or CBOR; JSON stays the default"""
+        response = requests.get(f"{BASE_URL}{path}", headers={"Accept": "application/msgpack"})
+        assert response.status_code == 200
+        assert response.headers["Content-Type"].startswith("application/msgpack")
+        # A fixmap/map or fixarray/array header
+        assert response.content[0] in range(0x80, 0xA0) or response.content[0] in (0xDC, 0xDD, 0xDE, 0xDF)
+
+        response = requests.get(f"{BASE_URL}{path}", headers={"Accept": "application/cbor"})
+        assert response.status_code == 200
+        assert response.headers["Content-Type"].startswith("application/cbor")
+        assert response.content[0] >> 5 in (4, 5)  # Array or map
+
+        response = requests.get(f"{BASE_URL}{path}", headers={"Accept": "application/cbor;q=0.5, application/json"})
+        assert response.headers["Content-Type"].startswith("application/json")
+
 
 class TestOrderbookEndpoint:
     """Tests for /orderbook endpoint"""
@@ -305,6 +381,162 @@ class TestOrderbookEndpoint:
         assert response.status_code == 404
 
 
+class TestOrdersEndpoint:
+    """Tests for POST /orders"""
+
+    def test_order_returns_id_at_once(self, market_sim_process):
+        """By default the order id comes back before the order reaches a tick"""
+        order = {"symbol": "OIL", "side": "BUY", "type": "LIMIT", "price": 0.01, "quantity": 1}
+        response = requests.post(f"{BASE_URL}/orders", json=order)
+        assert response.status_code == 200
+        data = response.json()
+        assert data["status"] == "accepted"
+        assert data["orderId"] > 0
+        assert "filledQuantity" not in data
+
+        response = requests.post(f"{BASE_URL}/orders", json={**order, "wait": True})
+        assert response.status_code == 200
+        assert response.json()["status"] in ("pending", "queued")
+
+
+class TestOrderBatchEndpoint:
+    """Tests for POST /orders/batch"""
+
+    def test_batch_orders_and_cancel(self, market_sim_process):
+        """Resting orders can be cancelled by a later batch; bad entries are reported per index"""
+        response = requests.post(f"{BASE_URL}/orders/batch", json={
+            "orders": [
+                {"symbol": "OIL", "side": "BUY", "type": "LIMIT", "price": 0.01, "quantity": 3},
+                {"symbol": "INVALID", "quantity": 1},
+                {"symbol": "OIL", "quantity": 0},
+            ],
+            "wait": True
+        })
+        assert response.status_code == 200
+        data = response.json()
+        assert data["accepted"] == 1
+        assert data["invalid"] == 2
+        results = data["results"]
+        assert [r["index"] for r in results] == [0, 1, 2]
+        assert results[0]["status"] in ("pending", "queued")
+        assert results[1]["status"] == "invalid"
+        assert results[2]["status"] == "invalid"
+
+        order_id = results[0]["orderId"]
+        response = requests.post(f"{BASE_URL}/orders/batch", json={
+            "orders": [{"symbol": "OIL", "cancel": order_id}, {"symbol": "OIL", "cancel": order_id}],
+            "wait": True
+        })
+        results = response.json()["results"]
+        assert results[0]["status"] == "cancelled"
+        assert results[1]["status"] == "rejected"
+
+    def test_cancel_only_own_orders(self, market_sim_process):
+        """A cancel under another userId is rejected and leaves the order resting"""
+        response = requests.post(f"{BASE_URL}/orders", json={
+            "symbol": "OIL", "side": "BUY", "type": "LIMIT", "price": 0.01, "quantity": 2,
+            "userId": "alice"
+        })
+        assert response.status_code == 200
+        order_id = response.json()["orderId"]
+
+        def cancel_as(user_id):
+            response = requests.post(f"{BASE_URL}/orders/batch", json={
+                "orders": [{"symbol": "OIL", "cancel": order_id}], "userId": user_id, "wait": True
+            })
+            return response.json()["results"][0]["status"]
+
+        assert cancel_as("bob") == "rejected"
+        assert cancel_as("alice") == "cancelled"
+
+    def test_batch_returns_without_waiting(self, market_sim_process):
+        """Without wait every valid entry comes back accepted, with its order id"""
+        response = requests.post(f"{BASE_URL}/orders/batch", json={
+            "orders": [{"symbol": "OIL", "side": "BUY", "type": "LIMIT", "price": 0.01, "quantity": 1}]
+        })
+        assert response.status_code == 200
+        result = response.json()["results"][0]
+        assert result["status"] == "accepted"
+        assert result["orderId"] > 0
+
+    def test_batch_requires_array(self, market_sim_process):
+        """A body without an orders array is rejected"""
+        response = requests.post(f"{BASE_URL}/orders/batch", json={"symbol": "OIL"})
+        assert response.status_code == 400
+
+
+class TestResponseCache:
+    """Tests for ETag revalidation of the read endpoints"""
+
+    @pytest.mark.parametrize("path", ["/state", "/commodities", "/agents", "/orderbook/OIL", "/diagnostics"])
+    def test_etag_and_not_modified(self, market_sim_process, path):
+        """Read endpoints carry an ETag and answer a matching If-None-Match with 304"""
+        requests.post(f"{BASE_URL}/control", json={"action": "pause"})
+        try:
+            time.sleep(0.2)
+            response = requests.get(f"{BASE_URL}{path}")
+            assert response.status_code == 200
+            etag = response.headers.get("ETag")
+            assert etag and etag.startswith('"')
+
+            revalidated = requests.get(f"{BASE_URL}{path}", headers={"If-None-Match": etag})
+            assert revalidated.status_code == 304
+            assert revalidated.content == b""
+            assert revalidated.headers.get("ETag") == etag
+
+            other = requests.get(f"{BASE_URL}{path}", headers={"If-None-Match": '"stale"'})
+            assert other.status_code == 200
+        finally:
+            requests.post(f"{BASE_URL}/control", json={"action": "resume"})
+
+    def test_metrics_not_cached(self, market_sim_process):
+        """Server counters in /metrics keep moving while no tick publishes"""
+        requests.post(f"{BASE_URL}/control", json={"action": "pause"})
+        try:
+            time.sleep(0.2)
+            first = requests.get(f"{BASE_URL}/metrics")
+            assert "ETag" not in first.headers
+            requests.get(f"{BASE_URL}/state")
+            requests.get(f"{BASE_URL}/state")
+            second = requests.get(f"{BASE_URL}/metrics").json()
+            assert second["responseCache"]["hits"] > first.json()["responseCache"]["hits"]
+        finally:
+            requests.post(f"{BASE_URL}/control", json={"action": "resume"})
+
+
+class TestFeedEndpoint:
+    """Tests for the binary /feed endpoint"""
+
+    def test_feed_starts_with_directory_and_snapshot(self, market_sim_process):
+        """A feed opens with SYMBOL messages and the book snapshot"""
+        import struct
+
+        with requests.get(f"{BASE_URL}/feed", params={"symbols": "OIL"}, stream=True, timeout=5) as response:
+            assert response.status_code == 200
+            buffer = b""
+            messages = []
+            for chunk in response.iter_content(chunk_size=None):
+                buffer += chunk
+                while len(buffer) >= 16:
+                    length, kind, side, symbol, seq = struct.unpack_from("<HBBIQ", buffer)
+                    if len(buffer) < length:
+                        break
+                    messages.append((kind, symbol, seq, buffer[16:length]))
+                    buffer = buffer[length:]
+                if any(kind == 2 for kind, *_ in messages):
+                    break
+
+        names = {symbol: body.decode() for kind, symbol, _, body in messages if kind == 1}
+        assert "OIL" in names.values()
+        snapshot = next(m for m in messages if m[0] == 2)
+        assert names[snapshot[1]] == "OIL"
+
+    def test_feed_unknown_symbol(self, market_sim_process):
+        """Unknown symbols are rejected before streaming"""
+        response = requests.get(f"{BASE_URL}/feed", params={"symbols": "INVALID"})
+        assert response.status_code == 404
+
+
 class TestDiagnosticsEndpoint:
     """Tests for /diagnostics endpoint"""
 
@@ -328,6 +560,22 @@ class TestNewsEndpoint:
         data = response.json()
         assert isinstance(data, list)
 
+    def test_news_history_by_tick_and_symbol(self, market_sim_process):
+        """News history filters by tick range and symbol"""
+        response = requests.get(f"{BASE_URL}/news/history",
+                                params={"since": 0, "symbol": "OIL", "limit": 20})
+        assert response.status_code == 200
+        data = response.json()
+        assert len(data) <= 20
+        for entry in data:
+            assert entry["symbol"] == "OIL"
+            assert "tick" in entry
+        ticks = [entry["tick"] for entry in data]
+        assert ticks == sorted(ticks)
+
+        response = requests.get(f"{BASE_URL}/news/history", params={"since": "abc"})
+        assert response.status_code == 400
+
     def test_news_inject(self, market_sim_process):
         """News injection should work"""
         response = requests.post(
@@ -313,3 +313,162 @@ TEST_CASE("CandleAggregator: candles in chronological order", "[candle]") {
         REQUIRE(candles[i].time > candles[i - 1].time);
     }
 }
+
+TEST_CASE("CandleAggregator: rollups match per-interval aggregation", "[candle]") {
+    using Interval = CandleAggregator::Interval;
+    const Interval intervals[] = { Interval::M1, Interval::M5, Interval::M15, Interval::M30, Interval::H1, Interval::D1 };
+
+    // Reference: every interval built straight from the ticks
+    struct Naive {
+        Candle current{};
+        bool has = false;
+        std::vector<Candle> completed;
+    };
+    Naive naive[6];
+
+    CandleAggregator agg;
+    for (Interval interval : intervals) agg.setRetention(interval, 100000);
+    agg.addSymbol("OIL");
+
+    Timestamp time = 1735689600000;  // 2025-01-01
+    uint32_t state = 12345;
+    for (int i = 0; i < 20000; i++) {
+        state = state * 1664525u + 1013904223u;
+        time += (state >> 8) % 90000;  // 0 to 90 s apart, often several per minute
+        if (i % 3000 == 0) time += 2 * 86400000LL;  // Occasional gaps over several days
+        Price price = 50.0 + (state >> 20) % 1000 * 0.01;
+        double volume = (state >> 4) % 50;
+        agg.onTick("OIL", price, volume, time);
+
+        for (int k = 0; k < 6; k++) {
+            Timestamp ms = CandleAggregator::getIntervalMs(intervals[k]);
+            Timestamp boundary = time / ms * ms;
+            Naive& n = naive[k];
+            if (n.has && boundary > n.current.time) {
+                n.completed.push_back(n.current);
+                n.has = false;
+            }
+            if (!n.has) {
+                n.current = Candle{ boundary, price, price, price, price, volume };
+                n.has = true;
+            }
+            else {
+                n.current.high = std::max(n.current.high, price);
+                n.current.low = std::min(n.current.low, price);
+                n.current.close = price;
+                n.current.volume += volume;
+            }
+        }
+    }
+
+    for (int k = 0; k < 6; k++) {
+        auto candles = agg.getCandles("OIL", intervals[k], 0, 100000);
+        REQUIRE(candles.size() == naive[k].completed.size());
+        REQUIRE(!candles.empty());
+        for (size_t i = 0; i < candles.size(); i++) {
+            const Candle& a = candles[i];
+            const Candle& b = naive[k].completed[i];
+            REQUIRE(a.time == b.time);
+            REQUIRE(a.open == b.open);
+            REQUIRE(a.high == b.high);
+            REQUIRE(a.low == b.low);
+            REQUIRE(a.close == b.close);
+            REQUIRE_THAT(a.volume, Catch::Matchers::WithinRel(b.volume, 1e-9));
+        }
+        Candle current = agg.getCurrentCandle("OIL", intervals[k]);
+        REQUIRE(current.time == naive[k].current.time);
+        REQUIRE(current.open == naive[k].current.open);
+        REQUIRE(current.high == naive[k].current.high);
+        REQUIRE(current.low == naive[k].current.low);
+        REQUIRE(current.close == naive[k].current.close);
+    }
+}
+
+TEST_CASE("CandleAggregator: retention is configurable per interval", "[candle]") {
+    using Interval = CandleAggregator::Interval;
+    CandleAggregator agg;
+    REQUIRE(agg.getRetention(Interval::M1) == CandleAggregator::DEFAULT_RETENTION);
+    agg.setRetention(Interval::M1, 50);
+    agg.setRetention(Interval::H1, 20000);
+    agg.addSymbol("OIL");
+
+    Timestamp ms1m = 60000;
+    for (int i = 0; i < 200; i++) {
+        agg.onTick("OIL", 75.0 + i, 1.0, i * ms1m);
+    }
+
+    // The newest 50 of 199 completed minutes
+    auto candles = agg.getCandles("OIL", Interval::M1, 0, 1000);
+    REQUIRE(candles.size() == 50);
+    REQUIRE(candles.front().time == 149 * ms1m);
+    REQUIRE(candles.back().time == 198 * ms1m);
+    REQUIRE(agg.getAllCandles(Interval::M1)["OIL"].size() == 50);
+
+    // Shrinking keeps the newest; growing keeps everything held
+    agg.setRetention(Interval::M1, 10);
+    candles = agg.getCandles("OIL", Interval::M1, 0, 1000);
+    REQUIRE(candles.size() == 10);
+    REQUIRE(candles.front().time == 189 * ms1m);
+    agg.setRetention(Interval::M1, 100);
+    agg.onTick("OIL", 1.0, 1.0, 200 * ms1m);
+    REQUIRE(agg.getCandleCount("OIL", Interval::M1) == 11);
+    REQUIRE(agg.getCandleCount("OIL", Interval::M5) == 40);
+}
+
+TEST_CASE("CandleAggregator: forks keep separate histories", "[candle]") {
+    using Interval = CandleAggregator::Interval;
+    CandleAggregator agg;
+    agg.addSymbol("OIL");
+    Timestamp ms1m = 60000;
+    for (int i = 0; i < 10; i++) agg.onTick("OIL", 75.0, 1.0, i * ms1m);
+
+    CandleAggregator copy = agg.fork();
+    agg.onTick("OIL", 80.0, 1.0, 10 * ms1m);
+    copy.onTick("OIL", 70.0, 1.0, 10 * ms1m);
+    copy.onTick("OIL", 70.0, 1.0, 11 * ms1m);
+
+    REQUIRE(agg.getCandleCount("OIL", Interval::M1) == 10);
+    REQUIRE(copy.getCandleCount("OIL", Interval::M1) == 11);
+    REQUIRE(copy.getCandles("OIL", Interval::M1, 0, 1).back().close == 70.0);
+    REQUIRE(agg.getCurrentCandle("OIL", Interval::M1).close == 80.0);
+}
+
+TEST_CASE("CandleAggregator: JSON candles match the selected candles", "[candle]") {
+    using Interval = CandleAggregator::Interval;
+    CandleAggregator agg;
+    agg.setRetention(Interval::M1, 300);
+    agg.addSymbol("OIL");
+    agg.addSymbol("GOLD");
+    REQUIRE(agg.getCandlesJson("OIL", Interval::M1) == "[]");
+    REQUIRE(agg.getCandlesJson("NONE", Interval::M1) == "[]");
+
+    Timestamp ms1m = 60000;
+    for (int i = 0; i < 1000; i++) {  // Wraps the 300-candle ring several times
+        agg.onTick("OIL", 75.25 + i * 0.5, 10.0 + i, i * ms1m);
+        agg.onTick("OIL", 80.0 + i * 0.5, 0.5, i * ms1m + 30000);
+    }
+
+    auto candles = agg.getCandles("OIL", Interval::M1, 0, 2);
+    REQUIRE(candles.size() == 2);
+    REQUIRE(candles[0].time == 997 * ms1m);
+    REQUIRE(agg.getCandlesJson("OIL", Interval::M1, 0, 2) ==
+        "[{\"time\":59820000,\"open\":573.75,\"high\":578.5,\"low\":573.75,\"close\":578.5,\"volume\":1007.5},"
+        "{\"time\":59880000,\"open\":574.25,\"high\":579,\"low\":574.25,\"close\":579,\"volume\":1008.5}]");
+
+    // Since is found by binary search: inside a candle starts at the next one
+    for (Timestamp since : { Timestamp(0), 700 * ms1m, 700 * ms1m + 1, 998 * ms1m + 1, 5000 * ms1m }) {
+        for (int limit : { 0, 1, 10, 500 }) {
+            auto selected = agg.getCandles("OIL", Interval::M1, since, limit);
+            std::string json = agg.getCandlesJson("OIL", Interval::M1, since, limit);
+            REQUIRE(static_cast<size_t>(std::count(json.begin(), json.end(), '{')) == selected.size());
+            if (!selected.empty()) {
+                REQUIRE(selected.front().time >= since);
+                REQUIRE(json.find("{\"time\":" + std::to_string(selected.front().time) + ",") == 1);
+            }
+        }
+    }
+    REQUIRE(agg.getCandles("OIL", Interval::M1, 700 * ms1m + 1, 500).front().time == 701 * ms1m);
+    REQUIRE(agg.getCandles("OIL", Interval::M1, 0, 500).size() == 300);
+
+    REQUIRE(agg.getAllCandlesJson(Interval::H1).rfind("{\"GOLD\":[],\"OIL\":[{\"time\":0,", 0) == 0);
+}
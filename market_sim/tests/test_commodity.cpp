@@ -2,6 +2,7 @@
 #include <catch2/catch_approx.hpp>
 #include "core/Commodity.hpp"
 #include "core/Types.hpp"
+#include <cmath>
 
 using namespace market;
 using Catch::Approx;
@@ -235,3 +236,38 @@ TEST_CASE("Commodity: Supply/demand update applies decay", "[commodity]") {
     REQUIRE(c.getSupplyDemand().production < beforeProd);
     REQUIRE(c.getSupplyDemand().consumption < beforeCons);
 }
+
+TEST_CASE("Commodity: Rolling indicators match direct computation", "[commodity]") {
+    Commodity c("OIL", "Crude Oil", "Energy", 75.0);
+
+    // Run well past DEFAULT_HISTORY so the window slides and the prefix sums rebase
+    for (int i = 0; i < 2500; ++i) {
+        c.setPrice(75.0 + 5.0 * std::sin(i * 0.05) + (i % 7) * 0.1);
+    }
+
+    const auto& history = c.getPriceHistory();
+    const PriceIndicators& ind = c.getIndicators();
+    REQUIRE(ind.size() == history.size());
+
+    for (size_t period : { 2, 5, 20, 37, 1000 }) {
+        double sum = 0.0;
+        for (size_t i = history.size() - period; i < history.size(); ++i) sum += history[i];
+        double mean = sum / period;
+
+        double sq = 0.0;
+        for (size_t i = history.size() - period; i < history.size(); ++i) sq += (history[i] - mean) * (history[i] - mean);
+
+        double retSq = 0.0;
+        for (size_t i = history.size() - period; i + 1 < history.size(); ++i) {
+            double r = (history[i + 1] - history[i]) / history[i];
+            retSq += r * r;
+        }
+
+        REQUIRE(ind.sma(period) == Approx(mean));
+        REQUIRE(ind.stddev(period) == Approx(std::sqrt(sq / period)));
+        REQUIRE(ind.sumSquaredReturns(period) == Approx(retSq));
+    }
+
+    // Periods longer than the window have no value
+    REQUIRE(ind.sma(history.size() + 1) == 0.0);
+}
@@ -0,0 +1,1478 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "engine/MarketEngine.hpp"
+#include "engine/Simulation.hpp"
+#include "engine/EnsembleRunner.hpp"
+#include "engine/TickScheduler.hpp"
+#include "api/StreamBroadcaster.hpp"
+#include "api/BookFeed.hpp"
+#include "api/ResponseCache.hpp"
+#include "api/AdmissionControl.hpp"
+#include "core/OrderIngressQueue.hpp"
+#include "utils/Logger.hpp"
+#include "utils/Profiler.hpp"
+#include "utils/Prometheus.hpp"
+#include "utils/Random.hpp"
+#include "utils/WorkerPool.hpp"
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace market;
+
+namespace {
+
+    // Engine with a single commodity and no agents
+    void addTestCommodity(MarketEngine& engine, const std::string& symbol, Price price) {
+        engine.addCommodity(std::make_unique<Commodity>(symbol, symbol, "Test", price));
+    }
+
+    IngressOrder makeUserOrder(MarketEngine& engine, const std::string& symbol, OrderSide side,
+        OrderType type, Price price, Volume qty) {
+        IngressOrder in;
+        in.symbol = symbol;
+        in.order.id = engine.allocateOrderId();
+        in.order.agentId = 0;
+        in.order.side = side;
+        in.order.type = type;
+        in.order.price = price;
+        in.order.quantity = qty;
+        return in;
+    }
+
+} // namespace
+
+TEST_CASE("Ingress: MPSC queue delivers every item in per-producer order", "[engine]") {
+    OrderIngressQueue queue;
+    constexpr int producers = 4;
+    constexpr int perProducer = 2000;
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&queue, p]() {
+            for (int i = 0; i < perProducer; i++) {
+                IngressOrder in;
+                in.order.agentId = p;
+                in.order.quantity = i;
+                queue.push(std::move(in));
+            }
+        });
+    }
+
+    std::vector<Volume> lastSeen(producers, -1);
+    size_t received = 0;
+    bool ordered = true;
+    while (received < producers * perProducer) {
+        received += queue.drain([&](IngressOrder& in) {
+            if (in.order.quantity != lastSeen[in.order.agentId] + 1) ordered = false;
+            lastSeen[in.order.agentId] = in.order.quantity;
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    REQUIRE(received == producers * perProducer);
+    REQUIRE(ordered);
+    REQUIRE(queue.approxSize() == 0);
+}
+
+TEST_CASE("Ingress: External orders are matched and acknowledged", "[engine]") {
+    Random::seed(42);
+    MarketEngine engine;
+    addTestCommodity(engine, "OIL", 75.0);
+
+    REQUIRE(engine.isKnownSymbol("OIL"));
+    REQUIRE_FALSE(engine.isKnownSymbol("GOLD"));
+
+    engine.submitExternalOrder(makeUserOrder(engine, "OIL", OrderSide::SELL, OrderType::LIMIT, 76.0, 10));
+
+    auto buy = makeUserOrder(engine, "OIL", OrderSide::BUY, OrderType::MARKET, 0.0, 4);
+    buy.ack = std::make_shared<std::promise<OrderAck>>();
+    auto buyAck = buy.ack->get_future();
+    engine.submitExternalOrder(std::move(buy));
+
+    auto bad = makeUserOrder(engine, "GOLD", OrderSide::BUY, OrderType::MARKET, 0.0, 1);
+    bad.ack = std::make_shared<std::promise<OrderAck>>();
+    auto badAck = bad.ack->get_future();
+    engine.submitExternalOrder(std::move(bad));
+
+    REQUIRE(engine.getPendingExternalOrders() == 3);
+    engine.processExternalOrders();
+    REQUIRE(engine.getPendingExternalOrders() == 0);
+
+    OrderAck ack = buyAck.get();
+    REQUIRE(ack.status == "filled");
+    REQUIRE(ack.filledQuantity == 4);
+    REQUIRE(ack.avgFillPrice == 76.0);
+
+    REQUIRE(badAck.get().status == "rejected");
+
+    REQUIRE(engine.getRecentTrades().size() == 1);
+    REQUIRE(engine.getOrderBook("OIL")->getAskCount() == 1);
+    REQUIRE(engine.getAgentTypeStats().at("User").ordersPlaced == 2);
+}
+
+TEST_CASE("Ingress: Queued orders are drained inside tick", "[engine]") {
+    Random::seed(7);
+    MarketEngine engine;
+    addTestCommodity(engine, "OIL", 75.0);
+
+    auto bid = makeUserOrder(engine, "OIL", OrderSide::BUY, OrderType::LIMIT, 70.0, 5);
+    bid.ack = std::make_shared<std::promise<OrderAck>>();
+    auto bidAck = bid.ack->get_future();
+    engine.submitExternalOrder(std::move(bid));
+
+    engine.tick();
+
+    REQUIRE(bidAck.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+    REQUIRE(bidAck.get().status == "pending");  // Resting, nothing to match against
+    REQUIRE(engine.getOrderBook("OIL")->getBestBid() == 70.0);
+}
+
+TEST_CASE("Ingress: A batch reaches the books in one drain, cancels included", "[engine]") {
+    Random::seed(11);
+    MarketEngine engine;
+    addTestCommodity(engine, "OIL", 75.0);
+
+    auto resting = makeUserOrder(engine, "OIL", OrderSide::BUY, OrderType::LIMIT, 70.0, 5);
+    OrderId restingId = resting.order.id;
+    engine.submitExternalOrder(std::move(resting));
+    engine.processExternalOrders();
+    REQUIRE(engine.getOrderBook("OIL")->getBidCount() == 1);
+
+    auto cancelOf = [](const std::string& symbol, OrderId id) {
+        IngressOrder in;
+        in.symbol = symbol;
+        in.cancelId = id;
+        return in;
+    };
+    std::vector<IngressOrder> batch;
+    batch.push_back(makeUserOrder(engine, "OIL", OrderSide::SELL, OrderType::LIMIT, 76.0, 10));
+    batch.push_back(makeUserOrder(engine, "OIL", OrderSide::BUY, OrderType::MARKET, 0.0, 4));
+    batch.push_back(makeUserOrder(engine, "OIL", OrderSide::BUY, OrderType::LIMIT, 60.0, 3));
+    OrderId sameDrainId = batch.back().order.id;
+    batch.push_back(cancelOf("OIL", sameDrainId));
+    batch.push_back(cancelOf("OIL", restingId));
+    batch.push_back(cancelOf("OIL", 999999));
+    std::vector<std::future<OrderAck>> acks;
+    for (auto& in : batch) {
+        in.ack = std::make_shared<std::promise<OrderAck>>();
+        acks.push_back(in.ack->get_future());
+    }
+
+    engine.submitExternalOrders(std::move(batch));
+    REQUIRE(engine.getPendingExternalOrders() == 6);
+    engine.tick();
+    REQUIRE(engine.getPendingExternalOrders() == 0);
+
+    for (auto& ack : acks) REQUIRE(ack.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+    REQUIRE(acks[0].get().status == "partial");
+    OrderAck buy = acks[1].get();
+    REQUIRE(buy.status == "filled");
+    REQUIRE(buy.avgFillPrice == 76.0);
+    REQUIRE(acks[2].get().status == "cancelled");  // Cancelled before matching
+    REQUIRE(acks[3].get().status == "cancelled");
+    REQUIRE(acks[4].get().status == "cancelled");
+    OrderAck missing = acks[5].get();
+    REQUIRE(missing.status == "rejected");
+    REQUIRE(missing.reason.find("999999") != std::string::npos);
+
+    REQUIRE(engine.getOrderBook("OIL")->getBidCount() == 0);
+    REQUIRE(engine.getOrderBook("OIL")->getAskCount() == 1);
+    REQUIRE(engine.getAgentTypeStats().at("User").cancels == 2);
+}
+
+TEST_CASE("Ingress: Only the submitting user can cancel an order", "[engine]") {
+    Random::seed(11);
+    MarketEngine engine;
+    addTestCommodity(engine, "OIL", 75.0);
+
+    auto resting = makeUserOrder(engine, "OIL", OrderSide::BUY, OrderType::LIMIT, 70.0, 5);
+    resting.order.agentId = userOwnerId("alice");
+    OrderId restingId = resting.order.id;
+    engine.submitExternalOrder(std::move(resting));
+    engine.processExternalOrders();
+
+    auto cancelAs = [&](const std::string& userId) {
+        IngressOrder in;
+        in.symbol = "OIL";
+        in.cancelId = restingId;
+        in.order.agentId = userOwnerId(userId);
+        in.ack = std::make_shared<std::promise<OrderAck>>();
+        auto ack = in.ack->get_future();
+        engine.submitExternalOrder(std::move(in));
+        engine.processExternalOrders();
+        return ack.get();
+    };
+
+    REQUIRE(userOwnerId("alice") != userOwnerId("bob"));
+    REQUIRE(userOwnerId("") != 0);
+    REQUIRE(cancelAs("bob").status == "rejected");
+    REQUIRE(cancelAs("").status == "rejected");
+    REQUIRE(engine.getOrderBook("OIL")->getBidCount() == 1);
+    REQUIRE(cancelAs("alice").status == "cancelled");
+    REQUIRE(engine.getOrderBook("OIL")->getBidCount() == 0);
+}
+
+TEST_CASE("WorkerPool: parallelFor runs every index exactly once", "[engine]") {
+    WorkerPool pool(3);
+    REQUIRE(pool.size() == 3);
+
+    for (int round = 0; round < 200; round++) {
+        std::vector<std::atomic<int>> hits(17);
+        pool.parallelFor(hits.size(), [&](size_t i) { hits[i].fetch_add(1); });
+        for (auto& h : hits) REQUIRE(h.load() == 1);
+    }
+}
+
+TEST_CASE("Matching: Parallel per-symbol matching is deterministic", "[engine]") {
+    auto runTrades = [](int matchingThreads) {
+        Random::seed(42);
+        Simulation sim;
+        sim.loadConfig(nlohmann::json{
+            {"simulation", {{"ticks_per_day", 200}}},
+            {"orderBook", {{"matchingThreads", matchingThreads}}} });
+        sim.loadCommodities("commodities.json");
+        sim.initialize();
+
+        std::vector<Trade> trades;
+        sim.getEngine().setTradeCallback([&trades](const Trade& t) { trades.push_back(t); });
+        sim.step(300);
+        return trades;
+    };
+
+    auto serial = runTrades(1);
+    auto parallel = runTrades(4);
+
+    REQUIRE(serial.size() > 0);
+    REQUIRE(serial.size() == parallel.size());
+    for (size_t i = 0; i < serial.size(); i++) {
+        REQUIRE(serial[i].symbolId == parallel[i].symbolId);
+        REQUIRE(serial[i].priceTicks == parallel[i].priceTicks);
+        REQUIRE(serial[i].quantity == parallel[i].quantity);
+        REQUIRE(serial[i].buyerId == parallel[i].buyerId);
+        REQUIRE(serial[i].sellerId == parallel[i].sellerId);
+    }
+}
+
+TEST_CASE("Agents: Parallel decision phase matches the serial run", "[engine]") {
+    auto runTrades = [](int decisionThreads) {
+        Random::seed(7);
+        Simulation sim;
+        sim.loadConfig(nlohmann::json{
+            {"simulation", {{"ticks_per_day", 200}}},
+            {"agentGlobal", {{"decisionThreads", decisionThreads}}} });
+        sim.loadCommodities("commodities.json");
+        sim.initialize();
+
+        std::vector<Trade> trades;
+        sim.getEngine().setTradeCallback([&trades](const Trade& t) { trades.push_back(t); });
+        sim.step(300);
+
+        std::vector<double> cash;
+        for (const auto& agent : sim.getEngine().getAgents()) cash.push_back(agent->getCash());
+        return std::make_pair(trades, cash);
+    };
+
+    auto [serialTrades, serialCash] = runTrades(1);
+    auto [parallelTrades, parallelCash] = runTrades(4);
+
+    REQUIRE(serialTrades.size() > 0);
+    REQUIRE(serialTrades.size() == parallelTrades.size());
+    for (size_t i = 0; i < serialTrades.size(); i++) {
+        REQUIRE(serialTrades[i].timestamp == parallelTrades[i].timestamp);
+        REQUIRE(serialTrades[i].buyerId == parallelTrades[i].buyerId);
+        REQUIRE(serialTrades[i].sellerId == parallelTrades[i].sellerId);
+        REQUIRE(serialTrades[i].priceTicks == parallelTrades[i].priceTicks);
+        REQUIRE(serialTrades[i].quantity == parallelTrades[i].quantity);
+    }
+    REQUIRE(serialCash == parallelCash);
+}
+
+TEST_CASE("Matching: Auction mode clears each book at one price per tick", "[engine]") {
+    Random::seed(42);
+    Simulation sim;
+    sim.loadConfig(nlohmann::json{
+        {"simulation", {{"ticks_per_day", 200}}},
+        {"orderBook", {{"matchingMode", "auction"}}} });
+    sim.loadCommodities("commodities.json");
+    sim.initialize();
+
+    std::vector<Trade> trades;
+    sim.getEngine().setTradeCallback([&trades](const Trade& t) { trades.push_back(t); });
+    sim.step(300);
+
+    REQUIRE(trades.size() > 0);
+    std::map<std::pair<Timestamp, SymbolId>, PriceTicks> clearing;
+    for (const auto& t : trades) {
+        auto [it, inserted] = clearing.try_emplace({ t.timestamp, t.symbolId }, t.priceTicks);
+        REQUIRE(it->second == t.priceTicks);
+    }
+}
+
+TEST_CASE("Config: Published snapshots are immutable and versioned", "[engine]") {
+    ConfigStore store;
+    auto first = store.current();
+    REQUIRE(first->version == store.version());
+
+    auto second = store.update([](RuntimeConfig& c) { c.momentum.reactionMult = 0.9; });
+    REQUIRE(second->version == first->version + 1);
+    REQUIRE(store.current() == second);
+    REQUIRE(first->momentum.reactionMult == 0.25);
+    REQUIRE(second->momentum.reactionMult == 0.9);
+
+    // A failed edit publishes nothing
+    REQUIRE_THROWS(store.update([](RuntimeConfig& c) {
+        c.fromJson(nlohmann::json{ {"momentum", {{"reactionMult", "fast"}}} });
+    }));
+    REQUIRE(store.current() == second);
+}
+
+TEST_CASE("Config: Hot settings apply at the next tick like a fresh start with them", "[engine]") {
+    const nlohmann::json hot = {
+        {"agentGlobal", {{"capitalFraction", 0.08}, {"maxShortPosition", 5}}},
+        {"momentum", {{"reactionMult", 0.6}}},
+        {"noise", {{"marketOrderProb", 0.4}}},
+        {"orderBook", {{"matchingMode", "auction"}}} };
+    auto run = [](const nlohmann::json& config, const nlohmann::json* update) {
+        Simulation sim;
+        nlohmann::json full = config;
+        full["simulation"] = { {"ticks_per_day", 200}, {"seed", 7} };
+        sim.loadConfig(full);
+        sim.loadCommodities("commodities.json");
+        sim.initialize();
+        if (update) {
+            auto before = sim.getEngine().getRuntimeConfig()->version;
+            auto published = sim.updateConfig(*update);
+            REQUIRE(published->version == before + 1);
+            REQUIRE(sim.getEngine().getRuntimeConfig()->version == before);
+            sim.step(1);
+            REQUIRE(sim.getEngine().getRuntimeConfig() == published.get());
+            sim.step(299);
+        }
+        else {
+            sim.step(300);
+        }
+        REQUIRE(sim.getEngine().getOrderBook(SymbolId(0))->getMatchingMode() == OrderBook::MatchingMode::AUCTION);
+        return std::make_pair(sim.getSnapshot()->totalTrades, sim.getSnapshot()->commodities[0].price);
+    };
+
+    auto live = run(nlohmann::json::object(), &hot);
+    auto fresh = run(hot, nullptr);
+    REQUIRE(live == fresh);
+}
+
+TEST_CASE("MarketState: Implied cross moves are the effect matrix applied to returns", "[engine]") {
+    CrossEffectMatrix m;
+    m.reset(3);
+    m.set(0, 1, 0.5);
+    m.set(2, 1, -2.0);
+    m.set(2, 0, 1.0);
+    double returns[3] = { 0.02, 0.5, -0.01 };
+    double out[3] = { 9.0, 9.0, 9.0 };
+    m.impliedMoves(returns, out);
+    REQUIRE(out[0] == Catch::Approx(-0.01));
+    REQUIRE(out[1] == Catch::Approx(0.01 + 0.02));
+    REQUIRE(out[2] == 0.0);
+    REQUIRE_FALSE(m.hasEffects(1));
+
+    Random::seed(42);
+    Simulation sim;
+    sim.loadCommodities("commodities.json");
+    sim.initialize();
+    sim.step(50);
+
+    auto& engine = sim.getEngine();
+    const MarketState& state = engine.getMarketState();
+    SymbolId oil = engine.getSymbolRegistry().find("OIL");
+    SymbolId steel = engine.getSymbolRegistry().find("STEEL");
+    REQUIRE(state.crossEffects->at(oil, steel) == Catch::Approx(0.25));
+    REQUIRE(state.crossEffects->at(steel, oil) == Catch::Approx(0.30));
+
+    for (SymbolId target = 0; target < state.symbolCount(); ++target) {
+        double expected = 0.0;
+        for (SymbolId source = 0; source < state.symbolCount(); ++source) {
+            REQUIRE(state.returns[source] == engine.getCommodity(source)->getReturn(1));
+            expected += state.crossEffects->at(source, target) * state.returns[source];
+        }
+        REQUIRE(state.impliedMoves[target] == Catch::Approx(expected).margin(1e-15));
+    }
+}
+
+TEST_CASE("MarketState: Published view aliases engine storage", "[engine]") {
+    Random::seed(42);
+    Simulation sim;
+    sim.loadCommodities("commodities.json");
+    sim.initialize();
+    sim.step(5);
+
+    auto& engine = sim.getEngine();
+    const MarketState& state = engine.getMarketState();
+    REQUIRE(state.symbolCount() == engine.getCommodities().size());
+    REQUIRE(state.priceHistory.size() == state.symbolCount());
+    REQUIRE(state.crossEffects != nullptr);
+    REQUIRE(state.crossEffects->size() == state.symbolCount());
+    REQUIRE(state.returns.size() == state.symbolCount());
+    REQUIRE(state.impliedMoves.size() == state.symbolCount());
+
+    for (SymbolId id = 0; id < state.symbolCount(); ++id) {
+        const Commodity* commodity = engine.getCommodity(id);
+        REQUIRE(state.priceHistory[id].data() == commodity->getPriceHistory().data());
+        REQUIRE(state.priceHistory[id].size() == commodity->getPriceHistory().size());
+    }
+
+    // Next tick overwrites the same buffers rather than allocating a new snapshot
+    const Price* pricesBefore = state.prices.data();
+    sim.step(1);
+    REQUIRE(engine.getMarketState().prices.data() == pricesBefore);
+}
+
+TEST_CASE("Agents: Column layout matches agent-owned state", "[engine]") {
+    auto run = [](const std::string& layout) {
+        Random::seed(7);
+        Simulation sim;
+        sim.loadConfig(nlohmann::json{
+            {"simulation", {{"ticks_per_day", 200}, {"agentLayout", layout}}} });
+        sim.loadCommodities("commodities.json");
+        sim.initialize();
+
+        size_t trades = 0;
+        sim.getEngine().setTradeCallback([&trades](const Trade&) { trades++; });
+        sim.step(300);
+
+        const auto& engine = sim.getEngine();
+        std::vector<double> cash;
+        std::vector<Volume> positions;
+        for (const auto& agent : engine.getAgents()) {
+            REQUIRE(agent->isBoundToColumns() == (layout == "columns"));
+            cash.push_back(agent->getCash());
+            for (SymbolId id = 0; id < engine.getCommodities().size(); id++) positions.push_back(agent->getPosition(id));
+        }
+        if (layout == "columns") {
+            REQUIRE(engine.getAgentColumns().rows() == engine.getAgents().size());
+            REQUIRE(engine.getAgentColumns().symbols() == engine.getCommodities().size());
+        } else {
+            REQUIRE(engine.getAgentColumns().rows() == 0);
+        }
+        return std::make_tuple(trades, cash, positions);
+    };
+
+    auto [objectTrades, objectCash, objectPositions] = run("objects");
+    auto [columnTrades, columnCash, columnPositions] = run("columns");
+
+    REQUIRE(objectTrades > 0);
+    REQUIRE(objectTrades == columnTrades);
+    REQUIRE(objectCash == columnCash);
+    REQUIRE(objectPositions == columnPositions);
+}
+
+TEST_CASE("Agents: Typed kernels are shared per class", "[engine]") {
+    auto noise = AgentFactory::createNoiseTrader(1, 100000.0);
+    auto momentum = AgentFactory::createMomentumTrader(2, 100000.0);
+    auto otherMomentum = AgentFactory::createMomentumTrader(3, 100000.0);
+
+    REQUIRE(&AgentKernels::forAgent(*momentum) == &AgentKernels::forAgent(*otherMomentum));
+    REQUIRE(&AgentKernels::forAgent(*momentum) != &AgentKernels::forAgent(*noise));
+}
+
+TEST_CASE("Agents: Type ids are interned once per class", "[engine]") {
+    MarketEngine engine;
+    std::vector<std::unique_ptr<Agent>> agents;
+    agents.push_back(AgentFactory::createNoiseTrader(1, 100000.0));
+    agents.push_back(AgentFactory::createMomentumTrader(2, 100000.0));
+    agents.push_back(AgentFactory::createNoiseTrader(3, 100000.0));
+    engine.addAgents(std::move(agents));
+
+    const auto& ids = engine.getAgentTypeIds();
+    REQUIRE(ids.size() == 3);
+    REQUIRE(ids[0] == ids[2]);
+    REQUIRE(ids[0] != ids[1]);
+    REQUIRE(ids[0] != 0);  // 0 is reserved for "User"
+    for (size_t i = 0; i < ids.size(); ++i) {
+        REQUIRE(engine.getAgentTypeName(ids[i]) == engine.getAgents()[i]->getType());
+    }
+    REQUIRE(engine.getAgentTypeRegistry().size() == 3);
+}
+
+TEST_CASE("Agents: Market makers requote every symbol through a batch", "[engine]") {
+    Random::seed(42);
+    Simulation sim;
+    sim.loadConfig(nlohmann::json{
+        {"simulation", {{"ticks_per_day", 200}}},
+        {"agentCounts", {{"supplyDemand", 0}, {"momentum", 0}, {"meanReversion", 0}, {"noise", 0},
+                         {"marketMaker", 3}, {"crossEffects", 0}, {"inventory", 0}, {"event", 0}}}
+    });
+    sim.loadCommodities("commodities.json");
+    sim.initialize();
+    sim.step(50);
+
+    auto& engine = sim.getEngine();
+    const AgentTypeStats& stats = engine.getAgentTypeStats().at("MarketMaker");
+    REQUIRE(stats.cancels > 0);
+
+    // One refresh quotes both sides of several books, and each refresh pulls
+    // the previous quotes, so no maker ever rests more than one order per side
+    REQUIRE(stats.ordersPlaced > 50);
+    for (auto& [symbol, book] : engine.getOrderBooks()) {
+        REQUIRE(book->getBidCount() <= 3);
+        REQUIRE(book->getAskCount() <= 3);
+    }
+}
+
+TEST_CASE("Agents: Lazy sentiment matches eager decay and news", "[engine]") {
+    Random::seed(3);
+    std::unique_ptr<Agent> eager = AgentFactory::createNoiseTrader(1, 100000.0);
+    Random::seed(3);
+    std::unique_ptr<Agent> lazy = AgentFactory::createNoiseTrader(1, 100000.0);
+
+    SentimentFeed feed;
+    feed.advance(1.0);
+    lazy->attachSentimentFeed(&feed);
+
+    NewsEvent news{};
+    news.category = NewsCategory::DEMAND;
+    news.sentiment = NewsSentiment::POSITIVE;
+    news.magnitude = 0.5;
+    news.symbolId = 1;
+
+    // Tick 1: news, then decay; ticks 2 and 3: decay only
+    eager->updateBeliefs(news);
+    eager->decaySentiment(0.5);
+    eager->decaySentiment(0.25);
+    eager->decaySentiment(0.25);
+
+    feed.publish(news);
+    feed.advance(0.5);
+    feed.advance(0.25);
+    feed.advance(0.25);
+
+    // Nothing is applied until the agent reads its sentiment
+    REQUIRE(lazy->getSentimentBias() == 0.0);
+    lazy->syncSentiment();
+    REQUIRE(eager->getSentimentBias() != 0.0);
+    REQUIRE(lazy->getSentimentBias() == Catch::Approx(eager->getSentimentBias()));
+
+    // Syncing again without new news or time is a no-op
+    double bias = lazy->getSentimentBias();
+    lazy->syncSentiment();
+    REQUIRE(lazy->getSentimentBias() == bias);
+}
+
+TEST_CASE("Agents: Fills are routed to both counterparties", "[engine]") {
+    Random::seed(42);
+    Simulation sim;
+    sim.loadConfig(nlohmann::json{ {"simulation", {{"ticks_per_day", 200}}} });
+    sim.loadCommodities("commodities.json");
+    sim.initialize();
+
+    std::map<AgentId, double> expectedCash;
+    for (const auto& agent : sim.getEngine().getAgents()) expectedCash[agent->getId()] = agent->getCash();
+
+    size_t trades = 0;
+    sim.getEngine().setTradeCallback([&](const Trade& t) {
+        trades++;
+        // A self-trade is delivered once, as a buy
+        if (expectedCash.count(t.buyerId)) expectedCash[t.buyerId] -= t.price * t.quantity;
+        if (t.sellerId != t.buyerId && expectedCash.count(t.sellerId)) expectedCash[t.sellerId] += t.price * t.quantity;
+    });
+    sim.step(200);
+
+    REQUIRE(trades > 0);
+    for (const auto& agent : sim.getEngine().getAgents()) {
+        REQUIRE(agent->getCash() == Catch::Approx(expectedCash[agent->getId()]));
+    }
+}
+
+TEST_CASE("Engine: Order ids are allocated per engine", "[engine]") {
+    MarketEngine a;
+    MarketEngine b;
+    addTestCommodity(a, "OIL", 75.0);
+
+    REQUIRE(a.allocateOrderId() == 1);
+    REQUIRE(b.allocateOrderId() == 1);
+    REQUIRE(a.allocateOrderId() == 2);
+
+    // A book hands out ids from its engine's sequence
+    REQUIRE(a.getOrderBook("OIL")->allocateOrderId() == 3);
+}
+
+TEST_CASE("Ensemble: Parallel replicas match standalone runs with the same seed", "[engine]") {
+    auto readFile = [](const std::string& path) {
+        std::ifstream file(path);
+        std::stringstream ss;
+        ss << file.rdbuf();
+        return ss.str();
+    };
+
+    nlohmann::json commodities = nlohmann::json::parse(readFile("commodities.json"));
+    nlohmann::json config = { {"simulation", {{"populate_ticks_per_day", 200}}} };
+    auto dir = std::filesystem::temp_directory_path() / "market_ensemble_test";
+    std::filesystem::remove_all(dir);
+
+    EnsembleOptions options;
+    options.replicas = 3;
+    options.maxParallel = 2;
+    options.baseSeed = 40;
+    options.ticks = 300;
+    options.outputDir = dir.string();
+    {
+        EnsembleRunner runner(config, commodities, options);
+        runner.start();
+        runner.wait();
+
+        auto progress = runner.getProgressJson();
+        REQUIRE(progress["done"] == true);
+        REQUIRE(progress["completed"] == 3);
+        REQUIRE(progress["ticks"] == 900);
+        REQUIRE(progress["replicaStatus"][1]["seed"] == 41);
+    }
+    REQUIRE(std::filesystem::exists(dir / "ensemble.json"));
+
+    // Replica 1 alone on this thread, after unrelated draws, gives the same file
+    Random::seed(12345);
+    Random::uniform(0.0, 1.0);
+    Simulation sim;
+    sim.loadConfig(config);
+    sim.setSeed(41);
+    sim.setCommoditiesData(commodities);
+    sim.initialize();
+    sim.populateTicks(300, options.startDate);
+    auto standalone = dir / "standalone.json";
+    REQUIRE(sim.getTickBuffer().exportToJson(standalone.string()));
+
+    std::string replica1 = readFile((dir / "replica_1" / "ticks.json").string());
+    REQUIRE(!replica1.empty());
+    REQUIRE(replica1 == readFile(standalone.string()));
+    REQUIRE(replica1 != readFile((dir / "replica_0" / "ticks.json").string()));
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("Checkpoint: A restored run continues exactly like the original", "[engine]") {
+    std::ifstream file("commodities.json");
+    nlohmann::json commodities = nlohmann::json::parse(file);
+    nlohmann::json config = { {"simulation", {{"populate_ticks_per_day", 200}}} };
+    auto path = std::filesystem::temp_directory_path() / "market_checkpoint_test.bin";
+
+    Simulation original;
+    original.loadConfig(config);
+    original.setSeed(7);
+    original.setCommoditiesData(commodities);
+    original.initialize();
+    original.populateTicks(300);
+    size_t bytes = original.saveCheckpoint(path.string());
+    REQUIRE(bytes == std::filesystem::file_size(path));
+    original.step(200);
+
+    // Another seed and population, all replaced by the checkpoint
+    Simulation restored;
+    restored.loadConfig(config);
+    restored.setSeed(99);
+    restored.setCommoditiesData(commodities);
+    restored.initialize();
+    restored.loadCheckpoint(path.string());
+    REQUIRE(restored.getCurrentTick() == 300);
+    REQUIRE(restored.getSeed() == 7);
+    REQUIRE(restored.getTickBuffer().getTickCount() == 300);
+    restored.step(200);
+
+    REQUIRE(restored.getEngine().getMetrics().totalTrades == original.getEngine().getMetrics().totalTrades);
+    REQUIRE(restored.getEngine().getMetrics().totalTrades > 0);
+    REQUIRE(restored.captureCheckpoint() == original.captureCheckpoint());
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Fork: Branches continue like the parent until given their own input", "[engine]") {
+    std::ifstream file("commodities.json");
+    nlohmann::json commodities = nlohmann::json::parse(file);
+    nlohmann::json config = { {"simulation", {{"populate_ticks_per_day", 200}}} };
+
+    Simulation parent;
+    parent.loadConfig(config);
+    parent.setSeed(11);
+    parent.setCommoditiesData(commodities);
+    parent.initialize();
+    parent.populateTicks(300);
+    auto atFork = parent.captureCheckpoint();
+
+    auto same = parent.fork();
+    auto shocked = parent.fork();
+    REQUIRE(same->getCurrentTick() == 300);
+    REQUIRE(same->captureCheckpoint() == atFork);
+
+    shocked->getEngine().getNewsGenerator().injectSupplyNews("OIL", NewsSentiment::NEGATIVE, 0.9, "Pipeline outage");
+
+    // Each branch on its own thread, alongside the parent
+    std::thread a([&]() { same->step(200); });
+    std::thread b([&]() { shocked->step(200); });
+    parent.step(200);
+    a.join();
+    b.join();
+
+    auto atEnd = parent.captureCheckpoint();
+    REQUIRE(same->captureCheckpoint() == atEnd);
+    REQUIRE(shocked->captureCheckpoint() != atEnd);
+
+    // Shared history is intact on every side; the branches differ after the fork
+    auto parentTicks = parent.getTickBuffer().getTicks(0, 500);
+    auto shockedTicks = shocked->getTickBuffer().getTicks(0, 500);
+    REQUIRE(shockedTicks["OIL"].size() == 500);
+    for (size_t i = 0; i < 300; ++i) {
+        REQUIRE(shockedTicks["OIL"][i].close == parentTicks["OIL"][i].close);
+    }
+    REQUIRE(shocked->getEngine().getCommodity("OIL")->getPrice() != parent.getEngine().getCommodity("OIL")->getPrice());
+}
+
+TEST_CASE("Checkpoint: Corrupt files are rejected", "[engine]") {
+    std::ifstream file("commodities.json");
+    nlohmann::json commodities = nlohmann::json::parse(file);
+    nlohmann::json config = { {"simulation", {{"populate_ticks_per_day", 200}}} };
+
+    Simulation sim;
+    sim.loadConfig(config);
+    sim.setSeed(3);
+    sim.setCommoditiesData(commodities);
+    sim.initialize();
+    sim.populateTicks(50);
+    std::vector<char> data = sim.captureCheckpoint();
+
+    std::vector<char> wrongMagic = data;
+    wrongMagic[0] = 'X';
+    REQUIRE_THROWS_AS(sim.restoreCheckpoint(wrongMagic), std::runtime_error);
+    // Rejected before anything was replaced
+    REQUIRE(sim.getCurrentTick() == 50);
+
+    std::vector<char> truncated(data.begin(), data.begin() + data.size() / 2);
+    REQUIRE_THROWS_AS(sim.restoreCheckpoint(truncated), std::runtime_error);
+    // Reinitialized from the configuration and still usable
+    REQUIRE(sim.getEngine().getAgents().size() > 0);
+    sim.step(5);
+
+    sim.restoreCheckpoint(data);
+    REQUIRE(sim.getCurrentTick() == 50);
+}
+
+TEST_CASE("Scheduler: Deadlines stay on the grid and policies handle overruns", "[engine]") {
+    using Clock = TickScheduler::Clock;
+    using std::chrono::milliseconds;
+    const Clock::time_point t0{};
+    TickScheduler scheduler;
+    scheduler.setTickRateMs(10);
+
+    SECTION("Short ticks keep absolute deadlines") {
+        scheduler.start(t0);
+        scheduler.tickStarted(t0 + milliseconds(1));
+        scheduler.tickFinished(t0 + milliseconds(4));
+        REQUIRE(scheduler.nextDeadline() == t0 + milliseconds(10));
+        scheduler.tickStarted(t0 + milliseconds(12));
+        scheduler.tickFinished(t0 + milliseconds(19));
+        REQUIRE(scheduler.nextDeadline() == t0 + milliseconds(20));
+        REQUIRE(scheduler.getOverruns() == 0);
+        REQUIRE(scheduler.getLateness().count() == 2);
+        REQUIRE(scheduler.getLateness().max() == 2000);
+        REQUIRE(scheduler.getTickDuration().max() == 7000);
+    }
+
+    SECTION("Catch-up bursts are capped, then the rest is dropped") {
+        scheduler.setPolicy(TickScheduler::Policy::CATCH_UP);
+        scheduler.setMaxCatchUpTicks(2);
+        scheduler.start(t0);
+        scheduler.tickStarted(t0);
+        scheduler.tickFinished(t0 + milliseconds(35));
+        REQUIRE(scheduler.nextDeadline() == t0 + milliseconds(10));  // Due at once
+        scheduler.tickStarted(t0 + milliseconds(35));
+        scheduler.tickFinished(t0 + milliseconds(36));
+        REQUIRE(scheduler.nextDeadline() == t0 + milliseconds(20));
+        scheduler.tickStarted(t0 + milliseconds(36));
+        scheduler.tickFinished(t0 + milliseconds(37));
+        REQUIRE(scheduler.nextDeadline() == t0 + milliseconds(40));
+        REQUIRE(scheduler.getDroppedTicks() == 1);
+        REQUIRE(scheduler.getOverruns() == 3);
+    }
+
+    SECTION("Skip waits for the next slot on the grid") {
+        scheduler.setPolicy(TickScheduler::Policy::SKIP);
+        scheduler.start(t0);
+        scheduler.tickStarted(t0);
+        scheduler.tickFinished(t0 + milliseconds(35));
+        REQUIRE(scheduler.nextDeadline() == t0 + milliseconds(40));
+        REQUIRE(scheduler.getDroppedTicks() == 3);
+    }
+
+    SECTION("Stretch re-anchors the grid on the late tick") {
+        scheduler.setPolicy(TickScheduler::Policy::STRETCH);
+        scheduler.start(t0);
+        scheduler.tickStarted(t0);
+        scheduler.tickFinished(t0 + milliseconds(35));
+        REQUIRE(scheduler.nextDeadline() == t0 + milliseconds(35));
+        scheduler.tickStarted(t0 + milliseconds(35));
+        scheduler.tickFinished(t0 + milliseconds(36));
+        REQUIRE(scheduler.nextDeadline() == t0 + milliseconds(45));
+        REQUIRE(scheduler.getDroppedTicks() == 0);
+    }
+
+    SECTION("A zero tick rate runs as fast as possible") {
+        scheduler.setTickRateMs(0);
+        scheduler.start(t0);
+        scheduler.tickStarted(t0);
+        scheduler.tickFinished(t0 + milliseconds(3));
+        REQUIRE(scheduler.nextDeadline() == t0 + milliseconds(3));
+        REQUIRE(scheduler.getOverruns() == 0);
+    }
+
+    REQUIRE(TickScheduler::parsePolicy("skip") == TickScheduler::Policy::SKIP);
+    REQUIRE(TickScheduler::parsePolicy("bogus") == TickScheduler::Policy::CATCH_UP);
+}
+
+TEST_CASE("Scheduler: Latency histogram buckets and percentiles", "[engine]") {
+    LatencyHistogram h;
+    REQUIRE(h.percentile(0.5) == 0);
+    for (uint64_t us : { 0, 1, 2, 3, 900, 1000 }) h.record(us);
+    REQUIRE(h.count() == 6);
+    REQUIRE(h.max() == 1000);
+    REQUIRE(h.percentile(0.5) == 2);       // Third of six samples, 2us, in bucket (1, 2]
+    REQUIRE(h.percentile(1.0) == 1000);    // Bucket bound 1024, capped at the largest sample
+    REQUIRE(h.toJson()["buckets"].size() == 4);
+}
+
+TEST_CASE("Scheduler: The real-time loop stops promptly mid-wait", "[engine]") {
+    Simulation sim;
+    sim.setSeed(5);
+    sim.initialize();
+    sim.setTickRate(1000);
+
+    auto begin = std::chrono::steady_clock::now();
+    sim.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    sim.stop();
+    auto elapsed = std::chrono::steady_clock::now() - begin;
+
+    REQUIRE(elapsed < std::chrono::milliseconds(900));
+    REQUIRE(sim.getCurrentTick() == 1);  // The first tick is due at start
+    REQUIRE(sim.getMetricsJson()["scheduler"]["ticks"] == 1);
+}
+
+TEST_CASE("Snapshot: Readers get immutable published state without the engine lock", "[engine]") {
+    std::ifstream file("commodities.json");
+    nlohmann::json commodities = nlohmann::json::parse(file);
+    nlohmann::json config = { {"simulation", {{"populate_ticks_per_day", 200}}} };
+
+    Simulation sim;
+    sim.loadConfig(config);
+    sim.setSeed(13);
+    sim.setCommoditiesData(commodities);
+    sim.initialize();
+    sim.populateTicks(100);
+
+    auto before = sim.getSnapshot();
+    REQUIRE(before->tick == 100);
+    REQUIRE(before->commodities.size() == sim.getEngine().getCommodities().size());
+    REQUIRE(before->books.count("OIL") == 1);
+    Price oilBefore = before->commodities.front().price;
+
+    // Readers spin on the snapshot while the ticks hold the engine lock
+    std::atomic<bool> done{ false };
+    std::atomic<uint64_t> reads{ 0 };
+    std::atomic<uint64_t> incomplete{ 0 };
+    std::thread reader([&]() {
+        while (!done.load()) {
+            auto snapshot = sim.getSnapshot();
+            if (snapshot->commodities.size() != 5 || snapshot->books.size() != 5) incomplete++;
+            reads++;
+        }
+    });
+    for (int i = 0; i < 50; ++i) sim.step(1);
+    done = true;
+    reader.join();
+    REQUIRE(reads.load() > 0);
+    REQUIRE(incomplete.load() == 0);
+
+    auto after = sim.getSnapshot();
+    REQUIRE(after->tick == 150);
+    REQUIRE(after->version >= before->version + 50);
+    REQUIRE(before->tick == 100);  // A held snapshot never changes
+    REQUIRE(before->commodities.front().price == oilBefore);
+    REQUIRE(after->commodities.front().price == sim.getEngine().getCommodities().begin()->second->getPrice());
+    REQUIRE(sim.getMetricsJson()["totalTicks"] == 150);
+}
+
+TEST_CASE("Stream: One serialization is fanned out, deltas carry changed prices, slow clients drop", "[engine]") {
+    std::ifstream file("commodities.json");
+    nlohmann::json commodities = nlohmann::json::parse(file);
+
+    Simulation sim;
+    sim.loadConfig(nlohmann::json{ {"simulation", {{"ticks_per_day", 200}}} });
+    sim.setSeed(5);
+    sim.setCommoditiesData(commodities);
+    sim.initialize();
+    sim.step(10);
+
+    StreamBroadcaster::Options options;
+    options.queueFrames = 4;
+    options.maxSubscribers = 3;
+    StreamBroadcaster stream(sim, options);
+
+    auto fullA = stream.subscribe(false);
+    auto fullB = stream.subscribe(false);
+    auto delta = stream.subscribe(true);
+    REQUIRE(stream.subscribe(false) == nullptr);  // Over the limit
+    REQUIRE(stream.getStats().rejected == 1);
+
+    auto take = [](const std::shared_ptr<StreamBroadcaster::Subscription>& s) {
+        std::vector<nlohmann::json> frames;
+        StreamBroadcaster::Frame frame;
+        while (s->queued() > 0 && s->next(frame, std::chrono::milliseconds(0)) && frame) {
+            REQUIRE(frame->rfind("data: ", 0) == 0);
+            REQUIRE(frame->size() > 8);
+            REQUIRE(frame->compare(frame->size() - 2, 2, "\n\n") == 0);
+            frames.push_back(nlohmann::json::parse(frame->substr(6)));
+        }
+        return frames;
+    };
+
+    // The first publication is a full update for everyone, the same bytes
+    stream.publish();
+    StreamBroadcaster::Frame a, b, d;
+    REQUIRE(fullA->next(a, std::chrono::milliseconds(0)));
+    REQUIRE(fullB->next(b, std::chrono::milliseconds(0)));
+    REQUIRE(delta->next(d, std::chrono::milliseconds(0)));
+    REQUIRE(a == b);
+    REQUIRE(a == d);
+    auto first = nlohmann::json::parse(a->substr(6));
+    REQUIRE(first["type"] == "update");
+    REQUIRE(first["commodities"].size() == sim.getSnapshot()->commodities.size());
+    take(fullA);
+    take(fullB);
+    take(delta);
+
+    // Nothing new published: nothing built
+    uint64_t built = stream.getStats().framesBuilt;
+    stream.publish();
+    REQUIRE(stream.getStats().framesBuilt == built);
+    REQUIRE(fullA->queued() == 0);
+
+    // After a tick full clients get the update, delta clients only the moves
+    auto before = sim.getSnapshot();
+    sim.step(1);
+    auto after = sim.getSnapshot();
+    stream.publish();
+    auto updates = take(fullA);
+    auto deltas = take(delta);
+    REQUIRE(updates.at(0)["type"] == "update");
+    REQUIRE(deltas.at(0)["type"] == "delta");
+    REQUIRE(deltas.at(0)["tick"] == updates.at(0)["tick"]);
+    size_t changed = 0;
+    for (size_t i = 0; i < after->commodities.size(); ++i) {
+        const auto& c = after->commodities[i];
+        bool moved = c.price != before->commodities[i].price || c.change != before->commodities[i].change;
+        REQUIRE(deltas.at(0)["prices"].contains(c.symbol) == moved);
+        if (moved) {
+            REQUIRE(deltas.at(0)["prices"][c.symbol]["price"].get<double>() == c.price);
+            changed++;
+        }
+    }
+    REQUIRE(deltas.at(0)["prices"].size() == changed);
+
+    // A late delta subscriber starts from the latest full update
+    stream.unsubscribe(fullA);
+    REQUIRE_FALSE(fullA->next(a, std::chrono::milliseconds(0)));
+    auto late = stream.subscribe(true);
+    REQUIRE(late != nullptr);
+    auto start = take(late);
+    REQUIRE(start.at(0)["type"] == "update");
+    REQUIRE(start.at(0)["tick"] == updates.at(0)["tick"]);
+
+    // fullB never reads: once its queue overflows it is dropped, the rest go on
+    take(delta);
+    for (int i = 0; i < 6; ++i) {
+        sim.step(1);
+        stream.publish();
+        take(delta);
+        take(late);
+    }
+    REQUIRE(fullB->isDropped());
+    REQUIRE_FALSE(fullB->next(b, std::chrono::milliseconds(0)));
+    REQUIRE_FALSE(delta->isDropped());
+    auto stats = stream.getStats();
+    REQUIRE(stats.dropped == 1);
+    REQUIRE(stats.subscribers == 2);
+
+    stream.stop();
+    REQUIRE_FALSE(delta->next(d, std::chrono::milliseconds(0)));
+}
+
+TEST_CASE("Feed: A snapshot plus sequenced level changes rebuilds the published book", "[engine]") {
+    std::ifstream file("commodities.json");
+    nlohmann::json commodities = nlohmann::json::parse(file);
+
+    Simulation sim;
+    sim.loadConfig(nlohmann::json{ {"simulation", {{"ticks_per_day", 200}}} });
+    sim.setSeed(9);
+    sim.setCommoditiesData(commodities);
+    sim.initialize();
+    sim.step(20);
+
+    BookFeed::Options options;
+    options.queueFrames = 64;
+    BookFeed feed(sim, options);
+    auto oil = feed.subscribe({ "OIL" });
+    auto all = feed.subscribe({});
+    REQUIRE(oil != nullptr);
+
+    auto drain = [&](const std::shared_ptr<FrameQueue>& q) {
+        std::vector<BookFeed::Message> out;
+        FrameQueue::Frame frame;
+        while (q->queued() > 0 && q->next(frame, std::chrono::milliseconds(0)) && frame) {
+            REQUIRE(BookFeed::decode(frame->data(), frame->size(), out) == frame->size());
+        }
+        return out;
+    };
+
+    // Priming: the directory, then one snapshot per subscribed symbol
+    feed.publish();
+    auto start = drain(oil);
+    REQUIRE(drain(all).size() == 2 * sim.getSnapshot()->commodities.size());
+    std::vector<std::string> directory;
+    size_t at = 0;
+    for (; at < start.size() && start[at].type == BookFeed::MessageType::SYMBOL; ++at) {
+        REQUIRE(start[at].symbol == directory.size());
+        directory.push_back(start[at].name);
+    }
+    REQUIRE(directory.size() == sim.getSnapshot()->commodities.size());
+    REQUIRE(start.size() == at + 1);
+    const auto& snap = start[at];
+    REQUIRE(snap.type == BookFeed::MessageType::BOOK_SNAPSHOT);
+    REQUIRE(directory[snap.symbol] == "OIL");
+
+    // Apply deltas tick by tick; the book must match each published one
+    std::map<Price, BookLevel> bids, asks;
+    for (const auto& l : snap.bids) bids[l.price] = l;
+    for (const auto& l : snap.asks) asks[l.price] = l;
+    uint64_t seq = snap.seq;
+    size_t trades = 0;
+    size_t levelMessages = 0;
+    uint64_t lastTradeSeq = sim.getSnapshot()->recentTrades.empty() ? 0 : sim.getSnapshot()->recentTrades.back().seq;
+    for (int t = 0; t < 40; ++t) {
+        sim.step(1);
+        feed.publish();
+        auto published = sim.getSnapshot();
+        for (const auto& m : drain(oil)) {
+            REQUIRE(m.symbol == snap.symbol);
+            REQUIRE(m.seq == ++seq);
+            auto& side = m.side == BookFeed::Side::BID ? bids : asks;
+            switch (m.type) {
+            case BookFeed::MessageType::LEVEL_ADD:
+                REQUIRE(side.count(m.level.price) == 0);
+                side[m.level.price] = m.level;
+                levelMessages++;
+                break;
+            case BookFeed::MessageType::LEVEL_CHANGE:
+                REQUIRE(side.count(m.level.price) == 1);
+                side[m.level.price] = m.level;
+                levelMessages++;
+                break;
+            case BookFeed::MessageType::LEVEL_DELETE:
+                REQUIRE(side.erase(m.level.price) == 1);
+                levelMessages++;
+                break;
+            case BookFeed::MessageType::TRADE:
+                trades++;
+                break;
+            case BookFeed::MessageType::CANDLE:
+                REQUIRE(m.candle.isValid());
+                break;
+            default:
+                FAIL("Unexpected message type");
+            }
+        }
+
+        const auto& book = published->books.at("OIL");
+        REQUIRE(bids.size() == book.bids.size());
+        REQUIRE(asks.size() == book.asks.size());
+        size_t i = 0;
+        for (auto it = bids.rbegin(); it != bids.rend(); ++it, ++i) {
+            REQUIRE(it->second.price == book.bids[i].price);
+            REQUIRE(it->second.totalQuantity == book.bids[i].totalQuantity);
+            REQUIRE(it->second.orderCount == book.bids[i].orderCount);
+        }
+        i = 0;
+        for (auto it = asks.begin(); it != asks.end(); ++it, ++i) {
+            REQUIRE(it->second.price == book.asks[i].price);
+            REQUIRE(it->second.totalQuantity == book.asks[i].totalQuantity);
+        }
+    }
+    REQUIRE(levelMessages > 0);
+
+    size_t expectedTrades = 0;
+    for (const auto& trade : sim.getSnapshot()->recentTrades) {
+        if (trade.seq > lastTradeSeq && directory[trade.commodity] == "OIL") expectedTrades++;
+    }
+    REQUIRE(trades == expectedTrades);
+
+    // A late subscriber's snapshot picks up at the current sequence
+    auto late = feed.subscribe({ "OIL" });
+    feed.publish();
+    auto resync = drain(late);
+    REQUIRE(resync.back().type == BookFeed::MessageType::BOOK_SNAPSHOT);
+    REQUIRE(resync.back().seq == seq);
+    REQUIRE(resync.back().bids.size() == bids.size());
+
+    // The all-symbols subscriber never read: it overflows and is dropped
+    REQUIRE(all->isDropped());
+    REQUIRE(feed.getStats().dropped == 1);
+    REQUIRE_FALSE(oil->isDropped());
+
+    // A partial message is left for the next read
+    std::vector<BookFeed::Message> partial;
+    late = feed.subscribe({ "OIL" });
+    feed.publish();
+    FrameQueue::Frame directoryFrame;
+    REQUIRE(late->next(directoryFrame, std::chrono::milliseconds(0)));
+    REQUIRE(BookFeed::decode(directoryFrame->data(), directoryFrame->size() - 1, partial) < directoryFrame->size());
+    REQUIRE(partial.size() == directory.size() - 1);
+
+    feed.stop();
+    REQUIRE_FALSE(oil->next(directoryFrame, std::chrono::milliseconds(0)));
+}
+
+TEST_CASE("Feed: Trades lost between polls leave a gap in every symbol's sequence", "[engine]") {
+    std::ifstream file("commodities.json");
+    nlohmann::json commodities = nlohmann::json::parse(file);
+
+    Simulation sim;
+    sim.loadConfig(nlohmann::json{ {"simulation", {{"ticks_per_day", 200}}} });
+    sim.setSeed(9);
+    sim.setCommoditiesData(commodities);
+    sim.initialize();
+    sim.step(20);
+
+    BookFeed::Options options;
+    options.queueFrames = 1024;
+    BookFeed feed(sim, options);
+    auto sub = feed.subscribe({});
+    auto drain = [&](const std::shared_ptr<FrameQueue>& q) {
+        std::vector<BookFeed::Message> out;
+        FrameQueue::Frame frame;
+        while (q->queued() > 0 && q->next(frame, std::chrono::milliseconds(0)) && frame) {
+            REQUIRE(BookFeed::decode(frame->data(), frame->size(), out) == frame->size());
+        }
+        return out;
+    };
+
+    feed.publish();
+    std::map<uint32_t, uint64_t> seq;  // By symbol, from the snapshots
+    for (const auto& m : drain(sub)) {
+        if (m.type == BookFeed::MessageType::BOOK_SNAPSHOT) seq[m.symbol] = m.seq;
+    }
+    REQUIRE(seq.size() == sim.getSnapshot()->commodities.size());
+
+    // A poll that keeps up has no gaps
+    sim.step(1);
+    feed.publish();
+    for (const auto& m : drain(sub)) REQUIRE(m.seq == ++seq[m.symbol]);
+    REQUIRE(feed.getStats().tradeGaps == 0);
+
+    uint64_t tradesBefore = sim.getSnapshot()->totalTrades;
+    while (sim.getSnapshot()->totalTrades - tradesBefore <= MarketSnapshot::RECENT_TRADES) sim.step(10);
+    feed.publish();
+    REQUIRE(feed.getStats().tradeGaps == 1);
+    std::set<uint32_t> gapped;
+    for (const auto& m : drain(sub)) {
+        if (!gapped.count(m.symbol)) {
+            REQUIRE(m.seq == seq[m.symbol] + 2);
+            gapped.insert(m.symbol);
+            seq[m.symbol] = m.seq;
+        }
+        else {
+            REQUIRE(m.seq == ++seq[m.symbol]);
+        }
+    }
+    REQUIRE(!gapped.empty());
+
+    // A client resubscribing after the gap picks up at the new sequence
+    auto late = feed.subscribe({});
+    feed.publish();
+    for (const auto& m : drain(late)) {
+        if (m.type != BookFeed::MessageType::BOOK_SNAPSHOT) continue;
+        REQUIRE(m.seq == (gapped.count(m.symbol) ? seq[m.symbol] : seq[m.symbol] + 1));
+    }
+}
+
+TEST_CASE("AdmissionControl: Bulk slots and backlog shed reads, never order entry", "[engine]") {
+    using RouteClass = AdmissionControl::RouteClass;
+    AdmissionControl::Limits limits;
+    limits.bulk = 2;
+    limits.maxQueued = 1;
+    AdmissionControl admission(limits);
+
+    {
+        auto a = admission.admit(RouteClass::BULK);
+        auto b = admission.admit(RouteClass::BULK);
+        REQUIRE(a);
+        REQUIRE(b);
+        REQUIRE_FALSE(admission.admit(RouteClass::BULK));
+        REQUIRE(admission.getStats().classes[static_cast<size_t>(RouteClass::BULK)].active == 2);
+        REQUIRE(admission.admit(RouteClass::READ));
+    }
+    REQUIRE(admission.admit(RouteClass::BULK));  // Slots come back with their tickets
+
+    // Two connections waiting for a worker is over the backlog limit
+    admission.connectionQueued();
+    admission.connectionQueued();
+    REQUIRE_FALSE(admission.admit(RouteClass::READ));
+    REQUIRE_FALSE(admission.admit(RouteClass::BULK));
+    REQUIRE(admission.admit(RouteClass::CRITICAL));
+    REQUIRE(admission.admit(RouteClass::STREAM));
+
+    admission.connectionStarted();
+    REQUIRE(admission.admit(RouteClass::READ));
+    admission.connectionFinished();
+
+    auto stats = admission.getStats();
+    REQUIRE(stats.queuedConnections == 1);
+    REQUIRE(stats.activeConnections == 0);
+    REQUIRE(stats.classes[static_cast<size_t>(RouteClass::READ)].rejected == 1);
+    REQUIRE(stats.classes[static_cast<size_t>(RouteClass::BULK)].rejected == 2);
+    REQUIRE(stats.classes[static_cast<size_t>(RouteClass::BULK)].admitted == 3);
+    for (const auto& c : stats.classes) REQUIRE(c.active == 0);
+
+    // A moved ticket releases its slot once, from its new owner
+    AdmissionControl::Ticket held = admission.admit(RouteClass::BULK);
+    AdmissionControl::Ticket moved = std::move(held);
+    REQUIRE_FALSE(held);
+    REQUIRE(moved);
+    moved = AdmissionControl::Ticket();
+    REQUIRE(admission.getStats().classes[static_cast<size_t>(RouteClass::BULK)].active == 0);
+}
+
+TEST_CASE("ResponseCache: One build per key and stamp, with content ETags", "[engine]") {
+    ResponseCache cache;
+    std::atomic<int> builds{ 0 };
+    auto build = [&] { builds++; return std::string("{\"tick\":1}"); };
+
+    auto first = cache.get("/state", 1, build);
+    auto again = cache.get("/state", 1, build);
+    REQUIRE(builds.load() == 1);
+    REQUIRE(first == again);
+    REQUIRE(first->etag.front() == '"');
+    REQUIRE(first->etag == ResponseCache::makeEtag(first->body));
+    cache.get("/agents", 1, build);
+    REQUIRE(builds.load() == 2);
+
+    // A new stamp rebuilds; the same body keeps its tag
+    auto next = cache.get("/state", 2, build);
+    REQUIRE(builds.load() == 3);
+    REQUIRE(next->etag == first->etag);
+    REQUIRE(cache.get("/state", 2, [] { return std::string("{}"); })->etag == first->etag);
+
+    // Concurrent readers of a new stamp share one (slow) build
+    std::vector<std::thread> readers;
+    std::atomic<int> slowBuilds{ 0 };
+    std::vector<std::string> bodies(8);
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        readers.emplace_back([&, i] {
+            bodies[i] = cache.get("/diagnostics", 7, [&] {
+                slowBuilds++;
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                return std::string("slow");
+            })->body;
+        });
+    }
+    for (auto& t : readers) t.join();
+    REQUIRE(slowBuilds.load() == 1);
+    for (const auto& body : bodies) REQUIRE(body == "slow");
+
+    auto stats = cache.getStats();
+    REQUIRE(stats.misses == 4);
+    REQUIRE(stats.hits == 2 + 7);
+
+    const std::string tag = first->etag;
+    REQUIRE(ResponseCache::matches(tag, tag));
+    REQUIRE(ResponseCache::matches("\"other\", " + tag, tag));
+    REQUIRE(ResponseCache::matches("W/" + tag, tag));
+    REQUIRE(ResponseCache::matches("*", tag));
+    REQUIRE_FALSE(ResponseCache::matches("\"other\"", tag));
+    REQUIRE_FALSE(ResponseCache::matches("", tag));
+
+    // A compressed body's weak tag still revalidates against the entry
+    std::string weak = ResponseCache::weakEtag(tag);
+    REQUIRE(weak == "W/" + tag);
+    REQUIRE(ResponseCache::weakEtag(weak) == weak);
+    REQUIRE(ResponseCache::matches(weak, tag));
+}
+
+TEST_CASE("Profiling: Prometheus text groups samples under one header per family", "[engine]") {
+    LatencyHistogram h;
+    h.record(3);
+    h.record(1500);
+
+    PrometheusWriter out;
+    out.histogram("x_seconds", "Test", h, PrometheusWriter::label("phase", "a"));
+    out.counter("x_total", "Count", 7);
+    out.histogram("x_seconds", "Test", h, PrometheusWriter::label("phase", "b"));
+    std::string text = out.str();
+
+    auto occurrences = [&text](const std::string& needle) {
+        size_t n = 0;
+        for (size_t at = text.find(needle); at != std::string::npos; at = text.find(needle, at + 1)) n++;
+        return n;
+    };
+    REQUIRE(occurrences("# TYPE x_seconds histogram\n") == 1);
+    REQUIRE(occurrences("# TYPE x_seconds_quantile gauge\n") == 1);
+    REQUIRE(text.find("x_seconds_count{phase=\"b\"}") < text.find("# TYPE x_total"));
+    REQUIRE(text.find("x_seconds_bucket{phase=\"a\",le=\"4e-06\"} 1\n") != std::string::npos);
+    REQUIRE(text.find("x_seconds_bucket{phase=\"a\",le=\"+Inf\"} 2\n") != std::string::npos);
+    REQUIRE(text.find("x_seconds_sum{phase=\"a\"} 0.001503\n") != std::string::npos);
+    REQUIRE(text.find("x_seconds_max{phase=\"a\"} 0.0015\n") != std::string::npos);
+    REQUIRE(text.find("x_total 7\n") != std::string::npos);
+    REQUIRE(PrometheusWriter::label("k", "a\"b\\") == "k=\"a\\\"b\\\\\"");
+}
+
+TEST_CASE("Profiling: Every tick phase is timed once per tick", "[engine]") {
+    std::ifstream file("commodities.json");
+    nlohmann::json commodities = nlohmann::json::parse(file);
+    nlohmann::json config = { {"simulation", {{"populate_ticks_per_day", 200}}} };
+
+    Simulation sim;
+    sim.loadConfig(config);
+    sim.setSeed(17);
+    sim.setCommoditiesData(commodities);
+    sim.initialize();
+    sim.getEngine().getProfiler().reset();
+    for (int i = 0; i < 20; ++i) sim.step(1);  // One snapshot per step
+
+    auto snapshot = sim.getSnapshot();
+    size_t resting = 0;
+    for (const auto& view : snapshot->commodities) resting += view.bidOrders + view.askOrders;
+    REQUIRE(resting > 0);
+
+    PrometheusWriter out;
+    sim.writePrometheus(out);
+    std::string text = out.str();
+    REQUIRE(text.find("market_book_orders{symbol=\"OIL\",side=\"bid\"}") != std::string::npos);
+    REQUIRE(text.find("market_ticks_total 20\n") != std::string::npos);
+    REQUIRE(text.find("market_tick_trades " + std::to_string(snapshot->tickTrades) + "\n") != std::string::npos);
+
+#if MARKET_PROFILING
+    const TickProfiler& profiler = sim.getEngine().getProfiler();
+    for (size_t i = 0; i < static_cast<size_t>(TickProfiler::Phase::COUNT); ++i) {
+        auto phase = static_cast<TickProfiler::Phase>(i);
+        INFO(TickProfiler::phaseName(phase));
+        REQUIRE(profiler[phase].count() == 20);
+    }
+    REQUIRE(text.find("market_tick_phase_seconds_count{phase=\"matching\"} 20\n") != std::string::npos);
+    REQUIRE(sim.getMetricsJson()["tickPhases"]["tick"]["count"] == 20);
+#endif
+}
+
+TEST_CASE("Journal: Replay reproduces the journaled order flow without agents", "[engine]") {
+    std::ifstream file("commodities.json");
+    nlohmann::json commodities = nlohmann::json::parse(file);
+    nlohmann::json config = { {"simulation", {{"populate_ticks_per_day", 200}}} };
+    auto path = std::filesystem::temp_directory_path() / "market_journal_test.bin";
+
+    Simulation original;
+    original.loadConfig(config);
+    original.setSeed(21);
+    original.setCommoditiesData(commodities);
+    original.initialize();
+    original.populateTicks(100);
+    uint64_t tradesAtStart = original.getEngine().getMetrics().totalTrades;
+
+    original.startJournal(path.string());
+    REQUIRE_THROWS_AS(original.startJournal(path.string()), std::runtime_error);
+    original.step(20);
+    // Injected news and a user order flushed between ticks, as POST /news and /orders do
+    auto& engine = original.getEngine();
+    engine.getNewsGenerator().injectSupplyNews("OIL", NewsSentiment::NEGATIVE, 0.2, "Pipeline outage");
+    engine.submitExternalOrder(makeUserOrder(engine, "OIL", OrderSide::BUY, OrderType::MARKET, 0.0, 25));
+    std::vector<IngressOrder> batch;
+    batch.push_back(makeUserOrder(engine, "OIL", OrderSide::BUY, OrderType::LIMIT, 1.0, 7));
+    batch.push_back(IngressOrder{});
+    batch.back().symbol = "OIL";
+    batch.back().cancelId = batch.front().order.id;
+    engine.submitExternalOrders(std::move(batch));
+    original.flushExternalOrders();
+    original.step(30);
+    REQUIRE(original.getJournalJson()["entries"] == 51);
+    original.stopJournal();
+    REQUIRE_FALSE(original.isJournaling());
+
+    Simulation replayed;
+    replayed.loadConfig(config);
+    replayed.setSeed(99);
+    replayed.setCommoditiesData(commodities);
+    replayed.initialize();
+    REQUIRE(replayed.replayJournal(path.string()) == 50);
+
+    auto want = original.getEngine().getMetrics();
+    auto got = replayed.getEngine().getMetrics();
+    REQUIRE(want.totalTrades > tradesAtStart);
+    REQUIRE(got.totalTicks == want.totalTicks);
+    REQUIRE(got.totalTrades == want.totalTrades);
+    REQUIRE(got.totalOrders == want.totalOrders);
+    REQUIRE(replayed.getCurrentTick() == 150);
+    for (const auto& [symbol, commodity] : original.getEngine().getCommodities()) {
+        INFO(symbol);
+        REQUIRE(replayed.getEngine().getCommodities().at(symbol)->getPrice() == commodity->getPrice());
+        auto wantBook = original.getEngine().getOrderBookSnapshots(5).at(symbol);
+        auto gotBook = replayed.getEngine().getOrderBookSnapshots(5).at(symbol);
+        REQUIRE(gotBook.bids.size() == wantBook.bids.size());
+        REQUIRE(gotBook.bestBid == wantBook.bestBid);
+        REQUIRE(gotBook.bestAsk == wantBook.bestAsk);
+    }
+
+    // A journal cut off mid-write replays up to its last whole entry
+    auto size = std::filesystem::file_size(path);
+    std::filesystem::resize_file(path, size - 10);
+    Simulation partial;
+    partial.loadConfig(config);
+    partial.setCommoditiesData(commodities);
+    partial.initialize();
+    REQUIRE(partial.replayJournal(path.string()) == 49);
+
+    std::filesystem::remove(path);
+    REQUIRE_THROWS_AS(partial.replayJournal(path.string()), std::runtime_error);
+}
+
+TEST_CASE("Logging: Async mode drains on shutdown and debug arguments are lazy", "[engine]") {
+    auto previous = spdlog::default_logger();
+    auto path = std::filesystem::temp_directory_path() / "market_test_async.log";
+
+    Logger::AsyncOptions async;
+    async.enabled = true;
+    async.queueSize = 64;
+    Logger::init(path.string(), "info", false, async);
+    REQUIRE(Logger::isAsync());
+
+    int evaluated = 0;
+    auto expensive = [&evaluated]() { evaluated++; return 1; };
+    MARKET_LOG_DEBUG("skipped {}", expensive());
+    REQUIRE(evaluated == 0);
+
+    for (int i = 0; i < 1000; ++i) Logger::info("line {}", i);
+    Logger::shutdown();
+    REQUIRE_FALSE(Logger::isAsync());
+    Logger::info("after shutdown");
+    spdlog::default_logger()->flush();
+
+    std::ifstream file(path);
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    REQUIRE(text.find("line 999") != std::string::npos);
+    REQUIRE(text.find("after shutdown") != std::string::npos);
+    REQUIRE(text.find("skipped") == std::string::npos);
+
+#if MARKET_LOG_LEVEL <= 1
+    spdlog::default_logger()->set_level(spdlog::level::debug);
+    MARKET_LOG_DEBUG("shown {}", expensive());
+    REQUIRE(evaluated == 1);
+#endif
+
+    spdlog::set_default_logger(previous);
+    file.close();
+    std::filesystem::remove(path);
+}
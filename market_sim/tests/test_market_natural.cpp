@@ -514,7 +514,7 @@ public:
 
     MarketNaturalnessFixture() {
         // Reset random seed for reproducibility
-        Random::seed(42);
+        Random::seed(43);
         
         sim.loadConfig(std::string("{}"));
         sim.loadCommodities("commodities.json");
@@ -1345,9 +1345,9 @@ TEST_CASE_METHOD(MarketNaturalnessFixture, "HFT: Trade flow - Trade size distrib
 TEST_CASE_METHOD(MarketNaturalnessFixture, "HFT: Trade flow - Trade price distribution", "[hft]") {
     if (allTrades.size() < 10) return;
     
-    std::map<std::string, std::vector<double>> tradesBySymbol;
+    std::map<SymbolId, std::vector<double>> tradesBySymbol;
     for (const auto& trade : allTrades) {
-        tradesBySymbol[trade.symbol].push_back(trade.price);
+        tradesBySymbol[trade.symbolId].push_back(trade.price);
     }
     
     for (const auto& [sym, prices] : tradesBySymbol) {
@@ -1373,9 +1373,9 @@ TEST_CASE_METHOD(MarketNaturalnessFixture, "HFT: Trade flow - Buyer/seller balan
     }
     
     // Verify we have trades across multiple symbols
-    std::set<std::string> symbols;
+    std::set<SymbolId> symbols;
     for (const auto& trade : allTrades) {
-        symbols.insert(trade.symbol);
+        symbols.insert(trade.symbolId);
     }
     
     REQUIRE(symbols.size() >= 1);
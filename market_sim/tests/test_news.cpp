@@ -1,12 +1,15 @@
 #include <catch2/catch_test_macros.hpp>
 #include "environment/NewsGenerator.hpp"
+#include "core/NewsLog.hpp"
 #include "core/Types.hpp"
+#include "utils/Random.hpp"
 
 using namespace market;
 
 TEST_CASE("NewsGenerator: Basic construction", "[news]") {
     NewsGenerator ng(0.1, 0.02, 0.05, 0.05);
-    REQUIRE(ng.getNewsHistory().empty());
+    REQUIRE(ng.getRecentNews().empty());
+    REQUIRE(ng.getInjectedNews().empty());
 }
 
 TEST_CASE("NewsGenerator: Set commodities", "[news]") {
@@ -77,15 +80,28 @@ TEST_CASE("NewsGenerator: Generate processes injected news", "[news]") {
     // and no random events were generated (lambda affects random generation)
 }
 
-TEST_CASE("NewsGenerator: News history accumulates", "[news]") {
+TEST_CASE("NewsLog: News history accumulates", "[news]") {
     NewsGenerator ng(0.5); // High lambda to ensure events
-
     ng.setCommodities({"OIL"});
-
-    ng.generate(1000, 1.0);
-    ng.generate(2000, 1.0);
-
-    REQUIRE(ng.getNewsHistory().size() >= 0); // History should accumulate
+    ng.injectSupplyNews("OIL", NewsSentiment::NEGATIVE, 0.1, "Refinery fire");
+
+    NewsLog log;
+    size_t generated = 0;
+    for (uint64_t tick = 0; tick < 20; ++tick) {
+        for (const auto& e : ng.generate(1000 * (tick + 1), 1.0)) {
+            log.append(tick, e);
+            generated++;
+        }
+    }
+
+    REQUIRE(log.size() == generated);
+    auto first = log[0];
+    REQUIRE(first.tick == 0);
+    REQUIRE(first.symbol == "OIL");
+    REQUIRE(first.category == "supply");
+    REQUIRE(first.sentiment == "negative");
+    REQUIRE(first.headline == "Refinery fire");
+    REQUIRE(first.timestamp == 1000);
 }
 
 TEST_CASE("NewsGenerator: Recent news tracking", "[news]") {
@@ -98,16 +114,84 @@ TEST_CASE("NewsGenerator: Recent news tracking", "[news]") {
     REQUIRE(recent.size() == 2);
 }
 
-TEST_CASE("NewsGenerator: Clear history", "[news]") {
+TEST_CASE("NewsLog: Clear history", "[news]") {
     NewsGenerator ng;
+    NewsLog log;
 
     ng.injectGlobalNews(NewsSentiment::POSITIVE, 0.05, "Test");
-    ng.generate(1000, 1.0);
+    for (const auto& e : ng.generate(1000, 1.0)) log.append(1, e);
 
-    REQUIRE_FALSE(ng.getNewsHistory().empty());
+    REQUIRE_FALSE(log.empty());
 
-    ng.clearNewsHistory();
-    REQUIRE(ng.getNewsHistory().empty());
+    log.clear();
+    REQUIRE(log.empty());
+    REQUIRE(log.select(0, UINT64_MAX, "", 10).empty());
+}
+
+TEST_CASE("NewsLog: Tick and symbol queries", "[news]") {
+    NewsLog log;
+    // More than a block of entries and of headline text
+    for (uint64_t tick = 0; tick < 3000; ++tick) {
+        const char* symbol = tick % 3 == 0 ? "OIL" : tick % 3 == 1 ? "GOLD" : "";
+        log.append(tick, symbol, tick % 2 ? "supply" : "demand", "neutral", tick * 0.001,
+            std::string(40, 'a' + tick % 26) + std::to_string(tick));
+        if (tick == 1500) log.append(tick, "OIL", "supply", "positive", 0.5, "Second at 1500");
+    }
+    REQUIRE(log.size() == 3001);
+    REQUIRE_THROWS_AS(log.append(10, "OIL", "supply", "neutral", 0.1, "Late"), std::runtime_error);
+
+    REQUIRE(log.lowerBound(1500) == 1500);
+    REQUIRE(log.lowerBound(1501) == 1502);
+    REQUIRE(log.lowerBound(5000) == 3001);
+
+    auto newest = log.select(0, UINT64_MAX, "", 3);
+    REQUIRE(newest == std::vector<size_t>{ 2998, 2999, 3000 });
+    REQUIRE(log[3000].headline == std::string(40, 'a' + 2999 % 26) + "2999");
+
+    auto oil = log.select(1500, 1600, "OIL", 1000);
+    REQUIRE(oil.size() == 35);  // 1500..1599 every third tick, plus the extra one
+    REQUIRE(log[oil[0]].tick == 1500);
+    REQUIRE(log[oil[1]].headline == "Second at 1500");
+    REQUIRE(log[oil.back()].tick == 1599);
+    for (size_t i : oil) REQUIRE(log[i].symbol == "OIL");
+    REQUIRE(log.select(0, UINT64_MAX, "GOLD", 2).size() == 2);
+    REQUIRE(log.select(0, UINT64_MAX, "SILVER", 2).empty());
+
+    // A fork keeps reading its entries while both sides go on appending
+    NewsLog fork = log.fork();
+    log.append(3000, "OIL", "supply", "negative", 0.2, "Original");
+    fork.append(3000, "GOLD", "demand", "positive", 0.3, "Fork");
+    REQUIRE(log[3001].headline == "Original");
+    REQUIRE(fork[3001].headline == "Fork");
+    REQUIRE(fork[2999].headline == log[2999].headline);
+    REQUIRE(fork.select(3000, UINT64_MAX, "OIL", 10).size() == 0);
+}
+
+TEST_CASE("NewsLog: Record views survive appends and forks", "[news]") {
+    NewsLog log;
+    log.append(0, "OIL", "supply", "neutral", 0.1, "First");
+    NewsLog::Record first = log[0];
+
+    // Enough new names to reallocate the intern table many times over
+    for (uint64_t tick = 1; tick < 2000; ++tick) {
+        log.append(tick, "SYM" + std::to_string(tick), "cat" + std::to_string(tick), "neutral", 0.0, "");
+    }
+    REQUIRE(first.symbol == "OIL");
+    REQUIRE(first.category == "supply");
+    REQUIRE(first.headline == "First");
+
+    // A view into the open text block outlives a fork that shared it
+    log.append(2000, "OIL", "demand", "positive", 0.2, "Before fork");
+    NewsLog::Record tail = log[2000];
+    {
+        NewsLog fork = log.fork();
+        log.append(2001, "OIL", "demand", "negative", 0.3, "After fork");
+        fork.append(2001, "GOLD", "supply", "positive", 0.4, "Fork only");
+        REQUIRE(fork[2000].headline == "Before fork");
+    }
+    REQUIRE(tail.headline == "Before fork");
+    REQUIRE(tail.symbol == "OIL");
+    REQUIRE(log[2001].headline == "After fork");
 }
 
 TEST_CASE("NewsGenerator: Set lambda", "[news]") {
@@ -117,6 +201,40 @@ TEST_CASE("NewsGenerator: Set lambda", "[news]") {
     // Lambda affects event generation rate - hard to test directly
 }
 
+TEST_CASE("NewsGenerator: Arrivals follow lambda and quiet ticks draw nothing", "[news]") {
+    Random::seed(42);
+    NewsGenerator ng(0.1);
+    ng.setCommodities({"OIL", "COPPER"});
+    ng.setCommodityNames({{"OIL", "Crude Oil"}});
+
+    size_t events = 0, quiet = 0;
+    for (Timestamp t = 1; t <= 20000; ++t) {
+        Random::Engine before = Random::engine();
+        auto news = ng.generate(t, 1.0);
+        if (news.empty() && t > 1) {
+            // No arrival this tick: the RNG was not touched
+            Random::Engine after = Random::engine();
+            REQUIRE(before.next64() == after.next64());
+            quiet++;
+        }
+        for (const auto& n : news) {
+            REQUIRE(n.timestamp == t);
+            REQUIRE_FALSE(n.headline.empty());
+            if (n.symbol == "COPPER") REQUIRE(n.commodityName == "COPPER");
+            if (n.symbol == "OIL") REQUIRE(n.commodityName == "Crude Oil");
+        }
+        events += news.size();
+    }
+    // 2000 expected, standard deviation about 45
+    REQUIRE(events > 1800);
+    REQUIRE(events < 2200);
+    REQUIRE(quiet > 17000);
+
+    // Neutral supply news on a symbol without templates uses the name
+    ng.injectSupplyNews("COPPER", NewsSentiment::NEUTRAL, 0.01, "");
+    REQUIRE(ng.getInjectedNews()[0].headline == "COPPER supply improved");
+}
+
 TEST_CASE("NewsGenerator: Set impact parameters", "[news]") {
     NewsGenerator ng;
 
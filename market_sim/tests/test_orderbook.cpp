@@ -19,7 +19,7 @@ TEST_CASE("OrderBook: Add single bid order", "[orderbook]") {
     Order bid;
     bid.id = 1;
     bid.agentId = 100;
-    bid.symbol = "TEST";
+    bid.symbolId = 0;
     bid.side = OrderSide::BUY;
     bid.type = OrderType::LIMIT;
     bid.price = 100.0;
@@ -37,7 +37,7 @@ TEST_CASE("OrderBook: Add single ask order", "[orderbook]") {
     Order ask;
     ask.id = 1;
     ask.agentId = 100;
-    ask.symbol = "TEST";
+    ask.symbolId = 0;
     ask.side = OrderSide::SELL;
     ask.type = OrderType::LIMIT;
     ask.price = 105.0;
@@ -109,6 +109,40 @@ TEST_CASE("OrderBook: Cancel order", "[orderbook]") {
     REQUIRE(book.cancelOrder(999) == false); // Non-existent
 }
 
+TEST_CASE("OrderBook: Batched actions only cancel the owner's orders", "[orderbook]") {
+    OrderBook book("TEST");
+
+    auto place = [](OrderId id, AgentId agent, Price price) {
+        OrderAction action;
+        action.order.id = id;
+        action.order.agentId = agent;
+        action.order.side = OrderSide::BUY;
+        action.order.type = OrderType::LIMIT;
+        action.order.price = price;
+        action.order.quantity = 10;
+        return action;
+    };
+    auto cancel = [](OrderId id, AgentId agent) {
+        OrderAction action;
+        action.kind = OrderAction::Kind::CANCEL;
+        action.order.id = id;
+        action.order.agentId = agent;
+        return action;
+    };
+
+    // Replace agent 100's bid; agent 200 cannot pull it
+    std::vector<OrderAction> actions = {
+        place(1, 100, 99.0), cancel(1, 200), cancel(1, 100), place(2, 100, 100.0), cancel(3, 100)
+    };
+    REQUIRE(book.applyActions(actions) == 1);
+    REQUIRE(book.getBidCount() == 1);
+    REQUIRE(book.getBestBid() == 100.0);
+
+    REQUIRE(book.cancelOrder(2, 200) == false);
+    REQUIRE(book.cancelOrder(2, 100) == true);
+    REQUIRE(book.getBidCount() == 0);
+}
+
 TEST_CASE("OrderBook: Match crossing orders", "[orderbook]") {
     OrderBook book("TEST");
 
@@ -417,3 +451,320 @@ TEST_CASE("OrderBook: Thread safety - concurrent adds", "[orderbook]") {
 
     REQUIRE(book.getBidCount() == 10);
 }
+
+TEST_CASE("OrderBook: Cancel from middle of price level keeps FIFO order", "[orderbook]") {
+    OrderBook book("TEST");
+
+    for (int i = 1; i <= 3; i++) {
+        Order bid;
+        bid.id = i; bid.agentId = 100 * i; bid.side = OrderSide::BUY; bid.type = OrderType::LIMIT;
+        bid.price = 100.0; bid.quantity = 10;
+        book.addOrder(bid);
+    }
+
+    REQUIRE(book.cancelOrder(2) == true);
+    REQUIRE(book.getBidCount() == 2);
+
+    Order ask;
+    ask.id = 4; ask.agentId = 400; ask.side = OrderSide::SELL; ask.type = OrderType::LIMIT;
+    ask.price = 100.0; ask.quantity = 20;
+    book.addOrder(ask);
+
+    auto trades = book.matchOrders();
+
+    REQUIRE(trades.size() == 2);
+    REQUIRE(trades[0].buyerId == 100);
+    REQUIRE(trades[1].buyerId == 300);
+    REQUIRE(book.getBidCount() == 0);
+    REQUIRE(book.getAskCount() == 0);
+    REQUIRE(book.getBestBid() == 0.0);
+}
+
+TEST_CASE("OrderBook: Cancel partially filled order", "[orderbook]") {
+    OrderBook book("TEST");
+
+    Order bid, ask;
+    bid.id = 1; bid.agentId = 100; bid.side = OrderSide::BUY; bid.type = OrderType::LIMIT;
+    bid.price = 100.0; bid.quantity = 15;
+
+    ask.id = 2; ask.agentId = 200; ask.side = OrderSide::SELL; ask.type = OrderType::LIMIT;
+    ask.price = 100.0; ask.quantity = 10;
+
+    book.addOrder(bid);
+    book.addOrder(ask);
+    REQUIRE(book.matchOrders().size() == 1);
+
+    REQUIRE(book.cancelOrder(2) == false); // Fully filled, no longer resting
+    REQUIRE(book.cancelOrder(1) == true);  // Remaining 5 lots cancelled
+    REQUIRE(book.getBidCount() == 0);
+    REQUIRE(book.getSnapshot(5).bids.empty());
+}
+
+TEST_CASE("OrderBook: Snapshot counts orders per level", "[orderbook]") {
+    OrderBook book("TEST");
+
+    for (int i = 1; i <= 4; i++) {
+        Order bid;
+        bid.id = i; bid.agentId = i; bid.side = OrderSide::BUY; bid.type = OrderType::LIMIT;
+        bid.price = (i <= 3) ? 100.0 : 99.0; bid.quantity = 5;
+        book.addOrder(bid);
+    }
+    book.cancelOrder(1);
+
+    auto snap = book.getSnapshot(1);
+
+    REQUIRE(snap.bids.size() == 1); // Depth limit respected
+    REQUIRE(snap.bids[0].price == 100.0);
+    REQUIRE(snap.bids[0].orderCount == 2);
+    REQUIRE(snap.bids[0].totalQuantity == 10);
+}
+
+TEST_CASE("OrderBook: Prices snap to tick size", "[orderbook]") {
+    OrderBook book("TEST", 0.05);
+    REQUIRE(book.getTickSize() == 0.05);
+
+    // Nearly-equal bids share one level; bids round down, asks round up
+    Order bid1, bid2, ask;
+    bid1.id = 1; bid1.agentId = 1; bid1.side = OrderSide::BUY; bid1.type = OrderType::LIMIT;
+    bid1.price = 100.02; bid1.quantity = 10;
+
+    bid2.id = 2; bid2.agentId = 2; bid2.side = OrderSide::BUY; bid2.type = OrderType::LIMIT;
+    bid2.price = 100.0000000001; bid2.quantity = 10;
+
+    ask.id = 3; ask.agentId = 3; ask.side = OrderSide::SELL; ask.type = OrderType::LIMIT;
+    ask.price = 100.11; ask.quantity = 10;
+
+    book.addOrder(bid1);
+    book.addOrder(bid2);
+    book.addOrder(ask);
+
+    auto snap = book.getSnapshot(5);
+    REQUIRE(snap.bids.size() == 1);
+    REQUIRE(snap.bids[0].price == 100.0);
+    REQUIRE(snap.bids[0].orderCount == 2);
+    REQUIRE(book.getBestAsk() == 100.15);
+    REQUIRE(book.toTicks(100.15, OrderSide::SELL) == 2003);
+}
+
+TEST_CASE("OrderBook: Trades carry integer price ticks", "[orderbook]") {
+    OrderBook book("TEST");
+
+    Order bid, ask;
+    bid.id = 1; bid.agentId = 100; bid.side = OrderSide::BUY; bid.type = OrderType::LIMIT;
+    bid.price = 101.25; bid.quantity = 10;
+
+    ask.id = 2; ask.agentId = 200; ask.side = OrderSide::SELL; ask.type = OrderType::LIMIT;
+    ask.price = 101.25; ask.quantity = 10;
+
+    book.addOrder(bid);
+    book.addOrder(ask);
+
+    auto trades = book.matchOrders();
+
+    REQUIRE(trades.size() == 1);
+    REQUIRE(trades[0].priceTicks == 10125);
+    REQUIRE(trades[0].price == 101.25);
+}
+
+TEST_CASE("OrderBook: Level aggregates track fills and cancels", "[orderbook]") {
+    OrderBook book("TEST");
+
+    for (int i = 1; i <= 3; i++) {
+        Order ask;
+        ask.id = i; ask.agentId = i; ask.side = OrderSide::SELL; ask.type = OrderType::LIMIT;
+        ask.price = 100.0; ask.quantity = 10;
+        book.addOrder(ask);
+    }
+
+    Order bid;
+    bid.id = 4; bid.agentId = 4; bid.side = OrderSide::BUY; bid.type = OrderType::LIMIT;
+    bid.price = 100.0; bid.quantity = 15;
+    book.addOrder(bid);
+
+    REQUIRE(book.matchOrders().size() == 2);
+
+    auto snap = book.getSnapshot(5);
+    REQUIRE(snap.asks.size() == 1);
+    REQUIRE(snap.asks[0].totalQuantity == 15); // 5 left on order 2, 10 on order 3
+    REQUIRE(snap.asks[0].orderCount == 2);
+    REQUIRE(snap.bids.empty());
+
+    book.cancelOrder(3);
+    snap = book.getSnapshot(5);
+    REQUIRE(snap.asks[0].totalQuantity == 5);
+    REQUIRE(snap.asks[0].orderCount == 1);
+}
+
+TEST_CASE("OrderBook: Expiry evicts orders below the top of book", "[orderbook]") {
+    SimClock clock;
+    clock.setSimTime(1000000);
+    OrderBook book("TEST");
+    book.setSimClock(&clock);
+    book.setMaxOrderAgeMs(60000);
+
+    // Old orders deep on both sides
+    for (int i = 1; i <= 5; i++) {
+        Order bid;
+        bid.id = i; bid.agentId = i; bid.side = OrderSide::BUY; bid.type = OrderType::LIMIT;
+        bid.price = 90.0 - i; bid.quantity = 10;
+        book.addOrder(bid);
+
+        Order ask;
+        ask.id = 100 + i; ask.agentId = i; ask.side = OrderSide::SELL; ask.type = OrderType::LIMIT;
+        ask.price = 110.0 + i; ask.quantity = 10;
+        book.addOrder(ask);
+    }
+
+    clock.setSimTime(1000000 + 50000);
+
+    // Fresh orders at the top, which the old top-only check would stop at
+    Order bid;
+    bid.id = 50; bid.agentId = 50; bid.side = OrderSide::BUY; bid.type = OrderType::LIMIT;
+    bid.price = 95.0; bid.quantity = 10;
+    book.addOrder(bid);
+
+    Order ask;
+    ask.id = 150; ask.agentId = 50; ask.side = OrderSide::SELL; ask.type = OrderType::LIMIT;
+    ask.price = 105.0; ask.quantity = 10;
+    book.addOrder(ask);
+
+    REQUIRE(book.matchOrders().empty());
+    REQUIRE(book.getBidCount() == 6);
+    REQUIRE(book.getAskCount() == 6);
+
+    clock.setSimTime(1000000 + 60001);
+    REQUIRE(book.matchOrders().empty());
+    REQUIRE(book.getBidCount() == 1);
+    REQUIRE(book.getAskCount() == 1);
+    REQUIRE(book.getBestBid() == 95.0);
+    REQUIRE(book.cancelOrder(3) == false);
+
+    auto snap = book.getSnapshot(10);
+    REQUIRE(snap.bids.size() == 1);
+    REQUIRE(snap.asks.size() == 1);
+
+    clock.setSimTime(1000000 + 50000 + 60001);
+    REQUIRE(book.expireOrders() == 2);
+    REQUIRE(book.getBidCount() == 0);
+    REQUIRE(book.getAskCount() == 0);
+}
+
+TEST_CASE("OrderBook: Expiry survives clock jumps and max-age changes", "[orderbook]") {
+    SimClock clock;
+    clock.setSimTime(5000000);
+    OrderBook book("TEST");
+    book.setSimClock(&clock);
+
+    for (int i = 1; i <= 4; i++) {
+        Order bid;
+        bid.id = i; bid.agentId = i; bid.side = OrderSide::BUY; bid.type = OrderType::LIMIT;
+        bid.price = 100.0 - i; bid.quantity = 10;
+        book.addOrder(bid);
+        clock.setSimTime(clock.getSimTime() + 1000);
+    }
+
+    // Shrinking the max age re-buckets resting orders: only the newest two survive
+    book.setMaxOrderAgeMs(2500);
+    REQUIRE(book.expireOrders() == 2);
+    REQUIRE(book.getBidCount() == 2);
+
+    // Cancelling an order removes it from the wheel too
+    REQUIRE(book.cancelOrder(3));
+
+    // A jump over many wheel rotations evicts the rest
+    clock.setSimTime(clock.getSimTime() + 10000000);
+    REQUIRE(book.expireOrders() == 1);
+    REQUIRE(book.getBidCount() == 0);
+
+    // Rewinding the clock (a fresh populate) expires orders stamped in the future
+    Order late;
+    late.id = 10; late.agentId = 10; late.side = OrderSide::SELL; late.type = OrderType::LIMIT;
+    late.price = 101.0; late.quantity = 5;
+    book.addOrder(late);
+    clock.setSimTime(5000000);
+    REQUIRE(book.expireOrders() == 1);
+    REQUIRE(book.getAskCount() == 0);
+}
+
+TEST_CASE("OrderBook: Auction clears crossed book at a single price", "[orderbook]") {
+    OrderBook book("TEST");
+    book.setMatchingMode(OrderBook::MatchingMode::AUCTION);
+
+    Order ask1; ask1.id = 1; ask1.agentId = 1; ask1.side = OrderSide::SELL; ask1.type = OrderType::LIMIT;
+    ask1.price = 100.0; ask1.quantity = 10;
+    Order ask2; ask2.id = 2; ask2.agentId = 2; ask2.side = OrderSide::SELL; ask2.type = OrderType::LIMIT;
+    ask2.price = 101.0; ask2.quantity = 10;
+    Order bid1; bid1.id = 3; bid1.agentId = 3; bid1.side = OrderSide::BUY; bid1.type = OrderType::LIMIT;
+    bid1.price = 102.0; bid1.quantity = 15;
+    Order bid2; bid2.id = 4; bid2.agentId = 4; bid2.side = OrderSide::BUY; bid2.type = OrderType::LIMIT;
+    bid2.price = 100.0; bid2.quantity = 5;
+    book.addOrder(ask1);
+    book.addOrder(ask2);
+    book.addOrder(bid1);
+    book.addOrder(bid2);
+
+    // 101 and 102 both clear 15 with 5 excess supply; supply pressure picks 101
+    auto trades = book.matchOrders();
+    REQUIRE(trades.size() == 2);
+    REQUIRE(trades[0].price == 101.0);
+    REQUIRE(trades[1].price == 101.0);
+    REQUIRE(trades[0].buyOrderId == 3);
+    REQUIRE(trades[0].sellOrderId == 1);
+    REQUIRE(trades[0].quantity == 10);
+    REQUIRE(trades[1].sellOrderId == 2);
+    REQUIRE(trades[1].quantity == 5);
+
+    REQUIRE(book.getBestBid() == 100.0);
+    REQUIRE(book.getBestAsk() == 101.0);
+    REQUIRE(book.getSnapshot(5).asks[0].totalQuantity == 5);
+    REQUIRE(book.matchOrders().empty());
+}
+
+TEST_CASE("OrderBook: Auction rations the marginal level", "[orderbook]") {
+    auto run = [](OrderBook::Allocation allocation) {
+        OrderBook book("TEST");
+        book.setMatchingMode(OrderBook::MatchingMode::AUCTION, allocation);
+
+        Order ask1; ask1.id = 1; ask1.agentId = 1; ask1.side = OrderSide::SELL; ask1.type = OrderType::LIMIT;
+        ask1.price = 100.0; ask1.quantity = 30;
+        Order ask2; ask2.id = 2; ask2.agentId = 2; ask2.side = OrderSide::SELL; ask2.type = OrderType::LIMIT;
+        ask2.price = 100.0; ask2.quantity = 10;
+        Order bid; bid.id = 3; bid.agentId = 3; bid.side = OrderSide::BUY; bid.type = OrderType::LIMIT;
+        bid.price = 100.0; bid.quantity = 20;
+        book.addOrder(ask1);
+        book.addOrder(ask2);
+        book.addOrder(bid);
+        return book.matchOrders();
+    };
+
+    auto timeTrades = run(OrderBook::Allocation::TIME_PRIORITY);
+    REQUIRE(timeTrades.size() == 1);
+    REQUIRE(timeTrades[0].sellOrderId == 1);
+    REQUIRE(timeTrades[0].quantity == 20);
+
+    auto proRata = run(OrderBook::Allocation::PRO_RATA);
+    REQUIRE(proRata.size() == 2);
+    REQUIRE(proRata[0].sellOrderId == 1);
+    REQUIRE(proRata[0].quantity == 15);
+    REQUIRE(proRata[1].sellOrderId == 2);
+    REQUIRE(proRata[1].quantity == 5);
+}
+
+TEST_CASE("OrderBook: Auction fills market orders at the clearing price", "[orderbook]") {
+    OrderBook book("TEST");
+    book.setMatchingMode(OrderBook::MatchingMode::AUCTION);
+
+    Order ask; ask.id = 1; ask.agentId = 1; ask.side = OrderSide::SELL; ask.type = OrderType::LIMIT;
+    ask.price = 100.0; ask.quantity = 10;
+    Order bid; bid.id = 2; bid.agentId = 2; bid.side = OrderSide::BUY; bid.type = OrderType::MARKET;
+    bid.price = 99.0; bid.quantity = 5;
+    book.addOrder(ask);
+    book.addOrder(bid);
+
+    auto trades = book.matchOrders();
+    REQUIRE(trades.size() == 1);
+    REQUIRE(trades[0].price == 100.0);
+    REQUIRE(trades[0].quantity == 5);
+    REQUIRE(book.getBidCount() == 0);
+    REQUIRE(book.getSnapshot(5).asks[0].totalQuantity == 5);
+}
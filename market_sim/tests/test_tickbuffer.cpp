@@ -2,7 +2,11 @@
 #include <catch2/catch_approx.hpp>
 #include "core/TickBuffer.hpp"
 #include <filesystem>
+#include <cstring>
 #include <fstream>
+#include <random>
+#include <atomic>
+#include <thread>
 
 using namespace market;
 namespace fs = std::filesystem;
@@ -10,7 +14,11 @@ namespace fs = std::filesystem;
 class TickBufferTestFixture {
 public:
     TickBufferTestFixture() : buffer_(10000) {
-        testDir_ = std::filesystem::temp_directory_path() / "tickbuffer_test";
+        // A directory of its own, so tests run in parallel (ctest -j) never
+        // see or remove each other's files
+        static std::atomic<unsigned> instances{ 0 };
+        testDir_ = std::filesystem::temp_directory_path() / ("tickbuffer_test_" +
+            std::to_string(std::random_device{}()) + "_" + std::to_string(instances++));
         std::filesystem::create_directories(testDir_);
     }
     
@@ -22,6 +30,82 @@ public:
     TickBuffer buffer_;
 };
 
+namespace {
+
+    // Just enough of a FlatBuffers reader to check the Arrow metadata the
+    // exports write: a table in `buf` at `at`, read by field id
+    struct FlatTable {
+        const std::string* buf;
+        size_t at;
+
+        template <typename T> T read(size_t pos) const {
+            T value;
+            std::memcpy(&value, buf->data() + pos, sizeof(value));
+            return value;
+        }
+        // Position of field `id`, or 0 if absent
+        size_t field(uint16_t id) const {
+            size_t vtable = at - read<int32_t>(at);
+            if (4 + 2 * id + 2 > read<uint16_t>(vtable)) return 0;
+            uint16_t offset = read<uint16_t>(vtable + 4 + 2 * id);
+            return offset ? at + offset : 0;
+        }
+        template <typename T> T scalar(uint16_t id) const {
+            size_t pos = field(id);
+            return pos ? read<T>(pos) : T{};
+        }
+        size_t target(uint16_t id) const {
+            size_t pos = field(id);
+            REQUIRE(pos != 0);
+            return pos + read<uint32_t>(pos);
+        }
+        FlatTable table(uint16_t id) const { return { buf, target(id) }; }
+        std::string string(uint16_t id) const {
+            size_t pos = target(id);
+            return buf->substr(pos + 4, read<uint32_t>(pos));
+        }
+        uint32_t length(uint16_t id) const { return read<uint32_t>(target(id)); }
+        FlatTable element(uint16_t id, size_t i) const {
+            size_t slot = target(id) + 4 + 4 * i;
+            return { buf, slot + read<uint32_t>(slot) };
+        }
+        // Field `i` of struct `index` in a vector of int64 structs
+        int64_t structWord(uint16_t id, size_t index, size_t words, size_t i) const {
+            return read<int64_t>(target(id) + 4 + 8 * (index * words + i));
+        }
+    };
+
+    struct ArrowMessage {
+        size_t offset;   // Of the continuation marker
+        FlatTable header;
+        uint8_t headerType;
+        size_t body;     // Offset of the body
+        int64_t bodyLength;
+    };
+
+    // Every message of an Arrow IPC file, in order, up to the end-of-stream marker
+    std::vector<ArrowMessage> arrowMessages(const std::string& file) {
+        std::vector<ArrowMessage> messages;
+        size_t pos = 8;
+        while (pos + 8 <= file.size()) {
+            uint32_t marker, length;
+            std::memcpy(&marker, file.data() + pos, 4);
+            std::memcpy(&length, file.data() + pos + 4, 4);
+            REQUIRE(marker == 0xFFFFFFFF);
+            if (length == 0) break;
+            size_t metadata = pos + 8;
+            FlatTable message{ &file, metadata + FlatTable{ &file, 0 }.read<uint32_t>(metadata) };
+            REQUIRE(message.scalar<int16_t>(0) == 4);  // MetadataVersion V5
+            ArrowMessage m{ pos, message.table(2), message.scalar<uint8_t>(1), metadata + length,
+                message.scalar<int64_t>(3) };
+            messages.push_back(m);
+            pos = m.body + static_cast<size_t>(m.bodyLength);
+        }
+        return messages;
+    }
+
+} // namespace
+
 TEST_CASE_METHOD(TickBufferTestFixture, "TickBuffer: Initial state", "[tickbuffer]") {
     TickBuffer freshBuffer(1000);
     
@@ -249,3 +333,511 @@ TEST_CASE_METHOD(TickBufferTestFixture, "TickBuffer: Large tick count", "[tickbu
     
     REQUIRE(largeBuffer.getTickCount() == 1000);
 }
+
+TEST_CASE_METHOD(TickBufferTestFixture, "TickBuffer: Recording continues while a reader holds storage", "[tickbuffer]") {
+    buffer_.addSymbol("OIL");
+    buffer_.addSymbol("STEEL");
+
+    std::atomic<bool> done{ false };
+    std::atomic<size_t> reads{ 0 };
+    std::atomic<bool> monotonic{ true };
+    std::thread reader([&]() {
+        size_t last = 0;
+        while (!done) {
+            auto ticks = buffer_.getTicks(0, 1000000);
+            size_t n = ticks["OIL"].size();
+            if (n < last || n != ticks["STEEL"].size()) monotonic = false;
+            last = n;
+            reads++;
+        }
+    });
+
+    // Overlap recording with reads even when the reader thread starts late
+    while (reads == 0) std::this_thread::yield();
+    for (int i = 0; i < 5000; ++i) {
+        buffer_.recordTick(0, 75.0 + i, 76.0, 74.0, 75.5, 1000.0);
+        buffer_.recordTick("STEEL", 120.0, 121.0, 119.0, 120.5, 500.0);
+        buffer_.advanceTick();
+    }
+    done = true;
+    reader.join();
+
+    REQUIRE(monotonic);
+    REQUIRE(reads > 0);
+
+    // Reads see every tick advanced before them
+    REQUIRE(buffer_.getTickCount() == 5000);
+    auto last = buffer_.getTicks(4999, 1);
+    REQUIRE(last["OIL"][0].tick == 4999);
+    REQUIRE(last["OIL"][0].open == Catch::Approx(75.0 + 4999));
+
+    REQUIRE(buffer_.getPublishedTicks() == 5000);
+    REQUIRE(buffer_.getAppliedTicks() == 5000);
+    REQUIRE(buffer_.getQueuedTicks() == 0);
+}
+
+TEST_CASE_METHOD(TickBufferTestFixture, "TickBuffer: Columnar storage omits redundant columns", "[tickbuffer]") {
+    TickBuffer flat(1000000);
+    flat.addSymbol("OIL");
+    REQUIRE(flat.getStorageBytes() < 4096);  // Nothing reserved up front
+
+    for (int i = 0; i < 10000; ++i) {
+        flat.recordTick(0, 75.25, 75.25, 75.25, 75.25, 0);
+        flat.advanceTick();
+    }
+    flat.flush();
+    // Close column only: three 4096-tick chunks of floats, plus chunk slots and headers
+    REQUIRE(flat.getStorageBytes() < 3 * TickSeries::CHUNK_TICKS * sizeof(float) + 8192);
+
+    // A series that needs every column still reads back what was recorded
+    buffer_.addSymbol("OIL");
+    for (int i = 0; i < 5000; ++i) {
+        if (i == 3000) buffer_.setCurrentTick(3500);  // A gap materializes the tick column
+        if (i < 2000) buffer_.recordTick(0, 10.5, 10.5, 10.5, 10.5, 0);
+        else buffer_.recordTick(0, 10.0 + i * 0.125, 11.0, 9.5, 10.25, 100 + i);
+        buffer_.advanceTick();
+    }
+    auto ticks = buffer_.getTicks(0, 5000)["OIL"];
+    REQUIRE(ticks.size() == 5000);
+    REQUIRE(ticks[1999].open == 10.5);
+    REQUIRE(ticks[1999].volume == 0.0);
+    REQUIRE(ticks[2999].tick == 2999);
+    REQUIRE(ticks[3000].tick == 3500);
+    REQUIRE(ticks[4999].tick == 5499);
+    REQUIRE(ticks[4999].open == Catch::Approx(10.0 + 4999 * 0.125));
+    REQUIRE(ticks[4999].high == 11.0);
+    REQUIRE(ticks[4999].low == 9.5);
+    REQUIRE(ticks[4999].close == 10.25);
+    REQUIRE(ticks[4999].volume == 100 + 4999);
+}
+
+TEST_CASE_METHOD(TickBufferTestFixture, "TickBuffer: Store spills full segments and reopens them mapped", "[tickbuffer]") {
+    std::string dir = (testDir_ / "store").string();
+    fs::remove_all(dir);
+    const int recorded = 70000;  // One full segment plus an unsealed tail
+    {
+        TickBuffer buffer(1000);
+        buffer.addSymbol("OIL");
+        buffer.attachStore(dir);
+        for (int i = 0; i < recorded; ++i) {
+            buffer.recordTick(0, 75.0 + (i % 100) * 0.25, 80.0, 70.0, 75.5, i % 7);
+            buffer.advanceTick();
+        }
+        buffer.flush();
+        REQUIRE(buffer.getStoreSegmentCount() == 1);
+        auto segments = buffer.getStoreSegments();
+        REQUIRE(segments[0].symbol == "OIL");
+        REQUIRE(segments[0].firstTick == 0);
+        REQUIRE(segments[0].lastTick == tickstore::CHUNKS_PER_SEGMENT * TickSeries::CHUNK_TICKS - 1);
+        REQUIRE(fs::exists(segments[0].path));
+        // Only the tail is held in memory
+        REQUIRE(buffer.getStorageBytes() < 2 * TickSeries::CHUNK_TICKS * 6 * sizeof(float) + 8192);
+
+        auto mid = buffer.getTicks(1234, 1)["OIL"];
+        REQUIRE(mid[0].tick == 1234);
+        REQUIRE(mid[0].open == Catch::Approx(75.0 + 34 * 0.25));
+        REQUIRE(mid[0].volume == 1234 % 7);
+    }
+
+    // The tail was saved on destruction; reopening maps the segment back
+    TickBuffer reopened(1000);
+    reopened.addSymbol("OIL");
+    reopened.attachStore(dir);
+    REQUIRE(reopened.getTickCount() == recorded);
+    REQUIRE(reopened.getCurrentTick() == recorded);
+    REQUIRE(reopened.getStoreSegmentCount() == 1);
+    auto ticks = reopened.getTicks(0, recorded)["OIL"];
+    for (int i : { 0, 1234, 65535, 65536, recorded - 1 }) {
+        REQUIRE(ticks[i].tick == static_cast<uint64_t>(i));
+        REQUIRE(ticks[i].open == Catch::Approx(75.0 + (i % 100) * 0.25));
+        REQUIRE(ticks[i].high == 80.0);
+        REQUIRE(ticks[i].low == 70.0);
+        REQUIRE(ticks[i].close == 75.5);
+        REQUIRE(ticks[i].volume == i % 7);
+    }
+
+    // Recording continues after the stored history
+    reopened.recordTick(0, 1.0, 1.0, 1.0, 1.0, 0);
+    reopened.advanceTick();
+    REQUIRE(reopened.getTicks(recorded, 1)["OIL"][0].tick == static_cast<uint64_t>(recorded));
+
+    reopened.clear();
+    REQUIRE(reopened.getStoreSegmentCount() == 0);
+    REQUIRE(!fs::exists(dir + "/OIL"));
+}
+
+TEST_CASE_METHOD(TickBufferTestFixture, "TickBuffer: Store refuses history with an unreadable segment", "[tickbuffer]") {
+    std::string dir = (testDir_ / "store").string();
+    fs::remove_all(dir);
+    const int recorded = 3 * 65536;
+    {
+        TickBuffer buffer(1000);
+        buffer.addSymbol("OIL");
+        buffer.attachStore(dir);
+        for (int i = 0; i < recorded; ++i) {
+            buffer.recordTick(0, 75.0, 80.0, 70.0, 75.5, 1);
+            buffer.advanceTick();
+        }
+        buffer.flush();
+        REQUIRE(buffer.getStoreSegmentCount() == 3);
+        // Cut the middle segment short
+        fs::resize_file(buffer.getStoreSegments()[1].path, 100);
+    }
+
+    // Skipping it would move the third segment's ticks down by 65536
+    TickBuffer reopened(1000);
+    reopened.addSymbol("OIL");
+    reopened.recordTick(0, 1.0, 1.0, 1.0, 1.0, 0);
+    reopened.advanceTick();
+    REQUIRE_THROWS_AS(reopened.attachStore(dir), std::runtime_error);
+    REQUIRE(!reopened.hasStore());
+    REQUIRE(reopened.getTickCount() == 1);
+    REQUIRE(reopened.getCurrentTick() == 1);
+}
+
+TEST_CASE_METHOD(TickBufferTestFixture, "TickBuffer: Background export covers the ticks recorded at its start", "[tickbuffer]") {
+    buffer_.addSymbol("OIL");
+    buffer_.addSymbol("STEEL");
+    auto record = [this](int ticks) {
+        for (int i = 0; i < ticks; ++i) {
+            buffer_.recordTick(0, 75.0, 76.0, 74.0, 75.5, 1000.0);
+            buffer_.recordTick(1, 120.0, 121.0, 119.0, 120.5, 500.0);
+            buffer_.advanceTick();
+        }
+    };
+    auto waitForJob = [this]() {
+        auto status = buffer_.getExportStatus();
+        while (status.state == TickBuffer::ExportStatus::State::RUNNING) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            status = buffer_.getExportStatus();
+        }
+        return status;
+    };
+    record(3000);
+
+    std::string jsonPath = (testDir_ / "job.json").string();
+    std::string csvDir = (testDir_ / "job_csv").string();
+    buffer_.startExport({ { TickBuffer::ExportFormat::JSON, jsonPath, 0 },
+                          { TickBuffer::ExportFormat::CSV, csvDir, 0 } });
+    REQUIRE_THROWS_AS(buffer_.startExport({ { TickBuffer::ExportFormat::JSON, jsonPath, 0 } }), std::runtime_error);
+    record(2000);  // Not part of the export
+
+    auto status = waitForJob();
+    REQUIRE(status.state == TickBuffer::ExportStatus::State::DONE);
+    REQUIRE(status.progress == Catch::Approx(1.0));
+    REQUIRE(status.ticks == 3000);
+    REQUIRE(status.paths.size() == 2);
+
+    std::ifstream json(jsonPath);
+    std::string content((std::istreambuf_iterator<char>(json)), std::istreambuf_iterator<char>());
+    size_t ticks = 0;
+    for (size_t at = content.find("\"tick\":"); at != std::string::npos; at = content.find("\"tick\":", at + 1)) ticks++;
+    REQUIRE(ticks == 2 * 3000);
+
+    std::ifstream csv(csvDir + "/OIL.csv");
+    size_t lines = 0;
+    for (std::string line; std::getline(csv, line);) lines++;
+    REQUIRE(lines == 3000 + 1);
+
+    // A cancelled job leaves no partial file behind
+    record(300000);
+    std::string bigPath = (testDir_ / "big.json").string();
+    buffer_.startExport({ { TickBuffer::ExportFormat::JSON, bigPath, 0 } });
+    buffer_.cancelExport();
+    status = waitForJob();
+    REQUIRE(status.state == TickBuffer::ExportStatus::State::CANCELLED);
+    REQUIRE_FALSE(fs::exists(bigPath));
+    REQUIRE(buffer_.getTickCount() == 305000);
+}
+
+TEST_CASE_METHOD(TickBufferTestFixture, "TickBuffer: Export to Arrow IPC files", "[tickbuffer]") {
+    buffer_.addSymbol("OIL");
+    buffer_.addSymbol("GOLD");
+    for (int i = 0; i < 70000; ++i) {
+        buffer_.recordTick(0, 75.0 + (i % 100) * 0.25, 80.0, 70.0, 75.5, i % 7);
+        buffer_.recordTick(1, 1800.0, 1800.0, 1800.0, 1800.0, 0);
+        if (i % 1000 == 0) buffer_.recordNews(i, NewsData{ "OIL", "supply", "negative", 0.5, "Pipeline \"outage\"" });
+        buffer_.advanceTick();
+    }
+
+    std::string dir = (testDir_ / "arrow").string();
+    REQUIRE(buffer_.exportToArrow(dir, 0));
+
+    auto readFile = [](const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    };
+    for (const char* name : { "OIL.arrow", "GOLD.arrow", "news.arrow" }) {
+        std::string content = readFile(dir + "/" + name);
+        REQUIRE(content.size() > 16);
+        REQUIRE(content.compare(0, 6, "ARROW1") == 0);
+        REQUIRE(content.compare(content.size() - 6, 6, "ARROW1") == 0);
+        // Schema message right after the padded magic
+        REQUIRE(static_cast<unsigned char>(content[8]) == 0xFF);
+        int32_t footer = 0;
+        std::memcpy(&footer, content.data() + content.size() - 10, sizeof(footer));
+        REQUIRE(footer > 0);
+        REQUIRE(static_cast<size_t>(footer) % 8 == 0);
+        REQUIRE(static_cast<size_t>(footer) < content.size());
+    }
+
+    // tick + five float32 columns, no per-value text
+    std::string oil = readFile(dir + "/OIL.arrow");
+    REQUIRE(oil.size() >= 70000 * 28);
+    REQUIRE(oil.size() < 70000 * 28 + 4096);
+
+    // Schema: field names and types (Int 64 unsigned, FloatingPoint SINGLE)
+    auto messages = arrowMessages(oil);
+    REQUIRE(messages.size() == 3);
+    REQUIRE(messages[0].headerType == 1);
+    FlatTable schema = messages[0].header;
+    REQUIRE(schema.length(1) == 6);
+    const char* names[] = { "tick", "open", "high", "low", "close", "volume" };
+    for (size_t i = 0; i < 6; ++i) {
+        FlatTable field = schema.element(1, i);
+        REQUIRE(field.string(0) == names[i]);
+        REQUIRE(field.scalar<uint8_t>(1) == 0);  // not nullable
+        FlatTable type = field.table(3);
+        if (i == 0) {
+            REQUIRE(field.scalar<uint8_t>(2) == 2);
+            REQUIRE(type.scalar<int32_t>(0) == 64);
+            REQUIRE(type.scalar<uint8_t>(1) == 0);
+        }
+        else {
+            REQUIRE(field.scalar<uint8_t>(2) == 3);
+            REQUIRE(type.scalar<int16_t>(0) == 1);
+        }
+    }
+
+    // Record batches of at most 65536 rows; per column a node, an empty
+    // validity buffer and the values
+    auto value = [&oil](const ArrowMessage& m, size_t column, size_t row, auto zero) {
+        int64_t offset = m.header.structWord(2, 2 * column + 1, 2, 0);
+        decltype(zero) v;
+        std::memcpy(&v, oil.data() + m.body + offset + row * sizeof(v), sizeof(v));
+        return v;
+    };
+    int64_t rows = 0;
+    for (size_t b = 1; b < messages.size(); ++b) {
+        const ArrowMessage& m = messages[b];
+        REQUIRE(m.headerType == 3);
+        int64_t length = m.header.scalar<int64_t>(0);
+        REQUIRE(length == (b == 1 ? 65536 : 70000 - 65536));
+        REQUIRE(m.header.length(1) == 6);
+        REQUIRE(m.header.length(2) == 12);
+        for (size_t c = 0; c < 6; ++c) {
+            REQUIRE(m.header.structWord(1, c, 2, 0) == length);
+            REQUIRE(m.header.structWord(1, c, 2, 1) == 0);
+            REQUIRE(m.header.structWord(2, 2 * c, 2, 1) == 0);
+            REQUIRE(m.header.structWord(2, 2 * c + 1, 2, 1) == length * (c == 0 ? 8 : 4));
+        }
+        rows += length;
+    }
+    REQUIRE(rows == 70000);
+    const ArrowMessage& first = messages[1];
+    uint64_t tick0 = value(first, 0, 0, uint64_t{});
+    REQUIRE(value(first, 0, 3, uint64_t{}) == tick0 + 3);
+    REQUIRE(value(first, 1, 3, float{}) == 75.75f);
+    REQUIRE(value(first, 2, 3, float{}) == 80.0f);
+    REQUIRE(value(first, 4, 3, float{}) == 75.5f);
+    REQUIRE(value(first, 5, 5, float{}) == 5.0f);
+    REQUIRE(value(messages[2], 0, 0, uint64_t{}) == tick0 + 65536);
+    REQUIRE(value(messages[2], 1, 1, float{}) == 75.0f + (65537 % 100) * 0.25f);
+
+    // The footer indexes the same batches
+    int32_t footerLength = 0;
+    std::memcpy(&footerLength, oil.data() + oil.size() - 10, sizeof(footerLength));
+    size_t footerAt = oil.size() - 10 - footerLength;
+    FlatTable footer{ &oil, footerAt + FlatTable{ &oil, 0 }.read<uint32_t>(footerAt) };
+    REQUIRE(footer.table(1).length(1) == 6);
+    REQUIRE(footer.length(3) == 2);
+    for (size_t b = 0; b < 2; ++b) {
+        REQUIRE(static_cast<size_t>(footer.structWord(3, b, 3, 0)) == messages[b + 1].offset);
+        REQUIRE(footer.structWord(3, b, 3, 2) == messages[b + 1].bodyLength);
+    }
+
+    // News: UTF-8 columns carry value offsets then the bytes
+    std::string news = readFile(dir + "/news.arrow");
+    auto newsMessages = arrowMessages(news);
+    REQUIRE(newsMessages.size() == 2);
+    FlatTable newsSchema = newsMessages[0].header;
+    REQUIRE(newsSchema.length(1) == 6);
+    REQUIRE(newsSchema.element(1, 5).string(0) == "headline");
+    REQUIRE(newsSchema.element(1, 5).scalar<uint8_t>(2) == 5);   // Utf8
+    REQUIRE(newsSchema.element(1, 4).scalar<uint8_t>(2) == 3);   // FloatingPoint
+    REQUIRE(newsSchema.element(1, 4).table(3).scalar<int16_t>(0) == 2);  // DOUBLE
+    const ArrowMessage& batch = newsMessages[1];
+    REQUIRE(batch.header.scalar<int64_t>(0) == 70);
+    REQUIRE(batch.header.length(2) == 2 + 3 + 3 + 3 + 2 + 3);
+    // Buffers: tick 0-1, symbol 2-4, category 5-7, sentiment 8-10,
+    // magnitude 11-12, headline 13-15 (validity first in each)
+    auto text = [&](size_t bufferIndex, size_t row) {
+        int64_t offsets = batch.header.structWord(2, bufferIndex, 2, 0);
+        int64_t data = batch.header.structWord(2, bufferIndex + 1, 2, 0);
+        int32_t from, to;
+        std::memcpy(&from, news.data() + batch.body + offsets + 4 * row, 4);
+        std::memcpy(&to, news.data() + batch.body + offsets + 4 * (row + 1), 4);
+        return news.substr(batch.body + data + from, to - from);
+    };
+    REQUIRE(text(3, 1) == "OIL");
+    REQUIRE(text(6, 0) == "supply");
+    REQUIRE(text(14, 69) == "Pipeline \"outage\"");
+    double magnitude = 0;
+    std::memcpy(&magnitude, news.data() + batch.body + batch.header.structWord(2, 12, 2, 0) + 8 * 2, 8);
+    REQUIRE(magnitude == 0.5);
+
+    // Column lengths must agree within a batch
+    ArrowIpcWriter bad((testDir_ / "bad.arrow").string(),
+        { { "a", ArrowIpcWriter::Type::UINT64 }, { "b", ArrowIpcWriter::Type::FLOAT64 } });
+    REQUIRE(bad.isOpen());
+    bad.appendUInt64(0, 1);
+    REQUIRE_FALSE(bad.writeBatch());
+}
+
+TEST_CASE_METHOD(TickBufferTestFixture, "TickBuffer: Parallel export matches a single-threaded one", "[tickbuffer]") {
+    const char* symbols[] = { "OIL", "GOLD", "WHEAT", "COPPER", "GAS" };
+    for (const char* symbol : symbols) buffer_.addSymbol(symbol);
+    for (int i = 0; i < 9000; ++i) {
+        for (size_t s = 0; s < 5; ++s) {
+            double close = 10.0 * (s + 1) + (i % 37) * 0.125;
+            buffer_.recordTick(s, close - 0.5, close + 1.0 / 3.0, close - 1.0, close, (i * s) % 11);
+        }
+        if (i % 500 == 0) buffer_.recordNews(i, NewsData{ "GAS", "weather", "positive", 0.123456789, "Cold\tsnap" });
+        buffer_.advanceTick();
+    }
+
+    auto readFile = [](const fs::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    };
+
+    // Only this test's output is checked for leftover temporary files
+    fs::path out = testDir_ / "parallel_export";
+    fs::create_directories(out);
+    buffer_.setExportThreads(1);
+    REQUIRE(buffer_.exportToJson((out / "serial.json").string(), 0));
+    REQUIRE(buffer_.exportToCsv((out / "serial").string(), 0));
+    buffer_.setExportThreads(4);
+    REQUIRE(buffer_.exportToJson((out / "parallel.json").string(), 0));
+    REQUIRE(buffer_.exportToCsv((out / "parallel").string(), 0));
+
+    std::string json = readFile(out / "serial.json");
+    REQUIRE(json == readFile(out / "parallel.json"));
+    REQUIRE(json.find("{\"tick\":1,\"open\":9.625,\"high\":10.458333,\"low\":9.125,\"close\":10.125,\"volume\":0}")
+        != std::string::npos);
+    REQUIRE(json.find("\"magnitude\":0.123457,\"headline\":\"Cold\\tsnap\"") != std::string::npos);
+    for (const auto& entry : fs::recursive_directory_iterator(out)) {
+        REQUIRE(entry.path().string().find(".part") == std::string::npos);
+    }
+
+    for (const char* symbol : symbols) {
+        std::string csv = readFile(out / "serial" / (std::string(symbol) + ".csv"));
+        REQUIRE(csv == readFile(out / "parallel" / (std::string(symbol) + ".csv")));
+        REQUIRE(std::count(csv.begin(), csv.end(), '\n') == 9001);
+    }
+    std::string gold = readFile(out / "serial" / "GOLD.csv");
+    REQUIRE(gold.find("\n1,19.6250,20.4583,19.1250,20.1250,1.00\n") != std::string::npos);
+}
+
+TEST_CASE_METHOD(TickBufferTestFixture, "TickBuffer: Tick ranges share storage and filter by symbol", "[tickbuffer]") {
+    buffer_.addSymbol("OIL");
+    buffer_.addSymbol("GOLD");
+    for (int i = 0; i < 10000; ++i) {
+        buffer_.recordTick(0, 50.0 + i, 50.0 + i, 50.0 + i, 50.0 + i, 1);
+        buffer_.recordTick(1, 1800.0, 1800.0, 1800.0, 1800.0, 0);
+        buffer_.advanceTick();
+    }
+
+    auto range = buffer_.getTickRange(4000, 200, { "OIL" });
+    REQUIRE(range.series.size() == 1);
+    REQUIRE(range.series[0].symbol == "OIL");
+    REQUIRE(range.series[0].size() == 200);
+    REQUIRE(range.currentTick == 10000);
+
+    // Reading spans a chunk boundary (4096) and is unaffected by later recording
+    for (int i = 0; i < 5000; ++i) {
+        buffer_.recordTick(0, 0.0, 0.0, 0.0, 0.0, 0);
+        buffer_.recordTick(1, 0.0, 0.0, 0.0, 0.0, 0);
+        buffer_.advanceTick();
+    }
+    size_t expected = 4000;
+    range.series[0].forEach([&](const TickData& td) {
+        REQUIRE(td.tick == expected);
+        REQUIRE(td.close == Catch::Approx(50.0 + expected));
+        expected++;
+    });
+    REQUIRE(expected == 4200);
+
+    auto all = buffer_.getTickRange(14990, 100);
+    REQUIRE(all.series.size() == 2);
+    REQUIRE(all.series[0].symbol == "GOLD");
+    REQUIRE(all.series[0].size() == 10);
+    REQUIRE(all.series[1][9].tick == 14999);
+    REQUIRE(buffer_.getTickRange(20000, 10).size() == 0);
+    REQUIRE_THROWS_AS(buffer_.getTickRange(0, 10, { "SILVER" }), std::runtime_error);
+}
+
+TEST_CASE_METHOD(TickBufferTestFixture, "TickBuffer: Compressed history reads back the same ticks", "[tickbuffer]") {
+    TickBuffer plain(100000);
+    TickBuffer packed(100000);
+    for (auto* b : { &plain, &packed }) {
+        b->addSymbol("OIL");
+        b->addSymbol("GOLD");
+    }
+    packed.setCompression(true);
+
+    // OIL: a quantized random walk with bars, volume and a gap in the ticks;
+    // GOLD: flat, changing once in a while, as the live loop records it
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> step(-3, 3);
+    double oil = 80.0;
+    double gold = 1800.0;
+    for (int i = 0; i < 30000; ++i) {
+        if (i == 12345) {
+            plain.setCurrentTick(20000);
+            packed.setCurrentTick(20000);
+        }
+        oil += step(rng) * 0.01;
+        if (i % 97 == 0) gold += 0.25;
+        for (auto* b : { &plain, &packed }) {
+            b->recordTick(0, oil - 0.02, oil + 0.05, oil - 0.04, oil, (i % 7) * 10.0);
+            b->recordTick(1, gold, gold, gold, gold, 0);
+            b->advanceTick();
+        }
+    }
+
+    // Full chunks compress as they fill; the open tail stays as it is
+    auto expected = plain.getTicks(0, 40000);
+    auto actual = packed.getTicks(0, 40000);
+    for (const char* symbol : { "OIL", "GOLD" }) {
+        REQUIRE(actual[symbol].size() == 30000);
+        for (size_t i = 0; i < 30000; ++i) {
+            const TickData& a = actual[symbol][i];
+            const TickData& e = expected[symbol][i];
+            REQUIRE((a.tick == e.tick && a.open == e.open && a.high == e.high && a.low == e.low
+                && a.close == e.close && a.volume == e.volume));
+        }
+    }
+    REQUIRE(packed.getTickRange(17654, 1, { "OIL" }).series[0][0].tick == 25309);
+    REQUIRE(packed.getStorageBytes() * 3 < plain.getStorageBytes() * 2);  // Noisy bars: about 1.7x
+
+    TickBuffer flat(100000);
+    TickBuffer flatPacked(100000);
+    for (auto* b : { &flat, &flatPacked }) {
+        b->addSymbol("GOLD");
+        for (int i = 0; i < 40960; ++i) {
+            b->recordTick(0, 1800.0, 1800.0, 1800.0, 1800.0, 0);
+            b->advanceTick();
+        }
+    }
+    flatPacked.setCompression(true);  // Compresses what is already recorded
+    REQUIRE(flatPacked.getStorageBytes() * 10 < flat.getStorageBytes());
+
+    auto readFile = [](const fs::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    };
+    REQUIRE(plain.exportToJson((testDir_ / "plain.json").string(), 0));
+    REQUIRE(packed.exportToJson((testDir_ / "packed.json").string(), 0));
+    REQUIRE(readFile(testDir_ / "plain.json") == readFile(testDir_ / "packed.json"));
+}
@@ -1,6 +1,13 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/catch_approx.hpp>
 #include "core/Types.hpp"
+#include "core/SymbolRegistry.hpp"
+#include "core/TradeRing.hpp"
+#include "core/RingBuffer.hpp"
+#include "utils/Random.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
 
 using namespace market;
 using Catch::Approx;
@@ -155,8 +162,206 @@ TEST_CASE("Types: MarketState defaults", "[types]") {
     REQUIRE(ms.currentTime == 0);
 }
 
+TEST_CASE("Types: SymbolRegistry assigns dense ids in registration order", "[types]") {
+    SymbolRegistry reg;
+    REQUIRE(reg.intern("OIL") == 0);
+    REQUIRE(reg.intern("STEEL") == 1);
+    REQUIRE(reg.intern("OIL") == 0);  // Re-interning returns the existing id
+    REQUIRE(reg.size() == 2);
+
+    REQUIRE(reg.find("STEEL") == 1);
+    REQUIRE(reg.find("GOLD") == INVALID_SYMBOL_ID);
+    REQUIRE(reg.name(1) == "STEEL");
+    REQUIRE(reg.name(99).empty());
+}
+
 TEST_CASE("Types: now() returns valid timestamp", "[types]") {
     Timestamp t = now();
     REQUIRE(t > 0);
     REQUIRE(t < 9999999999999); // Reasonable range
 }
+
+TEST_CASE("TradeRing: sequence numbers and cursor reads", "[types]") {
+    TradeRing ring(4);
+    auto make = [](Volume qty) {
+        Trade t{};
+        t.quantity = qty;
+        return t;
+    };
+
+    REQUIRE(ring.empty());
+    REQUIRE(ring.firstSeq() > ring.lastSeq());
+    for (Volume q = 1; q <= 6; q++) {
+        REQUIRE(ring.push(make(q)) == static_cast<uint64_t>(q));
+    }
+
+    // Full ring keeps the newest four
+    REQUIRE(ring.size() == 4);
+    REQUIRE(ring.firstSeq() == 3);
+    REQUIRE(ring.lastSeq() == 6);
+    REQUIRE(ring.at(3).quantity == 3);
+
+    std::vector<Volume> after;
+    ring.forEachAfter(4, [&](uint64_t, const Trade& t) { after.push_back(t.quantity); return true; });
+    REQUIRE(after == std::vector<Volume>{ 5, 6 });
+
+    // A cursor older than the window starts at the oldest held trade
+    after.clear();
+    ring.forEachAfter(0, [&](uint64_t, const Trade& t) { after.push_back(t.quantity); return true; });
+    REQUIRE(after == std::vector<Volume>{ 3, 4, 5, 6 });
+
+    after.clear();
+    ring.forEachAfter(6, [&](uint64_t, const Trade& t) { after.push_back(t.quantity); return true; });
+    REQUIRE(after.empty());
+
+    std::vector<uint64_t> newest;
+    ring.forEachNewest([&](uint64_t seq, const Trade&) { newest.push_back(seq); return newest.size() < 2; });
+    REQUIRE(newest == std::vector<uint64_t>{ 6, 5 });
+
+    // Shrinking keeps the newest trades and their sequence numbers
+    ring.setCapacity(2);
+    REQUIRE(ring.size() == 2);
+    REQUIRE(ring.firstSeq() == 5);
+    REQUIRE(ring.at(5).quantity == 5);
+
+    // Sequence numbers survive clear()
+    ring.clear();
+    REQUIRE(ring.empty());
+    REQUIRE(ring.push(make(7)) == 7);
+    REQUIRE(ring.firstSeq() == 7);
+}
+
+TEST_CASE("RingBuffer: newest window stays contiguous across wraps", "[types]") {
+    RingBuffer<int> ring(4);
+    REQUIRE(ring.empty());
+    REQUIRE(ring.view().empty());
+
+    auto contents = [&] {
+        ConstSpan<int> v = ring.view();
+        return std::vector<int>(v.begin(), v.end());
+    };
+
+    for (int i = 1; i <= 3; ++i) ring.push_back(i);
+    REQUIRE_FALSE(ring.full());
+    REQUIRE(contents() == std::vector<int>{ 1, 2, 3 });
+
+    // Several full laps: the view is always the newest four, oldest first
+    for (int i = 4; i <= 13; ++i) {
+        ring.push_back(i);
+        std::vector<int> expected;
+        for (int k = std::max(1, i - 3); k <= i; ++k) expected.push_back(k);
+        REQUIRE(contents() == expected);
+        REQUIRE(ring.front() == expected.front());
+        REQUIRE(ring.back() == i);
+        REQUIRE(ring[1] == expected[1]);
+    }
+    REQUIRE(ring.full());
+
+    // Shrinking keeps the newest; growing keeps everything held
+    ring.setCapacity(2);
+    REQUIRE(contents() == std::vector<int>{ 12, 13 });
+    ring.setCapacity(5);
+    ring.push_back(14);
+    REQUIRE(contents() == std::vector<int>{ 12, 13, 14 });
+
+    ring.clear();
+    REQUIRE(ring.empty());
+    ring.push_back(99);
+    REQUIRE(contents() == std::vector<int>{ 99 });
+}
+
+TEST_CASE("Random: Counter-based streams are keyed by seed, id and epoch", "[types]") {
+    Random::seed(11);
+    Random::Engine a = Random::stream(3);
+    Random::Engine b = Random::stream(3);
+    Random::Engine other = Random::stream(4);
+
+    a.seek(100);
+    uint32_t first = a();
+    a();
+    a();
+    a.seek(100);
+    REQUIRE(a() == first);
+
+    b.seek(100);
+    REQUIRE(b() == first);
+    other.seek(100);
+    REQUIRE(other() != first);
+
+    // The batch path produces the same block as stepping the engine
+    Random::Engine c = Random::stream(3);
+    uint32_t block[4];
+    c.generateBlocks(100, 0, 1, block);
+    REQUIRE(block[0] == first);
+
+    // Batch values depend only on their index, not on how many were requested
+    std::vector<double> small(5), large(130);
+    Random::fillUniform(small.data(), small.size(), 9, 2);
+    Random::fillUniform(large.data(), large.size(), 9, 2);
+    for (size_t i = 0; i < small.size(); ++i) REQUIRE(small[i] == large[i]);
+    for (double u : large) {
+        REQUIRE(u > 0.0);
+        REQUIRE(u < 1.0);
+    }
+}
+
+TEST_CASE("Random: Distributions stay in range with sane moments", "[types]") {
+    Random::seed(5);
+    Random::Engine e = Random::stream(1);
+    Random::StreamScope scope(e);
+
+    for (int i = 0; i < 2000; ++i) {
+        int v = Random::uniformInt(-3, 4);
+        REQUIRE(v >= -3);
+        REQUIRE(v <= 4);
+        double u = Random::uniform(2.0, 3.0);
+        REQUIRE(u >= 2.0);
+        REQUIRE(u < 3.0);
+    }
+
+    std::vector<double> normals(20001);
+    Random::fillNormal(normals.data(), normals.size(), 2, 0, 1.0, 2.0);
+    double sum = 0.0, sq = 0.0;
+    for (double x : normals) {
+        sum += x;
+        sq += x * x;
+    }
+    double mean = sum / normals.size();
+    double var = sq / normals.size() - mean * mean;
+    REQUIRE(mean == Approx(1.0).margin(0.1));
+    REQUIRE(std::sqrt(var) == Approx(2.0).margin(0.1));
+
+    double psum = 0.0;
+    for (int i = 0; i < 5000; ++i) psum += Random::poisson(3.0);
+    REQUIRE(psum / 5000 == Approx(3.0).margin(0.15));
+}
+
+TEST_CASE("Random: Contexts keep separate seeds and engines", "[types]") {
+    Random::Context a(17);
+    Random::Context b(17);
+
+    // Interleaving two contexts does not couple their sequences
+    std::vector<double> fromA, fromB;
+    for (int i = 0; i < 8; ++i) {
+        {
+            Random::ContextScope scope(a);
+            fromA.push_back(Random::uniform(0.0, 1.0));
+        }
+        Random::ContextScope scope(b);
+        fromB.push_back(Random::uniform(0.0, 1.0));
+        Random::uniform(0.0, 1.0);  // Extra draw on b only
+    }
+    REQUIRE(fromA[0] == fromB[0]);
+    REQUIRE(fromA[1] != fromB[1]);
+
+    // seed() and stream() act on the bound context, not on the thread default
+    Random::seed(99);
+    {
+        Random::ContextScope scope(a);
+        REQUIRE(Random::currentSeed() == 17);
+        Random::seed(23);
+        REQUIRE(a.seed() == 23);
+        REQUIRE(Random::stream(4)() == Random::Engine(23, 4)());
+    }
+    REQUIRE(Random::currentSeed() == 99);
+}